@@ -1,4 +1,8 @@
 mkdir -p build/shaders
 
-glslc src/shaders/simple.vert -o build/shaders/simple.vert.spv
-glslc src/shaders/simple.frag -o build/shaders/simple.frag.spv
\ No newline at end of file
+if exist build\ShaderCompiler.exe (
+  build\ShaderCompiler.exe --cache build/shader_cache --out-dir build/shaders src/shaders/simple.vert src/shaders/simple.frag
+) else (
+  glslc src/shaders/simple.vert -o build/shaders/simple.vert.spv
+  glslc src/shaders/simple.frag -o build/shaders/simple.frag.spv
+)
\ No newline at end of file
@@ -1,4 +1,9 @@
 mkdir -p build/shaders
 
-glslc src/shaders/simple.vert -o build/shaders/simple.vert.spv
-glslc src/shaders/simple.frag -o build/shaders/simple.frag.spv
\ No newline at end of file
+# build/ShaderCompiler comes from the CMake build and reuses unchanged shaders from build/shader_cache
+if [ -x build/ShaderCompiler ]; then
+  build/ShaderCompiler --cache build/shader_cache --out-dir build/shaders src/shaders/simple.vert src/shaders/simple.frag
+else
+  glslc src/shaders/simple.vert -o build/shaders/simple.vert.spv
+  glslc src/shaders/simple.frag -o build/shaders/simple.frag.spv
+fi
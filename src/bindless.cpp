@@ -0,0 +1,165 @@
+#include "bindless.hpp"
+
+#include <algorithm>
+
+namespace Rhi {
+    BindlessHeap::BindlessHeap(Device* device, BindlessHeapDescriptor descriptor) : device{ device }, desc{ descriptor } {
+        BindGroupLayoutEntry textures;
+        textures.binding = static_cast<Uint32>(BindlessResourceType::eTexture);
+        textures.visibility = this->desc.visibility;
+        textures.type = BindingType::eTexture;
+        textures.count = this->desc.textureCount;
+        textures.partiallyBound = true;
+        textures.texture.sampleType = this->desc.textureSampleType;
+
+        BindGroupLayoutEntry samplers;
+        samplers.binding = static_cast<Uint32>(BindlessResourceType::eSampler);
+        samplers.visibility = this->desc.visibility;
+        samplers.type = BindingType::eSampler;
+        samplers.count = this->desc.samplerCount;
+        samplers.partiallyBound = true;
+
+        BindGroupLayoutEntry storageBuffers;
+        storageBuffers.binding = static_cast<Uint32>(BindlessResourceType::eStorageBuffer);
+        storageBuffers.visibility = this->desc.visibility;
+        storageBuffers.type = BindingType::eBuffer;
+        storageBuffers.count = this->desc.storageBufferCount;
+        storageBuffers.partiallyBound = true;
+        storageBuffers.buffer.type = this->desc.readOnlyStorageBuffers ? BufferBindingType::eReadOnlyStorage : BufferBindingType::eStorage;
+
+        this->layout = this->device->createBindGroupLayout(BindGroupLayoutDescriptor{ { textures, samplers, storageBuffers } });
+
+        // Starts empty, every element is written later through updateBindGroup
+        this->bindGroup = this->device->createBindGroup(BindGroupDescriptor{ this->layout.get(), {} });
+
+        this->arrays[static_cast<Uint32>(BindlessResourceType::eTexture)].capacity = this->desc.textureCount;
+        this->arrays[static_cast<Uint32>(BindlessResourceType::eSampler)].capacity = this->desc.samplerCount;
+        this->arrays[static_cast<Uint32>(BindlessResourceType::eStorageBuffer)].capacity = this->desc.storageBufferCount;
+    }
+
+    Uint32 BindlessHeap::allocate(BindlessResourceType type, std::shared_ptr<void> resource) {
+        Array& array = this->arrays[static_cast<Uint32>(type)];
+        Uint32 index;
+
+        // Recycled indices first keeps the used range, and what shaders touch, compact
+        if (!array.freeIndices.empty()) {
+            index = array.freeIndices.back();
+            array.freeIndices.pop_back();
+        } else if (array.nextUnused < array.capacity) {
+            index = array.nextUnused++;
+            array.resources.emplace_back();
+        } else {
+            return kInvalidBindlessIndex;
+        }
+
+        array.resources[index] = std::move(resource);
+        return index;
+    }
+
+    Uint32 BindlessHeap::addTexture(std::shared_ptr<TextureView> textureView) {
+        TextureView* view = textureView.get();
+        Uint32 index = this->allocate(BindlessResourceType::eTexture, std::move(textureView));
+
+        if (index != kInvalidBindlessIndex) {
+            BindGroupEntry entry;
+            entry.binding = static_cast<Uint32>(BindlessResourceType::eTexture);
+            entry.arrayElement = index;
+            entry.textureView = view;
+
+            this->pendingWrites.push_back(entry);
+        }
+
+        return index;
+    }
+
+    Uint32 BindlessHeap::addSampler(std::shared_ptr<Sampler> sampler) {
+        Sampler* raw = sampler.get();
+        Uint32 index = this->allocate(BindlessResourceType::eSampler, std::move(sampler));
+
+        if (index != kInvalidBindlessIndex) {
+            BindGroupEntry entry;
+            entry.binding = static_cast<Uint32>(BindlessResourceType::eSampler);
+            entry.arrayElement = index;
+            entry.sampler = raw;
+
+            this->pendingWrites.push_back(entry);
+        }
+
+        return index;
+    }
+
+    Uint32 BindlessHeap::addStorageBuffer(std::shared_ptr<Buffer> buffer, Uint64 offset, Uint64 size) {
+        Buffer* raw = buffer.get();
+        Uint32 index = this->allocate(BindlessResourceType::eStorageBuffer, std::move(buffer));
+
+        if (index != kInvalidBindlessIndex) {
+            BindGroupEntry entry;
+            entry.binding = static_cast<Uint32>(BindlessResourceType::eStorageBuffer);
+            entry.arrayElement = index;
+            entry.buffer = BufferBinding{ raw, size, offset };
+
+            this->pendingWrites.push_back(entry);
+        }
+
+        return index;
+    }
+
+    void BindlessHeap::remove(BindlessResourceType type, Uint32 index, Uint64 frameIndex) {
+        const Array& array = this->arrays[static_cast<Uint32>(type)];
+
+        if (index >= array.resources.size() || array.resources[index] == nullptr) {
+            return;
+        }
+
+        bool alreadyRemoved = std::any_of(this->retired.begin(), this->retired.end(), [type, index](const Retired& entry) {
+            return entry.type == type && entry.index == index;
+        });
+
+        if (alreadyRemoved) {
+            return;
+        }
+
+        // A write still pending for the index is dropped, nothing can have used it yet
+        this->pendingWrites.erase(std::remove_if(this->pendingWrites.begin(), this->pendingWrites.end(),
+            [type, index](const BindGroupEntry& entry) {
+                return entry.binding == static_cast<Uint32>(type) && entry.arrayElement == index;
+            }), this->pendingWrites.end());
+
+        this->retired.push_back(Retired{ frameIndex, type, index });
+    }
+
+    void BindlessHeap::flush() {
+        if (this->pendingWrites.empty()) {
+            return;
+        }
+
+        this->device->updateBindGroup(this->bindGroup.get(), this->pendingWrites);
+        this->pendingWrites.clear();
+    }
+
+    void BindlessHeap::releaseRetired(Uint64 completedFrameIndex) {
+        // The stale descriptor stays in place, partially bound arrays allow it as long as no
+        // shader reads the index before it is handed out and written again
+        size_t kept = 0;
+
+        for (size_t i = 0; i < this->retired.size(); i++) {
+            const Retired& entry = this->retired[i];
+
+            if (entry.frameIndex > completedFrameIndex) {
+                this->retired[kept++] = entry;
+                continue;
+            }
+
+            Array& array = this->arrays[static_cast<Uint32>(entry.type)];
+            array.resources[entry.index] = nullptr;
+            array.freeIndices.push_back(entry.index);
+        }
+
+        this->retired.resize(kept);
+    }
+
+    Uint32 BindlessHeap::getUsedCount(BindlessResourceType type) const {
+        const Array& array = this->arrays[static_cast<Uint32>(type)];
+        return array.nextUnused - static_cast<Uint32>(array.freeIndices.size());
+    }
+};
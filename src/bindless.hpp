@@ -0,0 +1,90 @@
+#pragma once
+
+#include "rhi.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Bindless Heap
+    // ===========================================================================================================================
+
+    enum class BindlessResourceType : Uint8 {
+        eTexture,
+        eSampler,
+        eStorageBuffer
+    };
+
+    constexpr Uint32 kInvalidBindlessIndex = 0xFFFFFFFF;
+
+    struct BindlessHeapDescriptor {
+        // Array sizes, the bindings are 0 for textures, 1 for samplers and 2 for storage buffers
+        Uint32 textureCount = 16384;
+        Uint32 samplerCount = 256;
+        Uint32 storageBufferCount = 16384;
+
+        TextureSampleType textureSampleType = TextureSampleType::eFloat;
+        bool readOnlyStorageBuffers = true;
+
+        ShaderStageFlags visibility = static_cast<ShaderStageFlags>(ShaderStage::eVertex)
+            | static_cast<ShaderStageFlags>(ShaderStage::eFragment) | static_cast<ShaderStageFlags>(ShaderStage::eCompute);
+    };
+
+    // One bind group holding large partially bound arrays of textures, samplers and storage
+    // buffers. Resources get a stable index shaders use to reach them, so the group is bound
+    // once per frame instead of a group per material and draw.
+    //
+    // New descriptors are written by flush. A removed index is recycled, and its resource
+    // released, once the frame it was removed in has completed, so work in flight never sees
+    // its element change. Not thread safe.
+    class BindlessHeap {
+    public:
+        BindlessHeap(Device* device, BindlessHeapDescriptor descriptor = {});
+
+        // kInvalidBindlessIndex when the array is full
+        Uint32 addTexture(std::shared_ptr<TextureView> textureView);
+        Uint32 addSampler(std::shared_ptr<Sampler> sampler);
+        Uint32 addStorageBuffer(std::shared_ptr<Buffer> buffer, Uint64 offset = 0, Uint64 size = ULLONG_MAX);
+
+        // The index stays valid for work recorded up to frameIndex
+        void remove(BindlessResourceType type, Uint32 index, Uint64 frameIndex);
+
+        // Writes the descriptors added since the last flush, call before recording the frame
+        void flush();
+
+        // Recycles indices removed on or before completedFrameIndex
+        void releaseRetired(Uint64 completedFrameIndex);
+
+        // For the pipeline layouts of shaders indexing the heap
+        BindGroupLayout* getLayout() const { return this->layout.get(); }
+        BindGroup* getBindGroup() const { return this->bindGroup.get(); }
+
+        Uint32 getUsedCount(BindlessResourceType type) const;
+
+    private:
+        struct Array {
+            Uint32 capacity;
+            Uint32 nextUnused = 0;
+            std::vector<Uint32> freeIndices;
+
+            // Keeps every referenced resource alive until its index is recycled
+            std::vector<std::shared_ptr<void>> resources;
+        };
+
+        struct Retired {
+            Uint64 frameIndex;
+            BindlessResourceType type;
+            Uint32 index;
+        };
+
+        Uint32 allocate(BindlessResourceType type, std::shared_ptr<void> resource);
+
+        Device* device;
+        BindlessHeapDescriptor desc;
+
+        std::shared_ptr<BindGroupLayout> layout;
+        std::shared_ptr<BindGroup> bindGroup;
+
+        Array arrays[3];
+        std::vector<BindGroupEntry> pendingWrites;
+        std::vector<Retired> retired;
+    };
+};
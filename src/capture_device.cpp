@@ -0,0 +1,982 @@
+#include "capture_device.hpp"
+
+namespace Rhi {
+    namespace {
+        Buffer* unwrapBuffer(Buffer* buffer) {
+            return buffer != nullptr ? static_cast<CaptureBuffer*>(buffer)->getInner() : nullptr;
+        }
+
+        Texture* unwrapTexture(Texture* texture) {
+            return texture != nullptr ? static_cast<CaptureTexture*>(texture)->getInner() : nullptr;
+        }
+
+        uint32_t getBufferId(Buffer* buffer) {
+            return buffer != nullptr ? static_cast<CaptureBuffer*>(buffer)->getId() : 0;
+        }
+
+        uint32_t getTextureId(Texture* texture) {
+            return texture != nullptr ? static_cast<CaptureTexture*>(texture)->getId() : 0;
+        }
+
+        void writeStage(CaptureDevice* device, TracePayload& payload, const ProgrammableStage& stage) {
+            payload.write(device->getId(stage.module));
+            payload.writeString(stage.entryPoint);
+
+            if (stage.constants == nullptr) {
+                payload.write<uint32_t>(UINT32_MAX);
+                return;
+            }
+
+            payload.write(static_cast<uint32_t>(stage.constants->constants.size()));
+            for (const auto& constant : stage.constants->constants) {
+                payload.write(constant);
+            }
+
+            payload.write(stage.constants->hash);
+        }
+
+        void writeImageCopyTexture(TracePayload& payload, const ImageCopyTexture& copy) {
+            payload.write(getTextureId(copy.texture));
+            payload.write(copy.mipLevel);
+            payload.write(copy.origin);
+            payload.write(copy.aspect);
+        }
+
+        void writeImageCopyBuffer(TracePayload& payload, const ImageCopyBuffer& copy) {
+            payload.write(getBufferId(copy.buffer));
+            payload.write(static_cast<const ImageDataLayout&>(copy));
+        }
+
+        void writeBufferBarrier(TracePayload& payload, const BufferBarrier& barrier) {
+            payload.write(barrier.srcAccess);
+            payload.write(barrier.dstAccess);
+            payload.write(barrier.split);
+            payload.write(getBufferId(barrier.buffer));
+            payload.write(barrier.size);
+            payload.write(barrier.offset);
+        }
+
+        void writeImageBarrier(TracePayload& payload, const ImageBarrier& barrier) {
+            payload.write(barrier.srcAccess);
+            payload.write(barrier.dstAccess);
+            payload.write(barrier.split);
+            payload.write(getTextureId(barrier.texture));
+            payload.write(barrier.subresource);
+            payload.write(barrier.srcState);
+            payload.write(barrier.dstState);
+        }
+
+        void writePushConstants(TracePayload& payload, ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) {
+            payload.write(static_cast<uint32_t>(visibility));
+            payload.write(static_cast<uint32_t>(offset));
+            payload.write(static_cast<uint32_t>(size));
+            payload.writeBytes(data, size);
+        }
+
+        void writeBindGroup(CaptureDevice* device, TracePayload& payload, Uint32 index, BindGroup* bindGroup,
+            const Uint32* dynamicOffsets, Uint32 dynamicOffsetCount)
+        {
+            payload.write(index);
+            payload.write(device->getId(bindGroup));
+            payload.write(dynamicOffsetCount);
+            payload.writeBytes(dynamicOffsets, dynamicOffsetCount * sizeof(Uint32));
+        }
+
+        // Swaps the capture buffers for the inner ones once their ids are written
+        void writeBindGroupEntries(CaptureDevice* device, TracePayload& payload, std::vector<BindGroupEntry>& entries) {
+            payload.write(static_cast<uint32_t>(entries.size()));
+
+            for (auto& entry : entries) {
+                payload.write(entry.binding);
+                payload.write(entry.arrayElement);
+                payload.write(getBufferId(entry.buffer.buffer));
+                payload.write(entry.buffer.size);
+                payload.write(entry.buffer.offset);
+                payload.write(device->getId(entry.textureView));
+                payload.write(device->getId(entry.sampler));
+
+                entry.buffer.buffer = unwrapBuffer(entry.buffer.buffer);
+            }
+        }
+    };
+
+    // ===========================================================================================================================
+    // Resources
+    // ===========================================================================================================================
+
+    CaptureBuffer::CaptureBuffer(CaptureDevice* device, std::shared_ptr<Buffer> inner) : device{ device }, inner{ inner } {
+        this->desc = inner->desc;
+        this->mapState = inner->mapState;
+        this->currentMapping = inner->currentMapping;
+        this->id = device->track(this);
+    }
+
+    CaptureBuffer::~CaptureBuffer() {
+        this->device->release(this);
+    }
+
+    void* CaptureBuffer::map(Uint64 size, Uint64 offset) {
+        void* data = this->inner->map(size, offset);
+
+        this->mapState = this->inner->mapState;
+        this->currentMapping = this->inner->currentMapping;
+
+        return data;
+    }
+
+    void CaptureBuffer::unmap() {
+        const ActiveBufferMapping& mapping = this->inner->currentMapping;
+
+        if (this->inner->mapState == BufferMapState::eMapped && mapping.data != nullptr) {
+            TracePayload payload;
+            payload.write(this->id);
+            payload.write(mapping.offset);
+            payload.write(this->device->getWriter()->writeBlob(mapping.data, mapping.size));
+
+            this->device->getWriter()->writeRecord(TraceOp::eBufferData, payload);
+        }
+
+        this->inner->unmap();
+
+        this->mapState = this->inner->mapState;
+        this->currentMapping = this->inner->currentMapping;
+    }
+
+    void CaptureBuffer::flush(Uint64 size, Uint64 offset) {
+        this->inner->flush(size, offset);
+    }
+
+    void CaptureBuffer::invalidate(Uint64 size, Uint64 offset) {
+        this->inner->invalidate(size, offset);
+    }
+
+    CaptureTexture::CaptureTexture(CaptureDevice* device, std::shared_ptr<Texture> inner) : device{ device }, inner{ inner } {
+        this->desc = inner->desc;
+        this->state = inner->state;
+        this->id = device->track(this);
+    }
+
+    CaptureTexture::~CaptureTexture() {
+        this->device->release(this);
+    }
+
+    std::shared_ptr<TextureView> CaptureTexture::createView(TextureViewDescriptor descriptor) {
+        auto view = this->inner->createView(descriptor);
+        if (view == nullptr) {
+            return nullptr;
+        }
+
+        TextureView* object = view.get();
+        CaptureDevice* device = this->device;
+
+        TracePayload payload;
+        payload.write(device->track(object));
+        payload.write(this->id);
+        payload.write(descriptor);
+
+        device->getWriter()->writeRecord(TraceOp::eCreateTextureView, payload);
+
+        return std::shared_ptr<TextureView>(object, [device, view](TextureView*) mutable {
+            device->release(view.get());
+            view.reset();
+        });
+    }
+
+    // ===========================================================================================================================
+    // Pass Encoders
+    // ===========================================================================================================================
+
+    CaptureComputePassEncoder::CaptureComputePassEncoder(CaptureCommandEncoder* encoder, std::shared_ptr<ComputePassEncoder> inner)
+        : encoder{ encoder }, inner{ inner }
+    {
+        this->desc = inner->desc;
+        this->commandEncoder = encoder;
+        this->state = inner->state;
+    }
+
+    void CaptureComputePassEncoder::setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets) {
+        this->setBindGroup(index, bindGroup, dynamicOffsets.data(), 0, static_cast<Uint32>(dynamicOffsets.size()));
+    }
+
+    void CaptureComputePassEncoder::setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
+        Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength)
+    {
+        writeBindGroup(this->encoder->getDevice(), this->encoder->beginRecord(), index, bindGroup,
+            dynamicOffsetsData + dynamicOffsetsDataStart, dynamicOffsetsDataLength);
+        this->encoder->endRecord(TraceOp::eSetBindGroup);
+
+        this->inner->setBindGroup(index, bindGroup, dynamicOffsetsData, dynamicOffsetsDataStart, dynamicOffsetsDataLength);
+    }
+
+    void CaptureComputePassEncoder::setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) {
+        writePushConstants(this->encoder->beginRecord(), visibility, offset, size, data);
+        this->encoder->endRecord(TraceOp::eSetPushConstants);
+
+        this->inner->setPushConstants(visibility, offset, size, data);
+    }
+
+    void CaptureComputePassEncoder::setPipeline(ComputePipeline* pipeline) {
+        this->encoder->beginRecord().write(this->encoder->getDevice()->getId(pipeline));
+        this->encoder->endRecord(TraceOp::eSetPipeline);
+
+        this->inner->setPipeline(pipeline);
+    }
+
+    void CaptureComputePassEncoder::dispatchWorkgroups(Uint32 workgroupCountX, Uint32 workgroupCountY, Uint32 workgroupCountZ) {
+        TracePayload& payload = this->encoder->beginRecord();
+        payload.write(workgroupCountX);
+        payload.write(workgroupCountY);
+        payload.write(workgroupCountZ);
+        this->encoder->endRecord(TraceOp::eDispatch);
+
+        this->inner->dispatchWorkgroups(workgroupCountX, workgroupCountY, workgroupCountZ);
+    }
+
+    void CaptureComputePassEncoder::dispatchWorkgroupsIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) {
+        TracePayload& payload = this->encoder->beginRecord();
+        payload.write(getBufferId(indirectBuffer));
+        payload.write(indirectOffset);
+        this->encoder->endRecord(TraceOp::eDispatchIndirect);
+
+        this->inner->dispatchWorkgroupsIndirect(unwrapBuffer(indirectBuffer), indirectOffset);
+    }
+
+    void CaptureComputePassEncoder::end() {
+        this->encoder->beginRecord();
+        this->encoder->endRecord(TraceOp::eEndPass);
+
+        this->inner->end();
+        this->state = this->inner->state;
+        this->encoder->state = this->encoder->getInner()->state;
+    }
+
+    CaptureRenderPassEncoder::CaptureRenderPassEncoder(CaptureCommandEncoder* encoder, std::shared_ptr<RenderPassEncoder> inner)
+        : encoder{ encoder }, inner{ inner }
+    {
+        this->desc = inner->desc;
+        this->commandEncoder = encoder;
+        this->state = inner->state;
+    }
+
+    void CaptureRenderPassEncoder::setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets) {
+        this->setBindGroup(index, bindGroup, dynamicOffsets.data(), 0, static_cast<Uint32>(dynamicOffsets.size()));
+    }
+
+    void CaptureRenderPassEncoder::setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
+        Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength)
+    {
+        writeBindGroup(this->encoder->getDevice(), this->encoder->beginRecord(), index, bindGroup,
+            dynamicOffsetsData + dynamicOffsetsDataStart, dynamicOffsetsDataLength);
+        this->encoder->endRecord(TraceOp::eSetBindGroup);
+
+        this->inner->setBindGroup(index, bindGroup, dynamicOffsetsData, dynamicOffsetsDataStart, dynamicOffsetsDataLength);
+    }
+
+    void CaptureRenderPassEncoder::setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) {
+        writePushConstants(this->encoder->beginRecord(), visibility, offset, size, data);
+        this->encoder->endRecord(TraceOp::eSetPushConstants);
+
+        this->inner->setPushConstants(visibility, offset, size, data);
+    }
+
+    void CaptureRenderPassEncoder::setPipeline(RenderPipeline* pipeline) {
+        this->encoder->beginRecord().write(this->encoder->getDevice()->getId(pipeline));
+        this->encoder->endRecord(TraceOp::eSetPipeline);
+
+        this->inner->setPipeline(pipeline);
+    }
+
+    void CaptureRenderPassEncoder::setIndexBuffer(Buffer* buffer, IndexFormat indexFormat, Uint64 offset, Uint64 size) {
+        TracePayload& payload = this->encoder->beginRecord();
+        payload.write(getBufferId(buffer));
+        payload.write(indexFormat);
+        payload.write(offset);
+        payload.write(size);
+        this->encoder->endRecord(TraceOp::eSetIndexBuffer);
+
+        this->inner->setIndexBuffer(unwrapBuffer(buffer), indexFormat, offset, size);
+    }
+
+    void CaptureRenderPassEncoder::setVertexBuffer(Uint32 slot, Buffer* buffer, Uint64 offset, Uint64 size) {
+        TracePayload& payload = this->encoder->beginRecord();
+        payload.write(slot);
+        payload.write(getBufferId(buffer));
+        payload.write(offset);
+        payload.write(size);
+        this->encoder->endRecord(TraceOp::eSetVertexBuffer);
+
+        this->inner->setVertexBuffer(slot, unwrapBuffer(buffer), offset, size);
+    }
+
+    void CaptureRenderPassEncoder::draw(Uint32 vertexCount, Uint32 instanceCount, Uint32 firstVertex, Uint32 firstInstance) {
+        TracePayload& payload = this->encoder->beginRecord();
+        payload.write(vertexCount);
+        payload.write(instanceCount);
+        payload.write(firstVertex);
+        payload.write(firstInstance);
+        this->encoder->endRecord(TraceOp::eDraw);
+
+        this->inner->draw(vertexCount, instanceCount, firstVertex, firstInstance);
+    }
+
+    void CaptureRenderPassEncoder::drawIndexed(Uint32 indexCount, Uint32 instanceCount, Uint32 firstIndex, Int32 baseVertex,
+        Uint32 firstInstance)
+    {
+        TracePayload& payload = this->encoder->beginRecord();
+        payload.write(indexCount);
+        payload.write(instanceCount);
+        payload.write(firstIndex);
+        payload.write(baseVertex);
+        payload.write(firstInstance);
+        this->encoder->endRecord(TraceOp::eDrawIndexed);
+
+        this->inner->drawIndexed(indexCount, instanceCount, firstIndex, baseVertex, firstInstance);
+    }
+
+    void CaptureRenderPassEncoder::drawIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) {
+        TracePayload& payload = this->encoder->beginRecord();
+        payload.write(getBufferId(indirectBuffer));
+        payload.write(indirectOffset);
+        this->encoder->endRecord(TraceOp::eDrawIndirect);
+
+        this->inner->drawIndirect(unwrapBuffer(indirectBuffer), indirectOffset);
+    }
+
+    void CaptureRenderPassEncoder::drawIndexedIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) {
+        TracePayload& payload = this->encoder->beginRecord();
+        payload.write(getBufferId(indirectBuffer));
+        payload.write(indirectOffset);
+        this->encoder->endRecord(TraceOp::eDrawIndexedIndirect);
+
+        this->inner->drawIndexedIndirect(unwrapBuffer(indirectBuffer), indirectOffset);
+    }
+
+    void CaptureRenderPassEncoder::setViewport(float x, float y, float width, float height, float minDepth, float maxDepth) {
+        TracePayload& payload = this->encoder->beginRecord();
+        payload.write(Viewport{ x, y, width, height, minDepth, maxDepth });
+        this->encoder->endRecord(TraceOp::eSetViewport);
+
+        this->inner->setViewport(x, y, width, height, minDepth, maxDepth);
+    }
+
+    void CaptureRenderPassEncoder::setScissorRect(Uint32 x, Uint32 y, Uint32 width, Uint32 height) {
+        TracePayload& payload = this->encoder->beginRecord();
+        payload.write(x);
+        payload.write(y);
+        payload.write(width);
+        payload.write(height);
+        this->encoder->endRecord(TraceOp::eSetScissorRect);
+
+        this->inner->setScissorRect(x, y, width, height);
+    }
+
+    void CaptureRenderPassEncoder::setBlendConstant(Color color) {
+        this->encoder->beginRecord().write(color);
+        this->encoder->endRecord(TraceOp::eSetBlendConstant);
+
+        this->inner->setBlendConstant(color);
+    }
+
+    void CaptureRenderPassEncoder::setStencilReference(Uint32 reference) {
+        this->encoder->beginRecord().write(reference);
+        this->encoder->endRecord(TraceOp::eSetStencilReference);
+
+        this->inner->setStencilReference(reference);
+    }
+
+    void CaptureRenderPassEncoder::beginOcclusionQuery(Uint32 queryIndex) {
+        this->encoder->beginRecord().write(queryIndex);
+        this->encoder->endRecord(TraceOp::eBeginOcclusionQuery);
+
+        this->inner->beginOcclusionQuery(queryIndex);
+    }
+
+    void CaptureRenderPassEncoder::endOcclusionQuery() {
+        this->encoder->beginRecord();
+        this->encoder->endRecord(TraceOp::eEndOcclusionQuery);
+
+        this->inner->endOcclusionQuery();
+    }
+
+    void CaptureRenderPassEncoder::end() {
+        this->encoder->beginRecord();
+        this->encoder->endRecord(TraceOp::eEndPass);
+
+        this->inner->end();
+        this->state = this->inner->state;
+        this->encoder->state = this->encoder->getInner()->state;
+    }
+
+    // ===========================================================================================================================
+    // Command Encoder
+    // ===========================================================================================================================
+
+    CaptureCommandEncoder::CaptureCommandEncoder(CaptureDevice* device, std::shared_ptr<CommandEncoder> inner)
+        : device{ device }, inner{ inner }
+    {
+        this->state = inner->state;
+        this->id = device->track(this);
+    }
+
+    CaptureCommandEncoder::~CaptureCommandEncoder() {
+        this->device->release(this);
+    }
+
+    TracePayload& CaptureCommandEncoder::beginRecord() {
+        this->payload.clear();
+        this->payload.write(this->id);
+
+        return this->payload;
+    }
+
+    void CaptureCommandEncoder::endRecord(TraceOp op) {
+        this->device->getWriter()->writeRecord(op, this->payload);
+    }
+
+    std::shared_ptr<RenderPassEncoder> CaptureCommandEncoder::beginRenderPass(RenderPassDescriptor descriptor) {
+        TracePayload& payload = this->beginRecord();
+        payload.write(static_cast<uint32_t>(descriptor.colorAttachments.size()));
+
+        for (const auto& attachment : descriptor.colorAttachments) {
+            payload.write(this->device->getId(attachment.view));
+            payload.write(this->device->getId(attachment.resolveTarget));
+
+            RenderPassColorAttachment stored = attachment;
+            stored.view = nullptr;
+            stored.resolveTarget = nullptr;
+            payload.write(stored);
+        }
+
+        RenderPassDepthStencilAttachment depthStencil = descriptor.depthStencilAttachment;
+        payload.write(this->device->getId(depthStencil.view));
+
+        depthStencil.view = nullptr;
+        payload.write(depthStencil);
+        payload.write(descriptor.maxDrawCount);
+
+        this->endRecord(TraceOp::eBeginRenderPass);
+
+        auto pass = this->inner->beginRenderPass(descriptor);
+        this->state = this->inner->state;
+
+        return std::make_shared<CaptureRenderPassEncoder>(this, pass);
+    }
+
+    std::shared_ptr<ComputePassEncoder> CaptureCommandEncoder::beginComputePass(ComputePassDescriptor descriptor) {
+        this->beginRecord();
+        this->endRecord(TraceOp::eBeginComputePass);
+
+        auto pass = this->inner->beginComputePass(descriptor);
+        this->state = this->inner->state;
+
+        return std::make_shared<CaptureComputePassEncoder>(this, pass);
+    }
+
+    void CaptureCommandEncoder::copyBufferToBuffer(Buffer* source, Uint64 sourceOffset, Buffer* destination, Uint64 destinationOffset,
+        Uint64 size)
+    {
+        TracePayload& payload = this->beginRecord();
+        payload.write(getBufferId(source));
+        payload.write(sourceOffset);
+        payload.write(getBufferId(destination));
+        payload.write(destinationOffset);
+        payload.write(size);
+        this->endRecord(TraceOp::eCopyBufferToBuffer);
+
+        this->inner->copyBufferToBuffer(unwrapBuffer(source), sourceOffset, unwrapBuffer(destination), destinationOffset, size);
+    }
+
+    void CaptureCommandEncoder::copyBufferToTexture(ImageCopyBuffer source, ImageCopyTexture destination, Extent3D copySize) {
+        TracePayload& payload = this->beginRecord();
+        writeImageCopyBuffer(payload, source);
+        writeImageCopyTexture(payload, destination);
+        payload.write(copySize);
+        this->endRecord(TraceOp::eCopyBufferToTexture);
+
+        source.buffer = unwrapBuffer(source.buffer);
+        destination.texture = unwrapTexture(destination.texture);
+        this->inner->copyBufferToTexture(source, destination, copySize);
+    }
+
+    void CaptureCommandEncoder::copyTextureToBuffer(ImageCopyTexture source, ImageCopyBuffer destination, Extent3D copySize) {
+        TracePayload& payload = this->beginRecord();
+        writeImageCopyTexture(payload, source);
+        writeImageCopyBuffer(payload, destination);
+        payload.write(copySize);
+        this->endRecord(TraceOp::eCopyTextureToBuffer);
+
+        source.texture = unwrapTexture(source.texture);
+        destination.buffer = unwrapBuffer(destination.buffer);
+        this->inner->copyTextureToBuffer(source, destination, copySize);
+    }
+
+    void CaptureCommandEncoder::copyTextureToTexture(ImageCopyTexture source, ImageCopyTexture destination, Extent3D copySize) {
+        TracePayload& payload = this->beginRecord();
+        writeImageCopyTexture(payload, source);
+        writeImageCopyTexture(payload, destination);
+        payload.write(copySize);
+        this->endRecord(TraceOp::eCopyTextureToTexture);
+
+        source.texture = unwrapTexture(source.texture);
+        destination.texture = unwrapTexture(destination.texture);
+        this->inner->copyTextureToTexture(source, destination, copySize);
+    }
+
+    void CaptureCommandEncoder::clearBuffer(Buffer* buffer, Uint64 offset, Uint64 size) {
+        TracePayload& payload = this->beginRecord();
+        payload.write(getBufferId(buffer));
+        payload.write(offset);
+        payload.write(size);
+        this->endRecord(TraceOp::eClearBuffer);
+
+        this->inner->clearBuffer(unwrapBuffer(buffer), offset, size);
+    }
+
+    void CaptureCommandEncoder::resolveQuerySet(QuerySet querySet, Uint32 firstQuery, Uint32 queryCount, Buffer* destination,
+        Uint64 destinationOffset)
+    {
+        this->inner->resolveQuerySet(querySet, firstQuery, queryCount, unwrapBuffer(destination), destinationOffset);
+    }
+
+    void CaptureCommandEncoder::activatePipelineBarrier(ShaderStage srcStage, ShaderStage dstStage) {
+        TracePayload& payload = this->beginRecord();
+        payload.write(srcStage);
+        payload.write(dstStage);
+        this->endRecord(TraceOp::ePipelineBarrier);
+
+        this->inner->activatePipelineBarrier(srcStage, dstStage);
+    }
+
+    void CaptureCommandEncoder::activateBufferBarrier(ShaderStage srcStage, ShaderStage dstStage, BufferBarrier desc) {
+        TracePayload& payload = this->beginRecord();
+        payload.write(srcStage);
+        payload.write(dstStage);
+        writeBufferBarrier(payload, desc);
+        this->endRecord(TraceOp::eBufferBarrier);
+
+        desc.buffer = unwrapBuffer(desc.buffer);
+        this->inner->activateBufferBarrier(srcStage, dstStage, desc);
+    }
+
+    void CaptureCommandEncoder::activateImageBarrier(ShaderStage srcStage, ShaderStage dstStage, ImageBarrier desc) {
+        TracePayload& payload = this->beginRecord();
+        payload.write(srcStage);
+        payload.write(dstStage);
+        writeImageBarrier(payload, desc);
+        this->endRecord(TraceOp::eImageBarrier);
+
+        desc.texture = unwrapTexture(desc.texture);
+        this->inner->activateImageBarrier(srcStage, dstStage, desc);
+    }
+
+    void CaptureCommandEncoder::activateBarriers(ShaderStage srcStage, ShaderStage dstStage, const std::vector<BufferBarrier>& bufferBarriers,
+        const std::vector<ImageBarrier>& imageBarriers)
+    {
+        TracePayload& payload = this->beginRecord();
+        payload.write(srcStage);
+        payload.write(dstStage);
+
+        payload.write(static_cast<uint32_t>(bufferBarriers.size()));
+        for (const auto& barrier : bufferBarriers) {
+            writeBufferBarrier(payload, barrier);
+        }
+
+        payload.write(static_cast<uint32_t>(imageBarriers.size()));
+        for (const auto& barrier : imageBarriers) {
+            writeImageBarrier(payload, barrier);
+        }
+
+        this->endRecord(TraceOp::eBarriers);
+
+        std::vector<BufferBarrier> innerBufferBarriers = bufferBarriers;
+        for (auto& barrier : innerBufferBarriers) {
+            barrier.buffer = unwrapBuffer(barrier.buffer);
+        }
+
+        std::vector<ImageBarrier> innerImageBarriers = imageBarriers;
+        for (auto& barrier : innerImageBarriers) {
+            barrier.texture = unwrapTexture(barrier.texture);
+        }
+
+        this->inner->activateBarriers(srcStage, dstStage, innerBufferBarriers, innerImageBarriers);
+    }
+
+    void CaptureCommandEncoder::finish() {
+        this->beginRecord();
+        this->endRecord(TraceOp::eFinish);
+
+        this->inner->finish();
+        this->state = this->inner->state;
+    }
+
+    void CaptureCommandEncoder::reset() {
+        this->beginRecord();
+        this->endRecord(TraceOp::eResetCommandEncoder);
+
+        this->inner->reset();
+        this->state = this->inner->state;
+    }
+
+    // ===========================================================================================================================
+    // Queue
+    // ===========================================================================================================================
+
+    void CaptureQueue::submit(const std::vector<CommandEncoder*>& commandEncoders) {
+        TracePayload payload;
+        payload.write(static_cast<uint32_t>(commandEncoders.size()));
+
+        std::vector<CommandEncoder*> innerEncoders;
+        innerEncoders.reserve(commandEncoders.size());
+
+        for (CommandEncoder* encoder : commandEncoders) {
+            auto* captureEncoder = static_cast<CaptureCommandEncoder*>(encoder);
+
+            payload.write(captureEncoder->getId());
+            innerEncoders.emplace_back(captureEncoder->getInner());
+        }
+
+        this->device->getWriter()->writeRecord(TraceOp::eSubmit, payload);
+        this->inner->submit(innerEncoders);
+    }
+
+    void CaptureQueue::writeBuffer(Buffer* buffer, Uint64 bufferOffset, const void* data, Uint64 size) {
+        TracePayload payload;
+        payload.write(getBufferId(buffer));
+        payload.write(bufferOffset);
+        payload.write(this->device->getWriter()->writeBlob(data, size));
+
+        this->device->getWriter()->writeRecord(TraceOp::eWriteBuffer, payload);
+        this->inner->writeBuffer(unwrapBuffer(buffer), bufferOffset, data, size);
+    }
+
+    void CaptureQueue::writeTexture(ImageCopyTexture destination, const void* data, Uint64 dataSize,
+        ImageDataLayout dataLayout, Extent3D size)
+    {
+        TracePayload payload;
+        writeImageCopyTexture(payload, destination);
+        payload.write(this->device->getWriter()->writeBlob(data, dataSize));
+        payload.write(dataLayout);
+        payload.write(size);
+
+        this->device->getWriter()->writeRecord(TraceOp::eWriteTexture, payload);
+
+        destination.texture = unwrapTexture(destination.texture);
+        this->inner->writeTexture(destination, data, dataSize, dataLayout, size);
+    }
+
+    void CaptureQueue::waitIdle() {
+        this->device->getWriter()->writeRecord(TraceOp::eWaitIdle, TracePayload{});
+        this->inner->waitIdle();
+    }
+
+    // ===========================================================================================================================
+    // Device
+    // ===========================================================================================================================
+
+    CaptureDevice::CaptureDevice(Device* inner, TraceWriter* writer) : inner{ inner }, writer{ writer }, queue{ this, inner->getQueue() } {
+        this->desc = inner->desc;
+    }
+
+    uint32_t CaptureDevice::track(const void* object) {
+        std::lock_guard<std::mutex> lock{ this->mutex };
+
+        auto result = this->ids.emplace(object, this->nextId);
+        if (result.second) {
+            this->nextId++;
+        }
+
+        return result.first->second;
+    }
+
+    void CaptureDevice::release(const void* object) {
+        std::lock_guard<std::mutex> lock{ this->mutex };
+
+        auto found = this->ids.find(object);
+        if (found == this->ids.end()) {
+            return;
+        }
+
+        TracePayload payload;
+        payload.write(found->second);
+
+        this->writer->writeRecord(TraceOp::eDestroy, payload);
+        this->ids.erase(found);
+    }
+
+    uint32_t CaptureDevice::getId(const void* object) const {
+        if (object == nullptr) {
+            return 0;
+        }
+
+        std::lock_guard<std::mutex> lock{ this->mutex };
+
+        auto found = this->ids.find(object);
+        return found != this->ids.end() ? found->second : 0;
+    }
+
+    void CaptureDevice::endFrame() {
+        this->writer->writeRecord(TraceOp::eFrameEnd, TracePayload{});
+    }
+
+    std::shared_ptr<Buffer> CaptureDevice::createBuffer(BufferDescriptor descriptor) {
+        auto inner = this->inner->createBuffer(descriptor);
+        if (inner == nullptr) {
+            return nullptr;
+        }
+
+        auto buffer = std::make_shared<CaptureBuffer>(this, inner);
+
+        TracePayload payload;
+        payload.write(buffer->getId());
+        payload.write(descriptor);
+
+        this->writer->writeRecord(TraceOp::eCreateBuffer, payload);
+        return buffer;
+    }
+
+    std::shared_ptr<Texture> CaptureDevice::createTexture(TextureDescriptor descriptor) {
+        auto inner = this->inner->createTexture(descriptor);
+        if (inner == nullptr) {
+            return nullptr;
+        }
+
+        auto texture = std::make_shared<CaptureTexture>(this, inner);
+
+        TracePayload payload;
+        payload.write(texture->getId());
+        payload.write(descriptor);
+
+        this->writer->writeRecord(TraceOp::eCreateTexture, payload);
+        return texture;
+    }
+
+    std::shared_ptr<Sampler> CaptureDevice::createSampler(SamplerDescriptor descriptor) {
+        uint32_t id;
+        auto sampler = this->passThrough(this->inner->createSampler(descriptor), id);
+
+        if (sampler != nullptr) {
+            TracePayload payload;
+            payload.write(id);
+            payload.write(descriptor);
+
+            this->writer->writeRecord(TraceOp::eCreateSampler, payload);
+        }
+
+        return sampler;
+    }
+
+    std::shared_ptr<BindGroup> CaptureDevice::createBindGroup(BindGroupDescriptor descriptor) {
+        TracePayload payload;
+        payload.write(this->getId(descriptor.layout));
+        writeBindGroupEntries(this, payload, descriptor.entries);
+
+        uint32_t id;
+        auto bindGroup = this->passThrough(this->inner->createBindGroup(descriptor), id);
+
+        if (bindGroup != nullptr) {
+            TracePayload record;
+            record.write(id);
+            record.writeBytes(payload.getData(), payload.getSize());
+
+            this->writer->writeRecord(TraceOp::eCreateBindGroup, record);
+        }
+
+        return bindGroup;
+    }
+
+    void CaptureDevice::updateBindGroup(BindGroup* bindGroup, const std::vector<BindGroupEntry>& entries) {
+        std::vector<BindGroupEntry> unwrapped = entries;
+
+        TracePayload payload;
+        payload.write(this->getId(bindGroup));
+        writeBindGroupEntries(this, payload, unwrapped);
+
+        this->writer->writeRecord(TraceOp::eUpdateBindGroup, payload);
+        this->inner->updateBindGroup(bindGroup, unwrapped);
+    }
+
+    std::shared_ptr<BindGroupLayout> CaptureDevice::createBindGroupLayout(BindGroupLayoutDescriptor descriptor) {
+        uint32_t id;
+        auto layout = this->passThrough(this->inner->createBindGroupLayout(descriptor), id);
+
+        if (layout != nullptr) {
+            TracePayload payload;
+            payload.write(id);
+            payload.write(static_cast<uint32_t>(descriptor.entries.size()));
+
+            for (const auto& entry : descriptor.entries) {
+                payload.write(entry);
+            }
+
+            this->writer->writeRecord(TraceOp::eCreateBindGroupLayout, payload);
+        }
+
+        return layout;
+    }
+
+    std::shared_ptr<PipelineLayout> CaptureDevice::createPipelineLayout(PipelineLayoutDescriptor descriptor) {
+        uint32_t id;
+        auto layout = this->passThrough(this->inner->createPipelineLayout(descriptor), id);
+
+        if (layout != nullptr) {
+            TracePayload payload;
+            payload.write(id);
+            payload.write(static_cast<uint32_t>(descriptor.bindGroupLayouts.size()));
+
+            for (BindGroupLayout* bindGroupLayout : descriptor.bindGroupLayouts) {
+                payload.write(this->getId(bindGroupLayout));
+            }
+
+            payload.write(static_cast<uint32_t>(descriptor.pushConstantRanges.size()));
+            for (const auto& range : descriptor.pushConstantRanges) {
+                payload.write(range);
+            }
+
+            this->writer->writeRecord(TraceOp::eCreatePipelineLayout, payload);
+        }
+
+        return layout;
+    }
+
+    std::shared_ptr<ShaderModule> CaptureDevice::createShaderModule(ShaderModuleDescriptor descriptor) {
+        uint32_t id;
+        auto module = this->passThrough(this->inner->createShaderModule(descriptor), id);
+
+        if (module != nullptr) {
+            // Source is stored with its terminator so the replayed module sees the same string
+            Uint64 codeBytes = descriptor.codeSize != 0 ? descriptor.codeSize : std::strlen(descriptor.code) + 1;
+
+            TracePayload payload;
+            payload.write(id);
+            payload.write(this->writer->writeBlob(descriptor.code, codeBytes));
+            payload.write(descriptor.codeSize);
+
+            this->writer->writeRecord(TraceOp::eCreateShaderModule, payload);
+        }
+
+        return module;
+    }
+
+    void CaptureDevice::writeDerivedLayouts(TracePayload& payload, PipelineBase* pipeline, bool derived,
+        std::vector<const void*>& tracked)
+    {
+        if (!derived || pipeline->layout == nullptr) {
+            payload.write<uint32_t>(0);
+            payload.write<uint32_t>(0);
+            return;
+        }
+
+        auto trackDerived = [this, &tracked](const void* object) {
+            bool known = this->getId(object) != 0;
+            uint32_t id = this->track(object);
+
+            if (!known) {
+                tracked.emplace_back(object);
+            }
+
+            return id;
+        };
+
+        const auto& bindGroupLayouts = pipeline->layout->desc.bindGroupLayouts;
+
+        payload.write(trackDerived(pipeline->layout));
+        payload.write(static_cast<uint32_t>(bindGroupLayouts.size()));
+
+        for (BindGroupLayout* bindGroupLayout : bindGroupLayouts) {
+            payload.write(bindGroupLayout != nullptr ? trackDerived(bindGroupLayout) : 0);
+        }
+    }
+
+    std::shared_ptr<ComputePipeline> CaptureDevice::createComputePipeline(ComputePipelineDescriptor descriptor) {
+        auto pipeline = this->inner->createComputePipeline(descriptor);
+        if (pipeline == nullptr) {
+            return nullptr;
+        }
+
+        std::vector<const void*> tracked;
+        tracked.emplace_back(pipeline.get());
+
+        TracePayload payload;
+        payload.write(this->track(pipeline.get()));
+        payload.write(this->getId(descriptor.layout));
+        writeStage(this, payload, descriptor.compute);
+        this->writeDerivedLayouts(payload, pipeline.get(), descriptor.layout == nullptr, tracked);
+
+        this->writer->writeRecord(TraceOp::eCreateComputePipeline, payload);
+
+        ComputePipeline* object = pipeline.get();
+        return std::shared_ptr<ComputePipeline>(object, [this, pipeline, tracked](ComputePipeline*) mutable {
+            for (const void* trackedObject : tracked) {
+                this->release(trackedObject);
+            }
+
+            pipeline.reset();
+        });
+    }
+
+    std::shared_ptr<RenderPipeline> CaptureDevice::createRenderPipeline(RenderPipelineDescriptor descriptor) {
+        auto pipeline = this->inner->createRenderPipeline(descriptor);
+        if (pipeline == nullptr) {
+            return nullptr;
+        }
+
+        std::vector<const void*> tracked;
+        tracked.emplace_back(pipeline.get());
+
+        TracePayload payload;
+        payload.write(this->track(pipeline.get()));
+        payload.write(this->getId(descriptor.layout));
+
+        writeStage(this, payload, descriptor.vertex);
+        payload.write(static_cast<uint32_t>(descriptor.vertex.buffers.size()));
+
+        for (const auto& buffer : descriptor.vertex.buffers) {
+            payload.write(buffer.arrayStride);
+            payload.write(buffer.stepMode);
+            payload.write(static_cast<uint32_t>(buffer.attributes.size()));
+
+            for (const auto& attribute : buffer.attributes) {
+                payload.write(attribute);
+            }
+        }
+
+        writeStage(this, payload, descriptor.fragment);
+        payload.write(static_cast<uint32_t>(descriptor.fragment.targets.size()));
+
+        for (const auto& target : descriptor.fragment.targets) {
+            payload.write(target);
+        }
+
+        payload.write(descriptor.depthStencil);
+        payload.write(descriptor.primitive);
+        payload.write(descriptor.rasterizationState);
+        payload.write(descriptor.multisample);
+        this->writeDerivedLayouts(payload, pipeline.get(), descriptor.layout == nullptr, tracked);
+
+        this->writer->writeRecord(TraceOp::eCreateRenderPipeline, payload);
+
+        RenderPipeline* object = pipeline.get();
+        return std::shared_ptr<RenderPipeline>(object, [this, pipeline, tracked](RenderPipeline*) mutable {
+            for (const void* trackedObject : tracked) {
+                this->release(trackedObject);
+            }
+
+            pipeline.reset();
+        });
+    }
+
+    std::shared_ptr<CommandEncoder> CaptureDevice::createCommandEncoder() {
+        auto inner = this->inner->createCommandEncoder();
+        if (inner == nullptr) {
+            return nullptr;
+        }
+
+        auto encoder = std::make_shared<CaptureCommandEncoder>(this, inner);
+
+        TracePayload payload;
+        payload.write(encoder->getId());
+
+        this->writer->writeRecord(TraceOp::eCreateCommandEncoder, payload);
+        return encoder;
+    }
+};
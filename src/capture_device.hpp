@@ -0,0 +1,233 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "trace.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Capture Device
+    // ===========================================================================================================================
+
+    // Wraps another device and writes every resource creation, encoder command and queue
+    // operation into a trace while forwarding the call. Buffers, textures, encoders and the
+    // queue are wrapped, every other object is the inner one, so pipelines and bind groups
+    // can be inspected as usual. Objects created here must not outlive the capture device.
+
+    class CaptureDevice;
+
+    class CaptureBuffer : public Buffer {
+    public:
+        CaptureBuffer(CaptureDevice* device, std::shared_ptr<Buffer> inner);
+        ~CaptureBuffer();
+
+        void* map(Uint64 size = ULLONG_MAX, Uint64 offset = 0) override;
+
+        // Stores the mapped range, anything written through the mapping is replayed
+        void unmap() override;
+
+        void flush(Uint64 size = ULLONG_MAX, Uint64 offset = 0) override;
+        void invalidate(Uint64 size = ULLONG_MAX, Uint64 offset = 0) override;
+
+        Buffer* getInner() const { return this->inner.get(); }
+        uint32_t getId() const { return this->id; }
+
+    private:
+        CaptureDevice* device;
+        std::shared_ptr<Buffer> inner;
+        uint32_t id;
+    };
+
+    class CaptureTexture : public Texture {
+    public:
+        CaptureTexture(CaptureDevice* device, std::shared_ptr<Texture> inner);
+        ~CaptureTexture();
+
+        std::shared_ptr<TextureView> createView(TextureViewDescriptor descriptor) override;
+
+        Texture* getInner() const { return this->inner.get(); }
+        uint32_t getId() const { return this->id; }
+
+    private:
+        CaptureDevice* device;
+        std::shared_ptr<Texture> inner;
+        uint32_t id;
+    };
+
+    class CaptureCommandEncoder;
+
+    class CaptureComputePassEncoder : public ComputePassEncoder {
+    public:
+        CaptureComputePassEncoder(CaptureCommandEncoder* encoder, std::shared_ptr<ComputePassEncoder> inner);
+
+        void setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets = {}) override;
+        void setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
+            Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength) override;
+        void setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) override;
+
+        void setPipeline(ComputePipeline* pipeline) override;
+        void dispatchWorkgroups(Uint32 workgroupCountX, Uint32 workgroupCountY = 1, Uint32 workgroupCountZ = 1) override;
+        void dispatchWorkgroupsIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) override;
+
+        void end() override;
+
+    private:
+        CaptureCommandEncoder* encoder;
+        std::shared_ptr<ComputePassEncoder> inner;
+    };
+
+    class CaptureRenderPassEncoder : public RenderPassEncoder {
+    public:
+        CaptureRenderPassEncoder(CaptureCommandEncoder* encoder, std::shared_ptr<RenderPassEncoder> inner);
+
+        void setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets = {}) override;
+        void setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
+            Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength) override;
+        void setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) override;
+
+        void setPipeline(RenderPipeline* pipeline) override;
+        void setIndexBuffer(Buffer* buffer, IndexFormat indexFormat, Uint64 offset = 0, Uint64 size = ULLONG_MAX) override;
+        void setVertexBuffer(Uint32 slot, Buffer* buffer, Uint64 offset = 0, Uint64 size = ULLONG_MAX) override;
+
+        void draw(Uint32 vertexCount, Uint32 instanceCount = 1, Uint32 firstVertex = 0, Uint32 firstInstance = 0) override;
+        void drawIndexed(Uint32 indexCount, Uint32 instanceCount = 1, Uint32 firstIndex = 0, Int32 baseVertex = 0,
+            Uint32 firstInstance = 0) override;
+
+        void drawIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) override;
+        void drawIndexedIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) override;
+
+        void setViewport(float x, float y, float width, float height, float minDepth, float maxDepth) override;
+        void setScissorRect(Uint32 x, Uint32 y, Uint32 width, Uint32 height) override;
+        void setBlendConstant(Color color) override;
+        void setStencilReference(Uint32 reference) override;
+
+        void beginOcclusionQuery(Uint32 queryIndex) override;
+        void endOcclusionQuery() override;
+
+        void end() override;
+
+    private:
+        CaptureCommandEncoder* encoder;
+        std::shared_ptr<RenderPassEncoder> inner;
+    };
+
+    class CaptureCommandEncoder : public CommandEncoder {
+    public:
+        CaptureCommandEncoder(CaptureDevice* device, std::shared_ptr<CommandEncoder> inner);
+        ~CaptureCommandEncoder();
+
+        std::shared_ptr<RenderPassEncoder> beginRenderPass(RenderPassDescriptor descriptor) override;
+        std::shared_ptr<ComputePassEncoder> beginComputePass(ComputePassDescriptor descriptor) override;
+
+        void copyBufferToBuffer(Buffer* source, Uint64 sourceOffset, Buffer* destination, Uint64 destinationOffset,
+            Uint64 size) override;
+        void copyBufferToTexture(ImageCopyBuffer source, ImageCopyTexture destination, Extent3D copySize) override;
+        void copyTextureToBuffer(ImageCopyTexture source, ImageCopyBuffer destination, Extent3D copySize) override;
+        void copyTextureToTexture(ImageCopyTexture source, ImageCopyTexture destination, Extent3D copySize) override;
+        void clearBuffer(Buffer* buffer, Uint64 offset = 0, Uint64 size = ULLONG_MAX) override;
+
+        // Query sets have no creation path in the RHI yet, resolves are forwarded but not captured
+        void resolveQuerySet(QuerySet querySet, Uint32 firstQuery, Uint32 queryCount, Buffer* destination,
+            Uint64 destinationOffset) override;
+
+        void activatePipelineBarrier(ShaderStage srcStage, ShaderStage dstStage) override;
+        void activateBufferBarrier(ShaderStage srcStage, ShaderStage dstStage, BufferBarrier desc) override;
+        void activateImageBarrier(ShaderStage srcStage, ShaderStage dstStage, ImageBarrier desc) override;
+        void activateBarriers(ShaderStage srcStage, ShaderStage dstStage, const std::vector<BufferBarrier>& bufferBarriers,
+            const std::vector<ImageBarrier>& imageBarriers) override;
+
+        void finish() override;
+        void reset() override;
+
+        CommandEncoder* getInner() const { return this->inner.get(); }
+        CaptureDevice* getDevice() const { return this->device; }
+        uint32_t getId() const { return this->id; }
+
+        // Starts a record addressed to this encoder, passes record through their encoder
+        TracePayload& beginRecord();
+        void endRecord(TraceOp op);
+
+    private:
+        CaptureDevice* device;
+        std::shared_ptr<CommandEncoder> inner;
+
+        uint32_t id;
+        TracePayload payload;
+    };
+
+    class CaptureQueue : public Queue {
+    public:
+        CaptureQueue(CaptureDevice* device, Queue* inner) : device{ device }, inner{ inner } {}
+
+        void submit(const std::vector<CommandEncoder*>& commandEncoders) override;
+        void writeBuffer(Buffer* buffer, Uint64 bufferOffset, const void* data, Uint64 size) override;
+        void writeTexture(ImageCopyTexture destination, const void* data, Uint64 dataSize,
+            ImageDataLayout dataLayout, Extent3D size) override;
+        void waitIdle() override;
+
+    private:
+        CaptureDevice* device;
+        Queue* inner;
+    };
+
+    class CaptureDevice : public Device {
+    public:
+        CaptureDevice(Device* inner, TraceWriter* writer);
+
+        Queue* getQueue() override { return &this->queue; }
+
+        std::shared_ptr<Buffer> createBuffer(BufferDescriptor descriptor) override;
+        std::shared_ptr<Texture> createTexture(TextureDescriptor descriptor) override;
+        std::shared_ptr<Sampler> createSampler(SamplerDescriptor descriptor) override;
+        std::shared_ptr<BindGroup> createBindGroup(BindGroupDescriptor descriptor) override;
+        void updateBindGroup(BindGroup* bindGroup, const std::vector<BindGroupEntry>& entries) override;
+        std::shared_ptr<BindGroupLayout> createBindGroupLayout(BindGroupLayoutDescriptor descriptor) override;
+        std::shared_ptr<PipelineLayout> createPipelineLayout(PipelineLayoutDescriptor descriptor) override;
+        std::shared_ptr<ShaderModule> createShaderModule(ShaderModuleDescriptor descriptor) override;
+        std::shared_ptr<ComputePipeline> createComputePipeline(ComputePipelineDescriptor descriptor) override;
+        std::shared_ptr<RenderPipeline> createRenderPipeline(RenderPipelineDescriptor descriptor) override;
+        std::shared_ptr<CommandEncoder> createCommandEncoder() override;
+
+        // Marks a frame boundary, the replayer reports timings per frame
+        void endFrame();
+
+        // Used by the capture wrappers
+        uint32_t track(const void* object);
+        void release(const void* object);
+        uint32_t getId(const void* object) const;
+
+        TraceWriter* getWriter() const { return this->writer; }
+
+    private:
+        // The returned object is the inner one, dropping the last reference records its destruction
+        template <typename T>
+        std::shared_ptr<T> passThrough(std::shared_ptr<T> inner, uint32_t& id) {
+            if (inner == nullptr) {
+                id = 0;
+                return nullptr;
+            }
+
+            id = this->track(inner.get());
+
+            T* object = inner.get();
+            return std::shared_ptr<T>(object, [this, inner](T*) mutable {
+                this->release(inner.get());
+                inner.reset();
+            });
+        }
+
+        // Pipeline layouts a backend derived from reflection have no creation record, they are
+        // tracked for as long as the pipeline lives and recreated by the replayed pipeline
+        void writeDerivedLayouts(TracePayload& payload, PipelineBase* pipeline, bool derived, std::vector<const void*>& tracked);
+
+        Device* inner;
+        TraceWriter* writer;
+        CaptureQueue queue;
+
+        mutable std::mutex mutex;
+        std::unordered_map<const void*, uint32_t> ids;
+        uint32_t nextId = 1;
+    };
+};
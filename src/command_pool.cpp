@@ -0,0 +1,48 @@
+#include "command_pool.hpp"
+
+#include <algorithm>
+
+namespace Rhi {
+    CommandEncoderPool::CommandEncoderPool(Device* device, CommandEncoderPoolDescriptor descriptor) : device{ device }, desc{ descriptor } {
+        this->desc.framesInFlight = std::max<Uint32>(1, this->desc.framesInFlight);
+
+        this->frames.reset(new Frame[this->desc.framesInFlight]);
+        this->current = &this->frames[0];
+    }
+
+    void CommandEncoderPool::beginFrame(Uint64 frameIndex) {
+        this->current = &this->frames[frameIndex % this->desc.framesInFlight];
+
+        for (size_t i = 0; i < this->current->usedCount; i++) {
+            this->current->encoders[i]->reset();
+        }
+
+        this->current->usedCount = 0;
+    }
+
+    CommandEncoder* CommandEncoderPool::acquire() {
+        Frame* frame = this->current;
+
+        if (frame->usedCount == frame->encoders.size()) {
+            auto encoder = this->device->createCommandEncoder();
+
+            if (encoder == nullptr) {
+                return nullptr;
+            }
+
+            frame->encoders.push_back(std::move(encoder));
+        }
+
+        return frame->encoders[frame->usedCount++].get();
+    }
+
+    Uint32 CommandEncoderPool::getEncoderCount() const {
+        size_t count = 0;
+
+        for (Uint32 i = 0; i < this->desc.framesInFlight; i++) {
+            count += this->frames[i].encoders.size();
+        }
+
+        return static_cast<Uint32>(count);
+    }
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "rhi.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Command Encoder Pool
+    // ===========================================================================================================================
+
+    struct CommandEncoderPoolDescriptor {
+        Uint32 framesInFlight = 3;
+    };
+
+    // Command encoders recycled per frame. Every frame slot keeps the encoders handed out for it,
+    // and when the slot comes round again they are reset in one go and handed out again, so a
+    // steady frame creates no encoders and keeps their command memory. Pass encoders come from
+    // the command encoder itself, see CommandEncoder::beginRenderPass.
+    //
+    // One pool per recording thread.
+    class CommandEncoderPool {
+    public:
+        CommandEncoderPool(Device* device, CommandEncoderPoolDescriptor descriptor = {});
+
+        // Resets the encoders of frameIndex - framesInFlight, which must have completed
+        void beginFrame(Uint64 frameIndex);
+
+        // Open encoder owned by the pool, valid until its frame slot is begun again
+        CommandEncoder* acquire();
+
+        Uint32 getEncoderCount() const;
+
+    private:
+        struct Frame {
+            std::vector<std::shared_ptr<CommandEncoder>> encoders;
+            size_t usedCount = 0;
+        };
+
+        Device* device;
+        CommandEncoderPoolDescriptor desc;
+
+        std::unique_ptr<Frame[]> frames;
+        Frame* current;
+    };
+};
@@ -0,0 +1,4015 @@
+#include "compute_kernel.hpp"
+#include "hash.hpp"
+#include "shader_reflection.hpp"
+#include "specialization.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define RHI_COMPUTE_X86
+
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define RHI_TARGET_AVX2
+    #else
+        #define RHI_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+// Lane loops are inlined into the handler of each instruction set, so every copy is compiled
+// for the vector width of its handler
+#if defined(_MSC_VER) && !defined(__clang__)
+    #define RHI_LANES_INLINE __forceinline
+#else
+    #define RHI_LANES_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Lane Program
+    // ===========================================================================================================================
+
+    struct ComputeWarp;
+    struct ComputeInstruction;
+
+    typedef void (*ComputeHandler)(ComputeWarp& warp, const ComputeInstruction& instruction);
+
+    // Operands and the result are slots, immediate and extra are handler specific
+    struct ComputeInstruction {
+        ComputeHandler execute;
+        uint32_t result;
+        uint32_t operands[4];
+        uint32_t immediate;
+        uint32_t extra;
+    };
+
+    // Instructions [first, end) of the program, the last one a terminator
+    struct ComputeBlock {
+        uint32_t first;
+        uint32_t end;
+    };
+
+    struct ComputeSwitch {
+        uint32_t defaultTarget;
+        std::vector<std::pair<uint32_t, uint32_t>> cases;
+    };
+
+    struct alignas(64) ComputeSlot {
+        uint32_t lanes[kComputeLanes];
+    };
+
+    // Shared spaces are addressed alike by every lane. Interleaved spaces keep the words of the
+    // lanes side by side, lane i addressing data + i * 4 + offset, so one word of a lane spans
+    // kComputeLanes words of the space. Offsets from limit on are out of bounds for every lane.
+    struct ComputeSpace {
+        uint8_t* data;
+        Uint64 limit;
+        bool interleaved;
+    };
+
+    struct ComputeProgram {
+        std::vector<ComputeInstruction> instructions;
+        std::vector<ComputeBlock> blocks;
+        std::vector<ComputeSwitch> switches;
+
+        // Slots holding a constant, the value broadcast to every lane
+        std::vector<std::pair<uint32_t, uint32_t>> constants;
+        uint32_t slotCount = 0;
+
+        Uint64 workgroupBytes = 0;
+
+        // Private and function variables take privateBytes per lane, privateImage holding their
+        // initial value for every lane, interleaved
+        Uint64 privateBytes = 0;
+        std::vector<uint8_t> privateImage;
+
+        bool hasBarriers = false;
+        bool vectorized = false;
+    };
+
+    // Lanes wait at the block in pc, having left the block in previous. The block running is
+    // in block, active holding ~0 for the lanes running it and 0 for the others.
+    struct ComputeWarp {
+        const ComputeProgram* program;
+        ComputeSlot* slots;
+        const ComputeSpace* spaces;
+        uint32_t block;
+
+        alignas(64) uint32_t pc[kComputeLanes];
+        alignas(64) uint32_t previous[kComputeLanes];
+        alignas(64) uint32_t active[kComputeLanes];
+    };
+
+    namespace {
+        constexpr uint32_t kNoSlot = UINT32_MAX;
+
+        // pc of finished lanes, and the bit set on the pc of lanes waiting at a barrier
+        constexpr uint32_t kDone = UINT32_MAX;
+        constexpr uint32_t kWaitBit = 0x80000000u;
+
+        // Memory spaces of every kernel, the buffer bindings follow in getBindings() order
+        constexpr uint32_t kPushSpace = 0;
+        constexpr uint32_t kWorkgroupSpace = 1;
+        constexpr uint32_t kPrivateSpace = 2;
+        constexpr uint32_t kInputSpace = 3;
+        constexpr uint32_t kBindingSpaces = 4;
+
+        // Built-in inputs of one lane, byte offsets into the input space
+        constexpr uint32_t kInputLocalId = 0;
+        constexpr uint32_t kInputGlobalId = 12;
+        constexpr uint32_t kInputWorkgroupId = 24;
+        constexpr uint32_t kInputNumWorkgroups = 36;
+        constexpr uint32_t kInputLocalIndex = 48;
+        constexpr uint32_t kInputSubgroupSize = 52;
+        constexpr uint32_t kInputSubgroupLocalId = 56;
+        constexpr uint32_t kInputNumSubgroups = 60;
+        constexpr uint32_t kInputSubgroupId = 64;
+        constexpr uint32_t kInputStride = 68;
+
+        bool detectAvx2() {
+#if !defined(RHI_COMPUTE_X86)
+            return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 1);
+
+            // The OS must save the YMM registers on context switches
+            bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+
+            __cpuidex(info, 7, 0);
+            return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+
+        const bool kHasAvx2 = detectAvx2();
+
+        // ===========================================================================================================================
+        // Lane Values
+        // ===========================================================================================================================
+
+        // Bools are masks: ~0 for true, 0 for false
+
+        RHI_LANES_INLINE float toFloat(uint32_t bits) {
+            float value;
+            std::memcpy(&value, &bits, 4);
+            return value;
+        }
+
+        RHI_LANES_INLINE uint32_t toBits(float value) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, 4);
+            return bits;
+        }
+
+        RHI_LANES_INLINE uint32_t toMask(bool condition) {
+            return 0u - static_cast<uint32_t>(condition);
+        }
+
+        RHI_LANES_INLINE uint32_t blend(uint32_t value, uint32_t old, uint32_t mask) {
+            return (value & mask) | (old & ~mask);
+        }
+
+        RHI_LANES_INLINE int32_t toSigned(uint32_t value) {
+            return static_cast<int32_t>(value);
+        }
+
+        // Ones in the low count bits, count up to 32
+        RHI_LANES_INLINE uint32_t lowBits(uint32_t count) {
+            return count >= 32 ? ~0u : (1u << (count & 31)) - 1u;
+        }
+
+        RHI_LANES_INLINE uint32_t countBits(uint32_t value) {
+            value = value - ((value >> 1) & 0x55555555u);
+            value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+            value = (value + (value >> 4)) & 0x0F0F0F0Fu;
+            return (value * 0x01010101u) >> 24;
+        }
+
+        RHI_LANES_INLINE uint32_t reverseBits(uint32_t value) {
+            value = ((value >> 1) & 0x55555555u) | ((value & 0x55555555u) << 1);
+            value = ((value >> 2) & 0x33333333u) | ((value & 0x33333333u) << 2);
+            value = ((value >> 4) & 0x0F0F0F0Fu) | ((value & 0x0F0F0F0Fu) << 4);
+            value = ((value >> 8) & 0x00FF00FFu) | ((value & 0x00FF00FFu) << 8);
+            return (value >> 16) | (value << 16);
+        }
+
+        // Index of the highest and lowest set bit, ~0 for zero
+        RHI_LANES_INLINE uint32_t findMsb(uint32_t value) {
+            uint32_t index = ~0u;
+            for (uint32_t bit = 0; bit < 32; bit++) {
+                index = (value >> bit) & 1u ? bit : index;
+            }
+            return index;
+        }
+
+        RHI_LANES_INLINE uint32_t findLsb(uint32_t value) {
+            uint32_t index = ~0u;
+            for (uint32_t bit = 32; bit-- > 0;) {
+                index = (value >> bit) & 1u ? bit : index;
+            }
+            return index;
+        }
+
+        // Round to nearest even, overflow to infinity, NaN stays NaN
+        RHI_LANES_INLINE uint32_t floatToHalf(float value) {
+            const uint32_t denormalMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+
+            uint32_t bits = toBits(value);
+            uint32_t sign = (bits >> 16) & 0x8000u;
+            bits &= 0x7FFFFFFFu;
+
+            if (bits >= (127u + 16u) << 23) {
+                return sign | (bits > 0x7F800000u ? 0x7E00u : 0x7C00u);
+            }
+
+            if (bits < 113u << 23) {
+                return sign | (toBits(toFloat(bits) + toFloat(denormalMagic)) - denormalMagic);
+            }
+
+            uint32_t odd = (bits >> 13) & 1u;
+            bits += (static_cast<uint32_t>(15 - 127) << 23) + 0xFFFu + odd;
+            return sign | (bits >> 13);
+        }
+
+        // Moves the exponent and mantissa in place and rebiases with one multiply, which also
+        // turns half denormals into float normals
+        RHI_LANES_INLINE float halfToFloat(uint32_t half) {
+            uint32_t magnitude = half & 0x7FFFu;
+            uint32_t sign = (half & 0x8000u) << 16;
+
+            uint32_t bits = toBits(toFloat(magnitude << 13) * 5.192296858534828e33f);    // 2^112
+            bits = magnitude >= 0x7C00u ? 0x7F800000u | (magnitude & 0x3FFu) << 13 : bits;
+            return toFloat(bits | sign);
+        }
+
+        RHI_LANES_INLINE float clampFloat(float value, float low, float high) {
+            return std::min(std::max(value, low), high);
+        }
+
+        RHI_LANES_INLINE uint32_t packUnorm(float value, float scale) {
+            return static_cast<uint32_t>(std::nearbyint(clampFloat(value, 0.0f, 1.0f) * scale));
+        }
+
+        RHI_LANES_INLINE uint32_t packSnorm(float value, float scale, uint32_t bits) {
+            return static_cast<uint32_t>(static_cast<int32_t>(std::nearbyint(clampFloat(value, -1.0f, 1.0f) * scale))) & lowBits(bits);
+        }
+
+        RHI_LANES_INLINE float unpackSnorm(uint32_t value, uint32_t bits, float scale) {
+            int32_t sign = toSigned(value << (32 - bits)) >> (32 - bits);
+            return clampFloat(static_cast<float>(sign) / scale, -1.0f, 1.0f);
+        }
+
+        // ===========================================================================================================================
+        // Operations
+        // ===========================================================================================================================
+
+        // One lane of an instruction. Binary operations used by subgroup arithmetic also name
+        // the identity of their reduction.
+
+        struct SNegate { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return 0u - a; } };
+        struct FNegate { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return a ^ 0x80000000u; } };
+        struct Not { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return ~a; } };
+        struct Copy { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return a; } };
+        struct BitCount { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return countBits(a); } };
+        struct BitReverse { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return reverseBits(a); } };
+        struct IsNan { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toMask((a & 0x7FFFFFFFu) > 0x7F800000u); } };
+        struct IsInf { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toMask((a & 0x7FFFFFFFu) == 0x7F800000u); } };
+        struct ConvertSToF { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(static_cast<float>(toSigned(a))); } };
+        struct ConvertUToF { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(static_cast<float>(a)); } };
+
+        // Saturating, NaN converts to 0
+        struct ConvertFToS {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t a) {
+                float value = toFloat(a);
+                int32_t converted = static_cast<int32_t>(clampFloat(value == value ? value : 0.0f, -2147483648.0f, 2147483520.0f));
+                return value >= 2147483648.0f ? 0x7FFFFFFFu : static_cast<uint32_t>(converted);
+            }
+        };
+
+        struct ConvertFToU {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t a) {
+                float value = toFloat(a);
+                uint32_t converted = static_cast<uint32_t>(clampFloat(value == value ? value : 0.0f, 0.0f, 4294967040.0f));
+                return value >= 4294967296.0f ? ~0u : converted;
+            }
+        };
+
+        struct IAdd { static constexpr uint32_t kIdentity = 0; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return a + b; } };
+        struct ISub { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return a - b; } };
+        struct IMul { static constexpr uint32_t kIdentity = 1; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return a * b; } };
+        struct FAdd { static constexpr uint32_t kIdentity = 0; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toBits(toFloat(a) + toFloat(b)); } };
+        struct FSub { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toBits(toFloat(a) - toFloat(b)); } };
+        struct FMul { static constexpr uint32_t kIdentity = 0x3F800000u; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toBits(toFloat(a) * toFloat(b)); } };
+        struct FDiv { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toBits(toFloat(a) / toFloat(b)); } };
+        struct FRem { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toBits(std::fmod(toFloat(a), toFloat(b))); } };
+
+        struct FMod {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) {
+                return toBits(toFloat(a) - toFloat(b) * std::floor(toFloat(a) / toFloat(b)));
+            }
+        };
+
+        // Division by zero gives ~0 as D3D defines it, INT_MIN / -1 wraps. The divisor is made
+        // safe before dividing so the lanes need no branches.
+        struct UDiv {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) {
+                return b == 0 ? ~0u : a / (b == 0 ? 1u : b);
+            }
+        };
+
+        struct UMod {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) {
+                return b == 0 ? ~0u : a % (b == 0 ? 1u : b);
+            }
+        };
+
+        RHI_LANES_INLINE int32_t safeDivisor(int32_t a, int32_t b) {
+            return b == 0 || (a == std::numeric_limits<int32_t>::min() && b == -1) ? 1 : b;
+        }
+
+        struct SDiv {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) {
+                return b == 0 ? ~0u : static_cast<uint32_t>(toSigned(a) / safeDivisor(toSigned(a), toSigned(b)));
+            }
+        };
+
+        // Sign of the dividend
+        struct SRem {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) {
+                return b == 0 ? ~0u : static_cast<uint32_t>(toSigned(a) % safeDivisor(toSigned(a), toSigned(b)));
+            }
+        };
+
+        // Sign of the divisor
+        struct SMod {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) {
+                int32_t remainder = toSigned(a) % safeDivisor(toSigned(a), toSigned(b));
+                remainder += remainder != 0 && (remainder ^ toSigned(b)) < 0 ? toSigned(b) : 0;
+                return b == 0 ? ~0u : static_cast<uint32_t>(remainder);
+            }
+        };
+
+        struct ShiftLeftLogical { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return a << (b & 31); } };
+        struct ShiftRightLogical { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return a >> (b & 31); } };
+        struct ShiftRightArithmetic { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return static_cast<uint32_t>(toSigned(a) >> (b & 31)); } };
+        struct BitwiseAnd { static constexpr uint32_t kIdentity = ~0u; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return a & b; } };
+        struct BitwiseOr { static constexpr uint32_t kIdentity = 0; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return a | b; } };
+        struct BitwiseXor { static constexpr uint32_t kIdentity = 0; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return a ^ b; } };
+        struct LogicalEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return ~(a ^ b); } };
+
+        struct IEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(a == b); } };
+        struct INotEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(a != b); } };
+        struct UGreaterThan { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(a > b); } };
+        struct UGreaterThanEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(a >= b); } };
+        struct ULessThan { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(a < b); } };
+        struct ULessThanEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(a <= b); } };
+        struct SGreaterThan { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(toSigned(a) > toSigned(b)); } };
+        struct SGreaterThanEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(toSigned(a) >= toSigned(b)); } };
+        struct SLessThan { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(toSigned(a) < toSigned(b)); } };
+        struct SLessThanEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(toSigned(a) <= toSigned(b)); } };
+
+        // Ordered comparisons are false when either side is NaN, unordered ones true
+        struct FOrdEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(toFloat(a) == toFloat(b)); } };
+        struct FOrdNotEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(toFloat(a) < toFloat(b) || toFloat(a) > toFloat(b)); } };
+        struct FOrdLessThan { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(toFloat(a) < toFloat(b)); } };
+        struct FOrdLessThanEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(toFloat(a) <= toFloat(b)); } };
+        struct FOrdGreaterThan { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(toFloat(a) > toFloat(b)); } };
+        struct FOrdGreaterThanEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toMask(toFloat(a) >= toFloat(b)); } };
+        struct FUnordEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return ~FOrdNotEqual::apply(a, b); } };
+        struct FUnordNotEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return ~FOrdEqual::apply(a, b); } };
+        struct FUnordLessThan { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return ~FOrdGreaterThanEqual::apply(a, b); } };
+        struct FUnordLessThanEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return ~FOrdGreaterThan::apply(a, b); } };
+        struct FUnordGreaterThan { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return ~FOrdLessThanEqual::apply(a, b); } };
+        struct FUnordGreaterThanEqual { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return ~FOrdLessThan::apply(a, b); } };
+
+        struct Select { static RHI_LANES_INLINE uint32_t apply(uint32_t condition, uint32_t a, uint32_t b) { return blend(a, b, condition); } };
+
+        struct BitFieldUExtract {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t base, uint32_t offset, uint32_t count) {
+                return (base >> (offset & 31)) & lowBits(count);
+            }
+        };
+
+        struct BitFieldSExtract {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t base, uint32_t offset, uint32_t count) {
+                uint32_t shift = (32 - count) & 31;
+                uint32_t extended = static_cast<uint32_t>(toSigned((base >> (offset & 31)) << shift) >> shift);
+                return count == 0 ? 0 : extended;
+            }
+        };
+
+        struct BitFieldInsert {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t base, uint32_t insert, uint32_t offset, uint32_t count) {
+                uint32_t mask = lowBits(count) << (offset & 31);
+                return (base & ~mask) | ((insert << (offset & 31)) & mask);
+            }
+        };
+
+        // GLSL.std.450
+
+        struct Round { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::round(toFloat(a))); } };
+        struct RoundEven { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::nearbyint(toFloat(a))); } };
+        struct Trunc { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::trunc(toFloat(a))); } };
+        struct FAbs { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return a & 0x7FFFFFFFu; } };
+        struct SAbs { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toSigned(a) < 0 ? 0u - a : a; } };
+        struct Floor { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::floor(toFloat(a))); } };
+        struct Ceil { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::ceil(toFloat(a))); } };
+        struct Fract { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(toFloat(a) - std::floor(toFloat(a))); } };
+        struct Radians { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(toFloat(a) * 0.017453292519943295f); } };
+        struct Degrees { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(toFloat(a) * 57.29577951308232f); } };
+        struct Sin { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::sin(toFloat(a))); } };
+        struct Cos { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::cos(toFloat(a))); } };
+        struct Tan { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::tan(toFloat(a))); } };
+        struct Asin { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::asin(toFloat(a))); } };
+        struct Acos { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::acos(toFloat(a))); } };
+        struct Atan { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::atan(toFloat(a))); } };
+        struct Sinh { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::sinh(toFloat(a))); } };
+        struct Cosh { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::cosh(toFloat(a))); } };
+        struct Tanh { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::tanh(toFloat(a))); } };
+        struct Asinh { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::asinh(toFloat(a))); } };
+        struct Acosh { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::acosh(toFloat(a))); } };
+        struct Atanh { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::atanh(toFloat(a))); } };
+        struct Exp { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::exp(toFloat(a))); } };
+        struct Log { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::log(toFloat(a))); } };
+        struct Exp2 { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::exp2(toFloat(a))); } };
+        struct Log2 { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::log2(toFloat(a))); } };
+        struct Sqrt { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(std::sqrt(toFloat(a))); } };
+        struct InverseSqrt { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return toBits(1.0f / std::sqrt(toFloat(a))); } };
+        struct FindILsb { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return findLsb(a); } };
+        struct FindUMsb { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return findMsb(a); } };
+        struct FindSMsb { static RHI_LANES_INLINE uint32_t apply(uint32_t a) { return findMsb(toSigned(a) < 0 ? ~a : a); } };
+
+        struct FSign {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t a) {
+                float value = toFloat(a);
+                return toBits(value > 0.0f ? 1.0f : value < 0.0f ? -1.0f : value);
+            }
+        };
+
+        struct SSign {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t a) {
+                return toSigned(a) > 0 ? 1u : toSigned(a) < 0 ? ~0u : 0u;
+            }
+        };
+
+        struct Atan2 { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toBits(std::atan2(toFloat(a), toFloat(b))); } };
+        struct Pow { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toBits(std::pow(toFloat(a), toFloat(b))); } };
+        struct Ldexp { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toBits(std::ldexp(toFloat(a), toSigned(b))); } };
+        struct Step { static RHI_LANES_INLINE uint32_t apply(uint32_t edge, uint32_t x) { return toFloat(x) < toFloat(edge) ? 0u : 0x3F800000u; } };
+        struct FMin { static constexpr uint32_t kIdentity = 0x7F800000u; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toFloat(b) < toFloat(a) ? b : a; } };
+        struct FMax { static constexpr uint32_t kIdentity = 0xFF800000u; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toFloat(a) < toFloat(b) ? b : a; } };
+        struct UMin { static constexpr uint32_t kIdentity = ~0u; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return std::min(a, b); } };
+        struct UMax { static constexpr uint32_t kIdentity = 0; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return std::max(a, b); } };
+        struct SMin { static constexpr uint32_t kIdentity = 0x7FFFFFFFu; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toSigned(b) < toSigned(a) ? b : a; } };
+        struct SMax { static constexpr uint32_t kIdentity = 0x80000000u; static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b) { return toSigned(a) < toSigned(b) ? b : a; } };
+        struct Exchange { static RHI_LANES_INLINE uint32_t apply(uint32_t, uint32_t b) { return b; } };
+
+        struct FClamp { static RHI_LANES_INLINE uint32_t apply(uint32_t x, uint32_t low, uint32_t high) { return FMin::apply(FMax::apply(x, low), high); } };
+        struct UClamp { static RHI_LANES_INLINE uint32_t apply(uint32_t x, uint32_t low, uint32_t high) { return UMin::apply(UMax::apply(x, low), high); } };
+        struct SClamp { static RHI_LANES_INLINE uint32_t apply(uint32_t x, uint32_t low, uint32_t high) { return SMin::apply(SMax::apply(x, low), high); } };
+
+        // Not fused, which the precision rules of Vulkan allow
+        struct Fma { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t b, uint32_t c) { return toBits(toFloat(a) * toFloat(b) + toFloat(c)); } };
+
+        struct FMix {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t x, uint32_t y, uint32_t a) {
+                return toBits(toFloat(x) * (1.0f - toFloat(a)) + toFloat(y) * toFloat(a));
+            }
+        };
+
+        struct SmoothStep {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t edge0, uint32_t edge1, uint32_t x) {
+                float t = clampFloat((toFloat(x) - toFloat(edge0)) / (toFloat(edge1) - toFloat(edge0)), 0.0f, 1.0f);
+                return toBits(t * t * (3.0f - 2.0f * t));
+            }
+        };
+
+        struct PackHalf2x16 { static RHI_LANES_INLINE uint32_t apply(uint32_t x, uint32_t y) { return floatToHalf(toFloat(x)) | floatToHalf(toFloat(y)) << 16; } };
+        struct PackUnorm2x16 { static RHI_LANES_INLINE uint32_t apply(uint32_t x, uint32_t y) { return packUnorm(toFloat(x), 65535.0f) | packUnorm(toFloat(y), 65535.0f) << 16; } };
+        struct PackSnorm2x16 { static RHI_LANES_INLINE uint32_t apply(uint32_t x, uint32_t y) { return packSnorm(toFloat(x), 32767.0f, 16) | packSnorm(toFloat(y), 32767.0f, 16) << 16; } };
+
+        struct PackUnorm4x8 {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t x, uint32_t y, uint32_t z, uint32_t w) {
+                return packUnorm(toFloat(x), 255.0f) | packUnorm(toFloat(y), 255.0f) << 8 | packUnorm(toFloat(z), 255.0f) << 16
+                    | packUnorm(toFloat(w), 255.0f) << 24;
+            }
+        };
+
+        struct PackSnorm4x8 {
+            static RHI_LANES_INLINE uint32_t apply(uint32_t x, uint32_t y, uint32_t z, uint32_t w) {
+                return packSnorm(toFloat(x), 127.0f, 8) | packSnorm(toFloat(y), 127.0f, 8) << 8 | packSnorm(toFloat(z), 127.0f, 8) << 16
+                    | packSnorm(toFloat(w), 127.0f, 8) << 24;
+            }
+        };
+
+        // Component c of the unpacked vector
+        struct UnpackHalf2x16 { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t c) { return toBits(halfToFloat(a >> (c * 16))); } };
+        struct UnpackUnorm2x16 { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t c) { return toBits(static_cast<float>((a >> (c * 16)) & 0xFFFFu) / 65535.0f); } };
+        struct UnpackSnorm2x16 { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t c) { return toBits(unpackSnorm(a >> (c * 16), 16, 32767.0f)); } };
+        struct UnpackUnorm4x8 { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t c) { return toBits(static_cast<float>((a >> (c * 8)) & 0xFFu) / 255.0f); } };
+        struct UnpackSnorm4x8 { static RHI_LANES_INLINE uint32_t apply(uint32_t a, uint32_t c) { return toBits(unpackSnorm(a >> (c * 8), 8, 127.0f)); } };
+
+        // ===========================================================================================================================
+        // Lane Handlers
+        // ===========================================================================================================================
+
+        // Slots never overlap the mask, which the compiler cannot tell without __restrict
+        RHI_LANES_INLINE void blendLanes(uint32_t* __restrict lanes, const uint32_t* __restrict values,
+            const uint32_t* __restrict active)
+        {
+            for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                lanes[lane] = blend(values[lane], lanes[lane], active[lane]);
+            }
+        }
+
+        // Results are written to the active lanes only, the others keep the value they had
+        RHI_LANES_INLINE void writeSlot(ComputeWarp& warp, uint32_t slot, const uint32_t* values) {
+            blendLanes(warp.slots[slot].lanes, values, warp.active);
+        }
+
+        RHI_LANES_INLINE const uint32_t* readSlot(const ComputeWarp& warp, uint32_t slot) {
+            return warp.slots[slot].lanes;
+        }
+
+        template <typename Op>
+        struct UnaryLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* a = readSlot(warp, instruction.operands[0]);
+
+                uint32_t values[kComputeLanes];
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    values[lane] = Op::apply(a[lane]);
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        template <typename Op>
+        struct ImmediateLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* a = readSlot(warp, instruction.operands[0]);
+
+                uint32_t values[kComputeLanes];
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    values[lane] = Op::apply(a[lane], instruction.immediate);
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        template <typename Op>
+        struct BinaryLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* a = readSlot(warp, instruction.operands[0]);
+                const uint32_t* b = readSlot(warp, instruction.operands[1]);
+
+                uint32_t values[kComputeLanes];
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    values[lane] = Op::apply(a[lane], b[lane]);
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        template <typename Op>
+        struct TernaryLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* a = readSlot(warp, instruction.operands[0]);
+                const uint32_t* b = readSlot(warp, instruction.operands[1]);
+                const uint32_t* c = readSlot(warp, instruction.operands[2]);
+
+                uint32_t values[kComputeLanes];
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    values[lane] = Op::apply(a[lane], b[lane], c[lane]);
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        template <typename Op>
+        struct QuaternaryLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* a = readSlot(warp, instruction.operands[0]);
+                const uint32_t* b = readSlot(warp, instruction.operands[1]);
+                const uint32_t* c = readSlot(warp, instruction.operands[2]);
+                const uint32_t* d = readSlot(warp, instruction.operands[3]);
+
+                uint32_t values[kComputeLanes];
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    values[lane] = Op::apply(a[lane], b[lane], c[lane], d[lane]);
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        // Takes operand 0 in the lanes that came from block immediate
+        struct PhiLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* a = readSlot(warp, instruction.operands[0]);
+
+                const uint32_t* lanes = warp.slots[instruction.result].lanes;
+
+                uint32_t values[kComputeLanes];
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    values[lane] = blend(a[lane], lanes[lane], toMask(warp.previous[lane] == instruction.immediate));
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        // Byte offset of an access chain: operand 0 times the stride in immediate, plus operand 1
+        template <bool kHasBase>
+        struct OffsetLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* index = readSlot(warp, instruction.operands[0]);
+                const uint32_t* base = kHasBase ? readSlot(warp, instruction.operands[1]) : index;
+
+                uint32_t values[kComputeLanes];
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    values[lane] = index[lane] * instruction.immediate + (kHasBase ? base[lane] : 0u);
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        // ===========================================================================================================================
+        // Memory Handlers
+        // ===========================================================================================================================
+
+        // Accesses are to space extra at operand 0 plus immediate bytes, operand 0 being kNoSlot
+        // when the offset is constant. The sum is taken in 64 bits so it cannot wrap into range.
+        RHI_LANES_INLINE void loadOffsets(const ComputeWarp& warp, const ComputeInstruction& instruction, bool dynamic,
+            Uint64* offsets)
+        {
+            for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                offsets[lane] = instruction.immediate + (dynamic ? warp.slots[instruction.operands[0]].lanes[lane] : 0ull);
+            }
+        }
+
+        RHI_LANES_INLINE uint8_t* getLaneAddress(const ComputeSpace& space, Uint32 lane, Uint64 offset) {
+            return space.data + (space.interleaved ? lane * 4 : 0) + offset;
+        }
+
+        // The lanes access the aligned words following the one of lane 0, all in bounds: one offset
+        // into an interleaved space, or offsets 4 bytes apart into a shared one
+        RHI_LANES_INLINE bool isContiguous(const ComputeSpace& space, const uint32_t* offsets, Uint64 first) {
+            uint32_t step = space.interleaved ? 0 : 4;
+            uint32_t mismatch = 0;
+
+            for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                mismatch |= offsets[lane] ^ (offsets[0] + lane * step);
+            }
+
+            Uint64 end = first + (space.interleaved ? 4 : kComputeLanes * 4);
+            return mismatch == 0 && offsets[0] <= UINT32_MAX - kComputeLanes * 4 && end <= space.limit
+                && (reinterpret_cast<uintptr_t>(space.data + first) & 3) == 0;
+        }
+
+        RHI_LANES_INLINE void copyLanes(uint32_t* __restrict target, const uint32_t* __restrict source) {
+            for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                target[lane] = source[lane];
+            }
+        }
+
+        template <bool kDynamic>
+        struct LoadLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const ComputeSpace& space = warp.spaces[instruction.extra];
+                const uint32_t* dynamic = kDynamic ? readSlot(warp, instruction.operands[0]) : nullptr;
+                Uint64 first = instruction.immediate + (kDynamic ? dynamic[0] : 0ull);
+
+                // Inactive lanes load too, the blend drops their words
+                if (kDynamic ? isContiguous(space, dynamic, first)
+                    : space.interleaved && first + 4 <= space.limit && (reinterpret_cast<uintptr_t>(space.data + first) & 3) == 0)
+                {
+                    blendLanes(warp.slots[instruction.result].lanes, reinterpret_cast<const uint32_t*>(space.data + first), warp.active);
+                    return;
+                }
+
+                uint32_t values[kComputeLanes];
+
+                if (!kDynamic && !space.interleaved) {
+                    values[0] = 0;
+                    if (first + 4 <= space.limit) {
+                        std::memcpy(&values[0], space.data + first, 4);
+                    }
+
+                    std::fill(values + 1, values + kComputeLanes, values[0]);
+                } else {
+                    Uint64 offsets[kComputeLanes];
+                    loadOffsets(warp, instruction, kDynamic, offsets);
+
+                    for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                        values[lane] = 0;
+                        if (warp.active[lane] != 0 && offsets[lane] + 4 <= space.limit) {
+                            std::memcpy(&values[lane], getLaneAddress(space, lane, offsets[lane]), 4);
+                        }
+                    }
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        // Stores operand 1. Words of inactive lanes are never written, another invocation may own them.
+        template <bool kDynamic>
+        struct StoreLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const ComputeSpace& space = warp.spaces[instruction.extra];
+                const uint32_t* values = readSlot(warp, instruction.operands[1]);
+                const uint32_t* dynamic = kDynamic ? readSlot(warp, instruction.operands[0]) : nullptr;
+                Uint64 first = instruction.immediate + (kDynamic ? dynamic[0] : 0ull);
+
+                uint32_t active = ~0u;
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    active &= warp.active[lane];
+                }
+
+                bool contiguous = kDynamic ? isContiguous(space, dynamic, first)
+                    : space.interleaved && first + 4 <= space.limit && (reinterpret_cast<uintptr_t>(space.data + first) & 3) == 0;
+
+                if (active != 0 && contiguous) {
+                    copyLanes(reinterpret_cast<uint32_t*>(space.data + first), values);
+                    return;
+                }
+
+                Uint64 offsets[kComputeLanes];
+                loadOffsets(warp, instruction, kDynamic, offsets);
+
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    if (warp.active[lane] != 0 && offsets[lane] + 4 <= space.limit) {
+                        std::memcpy(getLaneAddress(space, lane, offsets[lane]), &values[lane], 4);
+                    }
+                }
+            }
+        };
+
+        static_assert(sizeof(std::atomic<uint32_t>) == 4, "Atomics work in place on 32-bit words");
+
+        // Null when out of bounds or unaligned, robust access drops such atomics
+        std::atomic<uint32_t>* getAtomic(const ComputeSpace& space, Uint32 lane, Uint64 offset) {
+            if (offset + 4 > space.limit || (offset & 3) != 0) {
+                return nullptr;
+            }
+
+            return reinterpret_cast<std::atomic<uint32_t>*>(getLaneAddress(space, lane, offset));
+        }
+
+        // Read-modify-write with operand 1, the lanes taking their turn in order
+        template <typename Op>
+        struct AtomicLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const ComputeSpace& space = warp.spaces[instruction.extra];
+                const uint32_t* operand = readSlot(warp, instruction.operands[1]);
+
+                Uint64 offsets[kComputeLanes];
+                loadOffsets(warp, instruction, instruction.operands[0] != kNoSlot, offsets);
+
+                uint32_t values[kComputeLanes] = {};
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    std::atomic<uint32_t>* atomic = warp.active[lane] != 0 ? getAtomic(space, lane, offsets[lane]) : nullptr;
+                    if (atomic == nullptr) {
+                        continue;
+                    }
+
+                    uint32_t old = atomic->load(std::memory_order_relaxed);
+                    while (!atomic->compare_exchange_weak(old, Op::apply(old, operand[lane]))) {
+                    }
+
+                    values[lane] = old;
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        // Stores operand 1 where the word equals operand 2
+        struct CompareExchangeLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const ComputeSpace& space = warp.spaces[instruction.extra];
+                const uint32_t* operand = readSlot(warp, instruction.operands[1]);
+                const uint32_t* comparator = readSlot(warp, instruction.operands[2]);
+
+                Uint64 offsets[kComputeLanes];
+                loadOffsets(warp, instruction, instruction.operands[0] != kNoSlot, offsets);
+
+                uint32_t values[kComputeLanes] = {};
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    std::atomic<uint32_t>* atomic = warp.active[lane] != 0 ? getAtomic(space, lane, offsets[lane]) : nullptr;
+                    if (atomic == nullptr) {
+                        continue;
+                    }
+
+                    uint32_t old = comparator[lane];
+                    atomic->compare_exchange_strong(old, operand[lane]);
+                    values[lane] = old;
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        struct AtomicLoadLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const ComputeSpace& space = warp.spaces[instruction.extra];
+
+                Uint64 offsets[kComputeLanes];
+                loadOffsets(warp, instruction, instruction.operands[0] != kNoSlot, offsets);
+
+                uint32_t values[kComputeLanes] = {};
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    std::atomic<uint32_t>* atomic = warp.active[lane] != 0 ? getAtomic(space, lane, offsets[lane]) : nullptr;
+                    values[lane] = atomic != nullptr ? atomic->load() : 0u;
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        struct AtomicStoreLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const ComputeSpace& space = warp.spaces[instruction.extra];
+                const uint32_t* operand = readSlot(warp, instruction.operands[1]);
+
+                Uint64 offsets[kComputeLanes];
+                loadOffsets(warp, instruction, instruction.operands[0] != kNoSlot, offsets);
+
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    std::atomic<uint32_t>* atomic = warp.active[lane] != 0 ? getAtomic(space, lane, offsets[lane]) : nullptr;
+                    if (atomic != nullptr) {
+                        atomic->store(operand[lane]);
+                    }
+                }
+            }
+        };
+
+        // Elements of a runtime array starting immediate bytes into space extra, operand 0
+        // holding the array stride itself rather than a slot
+        struct ArrayLengthLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const ComputeSpace& space = warp.spaces[instruction.extra];
+                Uint64 length = space.limit > instruction.immediate ? (space.limit - instruction.immediate) / instruction.operands[0] : 0;
+
+                uint32_t values[kComputeLanes];
+                std::fill(values, values + kComputeLanes, static_cast<uint32_t>(std::min<Uint64>(length, UINT32_MAX)));
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        // ===========================================================================================================================
+        // Subgroup Handlers
+        // ===========================================================================================================================
+
+        // Subgroups are warps, their operations span the lanes running the block
+
+        Uint32 firstActiveLane(const ComputeWarp& warp) {
+            Uint32 lane = 0;
+            while (lane + 1 < kComputeLanes && warp.active[lane] == 0) {
+                lane++;
+            }
+            return lane;
+        }
+
+        // Bit i set for active lane i where operand 0 is true
+        uint32_t ballot(const ComputeWarp& warp, const uint32_t* predicate) {
+            uint32_t bits = 0;
+            for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                bits |= (warp.active[lane] & predicate[lane] & 1u) << lane;
+            }
+            return bits;
+        }
+
+        struct ElectLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                uint32_t values[kComputeLanes] = {};
+                values[firstActiveLane(warp)] = ~0u;
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        enum class Vote : Uint8 {
+            eAll,
+            eAny,
+            eAllEqual
+        };
+
+        template <Vote kVote>
+        struct VoteLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* a = readSlot(warp, instruction.operands[0]);
+                uint32_t first = a[firstActiveLane(warp)];
+
+                bool all = true;
+                bool any = false;
+                bool equal = true;
+
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    if (warp.active[lane] != 0) {
+                        all &= a[lane] != 0;
+                        any |= a[lane] != 0;
+                        equal &= a[lane] == first;
+                    }
+                }
+
+                uint32_t values[kComputeLanes];
+                std::fill(values, values + kComputeLanes, toMask(kVote == Vote::eAll ? all : kVote == Vote::eAny ? any : equal));
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        // Operand 0 of the first active lane, or of the lane in operand 1 with immediate set
+        struct BroadcastLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* a = readSlot(warp, instruction.operands[0]);
+                uint32_t source = instruction.immediate != 0 ? readSlot(warp, instruction.operands[1])[firstActiveLane(warp)]
+                    : firstActiveLane(warp);
+
+                uint32_t values[kComputeLanes];
+                std::fill(values, values + kComputeLanes, a[source % kComputeLanes]);
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        struct BallotLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                uint32_t values[kComputeLanes];
+                std::fill(values, values + kComputeLanes, ballot(warp, readSlot(warp, instruction.operands[0])));
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        // Bit operand 1 of the ballot in operand 0
+        struct BallotBitExtractLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* bits = readSlot(warp, instruction.operands[0]);
+                const uint32_t* index = readSlot(warp, instruction.operands[1]);
+
+                uint32_t values[kComputeLanes];
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    values[lane] = toMask(index[lane] < 32 && ((bits[lane] >> (index[lane] & 31)) & 1u) != 0);
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        enum GroupOperation : uint32_t {
+            GroupOperationReduce = 0,
+            GroupOperationInclusiveScan = 1,
+            GroupOperationExclusiveScan = 2,
+            GroupOperationClusteredReduce = 3
+        };
+
+        // Bits of the ballot in operand 0 counted as the group operation in immediate does
+        struct BallotBitCountLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* bits = readSlot(warp, instruction.operands[0]);
+
+                uint32_t values[kComputeLanes];
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    uint32_t mask = instruction.immediate == GroupOperationReduce ? ~0u
+                        : instruction.immediate == GroupOperationInclusiveScan ? (2u << lane) - 1u : (1u << lane) - 1u;
+                    values[lane] = countBits(bits[lane] & mask);
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        enum class Shuffle : Uint8 {
+            eIndex,
+            eXor,
+            eUp,
+            eDown
+        };
+
+        // Operand 0 of the lane operand 1 names, lanes naming no lane keep their own
+        template <Shuffle kShuffle>
+        struct ShuffleLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* a = readSlot(warp, instruction.operands[0]);
+                const uint32_t* b = readSlot(warp, instruction.operands[1]);
+
+                uint32_t values[kComputeLanes];
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    uint32_t source = kShuffle == Shuffle::eIndex ? b[lane] : kShuffle == Shuffle::eXor ? lane ^ b[lane]
+                        : kShuffle == Shuffle::eUp ? lane - b[lane] : lane + b[lane];
+                    values[lane] = source < kComputeLanes ? a[source] : a[lane];
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        // Reductions and scans of operand 0 over the active lanes, the group operation in
+        // immediate and the cluster size in extra
+        template <typename Op>
+        struct GroupLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* a = readSlot(warp, instruction.operands[0]);
+                uint32_t values[kComputeLanes];
+
+                if (instruction.immediate == GroupOperationInclusiveScan || instruction.immediate == GroupOperationExclusiveScan) {
+                    uint32_t total = Op::kIdentity;
+
+                    for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                        uint32_t next = warp.active[lane] != 0 ? Op::apply(total, a[lane]) : total;
+                        values[lane] = instruction.immediate == GroupOperationInclusiveScan ? next : total;
+                        total = next;
+                    }
+                } else {
+                    Uint32 cluster = std::max<Uint32>(1, std::min<Uint32>(instruction.extra, kComputeLanes));
+
+                    for (Uint32 first = 0; first < kComputeLanes; first += cluster) {
+                        uint32_t total = Op::kIdentity;
+                        for (Uint32 lane = first; lane < std::min(first + cluster, kComputeLanes); lane++) {
+                            total = warp.active[lane] != 0 ? Op::apply(total, a[lane]) : total;
+                        }
+
+                        std::fill(values + first, values + std::min(first + cluster, kComputeLanes), total);
+                    }
+                }
+
+                writeSlot(warp, instruction.result, values);
+            }
+        };
+
+        // ===========================================================================================================================
+        // Terminators
+        // ===========================================================================================================================
+
+        // The active lanes go to their block in targets
+        RHI_LANES_INLINE void jumpLanes(ComputeWarp& warp, const uint32_t* targets) {
+            uint32_t blocks[kComputeLanes];
+            std::fill(blocks, blocks + kComputeLanes, warp.block);
+
+            blendLanes(warp.pc, targets, warp.active);
+            blendLanes(warp.previous, blocks, warp.active);
+        }
+
+        // To block immediate
+        struct BranchLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                uint32_t targets[kComputeLanes];
+                std::fill(targets, targets + kComputeLanes, instruction.immediate);
+                jumpLanes(warp, targets);
+            }
+        };
+
+        // To block immediate where operand 0 is true, to block extra elsewhere
+        struct BranchConditionalLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* condition = readSlot(warp, instruction.operands[0]);
+
+                uint32_t targets[kComputeLanes];
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    targets[lane] = blend(instruction.immediate, instruction.extra, condition[lane]);
+                }
+
+                jumpLanes(warp, targets);
+            }
+        };
+
+        // Operand 0 looked up in switch immediate
+        struct SwitchLanes {
+            static void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                const uint32_t* selector = readSlot(warp, instruction.operands[0]);
+                const ComputeSwitch& table = warp.program->switches[instruction.immediate];
+
+                uint32_t targets[kComputeLanes];
+                std::fill(targets, targets + kComputeLanes, table.defaultTarget);
+
+                for (const auto& entry : table.cases) {
+                    for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                        targets[lane] = selector[lane] == entry.first ? entry.second : targets[lane];
+                    }
+                }
+
+                jumpLanes(warp, targets);
+            }
+        };
+
+        // To block immediate once every warp of the workgroup got there
+        struct BarrierLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction& instruction) {
+                uint32_t targets[kComputeLanes];
+                std::fill(targets, targets + kComputeLanes, instruction.immediate | kWaitBit);
+                jumpLanes(warp, targets);
+            }
+        };
+
+        struct ExitLanes {
+            static RHI_LANES_INLINE void run(ComputeWarp& warp, const ComputeInstruction&) {
+                uint32_t targets[kComputeLanes];
+                std::fill(targets, targets + kComputeLanes, kDone);
+                blendLanes(warp.pc, targets, warp.active);
+            }
+        };
+
+        template <typename Lanes>
+        void runLanes(ComputeWarp& warp, const ComputeInstruction& instruction) {
+            Lanes::run(warp, instruction);
+        }
+
+#if defined(RHI_COMPUTE_X86)
+        template <typename Lanes>
+        RHI_TARGET_AVX2 void runLanesAvx2(ComputeWarp& warp, const ComputeInstruction& instruction) {
+            Lanes::run(warp, instruction);
+        }
+#endif
+
+        template <typename Lanes>
+        ComputeHandler getHandler(bool vectorized) {
+#if defined(RHI_COMPUTE_X86)
+            if (vectorized) {
+                return &runLanesAvx2<Lanes>;
+            }
+#endif
+            (void)vectorized;
+            return &runLanes<Lanes>;
+        }
+
+        // ===========================================================================================================================
+        // Warp Scheduling
+        // ===========================================================================================================================
+
+        // Runs the block the earliest lanes wait at until every lane finished or waits at a
+        // barrier. True when lanes wait.
+        bool runWarp(ComputeWarp& warp) {
+            const ComputeProgram& program = *warp.program;
+
+            for (;;) {
+                uint32_t block = warp.pc[0];
+                for (Uint32 lane = 1; lane < kComputeLanes; lane++) {
+                    block = std::min(block, warp.pc[lane]);
+                }
+
+                if (block >= kWaitBit) {
+                    return block != kDone;
+                }
+
+                for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                    warp.active[lane] = toMask(warp.pc[lane] == block);
+                }
+
+                warp.block = block;
+
+                const ComputeBlock& range = program.blocks[block];
+                for (uint32_t i = range.first; i < range.end; i++) {
+                    const ComputeInstruction& instruction = program.instructions[i];
+                    instruction.execute(warp, instruction);
+                }
+            }
+        }
+
+        void releaseWarp(ComputeWarp& warp) {
+            for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                warp.pc[lane] = warp.pc[lane] == kDone ? kDone : warp.pc[lane] & ~kWaitBit;
+            }
+        }
+
+        // ===========================================================================================================================
+        // Operation Tables
+        // ===========================================================================================================================
+
+        enum SpirvOp : uint32_t {
+            OpNop = 0,
+            OpUndef = 1,
+            OpLine = 8,
+            OpExtInstImport = 11,
+            OpExtInst = 12,
+            OpEntryPoint = 15,
+            OpExecutionMode = 16,
+            OpTypeVoid = 19,
+            OpTypeBool = 20,
+            OpTypeInt = 21,
+            OpTypeFloat = 22,
+            OpTypeVector = 23,
+            OpTypeMatrix = 24,
+            OpTypeImage = 25,
+            OpTypeSampler = 26,
+            OpTypeSampledImage = 27,
+            OpTypeArray = 28,
+            OpTypeRuntimeArray = 29,
+            OpTypeStruct = 30,
+            OpTypePointer = 32,
+            OpTypeFunction = 33,
+            OpConstantTrue = 41,
+            OpConstantFalse = 42,
+            OpConstant = 43,
+            OpConstantComposite = 44,
+            OpConstantNull = 46,
+            OpSpecConstantTrue = 48,
+            OpSpecConstantFalse = 49,
+            OpSpecConstant = 50,
+            OpSpecConstantComposite = 51,
+            OpSpecConstantOp = 52,
+            OpFunction = 54,
+            OpFunctionParameter = 55,
+            OpFunctionEnd = 56,
+            OpFunctionCall = 57,
+            OpVariable = 59,
+            OpLoad = 61,
+            OpStore = 62,
+            OpCopyMemory = 63,
+            OpAccessChain = 65,
+            OpInBoundsAccessChain = 66,
+            OpArrayLength = 68,
+            OpDecorate = 71,
+            OpMemberDecorate = 72,
+            OpVectorExtractDynamic = 77,
+            OpVectorInsertDynamic = 78,
+            OpVectorShuffle = 79,
+            OpCompositeConstruct = 80,
+            OpCompositeExtract = 81,
+            OpCompositeInsert = 82,
+            OpCopyObject = 83,
+            OpTranspose = 84,
+            OpUConvert = 113,
+            OpSConvert = 114,
+            OpFConvert = 115,
+            OpBitcast = 124,
+            OpVectorTimesScalar = 142,
+            OpMatrixTimesScalar = 143,
+            OpVectorTimesMatrix = 144,
+            OpMatrixTimesVector = 145,
+            OpMatrixTimesMatrix = 146,
+            OpOuterProduct = 147,
+            OpDot = 148,
+            OpAny = 154,
+            OpAll = 155,
+            OpSelect = 169,
+            OpBitFieldInsert = 201,
+            OpBitFieldSExtract = 202,
+            OpBitFieldUExtract = 203,
+            OpControlBarrier = 224,
+            OpMemoryBarrier = 225,
+            OpAtomicLoad = 227,
+            OpAtomicStore = 228,
+            OpAtomicExchange = 229,
+            OpAtomicCompareExchange = 230,
+            OpAtomicCompareExchangeWeak = 231,
+            OpAtomicIIncrement = 232,
+            OpAtomicIDecrement = 233,
+            OpAtomicIAdd = 234,
+            OpAtomicISub = 235,
+            OpAtomicSMin = 236,
+            OpAtomicUMin = 237,
+            OpAtomicSMax = 238,
+            OpAtomicUMax = 239,
+            OpAtomicAnd = 240,
+            OpAtomicOr = 241,
+            OpAtomicXor = 242,
+            OpPhi = 245,
+            OpLoopMerge = 246,
+            OpSelectionMerge = 247,
+            OpLabel = 248,
+            OpBranch = 249,
+            OpBranchConditional = 250,
+            OpSwitch = 251,
+            OpKill = 252,
+            OpReturn = 253,
+            OpReturnValue = 254,
+            OpUnreachable = 255,
+            OpNoLine = 317,
+            OpExecutionModeId = 331,
+            OpGroupNonUniformElect = 333,
+            OpGroupNonUniformAll = 334,
+            OpGroupNonUniformAny = 335,
+            OpGroupNonUniformAllEqual = 336,
+            OpGroupNonUniformBroadcast = 337,
+            OpGroupNonUniformBroadcastFirst = 338,
+            OpGroupNonUniformBallot = 339,
+            OpGroupNonUniformBallotBitExtract = 341,
+            OpGroupNonUniformBallotBitCount = 342,
+            OpGroupNonUniformShuffle = 345,
+            OpGroupNonUniformShuffleXor = 346,
+            OpGroupNonUniformShuffleUp = 347,
+            OpGroupNonUniformShuffleDown = 348,
+            OpGroupNonUniformIAdd = 349,
+            OpGroupNonUniformFAdd = 350,
+            OpGroupNonUniformIMul = 351,
+            OpGroupNonUniformFMul = 352,
+            OpGroupNonUniformSMin = 353,
+            OpGroupNonUniformUMin = 354,
+            OpGroupNonUniformFMin = 355,
+            OpGroupNonUniformSMax = 356,
+            OpGroupNonUniformUMax = 357,
+            OpGroupNonUniformFMax = 358,
+            OpGroupNonUniformBitwiseAnd = 359,
+            OpGroupNonUniformBitwiseOr = 360,
+            OpGroupNonUniformBitwiseXor = 361,
+            OpGroupNonUniformLogicalAnd = 362,
+            OpGroupNonUniformLogicalOr = 363,
+            OpGroupNonUniformLogicalXor = 364,
+            OpCopyLogical = 400,
+            OpTerminateInvocation = 4416,
+            OpAtomicFAddEXT = 6035
+        };
+
+        enum GlslOp : uint32_t {
+            GlslPackSnorm4x8 = 54,
+            GlslPackUnorm4x8 = 55,
+            GlslPackSnorm2x16 = 56,
+            GlslPackUnorm2x16 = 57,
+            GlslPackHalf2x16 = 58,
+            GlslUnpackSnorm2x16 = 60,
+            GlslUnpackUnorm2x16 = 61,
+            GlslUnpackHalf2x16 = 62,
+            GlslUnpackSnorm4x8 = 63,
+            GlslUnpackUnorm4x8 = 64,
+            GlslLength = 66,
+            GlslDistance = 67,
+            GlslCross = 68,
+            GlslNormalize = 69,
+            GlslFaceForward = 70,
+            GlslReflect = 71,
+            GlslRefract = 72
+        };
+
+        enum SpirvDecoration : uint32_t {
+            DecorationSpecId = 1,
+            DecorationBlock = 2,
+            DecorationBufferBlock = 3,
+            DecorationRowMajor = 4,
+            DecorationArrayStride = 6,
+            DecorationMatrixStride = 7,
+            DecorationBuiltIn = 11,
+            DecorationBinding = 33,
+            DecorationDescriptorSet = 34,
+            DecorationOffset = 35
+        };
+
+        enum SpirvStorageClass : uint32_t {
+            StorageClassUniformConstant = 0,
+            StorageClassInput = 1,
+            StorageClassUniform = 2,
+            StorageClassWorkgroup = 4,
+            StorageClassPrivate = 6,
+            StorageClassFunction = 7,
+            StorageClassPushConstant = 9,
+            StorageClassStorageBuffer = 12
+        };
+
+        enum SpirvBuiltIn : uint32_t {
+            BuiltInNumWorkgroups = 24,
+            BuiltInWorkgroupSize = 25,
+            BuiltInWorkgroupId = 26,
+            BuiltInLocalInvocationId = 27,
+            BuiltInGlobalInvocationId = 28,
+            BuiltInLocalInvocationIndex = 29,
+            BuiltInSubgroupSize = 36,
+            BuiltInNumSubgroups = 38,
+            BuiltInSubgroupId = 40,
+            BuiltInSubgroupLocalInvocationId = 41
+        };
+
+        constexpr uint32_t kSpirvMagic = 0x07230203;
+        constexpr Uint64 kSpirvHeaderWords = 5;
+        constexpr uint32_t kExecutionModelGLCompute = 5;
+        constexpr uint32_t kExecutionModeLocalSize = 17;
+        constexpr uint32_t kExecutionModeLocalSizeId = 38;
+        constexpr uint32_t kScopeWorkgroup = 2;
+
+        // Handlers of each operation, generic and vectorized, and its lane function to fold
+        // specialization constants with
+        struct UnaryOp {
+            uint32_t opcode;
+            ComputeHandler handlers[2];
+            uint32_t (*fold)(uint32_t a);
+        };
+
+        struct BinaryOp {
+            uint32_t opcode;
+            ComputeHandler handlers[2];
+            uint32_t (*fold)(uint32_t a, uint32_t b);
+        };
+
+        struct TernaryOp {
+            uint32_t opcode;
+            ComputeHandler handlers[2];
+            uint32_t (*fold)(uint32_t a, uint32_t b, uint32_t c);
+        };
+
+        template <typename Op>
+        UnaryOp unaryOp(uint32_t opcode) {
+            return { opcode, { getHandler<UnaryLanes<Op>>(false), getHandler<UnaryLanes<Op>>(true) }, &Op::apply };
+        }
+
+        template <typename Op>
+        BinaryOp binaryOp(uint32_t opcode) {
+            return { opcode, { getHandler<BinaryLanes<Op>>(false), getHandler<BinaryLanes<Op>>(true) }, &Op::apply };
+        }
+
+        template <typename Op>
+        TernaryOp ternaryOp(uint32_t opcode) {
+            return { opcode, { getHandler<TernaryLanes<Op>>(false), getHandler<TernaryLanes<Op>>(true) }, &Op::apply };
+        }
+
+        const UnaryOp kUnaryOps[] = {
+            unaryOp<ConvertFToU>(109), unaryOp<ConvertFToS>(110), unaryOp<ConvertSToF>(111), unaryOp<ConvertUToF>(112),
+            unaryOp<SNegate>(126), unaryOp<FNegate>(127), unaryOp<IsNan>(156), unaryOp<IsInf>(157), unaryOp<Not>(168),
+            unaryOp<Not>(200), unaryOp<BitReverse>(204), unaryOp<BitCount>(205)
+        };
+
+        const BinaryOp kBinaryOps[] = {
+            binaryOp<IAdd>(128), binaryOp<FAdd>(129), binaryOp<ISub>(130), binaryOp<FSub>(131), binaryOp<IMul>(132),
+            binaryOp<FMul>(133), binaryOp<UDiv>(134), binaryOp<SDiv>(135), binaryOp<FDiv>(136), binaryOp<UMod>(137),
+            binaryOp<SRem>(138), binaryOp<SMod>(139), binaryOp<FRem>(140), binaryOp<FMod>(141),
+            binaryOp<LogicalEqual>(164), binaryOp<BitwiseXor>(165), binaryOp<BitwiseOr>(166), binaryOp<BitwiseAnd>(167),
+            binaryOp<IEqual>(170), binaryOp<INotEqual>(171), binaryOp<UGreaterThan>(172), binaryOp<SGreaterThan>(173),
+            binaryOp<UGreaterThanEqual>(174), binaryOp<SGreaterThanEqual>(175), binaryOp<ULessThan>(176),
+            binaryOp<SLessThan>(177), binaryOp<ULessThanEqual>(178), binaryOp<SLessThanEqual>(179),
+            binaryOp<FOrdEqual>(180), binaryOp<FUnordEqual>(181), binaryOp<FOrdNotEqual>(182), binaryOp<FUnordNotEqual>(183),
+            binaryOp<FOrdLessThan>(184), binaryOp<FUnordLessThan>(185), binaryOp<FOrdGreaterThan>(186),
+            binaryOp<FUnordGreaterThan>(187), binaryOp<FOrdLessThanEqual>(188), binaryOp<FUnordLessThanEqual>(189),
+            binaryOp<FOrdGreaterThanEqual>(190), binaryOp<FUnordGreaterThanEqual>(191),
+            binaryOp<ShiftRightLogical>(194), binaryOp<ShiftRightArithmetic>(195), binaryOp<ShiftLeftLogical>(196),
+            binaryOp<BitwiseOr>(197), binaryOp<BitwiseXor>(198), binaryOp<BitwiseAnd>(199)
+        };
+
+        const TernaryOp kTernaryOps[] = {
+            ternaryOp<Select>(OpSelect), ternaryOp<BitFieldSExtract>(OpBitFieldSExtract),
+            ternaryOp<BitFieldUExtract>(OpBitFieldUExtract)
+        };
+
+        const UnaryOp kGlslUnaryOps[] = {
+            unaryOp<Round>(1), unaryOp<RoundEven>(2), unaryOp<Trunc>(3), unaryOp<FAbs>(4), unaryOp<SAbs>(5),
+            unaryOp<FSign>(6), unaryOp<SSign>(7), unaryOp<Floor>(8), unaryOp<Ceil>(9), unaryOp<Fract>(10),
+            unaryOp<Radians>(11), unaryOp<Degrees>(12), unaryOp<Sin>(13), unaryOp<Cos>(14), unaryOp<Tan>(15),
+            unaryOp<Asin>(16), unaryOp<Acos>(17), unaryOp<Atan>(18), unaryOp<Sinh>(19), unaryOp<Cosh>(20),
+            unaryOp<Tanh>(21), unaryOp<Asinh>(22), unaryOp<Acosh>(23), unaryOp<Atanh>(24), unaryOp<Exp>(27),
+            unaryOp<Log>(28), unaryOp<Exp2>(29), unaryOp<Log2>(30), unaryOp<Sqrt>(31), unaryOp<InverseSqrt>(32),
+            unaryOp<FindILsb>(73), unaryOp<FindSMsb>(74), unaryOp<FindUMsb>(75)
+        };
+
+        const BinaryOp kGlslBinaryOps[] = {
+            binaryOp<Atan2>(25), binaryOp<Pow>(26), binaryOp<FMin>(37), binaryOp<UMin>(38), binaryOp<SMin>(39),
+            binaryOp<FMax>(40), binaryOp<UMax>(41), binaryOp<SMax>(42), binaryOp<Step>(48), binaryOp<Ldexp>(53),
+            binaryOp<FMin>(79), binaryOp<FMax>(80)
+        };
+
+        const TernaryOp kGlslTernaryOps[] = {
+            ternaryOp<FClamp>(43), ternaryOp<UClamp>(44), ternaryOp<SClamp>(45), ternaryOp<FMix>(46),
+            ternaryOp<SmoothStep>(49), ternaryOp<Fma>(50), ternaryOp<FClamp>(81)
+        };
+
+        template <typename Entry, size_t kCount>
+        const Entry* findOp(const Entry (&table)[kCount], uint32_t opcode) {
+            for (const Entry& entry : table) {
+                if (entry.opcode == opcode) {
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
+
+        // ===========================================================================================================================
+        // SPIR-V Module
+        // ===========================================================================================================================
+
+        enum class TypeKind : Uint8 {
+            eUnsupported,
+            eVoid,
+            eBool,
+            eInt,
+            eFloat,
+            eVector,
+            eMatrix,
+            eArray,
+            eRuntimeArray,
+            eStruct,
+            ePointer,
+            eFunction
+        };
+
+        struct SpirvType {
+            TypeKind kind = TypeKind::eUnsupported;
+
+            // Component, column, element or pointee type, and the component, column or element count
+            uint32_t element = 0;
+            uint32_t count = 0;
+
+            uint32_t storageClass = 0;
+            std::vector<uint32_t> members;
+
+            // What an unsupported type is, for errors
+            const char* name = "an unknown type";
+        };
+
+        struct SpirvDecorations {
+            uint32_t specId = kNoSlot;
+            uint32_t builtIn = kNoSlot;
+            uint32_t binding = 0;
+            uint32_t group = 0;
+            uint32_t arrayStride = 0;
+        };
+
+        struct SpirvMemberDecorations {
+            uint32_t offset = kNoSlot;
+            uint32_t matrixStride = 0;
+            bool rowMajor = false;
+        };
+
+        // Scalar components flattened in member, element and column major order. Constants of
+        // unsupported types have supported false.
+        struct SpirvConstant {
+            uint32_t type;
+            std::vector<uint32_t> components;
+            bool supported = true;
+        };
+
+        struct SpirvVariable {
+            uint32_t type;
+            uint32_t storageClass;
+            uint32_t initializer;
+        };
+
+        // Word offsets of the instructions, the terminator last. Merge and debug instructions are left out.
+        struct SpirvBlock {
+            uint32_t label;
+            std::vector<Uint64> instructions;
+        };
+
+        struct SpirvFunction {
+            uint32_t resultType;
+            std::vector<uint32_t> parameters;
+            std::vector<SpirvBlock> blocks;
+        };
+
+        struct SpirvEntryPoint {
+            uint32_t model;
+            uint32_t function;
+            std::string name;
+        };
+
+        enum class ImportKind : Uint8 {
+            eOther,
+            eGlsl,
+            eNonSemantic
+        };
+
+        struct SpirvModule {
+            const uint32_t* words = nullptr;
+
+            std::unordered_map<uint32_t, SpirvType> types;
+            std::unordered_map<uint32_t, SpirvDecorations> decorations;
+            std::unordered_map<uint32_t, std::vector<SpirvMemberDecorations>> memberDecorations;
+            std::unordered_map<uint32_t, SpirvConstant> constants;
+            std::unordered_map<uint32_t, SpirvVariable> variables;
+            std::unordered_map<uint32_t, SpirvFunction> functions;
+            std::unordered_map<uint32_t, uint32_t> undefs;
+            std::unordered_map<uint32_t, ImportKind> imports;
+            std::vector<SpirvEntryPoint> entryPoints;
+
+            // Per entry function, with localSizeIds set the sizes are constant ids
+            std::unordered_map<uint32_t, std::array<uint32_t, 3>> localSizes;
+            std::unordered_map<uint32_t, bool> localSizeIds;
+            uint32_t workgroupSizeConstant = 0;
+
+            const SpirvType* findType(uint32_t id) const {
+                auto found = this->types.find(id);
+                return found != this->types.end() ? &found->second : nullptr;
+            }
+
+            const SpirvDecorations& getDecorations(uint32_t id) const {
+                static const SpirvDecorations none;
+                auto found = this->decorations.find(id);
+                return found != this->decorations.end() ? found->second : none;
+            }
+
+            const SpirvMemberDecorations& getMemberDecorations(uint32_t id, uint32_t member) const {
+                static const SpirvMemberDecorations none;
+                auto found = this->memberDecorations.find(id);
+                return found != this->memberDecorations.end() && member < found->second.size() ? found->second[member] : none;
+            }
+
+            // Scalar components of a value of the type, 0 for types that do not flatten
+            Uint32 getComponentCount(uint32_t id) const {
+                const SpirvType* type = this->findType(id);
+                if (type == nullptr) {
+                    return 0;
+                }
+
+                switch (type->kind) {
+                    case TypeKind::eBool:
+                    case TypeKind::eInt:
+                    case TypeKind::eFloat:
+                        return 1;
+                    case TypeKind::eVector:
+                    case TypeKind::eMatrix:
+                    case TypeKind::eArray:
+                        return type->count * this->getComponentCount(type->element);
+                    case TypeKind::eStruct: {
+                        Uint32 count = 0;
+                        for (uint32_t member : type->members) {
+                            Uint32 memberCount = this->getComponentCount(member);
+                            if (memberCount == 0) {
+                                return 0;
+                            }
+                            count += memberCount;
+                        }
+                        return count;
+                    }
+                    default:
+                        return 0;
+                }
+            }
+
+            // First flattened component of member or element index, and its type
+            bool getComponentRange(uint32_t id, uint32_t index, Uint32& first, uint32_t& elementType) const {
+                const SpirvType* type = this->findType(id);
+                if (type == nullptr || index >= (type->kind == TypeKind::eStruct ? type->members.size() : type->count)) {
+                    return false;
+                }
+
+                if (type->kind == TypeKind::eStruct) {
+                    first = 0;
+                    for (uint32_t member = 0; member < index; member++) {
+                        first += this->getComponentCount(type->members[member]);
+                    }
+                    elementType = type->members[index];
+                    return true;
+                }
+
+                if (type->kind != TypeKind::eVector && type->kind != TypeKind::eMatrix && type->kind != TypeKind::eArray) {
+                    return false;
+                }
+
+                first = index * this->getComponentCount(type->element);
+                elementType = type->element;
+                return true;
+            }
+        };
+
+        std::string readString(const uint32_t* words, Uint64 wordCount) {
+            const char* text = reinterpret_cast<const char*>(words);
+            return std::string(text, std::find(text, text + wordCount * 4, '\0'));
+        }
+
+        // Folds OpSpecConstantOp over the flattened components of its operands
+        bool foldSpecConstantOp(SpirvModule& module, const uint32_t* words, Uint32 wordCount, std::string& error) {
+            uint32_t resultType = words[1];
+            uint32_t opcode = words[3];
+
+            SpirvConstant result{ resultType, {} };
+            Uint32 count = module.getComponentCount(resultType);
+
+            std::vector<const SpirvConstant*> operands;
+            for (Uint32 i = 4; i < wordCount; i++) {
+                auto found = module.constants.find(words[i]);
+                operands.push_back(found != module.constants.end() ? &found->second : nullptr);
+            }
+
+            bool supported = count != 0 && !operands.empty() && operands[0] != nullptr && operands[0]->supported;
+
+            // Scalar operands are broadcast across vector results
+            auto component = [&operands](Uint32 operand, Uint32 index) {
+                const std::vector<uint32_t>& components = operands[operand]->components;
+                return components[std::min<size_t>(index, components.size() - 1)];
+            };
+
+            if (!supported) {
+                result.supported = false;
+            } else if (opcode == OpCompositeExtract) {
+                uint32_t type = operands[0]->type;
+                Uint32 first = 0;
+
+                for (Uint32 i = 5; i < wordCount; i++) {
+                    Uint32 offset;
+                    if (!module.getComponentRange(type, words[i], offset, type)) {
+                        error = "Specialization constant " + std::to_string(words[2]) + " extracts a missing component";
+                        return false;
+                    }
+                    first += offset;
+                }
+
+                result.components.assign(operands[0]->components.begin() + first, operands[0]->components.begin() + first + count);
+            } else if (opcode == OpUConvert || opcode == OpSConvert || opcode == OpFConvert || opcode == OpBitcast) {
+                result.components = operands[0]->components;
+            } else if (const UnaryOp* unary = findOp(kUnaryOps, opcode)) {
+                for (Uint32 i = 0; i < count; i++) {
+                    result.components.push_back(unary->fold(component(0, i)));
+                }
+            } else if (const BinaryOp* binary = operands.size() == 2 && operands[1] != nullptr && operands[1]->supported
+                ? findOp(kBinaryOps, opcode) : nullptr)
+            {
+                for (Uint32 i = 0; i < count; i++) {
+                    result.components.push_back(binary->fold(component(0, i), component(1, i)));
+                }
+            } else if (opcode == OpSelect && operands.size() == 3 && operands[1] != nullptr && operands[2] != nullptr) {
+                for (Uint32 i = 0; i < count; i++) {
+                    result.components.push_back(Select::apply(component(0, i), component(1, i), component(2, i)));
+                }
+            } else {
+                error = "Specialization constant operation " + std::to_string(opcode) + " is not supported";
+                return false;
+            }
+
+            module.constants[words[2]] = std::move(result);
+            return true;
+        }
+
+        bool parseModule(const uint32_t* words, Uint64 wordCount, const SpecializationData& specialization,
+            SpirvModule& module, std::string& error)
+        {
+            if (wordCount < kSpirvHeaderWords || words[0] != kSpirvMagic) {
+                error = "Shader module does not hold a SPIR-V binary";
+                return false;
+            }
+
+            module.words = words;
+
+            // Specialized values by constant id, every 32-bit constant and bool taking 4 bytes
+            std::unordered_map<uint32_t, uint32_t> specialized;
+            for (const auto& entry : specialization.entries) {
+                if (entry.size == 4) {
+                    uint32_t value;
+                    std::memcpy(&value, specialization.data.data() + entry.offset, 4);
+                    specialized[entry.constantId] = value;
+                }
+            }
+
+            SpirvFunction* function = nullptr;
+
+            for (Uint64 offset = kSpirvHeaderWords; offset < wordCount;) {
+                const uint32_t* instruction = words + offset;
+                Uint32 count = instruction[0] >> 16;
+                uint32_t opcode = instruction[0] & 0xFFFF;
+
+                if (count == 0 || offset + count > wordCount) {
+                    error = "SPIR-V instruction at word " + std::to_string(offset) + " runs past the end of the module";
+                    return false;
+                }
+
+                auto addType = [&module, instruction](TypeKind kind, uint32_t element, uint32_t elementCount) -> SpirvType& {
+                    SpirvType& type = module.types[instruction[1]];
+                    type.kind = kind;
+                    type.element = element;
+                    type.count = elementCount;
+                    return type;
+                };
+
+                auto specializedValue = [&module, &specialized](uint32_t id, uint32_t value) {
+                    uint32_t specId = module.getDecorations(id).specId;
+                    auto found = specialized.find(specId);
+                    return specId != kNoSlot && found != specialized.end() ? found->second : value;
+                };
+
+                switch (opcode) {
+                    case OpExtInstImport: {
+                        std::string name = readString(instruction + 2, count - 2);
+                        module.imports[instruction[1]] = name == "GLSL.std.450" ? ImportKind::eGlsl
+                            : name.compare(0, 12, "NonSemantic.") == 0 ? ImportKind::eNonSemantic : ImportKind::eOther;
+                        break;
+                    }
+
+                    case OpEntryPoint:
+                        if (count >= 4) {
+                            module.entryPoints.push_back({ instruction[1], instruction[2], readString(instruction + 3, count - 3) });
+                        }
+                        break;
+
+                    case OpExecutionMode:
+                    case OpExecutionModeId:
+                        if ((instruction[2] == kExecutionModeLocalSize || instruction[2] == kExecutionModeLocalSizeId) && count >= 6) {
+                            module.localSizes[instruction[1]] = { instruction[3], instruction[4], instruction[5] };
+                            module.localSizeIds[instruction[1]] = instruction[2] == kExecutionModeLocalSizeId;
+                        }
+                        break;
+
+                    case OpDecorate: {
+                        if (count < 3) {
+                            break;
+                        }
+
+                        SpirvDecorations& decorations = module.decorations[instruction[1]];
+                        uint32_t literal = count > 3 ? instruction[3] : 0;
+
+                        switch (instruction[2]) {
+                            case DecorationSpecId: decorations.specId = literal; break;
+                            case DecorationBuiltIn: decorations.builtIn = literal; break;
+                            case DecorationBinding: decorations.binding = literal; break;
+                            case DecorationDescriptorSet: decorations.group = literal; break;
+                            case DecorationArrayStride: decorations.arrayStride = literal; break;
+                            default: break;
+                        }
+
+                        if (instruction[2] == DecorationBuiltIn && literal == BuiltInWorkgroupSize) {
+                            module.workgroupSizeConstant = instruction[1];
+                        }
+                        break;
+                    }
+
+                    case OpMemberDecorate: {
+                        if (count < 4) {
+                            break;
+                        }
+
+                        std::vector<SpirvMemberDecorations>& members = module.memberDecorations[instruction[1]];
+                        members.resize(std::max<size_t>(members.size(), instruction[2] + 1));
+
+                        SpirvMemberDecorations& decorations = members[instruction[2]];
+                        uint32_t literal = count > 4 ? instruction[4] : 0;
+
+                        switch (instruction[3]) {
+                            case DecorationOffset: decorations.offset = literal; break;
+                            case DecorationMatrixStride: decorations.matrixStride = literal; break;
+                            case DecorationRowMajor: decorations.rowMajor = true; break;
+                            default: break;
+                        }
+                        break;
+                    }
+
+                    case OpTypeVoid: addType(TypeKind::eVoid, 0, 0); break;
+                    case OpTypeBool: addType(TypeKind::eBool, 0, 1); break;
+
+                    case OpTypeInt:
+                        addType(instruction[2] == 32 ? TypeKind::eInt : TypeKind::eUnsupported, 0, 1).name =
+                            instruction[2] == 64 ? "64-bit integers" : instruction[2] == 16 ? "16-bit integers" : "8-bit integers";
+                        break;
+
+                    case OpTypeFloat:
+                        addType(instruction[2] == 32 ? TypeKind::eFloat : TypeKind::eUnsupported, 0, 1).name =
+                            instruction[2] == 64 ? "64-bit floats" : "16-bit floats";
+                        break;
+
+                    case OpTypeVector: addType(TypeKind::eVector, instruction[2], instruction[3]); break;
+                    case OpTypeMatrix: addType(TypeKind::eMatrix, instruction[2], instruction[3]); break;
+                    case OpTypeImage: addType(TypeKind::eUnsupported, 0, 0).name = "images"; break;
+                    case OpTypeSampler: addType(TypeKind::eUnsupported, 0, 0).name = "samplers"; break;
+                    case OpTypeSampledImage: addType(TypeKind::eUnsupported, 0, 0).name = "sampled images"; break;
+
+                    case OpTypeArray: {
+                        auto length = module.constants.find(instruction[3]);
+                        bool sized = length != module.constants.end() && length->second.supported && length->second.components.size() == 1;
+                        addType(sized ? TypeKind::eArray : TypeKind::eUnsupported, instruction[2], sized ? length->second.components[0] : 0)
+                            .name = "arrays sized by 64-bit constants";
+                        break;
+                    }
+
+                    case OpTypeRuntimeArray: addType(TypeKind::eRuntimeArray, instruction[2], 0); break;
+
+                    case OpTypeStruct:
+                        addType(TypeKind::eStruct, 0, 0).members.assign(instruction + 2, instruction + count);
+                        break;
+
+                    case OpTypePointer:
+                        addType(TypeKind::ePointer, instruction[3], 0).storageClass = instruction[2];
+                        break;
+
+                    case OpTypeFunction: addType(TypeKind::eFunction, instruction[2], 0); break;
+
+                    case OpConstantTrue:
+                    case OpConstantFalse:
+                        module.constants[instruction[2]] = { instruction[1], { toMask(opcode == OpConstantTrue) } };
+                        break;
+
+                    case OpSpecConstantTrue:
+                    case OpSpecConstantFalse:
+                        module.constants[instruction[2]] = { instruction[1],
+                            { toMask(specializedValue(instruction[2], opcode == OpSpecConstantTrue) != 0) } };
+                        break;
+
+                    case OpConstant:
+                    case OpSpecConstant: {
+                        SpirvConstant& constant = module.constants[instruction[2]];
+                        constant.type = instruction[1];
+                        constant.supported = count == 4;
+
+                        if (constant.supported) {
+                            constant.components = { opcode == OpSpecConstant ? specializedValue(instruction[2], instruction[3]) : instruction[3] };
+                        }
+                        break;
+                    }
+
+                    case OpConstantComposite:
+                    case OpSpecConstantComposite: {
+                        SpirvConstant& constant = module.constants[instruction[2]];
+                        constant.type = instruction[1];
+
+                        for (Uint32 i = 3; i < count; i++) {
+                            auto part = module.constants.find(instruction[i]);
+                            if (part == module.constants.end() || !part->second.supported) {
+                                constant.supported = false;
+                                break;
+                            }
+
+                            constant.components.insert(constant.components.end(), part->second.components.begin(), part->second.components.end());
+                        }
+                        break;
+                    }
+
+                    case OpConstantNull: {
+                        Uint32 components = module.getComponentCount(instruction[1]);
+                        module.constants[instruction[2]] = { instruction[1], std::vector<uint32_t>(components, 0), components != 0 };
+                        break;
+                    }
+
+                    case OpSpecConstantOp:
+                        if (!foldSpecConstantOp(module, instruction, count, error)) {
+                            return false;
+                        }
+                        break;
+
+                    case OpUndef:
+                        module.undefs[instruction[2]] = instruction[1];
+                        break;
+
+                    case OpVariable:
+                        if (function == nullptr) {
+                            module.variables[instruction[2]] = { instruction[1], instruction[3], count > 4 ? instruction[4] : 0 };
+                        } else if (!function->blocks.empty()) {
+                            function->blocks.back().instructions.push_back(offset);
+                        }
+                        break;
+
+                    case OpFunction:
+                        function = &module.functions[instruction[2]];
+                        function->resultType = instruction[1];
+                        break;
+
+                    case OpFunctionParameter:
+                        if (function != nullptr) {
+                            function->parameters.push_back(instruction[2]);
+                        }
+                        break;
+
+                    case OpFunctionEnd:
+                        function = nullptr;
+                        break;
+
+                    case OpLabel:
+                        if (function != nullptr) {
+                            function->blocks.push_back({ instruction[1], {} });
+                        }
+                        break;
+
+                    case OpNop:
+                    case OpLine:
+                    case OpNoLine:
+                    case OpLoopMerge:
+                    case OpSelectionMerge:
+                        break;
+
+                    default:
+                        if (function != nullptr && !function->blocks.empty()) {
+                            function->blocks.back().instructions.push_back(offset);
+                        }
+                        break;
+                }
+
+                offset += count;
+            }
+
+            return true;
+        }
+
+        // ===========================================================================================================================
+        // Translation
+        // ===========================================================================================================================
+
+        struct HandlerOp {
+            uint32_t opcode;
+            ComputeHandler handlers[2];
+        };
+
+        template <typename Lanes>
+        HandlerOp handlerOp(uint32_t opcode) {
+            return { opcode, { getHandler<Lanes>(false), getHandler<Lanes>(true) } };
+        }
+
+        const HandlerOp kGroupOps[] = {
+            handlerOp<GroupLanes<IAdd>>(OpGroupNonUniformIAdd), handlerOp<GroupLanes<FAdd>>(OpGroupNonUniformFAdd),
+            handlerOp<GroupLanes<IMul>>(OpGroupNonUniformIMul), handlerOp<GroupLanes<FMul>>(OpGroupNonUniformFMul),
+            handlerOp<GroupLanes<SMin>>(OpGroupNonUniformSMin), handlerOp<GroupLanes<UMin>>(OpGroupNonUniformUMin),
+            handlerOp<GroupLanes<FMin>>(OpGroupNonUniformFMin), handlerOp<GroupLanes<SMax>>(OpGroupNonUniformSMax),
+            handlerOp<GroupLanes<UMax>>(OpGroupNonUniformUMax), handlerOp<GroupLanes<FMax>>(OpGroupNonUniformFMax),
+            handlerOp<GroupLanes<BitwiseAnd>>(OpGroupNonUniformBitwiseAnd), handlerOp<GroupLanes<BitwiseOr>>(OpGroupNonUniformBitwiseOr),
+            handlerOp<GroupLanes<BitwiseXor>>(OpGroupNonUniformBitwiseXor), handlerOp<GroupLanes<BitwiseAnd>>(OpGroupNonUniformLogicalAnd),
+            handlerOp<GroupLanes<BitwiseOr>>(OpGroupNonUniformLogicalOr), handlerOp<GroupLanes<BitwiseXor>>(OpGroupNonUniformLogicalXor)
+        };
+
+        const HandlerOp kShuffleOps[] = {
+            handlerOp<ShuffleLanes<Shuffle::eIndex>>(OpGroupNonUniformShuffle), handlerOp<ShuffleLanes<Shuffle::eXor>>(OpGroupNonUniformShuffleXor),
+            handlerOp<ShuffleLanes<Shuffle::eUp>>(OpGroupNonUniformShuffleUp), handlerOp<ShuffleLanes<Shuffle::eDown>>(OpGroupNonUniformShuffleDown)
+        };
+
+        // Increment and decrement add and subtract a constant 1
+        const HandlerOp kAtomicOps[] = {
+            handlerOp<AtomicLanes<Exchange>>(OpAtomicExchange), handlerOp<AtomicLanes<IAdd>>(OpAtomicIIncrement),
+            handlerOp<AtomicLanes<ISub>>(OpAtomicIDecrement), handlerOp<AtomicLanes<IAdd>>(OpAtomicIAdd),
+            handlerOp<AtomicLanes<ISub>>(OpAtomicISub), handlerOp<AtomicLanes<SMin>>(OpAtomicSMin),
+            handlerOp<AtomicLanes<UMin>>(OpAtomicUMin), handlerOp<AtomicLanes<SMax>>(OpAtomicSMax),
+            handlerOp<AtomicLanes<UMax>>(OpAtomicUMax), handlerOp<AtomicLanes<BitwiseAnd>>(OpAtomicAnd),
+            handlerOp<AtomicLanes<BitwiseOr>>(OpAtomicOr), handlerOp<AtomicLanes<BitwiseXor>>(OpAtomicXor),
+            handlerOp<AtomicLanes<FAdd>>(OpAtomicFAddEXT)
+        };
+
+        // Where a pointer points: a byte offset into a memory space, the dynamic part in a slot.
+        // The layout of the pointee is explicit for buffers and push constants, packed otherwise.
+        struct Pointer {
+            uint32_t space = 0;
+            uint32_t offset = kNoSlot;
+            uint32_t constant = 0;
+            uint32_t type = 0;
+
+            // Of the matrix pointed at, or of the matrices of the array pointed at
+            uint32_t matrixStride = 0;
+            bool rowMajor = false;
+
+            // Between the components of the vector pointed at
+            uint32_t componentStride = 4;
+            bool explicitLayout = false;
+        };
+
+        // One slot per flattened scalar component. Composite operations only rearrange slots.
+        struct Value {
+            uint32_t type = 0;
+            std::vector<uint32_t> slots;
+            bool isPointer = false;
+            Pointer pointer;
+        };
+
+        enum class FixupKind : Uint8 {
+            eBlockStart,
+            eBlockExit,
+            eValue,
+            eSwitchDefault,
+            eSwitchCase
+        };
+
+        // Operands naming blocks and values not translated yet: field 0 is the immediate of the
+        // instruction at index, field 1 its extra, or the case of the switch at index
+        struct Fixup {
+            FixupKind kind;
+            uint32_t index;
+            uint32_t field;
+            uint32_t id;
+            uint32_t component;
+        };
+
+        // One inlined call of a function, the entry point being the outermost
+        struct Instance {
+            const SpirvFunction* function;
+            Uint32 depth = 0;
+
+            std::unordered_map<uint32_t, Value> values;
+            std::unordered_map<uint32_t, uint32_t> blockStarts;
+            std::unordered_map<uint32_t, uint32_t> blockExits;
+            std::vector<Fixup> fixups;
+
+            // Branches to the block after the call and the value each return passes
+            std::vector<uint32_t> returnBranches;
+            std::vector<std::pair<std::vector<uint32_t>, uint32_t>> returnValues;
+        };
+
+        constexpr Uint32 kMaxCallDepth = 64;
+
+        class Translator {
+        public:
+            Translator(const SpirvModule& module, ComputeProgram& program, std::vector<ComputeKernelBinding>& bindings)
+                : module(module), program(program), bindings(bindings) {}
+
+            bool translate(uint32_t entryFunction, std::string& error) {
+                auto found = this->module.functions.find(entryFunction);
+                if (found == this->module.functions.end() || found->second.blocks.empty()) {
+                    error = "Entry point function " + std::to_string(entryFunction) + " has no body";
+                    return false;
+                }
+
+                Instance instance;
+                instance.function = &found->second;
+                return this->translateFunction(instance, error);
+            }
+
+        private:
+            const SpirvModule& module;
+            ComputeProgram& program;
+            std::vector<ComputeKernelBinding>& bindings;
+
+            std::unordered_map<uint32_t, uint32_t> constantSlots;
+            std::unordered_map<uint32_t, Value> globals;
+            std::unordered_map<uint32_t, bool> checkedTypes;
+
+            // =======================================================================================================================
+            // Emission
+            // =======================================================================================================================
+
+            template <typename Lanes>
+            ComputeHandler handler() const {
+                return getHandler<Lanes>(this->program.vectorized);
+            }
+
+            ComputeHandler select(const ComputeHandler* handlers) const {
+                return handlers[this->program.vectorized ? 1 : 0];
+            }
+
+            uint32_t emit(ComputeHandler execute, uint32_t result, std::initializer_list<uint32_t> operands, uint32_t immediate = 0,
+                uint32_t extra = 0)
+            {
+                ComputeInstruction instruction{ execute, result, { kNoSlot, kNoSlot, kNoSlot, kNoSlot }, immediate, extra };
+                std::copy(operands.begin(), operands.end(), instruction.operands);
+
+                this->program.instructions.push_back(instruction);
+                return static_cast<uint32_t>(this->program.instructions.size() - 1);
+            }
+
+            uint32_t allocateSlot() {
+                return this->program.slotCount++;
+            }
+
+            // The result goes to a new slot
+            uint32_t emitValue(ComputeHandler execute, std::initializer_list<uint32_t> operands, uint32_t immediate = 0,
+                uint32_t extra = 0)
+            {
+                uint32_t slot = this->allocateSlot();
+                this->emit(execute, slot, operands, immediate, extra);
+                return slot;
+            }
+
+            uint32_t getConstantSlot(uint32_t value) {
+                auto found = this->constantSlots.find(value);
+                if (found != this->constantSlots.end()) {
+                    return found->second;
+                }
+
+                uint32_t slot = this->allocateSlot();
+                this->program.constants.push_back({ slot, value });
+                this->constantSlots[value] = slot;
+                return slot;
+            }
+
+            uint32_t getFloatSlot(float value) {
+                return this->getConstantSlot(toBits(value));
+            }
+
+            void beginBlock() {
+                uint32_t first = static_cast<uint32_t>(this->program.instructions.size());
+                this->program.blocks.push_back({ first, first });
+            }
+
+            void endBlock() {
+                this->program.blocks.back().end = static_cast<uint32_t>(this->program.instructions.size());
+            }
+
+            uint32_t getCurrentBlock() const {
+                return static_cast<uint32_t>(this->program.blocks.size() - 1);
+            }
+
+            // Ends the block in a branch to the block begun right after
+            void splitBlock(ComputeHandler terminator) {
+                this->emit(terminator, kNoSlot, {}, static_cast<uint32_t>(this->program.blocks.size()));
+                this->endBlock();
+                this->beginBlock();
+            }
+
+            // =======================================================================================================================
+            // Types And Values
+            // =======================================================================================================================
+
+            bool checkType(uint32_t id, std::string& error) {
+                if (this->checkedTypes.count(id) != 0) {
+                    return true;
+                }
+
+                const SpirvType* type = this->module.findType(id);
+                if (type == nullptr) {
+                    error = "SPIR-V type " + std::to_string(id) + " is not declared";
+                    return false;
+                }
+
+                if (type->kind == TypeKind::eUnsupported) {
+                    error = std::string("Compute kernels do not support ") + type->name;
+                    return false;
+                }
+
+                // Marked first, pointers may lead back to the type
+                this->checkedTypes[id] = true;
+
+                switch (type->kind) {
+                    case TypeKind::eVector:
+                    case TypeKind::eMatrix:
+                    case TypeKind::eArray:
+                    case TypeKind::eRuntimeArray:
+                    case TypeKind::ePointer:
+                        return this->checkType(type->element, error);
+                    case TypeKind::eStruct:
+                        for (uint32_t member : type->members) {
+                            if (!this->checkType(member, error)) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    default:
+                        return true;
+                }
+            }
+
+            // Packed layout: 4 bytes per scalar, in flattened component order
+            Uint64 getNaturalSize(uint32_t id) const {
+                return static_cast<Uint64>(this->module.getComponentCount(id)) * 4;
+            }
+
+            bool defineValue(Instance& instance, uint32_t id, uint32_t type, std::vector<uint32_t> slots, std::string& error) {
+                if (!this->checkType(type, error)) {
+                    return false;
+                }
+
+                Value& value = instance.values[id];
+                value.type = type;
+                value.slots = std::move(slots);
+                return true;
+            }
+
+            bool isGlobal(uint32_t id) const {
+                return this->module.constants.count(id) != 0 || this->module.undefs.count(id) != 0
+                    || this->module.variables.count(id) != 0;
+            }
+
+            const Value* getValue(Instance& instance, uint32_t id, std::string& error) {
+                auto local = instance.values.find(id);
+                if (local != instance.values.end()) {
+                    return &local->second;
+                }
+
+                auto global = this->globals.find(id);
+                if (global != this->globals.end()) {
+                    return &global->second;
+                }
+
+                Value value;
+                auto constant = this->module.constants.find(id);
+                auto undef = this->module.undefs.find(id);
+                auto variable = this->module.variables.find(id);
+
+                if (constant != this->module.constants.end()) {
+                    if (!this->checkType(constant->second.type, error)) {
+                        return nullptr;
+                    }
+
+                    if (!constant->second.supported) {
+                        error = "Constant " + std::to_string(id) + " has a type compute kernels do not support";
+                        return nullptr;
+                    }
+
+                    value.type = constant->second.type;
+                    for (uint32_t component : constant->second.components) {
+                        value.slots.push_back(this->getConstantSlot(component));
+                    }
+                } else if (undef != this->module.undefs.end()) {
+                    if (!this->checkType(undef->second, error)) {
+                        return nullptr;
+                    }
+
+                    value.type = undef->second;
+                    value.slots.assign(this->module.getComponentCount(undef->second), this->getConstantSlot(0));
+                } else if (variable != this->module.variables.end()) {
+                    if (!this->resolveVariable(id, variable->second, value, error)) {
+                        return nullptr;
+                    }
+                } else {
+                    error = "SPIR-V value " + std::to_string(id) + " is used before it is defined";
+                    return nullptr;
+                }
+
+                return &(this->globals[id] = std::move(value));
+            }
+
+            uint32_t getScalar(Instance& instance, uint32_t id, std::string& error) {
+                const Value* value = this->getValue(instance, id, error);
+                if (value == nullptr) {
+                    return kNoSlot;
+                }
+
+                if (value->isPointer || value->slots.size() != 1) {
+                    error = "SPIR-V value " + std::to_string(id) + " is not a scalar";
+                    return kNoSlot;
+                }
+
+                return value->slots[0];
+            }
+
+            const Value* getPointer(Instance& instance, uint32_t id, std::string& error) {
+                const Value* value = this->getValue(instance, id, error);
+                if (value != nullptr && !value->isPointer) {
+                    error = "SPIR-V value " + std::to_string(id) + " is not a pointer";
+                    return nullptr;
+                }
+
+                return value;
+            }
+
+            bool getConstant(uint32_t id, uint32_t& value) const {
+                auto found = this->module.constants.find(id);
+                if (found == this->module.constants.end() || !found->second.supported || found->second.components.size() != 1) {
+                    return false;
+                }
+
+                value = found->second.components[0];
+                return true;
+            }
+
+            // Offset into the interleaved private space
+            uint32_t allocatePrivate(uint32_t type) {
+                uint32_t offset = static_cast<uint32_t>(this->program.privateBytes * kComputeLanes);
+                this->program.privateBytes += this->getNaturalSize(type);
+                this->program.privateImage.resize(this->program.privateBytes * kComputeLanes);
+                return offset;
+            }
+
+            bool resolveVariable(uint32_t id, const SpirvVariable& variable, Value& value, std::string& error) {
+                if (!this->checkType(variable.type, error)) {
+                    return false;
+                }
+
+                const SpirvType* pointerType = this->module.findType(variable.type);
+                const SpirvType* pointee = this->module.findType(pointerType->element);
+                const SpirvDecorations& decorations = this->module.getDecorations(id);
+
+                value.type = variable.type;
+                value.isPointer = true;
+                value.pointer.type = pointerType->element;
+
+                switch (variable.storageClass) {
+                    case StorageClassStorageBuffer:
+                    case StorageClassUniform:
+                        if (pointee->kind == TypeKind::eArray || pointee->kind == TypeKind::eRuntimeArray) {
+                            error = "Compute kernels do not support arrays of buffers";
+                            return false;
+                        }
+
+                        value.pointer.space = kBindingSpaces + static_cast<uint32_t>(this->bindings.size());
+                        value.pointer.explicitLayout = true;
+                        this->bindings.push_back({ decorations.group, decorations.binding });
+                        return true;
+
+                    case StorageClassPushConstant:
+                        value.pointer.space = kPushSpace;
+                        value.pointer.explicitLayout = true;
+                        return true;
+
+                    case StorageClassWorkgroup:
+                        value.pointer.space = kWorkgroupSpace;
+                        value.pointer.constant = static_cast<uint32_t>(this->program.workgroupBytes);
+                        this->program.workgroupBytes += this->getNaturalSize(pointerType->element);
+                        return true;
+
+                    case StorageClassPrivate: {
+                        value.pointer.space = kPrivateSpace;
+                        value.pointer.constant = this->allocatePrivate(pointerType->element);
+
+                        auto initializer = this->module.constants.find(variable.initializer);
+                        if (initializer != this->module.constants.end() && initializer->second.supported) {
+                            const std::vector<uint32_t>& components = initializer->second.components;
+                            uint8_t* image = this->program.privateImage.data() + value.pointer.constant;
+
+                            for (size_t i = 0; i < components.size() * kComputeLanes; i++) {
+                                std::memcpy(image + i * 4, &components[i / kComputeLanes], 4);
+                            }
+                        }
+                        return true;
+                    }
+
+                    case StorageClassInput: {
+                        value.pointer.space = kInputSpace;
+
+                        // The inputs are interleaved too
+
+                        switch (decorations.builtIn) {
+                            case BuiltInLocalInvocationId: value.pointer.constant = kInputLocalId * kComputeLanes; return true;
+                            case BuiltInGlobalInvocationId: value.pointer.constant = kInputGlobalId * kComputeLanes; return true;
+                            case BuiltInWorkgroupId: value.pointer.constant = kInputWorkgroupId * kComputeLanes; return true;
+                            case BuiltInNumWorkgroups: value.pointer.constant = kInputNumWorkgroups * kComputeLanes; return true;
+                            case BuiltInLocalInvocationIndex: value.pointer.constant = kInputLocalIndex * kComputeLanes; return true;
+                            case BuiltInSubgroupSize: value.pointer.constant = kInputSubgroupSize * kComputeLanes; return true;
+                            case BuiltInSubgroupLocalInvocationId: value.pointer.constant = kInputSubgroupLocalId * kComputeLanes; return true;
+                            case BuiltInNumSubgroups: value.pointer.constant = kInputNumSubgroups * kComputeLanes; return true;
+                            case BuiltInSubgroupId: value.pointer.constant = kInputSubgroupId * kComputeLanes; return true;
+                            default:
+                                error = "Compute kernels do not support the input variable " + std::to_string(id);
+                                return false;
+                        }
+                    }
+
+                    default:
+                        error = "Compute kernels do not support variables of storage class " + std::to_string(variable.storageClass);
+                        return false;
+                }
+            }
+
+            // =======================================================================================================================
+            // Memory
+            // =======================================================================================================================
+
+            // Steps into member or element index, the constant one when indexSlot is kNoSlot
+            bool accessElement(const Pointer& base, uint32_t index, uint32_t indexSlot, Pointer& element, std::string& error) {
+                const SpirvType* type = this->module.findType(base.type);
+                element = base;
+                element.componentStride = 4;
+
+                // Packed words of interleaved spaces are kComputeLanes words apart
+                Uint64 scale = base.space == kPrivateSpace || base.space == kInputSpace ? kComputeLanes : 1;
+                Uint64 stride = 0;
+
+                switch (type != nullptr ? type->kind : TypeKind::eUnsupported) {
+                    case TypeKind::eStruct: {
+                        if (indexSlot != kNoSlot || index >= type->members.size()) {
+                            error = "Access chain indexes struct " + std::to_string(base.type) + " out of range";
+                            return false;
+                        }
+
+                        const SpirvMemberDecorations& decorations = this->module.getMemberDecorations(base.type, index);
+                        Uint64 offset = 0;
+
+                        if (!base.explicitLayout) {
+                            for (uint32_t member = 0; member < index; member++) {
+                                offset += this->getNaturalSize(type->members[member]) * scale;
+                            }
+                        } else if (decorations.offset != kNoSlot) {
+                            offset = decorations.offset;
+                        } else {
+                            error = "Member " + std::to_string(index) + " of struct " + std::to_string(base.type) + " has no offset";
+                            return false;
+                        }
+
+                        element.type = type->members[index];
+                        element.constant += static_cast<uint32_t>(offset);
+                        element.matrixStride = decorations.matrixStride;
+                        element.rowMajor = decorations.rowMajor;
+                        return true;
+                    }
+
+                    case TypeKind::eArray:
+                    case TypeKind::eRuntimeArray: {
+                        uint32_t arrayStride = this->module.getDecorations(base.type).arrayStride;
+                        stride = base.explicitLayout && arrayStride != 0 ? arrayStride : this->getNaturalSize(type->element) * scale;
+                        break;
+                    }
+
+                    case TypeKind::eMatrix: {
+                        Uint64 rows = this->module.getComponentCount(type->element);
+                        Uint64 matrixStride = base.explicitLayout && base.matrixStride != 0 ? base.matrixStride : rows * 4 * scale;
+
+                        stride = base.rowMajor ? 4 : matrixStride;
+                        element.componentStride = base.rowMajor ? static_cast<uint32_t>(matrixStride) : 4;
+                        break;
+                    }
+
+                    case TypeKind::eVector:
+                        stride = base.componentStride * scale;
+                        break;
+
+                    default:
+                        error = "Access chain steps into scalar type " + std::to_string(base.type);
+                        return false;
+                }
+
+                element.type = type->element;
+
+                if (indexSlot == kNoSlot) {
+                    element.constant += static_cast<uint32_t>(index * stride);
+                } else if (base.offset == kNoSlot) {
+                    element.offset = this->emitValue(this->handler<OffsetLanes<false>>(), { indexSlot }, static_cast<uint32_t>(stride));
+                } else {
+                    element.offset = this->emitValue(this->handler<OffsetLanes<true>>(), { indexSlot, base.offset },
+                        static_cast<uint32_t>(stride));
+                }
+
+                return true;
+            }
+
+            Uint32 getElementCount(uint32_t id) const {
+                const SpirvType* type = this->module.findType(id);
+                return type->kind == TypeKind::eStruct ? static_cast<Uint32>(type->members.size()) : type->count;
+            }
+
+            bool isScalar(uint32_t id) const {
+                const SpirvType* type = this->module.findType(id);
+                return type->kind == TypeKind::eBool || type->kind == TypeKind::eInt || type->kind == TypeKind::eFloat;
+            }
+
+            bool loadValue(const Pointer& pointer, std::vector<uint32_t>& slots, std::string& error) {
+                if (this->module.findType(pointer.type)->kind == TypeKind::eRuntimeArray) {
+                    error = "Compute kernels cannot load runtime arrays whole";
+                    return false;
+                }
+
+                if (this->isScalar(pointer.type)) {
+                    ComputeHandler execute = pointer.offset != kNoSlot ? this->handler<LoadLanes<true>>() : this->handler<LoadLanes<false>>();
+                    slots.push_back(this->emitValue(execute, { pointer.offset }, pointer.constant, pointer.space));
+                    return true;
+                }
+
+                for (Uint32 i = 0; i < this->getElementCount(pointer.type); i++) {
+                    Pointer element;
+                    if (!this->accessElement(pointer, i, kNoSlot, element, error) || !this->loadValue(element, slots, error)) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            // Stores slots from next on, advancing next past them
+            bool storeValue(const Pointer& pointer, const std::vector<uint32_t>& slots, size_t& next, std::string& error) {
+                if (this->module.findType(pointer.type)->kind == TypeKind::eRuntimeArray) {
+                    error = "Compute kernels cannot store runtime arrays whole";
+                    return false;
+                }
+
+                if (this->isScalar(pointer.type)) {
+                    if (next >= slots.size()) {
+                        error = "Stored value has fewer components than its pointer type";
+                        return false;
+                    }
+
+                    ComputeHandler execute = pointer.offset != kNoSlot ? this->handler<StoreLanes<true>>() : this->handler<StoreLanes<false>>();
+                    this->emit(execute, kNoSlot, { pointer.offset, slots[next++] }, pointer.constant, pointer.space);
+                    return true;
+                }
+
+                for (Uint32 i = 0; i < this->getElementCount(pointer.type); i++) {
+                    Pointer element;
+                    if (!this->accessElement(pointer, i, kNoSlot, element, error) || !this->storeValue(element, slots, next, error)) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            bool translateAccessChain(Instance& instance, const uint32_t* words, Uint32 count, std::string& error) {
+                const Value* base = this->getPointer(instance, words[3], error);
+                if (base == nullptr) {
+                    return false;
+                }
+
+                Value result;
+                result.type = words[1];
+                result.isPointer = true;
+                result.pointer = base->pointer;
+
+                for (Uint32 i = 4; i < count; i++) {
+                    uint32_t index = 0;
+                    uint32_t indexSlot = kNoSlot;
+
+                    if (!this->getConstant(words[i], index)) {
+                        indexSlot = this->getScalar(instance, words[i], error);
+                        if (indexSlot == kNoSlot) {
+                            return false;
+                        }
+                    }
+
+                    Pointer element;
+                    if (!this->accessElement(result.pointer, index, indexSlot, element, error)) {
+                        return false;
+                    }
+                    result.pointer = element;
+                }
+
+                instance.values[words[2]] = std::move(result);
+                return true;
+            }
+
+            bool translateAtomic(Instance& instance, uint32_t opcode, const uint32_t* words, Uint32 count, std::string& error) {
+                // Stores have no result type and result
+                Uint32 pointerWord = opcode == OpAtomicStore ? 1 : 3;
+                const Value* pointer = count > pointerWord ? this->getPointer(instance, words[pointerWord], error) : nullptr;
+                if (pointer == nullptr) {
+                    return false;
+                }
+
+                if (!this->isScalar(pointer->pointer.type)) {
+                    error = "Atomic operations need a pointer to a scalar";
+                    return false;
+                }
+
+                const Pointer& target = pointer->pointer;
+
+                if (opcode == OpAtomicStore) {
+                    uint32_t value = this->getScalar(instance, words[4], error);
+                    if (value == kNoSlot) {
+                        return false;
+                    }
+
+                    this->emit(this->handler<AtomicStoreLanes>(), kNoSlot, { target.offset, value }, target.constant, target.space);
+                    return true;
+                }
+
+                uint32_t result = this->allocateSlot();
+
+                if (opcode == OpAtomicLoad) {
+                    this->emit(this->handler<AtomicLoadLanes>(), result, { target.offset }, target.constant, target.space);
+                } else if (opcode == OpAtomicCompareExchange || opcode == OpAtomicCompareExchangeWeak) {
+                    uint32_t value = this->getScalar(instance, words[7], error);
+                    uint32_t comparator = value != kNoSlot ? this->getScalar(instance, words[8], error) : kNoSlot;
+                    if (comparator == kNoSlot) {
+                        return false;
+                    }
+
+                    this->emit(this->handler<CompareExchangeLanes>(), result, { target.offset, value, comparator }, target.constant, target.space);
+                } else {
+                    bool unit = opcode == OpAtomicIIncrement || opcode == OpAtomicIDecrement;
+                    uint32_t value = unit ? this->getConstantSlot(1) : this->getScalar(instance, words[6], error);
+                    if (value == kNoSlot) {
+                        return false;
+                    }
+
+                    this->emit(this->select(findOp(kAtomicOps, opcode)->handlers), result, { target.offset, value }, target.constant, target.space);
+                }
+
+                return this->defineValue(instance, words[2], words[1], { result }, error);
+            }
+
+            // =======================================================================================================================
+            // Arithmetic
+            // =======================================================================================================================
+
+            // One instruction per component of the result, scalar operands broadcast
+            bool emitComponentwise(Instance& instance, uint32_t resultType, uint32_t result, ComputeHandler execute,
+                const uint32_t* operandIds, Uint32 operandCount, std::string& error)
+            {
+                std::vector<const Value*> operands;
+                for (Uint32 i = 0; i < operandCount; i++) {
+                    const Value* operand = this->getValue(instance, operandIds[i], error);
+                    if (operand == nullptr) {
+                        return false;
+                    }
+
+                    if (operand->isPointer || operand->slots.empty()) {
+                        error = "SPIR-V value " + std::to_string(operandIds[i]) + " is not an arithmetic operand";
+                        return false;
+                    }
+
+                    operands.push_back(operand);
+                }
+
+                std::vector<uint32_t> slots;
+                for (Uint32 component = 0; component < this->module.getComponentCount(resultType); component++) {
+                    uint32_t operandSlots[4] = { kNoSlot, kNoSlot, kNoSlot, kNoSlot };
+
+                    for (Uint32 i = 0; i < operandCount; i++) {
+                        const std::vector<uint32_t>& source = operands[i]->slots;
+                        operandSlots[i] = source[std::min<size_t>(component, source.size() - 1)];
+                    }
+
+                    slots.push_back(this->emitValue(execute, { operandSlots[0], operandSlots[1], operandSlots[2], operandSlots[3] }));
+                }
+
+                return this->defineValue(instance, result, resultType, std::move(slots), error);
+            }
+
+            // Elements of a are strideA slots apart, to walk the rows of a matrix
+            uint32_t emitDot(const uint32_t* a, Uint32 strideA, const uint32_t* b, Uint32 count) {
+                uint32_t sum = this->emitValue(this->handler<BinaryLanes<FMul>>(), { a[0], b[0] });
+
+                for (Uint32 i = 1; i < count; i++) {
+                    sum = this->emitValue(this->handler<TernaryLanes<Fma>>(), { a[i * strideA], b[i], sum });
+                }
+
+                return sum;
+            }
+
+            // Operands of an instruction as flattened slots
+            bool getOperands(Instance& instance, const uint32_t* ids, Uint32 count, std::vector<std::vector<uint32_t>>& operands,
+                std::string& error)
+            {
+                for (Uint32 i = 0; i < count; i++) {
+                    const Value* value = this->getValue(instance, ids[i], error);
+                    if (value == nullptr) {
+                        return false;
+                    }
+
+                    if (value->isPointer) {
+                        error = "SPIR-V value " + std::to_string(ids[i]) + " is a pointer";
+                        return false;
+                    }
+
+                    operands.push_back(value->slots);
+                }
+
+                return true;
+            }
+
+            bool translateMatrix(Instance& instance, uint32_t opcode, const uint32_t* words, std::string& error) {
+                std::vector<std::vector<uint32_t>> operands;
+                if (!this->getOperands(instance, words + 3, 2, operands, error)) {
+                    return false;
+                }
+
+                const std::vector<uint32_t>& a = operands[0];
+                const std::vector<uint32_t>& b = operands[1];
+                std::vector<uint32_t> slots;
+
+                switch (opcode) {
+                    case OpVectorTimesScalar:
+                    case OpMatrixTimesScalar:
+                        for (uint32_t component : a) {
+                            slots.push_back(this->emitValue(this->handler<BinaryLanes<FMul>>(), { component, b[0] }));
+                        }
+                        break;
+
+                    case OpDot:
+                        slots.push_back(this->emitDot(a.data(), 1, b.data(), static_cast<Uint32>(a.size())));
+                        break;
+
+                    // Column c of a matrix with r rows is slots [c * r, c * r + r)
+                    case OpMatrixTimesVector: {
+                        Uint32 rows = static_cast<Uint32>(a.size() / b.size());
+
+                        for (Uint32 row = 0; row < rows; row++) {
+                            slots.push_back(this->emitDot(a.data() + row, rows, b.data(), static_cast<Uint32>(b.size())));
+                        }
+                        break;
+                    }
+
+                    case OpVectorTimesMatrix: {
+                        Uint32 rows = static_cast<Uint32>(a.size());
+                        for (Uint32 column = 0; column < b.size() / rows; column++) {
+                            slots.push_back(this->emitDot(b.data() + column * rows, 1, a.data(), rows));
+                        }
+                        break;
+                    }
+
+                    case OpMatrixTimesMatrix: {
+                        Uint32 rows = this->module.getComponentCount(this->module.findType(words[1])->element);
+                        Uint32 inner = static_cast<Uint32>(a.size() / rows);
+
+                        for (Uint32 column = 0; column < b.size() / inner; column++) {
+                            for (Uint32 row = 0; row < rows; row++) {
+                                slots.push_back(this->emitDot(a.data() + row, rows, b.data() + column * inner, inner));
+                            }
+                        }
+                        break;
+                    }
+
+                    case OpOuterProduct:
+                        for (uint32_t column : b) {
+                            for (uint32_t row : a) {
+                                slots.push_back(this->emitValue(this->handler<BinaryLanes<FMul>>(), { row, column }));
+                            }
+                        }
+                        break;
+                }
+
+                return this->defineValue(instance, words[2], words[1], std::move(slots), error);
+            }
+
+            bool translateGlsl(Instance& instance, const uint32_t* words, Uint32 count, std::string& error) {
+                uint32_t resultType = words[1];
+                uint32_t result = words[2];
+                uint32_t operation = words[4];
+                const uint32_t* ids = words + 5;
+                Uint32 idCount = count - 5;
+
+                if (const UnaryOp* unary = idCount == 1 ? findOp(kGlslUnaryOps, operation) : nullptr) {
+                    return this->emitComponentwise(instance, resultType, result, this->select(unary->handlers), ids, 1, error);
+                }
+
+                if (const BinaryOp* binary = idCount == 2 ? findOp(kGlslBinaryOps, operation) : nullptr) {
+                    return this->emitComponentwise(instance, resultType, result, this->select(binary->handlers), ids, 2, error);
+                }
+
+                if (const TernaryOp* ternary = idCount == 3 ? findOp(kGlslTernaryOps, operation) : nullptr) {
+                    return this->emitComponentwise(instance, resultType, result, this->select(ternary->handlers), ids, 3, error);
+                }
+
+                std::vector<std::vector<uint32_t>> operands;
+                if (!this->getOperands(instance, ids, idCount, operands, error)) {
+                    return false;
+                }
+
+                auto fmul = this->handler<BinaryLanes<FMul>>();
+                auto fsub = this->handler<BinaryLanes<FSub>>();
+                std::vector<uint32_t> slots;
+
+                auto dot = [this, &operands](Uint32 a, Uint32 b) {
+                    return this->emitDot(operands[a].data(), 1, operands[b].data(), static_cast<Uint32>(operands[a].size()));
+                };
+
+                switch (operation) {
+                    case GlslPackUnorm4x8:
+                    case GlslPackSnorm4x8: {
+                        const std::vector<uint32_t>& v = operands[0];
+                        ComputeHandler execute = operation == GlslPackUnorm4x8 ? this->handler<QuaternaryLanes<PackUnorm4x8>>()
+                            : this->handler<QuaternaryLanes<PackSnorm4x8>>();
+                        slots.push_back(this->emitValue(execute, { v[0], v[1], v[2], v[3] }));
+                        break;
+                    }
+
+                    case GlslPackUnorm2x16:
+                    case GlslPackSnorm2x16:
+                    case GlslPackHalf2x16: {
+                        const std::vector<uint32_t>& v = operands[0];
+                        ComputeHandler execute = operation == GlslPackUnorm2x16 ? this->handler<BinaryLanes<PackUnorm2x16>>()
+                            : operation == GlslPackSnorm2x16 ? this->handler<BinaryLanes<PackSnorm2x16>>()
+                            : this->handler<BinaryLanes<PackHalf2x16>>();
+                        slots.push_back(this->emitValue(execute, { v[0], v[1] }));
+                        break;
+                    }
+
+                    case GlslUnpackUnorm2x16:
+                    case GlslUnpackSnorm2x16:
+                    case GlslUnpackHalf2x16:
+                    case GlslUnpackUnorm4x8:
+                    case GlslUnpackSnorm4x8: {
+                        ComputeHandler execute = operation == GlslUnpackUnorm2x16 ? this->handler<ImmediateLanes<UnpackUnorm2x16>>()
+                            : operation == GlslUnpackSnorm2x16 ? this->handler<ImmediateLanes<UnpackSnorm2x16>>()
+                            : operation == GlslUnpackHalf2x16 ? this->handler<ImmediateLanes<UnpackHalf2x16>>()
+                            : operation == GlslUnpackUnorm4x8 ? this->handler<ImmediateLanes<UnpackUnorm4x8>>()
+                            : this->handler<ImmediateLanes<UnpackSnorm4x8>>();
+
+                        for (uint32_t component = 0; component < this->module.getComponentCount(resultType); component++) {
+                            slots.push_back(this->emitValue(execute, { operands[0][0] }, component));
+                        }
+                        break;
+                    }
+
+                    case GlslLength:
+                        slots.push_back(this->emitValue(this->handler<UnaryLanes<Sqrt>>(), { dot(0, 0) }));
+                        break;
+
+                    case GlslDistance: {
+                        std::vector<uint32_t> difference;
+                        for (size_t i = 0; i < operands[0].size(); i++) {
+                            difference.push_back(this->emitValue(fsub, { operands[0][i], operands[1][i] }));
+                        }
+
+                        uint32_t squared = this->emitDot(difference.data(), 1, difference.data(), static_cast<Uint32>(difference.size()));
+                        slots.push_back(this->emitValue(this->handler<UnaryLanes<Sqrt>>(), { squared }));
+                        break;
+                    }
+
+                    case GlslCross: {
+                        const std::vector<uint32_t>& a = operands[0];
+                        const std::vector<uint32_t>& b = operands[1];
+
+                        for (Uint32 i = 0; i < 3; i++) {
+                            Uint32 j = (i + 1) % 3;
+                            Uint32 k = (i + 2) % 3;
+                            slots.push_back(this->emitValue(fsub, { this->emitValue(fmul, { a[j], b[k] }), this->emitValue(fmul, { a[k], b[j] }) }));
+                        }
+                        break;
+                    }
+
+                    case GlslNormalize: {
+                        uint32_t scale = this->emitValue(this->handler<UnaryLanes<InverseSqrt>>(), { dot(0, 0) });
+                        for (uint32_t component : operands[0]) {
+                            slots.push_back(this->emitValue(fmul, { component, scale }));
+                        }
+                        break;
+                    }
+
+                    // N when dot(Nref, I) is below zero, -N otherwise
+                    case GlslFaceForward: {
+                        uint32_t facing = this->emitValue(this->handler<BinaryLanes<FOrdLessThan>>(), { dot(2, 1), this->getFloatSlot(0.0f) });
+                        for (uint32_t component : operands[0]) {
+                            uint32_t negated = this->emitValue(this->handler<UnaryLanes<FNegate>>(), { component });
+                            slots.push_back(this->emitValue(this->handler<TernaryLanes<Select>>(), { facing, component, negated }));
+                        }
+                        break;
+                    }
+
+                    // I - 2 dot(N, I) N
+                    case GlslReflect: {
+                        uint32_t scale = this->emitValue(fmul, { dot(1, 0), this->getFloatSlot(2.0f) });
+                        for (size_t i = 0; i < operands[0].size(); i++) {
+                            slots.push_back(this->emitValue(fsub, { operands[0][i], this->emitValue(fmul, { scale, operands[1][i] }) }));
+                        }
+                        break;
+                    }
+
+                    // k = 1 - eta^2 (1 - dot(N, I)^2), zero when k < 0, eta I - (eta dot(N, I) + sqrt(k)) N otherwise
+                    case GlslRefract: {
+                        uint32_t eta = operands[2][0];
+                        uint32_t cosine = dot(1, 0);
+                        uint32_t one = this->getFloatSlot(1.0f);
+
+                        uint32_t sine = this->emitValue(fsub, { one, this->emitValue(fmul, { cosine, cosine }) });
+                        uint32_t k = this->emitValue(fsub, { one, this->emitValue(fmul, { this->emitValue(fmul, { eta, eta }), sine }) });
+                        uint32_t total = this->emitValue(this->handler<BinaryLanes<FOrdLessThan>>(), { k, this->getFloatSlot(0.0f) });
+                        uint32_t scale = this->emitValue(this->handler<TernaryLanes<Fma>>(),
+                            { eta, cosine, this->emitValue(this->handler<UnaryLanes<Sqrt>>(), { k }) });
+
+                        for (size_t i = 0; i < operands[0].size(); i++) {
+                            uint32_t refracted = this->emitValue(fsub, { this->emitValue(fmul, { eta, operands[0][i] }),
+                                this->emitValue(fmul, { scale, operands[1][i] }) });
+                            slots.push_back(this->emitValue(this->handler<TernaryLanes<Select>>(), { total, this->getFloatSlot(0.0f), refracted }));
+                        }
+                        break;
+                    }
+
+                    default:
+                        error = "Compute kernels do not support GLSL.std.450 instruction " + std::to_string(operation);
+                        return false;
+                }
+
+                return this->defineValue(instance, result, resultType, std::move(slots), error);
+            }
+
+            bool translateSubgroup(Instance& instance, uint32_t opcode, const uint32_t* words, Uint32 count, std::string& error) {
+                uint32_t resultType = words[1];
+                uint32_t result = words[2];
+
+                if (opcode == OpGroupNonUniformElect) {
+                    return this->defineValue(instance, result, resultType, { this->emitValue(this->handler<ElectLanes>(), {}) }, error);
+                }
+
+                // Arithmetic takes the group operation before the value
+                const HandlerOp* group = findOp(kGroupOps, opcode);
+                Uint32 valueWord = group != nullptr || opcode == OpGroupNonUniformBallotBitCount ? 5 : 4;
+
+                std::vector<std::vector<uint32_t>> operands;
+                if (count <= valueWord || !this->getOperands(instance, words + valueWord, count - valueWord, operands, error)) {
+                    if (error.empty()) {
+                        error = "Subgroup instruction " + std::to_string(opcode) + " has too few operands";
+                    }
+                    return false;
+                }
+
+                const std::vector<uint32_t>& value = operands[0];
+                std::vector<uint32_t> slots;
+
+                switch (opcode) {
+                    case OpGroupNonUniformAll:
+                        slots.push_back(this->emitValue(this->handler<VoteLanes<Vote::eAll>>(), { value[0] }));
+                        break;
+
+                    case OpGroupNonUniformAny:
+                        slots.push_back(this->emitValue(this->handler<VoteLanes<Vote::eAny>>(), { value[0] }));
+                        break;
+
+                    case OpGroupNonUniformAllEqual: {
+                        uint32_t equal = kNoSlot;
+                        for (uint32_t component : value) {
+                            uint32_t vote = this->emitValue(this->handler<VoteLanes<Vote::eAllEqual>>(), { component });
+                            equal = equal == kNoSlot ? vote : this->emitValue(this->handler<BinaryLanes<BitwiseAnd>>(), { equal, vote });
+                        }
+                        slots.push_back(equal);
+                        break;
+                    }
+
+                    case OpGroupNonUniformBroadcast:
+                    case OpGroupNonUniformBroadcastFirst:
+                        for (uint32_t component : value) {
+                            bool indexed = opcode == OpGroupNonUniformBroadcast;
+                            slots.push_back(this->emitValue(this->handler<BroadcastLanes>(), { component, indexed ? operands[1][0] : kNoSlot },
+                                indexed ? 1 : 0));
+                        }
+                        break;
+
+                    // Lanes past the warp size are never set
+                    case OpGroupNonUniformBallot:
+                        slots.push_back(this->emitValue(this->handler<BallotLanes>(), { value[0] }));
+                        slots.resize(4, this->getConstantSlot(0));
+                        break;
+
+                    case OpGroupNonUniformBallotBitExtract:
+                        slots.push_back(this->emitValue(this->handler<BallotBitExtractLanes>(), { value[0], operands[1][0] }));
+                        break;
+
+                    case OpGroupNonUniformBallotBitCount:
+                        if (words[4] > GroupOperationExclusiveScan) {
+                            error = "Subgroup ballot counts do not support group operation " + std::to_string(words[4]);
+                            return false;
+                        }
+
+                        slots.push_back(this->emitValue(this->handler<BallotBitCountLanes>(), { value[0] }, words[4]));
+                        break;
+
+                    default:
+                        if (const HandlerOp* shuffle = findOp(kShuffleOps, opcode)) {
+                            for (uint32_t component : value) {
+                                slots.push_back(this->emitValue(this->select(shuffle->handlers), { component, operands[1][0] }));
+                            }
+                            break;
+                        }
+
+                        if (group == nullptr || words[4] > GroupOperationClusteredReduce) {
+                            error = "Compute kernels do not support subgroup instruction " + std::to_string(opcode);
+                            return false;
+                        }
+
+                        uint32_t clusterSize = kComputeLanes;
+                        if (words[4] == GroupOperationClusteredReduce && (count < 7 || !this->getConstant(words[6], clusterSize))) {
+                            error = "Clustered subgroup reductions need a constant cluster size";
+                            return false;
+                        }
+
+                        for (uint32_t component : value) {
+                            slots.push_back(this->emitValue(this->select(group->handlers), { component }, words[4], clusterSize));
+                        }
+                        break;
+                }
+
+                return this->defineValue(instance, result, resultType, std::move(slots), error);
+            }
+
+            // =======================================================================================================================
+            // Control Flow
+            // =======================================================================================================================
+
+            void addBlockFixup(Instance& instance, FixupKind kind, uint32_t index, uint32_t field, uint32_t label) {
+                instance.fixups.push_back({ kind, index, field, label, 0 });
+            }
+
+            bool translateFunction(Instance& instance, std::string& error) {
+                for (const SpirvBlock& block : instance.function->blocks) {
+                    this->beginBlock();
+                    instance.blockStarts[block.label] = this->getCurrentBlock();
+
+                    if (!this->translateBlock(instance, block, error)) {
+                        return false;
+                    }
+                }
+
+                for (const Fixup& fixup : instance.fixups) {
+                    const std::unordered_map<uint32_t, uint32_t>& blocks = fixup.kind == FixupKind::eBlockExit ? instance.blockExits
+                        : instance.blockStarts;
+
+                    if (fixup.kind == FixupKind::eValue) {
+                        auto value = instance.values.find(fixup.id);
+                        if (value == instance.values.end() || fixup.component >= value->second.slots.size()) {
+                            error = "Phi operand " + std::to_string(fixup.id) + " is never defined";
+                            return false;
+                        }
+
+                        this->program.instructions[fixup.index].operands[0] = value->second.slots[fixup.component];
+                        continue;
+                    }
+
+                    auto block = blocks.find(fixup.id);
+                    if (block == blocks.end()) {
+                        error = "SPIR-V block " + std::to_string(fixup.id) + " is not in the function";
+                        return false;
+                    }
+
+                    switch (fixup.kind) {
+                        case FixupKind::eSwitchDefault:
+                            this->program.switches[fixup.index].defaultTarget = block->second;
+                            break;
+                        case FixupKind::eSwitchCase:
+                            this->program.switches[fixup.index].cases[fixup.field].second = block->second;
+                            break;
+                        default: {
+                            ComputeInstruction& instruction = this->program.instructions[fixup.index];
+                            (fixup.field == 0 ? instruction.immediate : instruction.extra) = block->second;
+                            break;
+                        }
+                    }
+                }
+
+                return true;
+            }
+
+            bool translateBlock(Instance& instance, const SpirvBlock& block, std::string& error) {
+                const uint32_t* words = this->module.words;
+                size_t first = 0;
+
+                std::vector<const uint32_t*> phis;
+                while (first < block.instructions.size() && (words[block.instructions[first]] & 0xFFFF) == OpPhi) {
+                    phis.push_back(words + block.instructions[first++]);
+                }
+
+                if (!phis.empty() && !this->translatePhis(instance, phis, error)) {
+                    return false;
+                }
+
+                for (size_t i = first; i < block.instructions.size(); i++) {
+                    const uint32_t* instruction = words + block.instructions[i];
+                    bool terminated = false;
+
+                    if (!this->translateInstruction(instance, block.label, instruction, instruction[0] >> 16, terminated, error)) {
+                        return false;
+                    }
+
+                    if (terminated) {
+                        return true;
+                    }
+                }
+
+                error = "SPIR-V block " + std::to_string(block.label) + " has no terminator";
+                return false;
+            }
+
+            // Phis of a block take their values together: when one reads another, every phi first
+            // goes to a temporary
+            bool translatePhis(Instance& instance, const std::vector<const uint32_t*>& phis, std::string& error) {
+                bool temporaries = false;
+                for (const uint32_t* phi : phis) {
+                    for (Uint32 i = 3; i + 1 < (phi[0] >> 16); i += 2) {
+                        for (const uint32_t* other : phis) {
+                            temporaries |= phi[i] == other[2];
+                        }
+                    }
+                }
+
+                std::vector<std::vector<uint32_t>> targets;
+
+                for (const uint32_t* phi : phis) {
+                    Uint32 count = this->module.getComponentCount(phi[1]);
+                    if (count == 0) {
+                        error = "Compute kernels do not support phis of pointers";
+                        return false;
+                    }
+
+                    std::vector<uint32_t> slots(count);
+                    std::vector<uint32_t> temporarySlots(temporaries ? count : 0);
+
+                    std::generate(slots.begin(), slots.end(), [this] { return this->allocateSlot(); });
+                    std::generate(temporarySlots.begin(), temporarySlots.end(), [this] { return this->allocateSlot(); });
+
+                    targets.push_back(temporaries ? temporarySlots : slots);
+
+                    if (!this->defineValue(instance, phi[2], phi[1], std::move(slots), error)) {
+                        return false;
+                    }
+                }
+
+                for (size_t p = 0; p < phis.size(); p++) {
+                    const uint32_t* phi = phis[p];
+
+                    for (Uint32 i = 3; i + 1 < (phi[0] >> 16); i += 2) {
+                        const Value* value = nullptr;
+                        if (instance.values.count(phi[i]) != 0 || this->isGlobal(phi[i])) {
+                            value = this->getValue(instance, phi[i], error);
+                            if (value == nullptr) {
+                                return false;
+                            }
+                        }
+
+                        auto exit = instance.blockExits.find(phi[i + 1]);
+
+                        for (uint32_t component = 0; component < targets[p].size(); component++) {
+                            uint32_t slot = value != nullptr && component < value->slots.size() ? value->slots[component] : kNoSlot;
+                            uint32_t index = this->emit(this->handler<PhiLanes>(), targets[p][component], { slot },
+                                exit != instance.blockExits.end() ? exit->second : 0);
+
+                            if (value == nullptr) {
+                                instance.fixups.push_back({ FixupKind::eValue, index, 0, phi[i], component });
+                            }
+
+                            if (exit == instance.blockExits.end()) {
+                                this->addBlockFixup(instance, FixupKind::eBlockExit, index, 0, phi[i + 1]);
+                            }
+                        }
+                    }
+                }
+
+                if (temporaries) {
+                    for (size_t p = 0; p < phis.size(); p++) {
+                        const std::vector<uint32_t>& slots = instance.values[phis[p][2]].slots;
+                        for (size_t component = 0; component < slots.size(); component++) {
+                            this->emit(this->handler<UnaryLanes<Copy>>(), slots[component], { targets[p][component] });
+                        }
+                    }
+                }
+
+                return true;
+            }
+
+            // Inlines the callee between this block and a new one, which its returns branch to
+            bool translateCall(Instance& instance, const uint32_t* words, Uint32 count, std::string& error) {
+                auto callee = this->module.functions.find(words[3]);
+                if (callee == this->module.functions.end() || callee->second.blocks.empty()) {
+                    error = "Function " + std::to_string(words[3]) + " has no body";
+                    return false;
+                }
+
+                if (instance.depth + 1 >= kMaxCallDepth || count - 4 != callee->second.parameters.size()) {
+                    error = instance.depth + 1 >= kMaxCallDepth ? "Function calls nest too deep to inline"
+                        : "Call to function " + std::to_string(words[3]) + " passes the wrong argument count";
+                    return false;
+                }
+
+                Instance call;
+                call.function = &callee->second;
+                call.depth = instance.depth + 1;
+
+                // Parameters alias the arguments, pointers included
+                for (Uint32 i = 4; i < count; i++) {
+                    const Value* argument = this->getValue(instance, words[i], error);
+                    if (argument == nullptr) {
+                        return false;
+                    }
+
+                    call.values[callee->second.parameters[i - 4]] = *argument;
+                }
+
+                this->emit(this->handler<BranchLanes>(), kNoSlot, {}, static_cast<uint32_t>(this->program.blocks.size()));
+                this->endBlock();
+
+                if (!this->translateFunction(call, error)) {
+                    return false;
+                }
+
+                this->beginBlock();
+                for (uint32_t branch : call.returnBranches) {
+                    this->program.instructions[branch].immediate = this->getCurrentBlock();
+                }
+
+                if (call.returnValues.empty()) {
+                    return true;
+                }
+
+                // A single return dominates the continuation, its value is used as is
+                if (call.returnValues.size() == 1) {
+                    return this->defineValue(instance, words[2], words[1], call.returnValues[0].first, error);
+                }
+
+                std::vector<uint32_t> slots(call.returnValues[0].first.size());
+                std::generate(slots.begin(), slots.end(), [this] { return this->allocateSlot(); });
+
+                for (const auto& returned : call.returnValues) {
+                    for (size_t component = 0; component < slots.size(); component++) {
+                        this->emit(this->handler<PhiLanes>(), slots[component], { returned.first[component] }, returned.second);
+                    }
+                }
+
+                return this->defineValue(instance, words[2], words[1], std::move(slots), error);
+            }
+
+            bool translateTerminator(Instance& instance, uint32_t label, uint32_t opcode, const uint32_t* words, Uint32 count,
+                std::string& error)
+            {
+                instance.blockExits[label] = this->getCurrentBlock();
+                uint32_t index = static_cast<uint32_t>(this->program.instructions.size());
+
+                switch (opcode) {
+                    case OpBranch:
+                        this->emit(this->handler<BranchLanes>(), kNoSlot, {});
+                        this->addBlockFixup(instance, FixupKind::eBlockStart, index, 0, words[1]);
+                        break;
+
+                    case OpBranchConditional: {
+                        uint32_t condition = this->getScalar(instance, words[1], error);
+                        if (condition == kNoSlot) {
+                            return false;
+                        }
+
+                        this->emit(this->handler<BranchConditionalLanes>(), kNoSlot, { condition });
+                        this->addBlockFixup(instance, FixupKind::eBlockStart, index, 0, words[2]);
+                        this->addBlockFixup(instance, FixupKind::eBlockStart, index, 1, words[3]);
+                        break;
+                    }
+
+                    case OpSwitch: {
+                        uint32_t selector = this->getScalar(instance, words[1], error);
+                        if (selector == kNoSlot) {
+                            return false;
+                        }
+
+                        uint32_t table = static_cast<uint32_t>(this->program.switches.size());
+                        this->program.switches.push_back({ 0, {} });
+                        this->addBlockFixup(instance, FixupKind::eSwitchDefault, table, 0, words[2]);
+
+                        for (Uint32 i = 3; i + 1 < count; i += 2) {
+                            this->addBlockFixup(instance, FixupKind::eSwitchCase, table,
+                                static_cast<uint32_t>(this->program.switches[table].cases.size()), words[i + 1]);
+                            this->program.switches[table].cases.push_back({ words[i], 0 });
+                        }
+
+                        this->emit(this->handler<SwitchLanes>(), kNoSlot, { selector }, table);
+                        break;
+                    }
+
+                    case OpReturn:
+                    case OpReturnValue:
+                        if (instance.depth == 0) {
+                            this->emit(this->handler<ExitLanes>(), kNoSlot, {});
+                            break;
+                        }
+
+                        if (opcode == OpReturnValue) {
+                            const Value* value = this->getValue(instance, words[1], error);
+                            if (value == nullptr) {
+                                return false;
+                            }
+
+                            instance.returnValues.push_back({ value->slots, this->getCurrentBlock() });
+                        }
+
+                        instance.returnBranches.push_back(index);
+                        this->emit(this->handler<BranchLanes>(), kNoSlot, {});
+                        break;
+
+                    default:
+                        this->emit(this->handler<ExitLanes>(), kNoSlot, {});
+                        break;
+                }
+
+                this->endBlock();
+                return true;
+            }
+
+            // =======================================================================================================================
+            // Instructions
+            // =======================================================================================================================
+
+            bool translateInstruction(Instance& instance, uint32_t label, const uint32_t* words, Uint32 count, bool& terminated,
+                std::string& error)
+            {
+                uint32_t opcode = words[0] & 0xFFFF;
+
+                switch (opcode) {
+                    case OpBranch:
+                    case OpBranchConditional:
+                    case OpSwitch:
+                    case OpReturn:
+                    case OpReturnValue:
+                    case OpKill:
+                    case OpUnreachable:
+                    case OpTerminateInvocation:
+                        terminated = true;
+                        return this->translateTerminator(instance, label, opcode, words, count, error);
+                    default:
+                        break;
+                }
+
+                if (const UnaryOp* unary = count == 4 ? findOp(kUnaryOps, opcode) : nullptr) {
+                    return this->emitComponentwise(instance, words[1], words[2], this->select(unary->handlers), words + 3, 1, error);
+                }
+
+                if (const BinaryOp* binary = count == 5 ? findOp(kBinaryOps, opcode) : nullptr) {
+                    return this->emitComponentwise(instance, words[1], words[2], this->select(binary->handlers), words + 3, 2, error);
+                }
+
+                if (const TernaryOp* ternary = count == 6 ? findOp(kTernaryOps, opcode) : nullptr) {
+                    return this->emitComponentwise(instance, words[1], words[2], this->select(ternary->handlers), words + 3, 3, error);
+                }
+
+                if (opcode >= OpAtomicLoad && opcode <= OpAtomicXor) {
+                    return this->translateAtomic(instance, opcode, words, count, error);
+                }
+
+                if (opcode >= OpGroupNonUniformElect && opcode <= OpGroupNonUniformLogicalXor) {
+                    return this->translateSubgroup(instance, opcode, words, count, error);
+                }
+
+                if (opcode >= OpVectorTimesScalar && opcode <= OpDot) {
+                    return this->translateMatrix(instance, opcode, words, error);
+                }
+
+                switch (opcode) {
+                    case OpAtomicFAddEXT:
+                        return this->translateAtomic(instance, opcode, words, count, error);
+
+                    case OpBitFieldInsert:
+                        return this->emitComponentwise(instance, words[1], words[2], this->handler<QuaternaryLanes<BitFieldInsert>>(),
+                            words + 3, 4, error);
+
+                    case OpUndef:
+                        return this->defineValue(instance, words[2], words[1],
+                            std::vector<uint32_t>(this->module.getComponentCount(words[1]), this->getConstantSlot(0)), error);
+
+                    case OpVariable: {
+                        Value& variable = instance.values[words[2]];
+                        variable.type = words[1];
+                        variable.isPointer = true;
+                        variable.pointer.space = kPrivateSpace;
+                        variable.pointer.type = this->module.findType(words[1])->element;
+
+                        if (!this->checkType(words[1], error)) {
+                            return false;
+                        }
+
+                        variable.pointer.constant = this->allocatePrivate(variable.pointer.type);
+
+                        // Initialized on every entry to the function
+                        if (count > 4) {
+                            Pointer pointer = variable.pointer;
+                            const Value* initializer = this->getValue(instance, words[4], error);
+                            size_t next = 0;
+                            return initializer != nullptr && this->storeValue(pointer, initializer->slots, next, error);
+                        }
+                        return true;
+                    }
+
+                    case OpLoad: {
+                        const Value* pointer = this->getPointer(instance, words[3], error);
+                        std::vector<uint32_t> slots;
+
+                        return pointer != nullptr && this->loadValue(pointer->pointer, slots, error)
+                            && this->defineValue(instance, words[2], words[1], std::move(slots), error);
+                    }
+
+                    case OpStore: {
+                        const Value* pointer = this->getPointer(instance, words[1], error);
+                        const Value* value = pointer != nullptr ? this->getValue(instance, words[2], error) : nullptr;
+                        size_t next = 0;
+
+                        return value != nullptr && this->storeValue(pointer->pointer, value->slots, next, error);
+                    }
+
+                    case OpCopyMemory: {
+                        const Value* target = this->getPointer(instance, words[1], error);
+                        const Value* source = target != nullptr ? this->getPointer(instance, words[2], error) : nullptr;
+                        std::vector<uint32_t> slots;
+                        size_t next = 0;
+
+                        return source != nullptr && this->loadValue(source->pointer, slots, error)
+                            && this->storeValue(target->pointer, slots, next, error);
+                    }
+
+                    case OpAccessChain:
+                    case OpInBoundsAccessChain:
+                        return this->translateAccessChain(instance, words, count, error);
+
+                    case OpArrayLength: {
+                        const Value* pointer = this->getPointer(instance, words[3], error);
+                        if (pointer == nullptr) {
+                            return false;
+                        }
+
+                        Pointer array;
+                        if (!this->accessElement(pointer->pointer, words[4], kNoSlot, array, error)) {
+                            return false;
+                        }
+
+                        const SpirvType* type = this->module.findType(array.type);
+                        uint32_t stride = this->module.getDecorations(array.type).arrayStride;
+                        if (type->kind != TypeKind::eRuntimeArray || array.offset != kNoSlot) {
+                            error = "Array length of a member that is not a runtime array";
+                            return false;
+                        }
+
+                        uint32_t length = this->emitValue(this->handler<ArrayLengthLanes>(),
+                            { stride != 0 ? stride : static_cast<uint32_t>(this->getNaturalSize(type->element)) }, array.constant, array.space);
+                        return this->defineValue(instance, words[2], words[1], { length }, error);
+                    }
+
+                    case OpFunctionCall:
+                        return this->translateCall(instance, words, count, error);
+
+                    case OpControlBarrier: {
+                        uint32_t scope = 0;
+                        if (this->getConstant(words[1], scope) && scope <= kScopeWorkgroup) {
+                            this->program.hasBarriers = true;
+                            this->splitBlock(this->handler<BarrierLanes>());
+                        }
+                        return true;
+                    }
+
+                    // One thread runs the workgroup, memory is always coherent within it
+                    case OpMemoryBarrier:
+                        return true;
+
+                    case OpExtInst: {
+                        auto import = this->module.imports.find(words[3]);
+                        ImportKind kind = import != this->module.imports.end() ? import->second : ImportKind::eOther;
+
+                        if (kind == ImportKind::eNonSemantic) {
+                            return true;
+                        }
+
+                        if (kind != ImportKind::eGlsl) {
+                            error = "Compute kernels do not support extended instruction set " + std::to_string(words[3]);
+                            return false;
+                        }
+
+                        return this->translateGlsl(instance, words, count, error);
+                    }
+
+                    default:
+                        break;
+                }
+
+                return this->translateComposite(instance, opcode, words, count, error);
+            }
+
+            // Composite instructions pick and rearrange the slots of their operands, emitting
+            // nothing but the selects of dynamic indices
+            bool translateComposite(Instance& instance, uint32_t opcode, const uint32_t* words, Uint32 count, std::string& error) {
+                std::vector<std::vector<uint32_t>> operands;
+                std::vector<uint32_t> slots;
+
+                switch (opcode) {
+                    case OpCopyObject:
+                    case OpCopyLogical:
+                    case OpBitcast:
+                    case OpUConvert:
+                    case OpSConvert:
+                    case OpFConvert: {
+                        const Value* value = this->getValue(instance, words[3], error);
+                        if (value == nullptr || !this->checkType(words[1], error)) {
+                            return false;
+                        }
+
+                        Value& copy = instance.values[words[2]] = *value;
+                        copy.type = words[1];
+                        return true;
+                    }
+
+                    case OpCompositeConstruct:
+                        if (!this->getOperands(instance, words + 3, count - 3, operands, error)) {
+                            return false;
+                        }
+
+                        for (const auto& operand : operands) {
+                            slots.insert(slots.end(), operand.begin(), operand.end());
+                        }
+                        break;
+
+                    case OpCompositeExtract:
+                    case OpCompositeInsert: {
+                        Uint32 compositeWord = opcode == OpCompositeExtract ? 3 : 4;
+                        const Value* composite = this->getValue(instance, words[compositeWord], error);
+                        if (composite == nullptr) {
+                            return false;
+                        }
+
+                        uint32_t type = composite->type;
+                        Uint32 first = 0;
+
+                        for (Uint32 i = compositeWord + 1; i < count; i++) {
+                            Uint32 offset;
+                            if (!this->module.getComponentRange(type, words[i], offset, type)) {
+                                error = "Composite index " + std::to_string(words[i]) + " is out of range";
+                                return false;
+                            }
+                            first += offset;
+                        }
+
+                        Uint32 size = this->module.getComponentCount(type);
+
+                        if (opcode == OpCompositeExtract) {
+                            slots.assign(composite->slots.begin() + first, composite->slots.begin() + first + size);
+                            break;
+                        }
+
+                        slots = composite->slots;
+                        if (!this->getOperands(instance, words + 3, 1, operands, error)) {
+                            return false;
+                        }
+
+                        std::copy(operands[0].begin(), operands[0].end(), slots.begin() + first);
+                        break;
+                    }
+
+                    case OpVectorShuffle: {
+                        if (!this->getOperands(instance, words + 3, 2, operands, error)) {
+                            return false;
+                        }
+
+                        std::vector<uint32_t> both = operands[0];
+                        both.insert(both.end(), operands[1].begin(), operands[1].end());
+
+                        // Component ~0 is undefined
+                        for (Uint32 i = 5; i < count; i++) {
+                            slots.push_back(words[i] < both.size() ? both[words[i]] : this->getConstantSlot(0));
+                        }
+                        break;
+                    }
+
+                    case OpTranspose: {
+                        if (!this->getOperands(instance, words + 3, 1, operands, error)) {
+                            return false;
+                        }
+
+                        Uint32 columns = this->getElementCount(this->getValue(instance, words[3], error)->type);
+                        Uint32 rows = static_cast<Uint32>(operands[0].size() / columns);
+
+                        for (Uint32 row = 0; row < rows; row++) {
+                            for (Uint32 column = 0; column < columns; column++) {
+                                slots.push_back(operands[0][column * rows + row]);
+                            }
+                        }
+                        break;
+                    }
+
+                    // A select per component, keeping the one whose index matches
+                    case OpVectorExtractDynamic:
+                    case OpVectorInsertDynamic: {
+                        Uint32 indexWord = opcode == OpVectorExtractDynamic ? 4 : 5;
+                        if (!this->getOperands(instance, words + 3, indexWord - 3, operands, error)) {
+                            return false;
+                        }
+
+                        uint32_t index = this->getScalar(instance, words[indexWord], error);
+                        if (index == kNoSlot) {
+                            return false;
+                        }
+
+                        const std::vector<uint32_t>& vector = operands[0];
+                        uint32_t extracted = vector[0];
+
+                        for (Uint32 i = 0; i < vector.size(); i++) {
+                            uint32_t match = this->emitValue(this->handler<BinaryLanes<IEqual>>(), { index, this->getConstantSlot(i) });
+
+                            if (opcode == OpVectorExtractDynamic) {
+                                extracted = i == 0 ? extracted : this->emitValue(this->handler<TernaryLanes<Select>>(), { match, vector[i], extracted });
+                            } else {
+                                slots.push_back(this->emitValue(this->handler<TernaryLanes<Select>>(), { match, operands[1][0], vector[i] }));
+                            }
+                        }
+
+                        if (opcode == OpVectorExtractDynamic) {
+                            slots.push_back(extracted);
+                        }
+                        break;
+                    }
+
+                    case OpAny:
+                    case OpAll: {
+                        if (!this->getOperands(instance, words + 3, 1, operands, error)) {
+                            return false;
+                        }
+
+                        ComputeHandler combine = opcode == OpAny ? this->handler<BinaryLanes<BitwiseOr>>() : this->handler<BinaryLanes<BitwiseAnd>>();
+                        uint32_t combined = operands[0][0];
+
+                        for (size_t i = 1; i < operands[0].size(); i++) {
+                            combined = this->emitValue(combine, { combined, operands[0][i] });
+                        }
+
+                        slots.push_back(combined);
+                        break;
+                    }
+
+                    default:
+                        error = "Compute kernels do not support SPIR-V instruction " + std::to_string(opcode);
+                        return false;
+                }
+
+                return this->defineValue(instance, words[2], words[1], std::move(slots), error);
+            }
+        };
+
+        // ===========================================================================================================================
+        // Execution
+        // ===========================================================================================================================
+
+        // The last lane reaches laneBytes past the word of the first
+        Uint64 getInterleavedLimit(Uint64 laneBytes) {
+            return laneBytes == 0 ? 0 : laneBytes * kComputeLanes - (kComputeLanes - 1) * 4;
+        }
+
+        // Registers and per lane memory of one warp, kept across the workgroups a job runs
+        struct WarpState {
+            std::vector<ComputeSlot> slots;
+            std::vector<uint8_t> privateMemory;
+            std::vector<uint32_t> inputs;
+            std::vector<ComputeSpace> spaces;
+            ComputeWarp warp;
+        };
+
+        void initWarp(WarpState& state, const ComputeProgram& program, const ComputeResources& resources, uint8_t* workgroupMemory,
+            Uint32 bindingCount)
+        {
+            state.slots.resize(program.slotCount);
+            for (const auto& constant : program.constants) {
+                std::fill(state.slots[constant.first].lanes, state.slots[constant.first].lanes + kComputeLanes, constant.second);
+            }
+
+            state.privateMemory.resize(program.privateImage.size());
+            state.inputs.resize(kInputStride / 4 * kComputeLanes);
+
+            state.spaces.resize(kBindingSpaces + bindingCount);
+            state.spaces[kPushSpace] = { static_cast<uint8_t*>(const_cast<void*>(resources.pushConstants)), resources.pushConstantsSize, false };
+            state.spaces[kWorkgroupSpace] = { workgroupMemory, program.workgroupBytes, false };
+            state.spaces[kPrivateSpace] = { state.privateMemory.data(), getInterleavedLimit(program.privateBytes), true };
+            state.spaces[kInputSpace] = { reinterpret_cast<uint8_t*>(state.inputs.data()), getInterleavedLimit(kInputStride), true };
+
+            for (Uint32 i = 0; i < bindingCount; i++) {
+                state.spaces[kBindingSpaces + i] = { resources.buffers[i].data, resources.buffers[i].size, false };
+            }
+
+            state.warp.program = &program;
+            state.warp.slots = state.slots.data();
+            state.warp.spaces = state.spaces.data();
+        }
+
+        // Points the lanes at invocations [warpIndex * kComputeLanes, ...) of the workgroup
+        void startWarp(WarpState& state, const ComputeProgram& program, const Uint32 workgroupSize[3], const Uint32 workgroupId[3],
+            const Uint32 workgroupCount[3], Uint32 warpIndex, Uint32 warpCount)
+        {
+            std::copy(program.privateImage.begin(), program.privateImage.end(), state.privateMemory.begin());
+
+            Uint32 invocations = workgroupSize[0] * workgroupSize[1] * workgroupSize[2];
+            Uint32 first = warpIndex * kComputeLanes;
+
+            // Divided once, stepped per lane after
+            Uint32 localId[3] = { first % workgroupSize[0], first / workgroupSize[0] % workgroupSize[1],
+                first / (workgroupSize[0] * workgroupSize[1]) };
+
+            for (Uint32 lane = 0; lane < kComputeLanes; lane++) {
+                Uint32 index = first + lane;
+
+                uint32_t* input = state.inputs.data() + lane;
+                for (Uint32 axis = 0; axis < 3; axis++) {
+                    input[(kInputLocalId / 4 + axis) * kComputeLanes] = localId[axis];
+                    input[(kInputGlobalId / 4 + axis) * kComputeLanes] = workgroupId[axis] * workgroupSize[axis] + localId[axis];
+                    input[(kInputWorkgroupId / 4 + axis) * kComputeLanes] = workgroupId[axis];
+                    input[(kInputNumWorkgroups / 4 + axis) * kComputeLanes] = workgroupCount[axis];
+                }
+
+                input[kInputLocalIndex / 4 * kComputeLanes] = index;
+                input[kInputSubgroupSize / 4 * kComputeLanes] = kComputeLanes;
+                input[kInputSubgroupLocalId / 4 * kComputeLanes] = lane;
+                input[kInputNumSubgroups / 4 * kComputeLanes] = warpCount;
+                input[kInputSubgroupId / 4 * kComputeLanes] = warpIndex;
+
+                state.warp.pc[lane] = index < invocations ? 0 : kDone;
+                state.warp.previous[lane] = kDone;
+
+                if (++localId[0] == workgroupSize[0]) {
+                    localId[0] = 0;
+                    if (++localId[1] == workgroupSize[1]) {
+                        localId[1] = 0;
+                        localId[2]++;
+                    }
+                }
+            }
+        }
+
+        bool findEntryPoint(const SpirvModule& module, const std::string& name, const SpirvEntryPoint*& entryPoint) {
+            for (const SpirvEntryPoint& candidate : module.entryPoints) {
+                if (candidate.model == kExecutionModelGLCompute && candidate.name == name) {
+                    entryPoint = &candidate;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        constexpr Uint64 kMaxWorkgroupInvocations = 1024;
+
+        // The WorkgroupSize built-in wins over the execution modes
+        bool resolveWorkgroupSize(const SpirvModule& module, uint32_t function, Uint32 size[3], std::string& error) {
+            auto constant = module.constants.find(module.workgroupSizeConstant);
+            auto local = module.localSizes.find(function);
+
+            for (Uint32 axis = 0; axis < 3; axis++) {
+                if (constant != module.constants.end()) {
+                    size[axis] = constant->second.components.size() == 3 ? constant->second.components[axis] : 0;
+                } else if (local == module.localSizes.end()) {
+                    size[axis] = 1;
+                } else if (module.localSizeIds.at(function)) {
+                    auto id = module.constants.find(local->second[axis]);
+                    size[axis] = id != module.constants.end() && id->second.components.size() == 1 ? id->second.components[0] : 0;
+                } else {
+                    size[axis] = local->second[axis];
+                }
+            }
+
+            Uint64 invocations = static_cast<Uint64>(size[0]) * size[1] * size[2];
+            if (invocations == 0 || invocations > kMaxWorkgroupInvocations) {
+                error = "Workgroup size " + std::to_string(size[0]) + "x" + std::to_string(size[1]) + "x" + std::to_string(size[2])
+                    + " is outside 1 to " + std::to_string(kMaxWorkgroupInvocations) + " invocations";
+                return false;
+            }
+
+            return true;
+        }
+    };
+
+    // ===========================================================================================================================
+    // Compute Kernel
+    // ===========================================================================================================================
+
+    ComputeKernel::ComputeKernel() = default;
+    ComputeKernel::~ComputeKernel() = default;
+
+    bool ComputeKernel::compile(const uint32_t* words, Uint64 wordCount, const char* entryPoint, const SpecializationBlock* constants,
+        std::string& error)
+    {
+        ShaderReflection reflection;
+        if (!reflectSpirv(words, wordCount, entryPoint, reflection, error)) {
+            return false;
+        }
+
+        if (reflection.stage != ShaderStage::eCompute) {
+            error = "Entry point " + reflection.entryPoint + " is not a compute shader";
+            return false;
+        }
+
+        SpecializationData specialization;
+        SpirvModule module;
+        const SpirvEntryPoint* selected = nullptr;
+
+        if (!buildSpecializationData(constants, reflection, specialization, error)
+            || !parseModule(words, wordCount, specialization, module, error))
+        {
+            return false;
+        }
+
+        if (!findEntryPoint(module, reflection.entryPoint, selected)) {
+            error = "Entry point " + reflection.entryPoint + " is not in the module";
+            return false;
+        }
+
+        auto program = std::make_unique<ComputeProgram>();
+        program->vectorized = kHasAvx2;
+
+        std::vector<ComputeKernelBinding> bindings;
+        Uint32 workgroupSize[3];
+
+        Translator translator(module, *program, bindings);
+        if (!resolveWorkgroupSize(module, selected->function, workgroupSize, error) || !translator.translate(selected->function, error)) {
+            return false;
+        }
+
+        this->program = std::move(program);
+        this->bindings = std::move(bindings);
+        std::copy(workgroupSize, workgroupSize + 3, this->workgroupSize);
+        return true;
+    }
+
+    void ComputeKernel::runWorkgroups(const ComputeResources& resources, const Uint32 workgroupCount[3], Uint64 begin, Uint64 end) const {
+        const ComputeProgram& program = *this->program;
+        Uint32 invocations = this->workgroupSize[0] * this->workgroupSize[1] * this->workgroupSize[2];
+        Uint32 warpCount = (invocations + kComputeLanes - 1) / kComputeLanes;
+
+        // Warps only stay resident when a barrier can suspend them, one warp runs them all otherwise
+        std::vector<uint8_t> workgroupMemory(program.workgroupBytes);
+        std::vector<WarpState> warps(program.hasBarriers ? warpCount : 1);
+
+        for (WarpState& warp : warps) {
+            initWarp(warp, program, resources, workgroupMemory.data(), static_cast<Uint32>(this->bindings.size()));
+        }
+
+        for (Uint64 group = begin; group < end; group++) {
+            Uint32 workgroupId[3] = { static_cast<Uint32>(group % workgroupCount[0]),
+                static_cast<Uint32>(group / workgroupCount[0] % workgroupCount[1]),
+                static_cast<Uint32>(group / (static_cast<Uint64>(workgroupCount[0]) * workgroupCount[1])) };
+
+            std::fill(workgroupMemory.begin(), workgroupMemory.end(), uint8_t(0));
+
+            if (!program.hasBarriers) {
+                for (Uint32 warp = 0; warp < warpCount; warp++) {
+                    startWarp(warps[0], program, this->workgroupSize, workgroupId, workgroupCount, warp, warpCount);
+                    runWarp(warps[0].warp);
+                }
+                continue;
+            }
+
+            for (Uint32 warp = 0; warp < warpCount; warp++) {
+                startWarp(warps[warp], program, this->workgroupSize, workgroupId, workgroupCount, warp, warpCount);
+            }
+
+            // Every warp runs up to the barrier, then all of them pass it together
+            for (bool waiting = true; waiting;) {
+                waiting = false;
+                for (WarpState& warp : warps) {
+                    waiting |= runWarp(warp.warp);
+                }
+
+                for (WarpState& warp : warps) {
+                    releaseWarp(warp.warp);
+                }
+            }
+        }
+    }
+
+    void ComputeKernel::dispatch(const ComputeResources& resources, Uint32 workgroupCountX, Uint32 workgroupCountY,
+        Uint32 workgroupCountZ) const
+    {
+        const Uint32 workgroupCount[3] = { workgroupCountX, workgroupCountY, workgroupCountZ };
+        Uint64 total = static_cast<Uint64>(workgroupCountX) * workgroupCountY * workgroupCountZ;
+
+        if (this->program != nullptr && total != 0) {
+            this->runWorkgroups(resources, workgroupCount, 0, total);
+        }
+    }
+
+    void ComputeKernel::dispatch(TaskPool& pool, const ComputeResources& resources, Uint32 workgroupCountX, Uint32 workgroupCountY,
+        Uint32 workgroupCountZ, Uint32 jobInvocations) const
+    {
+        const Uint32 workgroupCount[3] = { workgroupCountX, workgroupCountY, workgroupCountZ };
+        Uint64 total = static_cast<Uint64>(workgroupCountX) * workgroupCountY * workgroupCountZ;
+
+        if (this->program == nullptr || total == 0) {
+            return;
+        }
+
+        Uint32 invocations = this->workgroupSize[0] * this->workgroupSize[1] * this->workgroupSize[2];
+        Uint64 jobSize = std::max<Uint64>(1, (jobInvocations + invocations - 1) / invocations);
+        jobSize = std::max<Uint64>(jobSize, (total + UINT32_MAX - 1) / UINT32_MAX);
+        Uint64 jobCount = (total + jobSize - 1) / jobSize;
+
+        if (jobCount <= 1) {
+            this->runWorkgroups(resources, workgroupCount, 0, total);
+            return;
+        }
+
+        // The submitting thread runs jobs too, a dispatch may come from a worker of the same pool
+        pool.parallelFor(static_cast<Uint32>(jobCount), [&](Uint32 job) {
+            Uint64 begin = job * jobSize;
+            this->runWorkgroups(resources, workgroupCount, begin, std::min(total, begin + jobSize));
+        });
+    }
+
+    Uint32 ComputeKernel::getRegisterCount() const {
+        return this->program != nullptr ? this->program->slotCount : 0;
+    }
+
+    Uint32 ComputeKernel::getInstructionCount() const {
+        return this->program != nullptr ? static_cast<Uint32>(this->program->instructions.size()) : 0;
+    }
+
+    bool ComputeKernel::isVectorized() const {
+        return this->program != nullptr && this->program->vectorized;
+    }
+
+    // ===========================================================================================================================
+    // Kernel Cache
+    // ===========================================================================================================================
+
+    std::shared_ptr<const ComputeKernel> ComputeKernelCache::get(const ProgrammableStage& stage, std::string& error) {
+        const ShaderModuleDescriptor& descriptor = stage.module->desc;
+        if (descriptor.code == nullptr || descriptor.codeSize == 0 || descriptor.codeSize % 4 != 0) {
+            error = "Shader module does not hold a SPIR-V binary";
+            return nullptr;
+        }
+
+        Uint64 key = hashString(stage.entryPoint, hashBytes(descriptor.code, descriptor.codeSize));
+        if (stage.constants != nullptr) {
+            for (const SpecializationConstant& constant : stage.constants->constants) {
+                key = hashCombine(hashCombine(key, constant.id), hashValue(constant.value));
+            }
+        }
+
+        auto find = [this, key, &stage]() -> std::shared_ptr<const ComputeKernel> {
+            auto range = this->kernels.equal_range(key);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (matches(it->second, stage)) {
+                    return it->second.kernel;
+                }
+            }
+
+            return nullptr;
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (auto found = find()) {
+                return found;
+            }
+        }
+
+        // Translated outside the lock, a racing thread translating the same stage loses
+        std::vector<uint32_t> words(descriptor.codeSize / 4);
+        std::memcpy(words.data(), descriptor.code, descriptor.codeSize);
+
+        auto kernel = std::make_shared<ComputeKernel>();
+        if (!kernel->compile(words.data(), words.size(), stage.entryPoint, stage.constants, error)) {
+            return nullptr;
+        }
+
+        Entry entry;
+        entry.code.assign(reinterpret_cast<const uint8_t*>(descriptor.code), reinterpret_cast<const uint8_t*>(descriptor.code) + descriptor.codeSize);
+        entry.entryPoint = stage.entryPoint != nullptr ? stage.entryPoint : "";
+        entry.constants = stage.constants != nullptr ? stage.constants->constants : std::vector<SpecializationConstant>{};
+        entry.kernel = std::move(kernel);
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (auto found = find()) {
+            return found;
+        }
+
+        return this->kernels.emplace(key, std::move(entry))->second.kernel;
+    }
+
+    bool ComputeKernelCache::matches(const Entry& entry, const ProgrammableStage& stage) {
+        const ShaderModuleDescriptor& descriptor = stage.module->desc;
+        const char* entryPoint = stage.entryPoint != nullptr ? stage.entryPoint : "";
+
+        if (entry.code.size() != descriptor.codeSize || std::memcmp(entry.code.data(), descriptor.code, descriptor.codeSize) != 0
+            || entry.entryPoint != entryPoint)
+        {
+            return false;
+        }
+
+        Uint64 constantCount = stage.constants != nullptr ? stage.constants->constants.size() : 0;
+        if (entry.constants.size() != constantCount) {
+            return false;
+        }
+
+        return constantCount == 0 || std::equal(entry.constants.begin(), entry.constants.end(), stage.constants->constants.begin(),
+            [](const SpecializationConstant& a, const SpecializationConstant& b) {
+                return a.id == b.id && std::memcmp(&a.value, &b.value, sizeof(Float64)) == 0;
+            });
+    }
+
+    Uint32 ComputeKernelCache::getKernelCount() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return static_cast<Uint32>(this->kernels.size());
+    }
+};
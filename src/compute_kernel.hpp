@@ -0,0 +1,118 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "task_pool.hpp"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Compute Kernels
+    // ===========================================================================================================================
+
+    // Invocations run in warps of this many lanes, one lane per invocation. Subgroups are warps.
+    constexpr Uint32 kComputeLanes = 16;
+
+    struct ComputeProgram;
+
+    struct ComputeKernelBinding {
+        Uint32 group;
+        Uint32 binding;
+    };
+
+    struct ComputeBufferRange {
+        uint8_t* data = nullptr;
+        Uint64 size = 0;
+    };
+
+    struct ComputeResources {
+        // One range per entry of ComputeKernel::getBindings(), in the same order
+        const ComputeBufferRange* buffers = nullptr;
+
+        const void* pushConstants = nullptr;
+        Uint32 pushConstantsSize = 0;
+    };
+
+    // A SPIR-V compute entry point translated for the CPU. Every SSA value becomes a register
+    // of kComputeLanes 32-bit lanes, and every instruction a handler running its operation
+    // across all lanes at once, the lanes of inactive invocations masked out of the results.
+    // Control flow is per lane: each block runs for the lanes waiting at the earliest block in
+    // program order, which reconverges them at merge blocks.
+    //
+    // A workgroup runs its warps one after the other, a workgroup barrier suspends each warp
+    // until every other one reaches it. Shared memory lives with the workgroup, function and
+    // private variables with each lane. Buffer accesses outside their range read zero and drop
+    // writes, as robust buffer access does.
+    //
+    // Supported: 32-bit integer, float and bool scalars, vectors, matrices, arrays and
+    // structs, storage and uniform buffers, push constants, the compute built-ins, GLSL.std.450,
+    // atomics, non uniform subgroup operations and function calls, which are inlined. Textures,
+    // samplers, storage images and other widths fail to compile, naming the first one met.
+    class ComputeKernel {
+    public:
+        ComputeKernel();
+        ~ComputeKernel();
+
+        ComputeKernel(const ComputeKernel&) = delete;
+        ComputeKernel& operator=(const ComputeKernel&) = delete;
+
+        // entryPoint may be nullptr when the module has a single entry point. constants may be
+        // nullptr to keep the defaults declared in the shader.
+        bool compile(const uint32_t* words, Uint64 wordCount, const char* entryPoint, const SpecializationBlock* constants,
+            std::string& error);
+
+        void dispatch(const ComputeResources& resources, Uint32 workgroupCountX, Uint32 workgroupCountY = 1,
+            Uint32 workgroupCountZ = 1) const;
+
+        // Split into jobs of whole workgroups on the pool, each job running at least jobInvocations
+        void dispatch(TaskPool& pool, const ComputeResources& resources, Uint32 workgroupCountX, Uint32 workgroupCountY = 1,
+            Uint32 workgroupCountZ = 1, Uint32 jobInvocations = 16384) const;
+
+        // Buffers the entry point uses, push constants are passed separately
+        const std::vector<ComputeKernelBinding>& getBindings() const { return this->bindings; }
+
+        const Uint32* getWorkgroupSize() const { return this->workgroupSize; }
+        Uint32 getRegisterCount() const;
+        Uint32 getInstructionCount() const;
+
+        // True when the lane handlers run the AVX2 variants
+        bool isVectorized() const;
+
+    private:
+        void runWorkgroups(const ComputeResources& resources, const Uint32 workgroupCount[3], Uint64 begin, Uint64 end) const;
+
+        std::unique_ptr<ComputeProgram> program;
+        std::vector<ComputeKernelBinding> bindings;
+        Uint32 workgroupSize[3] = { 1, 1, 1 };
+    };
+
+    // ===========================================================================================================================
+    // Kernel Cache
+    // ===========================================================================================================================
+
+    // Kernels keyed by the module code, the entry point and the specialization constants, so
+    // pipelines created from the same stage share one translation
+    class ComputeKernelCache {
+    public:
+        // Null with the error set when the stage does not translate
+        std::shared_ptr<const ComputeKernel> get(const ProgrammableStage& stage, std::string& error);
+
+        Uint32 getKernelCount();
+
+    private:
+        // What the kernel was translated from, compared on a hash hit
+        struct Entry {
+            std::vector<uint8_t> code;
+            std::string entryPoint;
+            std::vector<SpecializationConstant> constants;
+            std::shared_ptr<const ComputeKernel> kernel;
+        };
+
+        std::mutex mutex;
+        std::unordered_multimap<Uint64, Entry> kernels;
+
+        static bool matches(const Entry& entry, const ProgrammableStage& stage);
+    };
+};
@@ -0,0 +1,46 @@
+#include "copy_footprint.hpp"
+
+namespace Rhi {
+    Uint64 getTextureCopyRegions(const TextureDescriptor& desc, Uint32 firstMip, Uint32 mipCount,
+        std::vector<TextureUploadRegion>& regions)
+    {
+        Uint64 size = 0;
+
+        regions.clear();
+        regions.reserve(mipCount * desc.sliceLayersNum);
+
+        for (Uint32 level = firstMip; level < firstMip + mipCount; level++) {
+            Extent3D extent = getMipExtent(desc.size, level);
+            CopyFootprint footprint = getCopyFootprint(desc.format, extent);
+
+            for (Uint32 layer = 0; layer < desc.sliceLayersNum; layer++) {
+                TextureUploadRegion region;
+                region.mipLevel = level;
+                region.arrayLayer = layer;
+                region.size = extent;
+                region.layout.offset = alignCopyOffset(size, kTextureCopyOffsetAlignment);
+                region.layout.bytesPerRow = footprint.bytesPerRow;
+                region.layout.rowsPerImage = footprint.rowsPerImage;
+
+                size = region.layout.offset + footprint.size;
+                regions.push_back(region);
+            }
+        }
+
+        return size;
+    }
+
+    Uint64 getTextureCopySize(const TextureDescriptor& desc, Uint32 firstMip, Uint32 mipCount) {
+        Uint64 size = 0;
+
+        for (Uint32 level = firstMip; level < firstMip + mipCount; level++) {
+            CopyFootprint footprint = getCopyFootprint(desc.format, getMipExtent(desc.size, level));
+
+            for (Uint32 layer = 0; layer < desc.sliceLayersNum; layer++) {
+                size = alignCopyOffset(size, kTextureCopyOffsetAlignment) + footprint.size;
+            }
+        }
+
+        return size;
+    }
+};
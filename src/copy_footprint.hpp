@@ -0,0 +1,69 @@
+#pragma once
+
+#include "format_traits.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Copy Footprints
+    // ===========================================================================================================================
+
+    constexpr Uint32 kTextureCopyRowAlignment = 256;
+    constexpr Uint64 kTextureCopyOffsetAlignment = 512;
+
+    // rowsPerImage is counted in block rows, as in ImageDataLayout
+    struct TextureUploadRegion {
+        ImageDataLayout layout;
+
+        Uint32 mipLevel;
+        Uint32 arrayLayer;
+        Extent3D size;
+    };
+
+    // One image in a copy buffer. rowBytes is the tightly packed part of each bytesPerRow,
+    // size covers every depth slice.
+    struct CopyFootprint {
+        Uint32 rowBytes;
+        Uint32 bytesPerRow;
+        Uint32 rowsPerImage;
+        Uint64 size;
+    };
+
+    constexpr Uint64 alignCopyOffset(Uint64 value, Uint64 alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    constexpr Extent3D getMipExtent(Extent3D size, Uint32 mipLevel) {
+        Uint32 width = size.width >> mipLevel;
+        Uint32 height = size.height >> mipLevel;
+        Uint32 depth = size.depth >> mipLevel;
+
+        return Extent3D{ width > 0 ? width : 1, height > 0 ? height : 1, depth > 0 ? depth : 1 };
+    }
+
+    // Tightly packed bytes of one block row of the given width
+    constexpr Uint64 getTextureRowBytes(TextureFormat format, Uint32 width) {
+        const TextureFormatTraits& traits = getTextureFormatTraits(format);
+        return static_cast<Uint64>((width + traits.blockWidth - 1) / traits.blockWidth) * traits.blockBytes;
+    }
+
+    // rowAlignment 1 gives the tightly packed layout of texture files
+    constexpr CopyFootprint getCopyFootprint(TextureFormat format, Extent3D extent, Uint32 rowAlignment = kTextureCopyRowAlignment) {
+        const TextureFormatTraits& traits = getTextureFormatTraits(format);
+
+        CopyFootprint footprint{};
+        footprint.rowBytes = static_cast<Uint32>(getTextureRowBytes(format, extent.width));
+        footprint.bytesPerRow = static_cast<Uint32>(alignCopyOffset(footprint.rowBytes, rowAlignment));
+        footprint.rowsPerImage = (extent.height + traits.blockHeight - 1) / traits.blockHeight;
+        footprint.size = static_cast<Uint64>(footprint.bytesPerRow) * footprint.rowsPerImage * extent.depth;
+
+        return footprint;
+    }
+
+    // Lays out mips [firstMip, firstMip + mipCount) of every array layer in a buffer, mip by mip,
+    // with the alignment copyBufferToTexture expects. Returns the buffer size needed.
+    Uint64 getTextureCopyRegions(const TextureDescriptor& desc, Uint32 firstMip, Uint32 mipCount,
+        std::vector<TextureUploadRegion>& regions);
+
+    // Buffer size getTextureCopyRegions returns, without building the regions
+    Uint64 getTextureCopySize(const TextureDescriptor& desc, Uint32 firstMip, Uint32 mipCount);
+};
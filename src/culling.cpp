@@ -0,0 +1,259 @@
+#include "culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define RHI_CULLING_X86
+    #include <immintrin.h>
+
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+        #define RHI_TARGET_AVX2
+    #else
+        #define RHI_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+namespace Rhi {
+    namespace {
+        bool detectAvx2() {
+#if !defined(RHI_CULLING_X86)
+            return false;
+#elif defined(_MSC_VER) && !defined(__clang__)
+            int info[4];
+            __cpuid(info, 1);
+
+            // The OS must save the YMM registers on context switches
+            bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+
+            __cpuidex(info, 7, 0);
+            return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+            return __builtin_cpu_supports("avx2");
+#endif
+        }
+
+        const bool kHasAvx2 = detectAvx2();
+
+        // Inside or intersecting every plane, with radius the projected half size on the plane normal
+        bool isInside(const Frustum& frustum, float x, float y, float z, float extentX, float extentY, float extentZ, float radius) {
+            for (Uint32 plane = 0; plane < 6; plane++) {
+                float distance = frustum.normalX[plane] * x + frustum.normalY[plane] * y + frustum.normalZ[plane] * z
+                    + frustum.distance[plane];
+
+                float projected = radius + std::fabs(frustum.normalX[plane]) * extentX + std::fabs(frustum.normalY[plane]) * extentY
+                    + std::fabs(frustum.normalZ[plane]) * extentZ;
+
+                if (distance < -projected) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        Uint32 cullSpheresScalar(const Frustum& frustum, const BoundingSpheres& spheres, Uint32 begin, Uint32 end, Uint32* visible) {
+            Uint32 count = 0;
+
+            for (Uint32 i = begin; i < end; i++) {
+                if (isInside(frustum, spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i], 0.0f, 0.0f, 0.0f, spheres.radius[i])) {
+                    visible[count++] = i;
+                }
+            }
+
+            return count;
+        }
+
+        Uint32 cullBoxesScalar(const Frustum& frustum, const BoundingBoxes& boxes, Uint32 begin, Uint32 end, Uint32* visible) {
+            Uint32 count = 0;
+
+            for (Uint32 i = begin; i < end; i++) {
+                if (isInside(frustum, boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i], boxes.extentX[i], boxes.extentY[i],
+                    boxes.extentZ[i], 0.0f))
+                {
+                    visible[count++] = i;
+                }
+            }
+
+            return count;
+        }
+
+#if defined(RHI_CULLING_X86)
+        // Branchless compaction, every lane is written and only the visible ones are kept
+        Uint32 writeVisible(int mask, Uint32 base, Uint32* visible) {
+            Uint32 count = 0;
+
+            for (Uint32 lane = 0; lane < 8; lane++) {
+                visible[count] = base + lane;
+                count += (mask >> lane) & 1;
+            }
+
+            return count;
+        }
+
+        RHI_TARGET_AVX2 Uint32 cullSpheresAvx2(const Frustum& frustum, const BoundingSpheres& spheres, Uint32 begin, Uint32 end,
+            Uint32* visible)
+        {
+            Uint32 count = 0;
+            Uint32 i = begin;
+
+            for (; i + 8 <= end; i += 8) {
+                __m256 x = _mm256_loadu_ps(spheres.centerX + i);
+                __m256 y = _mm256_loadu_ps(spheres.centerY + i);
+                __m256 z = _mm256_loadu_ps(spheres.centerZ + i);
+                __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(spheres.radius + i));
+
+                __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+                for (Uint32 plane = 0; plane < 6; plane++) {
+                    __m256 distance = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(frustum.normalX[plane]), x), _mm256_mul_ps(_mm256_set1_ps(frustum.normalY[plane]), y)),
+                        _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(frustum.normalZ[plane]), z), _mm256_set1_ps(frustum.distance[plane])));
+
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+                }
+
+                count += writeVisible(_mm256_movemask_ps(inside), i, visible + count);
+            }
+
+            return count + cullSpheresScalar(frustum, spheres, i, end, visible + count);
+        }
+
+        RHI_TARGET_AVX2 Uint32 cullBoxesAvx2(const Frustum& frustum, const BoundingBoxes& boxes, Uint32 begin, Uint32 end, Uint32* visible) {
+            Uint32 count = 0;
+            Uint32 i = begin;
+
+            for (; i + 8 <= end; i += 8) {
+                __m256 x = _mm256_loadu_ps(boxes.centerX + i);
+                __m256 y = _mm256_loadu_ps(boxes.centerY + i);
+                __m256 z = _mm256_loadu_ps(boxes.centerZ + i);
+                __m256 extentX = _mm256_loadu_ps(boxes.extentX + i);
+                __m256 extentY = _mm256_loadu_ps(boxes.extentY + i);
+                __m256 extentZ = _mm256_loadu_ps(boxes.extentZ + i);
+
+                __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+                for (Uint32 plane = 0; plane < 6; plane++) {
+                    __m256 distance = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(frustum.normalX[plane]), x), _mm256_mul_ps(_mm256_set1_ps(frustum.normalY[plane]), y)),
+                        _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(frustum.normalZ[plane]), z), _mm256_set1_ps(frustum.distance[plane])));
+
+                    __m256 projected = _mm256_add_ps(
+                        _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(std::fabs(frustum.normalX[plane])), extentX),
+                            _mm256_mul_ps(_mm256_set1_ps(std::fabs(frustum.normalY[plane])), extentY)),
+                        _mm256_mul_ps(_mm256_set1_ps(std::fabs(frustum.normalZ[plane])), extentZ));
+
+                    inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, projected), _mm256_setzero_ps(), _CMP_GE_OQ));
+                }
+
+                count += writeVisible(_mm256_movemask_ps(inside), i, visible + count);
+            }
+
+            return count + cullBoxesScalar(frustum, boxes, i, end, visible + count);
+        }
+#endif
+
+        Uint32 cullSpheresRange(const Frustum& frustum, const BoundingSpheres& spheres, Uint32 begin, Uint32 end, Uint32* visible) {
+#if defined(RHI_CULLING_X86)
+            if (kHasAvx2) {
+                return cullSpheresAvx2(frustum, spheres, begin, end, visible);
+            }
+#endif
+            return cullSpheresScalar(frustum, spheres, begin, end, visible);
+        }
+
+        Uint32 cullBoxesRange(const Frustum& frustum, const BoundingBoxes& boxes, Uint32 begin, Uint32 end, Uint32* visible) {
+#if defined(RHI_CULLING_X86)
+            if (kHasAvx2) {
+                return cullBoxesAvx2(frustum, boxes, begin, end, visible);
+            }
+#endif
+            return cullBoxesScalar(frustum, boxes, begin, end, visible);
+        }
+
+        // Every job culls its range into its own part of visible, the parts are then packed
+        // together. The caller culls ranges too, so it may run on a worker of the pool.
+        template <typename CullRange>
+        Uint32 cullParallel(TaskPool& pool, Uint32 count, Uint32* visible, Uint32 jobSize, CullRange cullRange) {
+            jobSize = std::max<Uint32>(8, jobSize / 8 * 8);
+            Uint32 jobCount = (count + jobSize - 1) / jobSize;
+
+            if (jobCount <= 1) {
+                return cullRange(0, count, visible);
+            }
+
+            std::vector<Uint32> jobVisible(jobCount);
+
+            pool.parallelFor(jobCount, [&](Uint32 job) {
+                Uint32 begin = job * jobSize;
+                jobVisible[job] = cullRange(begin, std::min(count, begin + jobSize), visible + begin);
+            });
+
+            Uint32 total = jobVisible[0];
+            for (Uint32 job = 1; job < jobCount; job++) {
+                std::copy(visible + job * jobSize, visible + job * jobSize + jobVisible[job], visible + total);
+                total += jobVisible[job];
+            }
+
+            return total;
+        }
+    };
+
+    Frustum extractFrustum(const float viewProjection[16]) {
+        // Row r of the matrix is (m[r], m[4 + r], m[8 + r], m[12 + r])
+        auto row = [viewProjection](Uint32 r, Uint32 column) { return viewProjection[column * 4 + r]; };
+
+        Frustum frustum;
+
+        for (Uint32 plane = 0; plane < 6; plane++) {
+            float coefficients[4];
+
+            for (Uint32 column = 0; column < 4; column++) {
+                switch (plane) {
+                    case 0: coefficients[column] = row(3, column) + row(0, column); break;    // left
+                    case 1: coefficients[column] = row(3, column) - row(0, column); break;    // right
+                    case 2: coefficients[column] = row(3, column) + row(1, column); break;    // bottom
+                    case 3: coefficients[column] = row(3, column) - row(1, column); break;    // top
+                    case 4: coefficients[column] = row(2, column); break;                     // near
+                    default: coefficients[column] = row(3, column) - row(2, column); break;   // far
+                }
+            }
+
+            float length = std::sqrt(coefficients[0] * coefficients[0] + coefficients[1] * coefficients[1]
+                + coefficients[2] * coefficients[2]);
+            float scale = length > 0.0f ? 1.0f / length : 0.0f;
+
+            frustum.normalX[plane] = coefficients[0] * scale;
+            frustum.normalY[plane] = coefficients[1] * scale;
+            frustum.normalZ[plane] = coefficients[2] * scale;
+            frustum.distance[plane] = coefficients[3] * scale;
+        }
+
+        return frustum;
+    }
+
+    Uint32 cullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, Uint32* visible) {
+        return cullSpheresRange(frustum, spheres, 0, spheres.count, visible);
+    }
+
+    Uint32 cullBoxes(const Frustum& frustum, const BoundingBoxes& boxes, Uint32* visible) {
+        return cullBoxesRange(frustum, boxes, 0, boxes.count, visible);
+    }
+
+    Uint32 cullSpheres(TaskPool& pool, const Frustum& frustum, const BoundingSpheres& spheres, Uint32* visible, Uint32 jobSize) {
+        return cullParallel(pool, spheres.count, visible, jobSize, [&frustum, &spheres](Uint32 begin, Uint32 end, Uint32* output) {
+            return cullSpheresRange(frustum, spheres, begin, end, output);
+        });
+    }
+
+    Uint32 cullBoxes(TaskPool& pool, const Frustum& frustum, const BoundingBoxes& boxes, Uint32* visible, Uint32 jobSize) {
+        return cullParallel(pool, boxes.count, visible, jobSize, [&frustum, &boxes](Uint32 begin, Uint32 end, Uint32* output) {
+            return cullBoxesRange(frustum, boxes, begin, end, output);
+        });
+    }
+
+    bool isCullingVectorized() {
+        return kHasAvx2;
+    }
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "task_pool.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Frustum Culling
+    // ===========================================================================================================================
+
+    // Planes point inward, a point p is inside when dot(normal, p) + distance >= 0 for all six
+    struct Frustum {
+        float normalX[6];
+        float normalY[6];
+        float normalZ[6];
+        float distance[6];
+    };
+
+    // From a column major view projection matrix with a [0, 1] depth range, as glm builds it
+    // for Vulkan with GLM_FORCE_DEPTH_ZERO_TO_ONE
+    Frustum extractFrustum(const float viewProjection[16]);
+
+    // Structure of arrays bounds, the culling loops read eight objects per instruction
+    struct BoundingSpheres {
+        const float* centerX;
+        const float* centerY;
+        const float* centerZ;
+        const float* radius;
+        Uint32 count;
+    };
+
+    struct BoundingBoxes {
+        const float* centerX;
+        const float* centerY;
+        const float* centerZ;
+        const float* extentX;
+        const float* extentY;
+        const float* extentZ;
+        Uint32 count;
+    };
+
+    // Write the indices of the objects touching the frustum to visible, which must hold count
+    // entries, in increasing order. Returns how many were written. Uses AVX2 when the CPU has it.
+    Uint32 cullSpheres(const Frustum& frustum, const BoundingSpheres& spheres, Uint32* visible);
+    Uint32 cullBoxes(const Frustum& frustum, const BoundingBoxes& boxes, Uint32* visible);
+
+    // Split into jobs of jobSize objects on the pool, the result keeps the increasing order
+    Uint32 cullSpheres(TaskPool& pool, const Frustum& frustum, const BoundingSpheres& spheres, Uint32* visible,
+        Uint32 jobSize = 16384);
+    Uint32 cullBoxes(TaskPool& pool, const Frustum& frustum, const BoundingBoxes& boxes, Uint32* visible,
+        Uint32 jobSize = 16384);
+
+    bool isCullingVectorized();
+};
@@ -0,0 +1,121 @@
+#include "draw_sort.hpp"
+
+#include <algorithm>
+
+namespace Rhi {
+    Uint32 quantizeDrawDepth(float viewDepth, float nearDepth, float farDepth) {
+        if (!(farDepth > nearDepth)) {
+            return 0;
+        }
+
+        float normalized = std::clamp((viewDepth - nearDepth) / (farDepth - nearDepth), 0.0f, 1.0f);
+        return static_cast<Uint32>(normalized * 16777215.0f);
+    }
+
+    void sortDraws(std::vector<SortedDraw>& draws, std::vector<SortedDraw>& scratch) {
+        size_t count = draws.size();
+        if (count < 2) {
+            return;
+        }
+
+        // Every digit histogram in one read of the keys
+        Uint32 histograms[8][256] = {};
+
+        for (const auto& draw : draws) {
+            for (Uint32 digit = 0; digit < 8; digit++) {
+                histograms[digit][(draw.key >> (digit * 8)) & 0xFF]++;
+            }
+        }
+
+        scratch.resize(count);
+
+        SortedDraw* source = draws.data();
+        SortedDraw* destination = scratch.data();
+
+        for (Uint32 digit = 0; digit < 8; digit++) {
+            Uint32* histogram = histograms[digit];
+
+            if (histogram[(source[0].key >> (digit * 8)) & 0xFF] == count) {
+                continue;
+            }
+
+            Uint32 offset = 0;
+            for (Uint32 bucket = 0; bucket < 256; bucket++) {
+                Uint32 bucketCount = histogram[bucket];
+                histogram[bucket] = offset;
+                offset += bucketCount;
+            }
+
+            for (size_t i = 0; i < count; i++) {
+                destination[histogram[(source[i].key >> (digit * 8)) & 0xFF]++] = source[i];
+            }
+
+            std::swap(source, destination);
+        }
+
+        if (source != draws.data()) {
+            draws.swap(scratch);
+        }
+    }
+
+    DrawEncodeStats encodeSortedDraws(RenderPassEncoder* pass, const DrawItem* items, const SortedDraw* sorted, Uint32 count,
+        Uint32 bindGroupIndex)
+    {
+        DrawEncodeStats stats;
+
+        RenderPipeline* pipeline = nullptr;
+        BindGroup* bindGroup = nullptr;
+
+        Buffer* vertexBuffer = nullptr;
+        Uint64 vertexOffset = 0;
+
+        Buffer* indexBuffer = nullptr;
+        IndexFormat indexFormat = IndexFormat::eUint32;
+        Uint64 indexOffset = 0;
+
+        for (Uint32 i = 0; i < count; i++) {
+            const DrawItem& item = items[sorted[i].drawIndex];
+
+            if (item.pipeline != pipeline) {
+                pipeline = item.pipeline;
+                pass->setPipeline(pipeline);
+
+                stats.pipelineChanges++;
+            }
+
+            if (item.bindGroup != bindGroup && item.bindGroup != nullptr) {
+                bindGroup = item.bindGroup;
+                pass->setBindGroup(bindGroupIndex, bindGroup);
+
+                stats.bindGroupChanges++;
+            }
+
+            if (item.vertexBuffer != nullptr && (item.vertexBuffer != vertexBuffer || item.vertexOffset != vertexOffset)) {
+                vertexBuffer = item.vertexBuffer;
+                vertexOffset = item.vertexOffset;
+                pass->setVertexBuffer(0, vertexBuffer, vertexOffset);
+
+                stats.bufferChanges++;
+            }
+
+            if (item.indexBuffer == nullptr) {
+                pass->draw(item.count, item.instanceCount, item.firstIndex, item.firstInstance);
+            } else {
+                if (item.indexBuffer != indexBuffer || item.indexFormat != indexFormat || item.indexOffset != indexOffset) {
+                    indexBuffer = item.indexBuffer;
+                    indexFormat = item.indexFormat;
+                    indexOffset = item.indexOffset;
+                    pass->setIndexBuffer(indexBuffer, indexFormat, indexOffset);
+
+                    stats.bufferChanges++;
+                }
+
+                pass->drawIndexed(item.count, item.instanceCount, item.firstIndex, item.baseVertex, item.firstInstance);
+            }
+
+            stats.drawCount++;
+        }
+
+        return stats;
+    }
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "rhi.hpp"
+
+#include <cstdint>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Draw Keys
+    // ===========================================================================================================================
+
+    // Opaque key, most significant first: pass 8 bits, pipeline 16 bits, bind group 16 bits, depth 24 bits.
+    // Sorting groups draws by state and goes front to back inside a group.
+    constexpr uint64_t makeDrawKey(Uint32 pass, Uint32 pipeline, Uint32 bindGroup, Uint32 depth) {
+        return (static_cast<uint64_t>(pass & 0xFF) << 56) | (static_cast<uint64_t>(pipeline & 0xFFFF) << 40)
+            | (static_cast<uint64_t>(bindGroup & 0xFFFF) << 24) | static_cast<uint64_t>(depth & 0xFFFFFF);
+    }
+
+    // Translucent key: pass 8 bits, inverted depth 24 bits, pipeline 16 bits, bind group 16 bits.
+    // Blending needs back to front, state changes only collapse between draws at equal depth.
+    constexpr uint64_t makeTranslucentDrawKey(Uint32 pass, Uint32 depth, Uint32 pipeline, Uint32 bindGroup) {
+        return (static_cast<uint64_t>(pass & 0xFF) << 56) | (static_cast<uint64_t>(~depth & 0xFFFFFF) << 32)
+            | (static_cast<uint64_t>(pipeline & 0xFFFF) << 16) | static_cast<uint64_t>(bindGroup & 0xFFFF);
+    }
+
+    constexpr Uint32 getDrawKeyPass(uint64_t key) {
+        return static_cast<Uint32>(key >> 56);
+    }
+
+    // View depth mapped to 24 bits over [nearDepth, farDepth], clamped outside
+    Uint32 quantizeDrawDepth(float viewDepth, float nearDepth, float farDepth);
+
+    struct SortedDraw {
+        uint64_t key;
+        Uint32 drawIndex;
+    };
+
+    // LSD radix sort on 8 bit digits, stable. Digits every key shares are skipped, so keys with
+    // few distinct passes or pipelines cost fewer than eight passes. scratch is resized as needed.
+    void sortDraws(std::vector<SortedDraw>& draws, std::vector<SortedDraw>& scratch);
+
+    // ===========================================================================================================================
+    // Sorted Encoding
+    // ===========================================================================================================================
+
+    struct DrawItem {
+        RenderPipeline* pipeline = nullptr;
+        BindGroup* bindGroup = nullptr;
+
+        Buffer* vertexBuffer = nullptr;
+        Uint64 vertexOffset = 0;
+
+        // Without an index buffer count is a vertex count and firstIndex the first vertex
+        Buffer* indexBuffer = nullptr;
+        IndexFormat indexFormat = IndexFormat::eUint32;
+        Uint64 indexOffset = 0;
+
+        Uint32 count = 0;
+        Uint32 instanceCount = 1;
+        Uint32 firstIndex = 0;
+        Int32 baseVertex = 0;
+        Uint32 firstInstance = 0;
+    };
+
+    struct DrawEncodeStats {
+        Uint32 drawCount = 0;
+        Uint32 pipelineChanges = 0;
+        Uint32 bindGroupChanges = 0;
+        Uint32 bufferChanges = 0;
+    };
+
+    // Records draws in the order of sorted, skipping pipeline, bind group and buffer bindings that
+    // match the previous draw. The bind group goes to bindGroupIndex.
+    DrawEncodeStats encodeSortedDraws(RenderPassEncoder* pass, const DrawItem* items, const SortedDraw* sorted, Uint32 count,
+        Uint32 bindGroupIndex = 1);
+};
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "rhi.hpp"
+
+// Format enum of rhi1.hpp, declared here so the traits do not pull in the Vulkan headers
+enum GPUTextureFormat : uint8_t;
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Texture Format Traits
+    // ===========================================================================================================================
+
+    enum class FormatCompression : Uint8 {
+        eNone,
+        eBC,
+        eETC2,
+        eASTC
+    };
+
+    // blockBytes is the size of one texel, or of one block for compressed formats. Combined
+    // depth stencil formats report eDepth with hasStencil set.
+    struct TextureFormatTraits {
+        TextureFormat format;
+
+        Uint8 blockWidth;
+        Uint8 blockHeight;
+        Uint8 blockBytes;
+        Uint8 componentCount;
+
+        TextureAspect aspect;
+        bool hasStencil;
+        bool isSrgb;
+        FormatCompression compression;
+    };
+
+    // Indexed by TextureFormat
+    constexpr TextureFormatTraits kTextureFormatTraits[] = {
+        { eR8Unorm,               1,  1,  1, 1, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eR8Snorm,               1,  1,  1, 1, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eR8Uint,                1,  1,  1, 1, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eR8Sint,                1,  1,  1, 1, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eR16Uint,               1,  1,  2, 1, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eR16Sint,               1,  1,  2, 1, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eR16Float,              1,  1,  2, 1, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRG8Unorm,              1,  1,  2, 2, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRG8Snorm,              1,  1,  2, 2, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRG8Uint,               1,  1,  2, 2, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRG8Sint,               1,  1,  2, 2, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eR32uint,               1,  1,  4, 1, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eR32sint,               1,  1,  4, 1, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eR32float,              1,  1,  4, 1, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRG16uint,              1,  1,  4, 2, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRG16sint,              1,  1,  4, 2, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRG16float,             1,  1,  4, 2, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRGBA8Unorm,            1,  1,  4, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRGBA8UnormSrgb,        1,  1,  4, 4, TextureAspect::eColor,   false, true,  FormatCompression::eNone },
+        { eRGBA8Snorm,            1,  1,  4, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRGBA8Uint,             1,  1,  4, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRGBA8Sint,             1,  1,  4, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eBGRA8Unorm,            1,  1,  4, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eBGRA8UnormSrgb,        1,  1,  4, 4, TextureAspect::eColor,   false, true,  FormatCompression::eNone },
+        { eRGB9E5Ufloat,          1,  1,  4, 3, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRGB10A2Uint,           1,  1,  4, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRGB10A2Unorm,          1,  1,  4, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRG11B10Ufloat,         1,  1,  4, 3, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRG32Uint,              1,  1,  8, 2, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRG32Sint,              1,  1,  8, 2, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRG32Float,             1,  1,  8, 2, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRGBA16Uint,            1,  1,  8, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRGBA16Sint,            1,  1,  8, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRGBA16Float,           1,  1,  8, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRGBA32Uint,            1,  1, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRGBA32Sint,            1,  1, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eRGBA32Float,           1,  1, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eNone },
+        { eS8Uint,                1,  1,  1, 1, TextureAspect::eStencil, true,  false, FormatCompression::eNone },
+        { eD16Unorm,              1,  1,  2, 1, TextureAspect::eDepth,   false, false, FormatCompression::eNone },
+        { eD24Plus,               1,  1,  4, 1, TextureAspect::eDepth,   false, false, FormatCompression::eNone },
+        { eD24PlusS8Uint,         1,  1,  4, 2, TextureAspect::eDepth,   true,  false, FormatCompression::eNone },
+        { eD32Sfloat,             1,  1,  4, 1, TextureAspect::eDepth,   false, false, FormatCompression::eNone },
+        { eD32SFloatS8Uint,       1,  1,  8, 2, TextureAspect::eDepth,   true,  false, FormatCompression::eNone },
+        { eBC1RGBAUnorm,          4,  4,  8, 4, TextureAspect::eColor,   false, false, FormatCompression::eBC },
+        { eBC1RGBAUnormSrgb,      4,  4,  8, 4, TextureAspect::eColor,   false, true,  FormatCompression::eBC },
+        { eBC2RGBAUnorm,          4,  4, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eBC },
+        { eBC2RGBAUnormSrgb,      4,  4, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eBC },
+        { eBC3RGBAUnorm,          4,  4, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eBC },
+        { eBC3RGBAUnormSrgb,      4,  4, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eBC },
+        { eBC4RUnorm,             4,  4,  8, 1, TextureAspect::eColor,   false, false, FormatCompression::eBC },
+        { eBC4RSnorm,             4,  4,  8, 1, TextureAspect::eColor,   false, false, FormatCompression::eBC },
+        { eBC5RGUnorm,            4,  4, 16, 2, TextureAspect::eColor,   false, false, FormatCompression::eBC },
+        { eBC5RGSnorm,            4,  4, 16, 2, TextureAspect::eColor,   false, false, FormatCompression::eBC },
+        { eBC6HRGBUfloat,         4,  4, 16, 3, TextureAspect::eColor,   false, false, FormatCompression::eBC },
+        { eBC6HRGBSfloat,         4,  4, 16, 3, TextureAspect::eColor,   false, false, FormatCompression::eBC },
+        { eBC7RGBAUnorm,          4,  4, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eBC },
+        { eBC7RGBAUnormSrgb,      4,  4, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eBC },
+        { eETC2RGB8Unorm,         4,  4,  8, 3, TextureAspect::eColor,   false, false, FormatCompression::eETC2 },
+        { eETC2RGB8UnormSrgb,     4,  4,  8, 3, TextureAspect::eColor,   false, true,  FormatCompression::eETC2 },
+        { eETC2RGB8A1Unorm,       4,  4,  8, 4, TextureAspect::eColor,   false, false, FormatCompression::eETC2 },
+        { eETC2RGB8A1UnormSrgb,   4,  4,  8, 4, TextureAspect::eColor,   false, true,  FormatCompression::eETC2 },
+        { eETC2RGBA8Unorm,        4,  4, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eETC2 },
+        { eETC2RGBA8UnormSrgb,    4,  4, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eETC2 },
+        { eEACR11Unorm,           4,  4,  8, 1, TextureAspect::eColor,   false, false, FormatCompression::eETC2 },
+        { eEACR11Snorm,           4,  4,  8, 1, TextureAspect::eColor,   false, false, FormatCompression::eETC2 },
+        { eEACRG11Unorm,          4,  4, 16, 2, TextureAspect::eColor,   false, false, FormatCompression::eETC2 },
+        { eEACRG11Snorm,          4,  4, 16, 2, TextureAspect::eColor,   false, false, FormatCompression::eETC2 },
+        { eASTC4X4Unorm,          4,  4, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC4X4UnormSrgb,      4,  4, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC5X4Unorm,          5,  4, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC5X4UnormSrgb,      5,  4, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC5X5Unorm,          5,  5, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC5X5UnormSrgb,      5,  5, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC6X5Unorm,          6,  5, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC6X5UnormSrgb,      6,  5, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC6X6Unorm,          6,  6, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC6X6UnormSrgb,      6,  6, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC8X5Unorm,          8,  5, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC8X5UnormSrgb,      8,  5, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC8X6Unorm,          8,  6, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC8X6UnormSrgb,      8,  6, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC8X8Unorm,          8,  8, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC8X8UnormSrgb,      8,  8, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC10X5Unorm,        10,  5, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC10X5UnormSrgb,    10,  5, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC10X6Unorm,        10,  6, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC10X6UnormSrgb,    10,  6, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC10X8Unorm,        10,  8, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC10X8UnormSrgb,    10,  8, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC10X10Unorm,       10, 10, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC10X10UnormSrgb,   10, 10, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC12X10Unorm,       12, 10, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC12X10UnormSrgb,   12, 10, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC },
+        { eASTC12X12Unorm,       12, 12, 16, 4, TextureAspect::eColor,   false, false, FormatCompression::eASTC },
+        { eASTC12X12UnormSrgb,   12, 12, 16, 4, TextureAspect::eColor,   false, true,  FormatCompression::eASTC }
+    };
+
+    constexpr const TextureFormatTraits& getTextureFormatTraits(TextureFormat format) {
+        return kTextureFormatTraits[format];
+    }
+
+    constexpr bool isDepthStencilFormat(TextureFormat format) {
+        return kTextureFormatTraits[format].aspect != TextureAspect::eColor;
+    }
+
+    constexpr bool isCompressedFormat(TextureFormat format) {
+        return kTextureFormatTraits[format].compression != FormatCompression::eNone;
+    }
+
+    // GPUTextureFormat lists the same formats in the same order, so both share one table
+    constexpr const TextureFormatTraits& getTextureFormatTraits(GPUTextureFormat format) {
+        return kTextureFormatTraits[static_cast<Uint8>(format)];
+    }
+
+    constexpr bool isDepthStencilFormat(GPUTextureFormat format) {
+        return getTextureFormatTraits(format).aspect != TextureAspect::eColor;
+    }
+
+    constexpr bool isCompressedFormat(GPUTextureFormat format) {
+        return getTextureFormatTraits(format).compression != FormatCompression::eNone;
+    }
+
+    // ===========================================================================================================================
+    // Vertex Format Traits
+    // ===========================================================================================================================
+
+    // What the shader reads, normalized formats arrive as float
+    enum class VertexComponentType : Uint8 {
+        eFloat,
+        eSint,
+        eUint
+    };
+
+    struct VertexFormatTraits {
+        VertexFormat format;
+
+        Uint8 size;
+        Uint8 componentCount;
+        VertexComponentType type;
+    };
+
+    // Indexed by VertexFormat
+    constexpr VertexFormatTraits kVertexFormatTraits[] = {
+        { eUint8x2,         2, 2, VertexComponentType::eUint },
+        { eUint8x4,         4, 4, VertexComponentType::eUint },
+        { eSint8x2,         2, 2, VertexComponentType::eSint },
+        { eSint8x4,         4, 4, VertexComponentType::eSint },
+        { eUnorm8x2,        2, 2, VertexComponentType::eFloat },
+        { eUnorm8x4,        4, 4, VertexComponentType::eFloat },
+        { eSnorm8x2,        2, 2, VertexComponentType::eFloat },
+        { eSnorm8x4,        4, 4, VertexComponentType::eFloat },
+        { eUint16x2,        4, 2, VertexComponentType::eUint },
+        { eUint16x4,        8, 4, VertexComponentType::eUint },
+        { eSint16x2,        4, 2, VertexComponentType::eSint },
+        { eSint16x4,        8, 4, VertexComponentType::eSint },
+        { eUnorm16x2,       4, 2, VertexComponentType::eFloat },
+        { eUnorm16x4,       8, 4, VertexComponentType::eFloat },
+        { eSnorm16x2,       4, 2, VertexComponentType::eFloat },
+        { eSnorm16x4,       8, 4, VertexComponentType::eFloat },
+        { eFloat16x2,       4, 2, VertexComponentType::eFloat },
+        { eFloat16x4,       8, 4, VertexComponentType::eFloat },
+        { eFloat32,         4, 1, VertexComponentType::eFloat },
+        { eFloat32x2,       8, 2, VertexComponentType::eFloat },
+        { eFloat32x3,      12, 3, VertexComponentType::eFloat },
+        { eFloat32x4,      16, 4, VertexComponentType::eFloat },
+        { eUint32,          4, 1, VertexComponentType::eUint },
+        { eUint32x2,        8, 2, VertexComponentType::eUint },
+        { eUint32x3,       12, 3, VertexComponentType::eUint },
+        { eUint32x4,       16, 4, VertexComponentType::eUint },
+        { eSint32,          4, 1, VertexComponentType::eSint },
+        { eSint32x2,        8, 2, VertexComponentType::eSint },
+        { eSint32x3,       12, 3, VertexComponentType::eSint },
+        { eSint32x4,       16, 4, VertexComponentType::eSint },
+        { eUnorm1010102,    4, 4, VertexComponentType::eFloat }
+    };
+
+    constexpr const VertexFormatTraits& getVertexFormatTraits(VertexFormat format) {
+        return kVertexFormatTraits[format];
+    }
+
+    namespace Detail {
+        template <typename Traits, size_t N>
+        constexpr bool isFormatTableOrdered(const Traits (&table)[N]) {
+            for (size_t i = 0; i < N; i++) {
+                if (static_cast<size_t>(table[i].format) != i) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    static_assert(sizeof(kTextureFormatTraits) / sizeof(TextureFormatTraits) == eASTC12X12UnormSrgb + 1,
+        "Every TextureFormat needs an entry in kTextureFormatTraits");
+    static_assert(Detail::isFormatTableOrdered(kTextureFormatTraits), "kTextureFormatTraits is out of TextureFormat order");
+
+    static_assert(sizeof(kVertexFormatTraits) / sizeof(VertexFormatTraits) == eUnorm1010102 + 1,
+        "Every VertexFormat needs an entry in kVertexFormatTraits");
+    static_assert(Detail::isFormatTableOrdered(kVertexFormatTraits), "kVertexFormatTraits is out of VertexFormat order");
+};
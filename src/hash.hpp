@@ -0,0 +1,42 @@
+#pragma once
+
+#include "rhi.hpp"
+
+#include <cstring>
+#include <type_traits>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Hash
+    // ===========================================================================================================================
+
+    // 64-bit FNV-1a, used for interning descriptors and deduplicating blobs
+    constexpr Uint64 kHashSeed = 14695981039346656037ull;
+    constexpr Uint64 kHashPrime = 1099511628211ull;
+
+    inline Uint64 hashBytes(const void* data, Uint64 size, Uint64 seed = kHashSeed) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        Uint64 hash = seed;
+
+        for (Uint64 i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * kHashPrime;
+        }
+
+        return hash;
+    }
+
+    // Only for types without padding, hash struct members one by one otherwise
+    template <typename T>
+    inline Uint64 hashValue(const T& value, Uint64 seed = kHashSeed) {
+        static_assert(std::is_trivially_copyable<T>::value, "hashValue needs a trivially copyable type");
+        return hashBytes(&value, sizeof(T), seed);
+    }
+
+    inline Uint64 hashString(const char* value, Uint64 seed = kHashSeed) {
+        return value == nullptr ? seed : hashBytes(value, std::strlen(value), seed);
+    }
+
+    inline Uint64 hashCombine(Uint64 hash, Uint64 value) {
+        return hashValue(value, hash);
+    }
+};
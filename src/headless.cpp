@@ -0,0 +1,287 @@
+#include "headless.hpp"
+#include "copy_footprint.hpp"
+
+#include <algorithm>
+#include <cerrno>
+
+#if defined(_WIN32)
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
+namespace Rhi {
+    namespace {
+        bool writeAll(int fileDescriptor, const uint8_t* data, Uint64 size) {
+            while (size != 0) {
+#if defined(_WIN32)
+                int written = _write(fileDescriptor, data, static_cast<unsigned int>(std::min<Uint64>(size, 1u << 30)));
+#else
+                ssize_t written = ::write(fileDescriptor, data, size);
+#endif
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+
+                    return false;
+                }
+
+                data += written;
+                size -= static_cast<Uint64>(written);
+            }
+
+            return true;
+        }
+
+        TextureSubresource getWholeTexture(const Texture* texture) {
+            TextureSubresource subresource;
+            subresource.mipLevelCount = texture->desc.mipLevelCount;
+            subresource.arrayLayerCount = texture->desc.sliceLayersNum;
+
+            return subresource;
+        }
+    };
+
+    HeadlessFrameSink makeFileDescriptorSink(int fileDescriptor) {
+        return [fileDescriptor](const HeadlessFrame& frame) {
+            if (frame.bytesPerRow == frame.rowBytes) {
+                return writeAll(fileDescriptor, frame.data, static_cast<Uint64>(frame.bytesPerRow) * frame.height);
+            }
+
+            for (Uint32 y = 0; y < frame.height; y++) {
+                if (!writeAll(fileDescriptor, frame.data + static_cast<Uint64>(y) * frame.bytesPerRow, frame.rowBytes)) {
+                    return false;
+                }
+            }
+
+            return true;
+        };
+    }
+
+    // ===========================================================================================================================
+    // Headless Presenter
+    // ===========================================================================================================================
+
+    void HeadlessPresenter::PacingWindow::add(double milliseconds) {
+        if (this->samples.size() < kHeadlessPacingWindow) {
+            this->samples.push_back(milliseconds);
+            return;
+        }
+
+        this->samples[this->cursor] = milliseconds;
+        this->cursor = (this->cursor + 1) % kHeadlessPacingWindow;
+    }
+
+    HeadlessPresenter::HeadlessPresenter(Device* device, HeadlessPresenterDescriptor descriptor, HeadlessFrameSink sink)
+        : device{ device }, desc{ descriptor }, sink{ std::move(sink) }
+    {
+        this->desc.framesInFlight = std::max<Uint32>(1, this->desc.framesInFlight);
+
+        TextureDescriptor targetDesc;
+        targetDesc.size = Extent3D{ this->desc.width, this->desc.height, 1 };
+        targetDesc.format = this->desc.format;
+        targetDesc.usage = this->desc.usage | static_cast<TextureUsageFlags>(TextureUsage::eRenderAttachment)
+            | static_cast<TextureUsageFlags>(TextureUsage::eCopySrc);
+
+        std::vector<TextureUploadRegion> regions;
+        Uint64 readbackSize = getTextureCopyRegions(targetDesc, 0, 1, regions);
+
+        this->layout = regions[0].layout;
+        this->rowBytes = static_cast<Uint32>(getTextureRowBytes(this->desc.format, this->desc.width));
+
+        BufferDescriptor readbackDesc;
+        readbackDesc.size = readbackSize;
+        readbackDesc.usage = static_cast<BufferUsageFlags>(BufferUsage::eCopyDst);
+        readbackDesc.location = BufferLocation::eHost;
+
+        this->slots.resize(this->desc.framesInFlight);
+
+        for (auto& slot : this->slots) {
+            slot.target = this->device->createTexture(targetDesc);
+            if (slot.target == nullptr) {
+                this->error = "Failed to create a headless color target";
+                return;
+            }
+
+            slot.view = slot.target->createView(TextureViewDescriptor{});
+            slot.readback = this->device->createBuffer(readbackDesc);
+
+            if (slot.view == nullptr || slot.readback == nullptr) {
+                this->error = "Failed to create a headless target view or readback buffer";
+                return;
+            }
+
+            slot.data = static_cast<const uint8_t*>(slot.readback->map(readbackSize, 0));
+            if (slot.data == nullptr) {
+                this->error = "Failed to map a headless readback buffer";
+                return;
+            }
+        }
+    }
+
+    HeadlessPresenter::~HeadlessPresenter() {
+        this->deliveryPool.wait();
+
+        for (auto& slot : this->slots) {
+            if (slot.data != nullptr) {
+                slot.readback->unmap();
+            }
+        }
+    }
+
+    TextureView* HeadlessPresenter::beginFrame(CommandEncoder* encoder, Uint64 frameIndex, Uint64 completedFrameIndex) {
+        Clock::time_point now = Clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            if (this->lastBeginTime != Clock::time_point{}) {
+                this->frameTimes.add(std::chrono::duration<double, std::milli>(now - this->lastBeginTime).count());
+            }
+        }
+
+        this->lastBeginTime = now;
+        this->deliver(completedFrameIndex);
+
+        Slot& slot = this->slots[frameIndex % this->desc.framesInFlight];
+
+        // Every target is in flight, the GPU is behind
+        if (slot.presented) {
+            this->device->getQueue()->waitIdle();
+            this->deliver(ULLONG_MAX);
+
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stats.gpuStalls++;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+
+            if (slot.delivering) {
+                this->stats.sinkStalls++;
+                this->delivered.wait(lock, [&slot] { return !slot.delivering; });
+            }
+        }
+
+        slot.frameIndex = frameIndex;
+        this->current = &slot;
+
+        this->tracker.require(slot.target.get(), getWholeTexture(slot.target.get()), TextureState::eColorAttachment, ShaderStage::eFragment);
+        this->tracker.flush(encoder);
+
+        return slot.view.get();
+    }
+
+    void HeadlessPresenter::present(CommandEncoder* encoder) {
+        Slot* slot = this->current;
+        if (slot == nullptr) {
+            return;
+        }
+
+        this->tracker.require(slot->target.get(), getWholeTexture(slot->target.get()), TextureState::eCopySrc, ShaderStage::eTransfer);
+        this->tracker.flush(encoder);
+
+        ImageCopyTexture source;
+        source.texture = slot->target.get();
+
+        ImageCopyBuffer destination;
+        static_cast<ImageDataLayout&>(destination) = this->layout;
+        destination.buffer = slot->readback.get();
+
+        encoder->copyTextureToBuffer(source, destination, Extent3D{ this->desc.width, this->desc.height, 1 });
+
+        // deliver reads the mapped pixels once the frame completes, the copy has to reach the host by then
+        BufferBarrier toHost;
+        toHost.srcAccess = ResourceAccess::eWriteOnly;
+        toHost.dstAccess = ResourceAccess::eReadOnly;
+        toHost.buffer = slot->readback.get();
+
+        encoder->activateBufferBarrier(ShaderStage::eTransfer, ShaderStage::eHost, toHost);
+
+        slot->presented = true;
+        slot->presentTime = Clock::now();
+        this->current = nullptr;
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stats.framesPresented++;
+    }
+
+    void HeadlessPresenter::flush() {
+        this->device->getQueue()->waitIdle();
+        this->deliver(ULLONG_MAX);
+        this->deliveryPool.wait();
+    }
+
+    HeadlessFrameStats HeadlessPresenter::getStats() const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        HeadlessFrameStats result = this->stats;
+
+        auto mean = [](const std::vector<double>& samples) {
+            double sum = 0.0;
+            for (double sample : samples) {
+                sum += sample;
+            }
+
+            return samples.empty() ? 0.0 : sum / static_cast<double>(samples.size());
+        };
+
+        result.meanFrameMilliseconds = mean(this->frameTimes.samples);
+        result.meanLatencyMilliseconds = mean(this->latencies.samples);
+
+        if (!this->frameTimes.samples.empty()) {
+            result.maxFrameMilliseconds = *std::max_element(this->frameTimes.samples.begin(), this->frameTimes.samples.end());
+        }
+
+        return result;
+    }
+
+    void HeadlessPresenter::deliver(Uint64 completedFrameIndex) {
+        std::vector<Slot*> ready;
+
+        for (auto& slot : this->slots) {
+            if (slot.presented && slot.frameIndex <= completedFrameIndex) {
+                ready.push_back(&slot);
+            }
+        }
+
+        // Oldest first, the single delivery worker keeps that order
+        std::sort(ready.begin(), ready.end(), [](const Slot* a, const Slot* b) { return a->frameIndex < b->frameIndex; });
+
+        for (Slot* slot : ready) {
+            slot->presented = false;
+            slot->readback->invalidate();
+
+            {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                slot->delivering = true;
+            }
+
+            this->deliveryPool.submit([this, slot] {
+                HeadlessFrame frame;
+                frame.frameIndex = slot->frameIndex;
+                frame.width = this->desc.width;
+                frame.height = this->desc.height;
+                frame.format = this->desc.format;
+                frame.data = slot->data + this->layout.offset;
+                frame.bytesPerRow = this->layout.bytesPerRow;
+                frame.rowBytes = this->rowBytes;
+
+                bool written = !this->sink || this->sink(frame);
+                double latency = std::chrono::duration<double, std::milli>(Clock::now() - slot->presentTime).count();
+
+                std::lock_guard<std::mutex> lock(this->mutex);
+
+                this->stats.framesDelivered++;
+                if (!written) {
+                    this->stats.sinkErrors++;
+                }
+
+                this->latencies.add(latency);
+
+                slot->delivering = false;
+                this->delivered.notify_all();
+            });
+        }
+    }
+};
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "task_pool.hpp"
+#include "texture_state.hpp"
+
+#include <chrono>
+#include <functional>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Headless Presentation
+    // ===========================================================================================================================
+
+    // Rows are bytesPerRow apart, of which the first rowBytes hold pixels
+    struct HeadlessFrame {
+        Uint64 frameIndex;
+
+        Uint32 width;
+        Uint32 height;
+        TextureFormat format;
+
+        const uint8_t* data;
+        Uint32 bytesPerRow;
+        Uint32 rowBytes;
+    };
+
+    // Called on the delivery thread in frame order, the data is only valid during the call.
+    // Returning false counts a sink error.
+    using HeadlessFrameSink = std::function<bool(const HeadlessFrame& frame)>;
+
+    // Writes the rows tightly packed, as raw video for an encoder reading a pipe. The descriptor
+    // stays owned by the caller.
+    HeadlessFrameSink makeFileDescriptorSink(int fileDescriptor);
+
+    struct HeadlessPresenterDescriptor {
+        Uint32 width = 1920;
+        Uint32 height = 1080;
+        TextureFormat format = TextureFormat::eRGBA8Unorm;
+
+        // Added to eRenderAttachment and eCopySrc on the targets
+        TextureUsageFlags usage = 0;
+
+        // Frames between rendering and delivery, one target and readback buffer each
+        Uint32 framesInFlight = 3;
+    };
+
+    struct HeadlessFrameStats {
+        Uint64 framesPresented = 0;
+        Uint64 framesDelivered = 0;
+        Uint64 sinkErrors = 0;
+
+        // beginFrame found its slot still in flight and waited for the queue, or still being
+        // delivered and waited for the sink
+        Uint64 gpuStalls = 0;
+        Uint64 sinkStalls = 0;
+
+        // Over the last kHeadlessPacingWindow frames, between beginFrame calls and from present to delivery
+        double meanFrameMilliseconds = 0.0;
+        double maxFrameMilliseconds = 0.0;
+        double meanLatencyMilliseconds = 0.0;
+    };
+
+    constexpr Uint32 kHeadlessPacingWindow = 120;
+
+    // Swapchain stand in for servers without a display. Frames rotate through framesInFlight
+    // offscreen color targets, present copies the target into a persistently mapped readback
+    // buffer, and once the caller reports the frame complete the pixels go to the sink on a
+    // delivery thread, so neither the GPU nor the sink blocks recording.
+    //
+    // Per frame: view = beginFrame(encoder, frameIndex, completed), render into view, present(encoder),
+    // submit. completedFrameIndex is the last frame whose submission finished, as everywhere else.
+    class HeadlessPresenter {
+    public:
+        HeadlessPresenter(Device* device, HeadlessPresenterDescriptor descriptor, HeadlessFrameSink sink);
+        ~HeadlessPresenter();
+
+        HeadlessPresenter(const HeadlessPresenter&) = delete;
+        HeadlessPresenter& operator=(const HeadlessPresenter&) = delete;
+
+        // False when a target or readback buffer could not be created, getError says why and
+        // nothing else may be called
+        bool isValid() const { return this->error.empty(); }
+        const std::string& getError() const { return this->error; }
+
+        // Delivers the frames completed by completedFrameIndex and returns the target of frameIndex,
+        // transitioned to eColorAttachment on encoder
+        TextureView* beginFrame(CommandEncoder* encoder, Uint64 frameIndex, Uint64 completedFrameIndex);
+
+        // Records the readback of the current target, after the last pass rendering into it
+        void present(CommandEncoder* encoder);
+
+        // Waits for the queue and the sink until every presented frame is delivered
+        void flush();
+
+        HeadlessFrameStats getStats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct PacingWindow {
+            std::vector<double> samples;
+            Uint32 cursor = 0;
+
+            void add(double milliseconds);
+        };
+
+        struct Slot {
+            std::shared_ptr<Texture> target;
+            std::shared_ptr<TextureView> view;
+
+            std::shared_ptr<Buffer> readback;
+            const uint8_t* data = nullptr;
+
+            Uint64 frameIndex = 0;
+            Clock::time_point presentTime;
+
+            // Copy recorded and not yet handed to the sink
+            bool presented = false;
+
+            // With the sink, guarded by mutex
+            bool delivering = false;
+        };
+
+        Device* device;
+        HeadlessPresenterDescriptor desc;
+        HeadlessFrameSink sink;
+        std::string error;
+
+        std::vector<Slot> slots;
+        Slot* current = nullptr;
+
+        ImageDataLayout layout;
+        Uint32 rowBytes;
+
+        TextureStateTracker tracker;
+
+        mutable std::mutex mutex;
+        std::condition_variable delivered;
+        HeadlessFrameStats stats;
+
+        Clock::time_point lastBeginTime;
+        PacingWindow frameTimes;
+        PacingWindow latencies;
+
+        // One worker, so the sink sees frames in order
+        TaskPool deliveryPool{ 1 };
+
+        void deliver(Uint64 completedFrameIndex);
+    };
+};
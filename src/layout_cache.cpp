@@ -0,0 +1,249 @@
+#include "layout_cache.hpp"
+
+#include "hash.hpp"
+
+#include <algorithm>
+
+namespace Rhi {
+    namespace {
+        // Only the sub layout selected by type takes part, the others are ignored by backends
+        Uint64 hashEntry(const BindGroupLayoutEntry& entry, Uint64 hash) {
+            hash = hashCombine(hash, entry.binding);
+            hash = hashCombine(hash, entry.visibility);
+            hash = hashCombine(hash, static_cast<Uint64>(entry.type));
+            hash = hashCombine(hash, entry.count);
+            hash = hashCombine(hash, entry.partiallyBound);
+
+            switch (entry.type) {
+                case BindingType::eBuffer:
+                    hash = hashCombine(hash, static_cast<Uint64>(entry.buffer.type));
+                    hash = hashCombine(hash, entry.buffer.hasDynamicOffset);
+                    hash = hashCombine(hash, entry.buffer.minBindingSize);
+                    break;
+
+                case BindingType::eSampler:
+                    hash = hashCombine(hash, static_cast<Uint64>(entry.sampler.type));
+                    break;
+
+                case BindingType::eTexture:
+                    hash = hashCombine(hash, static_cast<Uint64>(entry.texture.sampleType));
+                    hash = hashCombine(hash, static_cast<Uint64>(entry.texture.viewDimension));
+                    hash = hashCombine(hash, entry.texture.multisampled);
+                    break;
+
+                case BindingType::eStorageTexture:
+                    hash = hashCombine(hash, static_cast<Uint64>(entry.storageTexture.access));
+                    hash = hashCombine(hash, static_cast<Uint64>(entry.storageTexture.viewDimension));
+                    hash = hashCombine(hash, static_cast<Uint64>(entry.storageTexture.format));
+                    break;
+            }
+
+            return hash;
+        }
+
+        bool isEqualEntry(const BindGroupLayoutEntry& a, const BindGroupLayoutEntry& b) {
+            if (a.binding != b.binding || a.visibility != b.visibility || a.type != b.type || a.count != b.count
+                || a.partiallyBound != b.partiallyBound)
+            {
+                return false;
+            }
+
+            switch (a.type) {
+                case BindingType::eBuffer:
+                    return a.buffer.type == b.buffer.type && a.buffer.hasDynamicOffset == b.buffer.hasDynamicOffset
+                        && a.buffer.minBindingSize == b.buffer.minBindingSize;
+
+                case BindingType::eSampler:
+                    return a.sampler.type == b.sampler.type;
+
+                case BindingType::eTexture:
+                    return a.texture.sampleType == b.texture.sampleType && a.texture.viewDimension == b.texture.viewDimension
+                        && a.texture.multisampled == b.texture.multisampled;
+
+                case BindingType::eStorageTexture:
+                    return a.storageTexture.access == b.storageTexture.access
+                        && a.storageTexture.viewDimension == b.storageTexture.viewDimension
+                        && a.storageTexture.format == b.storageTexture.format;
+            }
+
+            return false;
+        }
+
+        Uint64 hashPushConstantRanges(const std::vector<PushConstantRange>& ranges, Uint64 hash) {
+            for (const auto& range : ranges) {
+                hash = hashCombine(hash, range.visibility);
+                hash = hashCombine(hash, range.offset);
+                hash = hashCombine(hash, range.size);
+            }
+
+            return hash;
+        }
+
+        bool isEqualPushConstantRanges(const std::vector<PushConstantRange>& a, const std::vector<PushConstantRange>& b) {
+            if (a.size() != b.size()) {
+                return false;
+            }
+
+            for (size_t i = 0; i < a.size(); i++) {
+                if (a[i].visibility != b[i].visibility || a[i].offset != b[i].offset || a[i].size != b[i].size) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+    };
+
+    PipelineLayoutCache::PipelineLayoutCache(Device* device) : device{ device } {}
+
+    BindGroupLayout* PipelineLayoutCache::getBindGroupLayout(const BindGroupLayoutDescriptor& descriptor) {
+        std::lock_guard<std::mutex> lock{ this->mutex };
+        return this->getBindGroupLayoutLocked(descriptor);
+    }
+
+    PipelineLayout* PipelineLayoutCache::getPipelineLayout(const std::vector<BindGroupLayoutDescriptor>& groups,
+        const std::vector<PushConstantRange>& pushConstantRanges)
+    {
+        std::lock_guard<std::mutex> lock{ this->mutex };
+        return this->getPipelineLayoutLocked(groups, pushConstantRanges);
+    }
+
+    BindGroupLayout* PipelineLayoutCache::getBindGroupLayoutLocked(const BindGroupLayoutDescriptor& descriptor) {
+        // Entry order does not change the layout, sort so both orders intern to one object
+        BindGroupLayoutDescriptor canonical = descriptor;
+        std::sort(canonical.entries.begin(), canonical.entries.end(), [](const BindGroupLayoutEntry& a, const BindGroupLayoutEntry& b) {
+            return a.binding < b.binding;
+        });
+
+        Uint64 hash = kHashSeed;
+        for (const auto& entry : canonical.entries) {
+            hash = hashEntry(entry, hash);
+        }
+
+        auto range = this->bindGroupLayouts.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            const auto& entries = it->second->desc.entries;
+
+            if (entries.size() == canonical.entries.size()
+                && std::equal(entries.begin(), entries.end(), canonical.entries.begin(), isEqualEntry))
+            {
+                return it->second.get();
+            }
+        }
+
+        auto layout = this->device->createBindGroupLayout(canonical);
+        this->bindGroupLayouts.emplace(hash, layout);
+
+        return layout.get();
+    }
+
+    PipelineLayout* PipelineLayoutCache::getPipelineLayoutLocked(const std::vector<BindGroupLayoutDescriptor>& groups,
+        const std::vector<PushConstantRange>& pushConstantRanges)
+    {
+        PipelineLayoutDescriptor descriptor;
+        descriptor.pushConstantRanges = pushConstantRanges;
+
+        // Interned bind group layouts compare by pointer from here on
+        Uint64 hash = kHashSeed;
+        for (const auto& group : groups) {
+            BindGroupLayout* layout = this->getBindGroupLayoutLocked(group);
+
+            descriptor.bindGroupLayouts.push_back(layout);
+            hash = hashCombine(hash, reinterpret_cast<Uint64>(layout));
+        }
+
+        hash = hashPushConstantRanges(pushConstantRanges, hash);
+
+        auto range = this->pipelineLayouts.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            const auto& desc = it->second->desc;
+
+            if (desc.bindGroupLayouts == descriptor.bindGroupLayouts
+                && isEqualPushConstantRanges(desc.pushConstantRanges, descriptor.pushConstantRanges))
+            {
+                return it->second.get();
+            }
+        }
+
+        auto layout = this->device->createPipelineLayout(descriptor);
+        this->pipelineLayouts.emplace(hash, layout);
+
+        return layout.get();
+    }
+
+    const ShaderReflection* PipelineLayoutCache::reflect(const ProgrammableStage& stage, std::string& error) {
+        std::lock_guard<std::mutex> lock{ this->mutex };
+
+        const ShaderModuleDescriptor& module = stage.module->desc;
+        const uint8_t* code = reinterpret_cast<const uint8_t*>(module.code);
+        Uint64 codeSize = code != nullptr ? module.codeSize : 0;
+        std::string entryPoint = stage.entryPoint != nullptr ? stage.entryPoint : "";
+
+        Uint64 hash = hashBytes(code, codeSize);
+        hash = hashString(entryPoint.c_str(), hash);
+
+        auto range = this->reflections.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            const ReflectionEntry& entry = it->second;
+
+            if (entry.entryPoint == entryPoint && entry.code.size() == codeSize
+                && std::equal(entry.code.begin(), entry.code.end(), code))
+            {
+                return entry.reflection.get();
+            }
+        }
+
+        auto reflection = std::make_unique<ShaderReflection>();
+        if (!reflectShaderModule(module, stage.entryPoint, *reflection, error)) {
+            return nullptr;
+        }
+
+        ReflectionEntry entry{ std::vector<uint8_t>(code, code + codeSize), entryPoint, std::move(reflection) };
+        return this->reflections.emplace(hash, std::move(entry))->second.reflection.get();
+    }
+
+    PipelineLayout* PipelineLayoutCache::deriveLayout(const std::vector<const ProgrammableStage*>& stages, std::string& error) {
+        std::vector<const ShaderReflection*> reflections;
+
+        for (const ProgrammableStage* stage : stages) {
+            const ShaderReflection* reflection = this->reflect(*stage, error);
+            if (reflection == nullptr) {
+                return nullptr;
+            }
+
+            reflections.push_back(reflection);
+        }
+
+        std::vector<BindGroupLayoutDescriptor> groups;
+        std::vector<PushConstantRange> pushConstantRanges;
+
+        Uint32 maxBindGroups = this->device->desc.requiredLimits.maxBindGroups;
+        if (!mergeShaderReflections(reflections, maxBindGroups, groups, pushConstantRanges, error)) {
+            return nullptr;
+        }
+
+        return this->getPipelineLayout(groups, pushConstantRanges);
+    }
+
+    PipelineLayout* PipelineLayoutCache::resolveLayout(const ComputePipelineDescriptor& descriptor, std::string& error) {
+        if (descriptor.layout != nullptr) {
+            return descriptor.layout;
+        }
+
+        return this->deriveLayout({ &descriptor.compute }, error);
+    }
+
+    PipelineLayout* PipelineLayoutCache::resolveLayout(const RenderPipelineDescriptor& descriptor, std::string& error) {
+        if (descriptor.layout != nullptr) {
+            return descriptor.layout;
+        }
+
+        // Depth only pipelines leave the fragment module empty
+        std::vector<const ProgrammableStage*> stages{ &descriptor.vertex };
+        if (descriptor.fragment.module != nullptr) {
+            stages.push_back(&descriptor.fragment);
+        }
+
+        return this->deriveLayout(stages, error);
+    }
+};
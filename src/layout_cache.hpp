@@ -0,0 +1,51 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "shader_reflection.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Pipeline Layout Cache
+    // ===========================================================================================================================
+
+    // Interns bind group and pipeline layouts so identical descriptors share one object, which
+    // keeps bind groups compatible across pipelines. The cache owns every layout it returns.
+    class PipelineLayoutCache {
+    public:
+        PipelineLayoutCache(Device* device);
+
+        BindGroupLayout* getBindGroupLayout(const BindGroupLayoutDescriptor& descriptor);
+        PipelineLayout* getPipelineLayout(const std::vector<BindGroupLayoutDescriptor>& groups,
+            const std::vector<PushConstantRange>& pushConstantRanges);
+
+        const ShaderReflection* reflect(const ProgrammableStage& stage, std::string& error);
+
+        // Returns descriptor.layout when set, the layout derived from the shader stages otherwise
+        PipelineLayout* resolveLayout(const ComputePipelineDescriptor& descriptor, std::string& error);
+        PipelineLayout* resolveLayout(const RenderPipelineDescriptor& descriptor, std::string& error);
+
+    private:
+        PipelineLayout* deriveLayout(const std::vector<const ProgrammableStage*>& stages, std::string& error);
+        PipelineLayout* getPipelineLayoutLocked(const std::vector<BindGroupLayoutDescriptor>& groups,
+            const std::vector<PushConstantRange>& pushConstantRanges);
+        BindGroupLayout* getBindGroupLayoutLocked(const BindGroupLayoutDescriptor& descriptor);
+
+        // Keyed by the SPIR-V rather than the module, which the cache does not own and whose
+        // address a later module may reuse
+        struct ReflectionEntry {
+            std::vector<uint8_t> code;
+            std::string entryPoint;
+            std::unique_ptr<ShaderReflection> reflection;
+        };
+
+        Device* device;
+        std::mutex mutex;
+
+        std::unordered_multimap<Uint64, std::shared_ptr<BindGroupLayout>> bindGroupLayouts;
+        std::unordered_multimap<Uint64, std::shared_ptr<PipelineLayout>> pipelineLayouts;
+        std::unordered_multimap<Uint64, ReflectionEntry> reflections;
+    };
+};
@@ -0,0 +1,159 @@
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Rhi {
+    MappedFile::~MappedFile() {
+        this->close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            this->close();
+
+            this->data = other.data;
+            this->size = other.size;
+            other.data = nullptr;
+            other.size = 0;
+
+#ifdef _WIN32
+            this->fileHandle = other.fileHandle;
+            this->mappingHandle = other.mappingHandle;
+            other.fileHandle = nullptr;
+            other.mappingHandle = nullptr;
+#endif
+        }
+
+        return *this;
+    }
+
+#ifdef _WIN32
+    bool MappedFile::open(const std::string& path) {
+        this->close();
+
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr) {
+            CloseHandle(file);
+            return false;
+        }
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        this->fileHandle = file;
+        this->mappingHandle = mapping;
+        this->data = static_cast<const uint8_t*>(view);
+        this->size = static_cast<Uint64>(fileSize.QuadPart);
+
+        return true;
+    }
+
+    void MappedFile::close() {
+        if (this->data != nullptr) {
+            UnmapViewOfFile(this->data);
+            CloseHandle(this->mappingHandle);
+            CloseHandle(this->fileHandle);
+        }
+
+        this->data = nullptr;
+        this->size = 0;
+        this->fileHandle = nullptr;
+        this->mappingHandle = nullptr;
+    }
+
+    void MappedFile::prefetch(Uint64 offset, Uint64 size) const {
+        if (this->data == nullptr || offset >= this->size) {
+            return;
+        }
+
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<uint8_t*>(this->data + offset);
+        range.NumberOfBytes = static_cast<SIZE_T>(std::min(size, this->size - offset));
+
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#else
+    bool MappedFile::open(const std::string& path) {
+        this->close();
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat fileStat;
+        if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+
+        void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+        // The mapping keeps its own reference to the file, the descriptor is no longer needed
+        ::close(fd);
+
+        if (view == MAP_FAILED) {
+            return false;
+        }
+
+        this->data = static_cast<const uint8_t*>(view);
+        this->size = static_cast<Uint64>(fileStat.st_size);
+
+        return true;
+    }
+
+    void MappedFile::close() {
+        if (this->data != nullptr) {
+            munmap(const_cast<uint8_t*>(this->data), static_cast<size_t>(this->size));
+        }
+
+        this->data = nullptr;
+        this->size = 0;
+    }
+
+    void MappedFile::prefetch(Uint64 offset, Uint64 size) const {
+        if (this->data == nullptr || offset >= this->size) {
+            return;
+        }
+
+        long pageSize = sysconf(_SC_PAGESIZE);
+        Uint64 alignedOffset = offset - (offset % static_cast<Uint64>(pageSize));
+        Uint64 end = std::min(offset + size, this->size);
+
+        madvise(const_cast<uint8_t*>(this->data + alignedOffset), static_cast<size_t>(end - alignedOffset), MADV_WILLNEED);
+    }
+#endif
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "rhi.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Mapped File
+    // ===========================================================================================================================
+
+    // Read-only view of a whole file mapped into the address space. Reads are served
+    // straight from the OS page cache, so the data is never copied into a heap buffer.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        bool open(const std::string& path);
+        void close();
+
+        // Hint the OS to start reading the given range ahead of the first access.
+        void prefetch(Uint64 offset, Uint64 size) const;
+
+        bool isOpen() const { return this->data != nullptr; }
+        const uint8_t* getData() const { return this->data; }
+        Uint64 getSize() const { return this->size; }
+
+    private:
+        const uint8_t* data = nullptr;
+        Uint64 size = 0;
+
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+    };
+};
@@ -0,0 +1,785 @@
+#include "mesh.hpp"
+#include "format_traits.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Helpers
+    // ===========================================================================================================================
+
+    namespace {
+        struct MeshFileHeader {
+            uint32_t magic;
+            uint32_t version;
+
+            uint32_t vertexCount;
+            uint32_t indexCount;
+            uint32_t vertexStride;
+            uint16_t attributeCount;
+            uint16_t subsetCount;
+            uint32_t indexFormat;
+            uint32_t reserved;
+
+            float boundsMin[3];
+            float boundsMax[3];
+
+            uint64_t attributeOffset;
+            uint64_t subsetOffset;
+            uint64_t vertexDataOffset;
+            uint64_t indexDataOffset;
+        };
+
+        struct MeshFileAttribute {
+            uint8_t semantic;
+            uint8_t format;
+            uint16_t offset;
+            uint32_t shaderLocation;
+        };
+
+        constexpr Uint64 kMeshFileSectionAlignment = 16;
+        constexpr Uint32 kMaxVertexCacheSize = 64;
+
+        Uint64 alignUp(Uint64 value, Uint64 alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        uint16_t encodeHalf(float value) {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            uint32_t sign = (bits >> 16) & 0x8000;
+            int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+            uint32_t mantissa = bits & 0x7FFFFF;
+
+            if (((bits >> 23) & 0xFF) == 0xFF) {
+                return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+            }
+
+            if (exponent >= 31) {
+                return static_cast<uint16_t>(sign | 0x7C00);
+            }
+
+            if (exponent <= 0) {
+                if (exponent < -10) {
+                    return static_cast<uint16_t>(sign);
+                }
+
+                mantissa |= 0x800000;
+                uint32_t shift = static_cast<uint32_t>(14 - exponent);
+                uint32_t half = mantissa >> shift;
+                uint32_t remainder = mantissa & ((1u << shift) - 1);
+                uint32_t halfway = 1u << (shift - 1);
+
+                if (remainder > halfway || (remainder == halfway && (half & 1))) {
+                    half++;
+                }
+
+                return static_cast<uint16_t>(sign | half);
+            }
+
+            uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+            uint32_t remainder = mantissa & 0x1FFF;
+
+            // Round to nearest even, a carry into the exponent is still the correct result
+            if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+                half++;
+            }
+
+            return static_cast<uint16_t>(half);
+        }
+
+        float clampFloat(float value, float low, float high) {
+            return std::min(std::max(value, low), high);
+        }
+
+        template <typename T>
+        void storeValue(uint8_t* dst, T value) {
+            std::memcpy(dst, &value, sizeof(T));
+        }
+
+        // ===========================================================================================================================
+        // Vertex Cache Scoring
+        // ===========================================================================================================================
+
+        constexpr float kCacheDecayPower = 1.5f;
+        constexpr float kLastTriangleScore = 0.75f;
+        constexpr float kValenceBoostScale = 2.0f;
+        constexpr float kValenceBoostPower = 0.5f;
+
+        float getVertexScore(int32_t cachePosition, uint32_t remainingValence, Uint32 cacheSize) {
+            if (remainingValence == 0) {
+                return -1.0f;
+            }
+
+            float score = 0.0f;
+
+            if (cachePosition >= 0) {
+                if (cachePosition < 3) {
+                    score = kLastTriangleScore;
+                } else {
+                    float scaler = 1.0f / static_cast<float>(cacheSize - 3);
+                    score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, kCacheDecayPower);
+                }
+            }
+
+            return score + kValenceBoostScale * std::pow(static_cast<float>(remainingValence), -kValenceBoostPower);
+        }
+    };
+
+    // ===========================================================================================================================
+    // Index Optimization
+    // ===========================================================================================================================
+
+    void optimizeVertexCache(uint32_t* indices, Uint64 indexCount, Uint32 vertexCount, Uint32 cacheSize) {
+        Uint64 triangleCount = indexCount / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        cacheSize = std::min(std::max<Uint32>(cacheSize, 4), kMaxVertexCacheSize);
+
+        // Triangle adjacency per vertex, the first remainingValence entries are still unemitted
+        std::vector<uint32_t> remainingValence(vertexCount, 0);
+        for (Uint64 i = 0; i < triangleCount * 3; i++) {
+            remainingValence[indices[i]]++;
+        }
+
+        std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+        for (Uint32 v = 0; v < vertexCount; v++) {
+            adjacencyOffset[v + 1] = adjacencyOffset[v] + remainingValence[v];
+        }
+
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (Uint64 t = 0; t < triangleCount; t++) {
+            for (Uint32 k = 0; k < 3; k++) {
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<uint32_t>(t);
+            }
+        }
+
+        std::vector<int32_t> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (Uint32 v = 0; v < vertexCount; v++) {
+            vertexScore[v] = getVertexScore(-1, remainingValence[v], cacheSize);
+        }
+
+        std::vector<float> triangleScore(triangleCount);
+        std::vector<uint8_t> emitted(triangleCount, 0);
+
+        Uint64 bestTriangle = 0;
+        for (Uint64 t = 0; t < triangleCount; t++) {
+            triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+            if (triangleScore[t] > triangleScore[bestTriangle]) {
+                bestTriangle = t;
+            }
+        }
+
+        std::vector<uint32_t> output;
+        output.reserve(triangleCount * 3);
+
+        uint32_t cache[kMaxVertexCacheSize + 3];
+        Uint32 cacheCount = 0;
+        Uint64 scanCursor = 0;
+
+        for (Uint64 emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+            if (bestTriangle == ULLONG_MAX) {
+                // Nothing adjacent to the cache is left, continue with the next unemitted triangle
+                while (emitted[scanCursor]) {
+                    scanCursor++;
+                }
+
+                bestTriangle = scanCursor;
+            }
+
+            const uint32_t* triangle = indices + bestTriangle * 3;
+            emitted[bestTriangle] = 1;
+
+            for (Uint32 k = 0; k < 3; k++) {
+                uint32_t v = triangle[k];
+                output.push_back(v);
+
+                uint32_t* begin = adjacency.data() + adjacencyOffset[v];
+                uint32_t* end = begin + remainingValence[v];
+                std::iter_swap(std::find(begin, end, static_cast<uint32_t>(bestTriangle)), end - 1);
+                remainingValence[v]--;
+            }
+
+            // The emitted triangle moves to the front of the LRU cache
+            uint32_t newCache[kMaxVertexCacheSize + 3];
+            Uint32 newCount = 0;
+
+            for (Uint32 k = 0; k < 3; k++) {
+                newCache[newCount++] = triangle[k];
+            }
+
+            for (Uint32 i = 0; i < cacheCount; i++) {
+                uint32_t v = cache[i];
+                if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                    newCache[newCount++] = v;
+                }
+            }
+
+            for (Uint32 i = 0; i < newCount; i++) {
+                uint32_t v = newCache[i];
+                cachePosition[v] = i < cacheSize ? static_cast<int32_t>(i) : -1;
+                vertexScore[v] = getVertexScore(cachePosition[v], remainingValence[v], cacheSize);
+            }
+
+            // Only triangles touching the old or new cache changed their score
+            bestTriangle = ULLONG_MAX;
+            float bestScore = -1.0f;
+
+            for (Uint32 i = 0; i < newCount; i++) {
+                uint32_t v = newCache[i];
+
+                for (Uint32 a = 0; a < remainingValence[v]; a++) {
+                    uint32_t t = adjacency[adjacencyOffset[v] + a];
+                    triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+                    if (triangleScore[t] > bestScore) {
+                        bestScore = triangleScore[t];
+                        bestTriangle = t;
+                    }
+                }
+            }
+
+            cacheCount = std::min(newCount, cacheSize);
+            std::copy(newCache, newCache + cacheCount, cache);
+        }
+
+        std::copy(output.begin(), output.end(), indices);
+    }
+
+    void optimizeOverdraw(uint32_t* indices, Uint64 indexCount, const float* positions, Uint32 cacheSize) {
+        Uint64 triangleCount = indexCount / 3;
+        if (triangleCount == 0) {
+            return;
+        }
+
+        uint32_t vertexCount = *std::max_element(indices, indices + triangleCount * 3) + 1;
+
+        // A triangle missing the cache on all three vertices is a natural restart point
+        std::vector<Uint64> clusterStart;
+        std::vector<Uint64> cacheTimestamp(vertexCount, 0);
+        Uint64 timestamp = cacheSize + 1;
+
+        for (Uint64 t = 0; t < triangleCount; t++) {
+            Uint32 misses = 0;
+
+            for (Uint32 k = 0; k < 3; k++) {
+                uint32_t v = indices[t * 3 + k];
+
+                if (timestamp - cacheTimestamp[v] > cacheSize) {
+                    cacheTimestamp[v] = timestamp++;
+                    misses++;
+                }
+            }
+
+            if (t == 0 || misses == 3) {
+                clusterStart.push_back(t);
+            }
+        }
+
+        clusterStart.push_back(triangleCount);
+        Uint64 clusterCount = clusterStart.size() - 1;
+
+        struct Cluster {
+            float centroid[3];
+            float normal[3];
+            float area;
+        };
+
+        std::vector<Cluster> clusters(clusterCount);
+        float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+        float meshArea = 0.0f;
+
+        for (Uint64 c = 0; c < clusterCount; c++) {
+            Cluster& cluster = clusters[c];
+            cluster = {};
+
+            for (Uint64 t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+                const float* p0 = positions + indices[t * 3] * 3;
+                const float* p1 = positions + indices[t * 3 + 1] * 3;
+                const float* p2 = positions + indices[t * 3 + 2] * 3;
+
+                float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+                float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+                for (Uint32 i = 0; i < 3; i++) {
+                    cluster.centroid[i] += (p0[i] + p1[i] + p2[i]) / 3.0f * area;
+                    cluster.normal[i] += n[i];
+                }
+
+                cluster.area += area;
+            }
+
+            for (Uint32 i = 0; i < 3; i++) {
+                meshCentroid[i] += cluster.centroid[i];
+            }
+
+            meshArea += cluster.area;
+
+            if (cluster.area > 0.0f) {
+                for (Uint32 i = 0; i < 3; i++) {
+                    cluster.centroid[i] /= cluster.area;
+                }
+            }
+        }
+
+        if (meshArea > 0.0f) {
+            for (Uint32 i = 0; i < 3; i++) {
+                meshCentroid[i] /= meshArea;
+            }
+        }
+
+        // Clusters facing away from the mesh center are likely occluders, draw them first
+        std::vector<float> sortKey(clusterCount);
+        for (Uint64 c = 0; c < clusterCount; c++) {
+            const Cluster& cluster = clusters[c];
+            float length = std::sqrt(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]);
+
+            float key = 0.0f;
+            for (Uint32 i = 0; i < 3 && length > 0.0f; i++) {
+                key += (cluster.centroid[i] - meshCentroid[i]) * cluster.normal[i] / length;
+            }
+
+            sortKey[c] = key;
+        }
+
+        std::vector<Uint64> order(clusterCount);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&sortKey](Uint64 a, Uint64 b) { return sortKey[a] > sortKey[b]; });
+
+        std::vector<uint32_t> output;
+        output.reserve(triangleCount * 3);
+
+        for (Uint64 c : order) {
+            output.insert(output.end(), indices + clusterStart[c] * 3, indices + clusterStart[c + 1] * 3);
+        }
+
+        std::copy(output.begin(), output.end(), indices);
+    }
+
+    float analyzeVertexCache(const uint32_t* indices, Uint64 indexCount, Uint32 vertexCount, Uint32 cacheSize) {
+        Uint64 triangleCount = indexCount / 3;
+        if (triangleCount == 0) {
+            return 0.0f;
+        }
+
+        std::vector<Uint64> cacheTimestamp(vertexCount, 0);
+        Uint64 timestamp = cacheSize + 1;
+        Uint64 misses = 0;
+
+        for (Uint64 i = 0; i < triangleCount * 3; i++) {
+            if (timestamp - cacheTimestamp[indices[i]] > cacheSize) {
+                cacheTimestamp[indices[i]] = timestamp++;
+                misses++;
+            }
+        }
+
+        return static_cast<float>(misses) / static_cast<float>(triangleCount);
+    }
+
+    // ===========================================================================================================================
+    // Mesh Cooking
+    // ===========================================================================================================================
+
+    void encodeVertexAttribute(VertexFormat format, const float* values, Uint32 componentCount, uint8_t* dst) {
+        float v[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        for (Uint32 i = 0; i < componentCount && i < 4; i++) {
+            v[i] = values[i];
+        }
+
+        switch (format) {
+            case eFloat32: case eFloat32x2: case eFloat32x3: case eFloat32x4:
+                std::memcpy(dst, v, getVertexFormatTraits(format).size);
+                break;
+
+            case eFloat16x2: case eFloat16x4:
+                for (Uint32 i = 0; i < getVertexFormatTraits(format).size / 2; i++) {
+                    storeValue<uint16_t>(dst + i * 2, encodeHalf(v[i]));
+                }
+                break;
+
+            case eUnorm16x2: case eUnorm16x4:
+                for (Uint32 i = 0; i < getVertexFormatTraits(format).size / 2; i++) {
+                    storeValue<uint16_t>(dst + i * 2, static_cast<uint16_t>(std::lround(clampFloat(v[i], 0.0f, 1.0f) * 65535.0f)));
+                }
+                break;
+
+            case eSnorm16x2: case eSnorm16x4:
+                for (Uint32 i = 0; i < getVertexFormatTraits(format).size / 2; i++) {
+                    storeValue<int16_t>(dst + i * 2, static_cast<int16_t>(std::lround(clampFloat(v[i], -1.0f, 1.0f) * 32767.0f)));
+                }
+                break;
+
+            case eUnorm8x2: case eUnorm8x4:
+                for (Uint32 i = 0; i < getVertexFormatTraits(format).size; i++) {
+                    dst[i] = static_cast<uint8_t>(std::lround(clampFloat(v[i], 0.0f, 1.0f) * 255.0f));
+                }
+                break;
+
+            case eSnorm8x2: case eSnorm8x4:
+                for (Uint32 i = 0; i < getVertexFormatTraits(format).size; i++) {
+                    storeValue<int8_t>(dst + i, static_cast<int8_t>(std::lround(clampFloat(v[i], -1.0f, 1.0f) * 127.0f)));
+                }
+                break;
+
+            case eUnorm1010102: {
+                // Signed directions are biased into [0, 1], w keeps only its sign
+                uint32_t x = static_cast<uint32_t>(std::lround(clampFloat(v[0] * 0.5f + 0.5f, 0.0f, 1.0f) * 1023.0f));
+                uint32_t y = static_cast<uint32_t>(std::lround(clampFloat(v[1] * 0.5f + 0.5f, 0.0f, 1.0f) * 1023.0f));
+                uint32_t z = static_cast<uint32_t>(std::lround(clampFloat(v[2] * 0.5f + 0.5f, 0.0f, 1.0f) * 1023.0f));
+                uint32_t w = v[3] < 0.0f ? 0u : 3u;
+
+                storeValue<uint32_t>(dst, x | (y << 10) | (z << 20) | (w << 30));
+                break;
+            }
+
+            default:
+                std::memset(dst, 0, getVertexFormatTraits(format).size);
+                break;
+        }
+    }
+
+    bool cookMesh(const MeshSource& source, const MeshCookOptions& options, CookedMesh& mesh, std::string& error) {
+        if (source.positions.empty() || source.positions.size() % 3 != 0) {
+            error = "Mesh has no positions";
+            return false;
+        }
+
+        Uint32 vertexCount = static_cast<Uint32>(source.positions.size() / 3);
+
+        struct Stream {
+            VertexSemantic semantic;
+            const std::vector<float>* values;
+            Uint32 componentCount;
+            VertexFormat format;
+        };
+
+        std::vector<Stream> streams;
+        streams.push_back({ VertexSemantic::ePosition, &source.positions, 3, options.positionFormat });
+        streams.push_back({ VertexSemantic::eNormal, &source.normals, 3, options.normalFormat });
+        streams.push_back({ VertexSemantic::eTangent, &source.tangents, 4, options.tangentFormat });
+        streams.push_back({ VertexSemantic::eTexCoord0, &source.texCoords, 2, options.texCoordFormat });
+        streams.push_back({ VertexSemantic::eColor0, &source.colors, 4, options.colorFormat });
+
+        streams.erase(std::remove_if(streams.begin(), streams.end(), [](const Stream& s) { return s.values->empty(); }), streams.end());
+
+        for (const auto& stream : streams) {
+            if (stream.values->size() != vertexCount * stream.componentCount) {
+                error = "Mesh attribute arrays have mismatching vertex counts";
+                return false;
+            }
+        }
+
+        std::vector<uint32_t> indices = source.indices;
+        if (indices.empty()) {
+            indices.resize(vertexCount);
+            std::iota(indices.begin(), indices.end(), 0u);
+        }
+
+        if (indices.size() % 3 != 0 || *std::max_element(indices.begin(), indices.end()) >= vertexCount) {
+            error = "Mesh indices do not form valid triangles";
+            return false;
+        }
+
+        std::vector<MeshSubset> subsets = source.subsets;
+        if (subsets.empty()) {
+            subsets.push_back({ 0, static_cast<uint32_t>(indices.size()) });
+        }
+
+        for (const auto& subset : subsets) {
+            if (subset.firstIndex % 3 != 0 || subset.indexCount % 3 != 0 || subset.firstIndex + subset.indexCount > indices.size()) {
+                error = "Mesh subset is not a triangle range inside the index buffer";
+                return false;
+            }
+
+            uint32_t* subsetIndices = indices.data() + subset.firstIndex;
+
+            if (options.optimizeVertexCache) {
+                optimizeVertexCache(subsetIndices, subset.indexCount, vertexCount, options.vertexCacheSize);
+            }
+
+            if (options.optimizeOverdraw) {
+                optimizeOverdraw(subsetIndices, subset.indexCount, source.positions.data(), options.vertexCacheSize);
+            }
+        }
+
+        // Renumber vertices in order of first use so vertex fetch walks memory linearly
+        std::vector<uint32_t> remap(vertexCount, UINT32_MAX);
+        std::vector<uint32_t> order;
+        order.reserve(vertexCount);
+
+        if (options.optimizeVertexFetch) {
+            for (auto& index : indices) {
+                if (remap[index] == UINT32_MAX) {
+                    remap[index] = static_cast<uint32_t>(order.size());
+                    order.push_back(index);
+                }
+
+                index = remap[index];
+            }
+        } else {
+            order.resize(vertexCount);
+            std::iota(order.begin(), order.end(), 0u);
+        }
+
+        mesh = CookedMesh{};
+        mesh.vertexCount = static_cast<Uint32>(order.size());
+        mesh.indices = std::move(indices);
+        mesh.subsets = std::move(subsets);
+
+        Uint64 offset = 0;
+        for (auto& stream : streams) {
+            if (stream.semantic == VertexSemantic::eTexCoord0 && stream.format == VertexFormat::eUnorm16x2) {
+                bool normalized = std::all_of(stream.values->begin(), stream.values->end(), [](float v) { return v >= 0.0f && v <= 1.0f; });
+
+                if (!normalized) {
+                    stream.format = VertexFormat::eFloat16x2;
+                }
+            }
+
+            MeshVertexAttribute attribute;
+            attribute.semantic = stream.semantic;
+            attribute.attribute.format = stream.format;
+            attribute.attribute.offset = offset;
+            attribute.attribute.shaderLocation = static_cast<Uint32>(stream.semantic);
+
+            mesh.attributes.push_back(attribute);
+            offset = alignUp(offset + getVertexFormatTraits(stream.format).size, 4);
+        }
+
+        mesh.vertexStride = offset;
+        mesh.vertexData.assign(mesh.vertexCount * mesh.vertexStride, 0);
+
+        for (Uint32 v = 0; v < mesh.vertexCount; v++) {
+            uint8_t* vertex = mesh.vertexData.data() + v * mesh.vertexStride;
+
+            for (size_t a = 0; a < streams.size(); a++) {
+                const Stream& stream = streams[a];
+                const float* values = stream.values->data() + order[v] * stream.componentCount;
+
+                encodeVertexAttribute(stream.format, values, stream.componentCount, vertex + mesh.attributes[a].attribute.offset);
+            }
+        }
+
+        for (Uint32 i = 0; i < 3; i++) {
+            mesh.boundsMin[i] = source.positions[i];
+            mesh.boundsMax[i] = source.positions[i];
+        }
+
+        for (Uint32 v = 0; v < vertexCount; v++) {
+            for (Uint32 i = 0; i < 3; i++) {
+                mesh.boundsMin[i] = std::min(mesh.boundsMin[i], source.positions[v * 3 + i]);
+                mesh.boundsMax[i] = std::max(mesh.boundsMax[i], source.positions[v * 3 + i]);
+            }
+        }
+
+        return true;
+    }
+
+    // ===========================================================================================================================
+    // Mesh File
+    // ===========================================================================================================================
+
+    bool writeMeshFile(const std::string& path, const CookedMesh& mesh, std::string& error) {
+        bool useShortIndices = mesh.vertexCount <= 0x10000;
+
+        MeshFileHeader header{};
+        header.magic = kMeshFileMagic;
+        header.version = kMeshFileVersion;
+        header.vertexCount = static_cast<uint32_t>(mesh.vertexCount);
+        header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+        header.vertexStride = static_cast<uint32_t>(mesh.vertexStride);
+        header.attributeCount = static_cast<uint16_t>(mesh.attributes.size());
+        header.subsetCount = static_cast<uint16_t>(mesh.subsets.size());
+        header.indexFormat = static_cast<uint32_t>(useShortIndices ? IndexFormat::eUint16 : IndexFormat::eUint32);
+
+        std::copy(mesh.boundsMin, mesh.boundsMin + 3, header.boundsMin);
+        std::copy(mesh.boundsMax, mesh.boundsMax + 3, header.boundsMax);
+
+        header.attributeOffset = alignUp(sizeof(MeshFileHeader), kMeshFileSectionAlignment);
+        header.subsetOffset = alignUp(header.attributeOffset + mesh.attributes.size() * sizeof(MeshFileAttribute), kMeshFileSectionAlignment);
+        header.vertexDataOffset = alignUp(header.subsetOffset + mesh.subsets.size() * sizeof(MeshSubset), kMeshFileSectionAlignment);
+        header.indexDataOffset = alignUp(header.vertexDataOffset + mesh.vertexData.size(), kMeshFileSectionAlignment);
+
+        std::vector<uint8_t> bytes(header.indexDataOffset + mesh.indices.size() * (useShortIndices ? 2 : 4), 0);
+        std::memcpy(bytes.data(), &header, sizeof(header));
+
+        for (size_t i = 0; i < mesh.attributes.size(); i++) {
+            MeshFileAttribute attribute;
+            attribute.semantic = static_cast<uint8_t>(mesh.attributes[i].semantic);
+            attribute.format = static_cast<uint8_t>(mesh.attributes[i].attribute.format);
+            attribute.offset = static_cast<uint16_t>(mesh.attributes[i].attribute.offset);
+            attribute.shaderLocation = static_cast<uint32_t>(mesh.attributes[i].attribute.shaderLocation);
+
+            std::memcpy(bytes.data() + header.attributeOffset + i * sizeof(attribute), &attribute, sizeof(attribute));
+        }
+
+        if (!mesh.subsets.empty()) {
+            std::memcpy(bytes.data() + header.subsetOffset, mesh.subsets.data(), mesh.subsets.size() * sizeof(MeshSubset));
+        }
+
+        if (!mesh.vertexData.empty()) {
+            std::memcpy(bytes.data() + header.vertexDataOffset, mesh.vertexData.data(), mesh.vertexData.size());
+        }
+
+        for (size_t i = 0; i < mesh.indices.size(); i++) {
+            if (useShortIndices) {
+                storeValue<uint16_t>(bytes.data() + header.indexDataOffset + i * 2, static_cast<uint16_t>(mesh.indices[i]));
+            } else {
+                storeValue<uint32_t>(bytes.data() + header.indexDataOffset + i * 4, mesh.indices[i]);
+            }
+        }
+
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        if (!stream.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+            error = "Failed to write " + path;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool MeshFile::open(const std::string& path, std::string& error) {
+        if (!this->file.open(path)) {
+            error = "Failed to map " + path;
+            return false;
+        }
+
+        if (this->file.getSize() < sizeof(MeshFileHeader)) {
+            error = "Mesh file is truncated";
+            return false;
+        }
+
+        MeshFileHeader header;
+        std::memcpy(&header, this->file.getData(), sizeof(header));
+
+        if (header.magic != kMeshFileMagic) {
+            error = "Not a mesh file";
+            return false;
+        }
+
+        if (header.version != kMeshFileVersion) {
+            error = "Mesh file version " + std::to_string(header.version) + " is not supported";
+            return false;
+        }
+
+        if (header.indexFormat != static_cast<uint32_t>(IndexFormat::eUint16) && header.indexFormat != static_cast<uint32_t>(IndexFormat::eUint32)) {
+            error = "Mesh file has an invalid index format";
+            return false;
+        }
+
+        Uint64 indexSize = header.indexFormat == static_cast<uint32_t>(IndexFormat::eUint16) ? 2 : 4;
+        Uint64 fileSize = this->file.getSize();
+
+        // Offsets come from the file, compare by subtraction so they cannot wrap
+        auto isInFile = [fileSize](Uint64 offset, Uint64 size) {
+            return offset <= fileSize && size <= fileSize - offset;
+        };
+
+        if (!isInFile(header.attributeOffset, header.attributeCount * sizeof(MeshFileAttribute))
+            || !isInFile(header.subsetOffset, header.subsetCount * sizeof(MeshSubset))
+            || !isInFile(header.vertexDataOffset, static_cast<Uint64>(header.vertexCount) * header.vertexStride)
+            || !isInFile(header.indexDataOffset, header.indexCount * indexSize)) {
+            error = "Mesh file sections are out of bounds";
+            return false;
+        }
+
+        this->vertexCount = header.vertexCount;
+        this->indexCount = header.indexCount;
+        this->indexFormat = static_cast<IndexFormat>(header.indexFormat);
+        this->vertexDataOffset = header.vertexDataOffset;
+        this->indexDataOffset = header.indexDataOffset;
+
+        std::copy(header.boundsMin, header.boundsMin + 3, this->boundsMin);
+        std::copy(header.boundsMax, header.boundsMax + 3, this->boundsMax);
+
+        this->attributes.clear();
+        this->layout = VertexBufferLayout{};
+        this->layout.arrayStride = header.vertexStride;
+
+        for (Uint32 i = 0; i < header.attributeCount; i++) {
+            MeshFileAttribute fileAttribute;
+            std::memcpy(&fileAttribute, this->file.getData() + header.attributeOffset + i * sizeof(fileAttribute), sizeof(fileAttribute));
+
+            if (fileAttribute.format > eUnorm1010102
+                || fileAttribute.offset + getVertexFormatTraits(static_cast<VertexFormat>(fileAttribute.format)).size > header.vertexStride)
+            {
+                error = "Mesh file attribute " + std::to_string(i) + " lies outside the vertex stride";
+                return false;
+            }
+
+            MeshVertexAttribute attribute;
+            attribute.semantic = static_cast<VertexSemantic>(fileAttribute.semantic);
+            attribute.attribute.format = static_cast<VertexFormat>(fileAttribute.format);
+            attribute.attribute.offset = fileAttribute.offset;
+            attribute.attribute.shaderLocation = fileAttribute.shaderLocation;
+
+            this->attributes.push_back(attribute);
+            this->layout.attributes.push_back(attribute.attribute);
+        }
+
+        this->subsets.resize(header.subsetCount);
+        if (header.subsetCount > 0) {
+            std::memcpy(this->subsets.data(), this->file.getData() + header.subsetOffset, header.subsetCount * sizeof(MeshSubset));
+        }
+
+        for (const MeshSubset& subset : this->subsets) {
+            if (subset.firstIndex > header.indexCount || subset.indexCount > header.indexCount - subset.firstIndex) {
+                error = "Mesh file subset is outside the index data";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    MeshBuffers uploadMesh(Device* device, CommandEncoder* encoder, const MeshFile& mesh) {
+        MeshBuffers buffers;
+
+        Uint64 vertexSize = mesh.getVertexDataSize();
+        Uint64 indexSize = mesh.getIndexDataSize();
+        Uint64 indexOffset = alignUp(vertexSize, 4);
+
+        BufferDescriptor vertexDesc;
+        vertexDesc.size = vertexSize;
+        vertexDesc.usage = static_cast<BufferUsageFlags>(BufferUsage::eVertex) | static_cast<BufferUsageFlags>(BufferUsage::eCopyDst);
+        vertexDesc.location = BufferLocation::eDeviceLocal;
+
+        BufferDescriptor indexDesc;
+        indexDesc.size = indexSize;
+        indexDesc.usage = static_cast<BufferUsageFlags>(BufferUsage::eIndex) | static_cast<BufferUsageFlags>(BufferUsage::eCopyDst);
+        indexDesc.location = BufferLocation::eDeviceLocal;
+
+        BufferDescriptor stagingDesc;
+        stagingDesc.size = indexOffset + indexSize;
+        stagingDesc.usage = static_cast<BufferUsageFlags>(BufferUsage::eCopySrc);
+        stagingDesc.location = BufferLocation::eHost;
+
+        buffers.vertexBuffer = device->createBuffer(vertexDesc);
+        buffers.indexBuffer = device->createBuffer(indexDesc);
+        buffers.staging = device->createBuffer(stagingDesc);
+
+        uint8_t* staging = static_cast<uint8_t*>(buffers.staging->map(stagingDesc.size, 0));
+        std::memcpy(staging, mesh.getVertexData(), vertexSize);
+        std::memcpy(staging + indexOffset, mesh.getIndexData(), indexSize);
+
+        buffers.staging->flush(stagingDesc.size, 0);
+        buffers.staging->unmap();
+
+        encoder->copyBufferToBuffer(buffers.staging.get(), 0, buffers.vertexBuffer.get(), 0, vertexSize);
+        encoder->copyBufferToBuffer(buffers.staging.get(), indexOffset, buffers.indexBuffer.get(), 0, indexSize);
+
+        return buffers;
+    }
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "mapped_file.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Mesh Source
+    // ===========================================================================================================================
+
+    enum class VertexSemantic : Uint8 {
+        ePosition,
+        eNormal,
+        eTangent,
+        eTexCoord0,
+        eColor0
+    };
+
+    struct MeshSubset {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+    };
+
+    // Uncompressed float input, one array per attribute. Attributes with an empty array
+    // are left out of the cooked vertex.
+    struct MeshSource {
+        std::vector<float> positions;   // xyz
+        std::vector<float> normals;     // xyz
+        std::vector<float> tangents;    // xyzw, w holds the bitangent sign
+        std::vector<float> texCoords;   // uv
+        std::vector<float> colors;      // rgba
+
+        std::vector<uint32_t> indices;
+        std::vector<MeshSubset> subsets;
+    };
+
+    // Loads an OBJ file through tinyobjloader, welding identical position/normal/uv tuples
+    bool importObjMesh(const std::string& path, MeshSource& source, std::string& error);
+
+    // ===========================================================================================================================
+    // Mesh Cooking
+    // ===========================================================================================================================
+
+    struct MeshCookOptions {
+        VertexFormat positionFormat = VertexFormat::eFloat16x4;
+        VertexFormat normalFormat = VertexFormat::eSnorm8x4;
+        VertexFormat tangentFormat = VertexFormat::eSnorm8x4;
+        VertexFormat texCoordFormat = VertexFormat::eUnorm16x2;     // eFloat16x2 when a uv leaves [0, 1]
+        VertexFormat colorFormat = VertexFormat::eUnorm8x4;
+
+        bool optimizeVertexCache = true;
+        bool optimizeOverdraw = true;
+        bool optimizeVertexFetch = true;
+        Uint32 vertexCacheSize = 32;
+    };
+
+    struct MeshVertexAttribute {
+        VertexSemantic semantic;
+        VertexAttribute attribute;
+    };
+
+    struct CookedMesh {
+        Uint32 vertexCount = 0;
+        Uint64 vertexStride = 0;
+
+        std::vector<MeshVertexAttribute> attributes;
+        std::vector<uint8_t> vertexData;
+        std::vector<uint32_t> indices;
+        std::vector<MeshSubset> subsets;
+
+        float boundsMin[3] = { 0.0f, 0.0f, 0.0f };
+        float boundsMax[3] = { 0.0f, 0.0f, 0.0f };
+    };
+
+    // values holds up to four components, missing ones are filled from (0, 0, 0, 1)
+    void encodeVertexAttribute(VertexFormat format, const float* values, Uint32 componentCount, uint8_t* dst);
+
+    bool cookMesh(const MeshSource& source, const MeshCookOptions& options, CookedMesh& mesh, std::string& error);
+
+    // Reorders triangles for the post-transform vertex cache (Forsyth, linear speed)
+    void optimizeVertexCache(uint32_t* indices, Uint64 indexCount, Uint32 vertexCount, Uint32 cacheSize);
+
+    // Splits cache optimized triangles into clusters at cache restarts and draws outward
+    // facing clusters first, so the vertex cache efficiency is kept while overdraw drops
+    void optimizeOverdraw(uint32_t* indices, Uint64 indexCount, const float* positions, Uint32 cacheSize);
+
+    // Average cache miss count per triangle for a FIFO cache of the given size
+    float analyzeVertexCache(const uint32_t* indices, Uint64 indexCount, Uint32 vertexCount, Uint32 cacheSize);
+
+    // ===========================================================================================================================
+    // Mesh File
+    // ===========================================================================================================================
+
+    constexpr uint32_t kMeshFileMagic = 0x48534D4E;    // "NMSH"
+    constexpr uint32_t kMeshFileVersion = 1;
+
+    bool writeMeshFile(const std::string& path, const CookedMesh& mesh, std::string& error);
+
+    // Memory mapped cooked mesh. Vertex and index data stay in the page cache and are
+    // copied once, into upload staging.
+    class MeshFile {
+    public:
+        bool open(const std::string& path, std::string& error);
+
+        Uint32 getVertexCount() const { return this->vertexCount; }
+        Uint32 getIndexCount() const { return this->indexCount; }
+        IndexFormat getIndexFormat() const { return this->indexFormat; }
+
+        const VertexBufferLayout& getVertexBufferLayout() const { return this->layout; }
+        const std::vector<MeshVertexAttribute>& getAttributes() const { return this->attributes; }
+        const std::vector<MeshSubset>& getSubsets() const { return this->subsets; }
+
+        const uint8_t* getVertexData() const { return this->file.getData() + this->vertexDataOffset; }
+        Uint64 getVertexDataSize() const { return this->vertexCount * this->layout.arrayStride; }
+
+        const uint8_t* getIndexData() const { return this->file.getData() + this->indexDataOffset; }
+        Uint64 getIndexDataSize() const { return this->indexCount * (this->indexFormat == IndexFormat::eUint16 ? 2ull : 4ull); }
+
+        const float* getBoundsMin() const { return this->boundsMin; }
+        const float* getBoundsMax() const { return this->boundsMax; }
+
+    private:
+        MappedFile file;
+
+        Uint32 vertexCount = 0;
+        Uint32 indexCount = 0;
+        IndexFormat indexFormat = IndexFormat::eUint32;
+
+        VertexBufferLayout layout;
+        std::vector<MeshVertexAttribute> attributes;
+        std::vector<MeshSubset> subsets;
+
+        Uint64 vertexDataOffset = 0;
+        Uint64 indexDataOffset = 0;
+
+        float boundsMin[3];
+        float boundsMax[3];
+    };
+
+    struct MeshBuffers {
+        std::shared_ptr<Buffer> vertexBuffer;
+        std::shared_ptr<Buffer> indexBuffer;
+
+        // Keep alive until the encoder's commands finished executing
+        std::shared_ptr<Buffer> staging;
+    };
+
+    // Creates device local vertex/index buffers and records their copies from a single staging buffer
+    MeshBuffers uploadMesh(Device* device, CommandEncoder* encoder, const MeshFile& mesh);
+};
@@ -0,0 +1,90 @@
+#include "mesh.hpp"
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader.h>
+
+#include <unordered_map>
+
+namespace Rhi {
+    namespace {
+        struct ObjIndexHash {
+            size_t operator()(const tinyobj::index_t& index) const {
+                size_t hash = static_cast<size_t>(index.vertex_index);
+                hash = hash * 31 + static_cast<size_t>(index.normal_index);
+                hash = hash * 31 + static_cast<size_t>(index.texcoord_index);
+
+                return hash;
+            }
+        };
+
+        struct ObjIndexEqual {
+            bool operator()(const tinyobj::index_t& a, const tinyobj::index_t& b) const {
+                return a.vertex_index == b.vertex_index && a.normal_index == b.normal_index && a.texcoord_index == b.texcoord_index;
+            }
+        };
+    };
+
+    bool importObjMesh(const std::string& path, MeshSource& source, std::string& error) {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warning;
+
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, path.c_str())) {
+            return false;
+        }
+
+        bool hasNormals = !attrib.normals.empty();
+        bool hasTexCoords = !attrib.texcoords.empty();
+
+        source = MeshSource{};
+        std::unordered_map<tinyobj::index_t, uint32_t, ObjIndexHash, ObjIndexEqual> uniqueVertices;
+
+        // Each OBJ shape becomes one subset of the shared vertex/index buffers
+        for (const auto& shape : shapes) {
+            MeshSubset subset;
+            subset.firstIndex = static_cast<uint32_t>(source.indices.size());
+
+            for (const auto& index : shape.mesh.indices) {
+                auto found = uniqueVertices.find(index);
+
+                if (found != uniqueVertices.end()) {
+                    source.indices.push_back(found->second);
+                    continue;
+                }
+
+                uint32_t vertex = static_cast<uint32_t>(source.positions.size() / 3);
+                uniqueVertices.emplace(index, vertex);
+                source.indices.push_back(vertex);
+
+                for (Uint32 i = 0; i < 3; i++) {
+                    source.positions.push_back(attrib.vertices[3 * index.vertex_index + i]);
+                }
+
+                if (hasNormals) {
+                    for (Uint32 i = 0; i < 3; i++) {
+                        source.normals.push_back(index.normal_index >= 0 ? attrib.normals[3 * index.normal_index + i] : 0.0f);
+                    }
+                }
+
+                // OBJ puts the uv origin at the bottom left, textures are uploaded top row first
+                if (hasTexCoords) {
+                    source.texCoords.push_back(index.texcoord_index >= 0 ? attrib.texcoords[2 * index.texcoord_index] : 0.0f);
+                    source.texCoords.push_back(index.texcoord_index >= 0 ? 1.0f - attrib.texcoords[2 * index.texcoord_index + 1] : 0.0f);
+                }
+            }
+
+            subset.indexCount = static_cast<uint32_t>(source.indices.size()) - subset.firstIndex;
+            if (subset.indexCount > 0) {
+                source.subsets.push_back(subset);
+            }
+        }
+
+        if (source.positions.empty()) {
+            error = path + " contains no triangles";
+            return false;
+        }
+
+        return true;
+    }
+};
@@ -0,0 +1,355 @@
+#include "multi_device.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Rhi {
+    namespace {
+        struct FeatureField {
+            bool SupportedFeatures::* member;
+            const char* name;
+        };
+
+        template <typename T>
+        struct LimitField {
+            T SupportedLimits::* member;
+            const char* name;
+        };
+
+        const FeatureField kFeatureFields[] = {
+            { &SupportedFeatures::depthClipControl, "depthClipControl" },
+            { &SupportedFeatures::depth32floatStencil8float, "depth32floatStencil8float" },
+            { &SupportedFeatures::textureCompressionBc, "textureCompressionBc" },
+            { &SupportedFeatures::textureCompressionBcSliced3d, "textureCompressionBcSliced3d" },
+            { &SupportedFeatures::textureCompressionEtc2, "textureCompressionEtc2" },
+            { &SupportedFeatures::textureCompressionAstc, "textureCompressionAstc" },
+            { &SupportedFeatures::textureCompressionAstcSliced3d, "textureCompressionAstcSliced3d" },
+            { &SupportedFeatures::timestampQuery, "timestampQuery" },
+            { &SupportedFeatures::indirectFirstInstance, "indirectFirstInstance" },
+            { &SupportedFeatures::shaderFloat16, "shaderFloat16" },
+            { &SupportedFeatures::rg11b10ufloatRender, "rg11b10ufloatRender" },
+            { &SupportedFeatures::bgra8unormStorage, "bgra8unormStorage" },
+            { &SupportedFeatures::float32Filterable, "float32Filterable" },
+            { &SupportedFeatures::float32Blendable, "float32Blendable" },
+            { &SupportedFeatures::clipDistance, "clipDistance" },
+            { &SupportedFeatures::dualSourceBlending, "dualSourceBlending" }
+        };
+
+        const LimitField<unsigned long> kLimitFields[] = {
+            { &SupportedLimits::maxTextureDimension1D, "maxTextureDimension1D" },
+            { &SupportedLimits::maxTextureDimension2D, "maxTextureDimension2D" },
+            { &SupportedLimits::maxTextureDimension3D, "maxTextureDimension3D" },
+            { &SupportedLimits::maxTextureArrayLayers, "maxTextureArrayLayers" },
+            { &SupportedLimits::maxBindGroups, "maxBindGroups" },
+            { &SupportedLimits::maxBindGroupsPlusVertexBuffers, "maxBindGroupsPlusVertexBuffers" },
+            { &SupportedLimits::maxBindingsPerBindGroup, "maxBindingsPerBindGroup" },
+            { &SupportedLimits::maxPushConstantsSize, "maxPushConstantsSize" },
+            { &SupportedLimits::maxDynamicUniformBuffersPerPipelineLayout, "maxDynamicUniformBuffersPerPipelineLayout" },
+            { &SupportedLimits::maxDynamicStorageBuffersPerPipelineLayout, "maxDynamicStorageBuffersPerPipelineLayout" },
+            { &SupportedLimits::maxSampledTexturesPerShaderStage, "maxSampledTexturesPerShaderStage" },
+            { &SupportedLimits::maxSamplersPerShaderStage, "maxSamplersPerShaderStage" },
+            { &SupportedLimits::maxStorageBuffersPerShaderStage, "maxStorageBuffersPerShaderStage" },
+            { &SupportedLimits::maxStorageTexturesPerShaderStage, "maxStorageTexturesPerShaderStage" },
+            { &SupportedLimits::maxUniformBuffersPerShaderStage, "maxUniformBuffersPerShaderStage" },
+            { &SupportedLimits::minUniformBufferOffsetAlignment, "minUniformBufferOffsetAlignment" },
+            { &SupportedLimits::minStorageBufferOffsetAlignment, "minStorageBufferOffsetAlignment" },
+            { &SupportedLimits::maxVertexBuffers, "maxVertexBuffers" },
+            { &SupportedLimits::maxVertexAttributes, "maxVertexAttributes" },
+            { &SupportedLimits::maxVertexBufferArrayStride, "maxVertexBufferArrayStride" },
+            { &SupportedLimits::maxInterStageShaderVariables, "maxInterStageShaderVariables" },
+            { &SupportedLimits::maxColorAttachments, "maxColorAttachments" },
+            { &SupportedLimits::maxColorAttachmentBytesPerSample, "maxColorAttachmentBytesPerSample" },
+            { &SupportedLimits::maxComputeWorkgroupStorageSize, "maxComputeWorkgroupStorageSize" },
+            { &SupportedLimits::maxComputeInvocationsPerWorkgroup, "maxComputeInvocationsPerWorkgroup" },
+            { &SupportedLimits::maxComputeWorkgroupSizeX, "maxComputeWorkgroupSizeX" },
+            { &SupportedLimits::maxComputeWorkgroupSizeY, "maxComputeWorkgroupSizeY" },
+            { &SupportedLimits::maxComputeWorkgroupSizeZ, "maxComputeWorkgroupSizeZ" },
+            { &SupportedLimits::maxComputeWorkgroupsPerDimension, "maxComputeWorkgroupsPerDimension" }
+        };
+
+        const LimitField<unsigned long long> kLimit64Fields[] = {
+            { &SupportedLimits::maxUniformBufferBindingSize, "maxUniformBufferBindingSize" },
+            { &SupportedLimits::maxStorageBufferBindingSize, "maxStorageBufferBindingSize" },
+            { &SupportedLimits::maxBufferSize, "maxBufferSize" }
+        };
+
+        // min* limits are alignments, every other limit is a maximum
+        template <typename T>
+        bool meetsLimit(const LimitField<T>& field, const SupportedLimits& adapter, const SupportedLimits& required) {
+            T value = adapter.*field.member;
+            T requiredValue = required.*field.member;
+
+            if (requiredValue == 0) {
+                return true;
+            }
+
+            return std::strncmp(field.name, "min", 3) == 0 ? value <= requiredValue : value >= requiredValue;
+        }
+
+        Uint64 getLog2(Uint64 value) {
+            Uint64 log = 0;
+
+            while (value > 1) {
+                value >>= 1;
+                log++;
+            }
+
+            return log;
+        }
+
+        Uint64 getTypeRank(AdapterType type) {
+            switch (type) {
+                case AdapterType::eDiscreteGpu: return 3;
+                case AdapterType::eIntegratedGpu: return 2;
+                case AdapterType::eVirtualGpu: return 1;
+                default: return 0;
+            }
+        }
+    };
+
+    // ===========================================================================================================================
+    // Adapter Selection
+    // ===========================================================================================================================
+
+    bool isAdapterSuitable(const AdapterDescriptor& adapter, const SupportedFeatures& requiredFeatures,
+        const SupportedLimits& requiredLimits, std::string& error)
+    {
+        for (const FeatureField& field : kFeatureFields) {
+            if (requiredFeatures.*field.member && !(adapter.features.*field.member)) {
+                error = std::string("Adapter lacks feature ") + field.name;
+                return false;
+            }
+        }
+
+        for (const auto& field : kLimitFields) {
+            if (!meetsLimit(field, adapter.limits, requiredLimits)) {
+                error = std::string("Adapter does not meet limit ") + field.name;
+                return false;
+            }
+        }
+
+        for (const auto& field : kLimit64Fields) {
+            if (!meetsLimit(field, adapter.limits, requiredLimits)) {
+                error = std::string("Adapter does not meet limit ") + field.name;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    Uint64 scoreAdapter(const AdapterDescriptor& adapter) {
+        Uint64 featureCount = 0;
+
+        for (const FeatureField& field : kFeatureFields) {
+            featureCount += adapter.features.*field.member ? 1 : 0;
+        }
+
+        // Each log2 is below 64, the sum stays under the feature count bits
+        const SupportedLimits& limits = adapter.limits;
+        Uint64 capacity = getLog2(limits.maxBufferSize) + getLog2(limits.maxStorageBufferBindingSize)
+            + getLog2(limits.maxComputeInvocationsPerWorkgroup) + getLog2(limits.maxComputeWorkgroupStorageSize)
+            + getLog2(limits.maxComputeWorkgroupsPerDimension) + getLog2(limits.maxTextureDimension2D);
+
+        return (getTypeRank(adapter.type) << 48) | (featureCount << 40) | capacity;
+    }
+
+    std::vector<RankedAdapter> rankAdapters(const std::vector<std::shared_ptr<Adapter>>& adapters,
+        const SupportedFeatures& requiredFeatures, const SupportedLimits& requiredLimits)
+    {
+        std::vector<RankedAdapter> ranked;
+        std::string error;
+
+        for (const auto& adapter : adapters) {
+            if (isAdapterSuitable(adapter->desc, requiredFeatures, requiredLimits, error)) {
+                ranked.push_back(RankedAdapter{ adapter, scoreAdapter(adapter->desc) });
+            }
+        }
+
+        std::stable_sort(ranked.begin(), ranked.end(), [](const RankedAdapter& a, const RankedAdapter& b) {
+            return a.score > b.score;
+        });
+
+        return ranked;
+    }
+
+    // ===========================================================================================================================
+    // Device Group
+    // ===========================================================================================================================
+
+    DeviceGroup::DeviceGroup(std::vector<Device*> devices, DeviceGroupDescriptor descriptor)
+        : devices{ std::move(devices) }, desc{ std::move(descriptor) }
+    {
+        this->desc.weights.resize(this->devices.size(), 1);
+        this->staging.resize(this->devices.size());
+    }
+
+    bool DeviceGroup::copyBuffer(Uint32 sourceDevice, Buffer* source, Uint64 sourceOffset, Uint32 destinationDevice,
+        Buffer* destination, Uint64 destinationOffset, Uint64 size, std::string& error)
+    {
+        if (sourceDevice >= this->devices.size() || destinationDevice >= this->devices.size()) {
+            error = "Device index out of range";
+            return false;
+        }
+
+        if (sourceOffset > source->desc.size || size > source->desc.size - sourceOffset
+            || destinationOffset > destination->desc.size || size > destination->desc.size - destinationOffset)
+        {
+            error = "Copy range exceeds the buffer size";
+            return false;
+        }
+
+        if (!(destination->desc.usage & static_cast<BufferUsageFlags>(BufferUsage::eCopyDst))) {
+            error = "Destination buffer lacks eCopyDst usage";
+            return false;
+        }
+
+        Queue* destinationQueue = this->devices[destinationDevice]->getQueue();
+
+        // Host buffers are read in place
+        if (source->desc.location == BufferLocation::eHost) {
+            const void* data = source->map(size, sourceOffset);
+            destinationQueue->writeBuffer(destination, destinationOffset, data, size);
+            source->unmap();
+
+            destinationQueue->waitIdle();
+            return true;
+        }
+
+        if (!(source->desc.usage & static_cast<BufferUsageFlags>(BufferUsage::eCopySrc))) {
+            error = "Source buffer lacks eCopySrc usage";
+            return false;
+        }
+
+        Device* device = this->devices[sourceDevice];
+        std::shared_ptr<Buffer>& staging = this->staging[sourceDevice];
+
+        if (staging == nullptr) {
+            staging = device->createBuffer(BufferDescriptor{ this->desc.stagingSize,
+                static_cast<BufferUsageFlags>(BufferUsage::eCopyDst), BufferLocation::eHost });
+
+            if (staging == nullptr) {
+                error = "Failed to create the staging buffer";
+                return false;
+            }
+        }
+
+        for (Uint64 offset = 0; offset < size; offset += this->desc.stagingSize) {
+            Uint64 chunkSize = std::min(this->desc.stagingSize, size - offset);
+
+            // Waiting for the queue does not make the copy visible to host reads, the barrier does
+            BufferBarrier barrier;
+            barrier.srcAccess = ResourceAccess::eWriteOnly;
+            barrier.dstAccess = ResourceAccess::eReadOnly;
+            barrier.buffer = staging.get();
+            barrier.size = chunkSize;
+
+            auto encoder = device->createCommandEncoder();
+            if (encoder == nullptr) {
+                error = "Failed to create a command encoder on the source device";
+                return false;
+            }
+
+            encoder->copyBufferToBuffer(source, sourceOffset + offset, staging.get(), 0, chunkSize);
+            encoder->activateBufferBarrier(ShaderStage::eTransfer, ShaderStage::eHost, barrier);
+            encoder->finish();
+
+            device->getQueue()->submit({ encoder.get() });
+            device->getQueue()->waitIdle();
+
+            const void* data = staging->map(chunkSize, 0);
+            staging->invalidate(chunkSize, 0);
+
+            // The staging buffer is reused by the next chunk, so the write must land first
+            destinationQueue->writeBuffer(destination, destinationOffset + offset, data, chunkSize);
+            destinationQueue->waitIdle();
+
+            staging->unmap();
+        }
+
+        return true;
+    }
+
+    std::vector<DispatchRange> DeviceGroup::splitDispatch(Uint32 workgroupCountX, Uint32 workgroupCountY,
+        Uint32 workgroupCountZ) const
+    {
+        Uint32 counts[3] = { workgroupCountX, workgroupCountY, workgroupCountZ };
+        Uint32 axis = static_cast<Uint32>(std::max_element(counts, counts + 3) - counts);
+
+        Uint64 totalWeight = 0;
+        for (Uint32 weight : this->desc.weights) {
+            totalWeight += weight;
+        }
+
+        std::vector<DispatchRange> ranges;
+        if (totalWeight == 0) {
+            return ranges;
+        }
+
+        // Cumulative rounding, so the ranges always cover the whole axis
+        Uint64 weightSoFar = 0;
+        Uint32 base = 0;
+
+        for (Uint32 i = 0; i < this->devices.size(); i++) {
+            weightSoFar += this->desc.weights[i];
+            Uint32 end = static_cast<Uint32>(counts[axis] * weightSoFar / totalWeight);
+
+            if (end > base) {
+                DispatchRange range{ i, { 0, 0, 0 }, { counts[0], counts[1], counts[2] } };
+                range.baseWorkgroup[axis] = base;
+                range.workgroupCount[axis] = end - base;
+
+                ranges.push_back(range);
+            }
+
+            base = end;
+        }
+
+        return ranges;
+    }
+
+    std::vector<FrameTile> DeviceGroup::splitTiles(Uint32 width, Uint32 height, Uint32 tileSize) const {
+        std::vector<FrameTile> tiles;
+
+        Uint64 totalWeight = 0;
+        for (Uint32 weight : this->desc.weights) {
+            totalWeight += weight;
+        }
+
+        if (totalWeight == 0 || tileSize == 0) {
+            return tiles;
+        }
+
+        // Smooth weighted round robin: every tile goes to the device furthest behind its share
+        std::vector<Int64> credit(this->devices.size(), 0);
+
+        for (Uint32 y = 0; y < height; y += tileSize) {
+            for (Uint32 x = 0; x < width; x += tileSize) {
+                Uint32 best = 0;
+
+                for (Uint32 i = 0; i < this->devices.size(); i++) {
+                    credit[i] += this->desc.weights[i];
+
+                    if (credit[i] > credit[best]) {
+                        best = i;
+                    }
+                }
+
+                credit[best] -= static_cast<Int64>(totalWeight);
+                tiles.push_back(FrameTile{ best, x, y, std::min(tileSize, width - x), std::min(tileSize, height - y) });
+            }
+        }
+
+        return tiles;
+    }
+
+    void dispatchRange(ComputePassEncoder* pass, const DispatchRange& range, Uint32 pushConstantOffset) {
+        // Uint32 is wider than the shader's uint on LP64 targets
+        const uint32_t baseWorkgroup[3] = { static_cast<uint32_t>(range.baseWorkgroup[0]),
+            static_cast<uint32_t>(range.baseWorkgroup[1]), static_cast<uint32_t>(range.baseWorkgroup[2]) };
+
+        pass->setPushConstants(static_cast<ShaderStageFlags>(ShaderStage::eCompute), pushConstantOffset,
+            sizeof(baseWorkgroup), baseWorkgroup);
+        pass->dispatchWorkgroups(range.workgroupCount[0], range.workgroupCount[1], range.workgroupCount[2]);
+    }
+};
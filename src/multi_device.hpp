@@ -0,0 +1,88 @@
+#pragma once
+
+#include "rhi.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Adapter Selection
+    // ===========================================================================================================================
+
+    // Checks the adapter has every required feature and meets every non zero required limit,
+    // maximums at least as large and alignments at most as large
+    bool isAdapterSuitable(const AdapterDescriptor& adapter, const SupportedFeatures& requiredFeatures,
+        const SupportedLimits& requiredLimits, std::string& error);
+
+    // Higher is better: the adapter type first, then the feature count, then the compute and
+    // memory limits
+    Uint64 scoreAdapter(const AdapterDescriptor& adapter);
+
+    struct RankedAdapter {
+        std::shared_ptr<Adapter> adapter;
+        Uint64 score;
+    };
+
+    // Suitable adapters, best first. Adapters with equal scores keep the enumeration order.
+    std::vector<RankedAdapter> rankAdapters(const std::vector<std::shared_ptr<Adapter>>& adapters,
+        const SupportedFeatures& requiredFeatures = {}, const SupportedLimits& requiredLimits = {});
+
+    // ===========================================================================================================================
+    // Device Group
+    // ===========================================================================================================================
+
+    // Workgroups [baseWorkgroup, baseWorkgroup + workgroupCount) of a dispatch
+    struct DispatchRange {
+        Uint32 deviceIndex;
+        Uint32 baseWorkgroup[3];
+        Uint32 workgroupCount[3];
+    };
+
+    struct FrameTile {
+        Uint32 deviceIndex;
+        Uint32 x;
+        Uint32 y;
+        Uint32 width;
+        Uint32 height;
+    };
+
+    struct DeviceGroupDescriptor {
+        // Relative throughput of each device, empty splits evenly
+        std::vector<Uint32> weights;
+
+        // Host buffer per source device, larger copies go through it in chunks
+        Uint64 stagingSize = 4ull << 20;
+    };
+
+    // Devices used side by side, with nothing shared between them. Work is split explicitly:
+    // each device records its own share and data moves between them through host memory.
+    class DeviceGroup {
+    public:
+        DeviceGroup(std::vector<Device*> devices, DeviceGroupDescriptor descriptor = {});
+
+        Uint32 getDeviceCount() const { return static_cast<Uint32>(this->devices.size()); }
+        Device* getDevice(Uint32 index) const { return this->devices[index]; }
+
+        // Reads the source back to a host buffer and writes it through the destination's queue.
+        // Blocks until both queues are idle, the source must not be written by pending work.
+        bool copyBuffer(Uint32 sourceDevice, Buffer* source, Uint64 sourceOffset, Uint32 destinationDevice,
+            Buffer* destination, Uint64 destinationOffset, Uint64 size, std::string& error);
+
+        // Cuts the largest dimension into one contiguous range per device, sized by weight.
+        // Devices whose share rounds to nothing get no range.
+        std::vector<DispatchRange> splitDispatch(Uint32 workgroupCountX, Uint32 workgroupCountY = 1,
+            Uint32 workgroupCountZ = 1) const;
+
+        // Cuts the frame into tileSize squares, row by row, and deals them out interleaved in
+        // proportion to the weights, so every device gets a spread of the screen
+        std::vector<FrameTile> splitTiles(Uint32 width, Uint32 height, Uint32 tileSize) const;
+
+    private:
+        std::vector<Device*> devices;
+        DeviceGroupDescriptor desc;
+
+        std::vector<std::shared_ptr<Buffer>> staging;
+    };
+
+    // Dispatches the range on a pass of its device. The base workgroup goes to three Uint32
+    // push constants at pushConstantOffset, for the shader to add to its workgroup id.
+    void dispatchRange(ComputePassEncoder* pass, const DispatchRange& range, Uint32 pushConstantOffset = 0);
+};
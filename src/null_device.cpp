@@ -0,0 +1,682 @@
+#include "null_device.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Resources
+    // ===========================================================================================================================
+
+    NullBuffer::NullBuffer(BufferDescriptor descriptor) : storage(descriptor.size) {
+        this->desc = descriptor;
+        this->mapState = BufferMapState::eUnmapped;
+        this->currentMapping = ActiveBufferMapping{ nullptr, 0, 0 };
+    }
+
+    void* NullBuffer::map(Uint64 size, Uint64 offset) {
+        // ULLONG_MAX maps the rest of the buffer, any other range has to fit
+        if (offset > this->desc.size || (size != ULLONG_MAX && size > this->desc.size - offset)) {
+            return nullptr;
+        }
+
+        size = std::min(size, this->desc.size - offset);
+
+        this->currentMapping = ActiveBufferMapping{ this->storage.data() + offset, size, offset };
+        this->mapState = BufferMapState::eMapped;
+
+        return this->currentMapping.data;
+    }
+
+    void NullBuffer::unmap() {
+        this->currentMapping = ActiveBufferMapping{ nullptr, 0, 0 };
+        this->mapState = BufferMapState::eUnmapped;
+    }
+
+    NullTexture::NullTexture(TextureDescriptor descriptor) : storage{ descriptor } {
+        this->desc = descriptor;
+        this->state = TextureState::eUndefined;
+    }
+
+    std::shared_ptr<TextureView> NullTexture::createView(TextureViewDescriptor descriptor) {
+        auto view = std::make_shared<NullTextureView>();
+        view->desc = descriptor;
+        view->texture = this;
+
+        return view;
+    }
+
+    // ===========================================================================================================================
+    // Pass Encoders
+    // ===========================================================================================================================
+
+    NullComputePassEncoder::NullComputePassEncoder(NullCommandEncoder* encoder, ComputePassDescriptor descriptor) : encoder{ encoder } {
+        this->desc = descriptor;
+        this->commandEncoder = encoder;
+        this->state = CommandState::Open;
+    }
+
+    void NullComputePassEncoder::setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets) {
+        this->setBindGroup(index, bindGroup, dynamicOffsets.data(), 0, static_cast<Uint32>(dynamicOffsets.size()));
+    }
+
+    void NullComputePassEncoder::setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
+        Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength)
+    {
+        this->encoder->recordInline(NullCommandType::eSetBindGroup, index, dynamicOffsetsData + dynamicOffsetsDataStart,
+            dynamicOffsetsDataLength * sizeof(Uint32), dynamicOffsetsDataLength, bindGroup);
+    }
+
+    void NullComputePassEncoder::setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) {
+        this->encoder->recordInline(NullCommandType::eSetPushConstants, static_cast<Uint32>(visibility), data, size, offset);
+    }
+
+    void NullComputePassEncoder::setPipeline(ComputePipeline* pipeline) {
+        this->encoder->record(NullCommandType::eSetPipeline, 0, pipeline);
+    }
+
+    void NullComputePassEncoder::dispatchWorkgroups(Uint32 workgroupCountX, Uint32 workgroupCountY, Uint32 workgroupCountZ) {
+        this->encoder->record(NullCommandType::eDispatch, 0, nullptr, workgroupCountX, workgroupCountY, workgroupCountZ);
+    }
+
+    void NullComputePassEncoder::dispatchWorkgroupsIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) {
+        this->encoder->record(NullCommandType::eDispatchIndirect, 0, indirectBuffer, indirectOffset);
+    }
+
+    void NullComputePassEncoder::end() {
+        this->encoder->record(NullCommandType::eEndPass);
+        this->encoder->state = CommandState::Open;
+        this->state = CommandState::Ended;
+    }
+
+    NullRenderPassEncoder::NullRenderPassEncoder(NullCommandEncoder* encoder, RenderPassDescriptor descriptor) : encoder{ encoder } {
+        this->desc = descriptor;
+        this->commandEncoder = encoder;
+        this->state = CommandState::Open;
+    }
+
+    void NullRenderPassEncoder::setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets) {
+        this->setBindGroup(index, bindGroup, dynamicOffsets.data(), 0, static_cast<Uint32>(dynamicOffsets.size()));
+    }
+
+    void NullRenderPassEncoder::setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
+        Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength)
+    {
+        this->encoder->recordInline(NullCommandType::eSetBindGroup, index, dynamicOffsetsData + dynamicOffsetsDataStart,
+            dynamicOffsetsDataLength * sizeof(Uint32), dynamicOffsetsDataLength, bindGroup);
+    }
+
+    void NullRenderPassEncoder::setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) {
+        this->encoder->recordInline(NullCommandType::eSetPushConstants, static_cast<Uint32>(visibility), data, size, offset);
+    }
+
+    void NullRenderPassEncoder::setPipeline(RenderPipeline* pipeline) {
+        this->encoder->record(NullCommandType::eSetPipeline, 0, pipeline);
+    }
+
+    void NullRenderPassEncoder::setIndexBuffer(Buffer* buffer, IndexFormat indexFormat, Uint64 offset, Uint64 size) {
+        this->encoder->record(NullCommandType::eSetIndexBuffer, static_cast<Uint32>(indexFormat), buffer, offset, size);
+    }
+
+    void NullRenderPassEncoder::setVertexBuffer(Uint32 slot, Buffer* buffer, Uint64 offset, Uint64 size) {
+        this->encoder->record(NullCommandType::eSetVertexBuffer, slot, buffer, offset, size);
+    }
+
+    void NullRenderPassEncoder::draw(Uint32 vertexCount, Uint32 instanceCount, Uint32 firstVertex, Uint32 firstInstance) {
+        this->encoder->record(NullCommandType::eDraw, vertexCount, nullptr, instanceCount, firstVertex, firstInstance);
+    }
+
+    void NullRenderPassEncoder::drawIndexed(Uint32 indexCount, Uint32 instanceCount, Uint32 firstIndex, Int32 baseVertex,
+        Uint32 firstInstance)
+    {
+        this->encoder->record(NullCommandType::eDrawIndexed, indexCount, nullptr,
+            (static_cast<Uint64>(instanceCount) << 32) | firstIndex, static_cast<Uint64>(static_cast<int64_t>(baseVertex)), firstInstance);
+    }
+
+    void NullRenderPassEncoder::drawIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) {
+        this->encoder->record(NullCommandType::eDrawIndirect, 0, indirectBuffer, indirectOffset);
+    }
+
+    void NullRenderPassEncoder::drawIndexedIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) {
+        this->encoder->record(NullCommandType::eDrawIndirect, 1, indirectBuffer, indirectOffset);
+    }
+
+    void NullRenderPassEncoder::setViewport(float x, float y, float width, float height, float minDepth, float maxDepth) {
+        Uint64 values[3];
+        float viewport[6] = { x, y, width, height, minDepth, maxDepth };
+        std::memcpy(values, viewport, sizeof(viewport));
+
+        this->encoder->record(NullCommandType::eSetViewport, 0, nullptr, values[0], values[1], values[2]);
+    }
+
+    void NullRenderPassEncoder::setScissorRect(Uint32 x, Uint32 y, Uint32 width, Uint32 height) {
+        this->encoder->record(NullCommandType::eSetScissorRect, 0, nullptr,
+            (static_cast<Uint64>(x) << 32) | y, (static_cast<Uint64>(width) << 32) | height);
+    }
+
+    void NullRenderPassEncoder::setBlendConstant(Color color) {
+        Uint64 values[2];
+        std::memcpy(values, &color, sizeof(color));
+
+        this->encoder->record(NullCommandType::eSetBlendConstant, 0, nullptr, values[0], values[1]);
+    }
+
+    void NullRenderPassEncoder::setStencilReference(Uint32 reference) {
+        this->encoder->record(NullCommandType::eSetStencilReference, reference);
+    }
+
+    void NullRenderPassEncoder::beginOcclusionQuery(Uint32 queryIndex) {
+        this->encoder->record(NullCommandType::eQuery, queryIndex, nullptr, 1);
+    }
+
+    void NullRenderPassEncoder::endOcclusionQuery() {
+        this->encoder->record(NullCommandType::eQuery, 0, nullptr, 0);
+    }
+
+    void NullRenderPassEncoder::end() {
+        this->encoder->record(NullCommandType::eEndPass);
+        this->encoder->state = CommandState::Open;
+        this->state = CommandState::Ended;
+    }
+
+    // ===========================================================================================================================
+    // Command Encoder
+    // ===========================================================================================================================
+
+    NullCommandEncoder::NullCommandEncoder(bool computeOnly, TaskPool* computePool) : computeOnly{ computeOnly }, computePool{ computePool } {
+        this->state = CommandState::Open;
+    }
+
+    std::shared_ptr<RenderPassEncoder> NullCommandEncoder::beginRenderPass(RenderPassDescriptor descriptor) {
+        if (this->computeOnly) {
+            return nullptr;
+        }
+
+        this->record(NullCommandType::eBeginPass, 0);
+        this->state = CommandState::Locked;
+
+        this->renderPass.desc = descriptor;
+        this->renderPass.state = CommandState::Open;
+
+        // Non owning, the pass lives inside the encoder
+        return std::shared_ptr<RenderPassEncoder>(std::shared_ptr<RenderPassEncoder>{}, &this->renderPass);
+    }
+
+    std::shared_ptr<ComputePassEncoder> NullCommandEncoder::beginComputePass(ComputePassDescriptor descriptor) {
+        this->record(NullCommandType::eBeginPass, 1);
+        this->state = CommandState::Locked;
+
+        this->computePass.desc = descriptor;
+        this->computePass.state = CommandState::Open;
+
+        return std::shared_ptr<ComputePassEncoder>(std::shared_ptr<ComputePassEncoder>{}, &this->computePass);
+    }
+
+    void NullCommandEncoder::copyBufferToBuffer(Buffer* source, Uint64 sourceOffset, Buffer* destination, Uint64 destinationOffset,
+        Uint64 size)
+    {
+        this->record(NullCommandType::eCopy, 0, destination, sourceOffset, destinationOffset, size);
+        this->transfers.push_back(Transfer{ static_cast<NullBuffer*>(source), sourceOffset,
+            static_cast<NullBuffer*>(destination), destinationOffset, size, kNoTextureCopy });
+    }
+
+    void NullCommandEncoder::copyBufferToTexture(ImageCopyBuffer source, ImageCopyTexture destination, Extent3D copySize) {
+        this->record(NullCommandType::eCopy, 1, destination.texture, source.offset);
+
+        this->transfers.push_back(Transfer{ static_cast<NullBuffer*>(source.buffer), source.offset, nullptr, 0, 0,
+            static_cast<Uint32>(this->textureCopies.size()) });
+        this->textureCopies.push_back(TextureCopy{ source, ImageCopyTexture{ nullptr }, destination, copySize });
+    }
+
+    void NullCommandEncoder::copyTextureToBuffer(ImageCopyTexture source, ImageCopyBuffer destination, Extent3D copySize) {
+        this->record(NullCommandType::eCopy, 2, source.texture, destination.offset);
+
+        this->transfers.push_back(Transfer{ nullptr, 0, static_cast<NullBuffer*>(destination.buffer), destination.offset, 0,
+            static_cast<Uint32>(this->textureCopies.size()) });
+        this->textureCopies.push_back(TextureCopy{ destination, source, ImageCopyTexture{ nullptr }, copySize });
+    }
+
+    void NullCommandEncoder::copyTextureToTexture(ImageCopyTexture source, ImageCopyTexture destination, Extent3D copySize) {
+        this->record(NullCommandType::eCopy, 3, destination.texture);
+
+        this->transfers.push_back(Transfer{ nullptr, 0, nullptr, 0, 0, static_cast<Uint32>(this->textureCopies.size()) });
+        this->textureCopies.push_back(TextureCopy{ ImageCopyBuffer{}, source, destination, copySize });
+    }
+
+    void NullCommandEncoder::clearBuffer(Buffer* buffer, Uint64 offset, Uint64 size) {
+        size = std::min(size, buffer->desc.size - offset);
+
+        // A transfer without source clears its destination
+        this->record(NullCommandType::eCopy, 4, buffer, offset, size);
+        this->transfers.push_back(Transfer{ nullptr, 0, static_cast<NullBuffer*>(buffer), offset, size, kNoTextureCopy });
+    }
+
+    void NullCommandEncoder::resolveQuerySet(QuerySet, Uint32 firstQuery, Uint32 queryCount, Buffer* destination,
+        Uint64 destinationOffset)
+    {
+        this->record(NullCommandType::eQuery, firstQuery, destination, queryCount, destinationOffset);
+    }
+
+    void NullCommandEncoder::activatePipelineBarrier(ShaderStage srcStage, ShaderStage dstStage) {
+        this->record(NullCommandType::eBarrier, 0, nullptr, static_cast<Uint64>(srcStage), static_cast<Uint64>(dstStage));
+    }
+
+    void NullCommandEncoder::activateBufferBarrier(ShaderStage srcStage, ShaderStage dstStage, BufferBarrier desc) {
+        this->record(NullCommandType::eBarrier, 1, desc.buffer, static_cast<Uint64>(srcStage), static_cast<Uint64>(dstStage));
+    }
+
+    void NullCommandEncoder::activateImageBarrier(ShaderStage srcStage, ShaderStage dstStage, ImageBarrier desc) {
+        this->record(NullCommandType::eBarrier, 2, desc.texture, static_cast<Uint64>(srcStage), static_cast<Uint64>(dstStage));
+    }
+
+    void NullCommandEncoder::activateBarriers(ShaderStage srcStage, ShaderStage dstStage, const std::vector<BufferBarrier>& bufferBarriers,
+        const std::vector<ImageBarrier>& imageBarriers)
+    {
+        this->record(NullCommandType::eBarrier, 3, nullptr, static_cast<Uint64>(srcStage), static_cast<Uint64>(dstStage),
+            bufferBarriers.size() + imageBarriers.size());
+    }
+
+    void NullCommandEncoder::finish() {
+        this->state = CommandState::Ended;
+    }
+
+    void NullCommandEncoder::reset() {
+        this->commands.clear();
+        this->inlineData.clear();
+        this->transfers.clear();
+        this->textureCopies.clear();
+
+        this->state = CommandState::Open;
+    }
+
+    void NullCommandEncoder::record(NullCommandType type, Uint32 index, const void* object, Uint64 value0, Uint64 value1, Uint64 value2) {
+        this->commands.push_back(NullCommand{ type, index, object, { value0, value1, value2 } });
+    }
+
+    void NullCommandEncoder::recordInline(NullCommandType type, Uint32 index, const void* data, Uint64 size, Uint64 value,
+        const void* object)
+    {
+        Uint64 dataOffset = this->inlineData.size();
+
+        if (size != 0) {
+            this->inlineData.resize(dataOffset + size);
+            std::memcpy(this->inlineData.data() + dataOffset, data, size);
+        }
+
+        this->commands.push_back(NullCommand{ type, index, object, { dataOffset, size, value } });
+    }
+
+    void NullCommandEncoder::execute() {
+        if (!this->computeOnly) {
+            for (const auto& transfer : this->transfers) {
+                this->executeTransfer(transfer);
+            }
+
+            return;
+        }
+
+        // Every transfer was recorded along with one copy command, which keeps them in order with the dispatches
+        Uint64 nextTransfer = 0;
+
+        const NullComputePipeline* pipeline = nullptr;
+        std::vector<BoundGroup> bindGroups;
+        std::vector<uint8_t> pushConstants;
+
+        for (const NullCommand& command : this->commands) {
+            switch (command.type) {
+                case NullCommandType::eCopy:
+                    this->executeTransfer(this->transfers[nextTransfer++]);
+                    break;
+
+                case NullCommandType::eSetPipeline:
+                    pipeline = static_cast<const NullComputePipeline*>(command.object);
+                    break;
+
+                case NullCommandType::eSetBindGroup:
+                    if (command.index >= bindGroups.size()) {
+                        bindGroups.resize(command.index + 1, BoundGroup{ nullptr, 0, 0 });
+                    }
+
+                    bindGroups[command.index] = BoundGroup{ static_cast<const BindGroup*>(command.object), command.values[0],
+                        static_cast<Uint32>(command.values[2]) };
+                    break;
+
+                case NullCommandType::eSetPushConstants: {
+                    Uint64 end = command.values[2] + command.values[1];
+                    if (end > pushConstants.size()) {
+                        pushConstants.resize(end);
+                    }
+
+                    std::memcpy(pushConstants.data() + command.values[2], this->inlineData.data() + command.values[0], command.values[1]);
+                    break;
+                }
+
+                case NullCommandType::eDispatch: {
+                    const uint32_t workgroupCount[3] = { static_cast<uint32_t>(command.values[0]),
+                        static_cast<uint32_t>(command.values[1]), static_cast<uint32_t>(command.values[2]) };
+
+                    this->executeDispatch(pipeline, bindGroups, pushConstants, workgroupCount);
+                    break;
+                }
+
+                case NullCommandType::eDispatchIndirect: {
+                    NullBuffer* indirectBuffer = static_cast<NullBuffer*>(const_cast<void*>(command.object));
+                    Uint64 indirectOffset = command.values[0];
+
+                    // A validation layer rejects arguments past the end of the buffer, the dispatch is dropped
+                    uint32_t workgroupCount[3];
+                    if (indirectOffset > indirectBuffer->desc.size || sizeof(workgroupCount) > indirectBuffer->desc.size - indirectOffset) {
+                        break;
+                    }
+
+                    std::memcpy(workgroupCount, indirectBuffer->getData() + indirectOffset, sizeof(workgroupCount));
+
+                    this->executeDispatch(pipeline, bindGroups, pushConstants, workgroupCount);
+                    break;
+                }
+
+                default:
+                    break;
+            }
+        }
+    }
+
+    void NullCommandEncoder::executeTransfer(const Transfer& transfer) {
+        if (transfer.textureCopy != kNoTextureCopy) {
+            const TextureCopy& copy = this->textureCopies[transfer.textureCopy];
+
+            if (copy.source.texture == nullptr) {
+                copyLinearToTiled(static_cast<NullTexture*>(copy.destination.texture)->getStorage(), copy.destination.mipLevel,
+                    copy.destination.origin, copy.size, transfer.source->getData(), copy.buffer);
+            } else if (copy.destination.texture == nullptr) {
+                copyTiledToLinear(static_cast<NullTexture*>(copy.source.texture)->getStorage(), copy.source.mipLevel,
+                    copy.source.origin, copy.size, transfer.destination->getData(), copy.buffer);
+            } else {
+                copyTiledToTiled(static_cast<NullTexture*>(copy.source.texture)->getStorage(), copy.source.mipLevel,
+                    copy.source.origin, static_cast<NullTexture*>(copy.destination.texture)->getStorage(),
+                    copy.destination.mipLevel, copy.destination.origin, copy.size);
+            }
+
+            return;
+        }
+
+        uint8_t* destination = transfer.destination->getData() + transfer.destinationOffset;
+
+        if (transfer.source == nullptr) {
+            std::memset(destination, 0, transfer.size);
+        } else {
+            std::memmove(destination, transfer.source->getData() + transfer.sourceOffset, transfer.size);
+        }
+    }
+
+    void NullCommandEncoder::executeDispatch(const NullComputePipeline* pipeline, const std::vector<BoundGroup>& bindGroups,
+        const std::vector<uint8_t>& pushConstants, const uint32_t workgroupCount[3])
+    {
+        if (pipeline == nullptr || pipeline->kernel == nullptr) {
+            return;
+        }
+
+        const ComputeKernel& kernel = *pipeline->kernel;
+
+        // Bindings left unbound get an empty range, their reads return zero as robust buffer access does
+        std::vector<ComputeBufferRange> buffers;
+        buffers.reserve(kernel.getBindings().size());
+
+        for (const ComputeKernelBinding& binding : kernel.getBindings()) {
+            ComputeBufferRange range{};
+            const BindGroup* bindGroup = binding.group < bindGroups.size() ? bindGroups[binding.group].bindGroup : nullptr;
+
+            if (bindGroup != nullptr) {
+                auto entry = std::find_if(bindGroup->desc.entries.begin(), bindGroup->desc.entries.end(),
+                    [&binding](const BindGroupEntry& other) {
+                        return other.binding == binding.binding && other.arrayElement == 0;
+                    });
+
+                if (entry != bindGroup->desc.entries.end() && entry->buffer.buffer != nullptr) {
+                    Uint64 offset = entry->buffer.offset;
+
+                    // Dynamic offsets come in binding order of the layout entries that take one
+                    if (bindGroup->desc.layout != nullptr) {
+                        const BoundGroup& bound = bindGroups[binding.group];
+                        bool dynamic = false;
+                        Uint32 dynamicIndex = 0;
+
+                        for (const auto& layoutEntry : bindGroup->desc.layout->desc.entries) {
+                            if (layoutEntry.type == BindingType::eBuffer && layoutEntry.buffer.hasDynamicOffset) {
+                                dynamic = dynamic || layoutEntry.binding == binding.binding;
+                                dynamicIndex += layoutEntry.binding < binding.binding ? 1 : 0;
+                            }
+                        }
+
+                        if (dynamic && dynamicIndex < bound.dynamicOffsetCount) {
+                            Uint32 dynamicOffset;
+                            std::memcpy(&dynamicOffset, this->inlineData.data() + bound.dynamicOffsets + dynamicIndex * sizeof(Uint32),
+                                sizeof(Uint32));
+
+                            offset += dynamicOffset;
+                        }
+                    }
+
+                    NullBuffer* buffer = static_cast<NullBuffer*>(entry->buffer.buffer);
+                    if (offset < buffer->desc.size) {
+                        range = ComputeBufferRange{ buffer->getData() + offset, std::min(entry->buffer.size, buffer->desc.size - offset) };
+                    }
+                }
+            }
+
+            buffers.push_back(range);
+        }
+
+        ComputeResources resources{ buffers.data(), pushConstants.data(), static_cast<Uint32>(pushConstants.size()) };
+
+        if (this->computePool != nullptr) {
+            kernel.dispatch(*this->computePool, resources, workgroupCount[0], workgroupCount[1], workgroupCount[2]);
+        } else {
+            kernel.dispatch(resources, workgroupCount[0], workgroupCount[1], workgroupCount[2]);
+        }
+    }
+
+    // ===========================================================================================================================
+    // Queue
+    // ===========================================================================================================================
+
+    void NullQueue::submit(const std::vector<CommandEncoder*>& commandEncoders) {
+        for (CommandEncoder* encoder : commandEncoders) {
+            static_cast<NullCommandEncoder*>(encoder)->execute();
+        }
+    }
+
+    void NullQueue::writeBuffer(Buffer* buffer, Uint64 bufferOffset, const void* data, Uint64 size) {
+        // Writes past the end are dropped like the indirect dispatches above
+        if (bufferOffset > buffer->desc.size || size > buffer->desc.size - bufferOffset) {
+            return;
+        }
+
+        std::memcpy(static_cast<NullBuffer*>(buffer)->getData() + bufferOffset, data, size);
+    }
+
+    void NullQueue::writeTexture(ImageCopyTexture destination, const void* data, Uint64, ImageDataLayout dataLayout,
+        Extent3D writeSize)
+    {
+        copyLinearToTiled(static_cast<NullTexture*>(destination.texture)->getStorage(), destination.mipLevel,
+            destination.origin, writeSize, data, dataLayout);
+    }
+
+    // ===========================================================================================================================
+    // Device
+    // ===========================================================================================================================
+
+    NullDevice::NullDevice() {
+        AdapterDescriptor adapter = getNullAdapterDescriptor();
+        this->desc = DeviceDescriptor{ adapter.features, adapter.limits, adapter.info, DeviceMode::eGraphics };
+    }
+
+    NullDevice::NullDevice(DeviceDescriptor descriptor) {
+        this->desc = descriptor;
+    }
+
+    std::shared_ptr<Buffer> NullDevice::createBuffer(BufferDescriptor descriptor) {
+        return std::make_shared<NullBuffer>(descriptor);
+    }
+
+    std::shared_ptr<Texture> NullDevice::createTexture(TextureDescriptor descriptor) {
+        if (this->desc.mode == DeviceMode::eComputeOnly) {
+            return nullptr;
+        }
+
+        return std::make_shared<NullTexture>(descriptor);
+    }
+
+    std::shared_ptr<Sampler> NullDevice::createSampler(SamplerDescriptor descriptor) {
+        if (this->desc.mode == DeviceMode::eComputeOnly) {
+            return nullptr;
+        }
+
+        auto sampler = std::make_shared<Sampler>();
+        sampler->desc = descriptor;
+        sampler->isComparison = descriptor.compare != CompareFunction::eNever;
+        sampler->isFiltering = descriptor.magFilter == FilterMode::eLinear || descriptor.minFilter == FilterMode::eLinear
+            || descriptor.mipmapFilter == MipmapFilterMode::eLinear;
+
+        return sampler;
+    }
+
+    std::shared_ptr<BindGroup> NullDevice::createBindGroup(BindGroupDescriptor descriptor) {
+        auto bindGroup = std::make_shared<BindGroup>();
+        bindGroup->desc = descriptor;
+
+        return bindGroup;
+    }
+
+    void NullDevice::updateBindGroup(BindGroup* bindGroup, const std::vector<BindGroupEntry>& entries) {
+        for (const auto& entry : entries) {
+            auto existing = std::find_if(bindGroup->desc.entries.begin(), bindGroup->desc.entries.end(),
+                [&entry](const BindGroupEntry& other) {
+                    return other.binding == entry.binding && other.arrayElement == entry.arrayElement;
+                });
+
+            if (existing != bindGroup->desc.entries.end()) {
+                *existing = entry;
+            } else {
+                bindGroup->desc.entries.push_back(entry);
+            }
+        }
+    }
+
+    std::shared_ptr<BindGroupLayout> NullDevice::createBindGroupLayout(BindGroupLayoutDescriptor descriptor) {
+        auto layout = std::make_shared<BindGroupLayout>();
+        layout->desc = descriptor;
+
+        return layout;
+    }
+
+    std::shared_ptr<PipelineLayout> NullDevice::createPipelineLayout(PipelineLayoutDescriptor descriptor) {
+        auto layout = std::make_shared<PipelineLayout>();
+        layout->desc = descriptor;
+
+        return layout;
+    }
+
+    std::shared_ptr<ShaderModule> NullDevice::createShaderModule(ShaderModuleDescriptor descriptor) {
+        auto module = std::make_shared<NullShaderModule>();
+        module->desc = descriptor;
+
+        return module;
+    }
+
+    std::shared_ptr<ComputePipeline> NullDevice::createComputePipeline(ComputePipelineDescriptor descriptor) {
+        auto pipeline = std::make_shared<NullComputePipeline>();
+        pipeline->desc = descriptor;
+        pipeline->layout = descriptor.layout;
+
+        // A stage that does not translate still makes a pipeline, its dispatches are dropped
+        if (this->desc.mode == DeviceMode::eComputeOnly && descriptor.compute.module != nullptr) {
+            pipeline->kernel = this->kernels.get(descriptor.compute, pipeline->kernelError);
+        }
+
+        return pipeline;
+    }
+
+    std::shared_ptr<RenderPipeline> NullDevice::createRenderPipeline(RenderPipelineDescriptor descriptor) {
+        if (this->desc.mode == DeviceMode::eComputeOnly) {
+            return nullptr;
+        }
+
+        auto pipeline = std::make_shared<RenderPipeline>();
+        pipeline->desc = descriptor;
+        pipeline->layout = descriptor.layout;
+        pipeline->writesDepth = descriptor.depthStencil.depthWriteEnabled;
+        pipeline->writesStencil = false;
+
+        return pipeline;
+    }
+
+    std::shared_ptr<CommandEncoder> NullDevice::createCommandEncoder() {
+        return std::make_shared<NullCommandEncoder>(this->desc.mode == DeviceMode::eComputeOnly, this->computePool);
+    }
+
+    // ===========================================================================================================================
+    // Adapter
+    // ===========================================================================================================================
+
+    AdapterDescriptor getNullAdapterDescriptor() {
+        AdapterDescriptor descriptor{};
+        descriptor.type = AdapterType::eCpu;
+        descriptor.info = DeviceInfo{ "null", "host", "Null Device" };
+
+        descriptor.features = SupportedFeatures{
+            true, true, true, true, true, true, true, true, true, true, true, true, true, true, true, true
+        };
+
+        SupportedLimits& limits = descriptor.limits;
+        limits.maxTextureDimension1D = 16384;
+        limits.maxTextureDimension2D = 16384;
+        limits.maxTextureDimension3D = 2048;
+        limits.maxTextureArrayLayers = 2048;
+        limits.maxBindGroups = 8;
+        limits.maxBindGroupsPlusVertexBuffers = 24;
+        limits.maxBindingsPerBindGroup = 65535;
+        limits.maxPushConstantsSize = 256;
+        limits.maxDynamicUniformBuffersPerPipelineLayout = 16;
+        limits.maxDynamicStorageBuffersPerPipelineLayout = 8;
+        limits.maxSampledTexturesPerShaderStage = 1048576;
+        limits.maxSamplersPerShaderStage = 4096;
+        limits.maxStorageBuffersPerShaderStage = 1048576;
+        limits.maxStorageTexturesPerShaderStage = 1048576;
+        limits.maxUniformBuffersPerShaderStage = 1048576;
+        limits.maxUniformBufferBindingSize = 65536;
+        limits.maxStorageBufferBindingSize = 1ull << 32;
+        limits.minUniformBufferOffsetAlignment = 256;
+        limits.minStorageBufferOffsetAlignment = 256;
+        limits.maxVertexBuffers = 16;
+        limits.maxBufferSize = 1ull << 32;
+        limits.maxVertexAttributes = 32;
+        limits.maxVertexBufferArrayStride = 2048;
+        limits.maxInterStageShaderVariables = 32;
+        limits.maxColorAttachments = 8;
+        limits.maxColorAttachmentBytesPerSample = 64;
+        limits.maxComputeWorkgroupStorageSize = 32768;
+        limits.maxComputeInvocationsPerWorkgroup = 1024;
+        limits.maxComputeWorkgroupSizeX = 1024;
+        limits.maxComputeWorkgroupSizeY = 1024;
+        limits.maxComputeWorkgroupSizeZ = 64;
+        limits.maxComputeWorkgroupsPerDimension = 65535;
+
+        return descriptor;
+    }
+
+    std::shared_ptr<Device> NullAdapter::requestDevice(DeviceMode mode) {
+        return std::make_shared<NullDevice>(DeviceDescriptor{ this->desc.features, this->desc.limits, this->desc.info, mode });
+    }
+
+    std::vector<std::shared_ptr<Adapter>> NullInstance::enumerateAdapters() {
+        std::vector<std::shared_ptr<Adapter>> adapters;
+        adapters.reserve(this->adapters.size());
+
+        for (const AdapterDescriptor& descriptor : this->adapters) {
+            adapters.push_back(std::make_shared<NullAdapter>(descriptor));
+        }
+
+        return adapters;
+    }
+};
@@ -0,0 +1,293 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "compute_kernel.hpp"
+#include "tiled_texture.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Null Backend
+    // ===========================================================================================================================
+
+    // Host only implementation of the RHI. Buffers and textures live in system memory, textures
+    // in tiled storage. Copies, clears and queue writes really execute at submit, everything else
+    // is recorded into a compact command stream and dropped. It measures the cost of the RHI
+    // itself and runs tools on machines without a GPU. Compute only devices also translate their
+    // compute pipelines with ComputeKernel and run the dispatches at submit, so compute work runs
+    // on GPU-less nodes.
+
+    enum class NullCommandType : Uint8 {
+        eSetPipeline,
+        eSetBindGroup,
+        eSetPushConstants,
+        eSetVertexBuffer,
+        eSetIndexBuffer,
+        eSetViewport,
+        eSetScissorRect,
+        eSetBlendConstant,
+        eSetStencilReference,
+        eDraw,
+        eDrawIndexed,
+        eDrawIndirect,
+        eDispatch,
+        eDispatchIndirect,
+        eBarrier,
+        eCopy,
+        eBeginPass,
+        eEndPass,
+        eQuery
+    };
+
+    struct NullCommand {
+        NullCommandType type;
+        Uint32 index;
+        const void* object;
+        Uint64 values[3];
+    };
+
+    class NullBuffer : public Buffer {
+    public:
+        NullBuffer(BufferDescriptor descriptor);
+
+        void* map(Uint64 size = ULLONG_MAX, Uint64 offset = 0) override;
+        void unmap() override;
+
+        void flush(Uint64 = ULLONG_MAX, Uint64 = 0) override {}
+        void invalidate(Uint64 = ULLONG_MAX, Uint64 = 0) override {}
+
+        uint8_t* getData() { return this->storage.data(); }
+
+    private:
+        std::vector<uint8_t> storage;
+    };
+
+    class NullTextureView : public TextureView {};
+
+    class NullTexture : public Texture {
+    public:
+        NullTexture(TextureDescriptor descriptor);
+
+        std::shared_ptr<TextureView> createView(TextureViewDescriptor descriptor) override;
+
+        // Every aspect of a texel is stored together, copies of one aspect move the whole texel
+        TiledTexture& getStorage() { return this->storage; }
+
+    private:
+        TiledTexture storage;
+    };
+
+    class NullShaderModule : public ShaderModule {
+    public:
+        CompilationInfo getCompilationInfo() override { return CompilationInfo{}; }
+    };
+
+    class NullComputePipeline : public ComputePipeline {
+    public:
+        // Null when the device is not compute only or the stage did not translate
+        std::shared_ptr<const ComputeKernel> kernel;
+        std::string kernelError;
+    };
+
+    class NullCommandEncoder;
+
+    class NullComputePassEncoder : public ComputePassEncoder {
+    public:
+        NullComputePassEncoder(NullCommandEncoder* encoder, ComputePassDescriptor descriptor);
+
+        void setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets = {}) override;
+        void setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
+            Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength) override;
+        void setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) override;
+
+        void setPipeline(ComputePipeline* pipeline) override;
+        void dispatchWorkgroups(Uint32 workgroupCountX, Uint32 workgroupCountY = 1, Uint32 workgroupCountZ = 1) override;
+        void dispatchWorkgroupsIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) override;
+
+        void end() override;
+
+    private:
+        NullCommandEncoder* encoder;
+    };
+
+    class NullRenderPassEncoder : public RenderPassEncoder {
+    public:
+        NullRenderPassEncoder(NullCommandEncoder* encoder, RenderPassDescriptor descriptor);
+
+        void setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets = {}) override;
+        void setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
+            Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength) override;
+        void setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) override;
+
+        void setPipeline(RenderPipeline* pipeline) override;
+        void setIndexBuffer(Buffer* buffer, IndexFormat indexFormat, Uint64 offset = 0, Uint64 size = ULLONG_MAX) override;
+        void setVertexBuffer(Uint32 slot, Buffer* buffer, Uint64 offset = 0, Uint64 size = ULLONG_MAX) override;
+
+        void draw(Uint32 vertexCount, Uint32 instanceCount = 1, Uint32 firstVertex = 0, Uint32 firstInstance = 0) override;
+        void drawIndexed(Uint32 indexCount, Uint32 instanceCount = 1, Uint32 firstIndex = 0, Int32 baseVertex = 0,
+            Uint32 firstInstance = 0) override;
+
+        void drawIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) override;
+        void drawIndexedIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) override;
+
+        void setViewport(float x, float y, float width, float height, float minDepth, float maxDepth) override;
+        void setScissorRect(Uint32 x, Uint32 y, Uint32 width, Uint32 height) override;
+        void setBlendConstant(Color color) override;
+        void setStencilReference(Uint32 reference) override;
+
+        void beginOcclusionQuery(Uint32 queryIndex) override;
+        void endOcclusionQuery() override;
+
+        void end() override;
+
+    private:
+        NullCommandEncoder* encoder;
+    };
+
+    class NullCommandEncoder : public CommandEncoder {
+    public:
+        // Compute only encoders run their dispatches at submit, on the pool when there is one
+        NullCommandEncoder(bool computeOnly = false, TaskPool* computePool = nullptr);
+
+        std::shared_ptr<RenderPassEncoder> beginRenderPass(RenderPassDescriptor descriptor) override;
+        std::shared_ptr<ComputePassEncoder> beginComputePass(ComputePassDescriptor descriptor) override;
+
+        void copyBufferToBuffer(Buffer* source, Uint64 sourceOffset, Buffer* destination, Uint64 destinationOffset,
+            Uint64 size) override;
+        void copyBufferToTexture(ImageCopyBuffer source, ImageCopyTexture destination, Extent3D copySize) override;
+        void copyTextureToBuffer(ImageCopyTexture source, ImageCopyBuffer destination, Extent3D copySize) override;
+        void copyTextureToTexture(ImageCopyTexture source, ImageCopyTexture destination, Extent3D copySize) override;
+        void clearBuffer(Buffer* buffer, Uint64 offset = 0, Uint64 size = ULLONG_MAX) override;
+        void resolveQuerySet(QuerySet querySet, Uint32 firstQuery, Uint32 queryCount, Buffer* destination,
+            Uint64 destinationOffset) override;
+
+        void activatePipelineBarrier(ShaderStage srcStage, ShaderStage dstStage) override;
+        void activateBufferBarrier(ShaderStage srcStage, ShaderStage dstStage, BufferBarrier desc) override;
+        void activateImageBarrier(ShaderStage srcStage, ShaderStage dstStage, ImageBarrier desc) override;
+        void activateBarriers(ShaderStage srcStage, ShaderStage dstStage, const std::vector<BufferBarrier>& bufferBarriers,
+            const std::vector<ImageBarrier>& imageBarriers) override;
+
+        void finish() override;
+        void reset() override;
+
+        void record(NullCommandType type, Uint32 index = 0, const void* object = nullptr,
+            Uint64 value0 = 0, Uint64 value1 = 0, Uint64 value2 = 0);
+
+        // Copies data into the encoder, the command references it by its offset there
+        void recordInline(NullCommandType type, Uint32 index, const void* data, Uint64 size, Uint64 value = 0,
+            const void* object = nullptr);
+
+        // Runs the buffer and texture transfers in record order, and the dispatches of compute
+        // only encoders between them, called by NullQueue::submit
+        void execute();
+
+        Uint64 getCommandCount() const { return this->commands.size(); }
+
+    private:
+        static constexpr Uint32 kNoTextureCopy = UINT32_MAX;
+
+        struct Transfer {
+            NullBuffer* source;
+            Uint64 sourceOffset;
+            NullBuffer* destination;
+            Uint64 destinationOffset;
+            Uint64 size;
+
+            // Index in textureCopies for copies touching a texture
+            Uint32 textureCopy;
+        };
+
+        // The buffer side is unused by texture to texture copies
+        struct TextureCopy {
+            ImageCopyBuffer buffer;
+            ImageCopyTexture source;
+            ImageCopyTexture destination;
+            Extent3D size;
+        };
+
+        // The dynamic offsets of a bind group stay in inlineData, dynamicOffsets is where they start
+        struct BoundGroup {
+            const BindGroup* bindGroup;
+            Uint64 dynamicOffsets;
+            Uint32 dynamicOffsetCount;
+        };
+
+        std::vector<NullCommand> commands;
+        std::vector<uint8_t> inlineData;
+        std::vector<Transfer> transfers;
+        std::vector<TextureCopy> textureCopies;
+
+        bool computeOnly;
+        TaskPool* computePool;
+
+        void executeTransfer(const Transfer& transfer);
+        void executeDispatch(const NullComputePipeline* pipeline, const std::vector<BoundGroup>& bindGroups,
+            const std::vector<uint8_t>& pushConstants, const uint32_t workgroupCount[3]);
+
+        // Only one pass is open at a time, beginning one hands out these
+        NullRenderPassEncoder renderPass{ this, RenderPassDescriptor{} };
+        NullComputePassEncoder computePass{ this, ComputePassDescriptor{} };
+    };
+
+    class NullQueue : public Queue {
+    public:
+        void submit(const std::vector<CommandEncoder*>& commandEncoders) override;
+        void writeBuffer(Buffer* buffer, Uint64 bufferOffset, const void* data, Uint64 size) override;
+        void writeTexture(ImageCopyTexture destination, const void* data, Uint64 dataSize, ImageDataLayout dataLayout,
+            Extent3D writeSize) override;
+        void waitIdle() override {}
+    };
+
+    class NullDevice : public Device {
+    public:
+        NullDevice();
+        NullDevice(DeviceDescriptor descriptor);
+
+        Queue* getQueue() override { return &this->queue; }
+
+        std::shared_ptr<Buffer> createBuffer(BufferDescriptor descriptor) override;
+        std::shared_ptr<Texture> createTexture(TextureDescriptor descriptor) override;
+        std::shared_ptr<Sampler> createSampler(SamplerDescriptor descriptor) override;
+        std::shared_ptr<BindGroup> createBindGroup(BindGroupDescriptor descriptor) override;
+        void updateBindGroup(BindGroup* bindGroup, const std::vector<BindGroupEntry>& entries) override;
+        std::shared_ptr<BindGroupLayout> createBindGroupLayout(BindGroupLayoutDescriptor descriptor) override;
+        std::shared_ptr<PipelineLayout> createPipelineLayout(PipelineLayoutDescriptor descriptor) override;
+        std::shared_ptr<ShaderModule> createShaderModule(ShaderModuleDescriptor descriptor) override;
+        std::shared_ptr<ComputePipeline> createComputePipeline(ComputePipelineDescriptor descriptor) override;
+        std::shared_ptr<RenderPipeline> createRenderPipeline(RenderPipelineDescriptor descriptor) override;
+        std::shared_ptr<CommandEncoder> createCommandEncoder() override;
+
+        // Dispatches of compute only devices run on the pool when set, on the submitting thread otherwise.
+        // The pool must outlive the submits.
+        void setComputePool(TaskPool* pool) { this->computePool = pool; }
+
+        ComputeKernelCache& getKernelCache() { return this->kernels; }
+
+    private:
+        NullQueue queue;
+
+        ComputeKernelCache kernels;
+        TaskPool* computePool = nullptr;
+    };
+
+    // Every feature and generous limits, as a CPU adapter
+    AdapterDescriptor getNullAdapterDescriptor();
+
+    class NullAdapter : public Adapter {
+    public:
+        NullAdapter(AdapterDescriptor descriptor) { this->desc = descriptor; }
+
+        std::shared_ptr<Device> requestDevice(DeviceMode mode = DeviceMode::eGraphics) override;
+    };
+
+    // Reports one adapter per descriptor, so several software devices with different
+    // capabilities can stand in for a multi-GPU machine
+    class NullInstance : public Instance {
+    public:
+        NullInstance(std::vector<AdapterDescriptor> adapters = { getNullAdapterDescriptor() }) : adapters{ std::move(adapters) } {}
+
+        std::vector<std::shared_ptr<Adapter>> enumerateAdapters() override;
+
+    private:
+        std::vector<AdapterDescriptor> adapters;
+    };
+};
@@ -0,0 +1,683 @@
+#include "pipeline_manifest.hpp"
+
+#include "hash.hpp"
+#include "mapped_file.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <climits>
+
+namespace Rhi {
+    namespace {
+        struct ManifestHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t shaderCount;
+            uint32_t entryCount;
+        };
+
+        // Every field goes through 64 bits, keys never hold struct padding
+        template <typename T>
+        void put(TracePayload& key, T value) {
+            key.write(static_cast<Uint64>(value));
+        }
+
+        template <typename T>
+        T get(TracePayloadReader& reader) {
+            return static_cast<T>(reader.read<Uint64>());
+        }
+
+        Uint64 getCodeBytes(const ShaderModuleDescriptor& descriptor) {
+            if (descriptor.code == nullptr) {
+                return 0;
+            }
+
+            return descriptor.codeSize != 0 ? descriptor.codeSize : std::strlen(descriptor.code) + 1;
+        }
+
+        // Only the sub layout selected by type is written, as PipelineLayoutCache compares them
+        void writeLayoutEntry(TracePayload& key, const BindGroupLayoutEntry& entry) {
+            put(key, entry.binding);
+            put(key, entry.visibility);
+            put(key, entry.type);
+            put(key, entry.count);
+            put(key, entry.partiallyBound);
+
+            switch (entry.type) {
+                case BindingType::eBuffer:
+                    put(key, entry.buffer.type);
+                    put(key, entry.buffer.hasDynamicOffset);
+                    put(key, entry.buffer.minBindingSize);
+                    break;
+
+                case BindingType::eSampler:
+                    put(key, entry.sampler.type);
+                    break;
+
+                case BindingType::eTexture:
+                    put(key, entry.texture.sampleType);
+                    put(key, entry.texture.viewDimension);
+                    put(key, entry.texture.multisampled);
+                    break;
+
+                case BindingType::eStorageTexture:
+                    put(key, entry.storageTexture.access);
+                    put(key, entry.storageTexture.viewDimension);
+                    put(key, entry.storageTexture.format);
+                    break;
+            }
+        }
+
+        BindGroupLayoutEntry readLayoutEntry(TracePayloadReader& reader) {
+            BindGroupLayoutEntry entry{};
+            entry.binding = get<Uint32>(reader);
+            entry.visibility = get<ShaderStageFlags>(reader);
+            entry.type = get<BindingType>(reader);
+            entry.count = get<Uint32>(reader);
+            entry.partiallyBound = get<bool>(reader);
+
+            switch (entry.type) {
+                case BindingType::eBuffer:
+                    entry.buffer.type = get<BufferBindingType>(reader);
+                    entry.buffer.hasDynamicOffset = get<bool>(reader);
+                    entry.buffer.minBindingSize = get<Uint64>(reader);
+                    break;
+
+                case BindingType::eSampler:
+                    entry.sampler.type = get<SamplerBindingType>(reader);
+                    break;
+
+                case BindingType::eTexture:
+                    entry.texture.sampleType = get<TextureSampleType>(reader);
+                    entry.texture.viewDimension = get<TextureViewDimension>(reader);
+                    entry.texture.multisampled = get<bool>(reader);
+                    break;
+
+                case BindingType::eStorageTexture:
+                    entry.storageTexture.access = get<ResourceAccess>(reader);
+                    entry.storageTexture.viewDimension = get<TextureViewDimension>(reader);
+                    entry.storageTexture.format = get<TextureFormat>(reader);
+                    break;
+            }
+
+            return entry;
+        }
+
+        void writeLayout(TracePayload& key, const PipelineLayout* layout) {
+            put(key, layout != nullptr);
+            if (layout == nullptr) {
+                return;
+            }
+
+            put(key, layout->desc.bindGroupLayouts.size());
+
+            for (const BindGroupLayout* group : layout->desc.bindGroupLayouts) {
+                put(key, group->desc.entries.size());
+
+                for (const auto& entry : group->desc.entries) {
+                    writeLayoutEntry(key, entry);
+                }
+            }
+
+            put(key, layout->desc.pushConstantRanges.size());
+
+            for (const auto& range : layout->desc.pushConstantRanges) {
+                put(key, range.visibility);
+                put(key, range.offset);
+                put(key, range.size);
+            }
+        }
+
+        // Counts are clamped to the key size, a corrupt key cannot ask for more elements than bytes
+        PipelineLayout* readLayout(TracePayloadReader& reader, Uint64 keySize, PipelineLayoutCache& layouts) {
+            if (!get<bool>(reader)) {
+                return nullptr;
+            }
+
+            std::vector<BindGroupLayoutDescriptor> groups(std::min(get<Uint64>(reader), keySize));
+
+            for (auto& group : groups) {
+                group.entries.resize(std::min(get<Uint64>(reader), keySize));
+
+                for (auto& entry : group.entries) {
+                    entry = readLayoutEntry(reader);
+                }
+            }
+
+            std::vector<PushConstantRange> ranges(std::min(get<Uint64>(reader), keySize));
+
+            for (auto& range : ranges) {
+                range.visibility = get<ShaderStageFlags>(reader);
+                range.offset = get<Uint32>(reader);
+                range.size = get<Uint32>(reader);
+            }
+
+            return reader.isValid() ? layouts.getPipelineLayout(groups, ranges) : nullptr;
+        }
+
+        void writeBlend(TracePayload& key, const BlendComponent& component) {
+            put(key, component.operation);
+            put(key, component.srcFactor);
+            put(key, component.dstFactor);
+        }
+
+        BlendComponent readBlend(TracePayloadReader& reader) {
+            BlendComponent component;
+            component.operation = get<BlendOperation>(reader);
+            component.srcFactor = get<BlendFactor>(reader);
+            component.dstFactor = get<BlendFactor>(reader);
+
+            return component;
+        }
+
+        void writeStencilFace(TracePayload& key, const StencilFaceState& face) {
+            put(key, face.compare);
+            put(key, face.failOp);
+            put(key, face.depthFailOp);
+            put(key, face.passOp);
+        }
+
+        StencilFaceState readStencilFace(TracePayloadReader& reader) {
+            StencilFaceState face;
+            face.compare = get<CompareFunction>(reader);
+            face.failOp = get<StencilOperation>(reader);
+            face.depthFailOp = get<StencilOperation>(reader);
+            face.passOp = get<StencilOperation>(reader);
+
+            return face;
+        }
+    };
+
+    // ===========================================================================================================================
+    // Recording
+    // ===========================================================================================================================
+
+    PipelineManifestDevice::PipelineManifestDevice(Device* inner) : inner{ inner }, layouts{ inner } {
+        this->desc = inner->desc;
+    }
+
+    std::shared_ptr<Buffer> PipelineManifestDevice::createBuffer(BufferDescriptor descriptor) {
+        return this->inner->createBuffer(descriptor);
+    }
+
+    std::shared_ptr<Texture> PipelineManifestDevice::createTexture(TextureDescriptor descriptor) {
+        return this->inner->createTexture(descriptor);
+    }
+
+    std::shared_ptr<Sampler> PipelineManifestDevice::createSampler(SamplerDescriptor descriptor) {
+        return this->inner->createSampler(descriptor);
+    }
+
+    std::shared_ptr<BindGroup> PipelineManifestDevice::createBindGroup(BindGroupDescriptor descriptor) {
+        return this->inner->createBindGroup(descriptor);
+    }
+
+    void PipelineManifestDevice::updateBindGroup(BindGroup* bindGroup, const std::vector<BindGroupEntry>& entries) {
+        this->inner->updateBindGroup(bindGroup, entries);
+    }
+
+    std::shared_ptr<BindGroupLayout> PipelineManifestDevice::createBindGroupLayout(BindGroupLayoutDescriptor descriptor) {
+        return this->inner->createBindGroupLayout(descriptor);
+    }
+
+    std::shared_ptr<PipelineLayout> PipelineManifestDevice::createPipelineLayout(PipelineLayoutDescriptor descriptor) {
+        return this->inner->createPipelineLayout(descriptor);
+    }
+
+    std::shared_ptr<CommandEncoder> PipelineManifestDevice::createCommandEncoder() {
+        return this->inner->createCommandEncoder();
+    }
+
+    // The code is hashed and kept while the caller's descriptor is known to be valid
+    std::shared_ptr<ShaderModule> PipelineManifestDevice::createShaderModule(ShaderModuleDescriptor descriptor) {
+        auto module = this->inner->createShaderModule(descriptor);
+        if (module == nullptr) {
+            return nullptr;
+        }
+
+        Uint64 codeBytes = getCodeBytes(descriptor);
+        Uint64 hash = hashBytes(descriptor.code, codeBytes);
+
+        {
+            std::lock_guard<std::mutex> lock{ this->mutex };
+            this->moduleHashes[module.get()] = hash;
+
+            ShaderBlob& blob = this->shaders[hash];
+            if (blob.code.empty()) {
+                blob.codeSize = descriptor.codeSize;
+                blob.code.assign(descriptor.code, descriptor.code + codeBytes);
+            }
+        }
+
+        ShaderModule* object = module.get();
+        return std::shared_ptr<ShaderModule>(object, [this, module](ShaderModule*) mutable {
+            {
+                std::lock_guard<std::mutex> lock{ this->mutex };
+                this->moduleHashes.erase(module.get());
+            }
+
+            module.reset();
+        });
+    }
+
+    Uint64 PipelineManifestDevice::getShaderHash(ShaderModule* module) {
+        {
+            std::lock_guard<std::mutex> lock{ this->mutex };
+
+            auto found = this->moduleHashes.find(module);
+            if (found != this->moduleHashes.end()) {
+                return found->second;
+            }
+        }
+
+        // Created elsewhere, the module's own descriptor is all there is
+        Uint64 codeBytes = getCodeBytes(module->desc);
+        Uint64 hash = hashBytes(module->desc.code, codeBytes);
+
+        std::lock_guard<std::mutex> lock{ this->mutex };
+
+        ShaderBlob& blob = this->shaders[hash];
+        if (blob.code.empty()) {
+            blob.codeSize = module->desc.codeSize;
+            blob.code.assign(module->desc.code, module->desc.code + codeBytes);
+        }
+
+        return hash;
+    }
+
+    PipelineManifestDevice::Entry* PipelineManifestDevice::findOrAddEntry(bool isRender, std::vector<uint8_t> key,
+        Uint64 firstFrame)
+    {
+        Uint64 hash = hashCombine(hashBytes(key.data(), key.size()), isRender);
+
+        std::lock_guard<std::mutex> lock{ this->mutex };
+
+        auto range = this->entries.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            Entry* entry = it->second.get();
+
+            if (entry->isRender == isRender && entry->key == key) {
+                entry->firstFrame = std::min(entry->firstFrame, firstFrame);
+                return entry;
+            }
+        }
+
+        auto entry = std::make_unique<Entry>();
+        entry->isRender = isRender;
+        entry->firstFrame = firstFrame;
+        entry->key = std::move(key);
+
+        return this->entries.emplace(hash, std::move(entry))->second.get();
+    }
+
+    std::shared_ptr<ComputePipeline> PipelineManifestDevice::createComputePipeline(ComputePipelineDescriptor descriptor) {
+        if (descriptor.compute.module == nullptr) {
+            return this->inner->createComputePipeline(descriptor);
+        }
+
+        TracePayload key;
+        writeLayout(key, descriptor.layout);
+
+        put(key, this->getShaderHash(descriptor.compute.module));
+        key.writeString(descriptor.compute.entryPoint);
+
+        const SpecializationBlock* constants = descriptor.compute.constants;
+        put(key, constants != nullptr ? constants->constants.size() : 0);
+
+        if (constants != nullptr) {
+            for (const auto& constant : constants->constants) {
+                put(key, constant.id);
+                key.write(constant.value);
+            }
+        }
+
+        Entry* entry = this->findOrAddEntry(false, std::vector<uint8_t>(key.getData(), key.getData() + key.getSize()),
+            this->frameIndex.load(std::memory_order_relaxed));
+
+        std::call_once(entry->compiled, [this, entry, &descriptor]() {
+            entry->computePipeline = this->inner->createComputePipeline(descriptor);
+        });
+
+        // A failed warm-up compile is retried with the application's own objects
+        return entry->computePipeline != nullptr ? entry->computePipeline : this->inner->createComputePipeline(descriptor);
+    }
+
+    std::shared_ptr<RenderPipeline> PipelineManifestDevice::createRenderPipeline(RenderPipelineDescriptor descriptor) {
+        if (descriptor.vertex.module == nullptr) {
+            return this->inner->createRenderPipeline(descriptor);
+        }
+
+        TracePayload key;
+        writeLayout(key, descriptor.layout);
+
+        const ProgrammableStage* stages[2] = { &descriptor.vertex, &descriptor.fragment };
+
+        for (const ProgrammableStage* stage : stages) {
+            put(key, stage->module != nullptr);
+            if (stage->module == nullptr) {
+                continue;
+            }
+
+            put(key, this->getShaderHash(stage->module));
+            key.writeString(stage->entryPoint);
+            put(key, stage->constants != nullptr ? stage->constants->constants.size() : 0);
+
+            if (stage->constants != nullptr) {
+                for (const auto& constant : stage->constants->constants) {
+                    put(key, constant.id);
+                    key.write(constant.value);
+                }
+            }
+        }
+
+        put(key, descriptor.vertex.buffers.size());
+
+        for (const auto& buffer : descriptor.vertex.buffers) {
+            put(key, buffer.arrayStride);
+            put(key, buffer.stepMode);
+            put(key, buffer.attributes.size());
+
+            for (const auto& attribute : buffer.attributes) {
+                put(key, attribute.format);
+                put(key, attribute.offset);
+                put(key, attribute.shaderLocation);
+            }
+        }
+
+        put(key, descriptor.fragment.targets.size());
+
+        for (const auto& target : descriptor.fragment.targets) {
+            put(key, target.format);
+            writeBlend(key, target.blend.color);
+            writeBlend(key, target.blend.alpha);
+            put(key, target.writeMask);
+        }
+
+        const DepthStencilState& depthStencil = descriptor.depthStencil;
+        put(key, depthStencil.format);
+        put(key, depthStencil.depthWriteEnabled);
+        put(key, depthStencil.depthCompare);
+        writeStencilFace(key, depthStencil.stencilFront);
+        writeStencilFace(key, depthStencil.stencilBack);
+        put(key, depthStencil.stencilReadMask);
+        put(key, depthStencil.stencilWriteMask);
+        put(key, depthStencil.depthBias);
+        key.write(depthStencil.depthBiasSlopeScale);
+        key.write(depthStencil.depthBiasClamp);
+
+        put(key, descriptor.primitive.topology);
+        put(key, descriptor.primitive.stripIndexFormat);
+        put(key, descriptor.rasterizationState.frontFace);
+        put(key, descriptor.rasterizationState.cullMode);
+        put(key, descriptor.rasterizationState.polygonMode);
+        put(key, descriptor.rasterizationState.unclippedDepth);
+        put(key, descriptor.multisample.count);
+        put(key, descriptor.multisample.mask);
+        put(key, descriptor.multisample.alphaToCoverageEnabled);
+
+        Entry* entry = this->findOrAddEntry(true, std::vector<uint8_t>(key.getData(), key.getData() + key.getSize()),
+            this->frameIndex.load(std::memory_order_relaxed));
+
+        std::call_once(entry->compiled, [this, entry, &descriptor]() {
+            entry->renderPipeline = this->inner->createRenderPipeline(descriptor);
+        });
+
+        return entry->renderPipeline != nullptr ? entry->renderPipeline : this->inner->createRenderPipeline(descriptor);
+    }
+
+    Uint32 PipelineManifestDevice::getPipelineCount() {
+        std::lock_guard<std::mutex> lock{ this->mutex };
+        return static_cast<Uint32>(this->entries.size());
+    }
+
+    // ===========================================================================================================================
+    // Manifest File
+    // ===========================================================================================================================
+
+    bool PipelineManifestDevice::saveManifest(const std::string& path, std::string& error) {
+        TracePayload file;
+
+        {
+            std::lock_guard<std::mutex> lock{ this->mutex };
+
+            file.write(ManifestHeader{ kPipelineManifestMagic, kPipelineManifestVersion,
+                static_cast<uint32_t>(this->shaders.size()), static_cast<uint32_t>(this->entries.size()) });
+
+            for (const auto& shader : this->shaders) {
+                file.write(shader.first);
+                file.write(shader.second.codeSize);
+                file.write(static_cast<Uint64>(shader.second.code.size()));
+                file.writeBytes(shader.second.code.data(), shader.second.code.size());
+            }
+
+            for (const auto& slot : this->entries) {
+                const Entry* entry = slot.second.get();
+
+                file.write(static_cast<uint8_t>(entry->isRender));
+                file.write(entry->firstFrame);
+                file.write(static_cast<uint32_t>(entry->key.size()));
+                file.writeBytes(entry->key.data(), entry->key.size());
+            }
+        }
+
+        std::FILE* output = std::fopen(path.c_str(), "wb");
+        if (output == nullptr) {
+            error = "Failed to create " + path;
+            return false;
+        }
+
+        bool written = std::fwrite(file.getData(), 1, file.getSize(), output) == file.getSize();
+        std::fclose(output);
+
+        if (!written) {
+            error = "Failed to write " + path;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool PipelineManifestDevice::loadManifest(const std::string& path, std::string& error) {
+        MappedFile file;
+        if (!file.open(path)) {
+            error = "Failed to open " + path;
+            return false;
+        }
+
+        TracePayloadReader reader{ file.getData(), file.getSize() };
+        ManifestHeader header = reader.read<ManifestHeader>();
+
+        if (header.magic != kPipelineManifestMagic || header.version != kPipelineManifestVersion) {
+            error = path + " is not a pipeline manifest of version " + std::to_string(kPipelineManifestVersion);
+            return false;
+        }
+
+        for (uint32_t i = 0; i < header.shaderCount && reader.isValid(); i++) {
+            Uint64 hash = reader.read<Uint64>();
+            Uint64 codeSize = reader.read<Uint64>();
+            std::vector<uint8_t> code(std::min(reader.read<Uint64>(), file.getSize()));
+            reader.readBytes(code.data(), code.size());
+
+            std::lock_guard<std::mutex> lock{ this->mutex };
+
+            ShaderBlob& blob = this->shaders[hash];
+            if (blob.code.empty()) {
+                blob.codeSize = codeSize;
+                blob.code = std::move(code);
+            }
+        }
+
+        for (uint32_t i = 0; i < header.entryCount && reader.isValid(); i++) {
+            bool isRender = reader.read<uint8_t>() != 0;
+            Uint64 firstFrame = reader.read<Uint64>();
+            std::vector<uint8_t> key(std::min<Uint64>(reader.read<uint32_t>(), file.getSize()));
+            reader.readBytes(key.data(), key.size());
+
+            if (reader.isValid()) {
+                this->findOrAddEntry(isRender, std::move(key), firstFrame);
+            }
+        }
+
+        if (!reader.isValid()) {
+            error = path + " is truncated";
+            return false;
+        }
+
+        return true;
+    }
+
+    // ===========================================================================================================================
+    // Warm-up
+    // ===========================================================================================================================
+
+    void PipelineManifestDevice::compileEntry(Entry* entry) {
+        TracePayloadReader reader{ entry->key.data(), entry->key.size() };
+        PipelineLayout* layout = readLayout(reader, entry->key.size(), this->layouts);
+
+        auto readStage = [this, &reader, entry](ProgrammableStage& stage, Uint32 index) {
+            stage.module = nullptr;
+            stage.constants = nullptr;
+
+            Uint64 hash = get<Uint64>(reader);
+            stage.entryPoint = reader.readString(entry->entryPoints[index]);
+
+            std::vector<SpecializationConstant> constants(std::min<Uint64>(get<Uint64>(reader), entry->key.size()));
+            for (auto& constant : constants) {
+                constant.id = get<Uint32>(reader);
+                constant.value = reader.read<Float64>();
+            }
+
+            if (!constants.empty()) {
+                stage.constants = this->constants.intern(std::move(constants));
+            }
+
+            std::lock_guard<std::mutex> lock{ this->mutex };
+
+            auto shader = this->shaders.find(hash);
+            if (shader != this->shaders.end()) {
+                stage.module = shader->second.module.get();
+            }
+
+            return stage.module != nullptr;
+        };
+
+        if (!entry->isRender) {
+            ComputePipelineDescriptor descriptor;
+            descriptor.layout = layout;
+
+            if (readStage(descriptor.compute, 0) && reader.isValid()) {
+                entry->computePipeline = this->inner->createComputePipeline(descriptor);
+            }
+
+            return;
+        }
+
+        RenderPipelineDescriptor descriptor;
+        descriptor.layout = layout;
+
+        if (!get<bool>(reader) || !readStage(descriptor.vertex, 0)) {
+            return;
+        }
+
+        if (get<bool>(reader) && !readStage(descriptor.fragment, 1)) {
+            return;
+        }
+
+        descriptor.vertex.buffers.resize(std::min<Uint64>(get<Uint64>(reader), entry->key.size()));
+
+        for (auto& buffer : descriptor.vertex.buffers) {
+            buffer.arrayStride = get<Uint64>(reader);
+            buffer.stepMode = get<VertexStepMode>(reader);
+            buffer.attributes.resize(std::min<Uint64>(get<Uint64>(reader), entry->key.size()));
+
+            for (auto& attribute : buffer.attributes) {
+                attribute.format = get<VertexFormat>(reader);
+                attribute.offset = get<Uint64>(reader);
+                attribute.shaderLocation = get<Uint32>(reader);
+            }
+        }
+
+        descriptor.fragment.targets.resize(std::min<Uint64>(get<Uint64>(reader), entry->key.size()));
+
+        for (auto& target : descriptor.fragment.targets) {
+            target.format = get<TextureFormat>(reader);
+            target.blend.color = readBlend(reader);
+            target.blend.alpha = readBlend(reader);
+            target.writeMask = get<ColorWriteFlags>(reader);
+        }
+
+        DepthStencilState& depthStencil = descriptor.depthStencil;
+        depthStencil.format = get<TextureFormat>(reader);
+        depthStencil.depthWriteEnabled = get<bool>(reader);
+        depthStencil.depthCompare = get<CompareFunction>(reader);
+        depthStencil.stencilFront = readStencilFace(reader);
+        depthStencil.stencilBack = readStencilFace(reader);
+        depthStencil.stencilReadMask = get<Uint64>(reader);
+        depthStencil.stencilWriteMask = get<Uint64>(reader);
+        depthStencil.depthBias = get<Int64>(reader);
+        depthStencil.depthBiasSlopeScale = reader.read<float>();
+        depthStencil.depthBiasClamp = reader.read<float>();
+
+        descriptor.primitive.topology = get<PrimitiveTopology>(reader);
+        descriptor.primitive.stripIndexFormat = get<IndexFormat>(reader);
+        descriptor.rasterizationState.frontFace = get<FrontFace>(reader);
+        descriptor.rasterizationState.cullMode = get<CullMode>(reader);
+        descriptor.rasterizationState.polygonMode = get<PolygonMode>(reader);
+        descriptor.rasterizationState.unclippedDepth = get<bool>(reader);
+        descriptor.multisample.count = get<Uint32>(reader);
+        descriptor.multisample.mask = get<Uint32>(reader);
+        descriptor.multisample.alphaToCoverageEnabled = get<bool>(reader);
+
+        if (reader.isValid()) {
+            entry->renderPipeline = this->inner->createRenderPipeline(descriptor);
+        }
+    }
+
+    Uint32 PipelineManifestDevice::warmUp(TaskPool& pool, PipelineWarmupDescriptor descriptor) {
+        std::vector<Entry*> pending;
+
+        {
+            std::lock_guard<std::mutex> lock{ this->mutex };
+
+            // Module creation is cheap next to pipeline compiles, it stays on this thread
+            for (auto& shader : this->shaders) {
+                ShaderBlob& blob = shader.second;
+
+                if (blob.module == nullptr) {
+                    blob.module = this->inner->createShaderModule(ShaderModuleDescriptor{
+                        reinterpret_cast<String>(blob.code.data()), blob.codeSize });
+                }
+            }
+
+            for (auto& slot : this->entries) {
+                Entry* entry = slot.second.get();
+
+                bool compiled = entry->computePipeline != nullptr || entry->renderPipeline != nullptr;
+                if (!compiled && entry->firstFrame <= descriptor.maxFirstFrame) {
+                    pending.push_back(entry);
+                }
+            }
+        }
+
+        auto total = static_cast<Uint32>(pending.size());
+        auto completed = std::make_shared<std::atomic<Uint32>>(0);
+        auto progress = std::make_shared<std::function<void(Uint32, Uint32)>>(std::move(descriptor.progress));
+
+        for (Entry* entry : pending) {
+            auto priority = static_cast<Int32>(std::min<Uint64>(entry->firstFrame, INT32_MAX));
+
+            pool.submit([this, entry, completed, progress, total]() {
+                std::call_once(entry->compiled, [this, entry]() {
+                    this->compileEntry(entry);
+                });
+
+                Uint32 done = completed->fetch_add(1, std::memory_order_relaxed) + 1;
+                if (*progress) {
+                    (*progress)(done, total);
+                }
+            }, -priority);
+        }
+
+        return total;
+    }
+};
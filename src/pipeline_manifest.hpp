@@ -0,0 +1,112 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "layout_cache.hpp"
+#include "specialization.hpp"
+#include "task_pool.hpp"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Pipeline Manifest
+    // ===========================================================================================================================
+
+    // A manifest is a header, the shader code blobs, then one entry per unique pipeline:
+    // { uint8 isRender, uint64 firstFrame, uint32 size, key }. The key is the descriptor
+    // written field by field as 64-bit values, with shaders referenced by content hash and
+    // explicit layouts stored by value, so equal descriptors always give equal keys.
+
+    constexpr uint32_t kPipelineManifestMagic = 0x4D4F5350;    // "PSOM"
+    constexpr uint32_t kPipelineManifestVersion = 1;
+
+    struct PipelineWarmupDescriptor {
+        // Pipelines first used after this frame are left to compile on first use
+        Uint64 maxFirstFrame = ULLONG_MAX;
+
+        // Called from the pool's workers after each pipeline, completed counts up to total
+        std::function<void(Uint32 completed, Uint32 total)> progress;
+    };
+
+    // Wraps another device, records every unique pipeline descriptor created through it with
+    // the frame it was first created in, and compiles the pipelines of a loaded manifest ahead
+    // of use. Creating a pipeline that was warmed up returns the warm object; one that is still
+    // compiling waits for that compile instead of starting a second one.
+    //
+    // Every other call goes straight to the inner device, and every object returned is the inner
+    // one. Pipelines warmed from a manifest use shader modules and layouts the manifest device
+    // created, with the same code and layout descriptors as the application's.
+    class PipelineManifestDevice : public Device {
+    public:
+        PipelineManifestDevice(Device* inner);
+
+        Queue* getQueue() override { return this->inner->getQueue(); }
+
+        std::shared_ptr<Buffer> createBuffer(BufferDescriptor descriptor) override;
+        std::shared_ptr<Texture> createTexture(TextureDescriptor descriptor) override;
+        std::shared_ptr<Sampler> createSampler(SamplerDescriptor descriptor) override;
+        std::shared_ptr<BindGroup> createBindGroup(BindGroupDescriptor descriptor) override;
+        void updateBindGroup(BindGroup* bindGroup, const std::vector<BindGroupEntry>& entries) override;
+        std::shared_ptr<BindGroupLayout> createBindGroupLayout(BindGroupLayoutDescriptor descriptor) override;
+        std::shared_ptr<PipelineLayout> createPipelineLayout(PipelineLayoutDescriptor descriptor) override;
+        std::shared_ptr<ShaderModule> createShaderModule(ShaderModuleDescriptor descriptor) override;
+        std::shared_ptr<ComputePipeline> createComputePipeline(ComputePipelineDescriptor descriptor) override;
+        std::shared_ptr<RenderPipeline> createRenderPipeline(RenderPipelineDescriptor descriptor) override;
+        std::shared_ptr<CommandEncoder> createCommandEncoder() override;
+
+        // Frame stamped on pipelines seen for the first time
+        void beginFrame(Uint64 frameIndex) { this->frameIndex.store(frameIndex, std::memory_order_relaxed); }
+
+        // Merges the file into the recorded set, an entry seen in both keeps the earlier frame
+        bool loadManifest(const std::string& path, std::string& error);
+        bool saveManifest(const std::string& path, std::string& error);
+
+        // Queues every recorded pipeline not compiled yet on the pool, earliest first use first,
+        // and returns how many were queued. Wait on the pool to block until they are done.
+        // The pool must be drained before the device is destroyed.
+        Uint32 warmUp(TaskPool& pool, PipelineWarmupDescriptor descriptor = {});
+
+        Uint32 getPipelineCount();
+
+    private:
+        struct Entry {
+            bool isRender;
+            Uint64 firstFrame;
+            std::vector<uint8_t> key;
+
+            std::once_flag compiled;
+            std::shared_ptr<ComputePipeline> computePipeline;
+            std::shared_ptr<RenderPipeline> renderPipeline;
+
+            // Storage the descriptor decoded from the key points into
+            std::string entryPoints[2];
+        };
+
+        struct ShaderBlob {
+            Uint64 codeSize;
+            std::vector<uint8_t> code;
+            std::shared_ptr<ShaderModule> module;
+        };
+
+        Entry* findOrAddEntry(bool isRender, std::vector<uint8_t> key, Uint64 firstFrame);
+        Uint64 getShaderHash(ShaderModule* module);
+        void compileEntry(Entry* entry);
+
+        Device* inner;
+
+        PipelineLayoutCache layouts;
+        SpecializationBlockPool constants;
+
+        std::atomic<Uint64> frameIndex{ 0 };
+
+        std::mutex mutex;
+        std::unordered_multimap<Uint64, std::unique_ptr<Entry>> entries;
+        std::unordered_map<Uint64, ShaderBlob> shaders;
+
+        // Code hash of every live module created through this device
+        std::unordered_map<const ShaderModule*, Uint64> moduleHashes;
+    };
+};
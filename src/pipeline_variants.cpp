@@ -0,0 +1,110 @@
+#include "pipeline_variants.hpp"
+
+#include "layout_cache.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Compute Pipeline Variants
+    // ===========================================================================================================================
+
+    ComputePipelineVariants::ComputePipelineVariants(Device* device, ComputePipelineDescriptor descriptor, PipelineLayoutCache* layouts)
+        : device{ device }, desc{ descriptor }, layouts{ layouts } {}
+
+    ComputePipeline* ComputePipelineVariants::getPipeline(const SpecializationBlock* constants, std::string& error) {
+        Variant* variant;
+        {
+            std::lock_guard<std::mutex> lock{ this->mutex };
+
+            auto& slot = this->variants[constants];
+            if (slot == nullptr) {
+                slot = std::make_unique<Variant>();
+            }
+
+            variant = slot.get();
+        }
+
+        // Compiling outside the map lock lets different variants build in parallel
+        std::call_once(variant->compiled, [this, variant, constants]() {
+            ComputePipelineDescriptor descriptor = this->desc;
+            descriptor.compute.constants = constants;
+
+            // Specialization keeps the resource interface, every variant shares one layout
+            if (descriptor.layout == nullptr && this->layouts != nullptr) {
+                descriptor.layout = this->layouts->resolveLayout(descriptor, variant->error);
+
+                if (descriptor.layout == nullptr) {
+                    return;
+                }
+            }
+
+            variant->pipeline = this->device->createComputePipeline(descriptor);
+            if (variant->pipeline == nullptr) {
+                variant->error = "Failed to create compute pipeline variant";
+            }
+        });
+
+        if (variant->pipeline == nullptr) {
+            error = variant->error;
+        }
+
+        return variant->pipeline.get();
+    }
+
+    Uint32 ComputePipelineVariants::getVariantCount() {
+        std::lock_guard<std::mutex> lock{ this->mutex };
+        return static_cast<Uint32>(this->variants.size());
+    }
+
+    // ===========================================================================================================================
+    // Render Pipeline Variants
+    // ===========================================================================================================================
+
+    RenderPipelineVariants::RenderPipelineVariants(Device* device, RenderPipelineDescriptor descriptor, PipelineLayoutCache* layouts)
+        : device{ device }, desc{ descriptor }, layouts{ layouts } {}
+
+    RenderPipeline* RenderPipelineVariants::getPipeline(const SpecializationBlock* vertexConstants,
+        const SpecializationBlock* fragmentConstants, std::string& error)
+    {
+        Variant* variant;
+        {
+            std::lock_guard<std::mutex> lock{ this->mutex };
+
+            auto& slot = this->variants[VariantKey{ vertexConstants, fragmentConstants }];
+            if (slot == nullptr) {
+                slot = std::make_unique<Variant>();
+            }
+
+            variant = slot.get();
+        }
+
+        std::call_once(variant->compiled, [this, variant, vertexConstants, fragmentConstants]() {
+            RenderPipelineDescriptor descriptor = this->desc;
+            descriptor.vertex.constants = vertexConstants;
+            descriptor.fragment.constants = fragmentConstants;
+
+            if (descriptor.layout == nullptr && this->layouts != nullptr) {
+                descriptor.layout = this->layouts->resolveLayout(descriptor, variant->error);
+
+                if (descriptor.layout == nullptr) {
+                    return;
+                }
+            }
+
+            variant->pipeline = this->device->createRenderPipeline(descriptor);
+            if (variant->pipeline == nullptr) {
+                variant->error = "Failed to create render pipeline variant";
+            }
+        });
+
+        if (variant->pipeline == nullptr) {
+            error = variant->error;
+        }
+
+        return variant->pipeline.get();
+    }
+
+    Uint32 RenderPipelineVariants::getVariantCount() {
+        std::lock_guard<std::mutex> lock{ this->mutex };
+        return static_cast<Uint32>(this->variants.size());
+    }
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "rhi.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace Rhi {
+    class PipelineLayoutCache;
+
+    // ===========================================================================================================================
+    // Pipeline Variants
+    // ===========================================================================================================================
+
+    // Lazily compiled specializations of one uber-shader pipeline. Each variant is compiled the
+    // first time its constant blocks are requested and cached under the interned block
+    // pointers. Concurrent requests for the same variant wait for a single compile.
+    class ComputePipelineVariants {
+    public:
+        // layouts derives the shared layout when descriptor.layout is nullptr
+        ComputePipelineVariants(Device* device, ComputePipelineDescriptor descriptor, PipelineLayoutCache* layouts = nullptr);
+
+        ComputePipeline* getPipeline(const SpecializationBlock* constants, std::string& error);
+        Uint32 getVariantCount();
+
+    private:
+        struct Variant {
+            std::once_flag compiled;
+            std::shared_ptr<ComputePipeline> pipeline;
+            std::string error;
+        };
+
+        Device* device;
+        ComputePipelineDescriptor desc;
+        PipelineLayoutCache* layouts;
+
+        std::mutex mutex;
+        std::unordered_map<const SpecializationBlock*, std::unique_ptr<Variant>> variants;
+    };
+
+    class RenderPipelineVariants {
+    public:
+        RenderPipelineVariants(Device* device, RenderPipelineDescriptor descriptor, PipelineLayoutCache* layouts = nullptr);
+
+        RenderPipeline* getPipeline(const SpecializationBlock* vertexConstants, const SpecializationBlock* fragmentConstants,
+            std::string& error);
+        Uint32 getVariantCount();
+
+    private:
+        struct Variant {
+            std::once_flag compiled;
+            std::shared_ptr<RenderPipeline> pipeline;
+            std::string error;
+        };
+
+        struct VariantKey {
+            const SpecializationBlock* vertex;
+            const SpecializationBlock* fragment;
+
+            bool operator==(const VariantKey& other) const {
+                return this->vertex == other.vertex && this->fragment == other.fragment;
+            }
+        };
+
+        struct VariantKeyHash {
+            size_t operator()(const VariantKey& key) const {
+                return std::hash<const void*>{}(key.vertex) * 31 + std::hash<const void*>{}(key.fragment);
+            }
+        };
+
+        Device* device;
+        RenderPipelineDescriptor desc;
+        PipelineLayoutCache* layouts;
+
+        std::mutex mutex;
+        std::unordered_map<VariantKey, std::unique_ptr<Variant>, VariantKeyHash> variants;
+    };
+};
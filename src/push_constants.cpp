@@ -0,0 +1,69 @@
+#include "push_constants.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Rhi {
+    PushConstantEmulator::PushConstantEmulator(Device* device, PushConstantEmulatorDescriptor descriptor) : device{ device }, desc{ descriptor } {
+        BindGroupLayoutEntry entry;
+        entry.binding = 0;
+        entry.visibility = static_cast<ShaderStageFlags>(ShaderStage::eVertex) | static_cast<ShaderStageFlags>(ShaderStage::eFragment)
+            | static_cast<ShaderStageFlags>(ShaderStage::eCompute);
+        entry.type = BindingType::eBuffer;
+        entry.buffer.type = BufferBindingType::eUniform;
+        entry.buffer.hasDynamicOffset = true;
+        entry.buffer.minBindingSize = this->desc.blockSize;
+
+        this->layout = this->device->createBindGroupLayout(BindGroupLayoutDescriptor{ { entry } });
+
+        TransientAllocatorDescriptor ringDesc;
+        ringDesc.pageSize = this->desc.pageSize;
+        ringDesc.blockSize = this->desc.pageSize;
+        ringDesc.alignment = this->desc.offsetAlignment;
+        ringDesc.usage = static_cast<BufferUsageFlags>(BufferUsage::eUniform);
+        ringDesc.framesInFlight = this->desc.framesInFlight;
+        ringDesc.layout = this->layout.get();
+        ringDesc.bindingSize = this->desc.blockSize;
+
+        this->ring = std::make_unique<TransientAllocator>(this->device, ringDesc);
+        this->shadow.assign(this->desc.blockSize, 0);
+    }
+
+    void PushConstantEmulator::beginFrame(Uint64 frameIndex) {
+        this->ring->beginFrame(frameIndex);
+        this->beginPass();
+    }
+
+    void PushConstantEmulator::beginPass() {
+        this->dirty = true;
+    }
+
+    void PushConstantEmulator::setPushConstants(Uint32 offset, Uint32 size, const void* data) {
+        if (offset >= this->desc.blockSize) {
+            return;
+        }
+
+        size = std::min(size, this->desc.blockSize - offset);
+        std::memcpy(this->shadow.data() + offset, data, size);
+
+        this->dirty = true;
+    }
+
+    void PushConstantEmulator::flush(BindingCommandsMixin* pass) {
+        if (!this->dirty) {
+            return;
+        }
+
+        TransientAllocation allocation = this->ring->allocate(this->context, this->desc.blockSize);
+
+        if (allocation.buffer == nullptr) {
+            return;
+        }
+
+        std::memcpy(allocation.data, this->shadow.data(), this->desc.blockSize);
+        allocation.buffer->flush(this->desc.blockSize, allocation.offset);
+
+        pass->setBindGroup(this->desc.bindGroupIndex, allocation.bindGroup, &allocation.offset, 0, 1);
+        this->dirty = false;
+    }
+};
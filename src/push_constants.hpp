@@ -0,0 +1,59 @@
+#pragma once
+
+#include "transient_allocator.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Push Constant Emulation
+    // ===========================================================================================================================
+
+    struct PushConstantEmulatorDescriptor {
+        // Group the block is bound at, the pipeline layout holds getLayout() there in place of its push constant ranges
+        Uint32 bindGroupIndex = 3;
+
+        // Largest push constant block
+        Uint32 blockSize = 128;
+
+        // minUniformBufferOffsetAlignment of the device
+        Uint32 offsetAlignment = 256;
+
+        // Uniform ring sizing, a frame that needs more grows it
+        Uint64 pageSize = 1ull << 20;
+        Uint32 framesInFlight = 3;
+    };
+
+    // For backends without native push constants. The block lives in a shadow copy and every
+    // draw or dispatch after a change binds a fresh copy of it, taken from a TransientAllocator
+    // and selected with a dynamic offset. Shaders see a uniform block at binding 0 of
+    // bindGroupIndex, which is what SPIR-V cross compilers turn push constant blocks into.
+    //
+    // One emulator per recording thread.
+    class PushConstantEmulator {
+    public:
+        PushConstantEmulator(Device* device, PushConstantEmulatorDescriptor descriptor = {});
+
+        BindGroupLayout* getLayout() const { return this->layout.get(); }
+
+        // Reuses the ring pages of frameIndex - framesInFlight, which must have completed
+        void beginFrame(Uint64 frameIndex);
+
+        // Call at the start of every pass, bindings do not survive pass boundaries
+        void beginPass();
+
+        void setPushConstants(Uint32 offset, Uint32 size, const void* data);
+
+        // Call before each draw or dispatch
+        void flush(BindingCommandsMixin* pass);
+
+    private:
+        Device* device;
+        PushConstantEmulatorDescriptor desc;
+
+        std::shared_ptr<BindGroupLayout> layout;
+        std::unique_ptr<TransientAllocator> ring;
+        TransientAllocator::Context context;
+
+        std::vector<uint8_t> shadow;
+        bool dirty = true;
+    };
+};
@@ -0,0 +1,540 @@
+#include "residency.hpp"
+#include "texture_streaming.hpp"
+#include "texture_state.hpp"
+
+#include <algorithm>
+
+namespace Rhi {
+    namespace {
+        constexpr BufferUsageFlags kCopyUsage = static_cast<BufferUsageFlags>(BufferUsage::eCopySrc)
+            | static_cast<BufferUsageFlags>(BufferUsage::eCopyDst);
+
+        Uint64 getTextureBytes(const TextureDescriptor& desc, Uint32 firstMip) {
+            return getTextureCopySize(desc, firstMip, desc.mipLevelCount - firstMip) * desc.sampleCount;
+        }
+
+        // The depth of a 3D texture is not array layers
+        TextureSubresource getWholeTexture(const Texture* texture) {
+            TextureSubresource subresource;
+            subresource.mipLevelCount = texture->desc.mipLevelCount;
+            subresource.arrayLayerCount = texture->desc.dimension == TextureDimension::e3D ? 1 : texture->desc.sliceLayersNum;
+
+            return subresource;
+        }
+
+        // A texture last transitioned by a TextureStateTracker may have its mips and layers in
+        // different states, each run of layers sharing a state then gets its own barrier
+        void transitionTexture(CommandEncoder* encoder, ShaderStage srcStage, ShaderStage dstStage, Texture* texture,
+            TextureState state)
+        {
+            ImageBarrier barrier;
+            barrier.srcAccess = ResourceAccess::eReadWrite;
+            barrier.dstAccess = state == TextureState::eCopyDst ? ResourceAccess::eWriteOnly : ResourceAccess::eReadOnly;
+            barrier.texture = texture;
+            barrier.subresource = getWholeTexture(texture);
+            barrier.srcState = texture->state;
+            barrier.dstState = state;
+
+            std::vector<ImageBarrier> barriers;
+
+            if (texture->subresourceStates.empty()) {
+                barriers.push_back(barrier);
+            } else {
+                Uint32 layerCount = barrier.subresource.arrayLayerCount;
+
+                for (Uint32 mipLevel = 0; mipLevel < texture->desc.mipLevelCount; mipLevel++) {
+                    for (Uint32 layer = 0, end; layer < layerCount; layer = end) {
+                        TextureState srcState = getTextureState(texture, mipLevel, layer);
+
+                        for (end = layer + 1; end < layerCount && getTextureState(texture, mipLevel, end) == srcState; end++) {}
+
+                        barrier.subresource.baseMipLevel = mipLevel;
+                        barrier.subresource.mipLevelCount = 1;
+                        barrier.subresource.baseArrayLayer = layer;
+                        barrier.subresource.arrayLayerCount = end - layer;
+                        barrier.srcState = srcState;
+
+                        barriers.push_back(barrier);
+                    }
+                }
+            }
+
+            encoder->activateBarriers(srcStage, dstStage, {}, barriers);
+            setTextureState(texture, state);
+        }
+
+        void transitionBuffer(CommandEncoder* encoder, ShaderStage srcStage, ShaderStage dstStage, Buffer* buffer,
+            ResourceAccess srcAccess, ResourceAccess dstAccess)
+        {
+            BufferBarrier barrier;
+            barrier.srcAccess = srcAccess;
+            barrier.dstAccess = dstAccess;
+            barrier.buffer = buffer;
+
+            encoder->activateBufferBarrier(srcStage, dstStage, barrier);
+        }
+    };
+
+    void ResidentResource::markUsed() {
+        this->lastUsedFrame.store(this->manager->getFrameIndex(), std::memory_order_relaxed);
+
+        if (this->state != ResidencyState::eResident) {
+            this->restoreRequested.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    // ===========================================================================================================================
+    // Residency Manager
+    // ===========================================================================================================================
+
+    ResidencyManager::ResidencyManager(Device* device, ResidencyDescriptor descriptor) : device{ device }, desc{ descriptor } {}
+
+    std::shared_ptr<ResidentBuffer> ResidencyManager::createBuffer(BufferDescriptor descriptor, ResidencyPriority priority) {
+        descriptor.usage |= kCopyUsage;
+
+        auto resource = std::make_shared<ResidentBuffer>(this, priority);
+        resource->desc = descriptor;
+        resource->fullBytes = descriptor.location == BufferLocation::eDeviceLocal ? descriptor.size : 0;
+        resource->lastUsedFrame = this->getFrameIndex();
+
+        bool fits = this->getDeviceBytes() + resource->fullBytes <= this->desc.budget;
+
+        if (fits || priority == ResidencyPriority::ePinned) {
+            resource->buffer = this->device->createBuffer(descriptor);
+            resource->deviceBytes = resource->fullBytes;
+            resource->hostBytes = descriptor.size - resource->fullBytes;
+        } else {
+            BufferDescriptor hostDesc = descriptor;
+            hostDesc.location = BufferLocation::eHost;
+
+            resource->buffer = this->device->createBuffer(hostDesc);
+            resource->state = ResidencyState::eDemoted;
+            resource->hostBytes = descriptor.size;
+        }
+
+        if (resource->buffer == nullptr) {
+            return nullptr;
+        }
+
+        this->buffers.emplace_back(resource);
+        return resource;
+    }
+
+    std::shared_ptr<ResidentTexture> ResidencyManager::createTexture(TextureDescriptor descriptor, ResidencyPriority priority) {
+        descriptor.usage |= static_cast<TextureUsageFlags>(TextureUsage::eCopySrc) | static_cast<TextureUsageFlags>(TextureUsage::eCopyDst);
+
+        auto resource = std::make_shared<ResidentTexture>(this, priority);
+        resource->desc = descriptor;
+        resource->fullBytes = getTextureBytes(descriptor, 0);
+        resource->lastUsedFrame = this->getFrameIndex();
+
+        // Textures cannot live in host memory, one that does not fit starts trimmed to the
+        // mips that do, down to minResidentMips
+        Uint64 available = this->desc.budget - std::min(this->desc.budget, this->getDeviceBytes());
+        Uint32 dropped = 0;
+
+        if (priority != ResidencyPriority::ePinned) {
+            Uint32 maxDropped = descriptor.mipLevelCount - std::min(this->desc.minResidentMips, descriptor.mipLevelCount);
+
+            while (dropped < maxDropped && getTextureBytes(descriptor, dropped) > available) {
+                dropped++;
+            }
+        }
+
+        if (dropped == 0) {
+            resource->texture = this->device->createTexture(descriptor);
+            resource->deviceBytes = resource->fullBytes;
+        } else {
+            TextureDescriptor trimmedDesc = descriptor;
+            trimmedDesc.size = getMipExtent(descriptor.size, dropped);
+            trimmedDesc.mipLevelCount = descriptor.mipLevelCount - dropped;
+
+            std::vector<TextureUploadRegion> regions;
+            Uint64 hostSize = getTextureCopyRegions(descriptor, 0, dropped, regions);
+
+            resource->texture = this->device->createTexture(trimmedDesc);
+            resource->hostMips = this->device->createBuffer(BufferDescriptor{ hostSize, kCopyUsage, BufferLocation::eHost });
+            resource->droppedMipCount = dropped;
+            resource->deviceBytes = getTextureBytes(descriptor, dropped);
+            resource->hostBytes = hostSize;
+            resource->state = ResidencyState::eTrimmed;
+
+            if (resource->hostMips == nullptr) {
+                return nullptr;
+            }
+        }
+
+        if (resource->texture == nullptr) {
+            return nullptr;
+        }
+
+        this->textures.emplace_back(resource);
+        return resource;
+    }
+
+    void ResidencyManager::prune() {
+        this->buffers.erase(std::remove_if(this->buffers.begin(), this->buffers.end(),
+            [](const std::weak_ptr<ResidentBuffer>& resource) { return resource.expired(); }), this->buffers.end());
+
+        this->textures.erase(std::remove_if(this->textures.begin(), this->textures.end(),
+            [](const std::weak_ptr<ResidentTexture>& resource) { return resource.expired(); }), this->textures.end());
+    }
+
+    Uint64 ResidencyManager::getDeviceBytes() const {
+        Uint64 bytes = 0;
+
+        for (const auto& weak : this->buffers) {
+            if (auto resource = weak.lock()) {
+                bytes += resource->deviceBytes;
+            }
+        }
+
+        for (const auto& weak : this->textures) {
+            if (auto resource = weak.lock()) {
+                bytes += resource->deviceBytes;
+            }
+        }
+
+        return bytes;
+    }
+
+    Uint32 ResidencyManager::getDroppableMipCount(const ResidentTexture* resource) const {
+        Uint32 keptMipCount = resource->desc.mipLevelCount - resource->droppedMipCount;
+        Uint32 minMipCount = std::min(this->desc.minResidentMips, resource->desc.mipLevelCount);
+
+        return keptMipCount > minMipCount ? keptMipCount - minMipCount : 0;
+    }
+
+    ResidencyStats ResidencyManager::update(CommandEncoder* encoder, Uint64 frameIndex) {
+        this->frameIndex = frameIndex;
+        this->prune();
+
+        ResidencyStats stats;
+        stats.budget = this->desc.budget;
+
+        // Locked for the whole update so a resource dropped by its owner stays valid meanwhile
+        std::vector<std::shared_ptr<ResidentResource>> live;
+        live.reserve(this->buffers.size() + this->textures.size());
+
+        for (const auto& weak : this->buffers) {
+            if (auto resource = weak.lock()) {
+                live.emplace_back(std::move(resource));
+            }
+        }
+
+        for (const auto& weak : this->textures) {
+            if (auto resource = weak.lock()) {
+                live.emplace_back(std::move(resource));
+            }
+        }
+
+        std::vector<ResidentResource*> restores, candidates;
+
+        for (const auto& resource : live) {
+            stats.deviceBytes += resource->deviceBytes;
+
+            if (resource->restoreRequested) {
+                restores.emplace_back(resource.get());
+                continue;
+            }
+
+            // Work of the last minIdleFrames frames may still be in flight
+            if (resource->priority == ResidencyPriority::ePinned || resource->lastUsedFrame + this->desc.minIdleFrames > frameIndex) {
+                continue;
+            }
+
+            auto* texture = dynamic_cast<ResidentTexture*>(resource.get());
+
+            bool evictable = texture != nullptr
+                ? this->getDroppableMipCount(texture) > 0
+                : resource->state == ResidencyState::eResident && resource->deviceBytes != 0;
+
+            if (evictable) {
+                candidates.emplace_back(resource.get());
+            }
+        }
+
+        // Coldest first: lowest priority, then least recently used
+        std::sort(candidates.begin(), candidates.end(), [](const ResidentResource* a, const ResidentResource* b) {
+            return a->priority != b->priority ? a->priority < b->priority : a->lastUsedFrame < b->lastUsedFrame;
+        });
+
+        std::sort(restores.begin(), restores.end(), [](const ResidentResource* a, const ResidentResource* b) {
+            return a->priority != b->priority ? a->priority > b->priority : a->lastUsedFrame > b->lastUsedFrame;
+        });
+
+        size_t nextCandidate = 0;
+
+        // A restore that cannot make room stays demoted instead of evicting hot resources
+        for (ResidentResource* resource : restores) {
+            if (!this->makeRoom(resource->fullBytes - resource->deviceBytes, encoder, candidates, nextCandidate, stats)) {
+                stats.overBudget = true;
+                break;
+            }
+
+            if (auto* texture = dynamic_cast<ResidentTexture*>(resource)) {
+                this->restoreTexture(texture, encoder, stats);
+            } else {
+                this->restoreBuffer(static_cast<ResidentBuffer*>(resource), encoder, stats);
+            }
+
+            resource->restoreRequested = false;
+        }
+
+        if (!this->makeRoom(0, encoder, candidates, nextCandidate, stats)) {
+            stats.overBudget = true;
+        }
+
+        stats.hostBytes = 0;
+        for (const auto& resource : live) {
+            stats.hostBytes += resource->hostBytes;
+
+            switch (resource->state) {
+                case ResidencyState::eResident: stats.residentCount++; break;
+                case ResidencyState::eDemoted: stats.demotedCount++; break;
+                case ResidencyState::eTrimmed: stats.trimmedCount++; break;
+            }
+        }
+
+        return stats;
+    }
+
+    bool ResidencyManager::makeRoom(Uint64 bytes, CommandEncoder* encoder, std::vector<ResidentResource*>& candidates, size_t& next,
+        ResidencyStats& stats)
+    {
+        while (stats.deviceBytes + bytes > this->desc.budget) {
+            if (next >= candidates.size()) {
+                return false;
+            }
+
+            ResidentResource* resource = candidates[next++];
+            auto* texture = dynamic_cast<ResidentTexture*>(resource);
+
+            if (texture == nullptr) {
+                this->demoteBuffer(static_cast<ResidentBuffer*>(resource), encoder, stats);
+                continue;
+            }
+
+            // Drop as few mips as cover the deficit, every mip roughly quarters the size
+            Uint64 deficit = stats.deviceBytes + bytes - this->desc.budget;
+            Uint32 maxDropped = texture->droppedMipCount + this->getDroppableMipCount(texture);
+            Uint32 dropped = texture->droppedMipCount + 1;
+
+            while (dropped < maxDropped && texture->deviceBytes - getTextureBytes(texture->desc, dropped) < deficit) {
+                dropped++;
+            }
+
+            this->trimTexture(texture, dropped, encoder, stats);
+        }
+
+        return true;
+    }
+
+    void ResidencyManager::demoteBuffer(ResidentBuffer* resource, CommandEncoder* encoder, ResidencyStats& stats) {
+        BufferDescriptor hostDesc = resource->desc;
+        hostDesc.location = BufferLocation::eHost;
+
+        auto host = this->device->createBuffer(hostDesc);
+        if (host == nullptr) {
+            return;
+        }
+
+        transitionBuffer(encoder, this->desc.consumerStage, ShaderStage::eTransfer, resource->buffer.get(), ResourceAccess::eReadWrite,
+            ResourceAccess::eReadOnly);
+        encoder->copyBufferToBuffer(resource->buffer.get(), 0, host.get(), 0, resource->desc.size);
+        transitionBuffer(encoder, ShaderStage::eTransfer, this->desc.consumerStage, host.get(), ResourceAccess::eWriteOnly,
+            ResourceAccess::eReadWrite);
+
+        this->retire(std::move(resource->buffer));
+        resource->buffer = std::move(host);
+
+        stats.deviceBytes -= resource->deviceBytes;
+        stats.evictedBytes += resource->deviceBytes;
+
+        resource->deviceBytes = 0;
+        resource->hostBytes = resource->desc.size;
+        resource->state = ResidencyState::eDemoted;
+        resource->generation++;
+    }
+
+    void ResidencyManager::restoreBuffer(ResidentBuffer* resource, CommandEncoder* encoder, ResidencyStats& stats) {
+        auto buffer = this->device->createBuffer(resource->desc);
+        if (buffer == nullptr) {
+            return;
+        }
+
+        transitionBuffer(encoder, this->desc.consumerStage, ShaderStage::eTransfer, resource->buffer.get(), ResourceAccess::eReadWrite,
+            ResourceAccess::eReadOnly);
+        encoder->copyBufferToBuffer(resource->buffer.get(), 0, buffer.get(), 0, resource->desc.size);
+        transitionBuffer(encoder, ShaderStage::eTransfer, this->desc.consumerStage, buffer.get(), ResourceAccess::eWriteOnly,
+            ResourceAccess::eReadWrite);
+
+        this->retire(std::move(resource->buffer));
+        resource->buffer = std::move(buffer);
+
+        stats.deviceBytes += resource->fullBytes;
+        stats.restoredBytes += resource->fullBytes;
+
+        resource->deviceBytes = resource->fullBytes;
+        resource->hostBytes = 0;
+        resource->state = ResidencyState::eResident;
+        resource->generation++;
+    }
+
+    void ResidencyManager::trimTexture(ResidentTexture* resource, Uint32 droppedMipCount, CommandEncoder* encoder, ResidencyStats& stats) {
+        const TextureDescriptor& fullDesc = resource->desc;
+        Uint32 oldDropped = resource->droppedMipCount;
+        Texture* old = resource->texture.get();
+
+        TextureDescriptor trimmedDesc = fullDesc;
+        trimmedDesc.size = getMipExtent(fullDesc.size, droppedMipCount);
+        trimmedDesc.mipLevelCount = fullDesc.mipLevelCount - droppedMipCount;
+
+        std::vector<TextureUploadRegion> regions;
+        Uint64 hostSize = getTextureCopyRegions(fullDesc, 0, droppedMipCount, regions);
+
+        auto trimmed = this->device->createTexture(trimmedDesc);
+        auto host = this->device->createBuffer(BufferDescriptor{ hostSize, kCopyUsage, BufferLocation::eHost });
+
+        if (trimmed == nullptr || host == nullptr) {
+            return;
+        }
+
+        // Regions are laid out mip by mip, so the mips dropped earlier form a prefix of the new buffer
+        if (resource->hostMips != nullptr) {
+            encoder->copyBufferToBuffer(resource->hostMips.get(), 0, host.get(), 0, resource->hostMips->desc.size);
+        }
+
+        transitionTexture(encoder, this->desc.consumerStage, ShaderStage::eTransfer, old, TextureState::eCopySrc);
+        transitionTexture(encoder, this->desc.consumerStage, ShaderStage::eTransfer, trimmed.get(), TextureState::eCopyDst);
+
+        for (const auto& region : regions) {
+            if (region.mipLevel < oldDropped) {
+                continue;
+            }
+
+            ImageCopyTexture source;
+            source.texture = old;
+            source.mipLevel = region.mipLevel - oldDropped;
+            source.origin.z = region.arrayLayer;
+
+            ImageCopyBuffer destination;
+            static_cast<ImageDataLayout&>(destination) = region.layout;
+            destination.buffer = host.get();
+
+            encoder->copyTextureToBuffer(source, destination, region.size);
+        }
+
+        for (Uint32 level = droppedMipCount; level < fullDesc.mipLevelCount; level++) {
+            for (Uint32 layer = 0; layer < fullDesc.sliceLayersNum; layer++) {
+                ImageCopyTexture source;
+                source.texture = old;
+                source.mipLevel = level - oldDropped;
+                source.origin.z = layer;
+
+                ImageCopyTexture destination;
+                destination.texture = trimmed.get();
+                destination.mipLevel = level - droppedMipCount;
+                destination.origin.z = layer;
+
+                encoder->copyTextureToTexture(source, destination, getMipExtent(fullDesc.size, level));
+            }
+        }
+
+        transitionTexture(encoder, ShaderStage::eTransfer, this->desc.consumerStage, trimmed.get(), TextureState::eShaderReadOnly);
+
+        this->retire(std::move(resource->texture));
+        this->retire(std::move(resource->hostMips));
+
+        resource->texture = std::move(trimmed);
+        resource->hostMips = std::move(host);
+        resource->droppedMipCount = droppedMipCount;
+
+        Uint64 deviceBytes = getTextureBytes(fullDesc, droppedMipCount);
+
+        stats.deviceBytes -= resource->deviceBytes - deviceBytes;
+        stats.evictedBytes += resource->deviceBytes - deviceBytes;
+
+        resource->deviceBytes = deviceBytes;
+        resource->hostBytes = hostSize;
+        resource->state = ResidencyState::eTrimmed;
+        resource->generation++;
+    }
+
+    void ResidencyManager::restoreTexture(ResidentTexture* resource, CommandEncoder* encoder, ResidencyStats& stats) {
+        const TextureDescriptor& fullDesc = resource->desc;
+        Uint32 dropped = resource->droppedMipCount;
+        Texture* old = resource->texture.get();
+
+        auto full = this->device->createTexture(fullDesc);
+        if (full == nullptr) {
+            return;
+        }
+
+        transitionTexture(encoder, this->desc.consumerStage, ShaderStage::eTransfer, old, TextureState::eCopySrc);
+        transitionTexture(encoder, this->desc.consumerStage, ShaderStage::eTransfer, full.get(), TextureState::eCopyDst);
+
+        std::vector<TextureUploadRegion> regions;
+        getTextureCopyRegions(fullDesc, 0, dropped, regions);
+
+        for (const auto& region : regions) {
+            ImageCopyBuffer source;
+            static_cast<ImageDataLayout&>(source) = region.layout;
+            source.buffer = resource->hostMips.get();
+
+            ImageCopyTexture destination;
+            destination.texture = full.get();
+            destination.mipLevel = region.mipLevel;
+            destination.origin.z = region.arrayLayer;
+
+            encoder->copyBufferToTexture(source, destination, region.size);
+        }
+
+        for (Uint32 level = dropped; level < fullDesc.mipLevelCount; level++) {
+            for (Uint32 layer = 0; layer < fullDesc.sliceLayersNum; layer++) {
+                ImageCopyTexture source;
+                source.texture = old;
+                source.mipLevel = level - dropped;
+                source.origin.z = layer;
+
+                ImageCopyTexture destination;
+                destination.texture = full.get();
+                destination.mipLevel = level;
+                destination.origin.z = layer;
+
+                encoder->copyTextureToTexture(source, destination, getMipExtent(fullDesc.size, level));
+            }
+        }
+
+        transitionTexture(encoder, ShaderStage::eTransfer, this->desc.consumerStage, full.get(), TextureState::eShaderReadOnly);
+
+        this->retire(std::move(resource->texture));
+        this->retire(std::move(resource->hostMips));
+
+        resource->texture = std::move(full);
+        resource->droppedMipCount = 0;
+
+        stats.deviceBytes += resource->fullBytes - resource->deviceBytes;
+        stats.restoredBytes += resource->fullBytes - resource->deviceBytes;
+
+        resource->deviceBytes = resource->fullBytes;
+        resource->hostBytes = 0;
+        resource->state = ResidencyState::eResident;
+        resource->generation++;
+    }
+
+    void ResidencyManager::retire(std::shared_ptr<void> object) {
+        if (object != nullptr) {
+            this->retired.emplace_back(this->getFrameIndex(), std::move(object));
+        }
+    }
+
+    void ResidencyManager::releaseRetired(Uint64 completedFrameIndex) {
+        auto released = std::remove_if(this->retired.begin(), this->retired.end(),
+            [completedFrameIndex](const std::pair<Uint64, std::shared_ptr<void>>& entry) {
+                return entry.first <= completedFrameIndex;
+            });
+
+        this->retired.erase(released, this->retired.end());
+    }
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include "rhi.hpp"
+
+#include <atomic>
+#include <mutex>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Residency
+    // ===========================================================================================================================
+
+    enum class ResidencyPriority : Uint8 {
+        eLow,
+        eNormal,
+        eHigh,
+
+        // Never evicted, for render targets and per-frame data
+        ePinned
+    };
+
+    enum class ResidencyState : Uint8 {
+        eResident,
+
+        // Buffer moved to a host buffer, still bindable at host memory speed
+        eDemoted,
+
+        // Texture with its largest mips dropped, the dropped mips wait in a host buffer
+        eTrimmed
+    };
+
+    struct ResidencyDescriptor {
+        // Device memory the managed resources may occupy
+        Uint64 budget = 512ull << 20;
+
+        // Frames a resource must go unused before it is evicted, at least the frames in flight
+        Uint32 minIdleFrames = 3;
+
+        // Trimming never leaves a texture with fewer mips than this
+        Uint32 minResidentMips = 1;
+
+        ShaderStage consumerStage = ShaderStage::eFragment;
+    };
+
+    struct ResidencyStats {
+        Uint64 budget = 0;
+        Uint64 deviceBytes = 0;
+        Uint64 hostBytes = 0;
+
+        // Moved during the last update
+        Uint64 evictedBytes = 0;
+        Uint64 restoredBytes = 0;
+
+        Uint32 residentCount = 0;
+        Uint32 demotedCount = 0;
+        Uint32 trimmedCount = 0;
+
+        // Set when nothing cold was left to evict, the working set itself exceeds the budget
+        bool overBudget = false;
+    };
+
+    class ResidencyManager;
+
+    class ResidentResource {
+    public:
+        ResidentResource(ResidencyManager* manager, ResidencyPriority priority) : manager{ manager }, priority{ priority } {}
+        virtual ~ResidentResource() = default;
+
+        ResidencyState getState() const { return this->state; }
+        ResidencyPriority getPriority() const { return this->priority; }
+        Uint64 getLastUsedFrame() const { return this->lastUsedFrame.load(std::memory_order_relaxed); }
+
+        // Bumped whenever the backing object is replaced. Views and bind groups made from an
+        // older generation reference a retired object and must be recreated.
+        Uint64 getGeneration() const { return this->generation; }
+
+    protected:
+        friend class ResidencyManager;
+
+        // Stamps the frame being recorded and queues a restore when not fully resident
+        void markUsed();
+
+        ResidencyManager* manager;
+        ResidencyPriority priority;
+        ResidencyState state = ResidencyState::eResident;
+
+        std::atomic<Uint64> lastUsedFrame{ 0 };
+        std::atomic<bool> restoreRequested{ false };
+        Uint64 generation = 0;
+
+        // Device bytes with every mip resident, and the bytes currently held on device and host
+        Uint64 fullBytes = 0;
+        Uint64 deviceBytes = 0;
+        Uint64 hostBytes = 0;
+    };
+
+    class ResidentBuffer : public ResidentResource {
+    public:
+        using ResidentResource::ResidentResource;
+
+        // Call while recording commands that use the buffer. A demoted buffer returns its host copy.
+        Buffer* acquire() {
+            this->markUsed();
+            return this->buffer.get();
+        }
+
+        Buffer* get() const { return this->buffer.get(); }
+
+    private:
+        friend class ResidencyManager;
+
+        BufferDescriptor desc;
+        std::shared_ptr<Buffer> buffer;
+    };
+
+    class ResidentTexture : public ResidentResource {
+    public:
+        using ResidentResource::ResidentResource;
+
+        // Call while recording commands that use the texture. A trimmed texture returns its
+        // smaller version, mip i of it is mip i + getDroppedMipCount() of the full texture.
+        Texture* acquire() {
+            this->markUsed();
+            return this->texture.get();
+        }
+
+        Texture* get() const { return this->texture.get(); }
+        Uint32 getDroppedMipCount() const { return this->droppedMipCount; }
+
+        // Mips [0, getDroppedMipCount()) laid out by getTextureCopyRegions, uploads of those go here
+        Buffer* getHostMips() const { return this->hostMips.get(); }
+
+    private:
+        friend class ResidencyManager;
+
+        TextureDescriptor desc;
+        std::shared_ptr<Texture> texture;
+
+        // Holds mips [0, droppedMipCount) laid out by getTextureCopyRegions
+        std::shared_ptr<Buffer> hostMips;
+        Uint32 droppedMipCount = 0;
+    };
+
+    // Keeps the device memory of the resources it creates under a budget. Resources stamp the
+    // frame on every acquire, update evicts the least recently used ones in priority order
+    // and restores evicted resources that were acquired again, recording the copies into the
+    // encoder it is given. Replaced objects stay alive until releaseRetired passes their frame.
+    //
+    // Resources allocated while over budget start in host memory (buffers) or with their
+    // largest mips in host memory (textures), and are restored by a later update once room has
+    // been made. Not thread safe except for acquire.
+    class ResidencyManager {
+    public:
+        ResidencyManager(Device* device, ResidencyDescriptor descriptor = {});
+
+        // Copy usages are added so the resource can be moved
+        std::shared_ptr<ResidentBuffer> createBuffer(BufferDescriptor descriptor, ResidencyPriority priority = ResidencyPriority::eNormal);
+        std::shared_ptr<ResidentTexture> createTexture(TextureDescriptor descriptor, ResidencyPriority priority = ResidencyPriority::eNormal);
+
+        // Record before the passes of frameIndex, acquires afterwards are stamped with frameIndex
+        ResidencyStats update(CommandEncoder* encoder, Uint64 frameIndex);
+
+        // Drops replaced objects whose copies were recorded on or before completedFrameIndex
+        void releaseRetired(Uint64 completedFrameIndex);
+
+        void setBudget(Uint64 budget) { this->desc.budget = budget; }
+
+        Uint64 getFrameIndex() const { return this->frameIndex.load(std::memory_order_relaxed); }
+
+    private:
+        void prune();
+        Uint64 getDeviceBytes() const;
+
+        // Evicts cold resources until bytes more fit into the budget, false if not enough could be freed
+        bool makeRoom(Uint64 bytes, CommandEncoder* encoder, std::vector<ResidentResource*>& candidates, size_t& next,
+            ResidencyStats& stats);
+
+        void demoteBuffer(ResidentBuffer* resource, CommandEncoder* encoder, ResidencyStats& stats);
+        void restoreBuffer(ResidentBuffer* resource, CommandEncoder* encoder, ResidencyStats& stats);
+
+        Uint32 getDroppableMipCount(const ResidentTexture* resource) const;
+        void trimTexture(ResidentTexture* resource, Uint32 droppedMipCount, CommandEncoder* encoder, ResidencyStats& stats);
+        void restoreTexture(ResidentTexture* resource, CommandEncoder* encoder, ResidencyStats& stats);
+
+        void retire(std::shared_ptr<void> object);
+
+        Device* device;
+        ResidencyDescriptor desc;
+
+        std::atomic<Uint64> frameIndex{ 0 };
+
+        std::vector<std::weak_ptr<ResidentBuffer>> buffers;
+        std::vector<std::weak_ptr<ResidentTexture>> textures;
+
+        std::vector<std::pair<Uint64, std::shared_ptr<void>>> retired;
+    };
+};
@@ -3,9 +3,24 @@
 #include <string>
 #include <memory>
 #include <vector>
-#include <map>
+#include <climits>
+#include <cstdint>
 
 namespace Rhi {
+    // ===========================================================================================================================
+    // Class Definition
+    // ===========================================================================================================================
+
+    class Buffer;
+    class Texture;
+    class TextureView;
+    class CommandEncoder;
+    class RenderPassEncoder;
+    class ComputePassEncoder;
+
+    struct RenderPassDescriptor;
+    struct ComputePassDescriptor;
+
     // ===========================================================================================================================
     // Basic Type
     // ===========================================================================================================================
@@ -101,6 +116,7 @@ namespace Rhi {
     };
 
     class Buffer {
+    public:
         BufferDescriptor desc;
 
         ActiveBufferMapping currentMapping;
@@ -308,13 +324,18 @@ namespace Rhi {
     };
 
     class Texture {
+    public:
         TextureDescriptor desc;
         TextureState state;
+
+        // Per mip and array layer, mip major. Empty while every subresource is in state.
+        std::vector<TextureState> subresourceStates;
         
         virtual std::shared_ptr<TextureView> createView(TextureViewDescriptor descriptor) = 0;
     };
 
     class TextureView {
+    public:
         TextureViewDescriptor desc;
         Texture* texture;
     }; 
@@ -334,7 +355,7 @@ namespace Rhi {
         eLinear
     };
 
-    enum MipmapFilterMode : Uint8 {
+    enum class MipmapFilterMode : Uint8 {
         eNearest,
         eLinear
     };
@@ -365,6 +386,7 @@ namespace Rhi {
     };
 
     class Sampler {
+    public:
         SamplerDescriptor desc;
 
         bool isComparison;
@@ -382,6 +404,11 @@ namespace Rhi {
         eTessellation    = 0x0008,
         eTask            = 0x0010,
         eMesh            = 0x0020,
+
+        // Barrier stages only, never a shader visibility. Copies and clears run at eTransfer,
+        // reads and writes through a mapped buffer at eHost.
+        eTransfer        = 0x0040,
+        eHost            = 0x0080
     };
 
     enum class BufferBindingType : Uint8 {
@@ -432,24 +459,29 @@ namespace Rhi {
         TextureFormat format;
     };
 
+    enum class BindingType : Uint8 {
+        eBuffer,
+        eSampler,
+        eTexture,
+        eStorageTexture
+    };
+
+    // Only the layout selected by type is read
     struct BindGroupLayoutEntry {
         Uint32 binding;
         ShaderStageFlags visibility;
-    };
+        BindingType type = BindingType::eBuffer;
 
-    struct BufferBindGroupLayoutEntry : BindGroupLayoutEntry {
-        BufferBindingLayout buffer;
-    };
+        // Descriptor array size, 0 for a runtime sized array
+        Uint32 count = 1;
 
-    struct SamplerBindGroupLayoutEntry : BindGroupLayoutEntry {
-        SamplerBindingLayout sampler;
-    };
+        // Elements may stay unwritten as long as shaders never access them, and elements not used
+        // by pending work may be rewritten with Device::updateBindGroup while the group is bound
+        bool partiallyBound = false;
 
-    struct TextureBindGroupLayoutEntry : BindGroupLayoutEntry {
+        BufferBindingLayout buffer;
+        SamplerBindingLayout sampler;
         TextureBindingLayout texture;
-    };
-
-    struct StorageTextureBindGroupLayoutEntry : BindGroupLayoutEntry {
         StorageTextureBindingLayout storageTexture;
     };
 
@@ -458,45 +490,51 @@ namespace Rhi {
     };
 
     class BindGroupLayout {
+    public:
         BindGroupLayoutDescriptor desc;
     };
 
     struct BufferBinding {
-        Buffer* buffer;
+        Buffer* buffer = nullptr;
         Uint64 size = ULLONG_MAX;
         Uint64 offset = 0;
     };
 
+    // The layout entry with the same binding decides which resource is used
     struct BindGroupEntry {
         Uint32 binding;
-    };
 
-    struct BufferBindGroupEntry : BindGroupEntry {
-        BufferBinding resource;
-    };
+        // Element of a descriptor array binding
+        Uint32 arrayElement = 0;
 
-    struct TextureBindGroupEntry : BindGroupEntry {
-        TextureView* resource;
-    };
-
-    struct SamplerBindGroupEntry : BindGroupEntry {
-        Sampler* resource;
+        BufferBinding buffer{};
+        TextureView* textureView = nullptr;
+        Sampler* sampler = nullptr;
     };
 
     struct BindGroupDescriptor {
         BindGroupLayout* layout;
-        std::vector<BindGroupEntry*> entries;
+        std::vector<BindGroupEntry> entries;
+    };
+
+    struct PushConstantRange {
+        ShaderStageFlags visibility;
+        Uint32 offset;
+        Uint32 size;
     };
 
     struct PipelineLayoutDescriptor {
         std::vector<BindGroupLayout*> bindGroupLayouts;
+        std::vector<PushConstantRange> pushConstantRanges;
     };
 
     class BindGroup {
+    public:
         BindGroupDescriptor desc;
     };
 
     class PipelineLayout {
+    public:
         PipelineLayoutDescriptor desc;
     };
 
@@ -520,7 +558,7 @@ namespace Rhi {
     };
 
     struct CompilationInfo {
-        CompilationMessage messages[];
+        std::vector<CompilationMessage> messages;
     };
 
     struct ShaderModuleCompilationHint {
@@ -530,10 +568,15 @@ namespace Rhi {
 
     struct ShaderModuleDescriptor {
         String code;
+
+        // Byte size of code when it holds a SPIR-V binary, 0 for null terminated source
+        Uint64 codeSize = 0;
+
         std::vector<ShaderModuleCompilationHint> compilationHints{};
     };
 
     class ShaderModule {
+    public:
         ShaderModuleDescriptor desc;
 
         virtual CompilationInfo getCompilationInfo() = 0;
@@ -595,7 +638,7 @@ namespace Rhi {
         eTriangleStrip
     };
 
-    enum IndexFormat : Uint8 {
+    enum class IndexFormat : Uint8 {
         eUint16,
         eUint32
     };
@@ -634,7 +677,7 @@ namespace Rhi {
         eMax
     };
 
-    enum BlendFactor : Uint8 {
+    enum class BlendFactor : Uint8 {
         eZero,
         eOne,
         eSrc,
@@ -667,10 +710,25 @@ namespace Rhi {
         const char* message;
     };
 
+    struct SpecializationConstant {
+        // SpecId decoration of the constant, constant_id in GLSL
+        Uint32 id;
+        Float64 value;
+    };
+
+    // Sorted by id without duplicates. Blocks from SpecializationBlockPool are interned, so
+    // equal constant sets share one block and compare by pointer.
+    struct SpecializationBlock {
+        std::vector<SpecializationConstant> constants;
+        Uint64 hash = 0;
+    };
+
     struct ProgrammableStage {
         ShaderModule* module;
         const char* entryPoint;
-        std::map<const char*, Float64> constants;
+
+        // nullptr keeps the default values declared in the shader
+        const SpecializationBlock* constants = nullptr;
     };
 
     struct VertexAttribute {
@@ -756,7 +814,8 @@ namespace Rhi {
     };
 
     struct PipelineDescriptorBase {
-        PipelineLayout layout;
+        // nullptr derives the layout from shader reflection
+        PipelineLayout* layout = nullptr;
     };
 
     struct ComputePipelineDescriptor : PipelineDescriptorBase {
@@ -774,14 +833,26 @@ namespace Rhi {
     };
 
     class PipelineBase {
-        virtual BindGroupLayout getBindGroupLayout(uint32_t index) = 0;
+    public:
+        // Explicit layout from the descriptor, or the one derived from shader reflection
+        PipelineLayout* layout = nullptr;
+
+        virtual BindGroupLayout* getBindGroupLayout(uint32_t index) {
+            if (this->layout == nullptr || index >= this->layout->desc.bindGroupLayouts.size()) {
+                return nullptr;
+            }
+
+            return this->layout->desc.bindGroupLayouts[index];
+        }
     };
 
-    class ComputePipeline : PipelineBase {
+    class ComputePipeline : public PipelineBase {
+    public:
         ComputePipelineDescriptor desc;
     };
 
-    class RenderPipeline : PipelineBase {
+    class RenderPipeline : public PipelineBase {
+    public:
         RenderPipelineDescriptor desc;
 
         bool writesDepth;
@@ -831,9 +902,19 @@ namespace Rhi {
     // Barrier
     // ===========================================================================================================================
 
+    // A split barrier starts the transition with eBegin and completes it with an identical eEnd
+    // barrier later, work recorded in between can overlap it. Backends without split barriers
+    // skip eBegin and treat eEnd as a full barrier.
+    enum class BarrierSplit : Uint8 {
+        eNone,
+        eBegin,
+        eEnd
+    };
+
     struct MemoryBarrier {
         ResourceAccess srcAccess;
         ResourceAccess dstAccess;
+        BarrierSplit split = BarrierSplit::eNone;
     };
 
     struct BufferBarrier : MemoryBarrier {
@@ -850,7 +931,11 @@ namespace Rhi {
         TextureState dstState;
     };
 
+    // srcStage is the work that produced the data, dstStage the work that consumes it. A copy
+    // feeding a shader is eTransfer to that shader stage, a copy read back on the CPU is eTransfer
+    // to eHost.
     class BarrierCommandsMixin {
+    public:
         virtual void activatePipelineBarrier(
             ShaderStage srcStage,
             ShaderStage dstStage
@@ -867,6 +952,14 @@ namespace Rhi {
             ShaderStage dstStage,
             ImageBarrier desc
         ) = 0;
+
+        // Records every barrier in one call. The stages may be several ShaderStage bits or'ed together.
+        virtual void activateBarriers(
+            ShaderStage srcStage,
+            ShaderStage dstStage,
+            const std::vector<BufferBarrier>& bufferBarriers,
+            const std::vector<ImageBarrier>& imageBarriers
+        ) = 0;
     };
 
     // ===========================================================================================================================
@@ -880,17 +973,21 @@ namespace Rhi {
     };
 
     class CommandsMixin {
+    public:
         CommandState state;
     };
 
-    class CommandEncoder : CommandsMixin, BarrierCommandsMixin {
+    class CommandEncoder : public CommandsMixin, public BarrierCommandsMixin {
+    public:
+        // The pass encoder belongs to this encoder and is only valid until its end(), backends
+        // may hand out the same object for every pass
         virtual std::shared_ptr<RenderPassEncoder> beginRenderPass(RenderPassDescriptor descriptor) = 0;
         virtual std::shared_ptr<ComputePassEncoder> beginComputePass(ComputePassDescriptor descriptor) = 0;
 
         virtual void copyBufferToBuffer(
-            Buffer source,
+            Buffer* source,
             Uint64 sourceOffset,
-            Buffer destination,
+            Buffer* destination,
             Uint64 destinationOffset,
             Uint64 size) = 0;
 
@@ -910,18 +1007,22 @@ namespace Rhi {
             Extent3D copySize) = 0;
 
         virtual void clearBuffer(
-            Buffer buffer,
+            Buffer* buffer,
             Uint64 offset = 0,
-            Uint64 size) = 0;
+            Uint64 size = ULLONG_MAX) = 0;
 
         virtual void resolveQuerySet(
             QuerySet querySet,
             Uint32 firstQuery,
             Uint32 queryCount,
-            Buffer destination,
+            Buffer* destination,
             Uint64 destinationOffset) = 0;
 
         virtual void finish() = 0;
+
+        // Drops the recorded commands and reopens the encoder, keeping its memory for the next
+        // recording. Every submission of the previous recording must have completed.
+        virtual void reset() = 0;
     };
 
     // ===========================================================================================================================
@@ -929,10 +1030,16 @@ namespace Rhi {
     // ===========================================================================================================================
 
     class BindingCommandsMixin {
-        virtual void setBindGroup(Uint32 index, BindGroup bindGroup, std::vector<Uint32> dynamicOffsets) = 0;
+    public:
+        virtual void setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets = {}) = 0;
 
-        virtual void setBindGroup(Uint32 index, BindGroup bindGroup, Uint32 dynamicOffsetsData[],
+        virtual void setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
             Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength) = 0;
+
+        // Writes bytes [offset, offset + size) of the push constant block, which must lie inside
+        // ranges of the pipeline layout visible to the given stages. The data is copied into
+        // the command stream, so small per-draw values need no buffer write or bind.
+        virtual void setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) = 0;
     };
 
     // ===========================================================================================================================
@@ -949,13 +1056,14 @@ namespace Rhi {
         ComputePassTimestampWrites timestampWrites;
     };
 
-    class ComputePassEncoder : CommandsMixin, BindingCommandsMixin {
+    class ComputePassEncoder : public CommandsMixin, public BindingCommandsMixin {
+    public:
         ComputePassDescriptor desc;
         CommandEncoder* commandEncoder;
 
         virtual void setPipeline(ComputePipeline* pipeline) = 0;
         virtual void dispatchWorkgroups(Uint32 workgroupCountX, Uint32 workgroupCountY = 1, Uint32 workgroupCountZ = 1) = 0;
-        virtual void dispatchWorkgroupsIndirect(Buffer indirectBuffer, Uint64 indirectOffset) = 0;
+        virtual void dispatchWorkgroupsIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) = 0;
 
         virtual void end() = 0;
     };
@@ -1004,10 +1112,11 @@ namespace Rhi {
     };
 
     class RenderCommandsMixin {
-        virtual void setPipeline(RenderPipeline pipeline) = 0;
+    public:
+        virtual void setPipeline(RenderPipeline* pipeline) = 0;
 
-        virtual void setIndexBuffer(Buffer buffer, IndexFormat indexFormat, Uint64 offset = 0, Uint64 size) = 0;
-        virtual void setVertexBuffer(Uint32 slot, Buffer buffer, Uint64 offset = 0, Uint64 size) = 0;
+        virtual void setIndexBuffer(Buffer* buffer, IndexFormat indexFormat, Uint64 offset = 0, Uint64 size = ULLONG_MAX) = 0;
+        virtual void setVertexBuffer(Uint32 slot, Buffer* buffer, Uint64 offset = 0, Uint64 size = ULLONG_MAX) = 0;
 
         virtual void draw(Uint32 vertexCount, Uint32 instanceCount = 1, 
             Uint32 firstVertex = 0, Uint32 firstInstance = 0) = 0;
@@ -1015,8 +1124,8 @@ namespace Rhi {
             Uint32 firstIndex = 0, Int32 baseVertex = 0,
             Uint32 firstInstance = 0) = 0;
 
-        virtual void drawIndirect(Buffer indirectBuffer, Uint64 indirectOffset) = 0;
-        virtual void drawIndexedIndirect(Buffer indirectBuffer, Uint64 indirectOffset) = 0;
+        virtual void drawIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) = 0;
+        virtual void drawIndexedIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) = 0;
     };
 
     struct RenderPassDescriptor {
@@ -1027,7 +1136,8 @@ namespace Rhi {
         Uint64 maxDrawCount = 50000000;
     };
 
-    class RenderPassEncoder : CommandsMixin, BindingCommandsMixin, RenderCommandsMixin {
+    class RenderPassEncoder : public CommandsMixin, public BindingCommandsMixin, public RenderCommandsMixin {
+    public:
         RenderPassDescriptor desc;
         CommandEncoder* commandEncoder;
 
@@ -1047,6 +1157,25 @@ namespace Rhi {
         virtual void end() = 0;
     }; 
 
+    // ===========================================================================================================================
+    // Queue
+    // ===========================================================================================================================
+
+    class Queue {
+    public:
+        // Encoders must be finished, they execute in the given order
+        virtual void submit(const std::vector<CommandEncoder*>& commandEncoders) = 0;
+
+        // data is copied before the call returns, the write lands ahead of the next submit
+        virtual void writeBuffer(Buffer* buffer, Uint64 bufferOffset, const void* data, Uint64 size) = 0;
+
+        virtual void writeTexture(ImageCopyTexture destination, const void* data, Uint64 dataSize,
+            ImageDataLayout dataLayout, Extent3D size) = 0;
+
+        // Blocks until all submitted work has finished
+        virtual void waitIdle() = 0;
+    };
+
     // ===========================================================================================================================
     // Device
     // ===========================================================================================================================
@@ -1084,6 +1213,7 @@ namespace Rhi {
         unsigned long maxBindGroups;
         unsigned long maxBindGroupsPlusVertexBuffers;
         unsigned long maxBindingsPerBindGroup;
+        unsigned long maxPushConstantsSize;
         unsigned long maxDynamicUniformBuffersPerPipelineLayout;
         unsigned long maxDynamicStorageBuffersPerPipelineLayout;
         unsigned long maxSampledTexturesPerShaderStage;
@@ -1110,24 +1240,82 @@ namespace Rhi {
         unsigned long maxComputeWorkgroupsPerDimension;
     };
 
+    enum class DeviceMode : Uint8 {
+        eGraphics,
+
+        // Compute queue only, no surface or graphics state is set up. The device creates buffers,
+        // shader modules, bind groups and compute pipelines, textures, samplers, render pipelines
+        // and render passes come back null.
+        eComputeOnly
+    };
+
     struct DeviceDescriptor {
         SupportedFeatures requiredFeatures;
         SupportedLimits requiredLimits;
         DeviceInfo info;
+        DeviceMode mode = DeviceMode::eGraphics;
     };
 
     class Device {
+    public:
         DeviceDescriptor desc;
 
+        virtual Queue* getQueue() = 0;
+
+        virtual std::shared_ptr<Buffer> createBuffer(BufferDescriptor descriptor) = 0;
+        virtual std::shared_ptr<Texture> createTexture(TextureDescriptor descriptor) = 0;
+        virtual std::shared_ptr<Sampler> createSampler(SamplerDescriptor descriptor) = 0;
+
+        virtual std::shared_ptr<BindGroup> createBindGroup(BindGroupDescriptor descriptor) = 0;
+
+        // Rewrites elements of an existing group. Unless the binding is partiallyBound, the group
+        // must not be in use by pending work.
+        virtual void updateBindGroup(BindGroup* bindGroup, const std::vector<BindGroupEntry>& entries) = 0;
+
+        virtual std::shared_ptr<BindGroupLayout> createBindGroupLayout(BindGroupLayoutDescriptor descriptor) = 0;
+        virtual std::shared_ptr<PipelineLayout> createPipelineLayout(PipelineLayoutDescriptor descriptor) = 0;
+
+        // Backends only accept SPIR-V, GLSL source goes through ShaderCache::createShaderModule
+        virtual std::shared_ptr<ShaderModule> createShaderModule(ShaderModuleDescriptor descriptor) = 0;
 
+        virtual std::shared_ptr<ComputePipeline> createComputePipeline(ComputePipelineDescriptor descriptor) = 0;
+        virtual std::shared_ptr<RenderPipeline> createRenderPipeline(RenderPipelineDescriptor descriptor) = 0;
+
+        virtual std::shared_ptr<CommandEncoder> createCommandEncoder() = 0;
     };
 
     // ===========================================================================================================================
     // Adapter
     // ===========================================================================================================================
 
+    enum class AdapterType : Uint8 {
+        eDiscreteGpu,
+        eIntegratedGpu,
+        eVirtualGpu,
+        eCpu,
+        eUnknown
+    };
+
+    struct AdapterDescriptor {
+        SupportedFeatures features;
+        SupportedLimits limits;
+        DeviceInfo info;
+        AdapterType type;
+    };
+
     class Adapter {
-        virtual std::shared_ptr<Device> requestDevice() = 0;
+    public:
+        AdapterDescriptor desc;
+
+        // The device reports the adapter's features and limits in its desc
+        virtual std::shared_ptr<Device> requestDevice(DeviceMode mode = DeviceMode::eGraphics) = 0;
+    };
+
+    class Instance {
+    public:
+        // Every adapter of the backend, in the order the driver reports them. rankAdapters
+        // orders them by capability.
+        virtual std::vector<std::shared_ptr<Adapter>> enumerateAdapters() = 0;
     };
 };
 
@@ -146,6 +146,7 @@ class GPUBuffer {
 // Texture
 // ===========================================================================================================================
 
+// Same formats in the same order as Rhi::TextureFormat, format_traits.hpp indexes its table with either
 enum GPUTextureFormat : uint8_t {
     // 8-bit formats
     R8_UNORM,
@@ -0,0 +1,581 @@
+#include "rhi_stats.hpp"
+#include "copy_footprint.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace Rhi {
+    namespace {
+        const char* const kCounterNames[kStatsCounterCount] = {
+            "draws", "indirectDraws", "dispatches", "indirectDispatches", "renderPasses", "computePasses",
+            "pipelineChanges", "bindGroupSets", "vertexBufferSets", "indexBufferSets", "pushConstantUpdates",
+            "dynamicStateChanges", "barriers", "transfers", "submits", "submittedEncoders", "writeBufferBytes",
+            "writeTextureBytes"
+        };
+
+        const char* const kObjectNames[kStatsObjectCount] = {
+            "buffers", "textures", "samplers", "bindGroups", "bindGroupLayouts", "pipelineLayouts", "shaderModules",
+            "computePipelines", "renderPipelines", "commandEncoders"
+        };
+
+        const char* const kHeapNames[kStatsHeapCount] = { "deviceLocal", "host" };
+
+        Uint64 getTextureMemorySize(const TextureDescriptor& desc) {
+            Uint64 size = 0;
+
+            for (Uint32 level = 0; level < desc.mipLevelCount; level++) {
+                size += getCopyFootprint(desc.format, getMipExtent(desc.size, level), 1).size;
+            }
+
+            return size * desc.sliceLayersNum * desc.sampleCount;
+        }
+
+        template <typename... Args>
+        void appendFormat(std::string& text, const char* format, Args... args) {
+            char buffer[128];
+            int length = std::snprintf(buffer, sizeof(buffer), format, args...);
+
+            text.append(buffer, static_cast<size_t>(std::max(0, std::min<int>(length, sizeof(buffer) - 1))));
+        }
+    };
+
+    const char* getStatsCounterName(StatsCounter counter) {
+        return kCounterNames[static_cast<Uint32>(counter)];
+    }
+
+    const char* getStatsObjectName(StatsObject object) {
+        return kObjectNames[static_cast<Uint32>(object)];
+    }
+
+    const char* getStatsHeapName(StatsHeap heap) {
+        return kHeapNames[static_cast<Uint32>(heap)];
+    }
+
+    // ===========================================================================================================================
+    // Counters
+    // ===========================================================================================================================
+
+    Uint32 StatsCounters::getThreadShard() {
+        static std::atomic<Uint32> nextShard{ 0 };
+        thread_local Uint32 shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kShardCount;
+
+        return shard;
+    }
+
+    void StatsCounters::add(const Uint64* values) {
+        Shard& shard = this->shards[getThreadShard()];
+
+        for (Uint32 i = 0; i < kStatsCounterCount; i++) {
+            if (values[i] != 0) {
+                shard.values[i].fetch_add(values[i], std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void StatsCounters::collect(Uint64* totals) {
+        std::fill(totals, totals + kStatsCounterCount, 0);
+
+        for (Shard& shard : this->shards) {
+            for (Uint32 i = 0; i < kStatsCounterCount; i++) {
+                totals[i] += shard.values[i].exchange(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // ===========================================================================================================================
+    // Reports
+    // ===========================================================================================================================
+
+    void StatsReport::add(const StatsFrame& frame) {
+        if (this->frameCount == 0) {
+            this->firstFrame = frame.frameIndex;
+        }
+
+        this->frameCount++;
+
+        for (Uint32 i = 0; i < kStatsCounterCount; i++) {
+            this->totals[i] += frame.counters[i];
+            this->peaks[i] = std::max(this->peaks[i], frame.counters[i]);
+        }
+
+        std::copy(frame.liveObjects, frame.liveObjects + kStatsObjectCount, this->liveObjects);
+        std::copy(frame.heapBytes, frame.heapBytes + kStatsHeapCount, this->heapBytes);
+    }
+
+    std::string formatStatsText(const StatsReport& report) {
+        Uint32 frames = std::max<Uint32>(1, report.frameCount);
+        std::string text;
+
+        appendFormat(text, "frames %llu+%lu:", report.firstFrame, report.frameCount);
+
+        for (Uint32 i = 0; i < kStatsCounterCount; i++) {
+            appendFormat(text, " %s %llu/%llu", kCounterNames[i], report.totals[i] / frames, report.peaks[i]);
+        }
+
+        for (Uint32 i = 0; i < kStatsObjectCount; i++) {
+            appendFormat(text, " %s %lld", kObjectNames[i], report.liveObjects[i]);
+        }
+
+        for (Uint32 i = 0; i < kStatsHeapCount; i++) {
+            appendFormat(text, " %sBytes %lld", kHeapNames[i], report.heapBytes[i]);
+        }
+
+        return text;
+    }
+
+    std::string formatStatsJson(const StatsReport& report) {
+        Uint32 frames = std::max<Uint32>(1, report.frameCount);
+        std::string json;
+
+        appendFormat(json, "{\"firstFrame\":%llu,\"frameCount\":%lu,\"counters\":{", report.firstFrame,
+            report.frameCount);
+
+        for (Uint32 i = 0; i < kStatsCounterCount; i++) {
+            if (i > 0) {
+                json += ',';
+            }
+
+            appendFormat(json, "\"%s\":{\"mean\":%llu,\"peak\":%llu}", kCounterNames[i], report.totals[i] / frames,
+                report.peaks[i]);
+        }
+
+        json += "},\"liveObjects\":{";
+
+        for (Uint32 i = 0; i < kStatsObjectCount; i++) {
+            if (i > 0) {
+                json += ',';
+            }
+
+            appendFormat(json, "\"%s\":%lld", kObjectNames[i], report.liveObjects[i]);
+        }
+
+        json += "},\"heapBytes\":{";
+
+        for (Uint32 i = 0; i < kStatsHeapCount; i++) {
+            if (i > 0) {
+                json += ',';
+            }
+
+            appendFormat(json, "\"%s\":%lld", kHeapNames[i], report.heapBytes[i]);
+        }
+
+        json += "}}";
+        return json;
+    }
+
+    // ===========================================================================================================================
+    // Pass Encoders
+    // ===========================================================================================================================
+
+    void StatsComputePassEncoder::setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets) {
+        this->encoder->count(StatsCounter::eBindGroupSets);
+        this->inner->setBindGroup(index, bindGroup, dynamicOffsets);
+    }
+
+    void StatsComputePassEncoder::setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
+        Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength)
+    {
+        this->encoder->count(StatsCounter::eBindGroupSets);
+        this->inner->setBindGroup(index, bindGroup, dynamicOffsetsData, dynamicOffsetsDataStart, dynamicOffsetsDataLength);
+    }
+
+    void StatsComputePassEncoder::setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) {
+        this->encoder->count(StatsCounter::ePushConstantUpdates);
+        this->inner->setPushConstants(visibility, offset, size, data);
+    }
+
+    void StatsComputePassEncoder::setPipeline(ComputePipeline* pipeline) {
+        this->encoder->count(StatsCounter::ePipelineChanges);
+        this->inner->setPipeline(pipeline);
+    }
+
+    void StatsComputePassEncoder::dispatchWorkgroups(Uint32 workgroupCountX, Uint32 workgroupCountY, Uint32 workgroupCountZ) {
+        this->encoder->count(StatsCounter::eDispatches);
+        this->inner->dispatchWorkgroups(workgroupCountX, workgroupCountY, workgroupCountZ);
+    }
+
+    void StatsComputePassEncoder::dispatchWorkgroupsIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) {
+        this->encoder->count(StatsCounter::eIndirectDispatches);
+        this->inner->dispatchWorkgroupsIndirect(indirectBuffer, indirectOffset);
+    }
+
+    void StatsComputePassEncoder::end() {
+        this->inner->end();
+        this->state = this->inner->state;
+        this->encoder->state = this->encoder->getInner()->state;
+
+        this->inner.reset();
+    }
+
+    void StatsRenderPassEncoder::setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets) {
+        this->encoder->count(StatsCounter::eBindGroupSets);
+        this->inner->setBindGroup(index, bindGroup, dynamicOffsets);
+    }
+
+    void StatsRenderPassEncoder::setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
+        Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength)
+    {
+        this->encoder->count(StatsCounter::eBindGroupSets);
+        this->inner->setBindGroup(index, bindGroup, dynamicOffsetsData, dynamicOffsetsDataStart, dynamicOffsetsDataLength);
+    }
+
+    void StatsRenderPassEncoder::setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) {
+        this->encoder->count(StatsCounter::ePushConstantUpdates);
+        this->inner->setPushConstants(visibility, offset, size, data);
+    }
+
+    void StatsRenderPassEncoder::setPipeline(RenderPipeline* pipeline) {
+        this->encoder->count(StatsCounter::ePipelineChanges);
+        this->inner->setPipeline(pipeline);
+    }
+
+    void StatsRenderPassEncoder::setIndexBuffer(Buffer* buffer, IndexFormat indexFormat, Uint64 offset, Uint64 size) {
+        this->encoder->count(StatsCounter::eIndexBufferSets);
+        this->inner->setIndexBuffer(buffer, indexFormat, offset, size);
+    }
+
+    void StatsRenderPassEncoder::setVertexBuffer(Uint32 slot, Buffer* buffer, Uint64 offset, Uint64 size) {
+        this->encoder->count(StatsCounter::eVertexBufferSets);
+        this->inner->setVertexBuffer(slot, buffer, offset, size);
+    }
+
+    void StatsRenderPassEncoder::draw(Uint32 vertexCount, Uint32 instanceCount, Uint32 firstVertex, Uint32 firstInstance) {
+        this->encoder->count(StatsCounter::eDraws);
+        this->inner->draw(vertexCount, instanceCount, firstVertex, firstInstance);
+    }
+
+    void StatsRenderPassEncoder::drawIndexed(Uint32 indexCount, Uint32 instanceCount, Uint32 firstIndex, Int32 baseVertex,
+        Uint32 firstInstance)
+    {
+        this->encoder->count(StatsCounter::eDraws);
+        this->inner->drawIndexed(indexCount, instanceCount, firstIndex, baseVertex, firstInstance);
+    }
+
+    void StatsRenderPassEncoder::drawIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) {
+        this->encoder->count(StatsCounter::eIndirectDraws);
+        this->inner->drawIndirect(indirectBuffer, indirectOffset);
+    }
+
+    void StatsRenderPassEncoder::drawIndexedIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) {
+        this->encoder->count(StatsCounter::eIndirectDraws);
+        this->inner->drawIndexedIndirect(indirectBuffer, indirectOffset);
+    }
+
+    void StatsRenderPassEncoder::setViewport(float x, float y, float width, float height, float minDepth, float maxDepth) {
+        this->encoder->count(StatsCounter::eDynamicStateChanges);
+        this->inner->setViewport(x, y, width, height, minDepth, maxDepth);
+    }
+
+    void StatsRenderPassEncoder::setScissorRect(Uint32 x, Uint32 y, Uint32 width, Uint32 height) {
+        this->encoder->count(StatsCounter::eDynamicStateChanges);
+        this->inner->setScissorRect(x, y, width, height);
+    }
+
+    void StatsRenderPassEncoder::setBlendConstant(Color color) {
+        this->encoder->count(StatsCounter::eDynamicStateChanges);
+        this->inner->setBlendConstant(color);
+    }
+
+    void StatsRenderPassEncoder::setStencilReference(Uint32 reference) {
+        this->encoder->count(StatsCounter::eDynamicStateChanges);
+        this->inner->setStencilReference(reference);
+    }
+
+    void StatsRenderPassEncoder::beginOcclusionQuery(Uint32 queryIndex) {
+        this->inner->beginOcclusionQuery(queryIndex);
+    }
+
+    void StatsRenderPassEncoder::endOcclusionQuery() {
+        this->inner->endOcclusionQuery();
+    }
+
+    void StatsRenderPassEncoder::end() {
+        this->inner->end();
+        this->state = this->inner->state;
+        this->encoder->state = this->encoder->getInner()->state;
+
+        this->inner.reset();
+    }
+
+    // ===========================================================================================================================
+    // Command Encoder
+    // ===========================================================================================================================
+
+    StatsCommandEncoder::StatsCommandEncoder(StatsDevice* device, std::shared_ptr<CommandEncoder> inner)
+        : device{ device }, inner{ inner }
+    {
+        this->state = inner->state;
+        this->device->addObject(StatsObject::eCommandEncoder, 1);
+    }
+
+    StatsCommandEncoder::~StatsCommandEncoder() {
+        this->device->addObject(StatsObject::eCommandEncoder, -1);
+    }
+
+    std::shared_ptr<RenderPassEncoder> StatsCommandEncoder::beginRenderPass(RenderPassDescriptor descriptor) {
+        this->renderPass.inner = this->inner->beginRenderPass(descriptor);
+        if (this->renderPass.inner == nullptr) {
+            return nullptr;
+        }
+
+        this->count(StatsCounter::eRenderPasses);
+        this->renderPass.desc = this->renderPass.inner->desc;
+        this->renderPass.commandEncoder = this;
+        this->renderPass.state = this->renderPass.inner->state;
+        this->state = this->inner->state;
+
+        // Non owning, the pass lives inside the encoder
+        return std::shared_ptr<RenderPassEncoder>(std::shared_ptr<RenderPassEncoder>{}, &this->renderPass);
+    }
+
+    std::shared_ptr<ComputePassEncoder> StatsCommandEncoder::beginComputePass(ComputePassDescriptor descriptor) {
+        this->count(StatsCounter::eComputePasses);
+
+        this->computePass.inner = this->inner->beginComputePass(descriptor);
+        this->computePass.desc = this->computePass.inner->desc;
+        this->computePass.commandEncoder = this;
+        this->computePass.state = this->computePass.inner->state;
+        this->state = this->inner->state;
+
+        return std::shared_ptr<ComputePassEncoder>(std::shared_ptr<ComputePassEncoder>{}, &this->computePass);
+    }
+
+    void StatsCommandEncoder::copyBufferToBuffer(Buffer* source, Uint64 sourceOffset, Buffer* destination, Uint64 destinationOffset,
+        Uint64 size)
+    {
+        this->count(StatsCounter::eTransfers);
+        this->inner->copyBufferToBuffer(source, sourceOffset, destination, destinationOffset, size);
+    }
+
+    void StatsCommandEncoder::copyBufferToTexture(ImageCopyBuffer source, ImageCopyTexture destination, Extent3D copySize) {
+        this->count(StatsCounter::eTransfers);
+        this->inner->copyBufferToTexture(source, destination, copySize);
+    }
+
+    void StatsCommandEncoder::copyTextureToBuffer(ImageCopyTexture source, ImageCopyBuffer destination, Extent3D copySize) {
+        this->count(StatsCounter::eTransfers);
+        this->inner->copyTextureToBuffer(source, destination, copySize);
+    }
+
+    void StatsCommandEncoder::copyTextureToTexture(ImageCopyTexture source, ImageCopyTexture destination, Extent3D copySize) {
+        this->count(StatsCounter::eTransfers);
+        this->inner->copyTextureToTexture(source, destination, copySize);
+    }
+
+    void StatsCommandEncoder::clearBuffer(Buffer* buffer, Uint64 offset, Uint64 size) {
+        this->count(StatsCounter::eTransfers);
+        this->inner->clearBuffer(buffer, offset, size);
+    }
+
+    void StatsCommandEncoder::resolveQuerySet(QuerySet querySet, Uint32 firstQuery, Uint32 queryCount, Buffer* destination,
+        Uint64 destinationOffset)
+    {
+        this->count(StatsCounter::eTransfers);
+        this->inner->resolveQuerySet(querySet, firstQuery, queryCount, destination, destinationOffset);
+    }
+
+    void StatsCommandEncoder::activatePipelineBarrier(ShaderStage srcStage, ShaderStage dstStage) {
+        this->count(StatsCounter::eBarriers);
+        this->inner->activatePipelineBarrier(srcStage, dstStage);
+    }
+
+    void StatsCommandEncoder::activateBufferBarrier(ShaderStage srcStage, ShaderStage dstStage, BufferBarrier desc) {
+        this->count(StatsCounter::eBarriers);
+        this->inner->activateBufferBarrier(srcStage, dstStage, desc);
+    }
+
+    void StatsCommandEncoder::activateImageBarrier(ShaderStage srcStage, ShaderStage dstStage, ImageBarrier desc) {
+        this->count(StatsCounter::eBarriers);
+        this->inner->activateImageBarrier(srcStage, dstStage, desc);
+    }
+
+    void StatsCommandEncoder::activateBarriers(ShaderStage srcStage, ShaderStage dstStage, const std::vector<BufferBarrier>& bufferBarriers,
+        const std::vector<ImageBarrier>& imageBarriers)
+    {
+        this->count(StatsCounter::eBarriers, bufferBarriers.size() + imageBarriers.size());
+        this->inner->activateBarriers(srcStage, dstStage, bufferBarriers, imageBarriers);
+    }
+
+    void StatsCommandEncoder::finish() {
+        this->inner->finish();
+        this->state = this->inner->state;
+
+        this->device->getCounters().add(this->counts);
+        std::fill(std::begin(this->counts), std::end(this->counts), 0);
+    }
+
+    void StatsCommandEncoder::reset() {
+        this->inner->reset();
+        this->state = this->inner->state;
+
+        std::fill(std::begin(this->counts), std::end(this->counts), 0);
+    }
+
+    // ===========================================================================================================================
+    // Queue
+    // ===========================================================================================================================
+
+    void StatsQueue::submit(const std::vector<CommandEncoder*>& commandEncoders) {
+        std::vector<CommandEncoder*> innerEncoders;
+        innerEncoders.reserve(commandEncoders.size());
+
+        for (CommandEncoder* encoder : commandEncoders) {
+            innerEncoders.push_back(static_cast<StatsCommandEncoder*>(encoder)->getInner());
+        }
+
+        StatsCounters& counters = this->device->getCounters();
+        counters.add(StatsCounter::eSubmits, 1);
+        counters.add(StatsCounter::eSubmittedEncoders, commandEncoders.size());
+
+        this->inner->submit(innerEncoders);
+    }
+
+    void StatsQueue::writeBuffer(Buffer* buffer, Uint64 bufferOffset, const void* data, Uint64 size) {
+        this->device->getCounters().add(StatsCounter::eWriteBufferBytes, size);
+        this->inner->writeBuffer(buffer, bufferOffset, data, size);
+    }
+
+    void StatsQueue::writeTexture(ImageCopyTexture destination, const void* data, Uint64 dataSize,
+        ImageDataLayout dataLayout, Extent3D size)
+    {
+        this->device->getCounters().add(StatsCounter::eWriteTextureBytes, dataSize);
+        this->inner->writeTexture(destination, data, dataSize, dataLayout, size);
+    }
+
+    void StatsQueue::waitIdle() {
+        this->inner->waitIdle();
+    }
+
+    // ===========================================================================================================================
+    // Device
+    // ===========================================================================================================================
+
+    StatsDevice::StatsDevice(Device* inner, StatsDeviceDescriptor descriptor)
+        : inner{ inner }, statsDesc{ std::move(descriptor) }, queue{ this, inner->getQueue() }
+    {
+        this->desc = inner->desc;
+        this->statsDesc.historySize = std::max<Uint32>(1, this->statsDesc.historySize);
+    }
+
+    std::shared_ptr<Buffer> StatsDevice::createBuffer(BufferDescriptor descriptor) {
+        StatsHeap heap = descriptor.location == BufferLocation::eHost ? StatsHeap::eHost : StatsHeap::eDeviceLocal;
+        return this->track(this->inner->createBuffer(descriptor), StatsObject::eBuffer, heap, static_cast<Int64>(descriptor.size));
+    }
+
+    std::shared_ptr<Texture> StatsDevice::createTexture(TextureDescriptor descriptor) {
+        return this->track(this->inner->createTexture(descriptor), StatsObject::eTexture, StatsHeap::eDeviceLocal,
+            static_cast<Int64>(getTextureMemorySize(descriptor)));
+    }
+
+    std::shared_ptr<Sampler> StatsDevice::createSampler(SamplerDescriptor descriptor) {
+        return this->track(this->inner->createSampler(descriptor), StatsObject::eSampler);
+    }
+
+    std::shared_ptr<BindGroup> StatsDevice::createBindGroup(BindGroupDescriptor descriptor) {
+        return this->track(this->inner->createBindGroup(descriptor), StatsObject::eBindGroup);
+    }
+
+    void StatsDevice::updateBindGroup(BindGroup* bindGroup, const std::vector<BindGroupEntry>& entries) {
+        this->inner->updateBindGroup(bindGroup, entries);
+    }
+
+    std::shared_ptr<BindGroupLayout> StatsDevice::createBindGroupLayout(BindGroupLayoutDescriptor descriptor) {
+        return this->track(this->inner->createBindGroupLayout(descriptor), StatsObject::eBindGroupLayout);
+    }
+
+    std::shared_ptr<PipelineLayout> StatsDevice::createPipelineLayout(PipelineLayoutDescriptor descriptor) {
+        return this->track(this->inner->createPipelineLayout(descriptor), StatsObject::ePipelineLayout);
+    }
+
+    std::shared_ptr<ShaderModule> StatsDevice::createShaderModule(ShaderModuleDescriptor descriptor) {
+        return this->track(this->inner->createShaderModule(descriptor), StatsObject::eShaderModule);
+    }
+
+    std::shared_ptr<ComputePipeline> StatsDevice::createComputePipeline(ComputePipelineDescriptor descriptor) {
+        return this->track(this->inner->createComputePipeline(descriptor), StatsObject::eComputePipeline);
+    }
+
+    std::shared_ptr<RenderPipeline> StatsDevice::createRenderPipeline(RenderPipelineDescriptor descriptor) {
+        return this->track(this->inner->createRenderPipeline(descriptor), StatsObject::eRenderPipeline);
+    }
+
+    std::shared_ptr<CommandEncoder> StatsDevice::createCommandEncoder() {
+        auto encoder = this->inner->createCommandEncoder();
+        return encoder != nullptr ? std::make_shared<StatsCommandEncoder>(this, encoder) : nullptr;
+    }
+
+    void StatsDevice::endFrame(Uint64 frameIndex) {
+        StatsFrame frame;
+        frame.frameIndex = frameIndex;
+
+        this->counters.collect(frame.counters);
+
+        for (Uint32 i = 0; i < kStatsObjectCount; i++) {
+            frame.liveObjects[i] = this->liveObjects[i].load(std::memory_order_relaxed);
+        }
+
+        for (Uint32 i = 0; i < kStatsHeapCount; i++) {
+            frame.heapBytes[i] = this->heapBytes[i].load(std::memory_order_relaxed);
+        }
+
+        std::string report;
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            if (this->history.size() < this->statsDesc.historySize) {
+                this->history.push_back(frame);
+            } else {
+                this->history[this->historyCursor] = frame;
+                this->historyCursor = (this->historyCursor + 1) % this->history.size();
+            }
+
+            if (this->statsDesc.exportInterval == 0) {
+                return;
+            }
+
+            this->pending.add(frame);
+
+            if (this->pending.frameCount < this->statsDesc.exportInterval) {
+                return;
+            }
+
+            report = this->statsDesc.exportFormat == StatsExportFormat::eJson
+                ? formatStatsJson(this->pending)
+                : formatStatsText(this->pending);
+
+            this->pending = StatsReport{};
+        }
+
+        if (this->statsDesc.exportSink) {
+            this->statsDesc.exportSink(report);
+        }
+    }
+
+    StatsFrame StatsDevice::getLastFrame() const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        if (this->history.empty()) {
+            return StatsFrame{};
+        }
+
+        size_t last = this->history.size() < this->statsDesc.historySize
+            ? this->history.size() - 1
+            : (this->historyCursor + this->history.size() - 1) % this->history.size();
+
+        return this->history[last];
+    }
+
+    std::vector<StatsFrame> StatsDevice::getHistory() const {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        std::vector<StatsFrame> frames;
+        frames.reserve(this->history.size());
+
+        for (size_t i = 0; i < this->history.size(); i++) {
+            frames.push_back(this->history[(this->historyCursor + i) % this->history.size()]);
+        }
+
+        return frames;
+    }
+};
@@ -0,0 +1,344 @@
+#pragma once
+
+#include "rhi.hpp"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Counters
+    // ===========================================================================================================================
+
+    enum class StatsCounter : Uint8 {
+        eDraws,
+        eIndirectDraws,
+        eDispatches,
+        eIndirectDispatches,
+        eRenderPasses,
+        eComputePasses,
+        ePipelineChanges,
+        eBindGroupSets,
+        eVertexBufferSets,
+        eIndexBufferSets,
+        ePushConstantUpdates,
+        eDynamicStateChanges,
+        eBarriers,
+        eTransfers,
+        eSubmits,
+        eSubmittedEncoders,
+        eWriteBufferBytes,
+        eWriteTextureBytes,
+        eCount
+    };
+
+    enum class StatsObject : Uint8 {
+        eBuffer,
+        eTexture,
+        eSampler,
+        eBindGroup,
+        eBindGroupLayout,
+        ePipelineLayout,
+        eShaderModule,
+        eComputePipeline,
+        eRenderPipeline,
+        eCommandEncoder,
+        eCount
+    };
+
+    // Textures count as eDeviceLocal
+    enum class StatsHeap : Uint8 {
+        eDeviceLocal,
+        eHost,
+        eCount
+    };
+
+    constexpr Uint32 kStatsCounterCount = static_cast<Uint32>(StatsCounter::eCount);
+    constexpr Uint32 kStatsObjectCount = static_cast<Uint32>(StatsObject::eCount);
+    constexpr Uint32 kStatsHeapCount = static_cast<Uint32>(StatsHeap::eCount);
+
+    const char* getStatsCounterName(StatsCounter counter);
+    const char* getStatsObjectName(StatsObject object);
+    const char* getStatsHeapName(StatsHeap heap);
+
+    // Counters summed per thread shard, each shard on its own cache line. Threads are spread
+    // over the shards on first use, so increments from different threads rarely share a line,
+    // and collect() is the only reader.
+    class StatsCounters {
+    public:
+        static constexpr Uint32 kShardCount = 16;
+
+        void add(StatsCounter counter, Uint64 value) {
+            this->shards[getThreadShard()].values[static_cast<Uint32>(counter)].fetch_add(value, std::memory_order_relaxed);
+        }
+
+        // Adds a whole block of counts, as encoders hand them over when they finish
+        void add(const Uint64* values);
+
+        // Sums every shard into totals and clears them
+        void collect(Uint64* totals);
+
+    private:
+        struct alignas(64) Shard {
+            std::atomic<Uint64> values[kStatsCounterCount] = {};
+        };
+
+        Shard shards[kShardCount];
+
+        static Uint32 getThreadShard();
+    };
+
+    // ===========================================================================================================================
+    // Frame Statistics
+    // ===========================================================================================================================
+
+    struct StatsFrame {
+        Uint64 frameIndex = 0;
+        Uint64 counters[kStatsCounterCount] = {};
+
+        // At the end of the frame
+        Int64 liveObjects[kStatsObjectCount] = {};
+        Int64 heapBytes[kStatsHeapCount] = {};
+
+        Uint64 get(StatsCounter counter) const { return this->counters[static_cast<Uint32>(counter)]; }
+    };
+
+    // Frames [firstFrame, firstFrame + frameCount), with the gauges of the last one
+    struct StatsReport {
+        Uint64 firstFrame = 0;
+        Uint32 frameCount = 0;
+
+        Uint64 totals[kStatsCounterCount] = {};
+        Uint64 peaks[kStatsCounterCount] = {};
+
+        Int64 liveObjects[kStatsObjectCount] = {};
+        Int64 heapBytes[kStatsHeapCount] = {};
+
+        void add(const StatsFrame& frame);
+    };
+
+    // One line each, counters as per frame mean and peak
+    std::string formatStatsText(const StatsReport& report);
+    std::string formatStatsJson(const StatsReport& report);
+
+    enum class StatsExportFormat : Uint8 {
+        eText,
+        eJson
+    };
+
+    struct StatsDeviceDescriptor {
+        // Frames between two exports, 0 only keeps the history
+        Uint32 exportInterval = 0;
+        StatsExportFormat exportFormat = StatsExportFormat::eJson;
+
+        // Called from endFrame with one formatted report
+        std::function<void(const std::string& report)> exportSink;
+
+        Uint32 historySize = 120;
+    };
+
+    // ===========================================================================================================================
+    // Stats Device
+    // ===========================================================================================================================
+
+    // Wraps another device and counts what goes through it. Encoders count into plain members
+    // while recording and hand the block to the sharded counters when they finish, so the
+    // recording cost is an increment per command. Queue operations add to the shards directly,
+    // resource lifetimes move atomic gauges.
+    //
+    // Encoders and the queue are wrapped, every other object is the inner one. Objects created
+    // here must not outlive the stats device.
+
+    class StatsDevice;
+    class StatsCommandEncoder;
+
+    class StatsComputePassEncoder : public ComputePassEncoder {
+    public:
+        StatsComputePassEncoder(StatsCommandEncoder* encoder) : encoder{ encoder } {}
+
+        void setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets = {}) override;
+        void setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
+            Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength) override;
+        void setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) override;
+
+        void setPipeline(ComputePipeline* pipeline) override;
+        void dispatchWorkgroups(Uint32 workgroupCountX, Uint32 workgroupCountY = 1, Uint32 workgroupCountZ = 1) override;
+        void dispatchWorkgroupsIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) override;
+
+        void end() override;
+
+    private:
+        friend class StatsCommandEncoder;
+
+        StatsCommandEncoder* encoder;
+        std::shared_ptr<ComputePassEncoder> inner;
+    };
+
+    class StatsRenderPassEncoder : public RenderPassEncoder {
+    public:
+        StatsRenderPassEncoder(StatsCommandEncoder* encoder) : encoder{ encoder } {}
+
+        void setBindGroup(Uint32 index, BindGroup* bindGroup, const std::vector<Uint32>& dynamicOffsets = {}) override;
+        void setBindGroup(Uint32 index, BindGroup* bindGroup, const Uint32* dynamicOffsetsData,
+            Uint64 dynamicOffsetsDataStart, Uint32 dynamicOffsetsDataLength) override;
+        void setPushConstants(ShaderStageFlags visibility, Uint32 offset, Uint32 size, const void* data) override;
+
+        void setPipeline(RenderPipeline* pipeline) override;
+        void setIndexBuffer(Buffer* buffer, IndexFormat indexFormat, Uint64 offset = 0, Uint64 size = ULLONG_MAX) override;
+        void setVertexBuffer(Uint32 slot, Buffer* buffer, Uint64 offset = 0, Uint64 size = ULLONG_MAX) override;
+
+        void draw(Uint32 vertexCount, Uint32 instanceCount = 1, Uint32 firstVertex = 0, Uint32 firstInstance = 0) override;
+        void drawIndexed(Uint32 indexCount, Uint32 instanceCount = 1, Uint32 firstIndex = 0, Int32 baseVertex = 0,
+            Uint32 firstInstance = 0) override;
+
+        void drawIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) override;
+        void drawIndexedIndirect(Buffer* indirectBuffer, Uint64 indirectOffset) override;
+
+        void setViewport(float x, float y, float width, float height, float minDepth, float maxDepth) override;
+        void setScissorRect(Uint32 x, Uint32 y, Uint32 width, Uint32 height) override;
+        void setBlendConstant(Color color) override;
+        void setStencilReference(Uint32 reference) override;
+
+        void beginOcclusionQuery(Uint32 queryIndex) override;
+        void endOcclusionQuery() override;
+
+        void end() override;
+
+    private:
+        friend class StatsCommandEncoder;
+
+        StatsCommandEncoder* encoder;
+        std::shared_ptr<RenderPassEncoder> inner;
+    };
+
+    class StatsCommandEncoder : public CommandEncoder {
+    public:
+        StatsCommandEncoder(StatsDevice* device, std::shared_ptr<CommandEncoder> inner);
+        ~StatsCommandEncoder();
+
+        std::shared_ptr<RenderPassEncoder> beginRenderPass(RenderPassDescriptor descriptor) override;
+        std::shared_ptr<ComputePassEncoder> beginComputePass(ComputePassDescriptor descriptor) override;
+
+        void copyBufferToBuffer(Buffer* source, Uint64 sourceOffset, Buffer* destination, Uint64 destinationOffset,
+            Uint64 size) override;
+        void copyBufferToTexture(ImageCopyBuffer source, ImageCopyTexture destination, Extent3D copySize) override;
+        void copyTextureToBuffer(ImageCopyTexture source, ImageCopyBuffer destination, Extent3D copySize) override;
+        void copyTextureToTexture(ImageCopyTexture source, ImageCopyTexture destination, Extent3D copySize) override;
+        void clearBuffer(Buffer* buffer, Uint64 offset = 0, Uint64 size = ULLONG_MAX) override;
+        void resolveQuerySet(QuerySet querySet, Uint32 firstQuery, Uint32 queryCount, Buffer* destination,
+            Uint64 destinationOffset) override;
+
+        void activatePipelineBarrier(ShaderStage srcStage, ShaderStage dstStage) override;
+        void activateBufferBarrier(ShaderStage srcStage, ShaderStage dstStage, BufferBarrier desc) override;
+        void activateImageBarrier(ShaderStage srcStage, ShaderStage dstStage, ImageBarrier desc) override;
+        void activateBarriers(ShaderStage srcStage, ShaderStage dstStage, const std::vector<BufferBarrier>& bufferBarriers,
+            const std::vector<ImageBarrier>& imageBarriers) override;
+
+        // Hands the counts recorded since the last reset to the device
+        void finish() override;
+
+        // Drops the counts of a recording that was not finished
+        void reset() override;
+
+        CommandEncoder* getInner() const { return this->inner.get(); }
+
+        void count(StatsCounter counter, Uint64 value = 1) { this->counts[static_cast<Uint32>(counter)] += value; }
+
+    private:
+        friend class StatsComputePassEncoder;
+        friend class StatsRenderPassEncoder;
+
+        StatsDevice* device;
+        std::shared_ptr<CommandEncoder> inner;
+
+        Uint64 counts[kStatsCounterCount] = {};
+
+        // Only one pass is open at a time, beginning one hands out these
+        StatsRenderPassEncoder renderPass{ this };
+        StatsComputePassEncoder computePass{ this };
+    };
+
+    class StatsQueue : public Queue {
+    public:
+        StatsQueue(StatsDevice* device, Queue* inner) : device{ device }, inner{ inner } {}
+
+        void submit(const std::vector<CommandEncoder*>& commandEncoders) override;
+        void writeBuffer(Buffer* buffer, Uint64 bufferOffset, const void* data, Uint64 size) override;
+        void writeTexture(ImageCopyTexture destination, const void* data, Uint64 dataSize,
+            ImageDataLayout dataLayout, Extent3D size) override;
+        void waitIdle() override;
+
+    private:
+        StatsDevice* device;
+        Queue* inner;
+    };
+
+    class StatsDevice : public Device {
+    public:
+        StatsDevice(Device* inner, StatsDeviceDescriptor descriptor = {});
+
+        Queue* getQueue() override { return &this->queue; }
+
+        std::shared_ptr<Buffer> createBuffer(BufferDescriptor descriptor) override;
+        std::shared_ptr<Texture> createTexture(TextureDescriptor descriptor) override;
+        std::shared_ptr<Sampler> createSampler(SamplerDescriptor descriptor) override;
+        std::shared_ptr<BindGroup> createBindGroup(BindGroupDescriptor descriptor) override;
+        void updateBindGroup(BindGroup* bindGroup, const std::vector<BindGroupEntry>& entries) override;
+        std::shared_ptr<BindGroupLayout> createBindGroupLayout(BindGroupLayoutDescriptor descriptor) override;
+        std::shared_ptr<PipelineLayout> createPipelineLayout(PipelineLayoutDescriptor descriptor) override;
+        std::shared_ptr<ShaderModule> createShaderModule(ShaderModuleDescriptor descriptor) override;
+        std::shared_ptr<ComputePipeline> createComputePipeline(ComputePipelineDescriptor descriptor) override;
+        std::shared_ptr<RenderPipeline> createRenderPipeline(RenderPipelineDescriptor descriptor) override;
+        std::shared_ptr<CommandEncoder> createCommandEncoder() override;
+
+        // Closes frameIndex: collects the counters, stores the frame in the history and exports
+        // a report when the interval is reached
+        void endFrame(Uint64 frameIndex);
+
+        StatsFrame getLastFrame() const;
+
+        // Oldest first, up to historySize frames
+        std::vector<StatsFrame> getHistory() const;
+
+        StatsCounters& getCounters() { return this->counters; }
+
+        // Used by the wrappers
+        void addObject(StatsObject object, Int64 count) {
+            this->liveObjects[static_cast<Uint32>(object)].fetch_add(count, std::memory_order_relaxed);
+        }
+
+    private:
+        // The returned object is the inner one, dropping the last reference updates the gauges
+        template <typename T>
+        std::shared_ptr<T> track(std::shared_ptr<T> inner, StatsObject object, StatsHeap heap = StatsHeap::eDeviceLocal, Int64 bytes = 0) {
+            if (inner == nullptr) {
+                return nullptr;
+            }
+
+            this->addObject(object, 1);
+            this->heapBytes[static_cast<Uint32>(heap)].fetch_add(bytes, std::memory_order_relaxed);
+
+            T* pointer = inner.get();
+            return std::shared_ptr<T>(pointer, [this, inner, object, heap, bytes](T*) mutable {
+                this->addObject(object, -1);
+                this->heapBytes[static_cast<Uint32>(heap)].fetch_sub(bytes, std::memory_order_relaxed);
+                inner.reset();
+            });
+        }
+
+        Device* inner;
+        StatsDeviceDescriptor statsDesc;
+        StatsQueue queue;
+
+        StatsCounters counters;
+        std::atomic<Int64> liveObjects[kStatsObjectCount] = {};
+        std::atomic<Int64> heapBytes[kStatsHeapCount] = {};
+
+        mutable std::mutex mutex;
+        std::vector<StatsFrame> history;
+        size_t historyCursor = 0;
+
+        StatsReport pending;
+    };
+};
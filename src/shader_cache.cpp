@@ -0,0 +1,398 @@
+#include "shader_cache.hpp"
+
+#include "hash.hpp"
+#include "task_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <unordered_set>
+
+namespace Rhi {
+    namespace {
+        namespace fs = std::filesystem;
+
+        constexpr uint32_t kSpirvMagic = 0x07230203;
+
+        // A store scans the directory for eviction for about one key in this many, or once an
+        // instance has written maxSize / kEvictInterval bytes since its last scan
+        constexpr Uint64 kEvictInterval = 32;
+
+        bool readFile(const std::string& path, std::string& contents) {
+            std::ifstream file{ path, std::ios::binary };
+            if (!file) {
+                return false;
+            }
+
+            std::ostringstream stream;
+            stream << file.rdbuf();
+            contents = stream.str();
+
+            return true;
+        }
+
+        // Matches '#include "name"' and '#include <name>', leading whitespace allowed
+        bool parseInclude(const std::string& line, std::string& name) {
+            size_t cursor = line.find_first_not_of(" \t");
+            if (cursor == std::string::npos || line.compare(cursor, 8, "#include") != 0) {
+                return false;
+            }
+
+            size_t open = line.find_first_of("\"<", cursor + 8);
+            if (open == std::string::npos) {
+                return false;
+            }
+
+            size_t close = line.find(line[open] == '"' ? '"' : '>', open + 1);
+            if (close == std::string::npos) {
+                return false;
+            }
+
+            name = line.substr(open + 1, close - open - 1);
+            return true;
+        }
+
+        // Folds the contents of every included file into the hash, depth first in source order
+        void hashIncludes(const std::string& source, const std::string& directory, const std::vector<std::string>& includeDirectories,
+            std::unordered_set<std::string>& visited, std::vector<std::string>& dependencies, Uint64& hash)
+        {
+            std::istringstream lines{ source };
+            std::string line, name;
+
+            while (std::getline(lines, line)) {
+                if (!parseInclude(line, name)) {
+                    continue;
+                }
+
+                hash = hashString(name.c_str(), hash);
+
+                std::vector<std::string> candidates{ (fs::path(directory) / name).string() };
+
+                for (const auto& includeDirectory : includeDirectories) {
+                    candidates.push_back((fs::path(includeDirectory) / name).string());
+                }
+
+                // An unresolved include stays in the key by name only, the compiler reports it
+                for (const auto& candidate : candidates) {
+                    std::string contents;
+                    if (!readFile(candidate, contents)) {
+                        continue;
+                    }
+
+                    std::string resolved = fs::path(candidate).lexically_normal().string();
+                    if (visited.insert(resolved).second) {
+                        dependencies.push_back(resolved);
+
+                        hash = hashBytes(contents.data(), contents.size(), hash);
+                        hashIncludes(contents, fs::path(resolved).parent_path().string(), includeDirectories, visited, dependencies, hash);
+                    }
+
+                    break;
+                }
+            }
+        }
+
+        // Same names as the file extensions glslc takes the stage from, so a file and the same
+        // source compiled from memory share a key. Tessellation has two GLSL stages, those
+        // sources name theirs with #pragma shader_stage.
+        const char* getStageName(ShaderStage stage) {
+            switch (stage) {
+                case ShaderStage::eVertex: return "vert";
+                case ShaderStage::eFragment: return "frag";
+                case ShaderStage::eCompute: return "comp";
+                case ShaderStage::eTask: return "task";
+                case ShaderStage::eMesh: return "mesh";
+                default: return "";
+            }
+        }
+
+        std::string makeTemporaryPath(const std::string& directory, const char* extension) {
+            static std::atomic<Uint64> counter{ 0 };
+            static const Uint64 processSalt = std::random_device{}();
+
+            char name[64];
+            std::snprintf(name, sizeof(name), "tmp-%016llx-%llu%s", static_cast<unsigned long long>(processSalt),
+                static_cast<unsigned long long>(counter++), extension);
+
+            return (fs::path(directory) / name).string();
+        }
+
+        int runCommand(std::string command) {
+#ifdef _WIN32
+            // cmd strips the outer pair of quotes, keep the quoted arguments intact
+            command = "\"" + command + "\"";
+#endif
+            return std::system(command.c_str());
+        }
+
+        std::string quote(const std::string& value) {
+            return "\"" + value + "\"";
+        }
+    };
+
+    ShaderCache::ShaderCache(ShaderCacheDescriptor descriptor) : desc{ descriptor } {
+        std::error_code errorCode;
+        fs::create_directories(this->desc.directory, errorCode);
+    }
+
+    std::string ShaderCache::getEntryPath(Uint64 key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.spv", static_cast<unsigned long long>(key));
+
+        return (fs::path(this->desc.directory) / name).string();
+    }
+
+    const std::string& ShaderCache::getCompilerVersion() {
+        std::call_once(this->compilerVersionFlag, [this]() {
+            std::string outputPath = makeTemporaryPath(this->desc.directory, ".version");
+
+            // A compiler that cannot report its version still works, its key just misses the version
+            if (runCommand(quote(this->desc.compiler) + " --version > " + quote(outputPath) + " 2>&1") == 0) {
+                readFile(outputPath, this->compilerVersion);
+            }
+
+            std::error_code errorCode;
+            fs::remove(outputPath, errorCode);
+        });
+
+        return this->compilerVersion;
+    }
+
+    Uint64 ShaderCache::computeKey(const std::string& source, const std::string& sourceDirectory, const std::string& stageName,
+        std::vector<std::string>& dependencies)
+    {
+        Uint64 hash = hashString(this->getCompilerVersion().c_str());
+        hash = hashString(this->desc.compilerOptions.c_str(), hash);
+        hash = hashString(stageName.c_str(), hash);
+        hash = hashBytes(source.data(), source.size(), hash);
+
+        std::unordered_set<std::string> visited;
+        hashIncludes(source, sourceDirectory, this->desc.includeDirectories, visited, dependencies, hash);
+
+        return hash;
+    }
+
+    bool ShaderCache::load(Uint64 key, std::vector<uint32_t>& spirv) {
+        std::string path = this->getEntryPath(key);
+        std::string contents;
+
+        if (!readFile(path, contents) || contents.size() < 4 || contents.size() % 4 != 0) {
+            return false;
+        }
+
+        spirv.resize(contents.size() / 4);
+        std::memcpy(spirv.data(), contents.data(), contents.size());
+
+        if (spirv[0] != kSpirvMagic) {
+            return false;
+        }
+
+        // The modification time doubles as the last use time for eviction
+        std::error_code errorCode;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), errorCode);
+
+        return true;
+    }
+
+    bool ShaderCache::store(Uint64 key, const std::string& compiledPath, std::vector<uint32_t>& spirv, std::string& error) {
+        std::string contents;
+
+        if (!readFile(compiledPath, contents) || contents.size() < 4 || contents.size() % 4 != 0) {
+            error = "Compiler produced no valid SPIR-V";
+            return false;
+        }
+
+        spirv.resize(contents.size() / 4);
+        std::memcpy(spirv.data(), contents.data(), contents.size());
+
+        // Rename is atomic, so parallel build steps and running apps never read a partial entry.
+        // Losing the race to an identical entry is fine, the content is the same by construction.
+        std::error_code errorCode;
+        fs::rename(compiledPath, this->getEntryPath(key), errorCode);
+        if (errorCode) {
+            fs::remove(compiledPath, errorCode);
+        }
+
+        // Keys are uniform hashes, sampling them spreads the scans over every process sharing the store
+        Uint64 written = this->bytesSinceEvict.fetch_add(contents.size()) + contents.size();
+        if (key % kEvictInterval == 0 || written >= this->desc.maxSize / kEvictInterval) {
+            this->evict();
+        }
+
+        return true;
+    }
+
+    void ShaderCache::compile(const std::string& source, const std::string& sourcePath, const std::string& sourceDirectory,
+        const std::string& stageName, ShaderCompileResult& result)
+    {
+        result.key = this->computeKey(source, sourceDirectory, stageName, result.dependencies);
+
+        if (this->load(result.key, result.spirv)) {
+            result.cacheHit = true;
+            result.success = true;
+            return;
+        }
+
+        std::string inputPath = sourcePath;
+        if (inputPath.empty()) {
+            inputPath = makeTemporaryPath(this->desc.directory, ".glsl");
+            std::ofstream{ inputPath, std::ios::binary } << source;
+        }
+
+        std::string outputPath = makeTemporaryPath(this->desc.directory, ".out");
+        std::string logPath = outputPath + ".log";
+
+        // Files leave the stage to the compiler, which reads it from the extension
+        std::string command = quote(this->desc.compiler) + " " + this->desc.compilerOptions;
+        if (sourcePath.empty() && !stageName.empty()) {
+            command += " -fshader-stage=" + stageName;
+        }
+
+        for (const auto& includeDirectory : this->desc.includeDirectories) {
+            command += " -I" + quote(includeDirectory);
+        }
+
+        command += " " + quote(inputPath) + " -o " + quote(outputPath) + " 2> " + quote(logPath);
+
+        int exitCode = runCommand(command);
+
+        std::error_code errorCode;
+        if (sourcePath.empty()) {
+            fs::remove(inputPath, errorCode);
+        }
+
+        if (exitCode != 0) {
+            if (!readFile(logPath, result.error) || result.error.empty()) {
+                result.error = "Failed to run " + this->desc.compiler;
+            }
+        } else {
+            result.success = this->store(result.key, outputPath, result.spirv, result.error);
+        }
+
+        fs::remove(outputPath, errorCode);
+        fs::remove(logPath, errorCode);
+    }
+
+    void ShaderCache::compileFile(const std::string& path, ShaderCompileResult& result) {
+        result = ShaderCompileResult{};
+
+        std::string source;
+        if (!readFile(path, source)) {
+            result.error = "Failed to read " + path;
+            return;
+        }
+
+        std::string extension = fs::path(path).extension().string();
+        std::string stageName = extension.empty() ? extension : extension.substr(1);
+
+        this->compile(source, path, fs::path(path).parent_path().string(), stageName, result);
+    }
+
+    void ShaderCache::compileSource(const char* source, ShaderStage stage, ShaderCompileResult& result) {
+        result = ShaderCompileResult{};
+
+        // The source is compiled from a temporary file in the store, which is where the
+        // compiler resolves its quoted includes
+        this->compile(source, std::string{}, this->desc.directory, getStageName(stage), result);
+    }
+
+    void ShaderCache::compileFiles(const std::vector<std::string>& paths, TaskPool& pool, std::vector<ShaderCompileResult>& results) {
+        results.clear();
+        results.resize(paths.size());
+
+        for (size_t i = 0; i < paths.size(); i++) {
+            pool.submit([this, &paths, &results, i]() {
+                this->compileFile(paths[i], results[i]);
+            });
+        }
+
+        pool.wait();
+    }
+
+    std::shared_ptr<ShaderModule> ShaderCache::createShaderModule(Device* device, const ShaderModuleDescriptor& descriptor,
+        ShaderStage stage, std::string& error)
+    {
+        if (descriptor.codeSize != 0) {
+            return device->createShaderModule(descriptor);
+        }
+
+        ShaderCompileResult result;
+        this->compileSource(descriptor.code, stage, result);
+
+        if (!result.success) {
+            error = result.error;
+            return nullptr;
+        }
+
+        std::shared_ptr<std::vector<uint32_t>> binary;
+        {
+            std::lock_guard<std::mutex> lock{ this->mutex };
+
+            auto& resident = this->residentBinaries[result.key];
+            if (resident == nullptr) {
+                resident = std::make_shared<std::vector<uint32_t>>(std::move(result.spirv));
+            }
+
+            binary = resident;
+        }
+
+        ShaderModuleDescriptor compiled = descriptor;
+        compiled.code = reinterpret_cast<String>(binary->data());
+        compiled.codeSize = binary->size() * sizeof(uint32_t);
+
+        return device->createShaderModule(compiled);
+    }
+
+    void ShaderCache::evict() {
+        this->bytesSinceEvict.store(0);
+
+        struct Entry {
+            fs::path path;
+            Uint64 size;
+            fs::file_time_type lastUse;
+        };
+
+        std::vector<Entry> entries;
+        Uint64 totalSize = 0;
+
+        // Other processes may add or remove entries meanwhile, every failure just skips the file
+        std::error_code errorCode;
+        for (fs::directory_iterator it{ this->desc.directory, errorCode }, end; !errorCode && it != end; it.increment(errorCode)) {
+            if (it->path().extension() != ".spv") {
+                continue;
+            }
+
+            std::error_code entryError;
+            Entry entry{ it->path(), it->file_size(entryError), it->last_write_time(entryError) };
+
+            if (!entryError) {
+                totalSize += entry.size;
+                entries.push_back(entry);
+            }
+        }
+
+        if (totalSize <= this->desc.maxSize) {
+            return;
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return a.lastUse < b.lastUse;
+        });
+
+        for (const auto& entry : entries) {
+            if (totalSize <= this->desc.maxSize) {
+                break;
+            }
+
+            if (fs::remove(entry.path, errorCode)) {
+                totalSize -= entry.size;
+            }
+        }
+    }
+};
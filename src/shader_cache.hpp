@@ -0,0 +1,93 @@
+#pragma once
+
+#include "rhi.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace Rhi {
+    class TaskPool;
+
+    // ===========================================================================================================================
+    // Shader Cache
+    // ===========================================================================================================================
+
+    struct ShaderCacheDescriptor {
+        // Directory of the on-disk store, shared by the build step and the runtime
+        std::string directory = "shader_cache";
+
+        // Least recently used entries are evicted once the store grows past this size
+        Uint64 maxSize = 256ull << 20;
+
+        std::string compiler = "glslc";
+        std::string compilerOptions = "-O";
+        std::vector<std::string> includeDirectories{};
+    };
+
+    struct ShaderCompileResult {
+        std::vector<uint32_t> spirv;
+
+        // Every file pulled in through #include, in the order they were first seen
+        std::vector<std::string> dependencies;
+
+        Uint64 key = 0;
+        bool cacheHit = false;
+        bool success = false;
+        std::string error;
+    };
+
+    // Content addressed SPIR-V store. The key hashes the source, the contents of every file
+    // it includes, the stage, the compiler options and the compiler version, so edits to a
+    // shared header invalidate exactly the shaders that include it, while touching a file
+    // without changing it costs nothing. Paths stay out of the key, the build step and the
+    // runtime reach the same compiler and includes through different ones.
+    class ShaderCache {
+    public:
+        explicit ShaderCache(ShaderCacheDescriptor descriptor);
+
+        ShaderCacheDescriptor desc;
+
+        // Compiles a GLSL file, the stage comes from its extension (.vert, .frag, .comp, ...)
+        void compileFile(const std::string& path, ShaderCompileResult& result);
+
+        // Compiles GLSL source held in memory. Includes resolve against includeDirectories.
+        void compileSource(const char* source, ShaderStage stage, ShaderCompileResult& result);
+
+        // Compiles every file on the pool, results line up with paths
+        void compileFiles(const std::vector<std::string>& paths, TaskPool& pool, std::vector<ShaderCompileResult>& results);
+
+        // Passes SPIR-V descriptors through, compiles source descriptors through the cache first
+        std::shared_ptr<ShaderModule> createShaderModule(Device* device, const ShaderModuleDescriptor& descriptor,
+            ShaderStage stage, std::string& error);
+
+        // Removes least recently used entries until the store fits in maxSize. Stores only run
+        // it now and then, call it after a batch to trim the store right away.
+        void evict();
+
+    private:
+        std::string getEntryPath(Uint64 key) const;
+
+        // Output of compiler --version, run once per cache
+        const std::string& getCompilerVersion();
+
+        Uint64 computeKey(const std::string& source, const std::string& sourceDirectory, const std::string& stageName,
+            std::vector<std::string>& dependencies);
+
+        bool load(Uint64 key, std::vector<uint32_t>& spirv);
+        bool store(Uint64 key, const std::string& compiledPath, std::vector<uint32_t>& spirv, std::string& error);
+
+        void compile(const std::string& source, const std::string& sourcePath, const std::string& sourceDirectory,
+            const std::string& stageName, ShaderCompileResult& result);
+
+        std::mutex mutex;
+
+        std::once_flag compilerVersionFlag;
+        std::string compilerVersion;
+
+        std::atomic<Uint64> bytesSinceEvict{ 0 };
+
+        // Keeps SPIR-V alive for the modules created from it, ShaderModuleDescriptor::code only points at it
+        std::unordered_map<Uint64, std::shared_ptr<std::vector<uint32_t>>> residentBinaries;
+    };
+};
@@ -0,0 +1,976 @@
+#include "shader_reflection.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // SPIR-V Module
+    // ===========================================================================================================================
+
+    namespace {
+        constexpr uint32_t kSpirvMagic = 0x07230203;
+        constexpr Uint64 kSpirvHeaderWords = 5;
+
+        enum SpirvOp : uint32_t {
+            OpName = 5,
+            OpEntryPoint = 15,
+            OpExecutionMode = 16,
+            OpTypeBool = 20,
+            OpTypeInt = 21,
+            OpTypeFloat = 22,
+            OpTypeVector = 23,
+            OpTypeMatrix = 24,
+            OpTypeImage = 25,
+            OpTypeSampler = 26,
+            OpTypeSampledImage = 27,
+            OpTypeArray = 28,
+            OpTypeRuntimeArray = 29,
+            OpTypeStruct = 30,
+            OpTypePointer = 32,
+            OpConstant = 43,
+            OpConstantComposite = 44,
+            OpSpecConstantTrue = 48,
+            OpSpecConstantFalse = 49,
+            OpSpecConstant = 50,
+            OpSpecConstantComposite = 51,
+            OpVariable = 59,
+            OpDecorate = 71,
+            OpMemberDecorate = 72,
+            OpExecutionModeId = 331
+        };
+
+        enum SpirvDecoration : uint32_t {
+            DecorationSpecId = 1,
+            DecorationBlock = 2,
+            DecorationBufferBlock = 3,
+            DecorationArrayStride = 6,
+            DecorationMatrixStride = 7,
+            DecorationBuiltIn = 11,
+            DecorationLocation = 30,
+            DecorationNonWritable = 24,
+            DecorationNonReadable = 25,
+            DecorationBinding = 33,
+            DecorationDescriptorSet = 34,
+            DecorationOffset = 35
+        };
+
+        enum SpirvStorageClass : uint32_t {
+            StorageClassUniformConstant = 0,
+            StorageClassInput = 1,
+            StorageClassUniform = 2,
+            StorageClassPushConstant = 9,
+            StorageClassStorageBuffer = 12
+        };
+
+        constexpr uint32_t kExecutionModeLocalSize = 17;
+        constexpr uint32_t kExecutionModeLocalSizeId = 38;
+        constexpr uint32_t kBuiltInWorkgroupSize = 25;
+
+        struct Decorations {
+            bool hasSpecId = false;
+            bool hasBinding = false;
+            bool hasGroup = false;
+            bool block = false;
+            bool bufferBlock = false;
+            bool nonWritable = false;
+            bool nonReadable = false;
+            bool hasOffset = false;
+            bool hasLocation = false;
+
+            uint32_t specId = 0;
+            uint32_t binding = 0;
+            uint32_t group = 0;
+            uint32_t offset = 0;
+            uint32_t location = 0;
+            uint32_t arrayStride = 0;
+            uint32_t matrixStride = 0;
+            uint32_t builtIn = UINT32_MAX;
+        };
+
+        struct Type {
+            uint32_t opcode;
+            std::vector<uint32_t> operands;
+        };
+
+        struct Variable {
+            uint32_t id;
+            uint32_t pointerType;
+            uint32_t storageClass;
+        };
+
+        struct SpecConstant {
+            uint32_t id;
+            uint32_t type;
+            std::vector<uint32_t> value;
+        };
+
+        struct EntryPoint {
+            uint32_t executionModel;
+            uint32_t id;
+            std::string name;
+            std::vector<uint32_t> interfaces;
+            uint32_t localSize[3] = { 1, 1, 1 };
+            uint32_t localSizeIds[3] = { 0, 0, 0 };
+        };
+
+        struct SpirvModule {
+            std::unordered_map<uint32_t, std::string> names;
+            std::unordered_map<uint32_t, Decorations> decorations;
+            std::map<std::pair<uint32_t, uint32_t>, Decorations> memberDecorations;
+            std::unordered_map<uint32_t, Type> types;
+            std::unordered_map<uint32_t, uint32_t> constants;
+            std::unordered_map<uint32_t, std::vector<uint32_t>> composites;
+            std::vector<Variable> variables;
+            std::vector<SpecConstant> specConstants;
+            std::vector<EntryPoint> entryPoints;
+
+            const Type* getType(uint32_t id) const {
+                auto found = this->types.find(id);
+                return found != this->types.end() ? &found->second : nullptr;
+            }
+
+            Decorations getDecorations(uint32_t id) const {
+                auto found = this->decorations.find(id);
+                return found != this->decorations.end() ? found->second : Decorations{};
+            }
+
+            Decorations getMemberDecorations(uint32_t id, uint32_t member) const {
+                auto found = this->memberDecorations.find({ id, member });
+                return found != this->memberDecorations.end() ? found->second : Decorations{};
+            }
+
+            uint32_t getConstant(uint32_t id, uint32_t fallback) const {
+                auto found = this->constants.find(id);
+                return found != this->constants.end() ? found->second : fallback;
+            }
+        };
+
+        std::string readString(const uint32_t* words, Uint64 wordCount, Uint64& consumed) {
+            std::string value;
+
+            for (consumed = 0; consumed < wordCount; consumed++) {
+                char chars[4];
+                std::memcpy(chars, &words[consumed], 4);
+
+                for (char c : chars) {
+                    if (c == '\0') {
+                        consumed++;
+                        return value;
+                    }
+
+                    value.push_back(c);
+                }
+            }
+
+            return value;
+        }
+
+        void applyDecoration(Decorations& target, uint32_t decoration, const uint32_t* literals, Uint64 literalCount) {
+            uint32_t literal = literalCount > 0 ? literals[0] : 0;
+
+            switch (decoration) {
+                case DecorationSpecId: target.specId = literal; target.hasSpecId = true; break;
+                case DecorationBlock: target.block = true; break;
+                case DecorationBufferBlock: target.bufferBlock = true; break;
+                case DecorationArrayStride: target.arrayStride = literal; break;
+                case DecorationMatrixStride: target.matrixStride = literal; break;
+                case DecorationBuiltIn: target.builtIn = literal; break;
+                case DecorationNonWritable: target.nonWritable = true; break;
+                case DecorationNonReadable: target.nonReadable = true; break;
+                case DecorationBinding: target.binding = literal; target.hasBinding = true; break;
+                case DecorationDescriptorSet: target.group = literal; target.hasGroup = true; break;
+                case DecorationOffset: target.offset = literal; target.hasOffset = true; break;
+                case DecorationLocation: target.location = literal; target.hasLocation = true; break;
+            }
+        }
+
+        // Operands an instruction needs before parseModule reads them, 0 for instructions it skips
+        Uint64 getMinimumOperandCount(uint32_t opcode) {
+            switch (opcode) {
+                case OpName: return 2;
+                case OpEntryPoint: return 3;
+                case OpExecutionMode: case OpExecutionModeId: return 2;
+                case OpTypeBool: case OpTypeSampler: case OpTypeStruct: return 1;
+                case OpTypeFloat: case OpTypeSampledImage: case OpTypeRuntimeArray: return 2;
+                case OpTypeInt: case OpTypeVector: case OpTypeMatrix: case OpTypeArray: case OpTypePointer: return 3;
+                case OpTypeImage: return 8;
+                case OpConstant: case OpSpecConstant: return 2;
+                case OpSpecConstantTrue: case OpSpecConstantFalse: return 2;
+                case OpConstantComposite: case OpSpecConstantComposite: return 2;
+                case OpVariable: return 3;
+                case OpDecorate: return 2;
+                case OpMemberDecorate: return 3;
+            }
+
+            return 0;
+        }
+
+        // Types may only reference types declared before them, which also rules out a type
+        // containing itself. Pointers are exempt, they do not nest into the layout.
+        bool hasDeclaredOperandTypes(const SpirvModule& module, uint32_t opcode, const uint32_t* op, Uint64 operandCount) {
+            switch (opcode) {
+                case OpTypeVector: case OpTypeMatrix: case OpTypeImage: case OpTypeSampledImage:
+                case OpTypeArray: case OpTypeRuntimeArray:
+                    return module.getType(op[1]) != nullptr;
+
+                case OpTypeStruct:
+                    for (Uint64 i = 1; i < operandCount; i++) {
+                        if (module.getType(op[i]) == nullptr) {
+                            return false;
+                        }
+                    }
+                    return true;
+            }
+
+            return true;
+        }
+
+        bool parseModule(const uint32_t* words, Uint64 wordCount, SpirvModule& module, std::string& error) {
+            if (wordCount < kSpirvHeaderWords || words[0] != kSpirvMagic) {
+                error = "Shader code is not a SPIR-V binary";
+                return false;
+            }
+
+            Uint64 cursor = kSpirvHeaderWords;
+
+            while (cursor < wordCount) {
+                uint32_t opcode = words[cursor] & 0xFFFF;
+                uint32_t length = words[cursor] >> 16;
+
+                if (length == 0 || length > wordCount - cursor || length - 1 < getMinimumOperandCount(opcode)) {
+                    error = "SPIR-V instruction stream is malformed";
+                    return false;
+                }
+
+                const uint32_t* op = words + cursor + 1;
+                Uint64 operandCount = length - 1;
+                Uint64 consumed = 0;
+
+                switch (opcode) {
+                    case OpName:
+                        module.names[op[0]] = readString(op + 1, operandCount - 1, consumed);
+                        break;
+
+                    case OpEntryPoint: {
+                        EntryPoint entryPoint;
+                        entryPoint.executionModel = op[0];
+                        entryPoint.id = op[1];
+                        entryPoint.name = readString(op + 2, operandCount - 2, consumed);
+                        entryPoint.interfaces.assign(op + 2 + consumed, op + operandCount);
+
+                        module.entryPoints.push_back(entryPoint);
+                        break;
+                    }
+
+                    case OpExecutionMode:
+                    case OpExecutionModeId: {
+                        bool isLocalSize = opcode == OpExecutionMode && op[1] == kExecutionModeLocalSize;
+                        bool isLocalSizeId = op[1] == kExecutionModeLocalSizeId;
+
+                        for (auto& entryPoint : module.entryPoints) {
+                            if (entryPoint.id != op[0] || operandCount < 5) {
+                                continue;
+                            }
+
+                            for (Uint32 i = 0; i < 3; i++) {
+                                if (isLocalSize) {
+                                    entryPoint.localSize[i] = op[2 + i];
+                                } else if (isLocalSizeId) {
+                                    entryPoint.localSizeIds[i] = op[2 + i];
+                                }
+                            }
+                        }
+                        break;
+                    }
+
+                    case OpTypeBool: case OpTypeInt: case OpTypeFloat: case OpTypeVector: case OpTypeMatrix:
+                    case OpTypeImage: case OpTypeSampler: case OpTypeSampledImage: case OpTypeArray:
+                    case OpTypeRuntimeArray: case OpTypeStruct: case OpTypePointer:
+                        if (module.getType(op[0]) != nullptr || !hasDeclaredOperandTypes(module, opcode, op, operandCount)) {
+                            error = "SPIR-V instruction stream is malformed";
+                            return false;
+                        }
+
+                        module.types[op[0]] = Type{ opcode, std::vector<uint32_t>(op + 1, op + operandCount) };
+                        break;
+
+                    case OpConstant:
+                        if (operandCount >= 3) {
+                            module.constants[op[1]] = op[2];
+                        }
+                        break;
+
+                    case OpSpecConstant:
+                        if (operandCount >= 3) {
+                            module.constants[op[1]] = op[2];
+                        }
+
+                        module.specConstants.push_back(SpecConstant{ op[1], op[0], std::vector<uint32_t>(op + 2, op + operandCount) });
+                        break;
+
+                    case OpSpecConstantTrue:
+                    case OpSpecConstantFalse:
+                        module.specConstants.push_back(SpecConstant{ op[1], op[0], { opcode == OpSpecConstantTrue ? 1u : 0u } });
+                        break;
+
+                    case OpConstantComposite:
+                    case OpSpecConstantComposite:
+                        module.composites[op[1]] = std::vector<uint32_t>(op + 2, op + operandCount);
+                        break;
+
+                    case OpVariable:
+                        module.variables.push_back(Variable{ op[1], op[0], op[2] });
+                        break;
+
+                    case OpDecorate:
+                        applyDecoration(module.decorations[op[0]], op[1], op + 2, operandCount - 2);
+                        break;
+
+                    case OpMemberDecorate:
+                        applyDecoration(module.memberDecorations[{ op[0], op[1] }], op[2], op + 3, operandCount - 3);
+                        break;
+                }
+
+                cursor += length;
+            }
+
+            return true;
+        }
+
+        // ===========================================================================================================================
+        // Type Layout
+        // ===========================================================================================================================
+
+        // Byte size of a type inside a buffer block. A runtime array counts as one element,
+        // which is the minimum a binding has to provide.
+        Uint64 getTypeSize(const SpirvModule& module, uint32_t typeId, uint32_t matrixStride = 0) {
+            const Type* type = module.getType(typeId);
+            if (type == nullptr) {
+                return 0;
+            }
+
+            switch (type->opcode) {
+                case OpTypeBool:
+                    return 4;
+
+                case OpTypeInt:
+                case OpTypeFloat:
+                    return type->operands[0] / 8;
+
+                case OpTypeVector:
+                    return type->operands[1] * getTypeSize(module, type->operands[0]);
+
+                case OpTypeMatrix:
+                    return type->operands[1] * (matrixStride != 0 ? matrixStride : getTypeSize(module, type->operands[0]));
+
+                case OpTypeArray:
+                case OpTypeRuntimeArray: {
+                    uint32_t stride = module.getDecorations(typeId).arrayStride;
+                    Uint64 elementSize = stride != 0 ? stride : getTypeSize(module, type->operands[0], matrixStride);
+                    Uint64 length = type->opcode == OpTypeArray ? module.getConstant(type->operands[1], 1) : 1;
+
+                    return elementSize * length;
+                }
+
+                case OpTypeStruct: {
+                    Uint64 size = 0;
+
+                    for (uint32_t member = 0; member < type->operands.size(); member++) {
+                        Decorations decorations = module.getMemberDecorations(typeId, member);
+                        Uint64 offset = decorations.hasOffset ? decorations.offset : size;
+
+                        size = std::max(size, offset + getTypeSize(module, type->operands[member], decorations.matrixStride));
+                    }
+
+                    return size;
+                }
+
+                case OpTypePointer:
+                    return 8;
+            }
+
+            return 0;
+        }
+
+        bool getFormatFromSpirvImageFormat(uint32_t imageFormat, TextureFormat& format) {
+            switch (imageFormat) {
+                case 1: format = eRGBA32Float; return true;
+                case 2: format = eRGBA16Float; return true;
+                case 3: format = eR32float; return true;
+                case 4: format = eRGBA8Unorm; return true;
+                case 5: format = eRGBA8Snorm; return true;
+                case 6: format = eRG32Float; return true;
+                case 7: format = eRG16float; return true;
+                case 8: format = eRG11B10Ufloat; return true;
+                case 9: format = eR16Float; return true;
+                case 11: format = eRGB10A2Unorm; return true;
+                case 13: format = eRG8Unorm; return true;
+                case 15: format = eR8Unorm; return true;
+                case 18: format = eRG8Snorm; return true;
+                case 20: format = eR8Snorm; return true;
+                case 21: format = eRGBA32Sint; return true;
+                case 22: format = eRGBA16Sint; return true;
+                case 23: format = eRGBA8Sint; return true;
+                case 24: format = eR32sint; return true;
+                case 25: format = eRG32Sint; return true;
+                case 26: format = eRG16sint; return true;
+                case 27: format = eRG8Sint; return true;
+                case 28: format = eR16Sint; return true;
+                case 29: format = eR8Sint; return true;
+                case 30: format = eRGBA32Uint; return true;
+                case 31: format = eRGBA16Uint; return true;
+                case 32: format = eRGBA8Uint; return true;
+                case 33: format = eR32uint; return true;
+                case 34: format = eRGB10A2Uint; return true;
+                case 35: format = eRG32Uint; return true;
+                case 36: format = eRG16uint; return true;
+                case 37: format = eRG8Uint; return true;
+                case 38: format = eR16Uint; return true;
+                case 39: format = eR8Uint; return true;
+            }
+
+            return false;
+        }
+
+        bool getViewDimension(uint32_t dim, bool arrayed, TextureViewDimension& viewDimension) {
+            switch (dim) {
+                case 0: viewDimension = TextureViewDimension::e1D; return true;
+                case 1: case 4: viewDimension = arrayed ? TextureViewDimension::e2DArray : TextureViewDimension::e2D; return true;
+                case 2: viewDimension = TextureViewDimension::e3D; return true;
+                case 3: viewDimension = arrayed ? TextureViewDimension::eCubeArray : TextureViewDimension::eCube; return true;
+            }
+
+            return false;
+        }
+
+        bool getShaderStage(uint32_t executionModel, ShaderStage& stage) {
+            switch (executionModel) {
+                case 0: stage = ShaderStage::eVertex; return true;
+                case 1: case 2: stage = ShaderStage::eTessellation; return true;
+                case 4: stage = ShaderStage::eFragment; return true;
+                case 5: stage = ShaderStage::eCompute; return true;
+                case 5267: case 5364: stage = ShaderStage::eTask; return true;
+                case 5268: case 5365: stage = ShaderStage::eMesh; return true;
+            }
+
+            return false;
+        }
+
+        bool reflectImage(const SpirvModule& module, const Type& image, const Decorations& decorations,
+            BindGroupLayoutEntry& entry, std::string& error)
+        {
+            uint32_t dim = image.operands[1];
+            bool isDepth = image.operands[2] == 1;
+            bool isArrayed = image.operands[3] == 1;
+            bool isMultisampled = image.operands[4] == 1;
+            uint32_t sampled = image.operands[5];
+
+            TextureViewDimension viewDimension;
+            if (!getViewDimension(dim, isArrayed, viewDimension)) {
+                error = "Texel buffers and subpass inputs have no bind group layout equivalent";
+                return false;
+            }
+
+            if (sampled == 2) {
+                entry.type = BindingType::eStorageTexture;
+                entry.storageTexture.viewDimension = viewDimension;
+
+                if (!getFormatFromSpirvImageFormat(image.operands[6], entry.storageTexture.format)) {
+                    error = "Storage image has no declared or supported format";
+                    return false;
+                }
+
+                if (decorations.nonReadable) {
+                    entry.storageTexture.access = ResourceAccess::eWriteOnly;
+                } else if (decorations.nonWritable) {
+                    entry.storageTexture.access = ResourceAccess::eReadOnly;
+                } else {
+                    entry.storageTexture.access = ResourceAccess::eReadWrite;
+                }
+
+                return true;
+            }
+
+            entry.type = BindingType::eTexture;
+            entry.texture.viewDimension = viewDimension;
+            entry.texture.multisampled = isMultisampled;
+
+            const Type* sampledType = module.getType(image.operands[0]);
+
+            if (isDepth) {
+                entry.texture.sampleType = TextureSampleType::eDepth;
+            } else if (sampledType != nullptr && sampledType->opcode == OpTypeInt) {
+                entry.texture.sampleType = sampledType->operands[1] != 0 ? TextureSampleType::eSint : TextureSampleType::eUint;
+            } else {
+                entry.texture.sampleType = TextureSampleType::eFloat;
+            }
+
+            return true;
+        }
+
+        bool reflectVariable(const SpirvModule& module, const Variable& variable, ShaderStage stage,
+            ShaderReflection& reflection, std::string& error)
+        {
+            const Type* pointer = module.getType(variable.pointerType);
+            if (pointer == nullptr || pointer->opcode != OpTypePointer) {
+                return true;
+            }
+
+            uint32_t typeId = pointer->operands[1];
+            Decorations decorations = module.getDecorations(variable.id);
+
+            if (variable.storageClass == StorageClassPushConstant) {
+                const Type* block = module.getType(typeId);
+                Uint64 begin = 0;
+
+                if (block != nullptr && block->opcode == OpTypeStruct && !block->operands.empty()) {
+                    begin = UINT32_MAX;
+
+                    for (uint32_t member = 0; member < block->operands.size(); member++) {
+                        begin = std::min<Uint64>(begin, module.getMemberDecorations(typeId, member).offset);
+                    }
+                }
+
+                PushConstantRange range;
+                range.visibility = static_cast<ShaderStageFlags>(stage);
+                range.offset = static_cast<Uint32>(begin);
+                range.size = static_cast<Uint32>(getTypeSize(module, typeId) - begin);
+
+                reflection.pushConstantRanges.push_back(range);
+                return true;
+            }
+
+            if (variable.storageClass != StorageClassUniformConstant && variable.storageClass != StorageClassUniform
+                && variable.storageClass != StorageClassStorageBuffer) {
+                return true;
+            }
+
+            ReflectedBinding binding;
+            binding.group = decorations.group;
+            binding.name = module.names.count(variable.id) ? module.names.at(variable.id) : std::string{};
+            binding.entry = BindGroupLayoutEntry{};
+            binding.entry.binding = decorations.binding;
+            binding.entry.visibility = static_cast<ShaderStageFlags>(stage);
+
+            // Descriptor arrays wrap the resource type, possibly in several dimensions
+            const Type* type = module.getType(typeId);
+            while (type != nullptr && (type->opcode == OpTypeArray || type->opcode == OpTypeRuntimeArray)) {
+                if (type->opcode == OpTypeRuntimeArray) {
+                    binding.entry.count = 0;
+                } else {
+                    binding.entry.count *= module.getConstant(type->operands[1], 1);
+                }
+
+                typeId = type->operands[0];
+                type = module.getType(typeId);
+            }
+
+            if (type == nullptr) {
+                error = "Resource variable " + binding.name + " has an unknown type";
+                return false;
+            }
+
+            switch (type->opcode) {
+                case OpTypeStruct: {
+                    Decorations blockDecorations = module.getDecorations(typeId);
+                    bool isStorage = variable.storageClass == StorageClassStorageBuffer || blockDecorations.bufferBlock;
+
+                    bool isReadOnly = decorations.nonWritable;
+                    if (!isReadOnly && !type->operands.empty()) {
+                        isReadOnly = true;
+
+                        for (uint32_t member = 0; member < type->operands.size(); member++) {
+                            isReadOnly = isReadOnly && module.getMemberDecorations(typeId, member).nonWritable;
+                        }
+                    }
+
+                    binding.entry.type = BindingType::eBuffer;
+                    binding.entry.buffer.minBindingSize = getTypeSize(module, typeId);
+
+                    if (!isStorage) {
+                        binding.entry.buffer.type = BufferBindingType::eUniform;
+                    } else {
+                        binding.entry.buffer.type = isReadOnly ? BufferBindingType::eReadOnlyStorage : BufferBindingType::eStorage;
+                    }
+                    break;
+                }
+
+                case OpTypeSampler:
+                    binding.entry.type = BindingType::eSampler;
+                    binding.entry.sampler.type = SamplerBindingType::eFiltering;
+                    break;
+
+                case OpTypeImage:
+                    if (!reflectImage(module, *type, decorations, binding.entry, error)) {
+                        return false;
+                    }
+                    break;
+
+                case OpTypeSampledImage: {
+                    // Combined image samplers are reported as the texture half of the pair
+                    const Type* image = module.getType(type->operands[0]);
+                    if (image == nullptr || !reflectImage(module, *image, decorations, binding.entry, error)) {
+                        return false;
+                    }
+                    break;
+                }
+
+                default:
+                    return true;
+            }
+
+            reflection.bindings.push_back(binding);
+            return true;
+        }
+
+        bool getVertexInputFormat(const SpirvModule& module, uint32_t typeId, VertexFormat& format) {
+            const Type* type = module.getType(typeId);
+            uint32_t componentCount = 1;
+
+            if (type != nullptr && type->opcode == OpTypeVector) {
+                componentCount = type->operands[1];
+                type = module.getType(type->operands[0]);
+            }
+
+            if (type == nullptr || (type->opcode != OpTypeFloat && type->opcode != OpTypeInt) || type->operands[0] != 32) {
+                return false;
+            }
+
+            static const VertexFormat kFloatFormats[] = { eFloat32, eFloat32x2, eFloat32x3, eFloat32x4 };
+            static const VertexFormat kSintFormats[] = { eSint32, eSint32x2, eSint32x3, eSint32x4 };
+            static const VertexFormat kUintFormats[] = { eUint32, eUint32x2, eUint32x3, eUint32x4 };
+
+            if (componentCount < 1 || componentCount > 4) {
+                return false;
+            }
+
+            if (type->opcode == OpTypeFloat) {
+                format = kFloatFormats[componentCount - 1];
+            } else {
+                format = type->operands[1] != 0 ? kSintFormats[componentCount - 1] : kUintFormats[componentCount - 1];
+            }
+
+            return true;
+        }
+
+        bool reflectVertexInputs(const SpirvModule& module, const EntryPoint& entryPoint, ShaderReflection& reflection,
+            std::string& error)
+        {
+            for (const auto& variable : module.variables) {
+                if (variable.storageClass != StorageClassInput
+                    || std::find(entryPoint.interfaces.begin(), entryPoint.interfaces.end(), variable.id) == entryPoint.interfaces.end())
+                {
+                    continue;
+                }
+
+                Decorations decorations = module.getDecorations(variable.id);
+                const Type* pointer = module.getType(variable.pointerType);
+
+                if (!decorations.hasLocation || decorations.builtIn != UINT32_MAX || pointer == nullptr || pointer->opcode != OpTypePointer) {
+                    continue;
+                }
+
+                ShaderVertexInput input;
+                input.location = decorations.location;
+
+                if (!getVertexInputFormat(module, pointer->operands[1], input.format)) {
+                    std::string name = module.names.count(variable.id) ? module.names.at(variable.id) : std::string{};
+                    error = "Vertex input " + name + " at location " + std::to_string(input.location) + " has no matching vertex format";
+                    return false;
+                }
+
+                reflection.vertexInputs.push_back(input);
+            }
+
+            std::sort(reflection.vertexInputs.begin(), reflection.vertexInputs.end(), [](const ShaderVertexInput& a, const ShaderVertexInput& b) {
+                return a.location < b.location;
+            });
+
+            return true;
+        }
+
+        bool reflectConstant(const SpirvModule& module, const SpecConstant& constant, ReflectedConstant& reflected) {
+            Decorations decorations = module.getDecorations(constant.id);
+            const Type* type = module.getType(constant.type);
+
+            if (!decorations.hasSpecId || type == nullptr || constant.value.empty()) {
+                return false;
+            }
+
+            reflected.id = decorations.specId;
+            reflected.name = module.names.count(constant.id) ? module.names.at(constant.id) : std::string{};
+
+            uint64_t bits = constant.value[0];
+            if (constant.value.size() > 1) {
+                bits |= static_cast<uint64_t>(constant.value[1]) << 32;
+            }
+
+            if (type->opcode == OpTypeBool) {
+                reflected.type = ConstantType::eBool;
+                reflected.defaultValue = bits != 0 ? 1.0 : 0.0;
+                return true;
+            }
+
+            if (type->opcode != OpTypeFloat && type->opcode != OpTypeInt) {
+                return false;
+            }
+
+            uint32_t width = type->operands[0];
+            if (width != 32 && width != 64) {
+                return false;
+            }
+
+            if (type->opcode == OpTypeFloat) {
+                reflected.type = width == 32 ? ConstantType::eFloat32 : ConstantType::eFloat64;
+
+                if (width == 32) {
+                    float value;
+                    uint32_t low = static_cast<uint32_t>(bits);
+                    std::memcpy(&value, &low, sizeof(value));
+
+                    reflected.defaultValue = value;
+                } else {
+                    std::memcpy(&reflected.defaultValue, &bits, sizeof(bits));
+                }
+
+                return true;
+            }
+
+            bool isSigned = type->operands[1] != 0;
+
+            if (width == 32) {
+                reflected.type = isSigned ? ConstantType::eInt32 : ConstantType::eUint32;
+                reflected.defaultValue = isSigned
+                    ? static_cast<Float64>(static_cast<int32_t>(bits))
+                    : static_cast<Float64>(static_cast<uint32_t>(bits));
+            } else {
+                reflected.type = isSigned ? ConstantType::eInt64 : ConstantType::eUint64;
+                reflected.defaultValue = isSigned
+                    ? static_cast<Float64>(static_cast<int64_t>(bits))
+                    : static_cast<Float64>(bits);
+            }
+
+            return true;
+        }
+
+        bool isSameLayout(const BindGroupLayoutEntry& a, const BindGroupLayoutEntry& b) {
+            if (a.type != b.type || a.count != b.count) {
+                return false;
+            }
+
+            switch (a.type) {
+                case BindingType::eBuffer:
+                    return (a.buffer.type == BufferBindingType::eUniform) == (b.buffer.type == BufferBindingType::eUniform);
+
+                case BindingType::eSampler:
+                    return a.sampler.type == b.sampler.type;
+
+                case BindingType::eTexture:
+                    return a.texture.sampleType == b.texture.sampleType && a.texture.viewDimension == b.texture.viewDimension
+                        && a.texture.multisampled == b.texture.multisampled;
+
+                case BindingType::eStorageTexture:
+                    return a.storageTexture.format == b.storageTexture.format
+                        && a.storageTexture.viewDimension == b.storageTexture.viewDimension;
+            }
+
+            return false;
+        }
+    };
+
+    // ===========================================================================================================================
+    // Reflection
+    // ===========================================================================================================================
+
+    bool reflectSpirv(const uint32_t* words, Uint64 wordCount, const char* entryPoint,
+        ShaderReflection& reflection, std::string& error)
+    {
+        SpirvModule module;
+        if (!parseModule(words, wordCount, module, error)) {
+            return false;
+        }
+
+        const EntryPoint* selected = nullptr;
+        for (const auto& candidate : module.entryPoints) {
+            if (entryPoint == nullptr || candidate.name == entryPoint) {
+                selected = &candidate;
+                break;
+            }
+        }
+
+        if (selected == nullptr) {
+            error = std::string("Entry point ") + (entryPoint ? entryPoint : "") + " not found in SPIR-V module";
+            return false;
+        }
+
+        reflection = ShaderReflection{};
+        reflection.entryPoint = selected->name;
+
+        if (!getShaderStage(selected->executionModel, reflection.stage)) {
+            error = "Entry point " + selected->name + " uses an unsupported execution model";
+            return false;
+        }
+
+        for (Uint32 i = 0; i < 3; i++) {
+            reflection.workgroupSize[i] = selected->localSizeIds[i] != 0
+                ? module.getConstant(selected->localSizeIds[i], 1)
+                : selected->localSize[i];
+        }
+
+        // A constant decorated as the WorkgroupSize built-in overrides the execution mode
+        for (const auto& composite : module.composites) {
+            if (module.getDecorations(composite.first).builtIn == kBuiltInWorkgroupSize && composite.second.size() == 3) {
+                for (Uint32 i = 0; i < 3; i++) {
+                    reflection.workgroupSize[i] = module.getConstant(composite.second[i], 1);
+                }
+            }
+        }
+
+        for (const auto& variable : module.variables) {
+            if (!reflectVariable(module, variable, reflection.stage, reflection, error)) {
+                return false;
+            }
+        }
+
+        if (reflection.stage == ShaderStage::eVertex && !reflectVertexInputs(module, *selected, reflection, error)) {
+            return false;
+        }
+
+        // Half precision and composite spec constants are skipped, they cannot be set from a Float64
+        for (const auto& constant : module.specConstants) {
+            ReflectedConstant reflected;
+            if (reflectConstant(module, constant, reflected)) {
+                reflection.constants.push_back(reflected);
+            }
+        }
+
+        std::sort(reflection.constants.begin(), reflection.constants.end(), [](const ReflectedConstant& a, const ReflectedConstant& b) {
+            return a.id < b.id;
+        });
+
+        return true;
+    }
+
+    bool reflectShaderModule(const ShaderModuleDescriptor& descriptor, const char* entryPoint,
+        ShaderReflection& reflection, std::string& error)
+    {
+        if (descriptor.code == nullptr || descriptor.codeSize == 0 || descriptor.codeSize % 4 != 0) {
+            error = "Shader module does not hold a SPIR-V binary";
+            return false;
+        }
+
+        // code is a char pointer with no alignment guarantee
+        std::vector<uint32_t> words(descriptor.codeSize / 4);
+        std::memcpy(words.data(), descriptor.code, descriptor.codeSize);
+
+        return reflectSpirv(words.data(), words.size(), entryPoint, reflection, error);
+    }
+
+    bool validateVertexInputs(const ShaderReflection& reflection, const std::vector<VertexBufferLayout>& buffers,
+        std::string& error)
+    {
+        for (const auto& input : reflection.vertexInputs) {
+            const VertexAttribute* found = nullptr;
+
+            for (const auto& buffer : buffers) {
+                for (const auto& attribute : buffer.attributes) {
+                    if (attribute.shaderLocation == input.location) {
+                        found = &attribute;
+                    }
+                }
+            }
+
+            if (found == nullptr) {
+                error = "No vertex attribute feeds shader location " + std::to_string(input.location);
+                return false;
+            }
+
+            if (!isVertexFormatCompatible(found->format, input.format)) {
+                error = "Vertex attribute at location " + std::to_string(input.location)
+                    + " does not match the component type the shader reads";
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool mergeShaderReflections(const std::vector<const ShaderReflection*>& reflections, Uint32 maxBindGroups,
+        std::vector<BindGroupLayoutDescriptor>& groups, std::vector<PushConstantRange>& pushConstantRanges,
+        std::string& error)
+    {
+        std::map<std::pair<Uint32, Uint32>, BindGroupLayoutEntry> merged;
+        groups.clear();
+        pushConstantRanges.clear();
+
+        for (const ShaderReflection* reflection : reflections) {
+            for (const auto& binding : reflection->bindings) {
+                // The set index comes straight from the SPIR-V and sizes the group list below
+                if (binding.group >= maxBindGroups) {
+                    error = "Binding " + std::to_string(binding.entry.binding) + " uses set " + std::to_string(binding.group)
+                        + ", the device supports " + std::to_string(maxBindGroups) + " bind groups";
+                    return false;
+                }
+
+                auto key = std::make_pair(binding.group, binding.entry.binding);
+                auto found = merged.find(key);
+
+                if (found == merged.end()) {
+                    merged.emplace(key, binding.entry);
+                    continue;
+                }
+
+                BindGroupLayoutEntry& entry = found->second;
+
+                if (!isSameLayout(entry, binding.entry)) {
+                    error = "Binding " + std::to_string(binding.entry.binding) + " of group " + std::to_string(binding.group)
+                        + " is declared differently across stages";
+                    return false;
+                }
+
+                entry.visibility |= binding.entry.visibility;
+
+                if (entry.type == BindingType::eBuffer) {
+                    entry.buffer.minBindingSize = std::max(entry.buffer.minBindingSize, binding.entry.buffer.minBindingSize);
+
+                    // One stage writing the buffer makes the shared binding writable
+                    if (binding.entry.buffer.type == BufferBindingType::eStorage) {
+                        entry.buffer.type = BufferBindingType::eStorage;
+                    }
+                }
+
+                if (entry.type == BindingType::eStorageTexture && entry.storageTexture.access != binding.entry.storageTexture.access) {
+                    entry.storageTexture.access = ResourceAccess::eReadWrite;
+                }
+            }
+
+            for (const auto& range : reflection->pushConstantRanges) {
+                auto same = std::find_if(pushConstantRanges.begin(), pushConstantRanges.end(), [&range](const PushConstantRange& other) {
+                    return other.offset == range.offset && other.size == range.size;
+                });
+
+                if (same != pushConstantRanges.end()) {
+                    same->visibility |= range.visibility;
+                } else {
+                    pushConstantRanges.push_back(range);
+                }
+            }
+        }
+
+        // std::map keeps (group, binding) ordered, so every group comes out sorted
+        for (const auto& item : merged) {
+            Uint32 group = item.first.first;
+
+            if (groups.size() <= group) {
+                groups.resize(group + 1);
+            }
+
+            groups[group].entries.push_back(item.second);
+        }
+
+        return true;
+    }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "struct_layout.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Shader Reflection
+    // ===========================================================================================================================
+
+    struct ReflectedBinding {
+        Uint32 group;
+        BindGroupLayoutEntry entry;
+        std::string name;
+    };
+
+    enum class ConstantType : Uint8 {
+        eBool,
+        eInt32,
+        eUint32,
+        eFloat32,
+        eInt64,
+        eUint64,
+        eFloat64
+    };
+
+    struct ReflectedConstant {
+        Uint32 id;
+        ConstantType type;
+        Float64 defaultValue;
+        std::string name;
+    };
+
+    struct ShaderReflection {
+        ShaderStage stage;
+        std::string entryPoint;
+
+        std::vector<ReflectedBinding> bindings;
+        std::vector<PushConstantRange> pushConstantRanges;
+
+        // Specialization constants sorted by id
+        std::vector<ReflectedConstant> constants;
+
+        // Only meaningful for compute, task and mesh stages
+        Uint32 workgroupSize[3] = { 1, 1, 1 };
+
+        // Vertex stage only, sorted by location
+        std::vector<ShaderVertexInput> vertexInputs;
+    };
+
+    // Reflects the resources of a SPIR-V module as seen by one entry point. entryPoint may be
+    // nullptr when the module has a single entry point. Every resource variable declared in the
+    // module is reported, whether or not the entry point uses it.
+    bool reflectSpirv(const uint32_t* words, Uint64 wordCount, const char* entryPoint,
+        ShaderReflection& reflection, std::string& error);
+
+    bool reflectShaderModule(const ShaderModuleDescriptor& descriptor, const char* entryPoint,
+        ShaderReflection& reflection, std::string& error);
+
+    // Every vertex input of the reflected vertex stage is fed by an attribute of a compatible format
+    bool validateVertexInputs(const ShaderReflection& reflection, const std::vector<VertexBufferLayout>& buffers,
+        std::string& error);
+
+    // Merges stage reflections into per-group layouts. A binding used by several stages gets
+    // the union of their visibility, conflicting declarations of the same binding fail.
+    // Entries inside every group are sorted by binding number. Groups at or past maxBindGroups,
+    // the device limit, fail.
+    bool mergeShaderReflections(const std::vector<const ShaderReflection*>& reflections, Uint32 maxBindGroups,
+        std::vector<BindGroupLayoutDescriptor>& groups, std::vector<PushConstantRange>& pushConstantRanges,
+        std::string& error);
+};
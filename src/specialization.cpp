@@ -0,0 +1,133 @@
+#include "specialization.hpp"
+
+#include "hash.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Rhi {
+    namespace {
+        template <typename T>
+        void appendValue(std::vector<uint8_t>& data, T value) {
+            size_t offset = data.size();
+
+            data.resize(offset + sizeof(T));
+            std::memcpy(data.data() + offset, &value, sizeof(T));
+        }
+    };
+
+    const SpecializationBlock* SpecializationBlockPool::intern(std::vector<SpecializationConstant> constants) {
+        std::stable_sort(constants.begin(), constants.end(), [](const SpecializationConstant& a, const SpecializationConstant& b) {
+            return a.id < b.id;
+        });
+
+        // Keep the last value of every id, stable sort left them in submission order
+        std::vector<SpecializationConstant> unique;
+        for (const auto& constant : constants) {
+            if (!unique.empty() && unique.back().id == constant.id) {
+                unique.back().value = constant.value;
+            } else {
+                unique.push_back(constant);
+            }
+        }
+
+        Uint64 hash = kHashSeed;
+        for (auto& constant : unique) {
+            // -0.0 and 0.0 specialize to the same code, let them share a block
+            if (constant.value == 0.0) {
+                constant.value = 0.0;
+            }
+
+            hash = hashCombine(hash, constant.id);
+            hash = hashValue(constant.value, hash);
+        }
+
+        std::lock_guard<std::mutex> lock{ this->mutex };
+
+        auto range = this->blocks.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            const auto& existing = it->second->constants;
+
+            bool isEqual = existing.size() == unique.size() && std::equal(existing.begin(), existing.end(), unique.begin(),
+                [](const SpecializationConstant& a, const SpecializationConstant& b) {
+                    return a.id == b.id && std::memcmp(&a.value, &b.value, sizeof(Float64)) == 0;
+                });
+
+            if (isEqual) {
+                return it->second.get();
+            }
+        }
+
+        auto block = std::make_unique<SpecializationBlock>();
+        block->constants = std::move(unique);
+        block->hash = hash;
+
+        return this->blocks.emplace(hash, std::move(block))->second.get();
+    }
+
+    const SpecializationBlock* SpecializationBlockPool::intern(const ShaderReflection& reflection,
+        const std::vector<std::pair<std::string, Float64>>& namedConstants, std::string& error)
+    {
+        std::vector<SpecializationConstant> constants;
+
+        for (const auto& named : namedConstants) {
+            auto found = std::find_if(reflection.constants.begin(), reflection.constants.end(), [&named](const ReflectedConstant& constant) {
+                return constant.name == named.first;
+            });
+
+            if (found == reflection.constants.end()) {
+                error = "Shader has no specialization constant named " + named.first;
+                return nullptr;
+            }
+
+            constants.push_back(SpecializationConstant{ found->id, named.second });
+        }
+
+        return this->intern(std::move(constants));
+    }
+
+    bool buildSpecializationData(const SpecializationBlock* block, const ShaderReflection& reflection,
+        SpecializationData& specialization, std::string& error)
+    {
+        specialization.entries.clear();
+        specialization.data.clear();
+
+        if (block == nullptr) {
+            return true;
+        }
+
+        // Both lists are sorted by id, walk them together
+        auto declared = reflection.constants.begin();
+
+        for (const auto& constant : block->constants) {
+            while (declared != reflection.constants.end() && declared->id < constant.id) {
+                ++declared;
+            }
+
+            if (declared == reflection.constants.end() || declared->id != constant.id) {
+                error = "Shader entry point " + reflection.entryPoint + " declares no specialization constant "
+                    + std::to_string(constant.id);
+                return false;
+            }
+
+            SpecializationMapEntry entry;
+            entry.constantId = constant.id;
+            entry.offset = static_cast<Uint32>(specialization.data.size());
+
+            switch (declared->type) {
+                case ConstantType::eBool: appendValue<uint32_t>(specialization.data, constant.value != 0.0 ? 1 : 0); break;
+                case ConstantType::eInt32: appendValue(specialization.data, static_cast<int32_t>(constant.value)); break;
+                case ConstantType::eUint32: appendValue(specialization.data, static_cast<uint32_t>(constant.value)); break;
+                case ConstantType::eFloat32: appendValue(specialization.data, static_cast<float>(constant.value)); break;
+                case ConstantType::eInt64: appendValue(specialization.data, static_cast<int64_t>(constant.value)); break;
+                case ConstantType::eUint64: appendValue(specialization.data, static_cast<uint64_t>(constant.value)); break;
+                case ConstantType::eFloat64: appendValue(specialization.data, constant.value); break;
+            }
+
+            entry.size = specialization.data.size() - entry.offset;
+            specialization.entries.push_back(entry);
+        }
+
+        return true;
+    }
+};
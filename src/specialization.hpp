@@ -0,0 +1,49 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "shader_reflection.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Specialization Block Pool
+    // ===========================================================================================================================
+
+    class SpecializationBlockPool {
+    public:
+        // Sorts the constants by id, a repeated id keeps its last value. Equal sets return the
+        // same block, which stays valid for the lifetime of the pool.
+        const SpecializationBlock* intern(std::vector<SpecializationConstant> constants);
+
+        // Same, with constants named as in the shader source and resolved through reflection
+        const SpecializationBlock* intern(const ShaderReflection& reflection,
+            const std::vector<std::pair<std::string, Float64>>& namedConstants, std::string& error);
+
+    private:
+        std::mutex mutex;
+        std::unordered_multimap<Uint64, std::unique_ptr<SpecializationBlock>> blocks;
+    };
+
+    // ===========================================================================================================================
+    // Specialization Data
+    // ===========================================================================================================================
+
+    // Mirrors VkSpecializationMapEntry
+    struct SpecializationMapEntry {
+        Uint32 constantId;
+        Uint32 offset;
+        Uint64 size;
+    };
+
+    struct SpecializationData {
+        std::vector<SpecializationMapEntry> entries;
+        std::vector<uint8_t> data;
+    };
+
+    // Converts each Float64 to the type the shader declares, the way backends hand the values to
+    // the driver. Ids the shader does not declare fail, so typos do not silently keep defaults.
+    bool buildSpecializationData(const SpecializationBlock* block, const ShaderReflection& reflection,
+        SpecializationData& specialization, std::string& error);
+};
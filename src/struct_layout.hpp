@@ -0,0 +1,349 @@
+#pragma once
+
+#include "format_traits.hpp"
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Shader Types
+    // ===========================================================================================================================
+
+    // Host mirrors of shader vectors and matrices. They only carry 4 byte alignment, so buffer
+    // structs place them at the offsets the layout rules ask for with explicit padding members,
+    // which isBufferLayout checks.
+    template <typename T, Uint32 N>
+    struct ShaderVector {
+        static_assert(sizeof(T) == 4 && N >= 2 && N <= 4, "Shader vectors hold two to four 32 bit components");
+
+        T v[N];
+
+        constexpr T& operator[](Uint32 index) { return this->v[index]; }
+        constexpr const T& operator[](Uint32 index) const { return this->v[index]; }
+    };
+
+    using Float2 = ShaderVector<float, 2>;
+    using Float3 = ShaderVector<float, 3>;
+    using Float4 = ShaderVector<float, 4>;
+    using Int2 = ShaderVector<int32_t, 2>;
+    using Int3 = ShaderVector<int32_t, 3>;
+    using Int4 = ShaderVector<int32_t, 4>;
+    using Uint2 = ShaderVector<uint32_t, 2>;
+    using Uint3 = ShaderVector<uint32_t, 3>;
+    using Uint4 = ShaderVector<uint32_t, 4>;
+
+    // Column major, named columns x rows as in GLSL. Columns are padded to four floats, which is
+    // what both std140 and std430 do for three and four row matrices.
+    template <Uint32 Columns, Uint32 Rows>
+    struct ShaderMatrix {
+        static_assert(Rows == 3 || Rows == 4, "Two row matrices have a different column stride per layout rule");
+
+        float columns[Columns][4];
+    };
+
+    using Float3x3 = ShaderMatrix<3, 3>;
+    using Float4x3 = ShaderMatrix<4, 3>;
+    using Float4x4 = ShaderMatrix<4, 4>;
+
+    // Vertex attributes stored in a narrower format than the shader reads
+    template <typename T, Uint32 N, VertexFormat Format>
+    struct PackedVertex {
+        T v[N];
+    };
+
+    using Uint8x4 = PackedVertex<uint8_t, 4, eUint8x4>;
+    using Unorm8x4 = PackedVertex<uint8_t, 4, eUnorm8x4>;
+    using Snorm8x4 = PackedVertex<int8_t, 4, eSnorm8x4>;
+    using Uint16x2 = PackedVertex<uint16_t, 2, eUint16x2>;
+    using Uint16x4 = PackedVertex<uint16_t, 4, eUint16x4>;
+    using Unorm16x2 = PackedVertex<uint16_t, 2, eUnorm16x2>;
+    using Unorm16x4 = PackedVertex<uint16_t, 4, eUnorm16x4>;
+    using Snorm16x2 = PackedVertex<int16_t, 2, eSnorm16x2>;
+    using Snorm16x4 = PackedVertex<int16_t, 4, eSnorm16x4>;
+    using Half2 = PackedVertex<uint16_t, 2, eFloat16x2>;
+    using Half4 = PackedVertex<uint16_t, 4, eFloat16x4>;
+    using Unorm1010102 = PackedVertex<uint32_t, 1, eUnorm1010102>;
+
+    // ===========================================================================================================================
+    // Vertex Formats
+    // ===========================================================================================================================
+
+    // A missing or extra component is filled in or dropped by the input assembler, the
+    // component type has to agree
+    constexpr bool isVertexFormatCompatible(VertexFormat attribute, VertexFormat input) {
+        return getVertexFormatTraits(attribute).type == getVertexFormatTraits(input).type;
+    }
+
+    template <typename T>
+    struct VertexFormatOf;
+
+    template <> struct VertexFormatOf<float> { static constexpr VertexFormat value = eFloat32; };
+    template <> struct VertexFormatOf<int32_t> { static constexpr VertexFormat value = eSint32; };
+    template <> struct VertexFormatOf<uint32_t> { static constexpr VertexFormat value = eUint32; };
+
+    template <> struct VertexFormatOf<Float2> { static constexpr VertexFormat value = eFloat32x2; };
+    template <> struct VertexFormatOf<Float3> { static constexpr VertexFormat value = eFloat32x3; };
+    template <> struct VertexFormatOf<Float4> { static constexpr VertexFormat value = eFloat32x4; };
+    template <> struct VertexFormatOf<Int2> { static constexpr VertexFormat value = eSint32x2; };
+    template <> struct VertexFormatOf<Int3> { static constexpr VertexFormat value = eSint32x3; };
+    template <> struct VertexFormatOf<Int4> { static constexpr VertexFormat value = eSint32x4; };
+    template <> struct VertexFormatOf<Uint2> { static constexpr VertexFormat value = eUint32x2; };
+    template <> struct VertexFormatOf<Uint3> { static constexpr VertexFormat value = eUint32x3; };
+    template <> struct VertexFormatOf<Uint4> { static constexpr VertexFormat value = eUint32x4; };
+
+    template <size_t N> struct VertexFormatOf<float[N]> : VertexFormatOf<ShaderVector<float, N>> {};
+    template <size_t N> struct VertexFormatOf<int32_t[N]> : VertexFormatOf<ShaderVector<int32_t, N>> {};
+    template <size_t N> struct VertexFormatOf<uint32_t[N]> : VertexFormatOf<ShaderVector<uint32_t, N>> {};
+
+    template <typename T, Uint32 N, VertexFormat Format>
+    struct VertexFormatOf<PackedVertex<T, N, Format>> {
+        static_assert(sizeof(T) * N == getVertexFormatTraits(Format).size, "Packed vertex type does not match its format size");
+
+        static constexpr VertexFormat value = Format;
+    };
+
+    // ===========================================================================================================================
+    // Static Vertex Layouts
+    // ===========================================================================================================================
+
+    template <size_t N>
+    struct StaticVertexLayout {
+        Uint64 arrayStride;
+        VertexStepMode stepMode;
+        std::array<VertexAttribute, N> attributes;
+
+        // VertexState keeps its attributes in a vector, this only copies the table
+        VertexBufferLayout getDescriptor() const {
+            return VertexBufferLayout{ this->arrayStride, this->stepMode,
+                std::vector<VertexAttribute>(this->attributes.begin(), this->attributes.end()) };
+        }
+    };
+
+    // The format comes from the member type, see VertexFormatOf. Vertex has to be standard layout.
+    #define RHI_VERTEX_ATTRIBUTE(Vertex, member, location)                                                                        \
+        ::Rhi::VertexAttribute{ ::Rhi::VertexFormatOf<std::remove_cv_t<decltype(Vertex::member)>>::value, offsetof(Vertex, member), \
+            location }
+
+    //  struct MeshVertex { Float3 position; Snorm8x4 normal; Unorm16x2 texCoord; };
+    //
+    //  constexpr auto kMeshVertexLayout = makeVertexLayout<MeshVertex>(eVertex,
+    //      RHI_VERTEX_ATTRIBUTE(MeshVertex, position, 0),
+    //      RHI_VERTEX_ATTRIBUTE(MeshVertex, normal, 1),
+    //      RHI_VERTEX_ATTRIBUTE(MeshVertex, texCoord, 2));
+    //
+    //  static_assert(isValidVertexLayout(kMeshVertexLayout), "");
+    template <typename Vertex, typename... Attributes>
+    constexpr StaticVertexLayout<sizeof...(Attributes)> makeVertexLayout(VertexStepMode stepMode, Attributes... attributes) {
+        static_assert(std::is_standard_layout<Vertex>::value, "Vertex attributes are located with offsetof");
+
+        return StaticVertexLayout<sizeof...(Attributes)>{ sizeof(Vertex), stepMode, { { attributes... } } };
+    }
+
+    // Attributes inside the stride, 4 byte aligned, not overlapping and at distinct locations
+    template <size_t N>
+    constexpr bool isValidVertexLayout(const StaticVertexLayout<N>& layout) {
+        if (layout.arrayStride % 4 != 0) {
+            return false;
+        }
+
+        for (size_t i = 0; i < N; i++) {
+            const VertexAttribute& a = layout.attributes[i];
+            Uint64 aEnd = a.offset + getVertexFormatTraits(a.format).size;
+
+            if (a.offset % 4 != 0 || aEnd > layout.arrayStride) {
+                return false;
+            }
+
+            for (size_t j = i + 1; j < N; j++) {
+                const VertexAttribute& b = layout.attributes[j];
+                Uint64 bEnd = b.offset + getVertexFormatTraits(b.format).size;
+
+                if (a.shaderLocation == b.shaderLocation || (a.offset < bEnd && b.offset < aEnd)) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // ===========================================================================================================================
+    // Shader Vertex Inputs
+    // ===========================================================================================================================
+
+    // A vertex shader input, with the 32 bit format of its shader type. ShaderReflection lists
+    // these at runtime, ShaderCompiler --reflect-header emits them as constexpr tables.
+    struct ShaderVertexInput {
+        Uint32 location;
+        VertexFormat format;
+    };
+
+    namespace Detail {
+        template <size_t N>
+        constexpr bool hasVertexInput(const StaticVertexLayout<N>& layout, const ShaderVertexInput& input) {
+            for (size_t i = 0; i < N; i++) {
+                if (layout.attributes[i].shaderLocation == input.location) {
+                    return isVertexFormatCompatible(layout.attributes[i].format, input.format);
+                }
+            }
+
+            return false;
+        }
+    };
+
+    // Every shader input is fed by one of the layouts with a compatible format, checked at
+    // compile time when both sides are constexpr
+    template <size_t M, typename... Layouts>
+    constexpr bool matchesVertexInputs(const std::array<ShaderVertexInput, M>& inputs, const Layouts&... layouts) {
+        for (size_t i = 0; i < M; i++) {
+            if (!(Detail::hasVertexInput(layouts, inputs[i]) || ...)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // ===========================================================================================================================
+    // Buffer Layouts
+    // ===========================================================================================================================
+
+    enum class BufferLayoutRule : Uint8 {
+        eStd140,
+        eStd430
+    };
+
+    struct ShaderTypeLayout {
+        Uint64 alignment;
+        Uint64 size;
+    };
+
+    constexpr Uint64 alignShaderOffset(Uint64 offset, Uint64 alignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    // Base alignment and size of a type under a layout rule. Specialize it for other host types,
+    // nested structs can return getBufferStructLayout of their fields.
+    template <typename T>
+    struct ShaderTypeOf;
+
+    template <typename T>
+    struct ShaderScalarType {
+        static constexpr ShaderTypeLayout get(BufferLayoutRule) { return { 4, 4 }; }
+    };
+
+    template <> struct ShaderTypeOf<float> : ShaderScalarType<float> {};
+    template <> struct ShaderTypeOf<int32_t> : ShaderScalarType<int32_t> {};
+    template <> struct ShaderTypeOf<uint32_t> : ShaderScalarType<uint32_t> {};
+
+    template <typename T, Uint32 N>
+    struct ShaderTypeOf<ShaderVector<T, N>> {
+        static constexpr ShaderTypeLayout get(BufferLayoutRule) { return { N == 2 ? 8u : 16u, N * 4u }; }
+    };
+
+    template <Uint32 Columns, Uint32 Rows>
+    struct ShaderTypeOf<ShaderMatrix<Columns, Rows>> {
+        static constexpr ShaderTypeLayout get(BufferLayoutRule) { return { 16, Columns * 16u }; }
+    };
+
+    // std140 rounds array strides and alignment up to 16, std430 keeps the element's
+    constexpr Uint64 getShaderArrayStride(BufferLayoutRule rule, ShaderTypeLayout element) {
+        Uint64 stride = alignShaderOffset(element.size, element.alignment);
+        return rule == BufferLayoutRule::eStd140 ? alignShaderOffset(stride, 16) : stride;
+    }
+
+    template <typename T, size_t N>
+    struct ShaderTypeOf<T[N]> {
+        static constexpr ShaderTypeLayout get(BufferLayoutRule rule) {
+            ShaderTypeLayout element = ShaderTypeOf<T>::get(rule);
+            Uint64 alignment = rule == BufferLayoutRule::eStd140 ? alignShaderOffset(element.alignment, 16) : element.alignment;
+
+            return { alignment, getShaderArrayStride(rule, element) * N };
+        }
+    };
+
+    // Array with the element stride of one rule, so scalar and vec2 arrays can live in std140 blocks
+    template <typename T, size_t N, BufferLayoutRule Rule>
+    struct ShaderArray {
+        static constexpr Uint64 kStride = getShaderArrayStride(Rule, ShaderTypeOf<T>::get(Rule));
+
+        struct Element {
+            T value;
+            uint8_t padding[kStride - sizeof(T) + (kStride == sizeof(T) ? 1 : 0)];
+        };
+
+        // Padding of the last element is part of the array, as in the shader
+        std::conditional_t<kStride == sizeof(T), T, Element> elements[N];
+
+        constexpr T& operator[](size_t index) { return get(this->elements[index]); }
+        constexpr const T& operator[](size_t index) const { return get(this->elements[index]); }
+
+    private:
+        static constexpr T& get(T& element) { return element; }
+        static constexpr const T& get(const T& element) { return element; }
+        static constexpr T& get(Element& element) { return element.value; }
+        static constexpr const T& get(const Element& element) { return element.value; }
+    };
+
+    template <typename T, size_t N, BufferLayoutRule Rule>
+    struct ShaderTypeOf<ShaderArray<T, N, Rule>> : ShaderTypeOf<T[N]> {};
+
+    struct ShaderField {
+        Uint64 offset;
+        Uint64 hostSize;
+
+        // Indexed by BufferLayoutRule
+        ShaderTypeLayout layouts[2];
+    };
+
+    #define RHI_SHADER_FIELD(Struct, member)                                                                                      \
+        ::Rhi::ShaderField{ offsetof(Struct, member), sizeof(Struct::member), {                                                 \
+            ::Rhi::ShaderTypeOf<std::remove_cv_t<decltype(Struct::member)>>::get(::Rhi::BufferLayoutRule::eStd140),              \
+            ::Rhi::ShaderTypeOf<std::remove_cv_t<decltype(Struct::member)>>::get(::Rhi::BufferLayoutRule::eStd430) } }
+
+    // Alignment and padded size of a struct with these fields, in declaration order
+    template <size_t N>
+    constexpr ShaderTypeLayout getBufferStructLayout(BufferLayoutRule rule, const ShaderField (&fields)[N]) {
+        Uint64 alignment = rule == BufferLayoutRule::eStd140 ? 16 : 4;
+        Uint64 cursor = 0;
+
+        for (size_t i = 0; i < N; i++) {
+            const ShaderTypeLayout& field = fields[i].layouts[static_cast<Uint32>(rule)];
+
+            alignment = field.alignment > alignment ? field.alignment : alignment;
+            cursor = alignShaderOffset(cursor, field.alignment) + field.size;
+        }
+
+        return { alignment, alignShaderOffset(cursor, alignment) };
+    }
+
+    // Every field sits at the offset and has the size the rule gives it, and sizeof(Struct)
+    // includes the tail padding, so the struct can be copied into the buffer as is, arrays of
+    // it included.
+    //
+    //  struct Light { Float3 direction; float intensity; Float4x4 shadowMatrix; };
+    //
+    //  constexpr ShaderField kLightFields[] = {
+    //      RHI_SHADER_FIELD(Light, direction), RHI_SHADER_FIELD(Light, intensity), RHI_SHADER_FIELD(Light, shadowMatrix) };
+    //
+    //  static_assert(isBufferLayout<Light>(BufferLayoutRule::eStd140, kLightFields), "");
+    template <typename Struct, size_t N>
+    constexpr bool isBufferLayout(BufferLayoutRule rule, const ShaderField (&fields)[N]) {
+        Uint64 cursor = 0;
+
+        for (size_t i = 0; i < N; i++) {
+            const ShaderTypeLayout& field = fields[i].layouts[static_cast<Uint32>(rule)];
+            cursor = alignShaderOffset(cursor, field.alignment);
+
+            if (fields[i].offset != cursor || fields[i].hostSize != field.size) {
+                return false;
+            }
+
+            cursor += field.size;
+        }
+
+        return sizeof(Struct) == getBufferStructLayout(rule, fields).size;
+    }
+};
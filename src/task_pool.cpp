@@ -0,0 +1,118 @@
+#include "task_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace Rhi {
+    TaskPool::TaskPool(Uint32 workerCount) {
+        if (workerCount == 0) {
+            workerCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        this->workers.reserve(workerCount);
+        for (Uint32 i = 0; i < workerCount; i++) {
+            this->workers.emplace_back(&TaskPool::workerLoop, this);
+        }
+    }
+
+    TaskPool::~TaskPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->stopping = true;
+        }
+
+        this->taskAvailable.notify_all();
+
+        for (auto& worker : this->workers) {
+            worker.join();
+        }
+    }
+
+    void TaskPool::submit(std::function<void()> task, Int32 priority) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            this->queue.push_back(Entry{ priority, this->nextSequence++, std::move(task) });
+            std::push_heap(this->queue.begin(), this->queue.end(), EntryOrder{});
+        }
+
+        this->taskAvailable.notify_one();
+    }
+
+    void TaskPool::wait() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->idle.wait(lock, [this] { return this->queue.empty() && this->activeCount == 0; });
+    }
+
+    void TaskPool::parallelFor(Uint32 jobCount, const std::function<void(Uint32)>& job, Int32 priority) {
+        struct Batch {
+            std::atomic<Uint32> next{ 0 };
+            Uint32 finished = 0;
+
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+
+        // Helpers that start after every job was claimed find nothing to run and never touch job,
+        // which is gone by then. Only the batch has to outlive the call.
+        auto batch = std::make_shared<Batch>();
+        const std::function<void(Uint32)>* body = &job;
+
+        auto drain = [batch, body, jobCount]() {
+            Uint32 ran = 0;
+
+            for (Uint32 index = batch->next++; index < jobCount; index = batch->next++) {
+                (*body)(index);
+                ran++;
+            }
+
+            if (ran != 0) {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                batch->finished += ran;
+
+                if (batch->finished == jobCount) {
+                    batch->done.notify_all();
+                }
+            }
+        };
+
+        Uint32 helperCount = std::min(jobCount > 0 ? jobCount - 1 : 0, this->getWorkerCount());
+        for (Uint32 i = 0; i < helperCount; i++) {
+            this->submit(drain, priority);
+        }
+
+        drain();
+
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->done.wait(lock, [&batch, jobCount] { return batch->finished == jobCount; });
+    }
+
+    void TaskPool::workerLoop() {
+        std::unique_lock<std::mutex> lock(this->mutex);
+
+        while (true) {
+            this->taskAvailable.wait(lock, [this] { return this->stopping || !this->queue.empty(); });
+
+            if (this->queue.empty()) {
+                return;
+            }
+
+            std::pop_heap(this->queue.begin(), this->queue.end(), EntryOrder{});
+            std::function<void()> task = std::move(this->queue.back().task);
+            this->queue.pop_back();
+
+            this->activeCount++;
+            lock.unlock();
+
+            task();
+
+            lock.lock();
+            this->activeCount--;
+
+            if (this->queue.empty() && this->activeCount == 0) {
+                this->idle.notify_all();
+            }
+        }
+    }
+};
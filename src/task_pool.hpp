@@ -0,0 +1,64 @@
+#pragma once
+
+#include "rhi.hpp"
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Task Pool
+    // ===========================================================================================================================
+
+    // Fixed set of worker threads pulling from a single priority queue. Higher priority
+    // runs first, tasks with equal priority run in submission order.
+    class TaskPool {
+    public:
+        // workerCount of 0 uses every hardware thread
+        explicit TaskPool(Uint32 workerCount = 0);
+        ~TaskPool();
+
+        TaskPool(const TaskPool&) = delete;
+        TaskPool& operator=(const TaskPool&) = delete;
+
+        void submit(std::function<void()> task, Int32 priority = 0);
+
+        // Blocks until the queue is empty and every worker is idle
+        void wait();
+
+        // Runs job(0) to job(jobCount - 1) and returns once all of them finished. The calling
+        // thread claims jobs alongside the workers, so a worker of this pool may call it without
+        // deadlocking, and it waits on these jobs only while the pool stays busy with other work.
+        void parallelFor(Uint32 jobCount, const std::function<void(Uint32)>& job, Int32 priority = 0);
+
+        Uint32 getWorkerCount() const { return static_cast<Uint32>(this->workers.size()); }
+
+    private:
+        struct Entry {
+            Int32 priority;
+            Uint64 sequence;
+            std::function<void()> task;
+        };
+
+        struct EntryOrder {
+            bool operator()(const Entry& a, const Entry& b) const {
+                return a.priority != b.priority ? a.priority < b.priority : a.sequence > b.sequence;
+            }
+        };
+
+        std::vector<std::thread> workers;
+        std::vector<Entry> queue;
+
+        std::mutex mutex;
+        std::condition_variable taskAvailable;
+        std::condition_variable idle;
+
+        Uint64 nextSequence = 0;
+        Uint32 activeCount = 0;
+        bool stopping = false;
+
+        void workerLoop();
+    };
+};
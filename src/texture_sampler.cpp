@@ -0,0 +1,579 @@
+#include "texture_sampler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+namespace Rhi {
+    // Lanes of one kernel call. Each axis keeps its coordinates and anisotropic step per lane.
+    struct SampleBatch {
+        Uint32 count;
+        Uint32 tapCount;
+
+        float coordinates[3][kSamplerLanes];
+        float axes[3][kSamplerLanes];
+        float lod[kSamplerLanes];
+        float reference[kSamplerLanes];
+        int32_t layer[kSamplerLanes];
+
+        float lodMinClamp;
+        float lodMaxClamp;
+        float passLess;
+        float passEqual;
+        float passGreater;
+
+        void (*wraps[3])(int32_t* coordinates, const int32_t* sizes, Uint32 count);
+    };
+
+    namespace {
+        // ===========================================================================================================================
+        // Texel Decoding
+        // ===========================================================================================================================
+
+        const std::array<float, 256> kSrgbToLinear = [] {
+            std::array<float, 256> table{};
+
+            for (Uint32 i = 0; i < 256; i++) {
+                float value = i / 255.0f;
+                table[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+            }
+
+            return table;
+        }();
+
+        float bitsToFloat(uint32_t bits) {
+            float value;
+            std::memcpy(&value, &bits, 4);
+            return value;
+        }
+
+        // Moves the exponent and mantissa in place and rebiases with one multiply, which also
+        // turns half denormals into float normals. Infinity and NaN keep an all ones exponent.
+        float halfToFloat(uint16_t half) {
+            uint32_t magnitude = half & 0x7FFFu;
+            uint32_t sign = static_cast<uint32_t>(half & 0x8000u) << 16;
+
+            float value = bitsToFloat(magnitude << 13) * 5.192296858534828e33f;    // 2^112
+            uint32_t bits;
+            std::memcpy(&bits, &value, 4);
+
+            bits = magnitude >= 0x7C00u ? 0x7F800000u | (magnitude & 0x3FFu) << 13 : bits;
+            return bitsToFloat(bits | sign);
+        }
+
+        // Unsigned floats of the packed formats: five exponent bits, no sign
+        float packedFloatToFloat(uint32_t bits, Uint32 mantissaBits) {
+            uint32_t exponent = bits >> mantissaBits;
+            float mantissa = static_cast<float>(bits & ((1u << mantissaBits) - 1)) / static_cast<float>(1u << mantissaBits);
+
+            if (exponent == 0) {
+                return std::ldexp(mantissa, -14);
+            }
+
+            return exponent == 31 ? std::numeric_limits<float>::infinity() : std::ldexp(1.0f + mantissa, static_cast<int>(exponent) - 15);
+        }
+
+        template <Uint32 C, bool kSrgb, bool kBgra>
+        struct Unorm8 {
+            static void decode(const uint8_t* texel, float* rgba) {
+                for (Uint32 c = 0; c < C; c++) {
+                    Uint32 channel = kBgra && c < 3 ? 2 - c : c;
+                    rgba[channel] = kSrgb && c < 3 ? kSrgbToLinear[texel[c]] : texel[c] * (1.0f / 255.0f);
+                }
+            }
+        };
+
+        template <Uint32 C>
+        struct Snorm8 {
+            static void decode(const uint8_t* texel, float* rgba) {
+                for (Uint32 c = 0; c < C; c++) {
+                    rgba[c] = std::max(static_cast<int8_t>(texel[c]) * (1.0f / 127.0f), -1.0f);
+                }
+            }
+        };
+
+        template <Uint32 C>
+        struct Unorm16 {
+            static void decode(const uint8_t* texel, float* rgba) {
+                uint16_t values[C];
+                std::memcpy(values, texel, sizeof(values));
+
+                for (Uint32 c = 0; c < C; c++) {
+                    rgba[c] = values[c] * (1.0f / 65535.0f);
+                }
+            }
+        };
+
+        template <Uint32 C>
+        struct Float16 {
+            static void decode(const uint8_t* texel, float* rgba) {
+                uint16_t values[C];
+                std::memcpy(values, texel, sizeof(values));
+
+                for (Uint32 c = 0; c < C; c++) {
+                    rgba[c] = halfToFloat(values[c]);
+                }
+            }
+        };
+
+        template <Uint32 C>
+        struct Float32 {
+            static void decode(const uint8_t* texel, float* rgba) {
+                std::memcpy(rgba, texel, C * 4);
+            }
+        };
+
+        // Depth in the low 24 bits, stencil above when there is one
+        struct Unorm24 {
+            static void decode(const uint8_t* texel, float* rgba) {
+                uint32_t bits;
+                std::memcpy(&bits, texel, 4);
+                rgba[0] = (bits & 0xFFFFFFu) * (1.0f / 16777215.0f);
+            }
+        };
+
+        struct Rgb10A2Unorm {
+            static void decode(const uint8_t* texel, float* rgba) {
+                uint32_t bits;
+                std::memcpy(&bits, texel, 4);
+
+                rgba[0] = (bits & 0x3FFu) * (1.0f / 1023.0f);
+                rgba[1] = ((bits >> 10) & 0x3FFu) * (1.0f / 1023.0f);
+                rgba[2] = ((bits >> 20) & 0x3FFu) * (1.0f / 1023.0f);
+                rgba[3] = (bits >> 30) * (1.0f / 3.0f);
+            }
+        };
+
+        struct Rg11B10Ufloat {
+            static void decode(const uint8_t* texel, float* rgba) {
+                uint32_t bits;
+                std::memcpy(&bits, texel, 4);
+
+                rgba[0] = packedFloatToFloat(bits & 0x7FFu, 6);
+                rgba[1] = packedFloatToFloat((bits >> 11) & 0x7FFu, 6);
+                rgba[2] = packedFloatToFloat(bits >> 22, 5);
+            }
+        };
+
+        struct Rgb9E5Ufloat {
+            static void decode(const uint8_t* texel, float* rgba) {
+                uint32_t bits;
+                std::memcpy(&bits, texel, 4);
+
+                float scale = std::ldexp(1.0f, static_cast<int>(bits >> 27) - 15 - 9);
+                rgba[0] = (bits & 0x1FFu) * scale;
+                rgba[1] = ((bits >> 9) & 0x1FFu) * scale;
+                rgba[2] = ((bits >> 18) & 0x1FFu) * scale;
+            }
+        };
+
+        template <typename Decoder>
+        void fetchTexels(const uint8_t* data, const Uint64* offsets, Uint32 count, float* texels) {
+            for (Uint32 i = 0; i < count; i++) {
+                float rgba[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+                Decoder::decode(data + offsets[i], rgba);
+
+                for (Uint32 c = 0; c < 4; c++) {
+                    texels[c * kSamplerLanes + i] = rgba[c];
+                }
+            }
+        }
+
+        TexelFetch getTexelFetch(TextureFormat format) {
+            switch (format) {
+                case eR8Unorm: return fetchTexels<Unorm8<1, false, false>>;
+                case eR8Snorm: return fetchTexels<Snorm8<1>>;
+                case eR16Float: return fetchTexels<Float16<1>>;
+                case eRG8Unorm: return fetchTexels<Unorm8<2, false, false>>;
+                case eRG8Snorm: return fetchTexels<Snorm8<2>>;
+                case eR32float: return fetchTexels<Float32<1>>;
+                case eRG16float: return fetchTexels<Float16<2>>;
+                case eRGBA8Unorm: return fetchTexels<Unorm8<4, false, false>>;
+                case eRGBA8UnormSrgb: return fetchTexels<Unorm8<4, true, false>>;
+                case eRGBA8Snorm: return fetchTexels<Snorm8<4>>;
+                case eBGRA8Unorm: return fetchTexels<Unorm8<4, false, true>>;
+                case eBGRA8UnormSrgb: return fetchTexels<Unorm8<4, true, true>>;
+                case eRGB9E5Ufloat: return fetchTexels<Rgb9E5Ufloat>;
+                case eRGB10A2Unorm: return fetchTexels<Rgb10A2Unorm>;
+                case eRG11B10Ufloat: return fetchTexels<Rg11B10Ufloat>;
+                case eRG32Float: return fetchTexels<Float32<2>>;
+                case eRGBA16Float: return fetchTexels<Float16<4>>;
+                case eRGBA32Float: return fetchTexels<Float32<4>>;
+                case eD16Unorm: return fetchTexels<Unorm16<1>>;
+                case eD24Plus: return fetchTexels<Unorm24>;
+                case eD24PlusS8Uint: return fetchTexels<Unorm24>;
+                case eD32Sfloat: return fetchTexels<Float32<1>>;
+                case eD32SFloatS8Uint: return fetchTexels<Float32<1>>;
+                default: return nullptr;
+            }
+        }
+
+        // ===========================================================================================================================
+        // Address Modes
+        // ===========================================================================================================================
+
+        void wrapClampToEdge(int32_t* coordinates, const int32_t* sizes, Uint32 count) {
+            for (Uint32 i = 0; i < count; i++) {
+                coordinates[i] = std::min(std::max(coordinates[i], static_cast<int32_t>(0)), sizes[i] - 1);
+            }
+        }
+
+        void wrapRepeat(int32_t* coordinates, const int32_t* sizes, Uint32 count) {
+            for (Uint32 i = 0; i < count; i++) {
+                int32_t wrapped = coordinates[i] % sizes[i];
+                coordinates[i] = wrapped < 0 ? wrapped + sizes[i] : wrapped;
+            }
+        }
+
+        void wrapMirrorRepeat(int32_t* coordinates, const int32_t* sizes, Uint32 count) {
+            for (Uint32 i = 0; i < count; i++) {
+                int32_t period = 2 * sizes[i];
+                int32_t wrapped = coordinates[i] % period;
+                wrapped = wrapped < 0 ? wrapped + period : wrapped;
+
+                coordinates[i] = wrapped < sizes[i] ? wrapped : period - 1 - wrapped;
+            }
+        }
+
+        // ===========================================================================================================================
+        // Kernels
+        // ===========================================================================================================================
+
+        constexpr Uint32 kMagLinear = 1;
+        constexpr Uint32 kMinLinear = 2;
+        constexpr Uint32 kMipLinear = 4;
+        constexpr Uint32 kCompare = 8;
+        constexpr Uint32 kVolume = 16;
+        constexpr Uint32 kKernelCount = 32;
+
+        // Far enough out that every address mode still works in float precision
+        constexpr float kMaxTexelPosition = 16777216.0f;
+
+        // std::floor is a library call without SSE4.1, this one vectorizes. Within +-2^31 only.
+        inline float floorLane(float value) {
+            float truncated = static_cast<float>(static_cast<int32_t>(value));
+            return truncated > value ? truncated - 1.0f : truncated;
+        }
+
+        // Filters every tap of every level for all lanes. A lane magnifies when its clamped level
+        // of detail is at most 0; when the two filters differ, nearest lanes get zero weight on
+        // the second texel of each axis instead of taking another path.
+        template <Uint32 kConfig>
+        void sampleKernel(const SampledTexture& texture, const SampleBatch& batch, float* output, Uint32 outputStride) {
+            constexpr bool kAnyLinear = (kConfig & (kMagLinear | kMinLinear)) != 0;
+            constexpr Uint32 kLevelCount = (kConfig & kMipLinear) != 0 ? 2 : 1;
+            constexpr Uint32 kAxisCount = (kConfig & kVolume) != 0 ? 3 : 2;
+            constexpr Uint32 kCornerCount = kAnyLinear ? 1u << kAxisCount : 1;
+
+            const TiledTexture& tiled = *texture.texture;
+            const uint8_t* data = tiled.getData();
+            const Uint32 count = batch.count;
+            const float maxLevel = static_cast<float>(texture.mipCount - 1);
+
+            float linear[kSamplerLanes];
+            int32_t levels[kLevelCount][kSamplerLanes];
+            float levelWeights[kLevelCount][kSamplerLanes];
+
+            for (Uint32 lane = 0; lane < count; lane++) {
+                float lod = std::min(std::max(batch.lod[lane], batch.lodMinClamp), batch.lodMaxClamp);
+                linear[lane] = lod > 0.0f ? ((kConfig & kMinLinear) != 0 ? 1.0f : 0.0f) : ((kConfig & kMagLinear) != 0 ? 1.0f : 0.0f);
+
+                float level = std::min(std::max(lod, 0.0f), maxLevel);
+
+                if constexpr (kLevelCount == 2) {
+                    float base = floorLane(level);
+
+                    levels[0][lane] = static_cast<int32_t>(base);
+                    levels[kLevelCount - 1][lane] = static_cast<int32_t>(std::min(base + 1.0f, maxLevel));
+                    levelWeights[0][lane] = 1.0f - (level - base);
+                    levelWeights[kLevelCount - 1][lane] = level - base;
+                } else {
+                    // ceil(level + 0.5) - 1, rounding halves down
+                    levels[0][lane] = static_cast<int32_t>(std::max(-floorLane(-level - 0.5f) - 1.0f, 0.0f));
+                    levelWeights[0][lane] = 1.0f;
+                }
+            }
+
+            float result[4][kSamplerLanes] = {};
+            const float tapWeight = 1.0f / static_cast<float>(batch.tapCount);
+
+            for (Uint32 l = 0; l < kLevelCount; l++) {
+                int32_t sizes[3][kSamplerLanes];
+
+                for (Uint32 axis = 0; axis < kAxisCount; axis++) {
+                    for (Uint32 lane = 0; lane < count; lane++) {
+                        sizes[axis][lane] = texture.mipSizes[levels[l][lane]][axis];
+                    }
+                }
+
+                for (Uint32 tap = 0; tap < batch.tapCount; tap++) {
+                    float step = (static_cast<float>(tap) + 0.5f) * tapWeight - 0.5f;
+
+                    // Per axis the texel each corner reads, and the weight of the second one
+                    int32_t texels[kAxisCount][2][kSamplerLanes];
+                    float fractions[kAxisCount][kSamplerLanes];
+
+                    for (Uint32 axis = 0; axis < kAxisCount; axis++) {
+                        for (Uint32 lane = 0; lane < count; lane++) {
+                            float position = (batch.coordinates[axis][lane] + batch.axes[axis][lane] * step) * sizes[axis][lane]
+                                - 0.5f * linear[lane];
+                            position = std::min(std::max(position, -kMaxTexelPosition), kMaxTexelPosition);
+
+                            float base = floorLane(position);
+                            texels[axis][0][lane] = static_cast<int32_t>(base);
+                            texels[axis][1][lane] = static_cast<int32_t>(base) + 1;
+                            fractions[axis][lane] = (position - base) * linear[lane];
+                        }
+
+                        batch.wraps[axis](texels[axis][0], sizes[axis], count);
+                        if constexpr (kAnyLinear) {
+                            batch.wraps[axis](texels[axis][1], sizes[axis], count);
+                        }
+                    }
+
+                    for (Uint32 corner = 0; corner < kCornerCount; corner++) {
+                        Uint64 offsets[kSamplerLanes];
+                        float weights[kSamplerLanes];
+
+                        for (Uint32 lane = 0; lane < count; lane++) {
+                            int32_t slice;
+                            if constexpr (kAxisCount == 3) {
+                                slice = texels[kAxisCount - 1][(corner >> 2) & 1][lane];
+                            } else {
+                                slice = batch.layer[lane];
+                            }
+
+                            offsets[lane] = tiled.getBlockOffset(levels[l][lane], texels[0][corner & 1][lane],
+                                texels[1][(corner >> 1) & 1][lane], slice);
+
+                            float weight = levelWeights[l][lane] * tapWeight;
+                            for (Uint32 axis = 0; axis < kAxisCount; axis++) {
+                                float fraction = fractions[axis][lane];
+                                weight *= ((corner >> axis) & 1) != 0 ? fraction : 1.0f - fraction;
+                            }
+
+                            weights[lane] = weight;
+                        }
+
+                        float values[4][kSamplerLanes];
+                        texture.fetch(data, offsets, count, &values[0][0]);
+
+                        if constexpr ((kConfig & kCompare) != 0) {
+                            for (Uint32 lane = 0; lane < count; lane++) {
+                                float depth = values[0][lane];
+                                float reference = batch.reference[lane];
+
+                                float pass = (reference < depth ? batch.passLess : 0.0f) + (reference == depth ? batch.passEqual : 0.0f)
+                                    + (reference > depth ? batch.passGreater : 0.0f);
+                                result[0][lane] += weights[lane] * pass;
+                            }
+                        } else {
+                            for (Uint32 c = 0; c < 4; c++) {
+                                for (Uint32 lane = 0; lane < count; lane++) {
+                                    result[c][lane] += weights[lane] * values[c][lane];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            constexpr Uint32 kChannelCount = (kConfig & kCompare) != 0 ? 1 : 4;
+            for (Uint32 c = 0; c < kChannelCount; c++) {
+                std::memcpy(output + c * outputStride, result[c], count * sizeof(float));
+            }
+        }
+
+        typedef void (*KernelFunction)(const SampledTexture& texture, const SampleBatch& batch, float* output, Uint32 outputStride);
+
+        template <Uint32... kConfigs>
+        constexpr std::array<KernelFunction, sizeof...(kConfigs)> makeKernelTable(std::integer_sequence<Uint32, kConfigs...>) {
+            return { { &sampleKernel<kConfigs>... } };
+        }
+
+        constexpr std::array<KernelFunction, kKernelCount> kKernels = makeKernelTable(std::make_integer_sequence<Uint32, kKernelCount>{});
+    };
+
+    // ===========================================================================================================================
+    // Sampled Textures
+    // ===========================================================================================================================
+
+    bool createSampledTexture(const TiledTexture& texture, SampledTexture& sampled, std::string& error) {
+        sampled.fetch = getTexelFetch(texture.getFormat());
+        if (sampled.fetch == nullptr) {
+            error = "Texture format cannot be sampled on the CPU";
+            return false;
+        }
+
+        // Storage stays once allocated, the sampler reads it without checking
+        if (texture.getData() == nullptr) {
+            error = "Texture has never been written";
+            return false;
+        }
+
+        sampled.texture = &texture;
+        sampled.mipCount = std::min(texture.getMipCount(), kMaxSampledMips);
+
+        bool isVolume = texture.getDimension() == TextureDimension::e3D;
+        sampled.layerCount = isVolume ? 1 : texture.getMipBlocks(0).depth;
+
+        for (Uint32 mipLevel = 0; mipLevel < sampled.mipCount; mipLevel++) {
+            Extent3D blocks = texture.getMipBlocks(mipLevel);
+
+            sampled.mipSizes[mipLevel][0] = static_cast<int32_t>(blocks.width);
+            sampled.mipSizes[mipLevel][1] = static_cast<int32_t>(blocks.height);
+            sampled.mipSizes[mipLevel][2] = isVolume ? static_cast<int32_t>(blocks.depth) : 1;
+        }
+
+        return true;
+    }
+
+    // ===========================================================================================================================
+    // CPU Sampler
+    // ===========================================================================================================================
+
+    CpuSampler::CpuSampler(const SamplerDescriptor& descriptor) : desc{ descriptor } {
+        bool allLinear = descriptor.magFilter == eLinear && descriptor.minFilter == eLinear
+            && descriptor.mipmapFilter == MipmapFilterMode::eLinear;
+        this->anisotropic = descriptor.maxAnisotropy > 1 && allLinear;
+
+        Uint32 config = (descriptor.magFilter == eLinear ? kMagLinear : 0) | (descriptor.minFilter == eLinear ? kMinLinear : 0)
+            | (descriptor.mipmapFilter == MipmapFilterMode::eLinear ? kMipLinear : 0)
+            | (descriptor.compare != CompareFunction::eNever ? kCompare : 0);
+
+        this->kernels[0] = kKernels[config];
+        this->kernels[1] = kKernels[config | kVolume];
+
+        const AddressMode modes[3] = { descriptor.addressModeU, descriptor.addressModeV, descriptor.addressModeW };
+        for (Uint32 axis = 0; axis < 3; axis++) {
+            switch (modes[axis]) {
+                case AddressMode::eRepeat: this->wraps[axis] = wrapRepeat; break;
+                case AddressMode::eMirrorRepeat: this->wraps[axis] = wrapMirrorRepeat; break;
+                default: this->wraps[axis] = wrapClampToEdge; break;
+            }
+        }
+
+        CompareFunction compare = descriptor.compare;
+        this->passLess = compare == eLess || compare == eLessEqual || compare == eNotEqual || compare == eAlways ? 1.0f : 0.0f;
+        this->passEqual = compare == eEqual || compare == eLessEqual || compare == eGreaterEqual || compare == eAlways ? 1.0f : 0.0f;
+        this->passGreater = compare == eGreater || compare == eNotEqual || compare == eGreaterEqual || compare == eAlways ? 1.0f : 0.0f;
+    }
+
+    void CpuSampler::fillBatch(const SampledTexture& texture, const SampleCoordinates& coordinates, Uint32 begin,
+        SampleBatch& batch) const
+    {
+        batch.count = std::min(kSamplerLanes, coordinates.count - begin);
+        batch.tapCount = 1;
+
+        batch.lodMinClamp = this->desc.lodMinClamp;
+        batch.lodMaxClamp = this->desc.lodMaxClamp;
+        batch.passLess = this->passLess;
+        batch.passEqual = this->passEqual;
+        batch.passGreater = this->passGreater;
+
+        for (Uint32 axis = 0; axis < 3; axis++) {
+            batch.wraps[axis] = this->wraps[axis];
+        }
+
+        bool isVolume = texture.texture->getDimension() == TextureDimension::e3D;
+        float lastLayer = static_cast<float>(texture.layerCount - 1);
+
+        for (Uint32 lane = 0; lane < batch.count; lane++) {
+            Uint32 i = begin + lane;
+            float w = coordinates.w != nullptr ? coordinates.w[i] : 0.0f;
+
+            batch.coordinates[0][lane] = coordinates.u[i];
+            batch.coordinates[1][lane] = coordinates.v[i];
+            batch.coordinates[2][lane] = isVolume ? w : 0.0f;
+            batch.layer[lane] = isVolume ? 0 : static_cast<int32_t>(std::min(std::max(floorLane(w + 0.5f), 0.0f), lastLayer));
+            batch.reference[lane] = coordinates.reference != nullptr ? coordinates.reference[i] : 0.0f;
+
+            for (Uint32 axis = 0; axis < 3; axis++) {
+                batch.axes[axis][lane] = 0.0f;
+            }
+        }
+    }
+
+    void CpuSampler::sampleLevel(const SampledTexture& texture, const SampleCoordinates& coordinates, const float* lod,
+        float* output) const
+    {
+        Kernel kernel = this->kernels[texture.texture->getDimension() == TextureDimension::e3D ? 1 : 0];
+        SampleBatch batch;
+
+        for (Uint32 begin = 0; begin < coordinates.count; begin += kSamplerLanes) {
+            this->fillBatch(texture, coordinates, begin, batch);
+            std::copy(lod + begin, lod + begin + batch.count, batch.lod);
+
+            kernel(texture, batch, output + begin, coordinates.count);
+        }
+    }
+
+    void CpuSampler::sampleGrad(const SampledTexture& texture, const SampleCoordinates& coordinates,
+        const SampleGradients& gradients, float* output) const
+    {
+        bool isVolume = texture.texture->getDimension() == TextureDimension::e3D;
+        Kernel kernel = this->kernels[isVolume ? 1 : 0];
+
+        const float size[3] = { static_cast<float>(texture.mipSizes[0][0]), static_cast<float>(texture.mipSizes[0][1]),
+            isVolume ? static_cast<float>(texture.mipSizes[0][2]) : 0.0f };
+        const float maxAnisotropy = static_cast<float>(std::max<Uint32>(1, this->desc.maxAnisotropy));
+
+        SampleBatch batch;
+        float ratios[kSamplerLanes];
+
+        for (Uint32 begin = 0; begin < coordinates.count; begin += kSamplerLanes) {
+            this->fillBatch(texture, coordinates, begin, batch);
+
+            for (Uint32 lane = 0; lane < batch.count; lane++) {
+                Uint32 i = begin + lane;
+
+                const float dx[3] = { gradients.dudx[i], gradients.dvdx[i], gradients.dwdx != nullptr ? gradients.dwdx[i] : 0.0f };
+                const float dy[3] = { gradients.dudy[i], gradients.dvdy[i], gradients.dwdy != nullptr ? gradients.dwdy[i] : 0.0f };
+
+                float lengthX = 0.0f;
+                float lengthY = 0.0f;
+                for (Uint32 axis = 0; axis < 3; axis++) {
+                    lengthX += dx[axis] * size[axis] * dx[axis] * size[axis];
+                    lengthY += dy[axis] * size[axis] * dy[axis] * size[axis];
+                }
+
+                lengthX = std::sqrt(lengthX);
+                lengthY = std::sqrt(lengthY);
+
+                float major = std::max(lengthX, lengthY);
+                float minor = std::min(lengthX, lengthY);
+
+                // Taps along the long axis, each filtered at the footprint's short side
+                float ratio = 1.0f;
+                if (this->anisotropic) {
+                    ratio = std::min(std::max(std::ceil(major / std::max(minor, 1e-20f)), 1.0f), maxAnisotropy);
+                }
+
+                ratios[lane] = ratio;
+                batch.lod[lane] = std::log2(major / ratio);
+                batch.tapCount = std::max(batch.tapCount, static_cast<Uint32>(ratio));
+
+                const float* axis = lengthX >= lengthY ? dx : dy;
+                for (Uint32 a = 0; a < 3; a++) {
+                    batch.axes[a][lane] = this->anisotropic ? axis[a] : 0.0f;
+                }
+            }
+
+            // Lanes needing fewer taps than the batch takes spread them over their own footprint,
+            // the outer taps landing where the lane's own outer taps would
+            float batchSpread = 1.0f - 1.0f / static_cast<float>(batch.tapCount);
+            for (Uint32 lane = 0; lane < batch.count; lane++) {
+                float scale = batch.tapCount > 1 ? (1.0f - 1.0f / ratios[lane]) / batchSpread : 0.0f;
+
+                for (Uint32 a = 0; a < 3; a++) {
+                    batch.axes[a][lane] *= scale;
+                }
+            }
+
+            kernel(texture, batch, output + begin, coordinates.count);
+        }
+    }
+};
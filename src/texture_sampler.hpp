@@ -0,0 +1,108 @@
+#pragma once
+
+#include "tiled_texture.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Sampled Textures
+    // ===========================================================================================================================
+
+    // Coordinates are sampled in batches of up to this many, one lane each
+    constexpr Uint32 kSamplerLanes = 16;
+    constexpr Uint32 kMaxSampledMips = 16;
+
+    // Decodes the texels at offsets[0, count) of data to float, channel c of texel i going to
+    // texels[c * kSamplerLanes + i]. Missing channels read as (0, 0, 0, 1).
+    typedef void (*TexelFetch)(const uint8_t* data, const Uint64* offsets, Uint32 count, float* texels);
+
+    struct SampledTexture {
+        const TiledTexture* texture;
+        TexelFetch fetch;
+
+        Uint32 mipCount;
+        Uint32 layerCount;
+
+        // Texels across, down and deep of each mip, deep being 1 except for 3D textures
+        int32_t mipSizes[kMaxSampledMips][3];
+    };
+
+    // Filterable formats and depth formats only: integer, stencil only and compressed formats
+    // fail. Depth is read as a single channel.
+    bool createSampledTexture(const TiledTexture& texture, SampledTexture& sampled, std::string& error);
+
+    // ===========================================================================================================================
+    // CPU Sampler
+    // ===========================================================================================================================
+
+    // Structure of arrays, count entries each
+    struct SampleCoordinates {
+        const float* u;
+        const float* v;
+
+        // Normalized depth for 3D textures, the array layer for others. Null reads as 0.
+        const float* w = nullptr;
+
+        // Compared against the depth texels by comparison samplers
+        const float* reference = nullptr;
+
+        Uint32 count;
+    };
+
+    // Derivatives of the normalized coordinates along screen x and y, as textureGrad takes them.
+    // The w ones are only read for 3D textures and may be null.
+    struct SampleGradients {
+        const float* dudx;
+        const float* dvdx;
+        const float* dudy;
+        const float* dvdy;
+        const float* dwdx = nullptr;
+        const float* dwdy = nullptr;
+    };
+
+    struct SampleBatch;
+
+    // Samples tiled textures as the WebGPU spec describes: per axis address modes, nearest or
+    // linear filtering chosen per coordinate by its level of detail, nearest or linear mip
+    // filtering, LOD clamps, anisotropic footprints and depth comparison with filtering.
+    //
+    // The filter modes, the comparison and the texture dimension select one compiled kernel per
+    // batch, so the lane loops inside run without branches. Address modes are applied to whole
+    // lane arrays at once.
+    //
+    // Output is structure of arrays too: channel c of coordinate i goes to output[c * count + i].
+    // Comparison samplers write channel 0 only, the filtered fraction of passing texels.
+    class CpuSampler {
+    public:
+        CpuSampler(const SamplerDescriptor& descriptor);
+
+        // textureSampleLevel, explicit level of detail per coordinate
+        void sampleLevel(const SampledTexture& texture, const SampleCoordinates& coordinates, const float* lod,
+            float* output) const;
+
+        // textureSampleGrad. With maxAnisotropy above 1 and every filter linear, the footprint's
+        // long axis is covered by up to maxAnisotropy taps.
+        void sampleGrad(const SampledTexture& texture, const SampleCoordinates& coordinates,
+            const SampleGradients& gradients, float* output) const;
+
+        const SamplerDescriptor& getDescriptor() const { return this->desc; }
+
+    private:
+        typedef void (*Kernel)(const SampledTexture& texture, const SampleBatch& batch, float* output, Uint32 outputStride);
+        typedef void (*Wrap)(int32_t* coordinates, const int32_t* sizes, Uint32 count);
+
+        void fillBatch(const SampledTexture& texture, const SampleCoordinates& coordinates, Uint32 begin,
+            SampleBatch& batch) const;
+
+        SamplerDescriptor desc;
+        bool anisotropic;
+
+        // Indexed by whether the texture is 3D
+        Kernel kernels[2];
+        Wrap wraps[3];
+
+        // 1 where the comparison passes for reference below, equal to, above the texel
+        float passLess;
+        float passEqual;
+        float passGreater;
+    };
+};
@@ -0,0 +1,336 @@
+#include "texture_state.hpp"
+#include "format_traits.hpp"
+#include "hash.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+namespace Rhi {
+    namespace {
+        Uint32 getLayerCount(const Texture* texture) {
+            return texture->desc.dimension == TextureDimension::e3D ? 1 : std::max<Uint32>(1, texture->desc.sliceLayersNum);
+        }
+
+        Uint32 getSubresourceCount(const Texture* texture) {
+            return std::max<Uint32>(1, texture->desc.mipLevelCount) * getLayerCount(texture);
+        }
+
+        TextureState* getStates(Texture* texture) {
+            if (texture->subresourceStates.empty()) {
+                texture->subresourceStates.assign(getSubresourceCount(texture), texture->state);
+            }
+
+            return texture->subresourceStates.data();
+        }
+
+        TextureAspect getAspect(const Texture* texture) {
+            return getTextureFormatTraits(texture->desc.format).aspect;
+        }
+
+        ResourceAccess getAccess(TextureState state) {
+            switch (state) {
+                case TextureState::eGeneral:
+                case TextureState::eColorAttachment:
+                case TextureState::eDepthStencilAttachment:
+                    return ResourceAccess::eReadWrite;
+
+                case TextureState::eCopyDst:
+                    return ResourceAccess::eWriteOnly;
+
+                default:
+                    return ResourceAccess::eReadOnly;
+            }
+        }
+
+        TextureSubresource getCopySubresource(const ImageCopyTexture& copy, Extent3D copySize) {
+            TextureSubresource subresource;
+            subresource.aspect = copy.aspect;
+            subresource.baseMipLevel = copy.mipLevel;
+            subresource.mipLevelCount = 1;
+
+            // Array layers are addressed through z, as in the texture upload paths
+            if (copy.texture->desc.dimension != TextureDimension::e3D) {
+                subresource.baseArrayLayer = copy.origin.z;
+                subresource.arrayLayerCount = copySize.depth;
+            }
+
+            return subresource;
+        }
+    };
+
+    TextureState getTextureState(const Texture* texture, Uint32 mipLevel, Uint32 arrayLayer) {
+        if (texture->subresourceStates.empty()) {
+            return texture->state;
+        }
+
+        return texture->subresourceStates[mipLevel * getLayerCount(texture) + arrayLayer];
+    }
+
+    void setTextureState(Texture* texture, TextureState state) {
+        texture->state = state;
+        texture->subresourceStates.clear();
+    }
+
+    // ===========================================================================================================================
+    // Texture State Tracker
+    // ===========================================================================================================================
+
+    size_t TextureStateTracker::SubresourceKeyHash::operator()(const SubresourceKey& key) const {
+        return static_cast<size_t>(hashCombine(hashValue(key.texture), key.index));
+    }
+
+    void TextureStateTracker::require(Texture* texture, const TextureSubresource& subresource, TextureState state, ShaderStage stage) {
+        this->transition(texture, subresource, state, stage, BarrierSplit::eNone);
+    }
+
+    void TextureStateTracker::require(TextureView* view, TextureState state, ShaderStage stage) {
+        if (view != nullptr) {
+            this->transition(view->texture, view->desc.subresource, state, stage, BarrierSplit::eNone);
+        }
+    }
+
+    void TextureStateTracker::requireCopySource(const ImageCopyTexture& source, Extent3D copySize, ShaderStage stage) {
+        this->require(source.texture, getCopySubresource(source, copySize), TextureState::eCopySrc, stage);
+    }
+
+    void TextureStateTracker::requireCopyDestination(const ImageCopyTexture& destination, Extent3D copySize, ShaderStage stage) {
+        this->require(destination.texture, getCopySubresource(destination, copySize), TextureState::eCopyDst, stage);
+    }
+
+    void TextureStateTracker::requireRenderPass(const RenderPassDescriptor& descriptor) {
+        for (const auto& attachment : descriptor.colorAttachments) {
+            this->require(attachment.view, TextureState::eColorAttachment, ShaderStage::eFragment);
+            this->require(attachment.resolveTarget, TextureState::eColorAttachment, ShaderStage::eFragment);
+        }
+
+        const RenderPassDepthStencilAttachment& depthStencil = descriptor.depthStencilAttachment;
+        TextureState depthState = depthStencil.depthReadOnly && depthStencil.stencilReadOnly
+            ? TextureState::eDepthStencilReadOnly
+            : TextureState::eDepthStencilAttachment;
+
+        this->require(depthStencil.view, depthState, ShaderStage::eFragment);
+    }
+
+    void TextureStateTracker::requireBindGroup(const BindGroup* bindGroup, ShaderStage stage) {
+        const BindGroupLayout* layout = bindGroup->desc.layout;
+
+        for (const auto& entry : bindGroup->desc.entries) {
+            if (entry.textureView == nullptr) {
+                continue;
+            }
+
+            bool storage = false;
+
+            if (layout != nullptr) {
+                for (const auto& layoutEntry : layout->desc.entries) {
+                    if (layoutEntry.binding == entry.binding) {
+                        storage = layoutEntry.type == BindingType::eStorageTexture;
+                        break;
+                    }
+                }
+            }
+
+            this->require(entry.textureView, storage ? TextureState::eGeneral : TextureState::eShaderReadOnly, stage);
+        }
+    }
+
+    void TextureStateTracker::beginTransition(Texture* texture, const TextureSubresource& subresource, TextureState state, ShaderStage stage) {
+        this->transition(texture, subresource, state, stage, BarrierSplit::eBegin);
+    }
+
+    void TextureStateTracker::transition(Texture* texture, const TextureSubresource& subresource, TextureState state, ShaderStage stage,
+        BarrierSplit split)
+    {
+        if (texture == nullptr) {
+            return;
+        }
+
+        this->pendingStages |= static_cast<ShaderStageFlags>(stage);
+
+        Uint32 mipEnd = std::min<Uint32>(std::max<Uint32>(1, texture->desc.mipLevelCount), subresource.baseMipLevel + subresource.mipLevelCount);
+        Uint32 layerEnd = std::min(getLayerCount(texture), subresource.baseArrayLayer + subresource.arrayLayerCount);
+
+        for (Uint32 mip = subresource.baseMipLevel; mip < mipEnd; mip++) {
+            for (Uint32 layer = subresource.baseArrayLayer; layer < layerEnd; layer++) {
+                this->transitionSubresource(texture, mip, layer, state, split);
+            }
+        }
+    }
+
+    void TextureStateTracker::transitionSubresource(Texture* texture, Uint32 mipLevel, Uint32 arrayLayer, TextureState state, BarrierSplit split) {
+        Uint32 index = mipLevel * getLayerCount(texture) + arrayLayer;
+        SubresourceKey key{ texture, index };
+
+        TextureState& current = getStates(texture)[index];
+
+        auto pendingSlot = this->pendingSlots.find(key);
+        auto begun = this->splits.find(key);
+
+        if (pendingSlot == this->pendingSlots.end() && begun != this->splits.end()) {
+            // The begun transition ends in this flush, current is already its destination
+            Transition end = begun->second;
+            end.split = BarrierSplit::eEnd;
+
+            this->pendingSlots.emplace(key, static_cast<Uint32>(this->pending.size()));
+            this->pending.push_back(end);
+            this->splits.erase(begun);
+
+            pendingSlot = this->pendingSlots.find(key);
+        }
+
+        if (pendingSlot != this->pendingSlots.end()) {
+            Transition& queued = this->pending[pendingSlot->second];
+
+            if (queued.split != BarrierSplit::eEnd) {
+                // Both uses fall between the same two flushes, the later one wins
+                queued.dstState = state;
+                queued.split = queued.split == BarrierSplit::eBegin && split == BarrierSplit::eBegin ? BarrierSplit::eBegin : BarrierSplit::eNone;
+                current = state;
+
+                return;
+            }
+
+            if (state == current) {
+                return;
+            }
+
+            // Moving on from a split barrier ending in this flush needs a barrier after the end
+            auto followUp = std::find_if(this->deferred.begin(), this->deferred.end(), [texture, mipLevel, arrayLayer](const Transition& transition) {
+                return transition.texture == texture && transition.mipLevel == mipLevel && transition.arrayLayer == arrayLayer;
+            });
+
+            if (followUp != this->deferred.end()) {
+                followUp->dstState = state;
+            } else {
+                this->deferred.push_back(Transition{ texture, mipLevel, arrayLayer, current, state, BarrierSplit::eNone });
+                this->touched.push_back(texture);
+            }
+
+            current = state;
+            return;
+        }
+
+        // Storage image accesses are not tracked, eGeneral to eGeneral is kept as a memory barrier
+        if (state == current && state != TextureState::eGeneral) {
+            return;
+        }
+
+        this->pendingSlots.emplace(key, static_cast<Uint32>(this->pending.size()));
+        this->pending.push_back(Transition{ texture, mipLevel, arrayLayer, current, state, split });
+        this->touched.push_back(texture);
+
+        current = state;
+    }
+
+    Uint32 TextureStateTracker::flush(CommandEncoder* encoder) {
+        ShaderStageFlags dstStages = this->pendingStages;
+        ShaderStageFlags srcStages = this->previousStages != 0 ? this->previousStages : dstStages;
+
+        // The end of a split barrier waits on the same stages as its begin
+        for (const auto& transition : this->pending) {
+            if (transition.split == BarrierSplit::eBegin) {
+                this->splits[SubresourceKey{ transition.texture, transition.mipLevel * getLayerCount(transition.texture) + transition.arrayLayer }] = transition;
+                this->splitStages |= srcStages;
+            } else if (transition.split == BarrierSplit::eEnd) {
+                srcStages |= this->splitStages;
+            }
+        }
+
+        if (this->splits.empty()) {
+            this->splitStages = 0;
+        }
+
+        Uint32 barrierCount = this->record(encoder, this->pending, static_cast<ShaderStage>(srcStages), static_cast<ShaderStage>(dstStages));
+        barrierCount += this->record(encoder, this->deferred, static_cast<ShaderStage>(dstStages), static_cast<ShaderStage>(dstStages));
+
+        // Textures back to a single state drop their per subresource states
+        std::sort(this->touched.begin(), this->touched.end());
+        this->touched.erase(std::unique(this->touched.begin(), this->touched.end()), this->touched.end());
+
+        for (Texture* texture : this->touched) {
+            const auto& states = texture->subresourceStates;
+
+            if (!states.empty() && std::all_of(states.begin(), states.end(), [&states](TextureState state) { return state == states[0]; })) {
+                setTextureState(texture, states[0]);
+            }
+        }
+
+        this->pending.clear();
+        this->deferred.clear();
+        this->pendingSlots.clear();
+        this->touched.clear();
+
+        if (dstStages != 0) {
+            this->previousStages = dstStages;
+        }
+
+        this->pendingStages = 0;
+        return barrierCount;
+    }
+
+    Uint32 TextureStateTracker::record(CommandEncoder* encoder, std::vector<Transition>& transitions, ShaderStage srcStage, ShaderStage dstStage) {
+        if (transitions.empty()) {
+            return 0;
+        }
+
+        std::sort(transitions.begin(), transitions.end(), [](const Transition& a, const Transition& b) {
+            return std::tie(a.texture, a.split, a.srcState, a.dstState, a.mipLevel, a.arrayLayer)
+                < std::tie(b.texture, b.split, b.srcState, b.dstState, b.mipLevel, b.arrayLayer);
+        });
+
+        auto sameTransition = [](const ImageBarrier& a, const ImageBarrier& b) {
+            return a.texture == b.texture && a.split == b.split && a.srcState == b.srcState && a.dstState == b.dstState;
+        };
+
+        // Runs of adjacent layers within one mip
+        std::vector<ImageBarrier> runs;
+
+        for (const auto& transition : transitions) {
+            ImageBarrier barrier;
+            barrier.srcAccess = getAccess(transition.srcState);
+            barrier.dstAccess = getAccess(transition.dstState);
+            barrier.split = transition.split;
+            barrier.texture = transition.texture;
+            barrier.subresource.aspect = getAspect(transition.texture);
+            barrier.subresource.baseMipLevel = transition.mipLevel;
+            barrier.subresource.baseArrayLayer = transition.arrayLayer;
+            barrier.srcState = transition.srcState;
+            barrier.dstState = transition.dstState;
+
+            if (!runs.empty()) {
+                TextureSubresource& last = runs.back().subresource;
+
+                if (sameTransition(runs.back(), barrier) && last.baseMipLevel == transition.mipLevel
+                    && last.baseArrayLayer + last.arrayLayerCount == transition.arrayLayer)
+                {
+                    last.arrayLayerCount++;
+                    continue;
+                }
+            }
+
+            runs.push_back(barrier);
+        }
+
+        // Adjacent mips covering the same layers share one barrier
+        std::vector<ImageBarrier> barriers;
+
+        for (const auto& run : runs) {
+            if (!barriers.empty()) {
+                TextureSubresource& last = barriers.back().subresource;
+
+                if (sameTransition(barriers.back(), run) && last.baseArrayLayer == run.subresource.baseArrayLayer
+                    && last.arrayLayerCount == run.subresource.arrayLayerCount
+                    && last.baseMipLevel + last.mipLevelCount == run.subresource.baseMipLevel)
+                {
+                    last.mipLevelCount++;
+                    continue;
+                }
+            }
+
+            barriers.push_back(run);
+        }
+
+        encoder->activateBarriers(srcStage, dstStage, {}, barriers);
+        return static_cast<Uint32>(barriers.size());
+    }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "rhi.hpp"
+
+#include <unordered_map>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Texture State Tracking
+    // ===========================================================================================================================
+
+    // Current state of one mip and array layer, from Texture::subresourceStates or Texture::state
+    TextureState getTextureState(const Texture* texture, Uint32 mipLevel, Uint32 arrayLayer);
+
+    // Whole texture transitions done outside a tracker, drops the per subresource states
+    void setTextureState(Texture* texture, TextureState state);
+
+    // Encoder operations declare the state they need per mip and layer, flush then records every
+    // transition since the last flush with a single activateBarriers call, right before the pass or
+    // copy that needs them. Adjacent mips and layers with the same transition share a barrier.
+    //
+    // The states live on the textures, so encoders using trackers must be submitted in the order
+    // they were recorded. One tracker per recording thread, and a texture is recorded by one
+    // thread at a time.
+    class TextureStateTracker {
+    public:
+        void require(Texture* texture, const TextureSubresource& subresource, TextureState state, ShaderStage stage);
+        void require(TextureView* view, TextureState state, ShaderStage stage);
+
+        void requireCopySource(const ImageCopyTexture& source, Extent3D copySize, ShaderStage stage = ShaderStage::eTransfer);
+        void requireCopyDestination(const ImageCopyTexture& destination, Extent3D copySize, ShaderStage stage = ShaderStage::eTransfer);
+
+        // Color, resolve and depth stencil attachments of the pass
+        void requireRenderPass(const RenderPassDescriptor& descriptor);
+
+        // Sampled textures to eShaderReadOnly, storage textures to eGeneral
+        void requireBindGroup(const BindGroup* bindGroup, ShaderStage stage);
+
+        // Starts moving the subresources to state with a split barrier at the next flush. The
+        // next require of them ends it, so work recorded in between overlaps the transition.
+        void beginTransition(Texture* texture, const TextureSubresource& subresource, TextureState state, ShaderStage stage);
+
+        // Records the queued transitions and returns how many barriers that took. Ending a split
+        // barrier and moving on to another state in the same flush takes a second call.
+        Uint32 flush(CommandEncoder* encoder);
+
+        bool hasPendingTransitions() const { return !this->pending.empty() || !this->deferred.empty(); }
+
+    private:
+        struct Transition {
+            Texture* texture;
+            Uint32 mipLevel;
+            Uint32 arrayLayer;
+
+            TextureState srcState;
+            TextureState dstState;
+            BarrierSplit split;
+        };
+
+        struct SubresourceKey {
+            const Texture* texture;
+            Uint32 index;
+
+            bool operator==(const SubresourceKey& other) const { return this->texture == other.texture && this->index == other.index; }
+        };
+
+        struct SubresourceKeyHash {
+            size_t operator()(const SubresourceKey& key) const;
+        };
+
+        std::vector<Transition> pending;
+        std::vector<Transition> deferred;
+
+        // Slot in pending of every subresource transitioned since the last flush
+        std::unordered_map<SubresourceKey, Uint32, SubresourceKeyHash> pendingSlots;
+
+        // Begun split barriers waiting for their end
+        std::unordered_map<SubresourceKey, Transition, SubresourceKeyHash> splits;
+
+        std::vector<Texture*> touched;
+
+        // Stages of the work after the previous flush and of the work after the next one
+        ShaderStageFlags previousStages = 0;
+        ShaderStageFlags pendingStages = 0;
+
+        // Stages the begun split barriers were recorded after
+        ShaderStageFlags splitStages = 0;
+
+        void transition(Texture* texture, const TextureSubresource& subresource, TextureState state, ShaderStage stage, BarrierSplit split);
+        void transitionSubresource(Texture* texture, Uint32 mipLevel, Uint32 arrayLayer, TextureState state, BarrierSplit split);
+
+        Uint32 record(CommandEncoder* encoder, std::vector<Transition>& transitions, ShaderStage srcStage, ShaderStage dstStage);
+    };
+};
@@ -0,0 +1,616 @@
+#include "texture_streaming.hpp"
+#include "texture_state.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Helpers
+    // ===========================================================================================================================
+
+    namespace {
+        template <typename T>
+        T readValue(const uint8_t* data, Uint64 offset) {
+            T value;
+            std::memcpy(&value, data + offset, sizeof(T));
+            return value;
+        }
+
+        constexpr uint32_t makeFourCC(char a, char b, char c, char d) {
+            return static_cast<uint32_t>(static_cast<uint8_t>(a))
+                | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8)
+                | (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16)
+                | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+        }
+
+        // ===========================================================================================================================
+        // KTX2
+        // ===========================================================================================================================
+
+        const uint8_t kKtx2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+        constexpr Uint64 kKtx2HeaderSize = 80;
+        constexpr Uint64 kKtx2LevelIndexEntrySize = 24;
+
+        bool getFormatFromVkFormat(uint32_t vkFormat, TextureFormat& format) {
+            switch (vkFormat) {
+                case 9: format = eR8Unorm; return true;
+                case 10: format = eR8Snorm; return true;
+                case 13: format = eR8Uint; return true;
+                case 14: format = eR8Sint; return true;
+                case 16: format = eRG8Unorm; return true;
+                case 17: format = eRG8Snorm; return true;
+                case 20: format = eRG8Uint; return true;
+                case 21: format = eRG8Sint; return true;
+                case 37: format = eRGBA8Unorm; return true;
+                case 38: format = eRGBA8Snorm; return true;
+                case 41: format = eRGBA8Uint; return true;
+                case 42: format = eRGBA8Sint; return true;
+                case 43: format = eRGBA8UnormSrgb; return true;
+                case 44: format = eBGRA8Unorm; return true;
+                case 50: format = eBGRA8UnormSrgb; return true;
+                case 64: format = eRGB10A2Unorm; return true;
+                case 68: format = eRGB10A2Uint; return true;
+                case 74: format = eR16Uint; return true;
+                case 75: format = eR16Sint; return true;
+                case 76: format = eR16Float; return true;
+                case 81: format = eRG16uint; return true;
+                case 82: format = eRG16sint; return true;
+                case 83: format = eRG16float; return true;
+                case 95: format = eRGBA16Uint; return true;
+                case 96: format = eRGBA16Sint; return true;
+                case 97: format = eRGBA16Float; return true;
+                case 98: format = eR32uint; return true;
+                case 99: format = eR32sint; return true;
+                case 100: format = eR32float; return true;
+                case 101: format = eRG32Uint; return true;
+                case 102: format = eRG32Sint; return true;
+                case 103: format = eRG32Float; return true;
+                case 107: format = eRGBA32Uint; return true;
+                case 108: format = eRGBA32Sint; return true;
+                case 109: format = eRGBA32Float; return true;
+                case 122: format = eRG11B10Ufloat; return true;
+                case 123: format = eRGB9E5Ufloat; return true;
+                case 124: format = eD16Unorm; return true;
+                case 125: format = eD24Plus; return true;
+                case 126: format = eD32Sfloat; return true;
+                case 127: format = eS8Uint; return true;
+                case 129: format = eD24PlusS8Uint; return true;
+                case 130: format = eD32SFloatS8Uint; return true;
+            }
+
+            // VK_FORMAT_BC1_RGBA_UNORM_BLOCK .. VK_FORMAT_ASTC_12x12_SRGB_BLOCK follow the same
+            // order as the compressed range of TextureFormat
+            if (vkFormat >= 133 && vkFormat <= 184) {
+                format = static_cast<TextureFormat>(eBC1RGBAUnorm + (vkFormat - 133));
+                return true;
+            }
+
+            return false;
+        }
+
+        bool parseKtx2(const uint8_t* data, Uint64 size, TextureContainerInfo& info, std::string& error) {
+            if (size < kKtx2HeaderSize) {
+                error = "KTX2 file is truncated";
+                return false;
+            }
+
+            uint32_t vkFormat = readValue<uint32_t>(data, 12);
+            uint32_t pixelWidth = readValue<uint32_t>(data, 20);
+            uint32_t pixelHeight = readValue<uint32_t>(data, 24);
+            uint32_t pixelDepth = readValue<uint32_t>(data, 28);
+            uint32_t layerCount = std::max<uint32_t>(1, readValue<uint32_t>(data, 32));
+            uint32_t faceCount = readValue<uint32_t>(data, 36);
+            uint32_t levelCount = std::max<uint32_t>(1, readValue<uint32_t>(data, 40));
+            uint32_t supercompressionScheme = readValue<uint32_t>(data, 44);
+
+            if (supercompressionScheme != 0) {
+                error = "Supercompressed KTX2 files cannot be streamed without decoding";
+                return false;
+            }
+
+            if (!getFormatFromVkFormat(vkFormat, info.desc.format)) {
+                error = "KTX2 file uses an unsupported format";
+                return false;
+            }
+
+            if (pixelWidth == 0) {
+                error = "KTX2 file has no width";
+                return false;
+            }
+
+            if (faceCount != 1 && faceCount != 6) {
+                error = "KTX2 file has an invalid face count";
+                return false;
+            }
+
+            // Every image takes at least one byte, which also keeps the layer count in 32 bits
+            if (layerCount > UINT32_MAX / faceCount || layerCount * faceCount > size || levelCount > 32) {
+                error = "KTX2 file has more images than it can hold";
+                return false;
+            }
+
+            if (size < kKtx2HeaderSize + levelCount * kKtx2LevelIndexEntrySize) {
+                error = "KTX2 level index is truncated";
+                return false;
+            }
+
+            info.type = TextureContainerType::eKtx2;
+            info.isCubemap = faceCount == 6;
+            info.desc.size.width = pixelWidth;
+            info.desc.size.height = std::max<uint32_t>(1, pixelHeight);
+            info.desc.size.depth = std::max<uint32_t>(1, pixelDepth);
+            info.desc.sliceLayersNum = layerCount * faceCount;
+            info.desc.mipLevelCount = levelCount;
+
+            if (pixelDepth > 0) {
+                info.desc.dimension = TextureDimension::e3D;
+            } else if (pixelHeight == 0) {
+                info.desc.dimension = TextureDimension::e1D;
+            } else {
+                info.desc.dimension = TextureDimension::e2D;
+            }
+
+            info.images.clear();
+            info.images.reserve(levelCount * info.desc.sliceLayersNum);
+
+            for (uint32_t level = 0; level < levelCount; level++) {
+                Uint64 entryOffset = kKtx2HeaderSize + level * kKtx2LevelIndexEntrySize;
+                Uint64 levelOffset = readValue<uint64_t>(data, entryOffset);
+                Uint64 levelLength = readValue<uint64_t>(data, entryOffset + 8);
+
+                Extent3D extent = getMipExtent(info.desc.size, level);
+                Uint64 imageSize = getCopyFootprint(info.desc.format, extent, 1).size;
+
+                // Compared without sums or products of file values, which a crafted header can make wrap
+                if (levelOffset > size || levelLength > size - levelOffset || info.desc.sliceLayersNum == 0
+                    || levelLength / info.desc.sliceLayersNum < imageSize)
+                {
+                    error = "KTX2 level data is out of bounds";
+                    return false;
+                }
+
+                // Within a level, images are ordered layer major, then face
+                for (Uint32 layer = 0; layer < info.desc.sliceLayersNum; layer++) {
+                    TextureContainerImage image;
+                    image.mipLevel = level;
+                    image.arrayLayer = layer;
+                    image.size = extent;
+                    image.offset = levelOffset + layer * imageSize;
+                    image.byteSize = imageSize;
+
+                    info.images.push_back(image);
+                }
+            }
+
+            return true;
+        }
+
+        // ===========================================================================================================================
+        // DDS
+        // ===========================================================================================================================
+
+        constexpr uint32_t kDdsMagic = makeFourCC('D', 'D', 'S', ' ');
+        constexpr Uint64 kDdsHeaderSize = 128;
+        constexpr Uint64 kDdsDx10HeaderSize = 20;
+
+        constexpr uint32_t kDdsFlagMipMapCount = 0x20000;
+        constexpr uint32_t kDdsPixelFlagFourCC = 0x4;
+        constexpr uint32_t kDdsPixelFlagRgb = 0x40;
+        constexpr uint32_t kDdsPixelFlagLuminance = 0x20000;
+        constexpr uint32_t kDdsCaps2Cubemap = 0x200;
+        constexpr uint32_t kDdsCaps2Volume = 0x200000;
+        constexpr uint32_t kDdsDx10MiscTextureCube = 0x4;
+
+        bool getFormatFromDxgiFormat(uint32_t dxgiFormat, TextureFormat& format) {
+            switch (dxgiFormat) {
+                case 2: format = eRGBA32Float; return true;
+                case 3: format = eRGBA32Uint; return true;
+                case 4: format = eRGBA32Sint; return true;
+                case 10: format = eRGBA16Float; return true;
+                case 12: format = eRGBA16Uint; return true;
+                case 14: format = eRGBA16Sint; return true;
+                case 16: format = eRG32Float; return true;
+                case 17: format = eRG32Uint; return true;
+                case 18: format = eRG32Sint; return true;
+                case 20: format = eD32SFloatS8Uint; return true;
+                case 24: format = eRGB10A2Unorm; return true;
+                case 25: format = eRGB10A2Uint; return true;
+                case 26: format = eRG11B10Ufloat; return true;
+                case 28: format = eRGBA8Unorm; return true;
+                case 29: format = eRGBA8UnormSrgb; return true;
+                case 30: format = eRGBA8Uint; return true;
+                case 31: format = eRGBA8Snorm; return true;
+                case 32: format = eRGBA8Sint; return true;
+                case 34: format = eRG16float; return true;
+                case 36: format = eRG16uint; return true;
+                case 38: format = eRG16sint; return true;
+                case 40: format = eD32Sfloat; return true;
+                case 41: format = eR32float; return true;
+                case 42: format = eR32uint; return true;
+                case 43: format = eR32sint; return true;
+                case 45: format = eD24PlusS8Uint; return true;
+                case 49: format = eRG8Unorm; return true;
+                case 50: format = eRG8Uint; return true;
+                case 51: format = eRG8Snorm; return true;
+                case 52: format = eRG8Sint; return true;
+                case 54: format = eR16Float; return true;
+                case 55: format = eD16Unorm; return true;
+                case 57: format = eR16Uint; return true;
+                case 59: format = eR16Sint; return true;
+                case 61: format = eR8Unorm; return true;
+                case 62: format = eR8Uint; return true;
+                case 63: format = eR8Snorm; return true;
+                case 64: format = eR8Sint; return true;
+                case 67: format = eRGB9E5Ufloat; return true;
+                case 71: format = eBC1RGBAUnorm; return true;
+                case 72: format = eBC1RGBAUnormSrgb; return true;
+                case 74: format = eBC2RGBAUnorm; return true;
+                case 75: format = eBC2RGBAUnormSrgb; return true;
+                case 77: format = eBC3RGBAUnorm; return true;
+                case 78: format = eBC3RGBAUnormSrgb; return true;
+                case 80: format = eBC4RUnorm; return true;
+                case 81: format = eBC4RSnorm; return true;
+                case 83: format = eBC5RGUnorm; return true;
+                case 84: format = eBC5RGSnorm; return true;
+                case 87: format = eBGRA8Unorm; return true;
+                case 91: format = eBGRA8UnormSrgb; return true;
+                case 95: format = eBC6HRGBUfloat; return true;
+                case 96: format = eBC6HRGBSfloat; return true;
+                case 98: format = eBC7RGBAUnorm; return true;
+                case 99: format = eBC7RGBAUnormSrgb; return true;
+            }
+
+            return false;
+        }
+
+        bool getFormatFromDdsPixelFormat(const uint8_t* data, TextureFormat& format) {
+            uint32_t flags = readValue<uint32_t>(data, 80);
+            uint32_t fourCC = readValue<uint32_t>(data, 84);
+            uint32_t bitCount = readValue<uint32_t>(data, 88);
+            uint32_t maskR = readValue<uint32_t>(data, 92);
+            uint32_t maskG = readValue<uint32_t>(data, 96);
+            uint32_t maskB = readValue<uint32_t>(data, 100);
+            uint32_t maskA = readValue<uint32_t>(data, 104);
+
+            if (flags & kDdsPixelFlagFourCC) {
+                switch (fourCC) {
+                    case makeFourCC('D', 'X', 'T', '1'): format = eBC1RGBAUnorm; return true;
+                    case makeFourCC('D', 'X', 'T', '2'):
+                    case makeFourCC('D', 'X', 'T', '3'): format = eBC2RGBAUnorm; return true;
+                    case makeFourCC('D', 'X', 'T', '4'):
+                    case makeFourCC('D', 'X', 'T', '5'): format = eBC3RGBAUnorm; return true;
+                    case makeFourCC('A', 'T', 'I', '1'):
+                    case makeFourCC('B', 'C', '4', 'U'): format = eBC4RUnorm; return true;
+                    case makeFourCC('B', 'C', '4', 'S'): format = eBC4RSnorm; return true;
+                    case makeFourCC('A', 'T', 'I', '2'):
+                    case makeFourCC('B', 'C', '5', 'U'): format = eBC5RGUnorm; return true;
+                    case makeFourCC('B', 'C', '5', 'S'): format = eBC5RGSnorm; return true;
+
+                    // Legacy D3DFORMAT values stored in the FourCC field
+                    case 111: format = eR16Float; return true;
+                    case 112: format = eRG16float; return true;
+                    case 113: format = eRGBA16Float; return true;
+                    case 114: format = eR32float; return true;
+                    case 115: format = eRG32Float; return true;
+                    case 116: format = eRGBA32Float; return true;
+                }
+
+                return false;
+            }
+
+            if ((flags & kDdsPixelFlagRgb) && bitCount == 32) {
+                if (maskR == 0x000000FF && maskG == 0x0000FF00 && maskB == 0x00FF0000) {
+                    format = eRGBA8Unorm;
+                    return true;
+                }
+
+                if (maskR == 0x00FF0000 && maskG == 0x0000FF00 && maskB == 0x000000FF) {
+                    format = eBGRA8Unorm;
+                    return true;
+                }
+
+                if (maskR == 0x000003FF && maskG == 0x000FFC00 && maskB == 0x3FF00000 && maskA == 0xC0000000) {
+                    format = eRGB10A2Unorm;
+                    return true;
+                }
+            }
+
+            if (flags & kDdsPixelFlagLuminance) {
+                if (bitCount == 8 && maskR == 0xFF) {
+                    format = eR8Unorm;
+                    return true;
+                }
+
+                if (bitCount == 16 && maskR == 0xFF && maskA == 0xFF00) {
+                    format = eRG8Unorm;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool parseDds(const uint8_t* data, Uint64 size, TextureContainerInfo& info, std::string& error) {
+            if (size < kDdsHeaderSize || readValue<uint32_t>(data, 4) != 124) {
+                error = "DDS header is truncated";
+                return false;
+            }
+
+            uint32_t flags = readValue<uint32_t>(data, 8);
+            uint32_t height = readValue<uint32_t>(data, 12);
+            uint32_t width = readValue<uint32_t>(data, 16);
+            uint32_t depth = readValue<uint32_t>(data, 24);
+            uint32_t mipMapCount = readValue<uint32_t>(data, 28);
+            uint32_t pixelFlags = readValue<uint32_t>(data, 80);
+            uint32_t fourCC = readValue<uint32_t>(data, 84);
+            uint32_t caps2 = readValue<uint32_t>(data, 112);
+
+            Uint64 dataOffset = kDdsHeaderSize;
+            uint32_t layerCount = 1;
+            uint32_t faceCount = (caps2 & kDdsCaps2Cubemap) ? 6 : 1;
+            bool isVolume = (caps2 & kDdsCaps2Volume) != 0;
+
+            if ((pixelFlags & kDdsPixelFlagFourCC) && fourCC == makeFourCC('D', 'X', '1', '0')) {
+                if (size < kDdsHeaderSize + kDdsDx10HeaderSize) {
+                    error = "DDS DX10 header is truncated";
+                    return false;
+                }
+
+                uint32_t dxgiFormat = readValue<uint32_t>(data, 128);
+                uint32_t resourceDimension = readValue<uint32_t>(data, 132);
+                uint32_t miscFlag = readValue<uint32_t>(data, 136);
+
+                if (!getFormatFromDxgiFormat(dxgiFormat, info.desc.format)) {
+                    error = "DDS file uses an unsupported DXGI format";
+                    return false;
+                }
+
+                layerCount = std::max<uint32_t>(1, readValue<uint32_t>(data, 140));
+                faceCount = (miscFlag & kDdsDx10MiscTextureCube) ? 6 : 1;
+                isVolume = resourceDimension == 4;
+                dataOffset += kDdsDx10HeaderSize;
+
+                if (resourceDimension == 2) {
+                    height = 1;
+                }
+            } else if (!getFormatFromDdsPixelFormat(data, info.desc.format)) {
+                error = "DDS file uses an unsupported pixel format";
+                return false;
+            }
+
+            info.type = TextureContainerType::eDds;
+            info.isCubemap = faceCount == 6;
+            info.desc.size.width = width;
+            info.desc.size.height = std::max<uint32_t>(1, height);
+            info.desc.size.depth = isVolume ? std::max<uint32_t>(1, depth) : 1;
+            info.desc.sliceLayersNum = isVolume ? 1 : layerCount * faceCount;
+            info.desc.mipLevelCount = (flags & kDdsFlagMipMapCount) ? std::max<uint32_t>(1, mipMapCount) : 1;
+
+            if (isVolume) {
+                info.desc.dimension = TextureDimension::e3D;
+            } else if (height <= 1 && !info.isCubemap) {
+                info.desc.dimension = TextureDimension::e1D;
+            } else {
+                info.desc.dimension = TextureDimension::e2D;
+            }
+
+            info.images.clear();
+            info.images.reserve(info.desc.mipLevelCount * info.desc.sliceLayersNum);
+
+            // DDS stores every mip of a layer before moving to the next layer
+            Uint64 offset = dataOffset;
+
+            for (Uint32 layer = 0; layer < info.desc.sliceLayersNum; layer++) {
+                for (Uint32 level = 0; level < info.desc.mipLevelCount; level++) {
+                    TextureContainerImage image;
+                    image.mipLevel = level;
+                    image.arrayLayer = layer;
+                    image.size = getMipExtent(info.desc.size, level);
+                    image.offset = offset;
+                    image.byteSize = getCopyFootprint(info.desc.format, image.size, 1).size;
+
+                    if (offset > size || image.byteSize > size - offset) {
+                        error = "DDS image data is out of bounds";
+                        return false;
+                    }
+
+                    offset += image.byteSize;
+
+                    info.images.push_back(image);
+                }
+            }
+
+            return true;
+        }
+    };
+
+    bool parseTextureContainer(const uint8_t* data, Uint64 size, TextureContainerInfo& info, std::string& error) {
+        if (size >= sizeof(kKtx2Identifier) && std::memcmp(data, kKtx2Identifier, sizeof(kKtx2Identifier)) == 0) {
+            return parseKtx2(data, size, info, error);
+        }
+
+        if (size >= 4 && readValue<uint32_t>(data, 0) == kDdsMagic) {
+            return parseDds(data, size, info, error);
+        }
+
+        error = "Unknown texture container";
+        return false;
+    }
+
+    // ===========================================================================================================================
+    // Texture Streamer
+    // ===========================================================================================================================
+
+    TextureStreamer::TextureStreamer(Device* device, TextureStreamerDescriptor descriptor)
+        : device{ device }, desc{ descriptor }, ioPool{ descriptor.ioThreadCount } {}
+
+    TextureStreamer::~TextureStreamer() {
+        this->ioPool.wait();
+    }
+
+    std::shared_ptr<TextureStreamTicket> TextureStreamer::request(TextureStreamRequest request) {
+        auto ticket = std::make_shared<TextureStreamTicket>();
+        ticket->request = std::move(request);
+
+        this->ioPool.submit([this, ticket] { this->load(ticket); }, ticket->request.priority);
+        return ticket;
+    }
+
+    void TextureStreamer::load(const std::shared_ptr<TextureStreamTicket>& ticket) {
+        ticket->status = TextureStreamStatus::eLoading;
+
+        MappedFile file;
+        if (!file.open(ticket->request.path)) {
+            ticket->error = "Failed to map " + ticket->request.path;
+            ticket->status = TextureStreamStatus::eFailed;
+            return;
+        }
+
+        TextureContainerInfo info;
+        if (!parseTextureContainer(file.getData(), file.getSize(), info, ticket->error)) {
+            ticket->status = TextureStreamStatus::eFailed;
+            return;
+        }
+
+        // Start pulling the whole payload into the page cache while the staging buffer is created
+        file.prefetch(0, file.getSize());
+
+        Uint64 stagingSize = 0;
+
+        ticket->regions.reserve(info.images.size());
+        for (const auto& image : info.images) {
+            CopyFootprint footprint = getCopyFootprint(info.desc.format, image.size);
+
+            TextureUploadRegion region;
+            region.mipLevel = image.mipLevel;
+            region.arrayLayer = image.arrayLayer;
+            region.size = image.size;
+            region.layout.offset = alignCopyOffset(stagingSize, kTextureCopyOffsetAlignment);
+            region.layout.bytesPerRow = footprint.bytesPerRow;
+            region.layout.rowsPerImage = footprint.rowsPerImage;
+
+            stagingSize = region.layout.offset + footprint.size;
+            ticket->regions.push_back(region);
+        }
+
+        info.desc.usage = ticket->request.usage;
+        ticket->texture = this->device->createTexture(info.desc);
+
+        // Compute only devices have no textures
+        if (ticket->texture == nullptr) {
+            ticket->error = "Failed to create the texture for " + ticket->request.path;
+            ticket->status = TextureStreamStatus::eFailed;
+            return;
+        }
+
+        BufferDescriptor stagingDesc;
+        stagingDesc.size = stagingSize;
+        stagingDesc.usage = static_cast<BufferUsageFlags>(BufferUsage::eCopySrc);
+        stagingDesc.location = BufferLocation::eHost;
+
+        ticket->staging = this->device->createBuffer(stagingDesc);
+        uint8_t* staging = ticket->staging != nullptr ? static_cast<uint8_t*>(ticket->staging->map(stagingSize, 0)) : nullptr;
+
+        if (staging == nullptr) {
+            ticket->error = "Failed to map the staging buffer for " + ticket->request.path;
+            ticket->texture = nullptr;
+            ticket->staging = nullptr;
+            ticket->status = TextureStreamStatus::eFailed;
+            return;
+        }
+
+        // The only copy a texel goes through on the CPU: page cache to staging
+        for (size_t i = 0; i < info.images.size(); i++) {
+            const TextureContainerImage& image = info.images[i];
+            const TextureUploadRegion& region = ticket->regions[i];
+
+            const uint8_t* src = file.getData() + image.offset;
+            uint8_t* dst = staging + region.layout.offset;
+
+            Uint64 tightRowSize = getTextureRowBytes(info.desc.format, image.size.width);
+
+            if (tightRowSize == region.layout.bytesPerRow) {
+                std::memcpy(dst, src, image.byteSize);
+                continue;
+            }
+
+            Uint64 rowCount = static_cast<Uint64>(region.layout.rowsPerImage) * image.size.depth;
+            for (Uint64 row = 0; row < rowCount; row++) {
+                std::memcpy(dst + row * region.layout.bytesPerRow, src + row * tightRowSize, tightRowSize);
+            }
+        }
+
+        ticket->staging->flush(stagingSize, 0);
+        ticket->staging->unmap();
+
+        ticket->status = TextureStreamStatus::eStaged;
+
+        std::lock_guard<std::mutex> lock(this->stagedMutex);
+        this->staged.push_back(ticket);
+    }
+
+    Uint32 TextureStreamer::recordUploads(CommandEncoder* encoder, Uint64 frameIndex) {
+        std::vector<std::shared_ptr<TextureStreamTicket>> ready;
+
+        {
+            std::lock_guard<std::mutex> lock(this->stagedMutex);
+            ready.swap(this->staged);
+        }
+
+        for (const auto& ticket : ready) {
+            Texture* texture = ticket->texture.get();
+
+            TextureSubresource subresource;
+            subresource.mipLevelCount = texture->desc.mipLevelCount;
+            subresource.arrayLayerCount = texture->desc.sliceLayersNum;
+
+            ImageBarrier toCopy;
+            toCopy.srcAccess = ResourceAccess::eReadOnly;
+            toCopy.dstAccess = ResourceAccess::eWriteOnly;
+            toCopy.texture = texture;
+            toCopy.subresource = subresource;
+            toCopy.srcState = TextureState::eUndefined;
+            toCopy.dstState = TextureState::eCopyDst;
+
+            encoder->activateImageBarrier(this->desc.consumerStage, ShaderStage::eTransfer, toCopy);
+
+            for (const auto& region : ticket->regions) {
+                ImageCopyBuffer source;
+                static_cast<ImageDataLayout&>(source) = region.layout;
+                source.buffer = ticket->staging.get();
+
+                ImageCopyTexture destination;
+                destination.texture = texture;
+                destination.mipLevel = region.mipLevel;
+                destination.origin.z = region.arrayLayer;
+
+                encoder->copyBufferToTexture(source, destination, region.size);
+            }
+
+            ImageBarrier toShader = toCopy;
+            toShader.srcAccess = ResourceAccess::eWriteOnly;
+            toShader.dstAccess = ResourceAccess::eReadOnly;
+            toShader.srcState = TextureState::eCopyDst;
+            toShader.dstState = TextureState::eShaderReadOnly;
+
+            encoder->activateImageBarrier(ShaderStage::eTransfer, this->desc.consumerStage, toShader);
+            setTextureState(texture, TextureState::eShaderReadOnly);
+
+            this->inFlightStaging.emplace_back(frameIndex, std::move(ticket->staging));
+            ticket->regions.clear();
+            ticket->status = TextureStreamStatus::eRecorded;
+        }
+
+        return static_cast<Uint32>(ready.size());
+    }
+
+    void TextureStreamer::releaseStaging(Uint64 completedFrameIndex) {
+        auto retired = std::remove_if(this->inFlightStaging.begin(), this->inFlightStaging.end(),
+            [completedFrameIndex](const std::pair<Uint64, std::shared_ptr<Buffer>>& entry) {
+                return entry.first <= completedFrameIndex;
+            });
+
+        this->inFlightStaging.erase(retired, this->inFlightStaging.end());
+    }
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "copy_footprint.hpp"
+#include "mapped_file.hpp"
+#include "task_pool.hpp"
+
+#include <atomic>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Texture Container
+    // ===========================================================================================================================
+
+    enum class TextureContainerType : Uint8 {
+        eKtx2,
+        eDds
+    };
+
+    // One mip level of one array layer (cube faces count as layers) inside the container.
+    // Depth slices of a 3D texture follow each other, rows are tightly packed.
+    struct TextureContainerImage {
+        Uint32 mipLevel;
+        Uint32 arrayLayer;
+        Extent3D size;
+
+        Uint64 offset;
+        Uint64 byteSize;
+    };
+
+    struct TextureContainerInfo {
+        TextureContainerType type;
+        TextureDescriptor desc;
+        bool isCubemap = false;
+
+        std::vector<TextureContainerImage> images;
+    };
+
+    // Parses a KTX2 or DDS header in place. Image offsets point into the given memory,
+    // nothing is decoded or copied. Supercompressed KTX2 files are rejected.
+    bool parseTextureContainer(const uint8_t* data, Uint64 size, TextureContainerInfo& info, std::string& error);
+
+    // ===========================================================================================================================
+    // Texture Streamer
+    // ===========================================================================================================================
+
+    enum class TextureStreamStatus : Uint8 {
+        eQueued,
+        eLoading,
+        eStaged,
+        eRecorded,
+        eFailed
+    };
+
+    struct TextureStreamRequest {
+        std::string path;
+        Int32 priority = 0;
+
+        TextureUsageFlags usage = static_cast<TextureUsageFlags>(TextureUsage::eTextureBinding)
+            | static_cast<TextureUsageFlags>(TextureUsage::eCopyDst);
+    };
+
+    class TextureStreamTicket {
+    public:
+        TextureStreamStatus getStatus() const { return this->status.load(); }
+
+        // Valid once the status reached eStaged
+        std::shared_ptr<Texture> getTexture() const { return this->texture; }
+        const std::string& getError() const { return this->error; }
+
+    private:
+        friend class TextureStreamer;
+
+        std::atomic<TextureStreamStatus> status{ TextureStreamStatus::eQueued };
+        TextureStreamRequest request;
+
+        std::shared_ptr<Texture> texture;
+        std::shared_ptr<Buffer> staging;
+        std::vector<TextureUploadRegion> regions;
+        std::string error;
+    };
+
+    struct TextureStreamerDescriptor {
+        Uint32 ioThreadCount = 2;
+        ShaderStage consumerStage = ShaderStage::eFragment;
+    };
+
+    // Loads KTX2/DDS files on I/O worker threads. Each file is memory mapped and its mip
+    // levels are copied once, from the page cache straight into a host staging buffer laid
+    // out for copyBufferToTexture. The copies themselves are recorded on the caller's thread.
+    //
+    // The device must allow createBuffer/createTexture and Buffer::map from worker threads.
+    class TextureStreamer {
+    public:
+        TextureStreamer(Device* device, TextureStreamerDescriptor descriptor = {});
+        ~TextureStreamer();
+
+        std::shared_ptr<TextureStreamTicket> request(TextureStreamRequest request);
+
+        // Records the staging to texture copies of every staged ticket and moves the textures
+        // to TextureState::eShaderReadOnly. Returns the number of textures recorded.
+        Uint32 recordUploads(CommandEncoder* encoder, Uint64 frameIndex);
+
+        // Drops staging buffers whose copies were recorded on or before completedFrameIndex
+        void releaseStaging(Uint64 completedFrameIndex);
+
+    private:
+        Device* device;
+        TextureStreamerDescriptor desc;
+
+        std::mutex stagedMutex;
+        std::vector<std::shared_ptr<TextureStreamTicket>> staged;
+        std::vector<std::pair<Uint64, std::shared_ptr<Buffer>>> inFlightStaging;
+
+        // Declared last so worker threads are joined before the state they touch is destroyed
+        TaskPool ioPool;
+
+        void load(const std::shared_ptr<TextureStreamTicket>& ticket);
+    };
+};
@@ -0,0 +1,561 @@
+#include "tiled_texture.hpp"
+#include "copy_footprint.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define RHI_TILED_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace Rhi {
+    namespace {
+        constexpr Uint32 kTileBytesLog2 = 12;
+
+        Uint32 ceilLog2(Uint32 value) {
+            Uint32 result = 0;
+            while ((1u << result) < value) {
+                result++;
+            }
+
+            return result;
+        }
+
+        template <bool kToTiled>
+        using TiledPointer = std::conditional_t<kToTiled, uint8_t*, const uint8_t*>;
+
+        template <bool kToTiled>
+        using LinearPointer = std::conditional_t<kToTiled, const uint8_t*, uint8_t*>;
+
+        // A 4x4 square in tiled order is four 2x2 quads in Z order, each quad two blocks of its
+        // first row then two of its second. B is zero when the block size is only known at run time.
+        template <Uint32 B>
+        inline void swizzleSquare(uint8_t* tiled, const uint8_t* linear, Uint64 bytesPerRow, Uint32 bytes) {
+            for (Uint32 quad = 0; quad < 4; quad++) {
+                const uint8_t* row = linear + (quad >> 1) * 2 * bytesPerRow + (quad & 1) * 2 * bytes;
+
+                std::memcpy(tiled + quad * 4 * bytes, row, 2 * bytes);
+                std::memcpy(tiled + quad * 4 * bytes + 2 * bytes, row + bytesPerRow, 2 * bytes);
+            }
+        }
+
+        template <Uint32 B>
+        inline void deswizzleSquare(uint8_t* linear, const uint8_t* tiled, Uint64 bytesPerRow, Uint32 bytes) {
+            for (Uint32 quad = 0; quad < 4; quad++) {
+                uint8_t* row = linear + (quad >> 1) * 2 * bytesPerRow + (quad & 1) * 2 * bytes;
+
+                std::memcpy(row, tiled + quad * 4 * bytes, 2 * bytes);
+                std::memcpy(row + bytesPerRow, tiled + quad * 4 * bytes + 2 * bytes, 2 * bytes);
+            }
+        }
+
+#if defined(RHI_TILED_SSE2)
+        inline __m128i load32(const uint8_t* data) {
+            int value;
+            std::memcpy(&value, data, 4);
+            return _mm_cvtsi32_si128(value);
+        }
+
+        inline void store32(uint8_t* data, __m128i value) {
+            int bits = _mm_cvtsi128_si32(value);
+            std::memcpy(data, &bits, 4);
+        }
+
+        // Rows of four one byte blocks: pairs of blocks from two rows interleave as 16 bit words
+        template <>
+        inline void swizzleSquare<1>(uint8_t* tiled, const uint8_t* linear, Uint64 bytesPerRow, Uint32) {
+            __m128i top = _mm_unpacklo_epi16(load32(linear), load32(linear + bytesPerRow));
+            __m128i bottom = _mm_unpacklo_epi16(load32(linear + 2 * bytesPerRow), load32(linear + 3 * bytesPerRow));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(tiled), _mm_unpacklo_epi64(top, bottom));
+        }
+
+        template <>
+        inline void deswizzleSquare<1>(uint8_t* linear, const uint8_t* tiled, Uint64 bytesPerRow, Uint32) {
+            __m128i square = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tiled));
+            square = _mm_shufflelo_epi16(square, _MM_SHUFFLE(3, 1, 2, 0));
+            square = _mm_shufflehi_epi16(square, _MM_SHUFFLE(3, 1, 2, 0));
+
+            for (Uint32 row = 0; row < 4; row++) {
+                store32(linear + row * bytesPerRow, square);
+                square = _mm_srli_si128(square, 4);
+            }
+        }
+
+        template <>
+        inline void swizzleSquare<2>(uint8_t* tiled, const uint8_t* linear, Uint64 bytesPerRow, Uint32) {
+            for (Uint32 half = 0; half < 2; half++) {
+                const uint8_t* rows = linear + half * 2 * bytesPerRow;
+
+                __m128i first = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows));
+                __m128i second = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(rows + bytesPerRow));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(tiled + half * 16), _mm_unpacklo_epi32(first, second));
+            }
+        }
+
+        template <>
+        inline void deswizzleSquare<2>(uint8_t* linear, const uint8_t* tiled, Uint64 bytesPerRow, Uint32) {
+            for (Uint32 half = 0; half < 2; half++) {
+                uint8_t* rows = linear + half * 2 * bytesPerRow;
+
+                __m128i quads = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tiled + half * 16));
+                quads = _mm_shuffle_epi32(quads, _MM_SHUFFLE(3, 1, 2, 0));
+
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(rows), quads);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(rows + bytesPerRow), _mm_srli_si128(quads, 8));
+            }
+        }
+
+        template <>
+        inline void swizzleSquare<4>(uint8_t* tiled, const uint8_t* linear, Uint64 bytesPerRow, Uint32) {
+            for (Uint32 half = 0; half < 2; half++) {
+                const uint8_t* rows = linear + half * 2 * bytesPerRow;
+
+                __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows));
+                __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows + bytesPerRow));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(tiled + half * 32), _mm_unpacklo_epi64(first, second));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(tiled + half * 32 + 16), _mm_unpackhi_epi64(first, second));
+            }
+        }
+
+        template <>
+        inline void deswizzleSquare<4>(uint8_t* linear, const uint8_t* tiled, Uint64 bytesPerRow, Uint32) {
+            for (Uint32 half = 0; half < 2; half++) {
+                uint8_t* rows = linear + half * 2 * bytesPerRow;
+
+                __m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tiled + half * 32));
+                __m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tiled + half * 32 + 16));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(rows), _mm_unpacklo_epi64(left, right));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(rows + bytesPerRow), _mm_unpackhi_epi64(left, right));
+            }
+        }
+#endif
+
+        // Copies rows [y, y + height) of columns [x, x + width) of one slice. Rows four aligned
+        // groups of four go square by square, the ragged edges block by block.
+        template <Uint32 B, bool kToTiled>
+        void copyBlocks(const TiledTexture& texture, TiledPointer<kToTiled> tiled, Uint32 mipLevel, Uint32 slice,
+            Uint32 x, Uint32 y, Uint32 width, Uint32 height, LinearPointer<kToTiled> linear, Uint64 bytesPerRow, Uint32 blockBytes)
+        {
+            const Uint32 bytes = B != 0 ? B : blockBytes;
+
+            auto copyBlock = [&](Uint32 column, Uint32 row) {
+                auto tiledBlock = tiled + texture.getBlockOffset(mipLevel, column, row, slice);
+                auto linearBlock = linear + (row - y) * bytesPerRow + (column - x) * bytes;
+
+                if constexpr (kToTiled) {
+                    std::memcpy(tiledBlock, linearBlock, bytes);
+                } else {
+                    std::memcpy(linearBlock, tiledBlock, bytes);
+                }
+            };
+
+            Uint32 endX = x + width;
+            Uint32 endY = y + height;
+
+            for (Uint32 row = y; row < endY;) {
+                if ((row & 3) != 0 || row + 4 > endY) {
+                    for (Uint32 column = x; column < endX; column++) {
+                        copyBlock(column, row);
+                    }
+
+                    row++;
+                    continue;
+                }
+
+                Uint32 column = x;
+                for (; column < endX && (column & 3) != 0; column++) {
+                    for (Uint32 r = 0; r < 4; r++) {
+                        copyBlock(column, row + r);
+                    }
+                }
+
+                for (; column + 4 <= endX; column += 4) {
+                    auto tiledSquare = tiled + texture.getBlockOffset(mipLevel, column, row, slice);
+                    auto linearSquare = linear + (row - y) * bytesPerRow + (column - x) * bytes;
+
+                    if constexpr (kToTiled) {
+                        swizzleSquare<B>(tiledSquare, linearSquare, bytesPerRow, bytes);
+                    } else {
+                        deswizzleSquare<B>(linearSquare, tiledSquare, bytesPerRow, bytes);
+                    }
+                }
+
+                for (; column < endX; column++) {
+                    for (Uint32 r = 0; r < 4; r++) {
+                        copyBlock(column, row + r);
+                    }
+                }
+
+                row += 4;
+            }
+        }
+
+        template <bool kToTiled>
+        void copyBlocks(const TiledTexture& texture, TiledPointer<kToTiled> tiled, Uint32 mipLevel, Uint32 slice,
+            Uint32 x, Uint32 y, Uint32 width, Uint32 height, LinearPointer<kToTiled> linear, Uint64 bytesPerRow)
+        {
+            Uint32 bytes = texture.getBlockBytes();
+
+            switch (bytes) {
+                case 1: copyBlocks<1, kToTiled>(texture, tiled, mipLevel, slice, x, y, width, height, linear, bytesPerRow, 1); break;
+                case 2: copyBlocks<2, kToTiled>(texture, tiled, mipLevel, slice, x, y, width, height, linear, bytesPerRow, 2); break;
+                case 4: copyBlocks<4, kToTiled>(texture, tiled, mipLevel, slice, x, y, width, height, linear, bytesPerRow, 4); break;
+                case 8: copyBlocks<8, kToTiled>(texture, tiled, mipLevel, slice, x, y, width, height, linear, bytesPerRow, 8); break;
+                case 16: copyBlocks<16, kToTiled>(texture, tiled, mipLevel, slice, x, y, width, height, linear, bytesPerRow, 16); break;
+                default: copyBlocks<0, kToTiled>(texture, tiled, mipLevel, slice, x, y, width, height, linear, bytesPerRow, bytes); break;
+            }
+        }
+
+        // In blocks, slices from slice
+        struct CopyBox {
+            Uint32 mipLevel;
+            Uint32 x;
+            Uint32 y;
+            Uint32 slice;
+            Uint32 width;
+            Uint32 height;
+            Uint32 sliceCount;
+        };
+
+        CopyBox getCopyBox(const TiledTexture& texture, Uint32 mipLevel, Origin3D origin, Extent3D extent) {
+            Uint32 blockWidth = texture.getBlockWidth();
+            Uint32 blockHeight = texture.getBlockHeight();
+
+            CopyBox box{ mipLevel, origin.x / blockWidth, origin.y / blockHeight, origin.z, 0, 0, 0 };
+            if (mipLevel >= texture.getMipCount()) {
+                return box;
+            }
+
+            auto clip = [](Uint32 begin, Uint32 count, Uint32 limit) -> Uint32 {
+                return begin < limit ? std::min(count, limit - begin) : 0;
+            };
+
+            Extent3D blocks = texture.getMipBlocks(mipLevel);
+            box.width = clip(box.x, (extent.width + blockWidth - 1) / blockWidth, blocks.width);
+            box.height = clip(box.y, (extent.height + blockHeight - 1) / blockHeight, blocks.height);
+            box.sliceCount = clip(box.slice, extent.depth, blocks.depth);
+
+            return box;
+        }
+
+        // Rows of a box within one tile row of one slice, the slice counted from the box's first
+        struct Band {
+            Uint32 slice;
+            Uint32 y;
+            Uint32 height;
+        };
+
+        Uint32 getTileRowsPerSlice(const TiledTexture& texture, const CopyBox& box) {
+            if (box.width == 0 || box.height == 0) {
+                return 0;
+            }
+
+            Uint32 tileHeight = texture.getTileHeight();
+            return (box.y + box.height - 1) / tileHeight - box.y / tileHeight + 1;
+        }
+
+        Band getBand(const TiledTexture& texture, const CopyBox& box, Uint32 tileRowsPerSlice, Uint32 index) {
+            Uint32 tileHeight = texture.getTileHeight();
+            Uint32 tileRow = box.y / tileHeight + index % tileRowsPerSlice;
+
+            Uint32 begin = std::max(box.y, tileRow * tileHeight);
+            Uint32 end = std::min(box.y + box.height, (tileRow + 1) * tileHeight);
+
+            return Band{ index / tileRowsPerSlice, begin, end - begin };
+        }
+
+        struct LinearCopy {
+            CopyBox box;
+            Uint32 tileRowsPerSlice;
+            Uint64 bytesPerRow;
+            Uint64 bytesPerImage;
+        };
+
+        LinearCopy getLinearCopy(const TiledTexture& texture, Uint32 mipLevel, Origin3D origin, Extent3D extent,
+            const ImageDataLayout& layout)
+        {
+            LinearCopy copy;
+            copy.box = getCopyBox(texture, mipLevel, origin, extent);
+            copy.tileRowsPerSlice = getTileRowsPerSlice(texture, copy.box);
+
+            // The image keeps the layout's pitch even when the box is clipped
+            Uint32 blockHeight = texture.getBlockHeight();
+            Uint32 rowsPerImage = layout.rowsPerImage != 0 ? layout.rowsPerImage : (extent.height + blockHeight - 1) / blockHeight;
+
+            Uint32 blockWidth = texture.getBlockWidth();
+            copy.bytesPerRow = layout.bytesPerRow != 0 ? layout.bytesPerRow
+                : static_cast<Uint64>((extent.width + blockWidth - 1) / blockWidth) * texture.getBlockBytes();
+            copy.bytesPerImage = copy.bytesPerRow * rowsPerImage;
+
+            return copy;
+        }
+
+        template <bool kToTiled>
+        void copyLinearBands(const TiledTexture& texture, TiledPointer<kToTiled> tiled, const LinearCopy& copy,
+            LinearPointer<kToTiled> linear, Uint32 begin, Uint32 end)
+        {
+            const CopyBox& box = copy.box;
+
+            for (Uint32 index = begin; index < end; index++) {
+                Band band = getBand(texture, box, copy.tileRowsPerSlice, index);
+                auto bandLinear = linear + band.slice * copy.bytesPerImage + (band.y - box.y) * copy.bytesPerRow;
+
+                if constexpr (!kToTiled) {
+                    if (tiled == nullptr) {
+                        for (Uint32 row = 0; row < band.height; row++) {
+                            std::memset(bandLinear + row * copy.bytesPerRow, 0, static_cast<Uint64>(box.width) * texture.getBlockBytes());
+                        }
+
+                        continue;
+                    }
+                }
+
+                copyBlocks<kToTiled>(texture, tiled, box.mipLevel, box.slice + band.slice, box.x, band.y, box.width, band.height,
+                    bandLinear, copy.bytesPerRow);
+            }
+        }
+
+        struct TiledCopy {
+            CopyBox source;
+            CopyBox destination;
+            Uint32 tileRowsPerSlice;
+        };
+
+        // Boxes of equal size, clipped to both mips. Bands follow the source's tile rows.
+        TiledCopy getTiledCopy(const TiledTexture& source, Uint32 sourceMip, Origin3D sourceOrigin,
+            const TiledTexture& destination, Uint32 destinationMip, Origin3D destinationOrigin, Extent3D extent)
+        {
+            TiledCopy copy;
+            copy.source = getCopyBox(source, sourceMip, sourceOrigin, extent);
+            copy.destination = getCopyBox(destination, destinationMip, destinationOrigin, extent);
+
+            if (source.getBlockBytes() != destination.getBlockBytes()) {
+                copy.source.width = 0;
+            }
+
+            Uint32 width = std::min(copy.source.width, copy.destination.width);
+            Uint32 height = std::min(copy.source.height, copy.destination.height);
+            Uint32 sliceCount = std::min(copy.source.sliceCount, copy.destination.sliceCount);
+
+            for (CopyBox* box : { &copy.source, &copy.destination }) {
+                box->width = width;
+                box->height = height;
+                box->sliceCount = sliceCount;
+            }
+
+            copy.tileRowsPerSlice = getTileRowsPerSlice(source, copy.source);
+            return copy;
+        }
+
+        // Each band goes through scratch as a tightly packed linear image
+        void copyTiledBands(const TiledTexture& source, const uint8_t* sourceData, const TiledTexture& destination,
+            uint8_t* destinationData, const TiledCopy& copy, Uint32 begin, Uint32 end)
+        {
+            Uint64 bytesPerRow = static_cast<Uint64>(copy.source.width) * source.getBlockBytes();
+            std::vector<uint8_t> scratch(bytesPerRow * source.getTileHeight());
+
+            for (Uint32 index = begin; index < end; index++) {
+                Band band = getBand(source, copy.source, copy.tileRowsPerSlice, index);
+
+                if (sourceData == nullptr) {
+                    std::fill(scratch.begin(), scratch.end(), 0);
+                } else {
+                    copyBlocks<false>(source, sourceData, copy.source.mipLevel, copy.source.slice + band.slice,
+                        copy.source.x, band.y, copy.source.width, band.height, scratch.data(), bytesPerRow);
+                }
+
+                copyBlocks<true>(destination, destinationData, copy.destination.mipLevel, copy.destination.slice + band.slice,
+                    copy.destination.x, copy.destination.y + (band.y - copy.source.y), copy.destination.width, band.height,
+                    scratch.data(), bytesPerRow);
+            }
+        }
+
+        Uint32 getBandsPerJob(const TiledTexture& texture, Uint32 width, Uint64 jobBytes) {
+            Uint64 bandBytes = std::max<Uint64>(1, static_cast<Uint64>(width) * texture.getBlockBytes() * texture.getTileHeight());
+            return static_cast<Uint32>(std::max<Uint64>(1, jobBytes / bandBytes));
+        }
+
+        // Jobs copy disjoint bands. The caller copies bands too, so it may run on a worker of the pool.
+        template <typename CopyBands>
+        void copyParallel(TaskPool& pool, Uint32 bandCount, Uint32 bandsPerJob, CopyBands copyBands) {
+            Uint32 jobCount = (bandCount + bandsPerJob - 1) / bandsPerJob;
+
+            if (jobCount <= 1) {
+                copyBands(0, bandCount);
+                return;
+            }
+
+            pool.parallelFor(jobCount, [&](Uint32 job) {
+                copyBands(job * bandsPerJob, std::min(bandCount, (job + 1) * bandsPerJob));
+            });
+        }
+    };
+
+    // ===========================================================================================================================
+    // Tiled Texture Storage
+    // ===========================================================================================================================
+
+    TiledTexture::TiledTexture(const TextureDescriptor& descriptor) {
+        const TextureFormatTraits& traits = getTextureFormatTraits(descriptor.format);
+
+        this->format = descriptor.format;
+        this->dimension = descriptor.dimension;
+        this->blockBytes = std::max<Uint32>(1, traits.blockBytes);
+        this->blockWidth = std::max<Uint32>(1, traits.blockWidth);
+        this->blockHeight = std::max<Uint32>(1, traits.blockHeight);
+
+        // Wider than high when the tile's block count is an odd power of two. At least 4x4.
+        Uint32 blocksLog2 = std::max<Uint32>(4, kTileBytesLog2 - std::min(kTileBytesLog2, ceilLog2(this->blockBytes)));
+        this->tileWidthLog2 = (blocksLog2 + 1) / 2;
+        this->tileHeightLog2 = blocksLog2 / 2;
+        this->tileBytes = static_cast<Uint64>(this->blockBytes) << blocksLog2;
+
+        // x and y bits interleave from the bottom, the extra x bit of a wide tile goes on top
+        for (Uint32 i = 0; i < this->getTileWidth(); i++) {
+            Uint32 x = 0;
+            Uint32 y = 0;
+
+            for (Uint32 bit = 0; bit < this->tileWidthLog2; bit++) {
+                if (((i >> bit) & 1) == 0) {
+                    continue;
+                }
+
+                x |= bit < this->tileHeightLog2 ? 1u << (2 * bit) : 1u << (this->tileHeightLog2 + bit);
+                if (bit < this->tileHeightLog2) {
+                    y |= 1u << (2 * bit + 1);
+                }
+            }
+
+            this->mortonX[i] = static_cast<uint16_t>(x);
+            this->mortonY[i] = static_cast<uint16_t>(y);
+        }
+
+        Uint32 mipCount = std::max<Uint32>(1, descriptor.mipLevelCount);
+        this->mips.resize(mipCount);
+
+        for (Uint32 mipLevel = 0; mipLevel < mipCount; mipLevel++) {
+            Extent3D extent = getMipExtent(descriptor.size, mipLevel);
+            MipLayout& mip = this->mips[mipLevel];
+
+            mip.offset = this->size;
+            mip.blocksWide = (extent.width + this->blockWidth - 1) / this->blockWidth;
+            mip.blocksHigh = (extent.height + this->blockHeight - 1) / this->blockHeight;
+            mip.sliceCount = descriptor.dimension == TextureDimension::e3D ? extent.depth
+                : std::max<Uint32>(1, descriptor.sliceLayersNum);
+            mip.tilesWide = (mip.blocksWide + this->getTileWidth() - 1) >> this->tileWidthLog2;
+            mip.tilesHigh = (mip.blocksHigh + this->getTileHeight() - 1) >> this->tileHeightLog2;
+
+            this->size += this->tileBytes * mip.tilesWide * mip.tilesHigh * mip.sliceCount;
+        }
+    }
+
+    Extent3D TiledTexture::getMipBlocks(Uint32 mipLevel) const {
+        const MipLayout& mip = this->mips[mipLevel];
+        return Extent3D{ mip.blocksWide, mip.blocksHigh, mip.sliceCount };
+    }
+
+    uint8_t* TiledTexture::acquireData() {
+        if (this->storage.empty()) {
+            this->storage.resize(this->size);
+        }
+
+        return this->storage.data();
+    }
+
+    // ===========================================================================================================================
+    // Tiled Copies
+    // ===========================================================================================================================
+
+    void copyLinearToTiled(TiledTexture& destination, Uint32 mipLevel, Origin3D origin, Extent3D extent,
+        const void* source, ImageDataLayout layout)
+    {
+        LinearCopy copy = getLinearCopy(destination, mipLevel, origin, extent, layout);
+        Uint32 bandCount = copy.tileRowsPerSlice * copy.box.sliceCount;
+
+        if (bandCount > 0) {
+            copyLinearBands<true>(destination, destination.acquireData(), copy,
+                static_cast<const uint8_t*>(source) + layout.offset, 0, bandCount);
+        }
+    }
+
+    void copyTiledToLinear(const TiledTexture& source, Uint32 mipLevel, Origin3D origin, Extent3D extent,
+        void* destination, ImageDataLayout layout)
+    {
+        LinearCopy copy = getLinearCopy(source, mipLevel, origin, extent, layout);
+
+        copyLinearBands<false>(source, source.getData(), copy, static_cast<uint8_t*>(destination) + layout.offset,
+            0, copy.tileRowsPerSlice * copy.box.sliceCount);
+    }
+
+    void copyTiledToTiled(const TiledTexture& source, Uint32 sourceMip, Origin3D sourceOrigin,
+        TiledTexture& destination, Uint32 destinationMip, Origin3D destinationOrigin, Extent3D extent)
+    {
+        TiledCopy copy = getTiledCopy(source, sourceMip, sourceOrigin, destination, destinationMip, destinationOrigin, extent);
+        Uint32 bandCount = copy.tileRowsPerSlice * copy.source.sliceCount;
+
+        if (bandCount > 0) {
+            copyTiledBands(source, source.getData(), destination, destination.acquireData(), copy, 0, bandCount);
+        }
+    }
+
+    void copyLinearToTiled(TaskPool& pool, TiledTexture& destination, Uint32 mipLevel, Origin3D origin, Extent3D extent,
+        const void* source, ImageDataLayout layout, Uint64 jobBytes)
+    {
+        LinearCopy copy = getLinearCopy(destination, mipLevel, origin, extent, layout);
+        Uint32 bandCount = copy.tileRowsPerSlice * copy.box.sliceCount;
+
+        if (bandCount == 0) {
+            return;
+        }
+
+        uint8_t* tiled = destination.acquireData();
+        const uint8_t* linear = static_cast<const uint8_t*>(source) + layout.offset;
+
+        copyParallel(pool, bandCount, getBandsPerJob(destination, copy.box.width, jobBytes), [&](Uint32 begin, Uint32 end) {
+            copyLinearBands<true>(destination, tiled, copy, linear, begin, end);
+        });
+    }
+
+    void copyTiledToLinear(TaskPool& pool, const TiledTexture& source, Uint32 mipLevel, Origin3D origin, Extent3D extent,
+        void* destination, ImageDataLayout layout, Uint64 jobBytes)
+    {
+        LinearCopy copy = getLinearCopy(source, mipLevel, origin, extent, layout);
+        uint8_t* linear = static_cast<uint8_t*>(destination) + layout.offset;
+
+        copyParallel(pool, copy.tileRowsPerSlice * copy.box.sliceCount, getBandsPerJob(source, copy.box.width, jobBytes),
+            [&](Uint32 begin, Uint32 end) {
+                copyLinearBands<false>(source, source.getData(), copy, linear, begin, end);
+            });
+    }
+
+    void copyTiledToTiled(TaskPool& pool, const TiledTexture& source, Uint32 sourceMip, Origin3D sourceOrigin,
+        TiledTexture& destination, Uint32 destinationMip, Origin3D destinationOrigin, Extent3D extent, Uint64 jobBytes)
+    {
+        TiledCopy copy = getTiledCopy(source, sourceMip, sourceOrigin, destination, destinationMip, destinationOrigin, extent);
+        Uint32 bandCount = copy.tileRowsPerSlice * copy.source.sliceCount;
+
+        if (bandCount == 0) {
+            return;
+        }
+
+        uint8_t* destinationData = destination.acquireData();
+
+        copyParallel(pool, bandCount, getBandsPerJob(source, copy.source.width, jobBytes), [&](Uint32 begin, Uint32 end) {
+            copyTiledBands(source, source.getData(), destination, destinationData, copy, begin, end);
+        });
+    }
+
+    bool isTiledCopyVectorized() {
+#if defined(RHI_TILED_SSE2)
+        return true;
+#else
+        return false;
+#endif
+    }
+};
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "format_traits.hpp"
+#include "task_pool.hpp"
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Tiled Texture Storage
+    // ===========================================================================================================================
+
+    // Host texture storage cut into 4 KiB tiles with the texels of each tile in Morton order, so
+    // texels close in 2D are close in memory. Every slice of every mip is a row major grid of
+    // tiles, slices being the array layers, or the depth slices of a 3D texture. Compressed
+    // formats store one block where other formats store one texel.
+    //
+    // Tiles hold 4096 bytes of blocks: 64x64 one byte blocks, 64x32 two byte ones, down to
+    // 16x16 sixteen byte ones. Any 4x4 block aligned square is contiguous, the copy kernels
+    // move one such square per step.
+    class TiledTexture {
+    public:
+        TiledTexture(const TextureDescriptor& descriptor);
+
+        // Blocks across and down a mip, depth is its slice count
+        Extent3D getMipBlocks(Uint32 mipLevel) const;
+
+        TextureFormat getFormat() const { return this->format; }
+        TextureDimension getDimension() const { return this->dimension; }
+        Uint32 getMipCount() const { return static_cast<Uint32>(this->mips.size()); }
+        Uint32 getBlockBytes() const { return this->blockBytes; }
+        Uint32 getBlockWidth() const { return this->blockWidth; }
+        Uint32 getBlockHeight() const { return this->blockHeight; }
+        Uint32 getTileWidth() const { return 1u << this->tileWidthLog2; }
+        Uint32 getTileHeight() const { return 1u << this->tileHeightLog2; }
+        Uint64 getSize() const { return this->size; }
+
+        // Byte offset of block (x, y) of a slice of a mip
+        Uint64 getBlockOffset(Uint32 mipLevel, Uint32 x, Uint32 y, Uint32 slice) const {
+            const MipLayout& mip = this->mips[mipLevel];
+
+            Uint64 tile = (static_cast<Uint64>(slice) * mip.tilesHigh + (y >> this->tileHeightLog2)) * mip.tilesWide
+                + (x >> this->tileWidthLog2);
+            Uint32 texel = this->mortonX[x & (this->getTileWidth() - 1)] | this->mortonY[y & (this->getTileHeight() - 1)];
+
+            return mip.offset + tile * this->tileBytes + static_cast<Uint64>(texel) * this->blockBytes;
+        }
+
+        // Storage is allocated, zeroed, by the first write. Null until then, reading it gives zeros.
+        const uint8_t* getData() const { return this->storage.empty() ? nullptr : this->storage.data(); }
+        uint8_t* acquireData();
+
+    private:
+        struct MipLayout {
+            Uint64 offset;
+            Uint32 blocksWide;
+            Uint32 blocksHigh;
+            Uint32 sliceCount;
+            Uint32 tilesWide;
+            Uint32 tilesHigh;
+        };
+
+        std::vector<MipLayout> mips;
+        std::vector<uint8_t> storage;
+        Uint64 size = 0;
+
+        TextureFormat format;
+        TextureDimension dimension;
+
+        Uint32 blockBytes;
+        Uint32 blockWidth;
+        Uint32 blockHeight;
+
+        Uint32 tileWidthLog2;
+        Uint32 tileHeightLog2;
+        Uint64 tileBytes;
+
+        // Position in the tile is mortonX[x] | mortonY[y], x and y taken within the tile
+        uint16_t mortonX[64];
+        uint16_t mortonY[64];
+    };
+
+    // ===========================================================================================================================
+    // Tiled Copies
+    // ===========================================================================================================================
+
+    // Boxes are in texels and block aligned, as for copyBufferToTexture. origin.z and extent.depth
+    // select slices. The linear side follows the layout, its rowsPerImage counted in block rows,
+    // zero meaning the box's own height. Boxes are clipped to the mip.
+    void copyLinearToTiled(TiledTexture& destination, Uint32 mipLevel, Origin3D origin, Extent3D extent,
+        const void* source, ImageDataLayout layout);
+    void copyTiledToLinear(const TiledTexture& source, Uint32 mipLevel, Origin3D origin, Extent3D extent,
+        void* destination, ImageDataLayout layout);
+
+    // Both textures must have the same block size, the copy does nothing otherwise
+    void copyTiledToTiled(const TiledTexture& source, Uint32 sourceMip, Origin3D sourceOrigin,
+        TiledTexture& destination, Uint32 destinationMip, Origin3D destinationOrigin, Extent3D extent);
+
+    // Split into jobs of whole tile rows on the pool, each job moving at least jobBytes
+    void copyLinearToTiled(TaskPool& pool, TiledTexture& destination, Uint32 mipLevel, Origin3D origin, Extent3D extent,
+        const void* source, ImageDataLayout layout, Uint64 jobBytes = 256ull << 10);
+    void copyTiledToLinear(TaskPool& pool, const TiledTexture& source, Uint32 mipLevel, Origin3D origin, Extent3D extent,
+        void* destination, ImageDataLayout layout, Uint64 jobBytes = 256ull << 10);
+    void copyTiledToTiled(TaskPool& pool, const TiledTexture& source, Uint32 sourceMip, Origin3D sourceOrigin,
+        TiledTexture& destination, Uint32 destinationMip, Origin3D destinationOrigin, Extent3D extent,
+        Uint64 jobBytes = 256ull << 10);
+
+    // True when the 1, 2 and 4 byte block kernels use SSE2
+    bool isTiledCopyVectorized();
+};
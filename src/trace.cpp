@@ -0,0 +1,191 @@
+#include "trace.hpp"
+
+#include "hash.hpp"
+
+namespace Rhi {
+    namespace {
+        struct TraceHeader {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t abiHash;
+        };
+
+        struct TraceRecordHeader {
+            uint16_t op;
+            uint16_t reserved;
+            uint32_t size;
+        };
+
+        // Second seed for blob keys, any odd constant different from kHashSeed works
+        constexpr Uint64 kBlobHashSeed = 0x9E3779B97F4A7C15ull;
+    };
+
+    Uint64 getTraceAbiHash() {
+        const Uint64 sizes[] = {
+            sizeof(BufferDescriptor), sizeof(TextureDescriptor), sizeof(TextureViewDescriptor), sizeof(SamplerDescriptor),
+            sizeof(BindGroupLayoutEntry), sizeof(PushConstantRange), sizeof(ImageDataLayout), sizeof(Origin3D),
+            sizeof(Extent3D), sizeof(Color), sizeof(VertexAttribute), sizeof(ColorTargetState), sizeof(PrimitiveState),
+            sizeof(RasterizationState), sizeof(DepthStencilState), sizeof(MultisampleState), sizeof(TextureSubresource),
+            sizeof(RenderPassColorAttachment), sizeof(RenderPassDepthStencilAttachment)
+        };
+
+        return hashBytes(sizes, sizeof(sizes));
+    }
+
+    // ===========================================================================================================================
+    // Trace Writer
+    // ===========================================================================================================================
+
+    TraceWriter::~TraceWriter() {
+        this->close();
+    }
+
+    bool TraceWriter::open(const std::string& path, std::string& error) {
+        this->close();
+
+        this->file = std::fopen(path.c_str(), "wb");
+        if (this->file == nullptr) {
+            error = "Failed to create " + path;
+            return false;
+        }
+
+        TraceHeader header{ kTraceMagic, kTraceVersion, getTraceAbiHash() };
+        std::fwrite(&header, sizeof(header), 1, this->file);
+
+        return true;
+    }
+
+    void TraceWriter::close() {
+        std::lock_guard<std::mutex> lock{ this->mutex };
+
+        if (this->file != nullptr) {
+            std::fclose(this->file);
+            this->file = nullptr;
+        }
+
+        this->blobs.clear();
+        this->nextBlobId = 1;
+    }
+
+    uint32_t TraceWriter::writeBlob(const void* data, Uint64 size) {
+        BlobKey key{ hashBytes(data, size), hashBytes(data, size, kBlobHashSeed) };
+
+        std::lock_guard<std::mutex> lock{ this->mutex };
+
+        auto found = this->blobs.find(key);
+        if (found != this->blobs.end() && found->second.size == size) {
+            this->blobBytesSaved += size;
+            return found->second.id;
+        }
+
+        uint32_t id = this->nextBlobId++;
+        this->blobs[key] = BlobEntry{ id, size };
+
+        TracePayload payload;
+        payload.write(id);
+        payload.writeBytes(data, size);
+
+        this->writeRecordLocked(TraceOp::eBlob, payload.getData(), payload.getSize());
+        return id;
+    }
+
+    void TraceWriter::writeRecord(TraceOp op, const TracePayload& payload) {
+        std::lock_guard<std::mutex> lock{ this->mutex };
+        this->writeRecordLocked(op, payload.getData(), payload.getSize());
+    }
+
+    void TraceWriter::writeRecordLocked(TraceOp op, const void* data, Uint64 size) {
+        if (this->file == nullptr) {
+            return;
+        }
+
+        TraceRecordHeader header{ static_cast<uint16_t>(op), 0, static_cast<uint32_t>(size) };
+
+        std::fwrite(&header, sizeof(header), 1, this->file);
+        if (size != 0) {
+            std::fwrite(data, 1, size, this->file);
+        }
+    }
+
+    // ===========================================================================================================================
+    // Trace Reader
+    // ===========================================================================================================================
+
+    bool TraceReader::open(const std::string& path, std::string& error) {
+        if (!this->file.open(path)) {
+            error = "Failed to open " + path;
+            return false;
+        }
+
+        TraceHeader header;
+        if (this->file.getSize() < sizeof(header)) {
+            error = path + " is not a trace";
+            return false;
+        }
+
+        std::memcpy(&header, this->file.getData(), sizeof(header));
+
+        if (header.magic != kTraceMagic || header.version != kTraceVersion) {
+            error = path + " is not a trace of this version";
+            return false;
+        }
+
+        // Raw structs in the trace must match this build
+        if (header.abiHash != getTraceAbiHash()) {
+            error = path + " was captured by a build with different RHI struct layouts";
+            return false;
+        }
+
+        this->cursor = sizeof(header);
+        this->blobs.clear();
+
+        // Records are read front to back
+        this->file.prefetch(0, this->file.getSize());
+        return true;
+    }
+
+    bool TraceReader::next(TraceRecord& record, std::string& error) {
+        const uint8_t* data = this->file.getData();
+        Uint64 size = this->file.getSize();
+
+        while (this->cursor + sizeof(TraceRecordHeader) <= size) {
+            TraceRecordHeader header;
+            std::memcpy(&header, data + this->cursor, sizeof(header));
+
+            Uint64 payloadOffset = this->cursor + sizeof(header);
+            if (payloadOffset + header.size > size) {
+                error = "Trace is truncated";
+                return false;
+            }
+
+            this->cursor = payloadOffset + header.size;
+
+            if (static_cast<TraceOp>(header.op) == TraceOp::eBlob) {
+                uint32_t id;
+                std::memcpy(&id, data + payloadOffset, sizeof(id));
+
+                if (this->blobs.size() <= id) {
+                    this->blobs.resize(id + 1, BlobView{ nullptr, 0 });
+                }
+
+                this->blobs[id] = BlobView{ data + payloadOffset + sizeof(id), header.size - sizeof(id) };
+                continue;
+            }
+
+            record = TraceRecord{ static_cast<TraceOp>(header.op), data + payloadOffset, header.size };
+            return true;
+        }
+
+        return false;
+    }
+
+    const uint8_t* TraceReader::getBlob(uint32_t id, Uint64& size) const {
+        if (id >= this->blobs.size()) {
+            size = 0;
+            return nullptr;
+        }
+
+        size = this->blobs[id].size;
+        return this->blobs[id].data;
+    }
+};
@@ -0,0 +1,258 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "mapped_file.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Trace Format
+    // ===========================================================================================================================
+
+    // A trace is a header followed by records of { uint16 op, uint16 reserved, uint32 size, payload }.
+    // Objects are referenced by ids assigned at creation, 0 stands for nullptr. Data uploads and
+    // shader code are stored once as blob records and referenced by blob id afterwards.
+
+    constexpr uint32_t kTraceMagic = 0x52544852;    // "RHTR"
+    constexpr uint32_t kTraceVersion = 5;
+
+    enum class TraceOp : uint16_t {
+        eBlob,
+        eFrameEnd,
+        eDestroy,
+
+        eCreateBuffer,
+        eCreateTexture,
+        eCreateTextureView,
+        eCreateSampler,
+        eCreateBindGroupLayout,
+        eCreatePipelineLayout,
+        eCreateBindGroup,
+        eUpdateBindGroup,
+        eCreateShaderModule,
+        eCreateComputePipeline,
+        eCreateRenderPipeline,
+        eCreateCommandEncoder,
+
+        eBufferData,
+
+        eBeginRenderPass,
+        eBeginComputePass,
+        eEndPass,
+        eSetPipeline,
+        eSetBindGroup,
+        eSetPushConstants,
+        eSetVertexBuffer,
+        eSetIndexBuffer,
+        eSetViewport,
+        eSetScissorRect,
+        eSetBlendConstant,
+        eSetStencilReference,
+        eBeginOcclusionQuery,
+        eEndOcclusionQuery,
+        eDraw,
+        eDrawIndexed,
+        eDrawIndirect,
+        eDrawIndexedIndirect,
+        eDispatch,
+        eDispatchIndirect,
+
+        eCopyBufferToBuffer,
+        eCopyBufferToTexture,
+        eCopyTextureToBuffer,
+        eCopyTextureToTexture,
+        eClearBuffer,
+        ePipelineBarrier,
+        eBufferBarrier,
+        eImageBarrier,
+        eBarriers,
+        eFinish,
+        eResetCommandEncoder,
+
+        eSubmit,
+        eWriteBuffer,
+        eWriteTexture,
+        eWaitIdle
+    };
+
+    // Changes whenever a struct the trace stores as raw bytes changes size
+    Uint64 getTraceAbiHash();
+
+    // ===========================================================================================================================
+    // Trace Payload
+    // ===========================================================================================================================
+
+    class TracePayload {
+    public:
+        template <typename T>
+        void write(const T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "Trace payloads only hold trivially copyable values");
+            this->writeBytes(&value, sizeof(T));
+        }
+
+        void writeBytes(const void* data, Uint64 size) {
+            if (size == 0) {
+                return;
+            }
+
+            const uint8_t* bytes = static_cast<const uint8_t*>(data);
+            this->bytes.insert(this->bytes.end(), bytes, bytes + size);
+        }
+
+        void writeString(const char* value) {
+            uint32_t length = value != nullptr ? static_cast<uint32_t>(std::strlen(value)) : UINT32_MAX;
+
+            this->write(length);
+            if (value != nullptr) {
+                this->writeBytes(value, length);
+            }
+        }
+
+        void clear() { this->bytes.clear(); }
+
+        const uint8_t* getData() const { return this->bytes.data(); }
+        Uint64 getSize() const { return this->bytes.size(); }
+
+    private:
+        std::vector<uint8_t> bytes;
+    };
+
+    // Bounds checked cursor over a record payload. Reading past the end yields zeros and
+    // clears isValid, so a truncated record is reported once instead of crashing.
+    class TracePayloadReader {
+    public:
+        TracePayloadReader(const uint8_t* data, Uint64 size) : cursor{ data }, end{ data + size } {}
+
+        template <typename T>
+        T read() {
+            static_assert(std::is_trivially_copyable<T>::value, "Trace payloads only hold trivially copyable values");
+
+            T value{};
+            this->readBytes(&value, sizeof(T));
+
+            return value;
+        }
+
+        void readBytes(void* data, Uint64 size) {
+            if (size == 0) {
+                return;
+            }
+
+            if (static_cast<Uint64>(this->end - this->cursor) < size) {
+                std::memset(data, 0, size);
+                this->valid = false;
+                return;
+            }
+
+            std::memcpy(data, this->cursor, size);
+            this->cursor += size;
+        }
+
+        // The string stays owned by the trace, nullptr when the writer stored nullptr
+        const char* readString(std::string& storage) {
+            uint32_t length = this->read<uint32_t>();
+            if (length == UINT32_MAX) {
+                return nullptr;
+            }
+
+            storage.resize(length);
+            this->readBytes(&storage[0], length);
+
+            return storage.c_str();
+        }
+
+        bool isValid() const { return this->valid; }
+
+    private:
+        const uint8_t* cursor;
+        const uint8_t* end;
+        bool valid = true;
+    };
+
+    // ===========================================================================================================================
+    // Trace Writer
+    // ===========================================================================================================================
+
+    class TraceWriter {
+    public:
+        TraceWriter() = default;
+        ~TraceWriter();
+
+        TraceWriter(const TraceWriter&) = delete;
+        TraceWriter& operator=(const TraceWriter&) = delete;
+
+        bool open(const std::string& path, std::string& error);
+        void close();
+
+        // Returns the id of a blob with this content, writing the blob record on first use
+        uint32_t writeBlob(const void* data, Uint64 size);
+
+        void writeRecord(TraceOp op, const TracePayload& payload);
+
+        bool isOpen() const { return this->file != nullptr; }
+        Uint64 getBlobBytesSaved() const { return this->blobBytesSaved; }
+
+    private:
+        void writeRecordLocked(TraceOp op, const void* data, Uint64 size);
+
+        std::FILE* file = nullptr;
+        std::mutex mutex;
+
+        // Keyed by two independent content hashes, the size is checked on lookup
+        struct BlobKey {
+            Uint64 hash0;
+            Uint64 hash1;
+
+            bool operator==(const BlobKey& other) const { return this->hash0 == other.hash0 && this->hash1 == other.hash1; }
+        };
+
+        struct BlobKeyHash {
+            size_t operator()(const BlobKey& key) const { return static_cast<size_t>(key.hash0); }
+        };
+
+        struct BlobEntry {
+            uint32_t id;
+            Uint64 size;
+        };
+
+        std::unordered_map<BlobKey, BlobEntry, BlobKeyHash> blobs;
+        uint32_t nextBlobId = 1;
+        Uint64 blobBytesSaved = 0;
+    };
+
+    // ===========================================================================================================================
+    // Trace Reader
+    // ===========================================================================================================================
+
+    struct TraceRecord {
+        TraceOp op;
+        const uint8_t* data;
+        Uint64 size;
+    };
+
+    class TraceReader {
+    public:
+        bool open(const std::string& path, std::string& error);
+
+        // Blob records are consumed here and never returned
+        bool next(TraceRecord& record, std::string& error);
+
+        // Blob data stays valid while the reader is open, nullptr for an unknown id
+        const uint8_t* getBlob(uint32_t id, Uint64& size) const;
+
+    private:
+        struct BlobView {
+            const uint8_t* data;
+            Uint64 size;
+        };
+
+        MappedFile file;
+        Uint64 cursor = 0;
+        std::vector<BlobView> blobs;
+    };
+};
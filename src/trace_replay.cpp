@@ -0,0 +1,805 @@
+#include "trace_replay.hpp"
+
+namespace Rhi {
+    namespace {
+        double getMilliseconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+            return std::chrono::duration<double, std::milli>(end - start).count();
+        }
+    };
+
+    void TraceReplayer::reset() {
+        this->encoders.clear();
+        this->objects.clear();
+        this->strings.clear();
+        this->specializationBlocks.clear();
+    }
+
+    bool TraceReplayer::replay(TraceReader& reader, std::vector<TraceFrameTiming>& frames, std::string& error) {
+        frames.clear();
+
+        TraceFrameTiming frame;
+        Clock::time_point frameStart = Clock::now();
+
+        TraceRecord record;
+        while (reader.next(record, error)) {
+            if (record.op == TraceOp::eFrameEnd) {
+                Clock::time_point now = Clock::now();
+
+                frame.milliseconds = getMilliseconds(frameStart, now);
+                frames.emplace_back(std::move(frame));
+
+                frame = TraceFrameTiming{};
+                frameStart = now;
+
+                continue;
+            }
+
+            if (!this->execute(record, reader, frame, error)) {
+                return false;
+            }
+        }
+
+        if (!error.empty()) {
+            return false;
+        }
+
+        if (frame.commandCount != 0 || frame.uploadBytes != 0) {
+            frame.milliseconds = getMilliseconds(frameStart, Clock::now());
+            frames.emplace_back(std::move(frame));
+        }
+
+        return true;
+    }
+
+    void TraceReplayer::readStage(TracePayloadReader& payload, ProgrammableStage& stage) {
+        stage.module = this->get<ShaderModule>(payload.read<uint32_t>());
+
+        std::string entryPoint;
+        if (payload.readString(entryPoint) != nullptr) {
+            this->strings.emplace_back(std::move(entryPoint));
+            stage.entryPoint = this->strings.back().c_str();
+        } else {
+            stage.entryPoint = nullptr;
+        }
+
+        uint32_t constantCount = payload.read<uint32_t>();
+        if (constantCount == UINT32_MAX) {
+            stage.constants = nullptr;
+            return;
+        }
+
+        SpecializationBlock block;
+        for (uint32_t i = 0; i < constantCount && payload.isValid(); i++) {
+            block.constants.emplace_back(payload.read<SpecializationConstant>());
+        }
+
+        block.hash = payload.read<Uint64>();
+
+        this->specializationBlocks.emplace_back(std::move(block));
+        stage.constants = &this->specializationBlocks.back();
+    }
+
+    void TraceReplayer::readImageCopyTexture(TracePayloadReader& payload, ImageCopyTexture& copy) {
+        copy.texture = this->get<Texture>(payload.read<uint32_t>());
+        copy.mipLevel = payload.read<Uint32>();
+        copy.origin = payload.read<Origin3D>();
+        copy.aspect = payload.read<TextureAspect>();
+    }
+
+    void TraceReplayer::readImageCopyBuffer(TracePayloadReader& payload, ImageCopyBuffer& copy) {
+        copy.buffer = this->get<Buffer>(payload.read<uint32_t>());
+        static_cast<ImageDataLayout&>(copy) = payload.read<ImageDataLayout>();
+    }
+
+    void TraceReplayer::readBufferBarrier(TracePayloadReader& payload, BufferBarrier& barrier) {
+        barrier.srcAccess = payload.read<ResourceAccess>();
+        barrier.dstAccess = payload.read<ResourceAccess>();
+        barrier.split = payload.read<BarrierSplit>();
+        barrier.buffer = this->get<Buffer>(payload.read<uint32_t>());
+        barrier.size = payload.read<uint64_t>();
+        barrier.offset = payload.read<uint64_t>();
+    }
+
+    void TraceReplayer::readImageBarrier(TracePayloadReader& payload, ImageBarrier& barrier) {
+        barrier.srcAccess = payload.read<ResourceAccess>();
+        barrier.dstAccess = payload.read<ResourceAccess>();
+        barrier.split = payload.read<BarrierSplit>();
+        barrier.texture = this->get<Texture>(payload.read<uint32_t>());
+        barrier.subresource = payload.read<TextureSubresource>();
+        barrier.srcState = payload.read<TextureState>();
+        barrier.dstState = payload.read<TextureState>();
+    }
+
+    void TraceReplayer::readBindGroupEntries(TracePayloadReader& payload, std::vector<BindGroupEntry>& entries) {
+        uint32_t count = payload.read<uint32_t>();
+
+        for (uint32_t i = 0; i < count && payload.isValid(); i++) {
+            BindGroupEntry entry;
+            entry.binding = payload.read<Uint32>();
+            entry.arrayElement = payload.read<Uint32>();
+            entry.buffer.buffer = this->get<Buffer>(payload.read<uint32_t>());
+            entry.buffer.size = payload.read<Uint64>();
+            entry.buffer.offset = payload.read<Uint64>();
+            entry.textureView = this->get<TextureView>(payload.read<uint32_t>());
+            entry.sampler = this->get<Sampler>(payload.read<uint32_t>());
+
+            entries.emplace_back(entry);
+        }
+    }
+
+    void TraceReplayer::storeDerivedLayouts(TracePayloadReader& payload, const std::shared_ptr<PipelineBase>& pipeline) {
+        uint32_t layoutId = payload.read<uint32_t>();
+        uint32_t bindGroupLayoutCount = payload.read<uint32_t>();
+
+        // Aliases keep the pipeline alive for as long as its layouts are referenced
+        if (layoutId != 0 && pipeline->layout != nullptr) {
+            this->objects.emplace(layoutId, std::shared_ptr<void>(pipeline, pipeline->layout));
+        }
+
+        for (uint32_t i = 0; i < bindGroupLayoutCount && payload.isValid(); i++) {
+            uint32_t id = payload.read<uint32_t>();
+            BindGroupLayout* bindGroupLayout = pipeline->getBindGroupLayout(i);
+
+            if (id != 0 && bindGroupLayout != nullptr) {
+                this->objects.emplace(id, std::shared_ptr<void>(pipeline, bindGroupLayout));
+            }
+        }
+    }
+
+    bool TraceReplayer::execute(const TraceRecord& record, TraceReader& reader, TraceFrameTiming& frame, std::string& error) {
+        TracePayloadReader payload{ record.data, record.size };
+
+        auto getBlob = [&reader, &error](uint32_t id, Uint64& size) {
+            const uint8_t* data = reader.getBlob(id, size);
+            if (data == nullptr) {
+                error = "Trace references unknown blob " + std::to_string(id);
+            }
+
+            return data;
+        };
+
+        switch (record.op) {
+            case TraceOp::eDestroy: {
+                uint32_t id = payload.read<uint32_t>();
+
+                this->objects.erase(id);
+                this->encoders.erase(id);
+                break;
+            }
+
+            case TraceOp::eCreateBuffer: {
+                uint32_t id = payload.read<uint32_t>();
+                this->objects[id] = this->device->createBuffer(payload.read<BufferDescriptor>());
+                break;
+            }
+
+            case TraceOp::eCreateTexture: {
+                uint32_t id = payload.read<uint32_t>();
+                this->objects[id] = this->device->createTexture(payload.read<TextureDescriptor>());
+                break;
+            }
+
+            case TraceOp::eCreateTextureView: {
+                uint32_t id = payload.read<uint32_t>();
+                Texture* texture = this->get<Texture>(payload.read<uint32_t>());
+
+                if (texture == nullptr) {
+                    error = "Texture view of an unknown texture";
+                    return false;
+                }
+
+                this->objects[id] = texture->createView(payload.read<TextureViewDescriptor>());
+                break;
+            }
+
+            case TraceOp::eCreateSampler: {
+                uint32_t id = payload.read<uint32_t>();
+                this->objects[id] = this->device->createSampler(payload.read<SamplerDescriptor>());
+                break;
+            }
+
+            case TraceOp::eCreateBindGroupLayout: {
+                uint32_t id = payload.read<uint32_t>();
+                uint32_t count = payload.read<uint32_t>();
+
+                BindGroupLayoutDescriptor descriptor;
+                for (uint32_t i = 0; i < count && payload.isValid(); i++) {
+                    descriptor.entries.emplace_back(payload.read<BindGroupLayoutEntry>());
+                }
+
+                this->objects[id] = this->device->createBindGroupLayout(descriptor);
+                break;
+            }
+
+            case TraceOp::eCreatePipelineLayout: {
+                uint32_t id = payload.read<uint32_t>();
+
+                PipelineLayoutDescriptor descriptor;
+
+                uint32_t bindGroupLayoutCount = payload.read<uint32_t>();
+                for (uint32_t i = 0; i < bindGroupLayoutCount && payload.isValid(); i++) {
+                    descriptor.bindGroupLayouts.emplace_back(this->get<BindGroupLayout>(payload.read<uint32_t>()));
+                }
+
+                uint32_t rangeCount = payload.read<uint32_t>();
+                for (uint32_t i = 0; i < rangeCount && payload.isValid(); i++) {
+                    descriptor.pushConstantRanges.emplace_back(payload.read<PushConstantRange>());
+                }
+
+                this->objects[id] = this->device->createPipelineLayout(descriptor);
+                break;
+            }
+
+            case TraceOp::eCreateBindGroup: {
+                uint32_t id = payload.read<uint32_t>();
+
+                BindGroupDescriptor descriptor;
+                descriptor.layout = this->get<BindGroupLayout>(payload.read<uint32_t>());
+                this->readBindGroupEntries(payload, descriptor.entries);
+
+                this->objects[id] = this->device->createBindGroup(descriptor);
+                break;
+            }
+
+            case TraceOp::eUpdateBindGroup: {
+                BindGroup* bindGroup = this->get<BindGroup>(payload.read<uint32_t>());
+
+                std::vector<BindGroupEntry> entries;
+                this->readBindGroupEntries(payload, entries);
+
+                if (bindGroup == nullptr) {
+                    error = "Update of an unknown bind group";
+                    return false;
+                }
+
+                this->device->updateBindGroup(bindGroup, entries);
+                break;
+            }
+
+            case TraceOp::eCreateShaderModule: {
+                uint32_t id = payload.read<uint32_t>();
+
+                Uint64 size;
+                const uint8_t* code = getBlob(payload.read<uint32_t>(), size);
+                if (code == nullptr) {
+                    return false;
+                }
+
+                ShaderModuleDescriptor descriptor;
+                descriptor.code = reinterpret_cast<const char*>(code);
+                descriptor.codeSize = payload.read<Uint64>();
+
+                this->objects[id] = this->device->createShaderModule(descriptor);
+                break;
+            }
+
+            case TraceOp::eCreateComputePipeline: {
+                uint32_t id = payload.read<uint32_t>();
+
+                ComputePipelineDescriptor descriptor;
+                descriptor.layout = this->get<PipelineLayout>(payload.read<uint32_t>());
+                this->readStage(payload, descriptor.compute);
+
+                auto pipeline = this->device->createComputePipeline(descriptor);
+                if (pipeline == nullptr) {
+                    error = "Failed to recreate compute pipeline " + std::to_string(id);
+                    return false;
+                }
+
+                this->objects[id] = pipeline;
+                this->storeDerivedLayouts(payload, pipeline);
+                break;
+            }
+
+            case TraceOp::eCreateRenderPipeline: {
+                uint32_t id = payload.read<uint32_t>();
+
+                RenderPipelineDescriptor descriptor;
+                descriptor.layout = this->get<PipelineLayout>(payload.read<uint32_t>());
+                this->readStage(payload, descriptor.vertex);
+
+                uint32_t bufferCount = payload.read<uint32_t>();
+                for (uint32_t i = 0; i < bufferCount && payload.isValid(); i++) {
+                    VertexBufferLayout buffer;
+                    buffer.arrayStride = payload.read<Uint64>();
+                    buffer.stepMode = payload.read<VertexStepMode>();
+
+                    uint32_t attributeCount = payload.read<uint32_t>();
+                    for (uint32_t j = 0; j < attributeCount && payload.isValid(); j++) {
+                        buffer.attributes.emplace_back(payload.read<VertexAttribute>());
+                    }
+
+                    descriptor.vertex.buffers.emplace_back(std::move(buffer));
+                }
+
+                this->readStage(payload, descriptor.fragment);
+
+                uint32_t targetCount = payload.read<uint32_t>();
+                for (uint32_t i = 0; i < targetCount && payload.isValid(); i++) {
+                    descriptor.fragment.targets.emplace_back(payload.read<ColorTargetState>());
+                }
+
+                descriptor.depthStencil = payload.read<DepthStencilState>();
+                descriptor.primitive = payload.read<PrimitiveState>();
+                descriptor.rasterizationState = payload.read<RasterizationState>();
+                descriptor.multisample = payload.read<MultisampleState>();
+
+                auto pipeline = this->device->createRenderPipeline(descriptor);
+                if (pipeline == nullptr) {
+                    error = "Failed to recreate render pipeline " + std::to_string(id);
+                    return false;
+                }
+
+                this->objects[id] = pipeline;
+                this->storeDerivedLayouts(payload, pipeline);
+                break;
+            }
+
+            case TraceOp::eCreateCommandEncoder: {
+                uint32_t id = payload.read<uint32_t>();
+                this->encoders[id].encoder = this->device->createCommandEncoder();
+                break;
+            }
+
+            case TraceOp::eBufferData: {
+                Buffer* buffer = this->get<Buffer>(payload.read<uint32_t>());
+                Uint64 offset = payload.read<Uint64>();
+
+                Uint64 size;
+                const uint8_t* data = getBlob(payload.read<uint32_t>(), size);
+                if (data == nullptr) {
+                    return false;
+                }
+
+                if (buffer == nullptr) {
+                    error = "Buffer data for an unknown buffer";
+                    return false;
+                }
+
+                std::memcpy(buffer->map(size, offset), data, size);
+                buffer->unmap();
+
+                frame.uploadBytes += size;
+                break;
+            }
+
+            case TraceOp::eSubmit: {
+                uint32_t count = payload.read<uint32_t>();
+
+                std::vector<CommandEncoder*> submitted;
+                for (uint32_t i = 0; i < count && payload.isValid(); i++) {
+                    auto found = this->encoders.find(payload.read<uint32_t>());
+                    if (found == this->encoders.end()) {
+                        error = "Submit of an unknown command encoder";
+                        return false;
+                    }
+
+                    submitted.emplace_back(found->second.encoder.get());
+                }
+
+                Clock::time_point start = Clock::now();
+                this->device->getQueue()->submit(submitted);
+                frame.submitMilliseconds += getMilliseconds(start, Clock::now());
+                break;
+            }
+
+            case TraceOp::eWriteBuffer: {
+                Buffer* buffer = this->get<Buffer>(payload.read<uint32_t>());
+                Uint64 offset = payload.read<Uint64>();
+
+                Uint64 size;
+                const uint8_t* data = getBlob(payload.read<uint32_t>(), size);
+                if (data == nullptr) {
+                    return false;
+                }
+
+                this->device->getQueue()->writeBuffer(buffer, offset, data, size);
+                frame.uploadBytes += size;
+                break;
+            }
+
+            case TraceOp::eWriteTexture: {
+                ImageCopyTexture destination;
+                this->readImageCopyTexture(payload, destination);
+
+                Uint64 size;
+                const uint8_t* data = getBlob(payload.read<uint32_t>(), size);
+                if (data == nullptr) {
+                    return false;
+                }
+
+                ImageDataLayout dataLayout = payload.read<ImageDataLayout>();
+                Extent3D extent = payload.read<Extent3D>();
+
+                this->device->getQueue()->writeTexture(destination, data, size, dataLayout, extent);
+                frame.uploadBytes += size;
+                break;
+            }
+
+            case TraceOp::eWaitIdle: {
+                Clock::time_point start = Clock::now();
+                this->device->getQueue()->waitIdle();
+                frame.submitMilliseconds += getMilliseconds(start, Clock::now());
+                break;
+            }
+
+            default: {
+                if (!this->executeCommand(record.op, payload, frame, error)) {
+                    return false;
+                }
+
+                break;
+            }
+        }
+
+        if (!payload.isValid()) {
+            error = "Trace record " + std::to_string(static_cast<uint32_t>(record.op)) + " is truncated";
+            return false;
+        }
+
+        return true;
+    }
+
+    bool TraceReplayer::executeCommand(TraceOp op, TracePayloadReader& payload, TraceFrameTiming& frame, std::string& error) {
+        auto found = this->encoders.find(payload.read<uint32_t>());
+        if (found == this->encoders.end()) {
+            error = "Command for an unknown command encoder";
+            return false;
+        }
+
+        EncoderState& state = found->second;
+        CommandEncoder* encoder = state.encoder.get();
+
+        RenderPassEncoder* renderPass = state.renderPass.get();
+        ComputePassEncoder* computePass = state.computePass.get();
+
+        // Everything from vertex buffers to indirect draws only exists inside a render pass
+        if (op >= TraceOp::eSetVertexBuffer && op <= TraceOp::eDrawIndexedIndirect && renderPass == nullptr) {
+            error = "Render command outside of a render pass";
+            return false;
+        }
+
+        frame.commandCount++;
+        state.passCommandCount++;
+
+        switch (op) {
+            case TraceOp::eBeginRenderPass: {
+                RenderPassDescriptor descriptor;
+
+                uint32_t colorCount = payload.read<uint32_t>();
+                for (uint32_t i = 0; i < colorCount && payload.isValid(); i++) {
+                    TextureView* view = this->get<TextureView>(payload.read<uint32_t>());
+                    TextureView* resolveTarget = this->get<TextureView>(payload.read<uint32_t>());
+
+                    RenderPassColorAttachment attachment = payload.read<RenderPassColorAttachment>();
+                    attachment.view = view;
+                    attachment.resolveTarget = resolveTarget;
+
+                    descriptor.colorAttachments.emplace_back(attachment);
+                }
+
+                TextureView* depthView = this->get<TextureView>(payload.read<uint32_t>());
+
+                descriptor.depthStencilAttachment = payload.read<RenderPassDepthStencilAttachment>();
+                descriptor.depthStencilAttachment.view = depthView;
+                descriptor.occlusionQuerySet = nullptr;
+                descriptor.timestampWrites = RenderPassTimestampWrites{ nullptr, 0, 0 };
+                descriptor.maxDrawCount = payload.read<Uint64>();
+
+                state.renderPass = encoder->beginRenderPass(descriptor);
+                state.passStart = Clock::now();
+                state.passCommandCount = 0;
+                break;
+            }
+
+            case TraceOp::eBeginComputePass: {
+                ComputePassDescriptor descriptor;
+                descriptor.timestampWrites = ComputePassTimestampWrites{ nullptr, 0, 0 };
+
+                state.computePass = encoder->beginComputePass(descriptor);
+                state.passStart = Clock::now();
+                state.passCommandCount = 0;
+                break;
+            }
+
+            case TraceOp::eEndPass: {
+                if (renderPass != nullptr) {
+                    renderPass->end();
+                } else if (computePass != nullptr) {
+                    computePass->end();
+                } else {
+                    error = "End of a pass that was never begun";
+                    return false;
+                }
+
+                frame.passes.emplace_back(TracePassTiming{ computePass != nullptr,
+                    getMilliseconds(state.passStart, Clock::now()), state.passCommandCount - 1 });
+
+                state.renderPass = nullptr;
+                state.computePass = nullptr;
+                break;
+            }
+
+            case TraceOp::eSetPipeline: {
+                uint32_t id = payload.read<uint32_t>();
+
+                if (renderPass != nullptr) {
+                    renderPass->setPipeline(this->get<RenderPipeline>(id));
+                } else if (computePass != nullptr) {
+                    computePass->setPipeline(this->get<ComputePipeline>(id));
+                }
+
+                break;
+            }
+
+            case TraceOp::eSetBindGroup: {
+                Uint32 index = payload.read<Uint32>();
+                BindGroup* bindGroup = this->get<BindGroup>(payload.read<uint32_t>());
+
+                std::vector<Uint32> dynamicOffsets(payload.read<Uint32>());
+                payload.readBytes(dynamicOffsets.data(), dynamicOffsets.size() * sizeof(Uint32));
+
+                if (renderPass != nullptr) {
+                    renderPass->setBindGroup(index, bindGroup, dynamicOffsets);
+                } else if (computePass != nullptr) {
+                    computePass->setBindGroup(index, bindGroup, dynamicOffsets);
+                }
+
+                break;
+            }
+
+            case TraceOp::eSetPushConstants: {
+                ShaderStageFlags visibility = payload.read<uint32_t>();
+                Uint32 offset = payload.read<uint32_t>();
+
+                std::vector<uint8_t> data(payload.read<uint32_t>());
+                payload.readBytes(data.data(), data.size());
+
+                if (renderPass != nullptr) {
+                    renderPass->setPushConstants(visibility, offset, static_cast<Uint32>(data.size()), data.data());
+                } else if (computePass != nullptr) {
+                    computePass->setPushConstants(visibility, offset, static_cast<Uint32>(data.size()), data.data());
+                }
+
+                break;
+            }
+
+            case TraceOp::eDispatch: {
+                Uint32 x = payload.read<Uint32>();
+                Uint32 y = payload.read<Uint32>();
+                Uint32 z = payload.read<Uint32>();
+
+                if (computePass != nullptr) {
+                    computePass->dispatchWorkgroups(x, y, z);
+                }
+
+                break;
+            }
+
+            case TraceOp::eDispatchIndirect: {
+                Buffer* buffer = this->get<Buffer>(payload.read<uint32_t>());
+                Uint64 offset = payload.read<Uint64>();
+
+                if (computePass != nullptr) {
+                    computePass->dispatchWorkgroupsIndirect(buffer, offset);
+                }
+
+                break;
+            }
+
+            case TraceOp::eCopyBufferToBuffer: {
+                Buffer* source = this->get<Buffer>(payload.read<uint32_t>());
+                Uint64 sourceOffset = payload.read<Uint64>();
+                Buffer* destination = this->get<Buffer>(payload.read<uint32_t>());
+                Uint64 destinationOffset = payload.read<Uint64>();
+                Uint64 size = payload.read<Uint64>();
+
+                encoder->copyBufferToBuffer(source, sourceOffset, destination, destinationOffset, size);
+                break;
+            }
+
+            case TraceOp::eCopyBufferToTexture: {
+                ImageCopyBuffer source;
+                ImageCopyTexture destination;
+
+                this->readImageCopyBuffer(payload, source);
+                this->readImageCopyTexture(payload, destination);
+
+                encoder->copyBufferToTexture(source, destination, payload.read<Extent3D>());
+                break;
+            }
+
+            case TraceOp::eCopyTextureToBuffer: {
+                ImageCopyTexture source;
+                ImageCopyBuffer destination;
+
+                this->readImageCopyTexture(payload, source);
+                this->readImageCopyBuffer(payload, destination);
+
+                encoder->copyTextureToBuffer(source, destination, payload.read<Extent3D>());
+                break;
+            }
+
+            case TraceOp::eCopyTextureToTexture: {
+                ImageCopyTexture source;
+                ImageCopyTexture destination;
+
+                this->readImageCopyTexture(payload, source);
+                this->readImageCopyTexture(payload, destination);
+
+                encoder->copyTextureToTexture(source, destination, payload.read<Extent3D>());
+                break;
+            }
+
+            case TraceOp::eClearBuffer: {
+                Buffer* buffer = this->get<Buffer>(payload.read<uint32_t>());
+                Uint64 offset = payload.read<Uint64>();
+                Uint64 size = payload.read<Uint64>();
+
+                encoder->clearBuffer(buffer, offset, size);
+                break;
+            }
+
+            case TraceOp::ePipelineBarrier: {
+                ShaderStage srcStage = payload.read<ShaderStage>();
+                ShaderStage dstStage = payload.read<ShaderStage>();
+
+                encoder->activatePipelineBarrier(srcStage, dstStage);
+                break;
+            }
+
+            case TraceOp::eBufferBarrier: {
+                ShaderStage srcStage = payload.read<ShaderStage>();
+                ShaderStage dstStage = payload.read<ShaderStage>();
+
+                BufferBarrier barrier;
+                this->readBufferBarrier(payload, barrier);
+
+                encoder->activateBufferBarrier(srcStage, dstStage, barrier);
+                break;
+            }
+
+            case TraceOp::eImageBarrier: {
+                ShaderStage srcStage = payload.read<ShaderStage>();
+                ShaderStage dstStage = payload.read<ShaderStage>();
+
+                ImageBarrier barrier;
+                this->readImageBarrier(payload, barrier);
+
+                encoder->activateImageBarrier(srcStage, dstStage, barrier);
+                break;
+            }
+
+            case TraceOp::eBarriers: {
+                ShaderStage srcStage = payload.read<ShaderStage>();
+                ShaderStage dstStage = payload.read<ShaderStage>();
+
+                std::vector<BufferBarrier> bufferBarriers;
+                uint32_t bufferBarrierCount = payload.read<uint32_t>();
+
+                for (uint32_t i = 0; i < bufferBarrierCount && payload.isValid(); i++) {
+                    bufferBarriers.emplace_back();
+                    this->readBufferBarrier(payload, bufferBarriers.back());
+                }
+
+                std::vector<ImageBarrier> imageBarriers;
+                uint32_t imageBarrierCount = payload.read<uint32_t>();
+
+                for (uint32_t i = 0; i < imageBarrierCount && payload.isValid(); i++) {
+                    imageBarriers.emplace_back();
+                    this->readImageBarrier(payload, imageBarriers.back());
+                }
+
+                encoder->activateBarriers(srcStage, dstStage, bufferBarriers, imageBarriers);
+                break;
+            }
+
+            case TraceOp::eFinish: {
+                encoder->finish();
+                break;
+            }
+
+            case TraceOp::eResetCommandEncoder: {
+                state.renderPass = nullptr;
+                state.computePass = nullptr;
+
+                encoder->reset();
+                break;
+            }
+
+            case TraceOp::eSetVertexBuffer: {
+                Uint32 slot = payload.read<Uint32>();
+                Buffer* buffer = this->get<Buffer>(payload.read<uint32_t>());
+                Uint64 offset = payload.read<Uint64>();
+                Uint64 size = payload.read<Uint64>();
+
+                renderPass->setVertexBuffer(slot, buffer, offset, size);
+                break;
+            }
+
+            case TraceOp::eSetIndexBuffer: {
+                Buffer* buffer = this->get<Buffer>(payload.read<uint32_t>());
+                IndexFormat format = payload.read<IndexFormat>();
+                Uint64 offset = payload.read<Uint64>();
+                Uint64 size = payload.read<Uint64>();
+
+                renderPass->setIndexBuffer(buffer, format, offset, size);
+                break;
+            }
+
+            case TraceOp::eSetViewport: {
+                Viewport viewport = payload.read<Viewport>();
+                renderPass->setViewport(viewport.x, viewport.y, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth);
+                break;
+            }
+
+            case TraceOp::eSetScissorRect: {
+                Uint32 x = payload.read<Uint32>();
+                Uint32 y = payload.read<Uint32>();
+                Uint32 width = payload.read<Uint32>();
+                Uint32 height = payload.read<Uint32>();
+
+                renderPass->setScissorRect(x, y, width, height);
+                break;
+            }
+
+            case TraceOp::eSetBlendConstant: {
+                renderPass->setBlendConstant(payload.read<Color>());
+                break;
+            }
+
+            case TraceOp::eSetStencilReference: {
+                renderPass->setStencilReference(payload.read<Uint32>());
+                break;
+            }
+
+            case TraceOp::eBeginOcclusionQuery: {
+                renderPass->beginOcclusionQuery(payload.read<Uint32>());
+                break;
+            }
+
+            case TraceOp::eEndOcclusionQuery: {
+                renderPass->endOcclusionQuery();
+                break;
+            }
+
+            case TraceOp::eDraw: {
+                Uint32 vertexCount = payload.read<Uint32>();
+                Uint32 instanceCount = payload.read<Uint32>();
+                Uint32 firstVertex = payload.read<Uint32>();
+                Uint32 firstInstance = payload.read<Uint32>();
+
+                renderPass->draw(vertexCount, instanceCount, firstVertex, firstInstance);
+                break;
+            }
+
+            case TraceOp::eDrawIndexed: {
+                Uint32 indexCount = payload.read<Uint32>();
+                Uint32 instanceCount = payload.read<Uint32>();
+                Uint32 firstIndex = payload.read<Uint32>();
+                Int32 baseVertex = payload.read<Int32>();
+                Uint32 firstInstance = payload.read<Uint32>();
+
+                renderPass->drawIndexed(indexCount, instanceCount, firstIndex, baseVertex, firstInstance);
+                break;
+            }
+
+            case TraceOp::eDrawIndirect: {
+                Buffer* buffer = this->get<Buffer>(payload.read<uint32_t>());
+                renderPass->drawIndirect(buffer, payload.read<Uint64>());
+                break;
+            }
+
+            case TraceOp::eDrawIndexedIndirect: {
+                Buffer* buffer = this->get<Buffer>(payload.read<uint32_t>());
+                renderPass->drawIndexedIndirect(buffer, payload.read<Uint64>());
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        return true;
+    }
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "trace.hpp"
+
+#include <chrono>
+#include <deque>
+#include <unordered_map>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Trace Replay
+    // ===========================================================================================================================
+
+    struct TracePassTiming {
+        bool compute;
+
+        // CPU time from beginning to ending the pass, the cost of encoding it
+        double milliseconds;
+        Uint64 commandCount;
+    };
+
+    struct TraceFrameTiming {
+        std::vector<TracePassTiming> passes;
+
+        double milliseconds = 0;
+        double submitMilliseconds = 0;
+
+        Uint64 commandCount = 0;
+        Uint64 uploadBytes = 0;
+    };
+
+    // Re-issues a trace against a device as fast as the records can be read. The replayed
+    // objects reference shader code and strings inside the trace, keep the reader open
+    // while the replayer is alive.
+    class TraceReplayer {
+    public:
+        TraceReplayer(Device* device) : device{ device } {}
+
+        // Replays the remaining records of the reader, one timing per frame. Commands or uploads
+        // after the last frame end count as a frame of their own.
+        bool replay(TraceReader& reader, std::vector<TraceFrameTiming>& frames, std::string& error);
+
+        // Drops every replayed object, replay starts from an empty object table
+        void reset();
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        struct EncoderState {
+            std::shared_ptr<CommandEncoder> encoder;
+            std::shared_ptr<RenderPassEncoder> renderPass;
+            std::shared_ptr<ComputePassEncoder> computePass;
+
+            Clock::time_point passStart;
+            Uint64 passCommandCount = 0;
+        };
+
+        bool execute(const TraceRecord& record, TraceReader& reader, TraceFrameTiming& frame, std::string& error);
+        bool executeCommand(TraceOp op, TracePayloadReader& payload, TraceFrameTiming& frame, std::string& error);
+
+        void readStage(TracePayloadReader& payload, ProgrammableStage& stage);
+        void readImageCopyTexture(TracePayloadReader& payload, ImageCopyTexture& copy);
+        void readImageCopyBuffer(TracePayloadReader& payload, ImageCopyBuffer& copy);
+        void readBindGroupEntries(TracePayloadReader& payload, std::vector<BindGroupEntry>& entries);
+        void readBufferBarrier(TracePayloadReader& payload, BufferBarrier& barrier);
+        void readImageBarrier(TracePayloadReader& payload, ImageBarrier& barrier);
+        void storeDerivedLayouts(TracePayloadReader& payload, const std::shared_ptr<PipelineBase>& pipeline);
+
+        template <typename T>
+        T* get(uint32_t id) const {
+            auto found = this->objects.find(id);
+            return found != this->objects.end() ? static_cast<T*>(found->second.get()) : nullptr;
+        }
+
+        Device* device;
+
+        std::unordered_map<uint32_t, std::shared_ptr<void>> objects;
+        std::unordered_map<uint32_t, EncoderState> encoders;
+
+        // Storage for the values replayed descriptors point at
+        std::deque<std::string> strings;
+        std::deque<SpecializationBlock> specializationBlocks;
+    };
+};
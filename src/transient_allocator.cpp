@@ -0,0 +1,177 @@
+#include "transient_allocator.hpp"
+
+#include <algorithm>
+
+namespace Rhi {
+    namespace {
+        Uint64 alignUp(Uint64 value, Uint64 alignment) {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    };
+
+    TransientAllocator::TransientAllocator(Device* device, TransientAllocatorDescriptor descriptor) : device{ device }, desc{ descriptor } {
+        this->desc.alignment = std::max<Uint32>(16, this->desc.alignment);
+        this->desc.framesInFlight = std::max<Uint32>(1, this->desc.framesInFlight);
+        this->desc.blockSize = alignUp(std::max<Uint64>(1, this->desc.blockSize), this->desc.alignment);
+        this->desc.pageSize = alignUp(std::max(this->desc.pageSize, this->desc.blockSize), this->desc.alignment);
+
+        if (this->desc.layout == nullptr) {
+            this->desc.bindingSize = 0;
+        }
+
+        this->frames.reset(new Frame[this->desc.framesInFlight]);
+        this->current = &this->frames[0];
+    }
+
+    TransientAllocator::~TransientAllocator() {
+        for (Uint32 i = 0; i < this->desc.framesInFlight; i++) {
+            for (auto& page : this->frames[i].pages) {
+                page->buffer->unmap();
+            }
+        }
+    }
+
+    TransientAllocator::Page* TransientAllocator::createPage(Uint64 size) {
+        BufferDescriptor bufferDesc;
+        bufferDesc.size = size + this->desc.bindingSize;
+        bufferDesc.usage = this->desc.usage;
+        bufferDesc.location = BufferLocation::eHost;
+
+        auto page = std::make_unique<Page>();
+        page->buffer = this->device->createBuffer(bufferDesc);
+
+        if (page->buffer == nullptr) {
+            return nullptr;
+        }
+
+        if (this->desc.layout != nullptr) {
+            BindGroupEntry entry;
+            entry.binding = 0;
+            entry.buffer = BufferBinding{ page->buffer.get(), this->desc.bindingSize, 0 };
+
+            page->bindGroup = this->device->createBindGroup(BindGroupDescriptor{ this->desc.layout, { entry } });
+        }
+
+        page->data = static_cast<uint8_t*>(page->buffer->map(bufferDesc.size, 0));
+        page->size = size;
+
+        this->current->pages.push_back(std::move(page));
+        return this->current->pages.back().get();
+    }
+
+    void TransientAllocator::beginFrame(Uint64 frameIndex) {
+        this->frameIndex = frameIndex;
+        this->current = &this->frames[frameIndex % this->desc.framesInFlight];
+
+        for (auto& page : this->current->pages) {
+            page->cursor.store(0, std::memory_order_relaxed);
+        }
+
+        this->current->currentIndex = 0;
+        this->current->currentPage.store(this->current->pages.empty() ? nullptr : this->current->pages[0].get(), std::memory_order_release);
+    }
+
+    bool TransientAllocator::refill(Context& context, Uint64 size) {
+        Uint64 blockSize = std::max(this->desc.blockSize, alignUp(size, this->desc.alignment));
+
+        while (true) {
+            Page* page = this->current->currentPage.load(std::memory_order_acquire);
+
+            if (page != nullptr) {
+                Uint64 start = page->cursor.fetch_add(blockSize, std::memory_order_relaxed);
+
+                if (start + blockSize <= page->size) {
+                    context.page = page;
+                    context.cursor = start;
+                    context.end = start + blockSize;
+                    context.frameIndex = this->frameIndex;
+
+                    return true;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(this->mutex);
+
+            // Another thread may have moved on already
+            if (this->current->currentPage.load(std::memory_order_relaxed) != page) {
+                continue;
+            }
+
+            Frame* frame = this->current;
+            Page* next = nullptr;
+
+            // The pages after the current one were used by an earlier frame and are empty now
+            while (page != nullptr && frame->currentIndex + 1 < frame->pages.size()) {
+                Page* candidate = frame->pages[++frame->currentIndex].get();
+
+                if (candidate->size >= blockSize) {
+                    next = candidate;
+                    break;
+                }
+            }
+
+            if (next == nullptr) {
+                next = this->createPage(std::max(this->desc.pageSize, blockSize));
+
+                if (next == nullptr) {
+                    return false;
+                }
+
+                frame->currentIndex = frame->pages.size() - 1;
+            }
+
+            frame->currentPage.store(next, std::memory_order_release);
+        }
+    }
+
+    TransientAllocation TransientAllocator::allocate(Context& context, Uint64 size) {
+        Uint64 alignedSize = alignUp(std::max<Uint64>(1, size), this->desc.alignment);
+
+        bool fits = context.frameIndex == this->frameIndex && context.page != nullptr && context.cursor + alignedSize <= context.end;
+
+        if (!fits && !this->refill(context, alignedSize)) {
+            return TransientAllocation{};
+        }
+
+        TransientAllocation allocation;
+        allocation.buffer = context.page->buffer.get();
+        allocation.bindGroup = size <= this->desc.bindingSize ? context.page->bindGroup.get() : nullptr;
+        allocation.offset = static_cast<Uint32>(context.cursor);
+        allocation.data = context.page->data + context.cursor;
+
+        context.cursor += alignedSize;
+        return allocation;
+    }
+
+    void TransientAllocator::flush() {
+        for (auto& page : this->current->pages) {
+            Uint64 used = std::min(page->cursor.load(std::memory_order_relaxed), page->size);
+
+            if (used != 0) {
+                page->buffer->flush(used, 0);
+            }
+        }
+    }
+
+    Uint64 TransientAllocator::getUsedBytes() const {
+        Uint64 bytes = 0;
+
+        for (const auto& page : this->current->pages) {
+            bytes += std::min(page->cursor.load(std::memory_order_relaxed), page->size);
+        }
+
+        return bytes;
+    }
+
+    Uint64 TransientAllocator::getCapacity() const {
+        Uint64 bytes = 0;
+
+        for (Uint32 i = 0; i < this->desc.framesInFlight; i++) {
+            for (const auto& page : this->frames[i].pages) {
+                bytes += page->size;
+            }
+        }
+
+        return bytes;
+    }
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "rhi.hpp"
+
+#include <atomic>
+#include <mutex>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Transient Allocator
+    // ===========================================================================================================================
+
+    struct TransientAllocatorDescriptor {
+        // Host visible pages holding the data of one frame, more are added when a frame needs them
+        Uint64 pageSize = 4ull << 20;
+
+        // Span a thread claims from a page at once, its allocations inside it take no lock
+        Uint64 blockSize = 64ull << 10;
+
+        // minUniformBufferOffsetAlignment or minStorageBufferOffsetAlignment of the device
+        Uint32 alignment = 256;
+
+        BufferUsageFlags usage = static_cast<BufferUsageFlags>(BufferUsage::eUniform) | static_cast<BufferUsageFlags>(BufferUsage::eStorage);
+        Uint32 framesInFlight = 3;
+
+        // Optional layout with a dynamic offset buffer at binding 0. Every page then gets a bind
+        // group over bindingSize bytes, so one group and an offset serve every allocation up to that size.
+        BindGroupLayout* layout = nullptr;
+        Uint64 bindingSize = 64ull << 10;
+    };
+
+    struct TransientAllocation {
+        Buffer* buffer = nullptr;
+
+        // Binds bindingSize bytes from offset, null for allocations larger than that, which have
+        // to be bound through buffer and offset instead
+        BindGroup* bindGroup = nullptr;
+
+        // Dynamic offset of the allocation inside buffer
+        Uint32 offset = 0;
+        void* data = nullptr;
+    };
+
+    // Linear allocator for per-draw uniform and storage data that lives for one frame. Each
+    // recording thread bumps a pointer through its own Context, threads only meet on an atomic
+    // when a context claims its next block. Pages are kept per frame in flight and reused once
+    // that frame has completed, so a steady workload stops creating buffers.
+    class TransientAllocator {
+        struct Page;
+
+    public:
+        class Context {
+        private:
+            friend class TransientAllocator;
+
+            Page* page = nullptr;
+            Uint64 cursor = 0;
+            Uint64 end = 0;
+            Uint64 frameIndex = ULLONG_MAX;
+        };
+
+        TransientAllocator(Device* device, TransientAllocatorDescriptor descriptor = {});
+        ~TransientAllocator();
+
+        TransientAllocator(const TransientAllocator&) = delete;
+        TransientAllocator& operator=(const TransientAllocator&) = delete;
+
+        // Reuses the pages of frameIndex - framesInFlight, which must have completed. Not
+        // thread safe against allocate.
+        void beginFrame(Uint64 frameIndex);
+
+        // Safe from many threads as long as each uses its own context. An empty allocation
+        // means the device ran out of memory.
+        TransientAllocation allocate(Context& context, Uint64 size);
+
+        // Makes the data written this frame visible to the device, call before submitting
+        void flush();
+
+        Uint64 getUsedBytes() const;
+        Uint64 getCapacity() const;
+
+    private:
+        struct Page {
+            std::shared_ptr<Buffer> buffer;
+            std::shared_ptr<BindGroup> bindGroup;
+            uint8_t* data;
+
+            // Allocations must start below size, bindingSize bytes of slack follow it
+            Uint64 size;
+            std::atomic<Uint64> cursor{ 0 };
+        };
+
+        // pages only changes under the mutex, contexts reach pages through currentPage
+        struct Frame {
+            std::vector<std::unique_ptr<Page>> pages;
+            std::atomic<Page*> currentPage{ nullptr };
+            size_t currentIndex = 0;
+        };
+
+        bool refill(Context& context, Uint64 size);
+        Page* createPage(Uint64 size);
+
+        Device* device;
+        TransientAllocatorDescriptor desc;
+
+        std::unique_ptr<Frame[]> frames;
+        Frame* current;
+        Uint64 frameIndex = 0;
+
+        // Guards adding pages and moving on to the next page
+        std::mutex mutex;
+    };
+};
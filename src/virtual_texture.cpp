@@ -0,0 +1,684 @@
+#include "virtual_texture.hpp"
+#include "texture_streaming.hpp"
+#include "texture_state.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Rhi {
+    namespace {
+        constexpr Uint32 kMaxMipLevels = 31;
+
+        Uint32 getPageCount(Uint32 texels, Uint32 tileSize) {
+            return std::max<Uint32>(1, std::min(kVirtualMaxPagesPerSide, (texels + tileSize - 1) / tileSize));
+        }
+
+        // Every mip halves the pages, rounding up, until a single page covers the texture
+        Uint32 getNextPageCount(Uint32 pages) {
+            return std::max<Uint32>(1, (pages + 1) / 2);
+        }
+
+        Uint32 getKeyMip(Uint64 key) { return static_cast<Uint32>(key >> 40); }
+        Uint32 getKeyY(Uint64 key) { return static_cast<Uint32>((key >> 20) & 0xFFFFF); }
+        Uint32 getKeyX(Uint64 key) { return static_cast<Uint32>(key & 0xFFFFF); }
+
+        Uint32 getEntryMip(uint32_t entry) { return (entry >> 24) & 0x7F; }
+
+        void transitionTexture(CommandEncoder* encoder, ShaderStage srcStage, ShaderStage dstStage, Texture* texture,
+            TextureState state)
+        {
+            ImageBarrier barrier;
+            barrier.srcAccess = ResourceAccess::eReadWrite;
+            barrier.dstAccess = state == TextureState::eCopyDst ? ResourceAccess::eWriteOnly : ResourceAccess::eReadOnly;
+            barrier.texture = texture;
+            barrier.subresource.mipLevelCount = texture->desc.mipLevelCount;
+            barrier.subresource.arrayLayerCount = texture->desc.sliceLayersNum;
+            barrier.srcState = texture->state;
+            barrier.dstState = state;
+
+            encoder->activateImageBarrier(srcStage, dstStage, barrier);
+            setTextureState(texture, state);
+        }
+
+        void transitionBuffer(CommandEncoder* encoder, ShaderStage srcStage, ShaderStage dstStage, Buffer* buffer,
+            ResourceAccess srcAccess, ResourceAccess dstAccess)
+        {
+            BufferBarrier barrier;
+            barrier.srcAccess = srcAccess;
+            barrier.dstAccess = dstAccess;
+            barrier.buffer = buffer;
+
+            encoder->activateBufferBarrier(srcStage, dstStage, barrier);
+        }
+
+        bool validateDescriptor(const VirtualTextureDescriptor& desc, std::string& error) {
+            if (desc.tileSize == 0) {
+                error = "Virtual texture tileSize must not be 0";
+                return false;
+            }
+
+            // Page table entries hold the cache slot in 12 bits per axis
+            if (desc.cacheTilesX == 0 || desc.cacheTilesY == 0 || desc.cacheTilesX > kVirtualMaxCacheTilesPerSide
+                || desc.cacheTilesY > kVirtualMaxCacheTilesPerSide)
+            {
+                error = "Virtual texture cache must hold 1 to " + std::to_string(kVirtualMaxCacheTilesPerSide) + " tiles per side";
+                return false;
+            }
+
+            return true;
+        }
+    };
+
+    // ===========================================================================================================================
+    // Virtual Texture Pack
+    // ===========================================================================================================================
+
+    bool VirtualTexturePack::open(const std::string& path, std::string& error) {
+        if (!this->file.open(path)) {
+            error = "Cannot open " + path;
+            return false;
+        }
+
+        if (this->file.getSize() < sizeof(VirtualTexturePackHeader)) {
+            error = path + " is too small to be a virtual texture pack";
+            return false;
+        }
+
+        std::memcpy(&this->header, this->file.getData(), sizeof(VirtualTexturePackHeader));
+
+        if (this->header.magic != kVirtualTexturePackMagic || this->header.version != kVirtualTexturePackVersion) {
+            error = path + " is not a version " + std::to_string(kVirtualTexturePackVersion) + " virtual texture pack";
+            return false;
+        }
+
+        if (this->header.tileSize == 0 || this->header.mipLevelCount == 0 || this->header.mipLevelCount > kMaxMipLevels) {
+            error = path + " has an invalid tile layout";
+            return false;
+        }
+
+        this->mipTableOffsets.clear();
+        this->mipPagesX.clear();
+
+        Uint64 tileCount = 0;
+        Uint32 pagesX = getPageCount(this->header.width, this->header.tileSize);
+        Uint32 pagesY = getPageCount(this->header.height, this->header.tileSize);
+
+        for (Uint32 level = 0; level < this->header.mipLevelCount; level++) {
+            this->mipTableOffsets.push_back(tileCount);
+            this->mipPagesX.push_back(pagesX);
+
+            tileCount += static_cast<Uint64>(pagesX) * pagesY;
+            pagesX = getNextPageCount(pagesX);
+            pagesY = getNextPageCount(pagesY);
+        }
+
+        if (this->file.getSize() - sizeof(VirtualTexturePackHeader) < tileCount * sizeof(TileEntry)) {
+            error = path + " is truncated inside its tile table";
+            return false;
+        }
+
+        this->tileTable = this->file.getData() + sizeof(VirtualTexturePackHeader);
+        return true;
+    }
+
+    bool VirtualTexturePack::readTile(Uint32 mipLevel, Uint32 x, Uint32 y, uint8_t* destination, Uint32 rowPitch) {
+        if (mipLevel >= this->mipPagesX.size() || x >= this->mipPagesX[mipLevel]) {
+            return false;
+        }
+
+        Uint64 index = this->mipTableOffsets[mipLevel] + static_cast<Uint64>(y) * this->mipPagesX[mipLevel] + x;
+        Uint64 end = mipLevel + 1 < this->mipTableOffsets.size() ? this->mipTableOffsets[mipLevel + 1] : index + 1;
+
+        if (index >= end) {
+            return false;
+        }
+
+        TileEntry entry;
+        std::memcpy(&entry, this->tileTable + index * sizeof(TileEntry), sizeof(TileEntry));
+
+        Uint64 tileBytes = static_cast<Uint64>(this->header.rowBytes) * this->header.rowCount;
+
+        if (entry.size == 0 || entry.size < tileBytes || entry.offset > this->file.getSize()
+            || this->file.getSize() - entry.offset < tileBytes || rowPitch < this->header.rowBytes)
+        {
+            return false;
+        }
+
+        const uint8_t* src = this->file.getData() + entry.offset;
+
+        for (Uint32 row = 0; row < this->header.rowCount; row++) {
+            std::memcpy(destination + static_cast<Uint64>(row) * rowPitch, src + static_cast<Uint64>(row) * this->header.rowBytes,
+                this->header.rowBytes);
+        }
+
+        return true;
+    }
+
+    void VirtualTexturePack::getDescriptor(VirtualTextureDescriptor& descriptor) const {
+        descriptor.size = Extent3D{ this->header.width, this->header.height };
+        descriptor.format = static_cast<TextureFormat>(this->header.format);
+        descriptor.tileSize = this->header.tileSize;
+        descriptor.tileBorder = this->header.tileBorder;
+        descriptor.mipLevelCount = this->header.mipLevelCount;
+    }
+
+    // ===========================================================================================================================
+    // Virtual Texture
+    // ===========================================================================================================================
+
+    VirtualTexture::VirtualTexture(Device* device, VirtualTextureSource* source, VirtualTextureDescriptor descriptor)
+        : device{ device }, source{ source }, desc{ descriptor }, ioPool{ std::max<Uint32>(1, descriptor.ioThreadCount) }
+    {
+        this->desc.framesInFlight = std::max<Uint32>(1, this->desc.framesInFlight);
+
+        if (!validateDescriptor(this->desc, this->error)) {
+            return;
+        }
+
+        Uint32 pagesX = getPageCount(this->desc.size.width, this->desc.tileSize);
+        Uint32 pagesY = getPageCount(this->desc.size.height, this->desc.tileSize);
+
+        // The whole table starts dirty so the first update overwrites its undefined contents
+        while (true) {
+            Mip mip;
+            mip.pagesX = pagesX;
+            mip.pagesY = pagesY;
+            mip.entries.assign(static_cast<size_t>(pagesX) * pagesY, 0);
+            mip.dirtyMinX = 0;
+            mip.dirtyMinY = 0;
+            mip.dirtyMaxX = pagesX - 1;
+            mip.dirtyMaxY = pagesY - 1;
+
+            this->mips.push_back(std::move(mip));
+
+            bool lastMip = this->mips.size() == kMaxMipLevels || this->mips.size() == this->desc.mipLevelCount;
+            if ((pagesX == 1 && pagesY == 1) || lastMip) {
+                break;
+            }
+
+            pagesX = getNextPageCount(pagesX);
+            pagesY = getNextPageCount(pagesY);
+        }
+
+        this->mipLevelCount = static_cast<Uint32>(this->mips.size());
+
+        const Mip& coarsest = this->mips.back();
+        Uint32 slotCount = this->desc.cacheTilesX * this->desc.cacheTilesY;
+
+        if (static_cast<Uint64>(coarsest.pagesX) * coarsest.pagesY >= slotCount) {
+            this->error = "Virtual texture cache cannot hold the " + std::to_string(coarsest.pagesX * coarsest.pagesY)
+                + " tiles of the coarsest mip and still stream finer ones";
+            return;
+        }
+
+        Uint32 tileTexels = this->desc.tileSize + this->desc.tileBorder * 2;
+
+        TextureDescriptor cacheDesc;
+        cacheDesc.size = Extent3D{ this->desc.cacheTilesX * tileTexels, this->desc.cacheTilesY * tileTexels };
+        cacheDesc.usage = static_cast<TextureUsageFlags>(TextureUsage::eTextureBinding) | static_cast<TextureUsageFlags>(TextureUsage::eCopyDst);
+        cacheDesc.format = this->desc.format;
+
+        this->cacheTexture = this->device->createTexture(cacheDesc);
+
+        TextureDescriptor pageTableDesc;
+        pageTableDesc.size = Extent3D{ this->mips[0].pagesX, this->mips[0].pagesY };
+        pageTableDesc.mipLevelCount = this->mipLevelCount;
+        pageTableDesc.usage = static_cast<TextureUsageFlags>(TextureUsage::eTextureBinding) | static_cast<TextureUsageFlags>(TextureUsage::eCopyDst);
+        pageTableDesc.format = TextureFormat::eR32uint;
+
+        this->pageTable = this->device->createTexture(pageTableDesc);
+
+        Uint64 feedbackSize = static_cast<Uint64>(this->desc.feedbackEntryCount) * sizeof(uint32_t);
+
+        this->feedbackBuffer = this->device->createBuffer(BufferDescriptor{ feedbackSize,
+            static_cast<BufferUsageFlags>(BufferUsage::eStorage) | static_cast<BufferUsageFlags>(BufferUsage::eCopySrc)
+                | static_cast<BufferUsageFlags>(BufferUsage::eCopyDst),
+            BufferLocation::eDeviceLocal });
+
+        for (Uint32 i = 0; i < this->desc.framesInFlight; i++) {
+            this->readbackBuffers.push_back(this->device->createBuffer(BufferDescriptor{ feedbackSize,
+                static_cast<BufferUsageFlags>(BufferUsage::eCopyDst), BufferLocation::eHost }));
+        }
+
+        // Staging layout of one tile, the same one copyBufferToTexture expects
+        CopyFootprint tileFootprint = getCopyFootprint(this->desc.format, Extent3D{ tileTexels, tileTexels });
+        this->tileStagingSize = tileFootprint.size;
+        this->tileRowPitch = tileFootprint.bytesPerRow;
+        this->tileRowCount = tileFootprint.rowsPerImage;
+
+        this->slots.assign(slotCount, Slot{ 0, 0, false, false });
+
+        for (Uint32 slot = slotCount; slot > 0; slot--) {
+            this->freeSlots.push_back(slot - 1);
+        }
+
+        // The tiles of the coarsest mip stay resident, every page falls back to one of them
+        for (Uint32 y = 0; y < coarsest.pagesY; y++) {
+            for (Uint32 x = 0; x < coarsest.pagesX; x++) {
+                this->requestTile(makeKey(this->mipLevelCount - 1, x, y), static_cast<Int32>(this->mipLevelCount));
+            }
+        }
+    }
+
+    void VirtualTexture::recordFeedbackReadback(CommandEncoder* encoder, Uint64 frameIndex) {
+        Uint32 index = static_cast<Uint32>(frameIndex % this->desc.framesInFlight);
+        Buffer* readback = this->readbackBuffers[index].get();
+
+        // A readback never consumed means the caller ran more frames ahead than framesInFlight
+        this->pendingReadbacks.erase(std::remove_if(this->pendingReadbacks.begin(), this->pendingReadbacks.end(),
+            [index](const std::pair<Uint64, Uint32>& pending) { return pending.second == index; }), this->pendingReadbacks.end());
+
+        transitionBuffer(encoder, this->desc.consumerStage, ShaderStage::eTransfer, this->feedbackBuffer.get(), ResourceAccess::eReadWrite,
+            ResourceAccess::eReadOnly);
+        encoder->copyBufferToBuffer(this->feedbackBuffer.get(), 0, readback, 0, this->feedbackBuffer->desc.size);
+        transitionBuffer(encoder, ShaderStage::eTransfer, ShaderStage::eHost, readback, ResourceAccess::eWriteOnly, ResourceAccess::eReadOnly);
+
+        transitionBuffer(encoder, ShaderStage::eTransfer, ShaderStage::eTransfer, this->feedbackBuffer.get(), ResourceAccess::eReadOnly,
+            ResourceAccess::eWriteOnly);
+        encoder->clearBuffer(this->feedbackBuffer.get());
+        transitionBuffer(encoder, ShaderStage::eTransfer, this->desc.consumerStage, this->feedbackBuffer.get(), ResourceAccess::eWriteOnly,
+            ResourceAccess::eReadWrite);
+
+        this->pendingReadbacks.emplace_back(frameIndex, index);
+        this->feedbackCleared = true;
+    }
+
+    void VirtualTexture::readFeedback(Uint64 completedFrameIndex, VirtualTextureStats& stats) {
+        std::unordered_map<Uint64, Uint32> requested;
+
+        for (auto pending = this->pendingReadbacks.begin(); pending != this->pendingReadbacks.end();) {
+            if (pending->first > completedFrameIndex) {
+                ++pending;
+                continue;
+            }
+
+            Buffer* readback = this->readbackBuffers[pending->second].get();
+            Uint64 frame = pending->first;
+
+            const uint32_t* entries = static_cast<const uint32_t*>(readback->map(readback->desc.size, 0));
+            readback->invalidate(readback->desc.size, 0);
+
+            for (Uint32 i = 0; i < this->desc.feedbackEntryCount; i++) {
+                uint32_t value = entries[i];
+
+                if ((value & kVirtualEntryValid) == 0) {
+                    continue;
+                }
+
+                Uint32 mipLevel = (value >> 26) & 0x1F;
+                Uint32 x = value & 0x1FFF;
+                Uint32 y = (value >> 13) & 0x1FFF;
+
+                if (mipLevel >= this->mipLevelCount || x >= this->mips[mipLevel].pagesX || y >= this->mips[mipLevel].pagesY) {
+                    continue;
+                }
+
+                requested[makeKey(mipLevel, x, y)]++;
+            }
+
+            readback->unmap();
+
+            this->lastFeedbackFrame = std::max(this->lastFeedbackFrame, frame);
+            pending = this->pendingReadbacks.erase(pending);
+        }
+
+        stats.requestedPages = static_cast<Uint32>(requested.size());
+
+        // A missing page is sampled through its closest resident ancestor, which is therefore
+        // in use too. Every tile on the way there is loaded, so detail sharpens a mip at a time.
+        std::unordered_map<Uint64, Uint32> loads;
+
+        for (const auto& [key, count] : requested) {
+            Uint32 mipLevel = getKeyMip(key), x = getKeyX(key), y = getKeyY(key);
+
+            while (true) {
+                Uint64 tile = makeKey(mipLevel, x, y);
+                auto resident = this->residentTiles.find(tile);
+
+                if (resident != this->residentTiles.end()) {
+                    this->slots[resident->second].lastUsedFrame = this->lastFeedbackFrame;
+                    break;
+                }
+
+                if (this->pendingTiles.count(tile) == 0 && this->missingTiles.count(tile) == 0) {
+                    loads[tile] += count;
+                }
+
+                if (mipLevel + 1 == this->mipLevelCount) {
+                    break;
+                }
+
+                mipLevel++;
+                x /= 2;
+                y /= 2;
+            }
+        }
+
+        std::vector<std::pair<Uint64, Uint32>> ordered{ loads.begin(), loads.end() };
+
+        // Coarse tiles first since they cover the most pages, then the most requested
+        std::sort(ordered.begin(), ordered.end(), [](const std::pair<Uint64, Uint32>& a, const std::pair<Uint64, Uint32>& b) {
+            return getKeyMip(a.first) != getKeyMip(b.first) ? getKeyMip(a.first) > getKeyMip(b.first) : a.second > b.second;
+        });
+
+        for (const auto& [key, count] : ordered) {
+            if (this->pendingTiles.size() >= this->desc.maxPendingLoads) {
+                break;
+            }
+
+            this->requestTile(key, static_cast<Int32>(getKeyMip(key)));
+            stats.queuedLoads++;
+        }
+    }
+
+    void VirtualTexture::requestTile(Uint64 key, Int32 priority) {
+        this->pendingTiles.insert(key);
+        this->ioPool.submit([this, key] { this->load(key); }, priority);
+    }
+
+    void VirtualTexture::load(Uint64 key) {
+        BufferDescriptor stagingDesc;
+        stagingDesc.size = this->tileStagingSize;
+        stagingDesc.usage = static_cast<BufferUsageFlags>(BufferUsage::eCopySrc);
+        stagingDesc.location = BufferLocation::eHost;
+
+        auto staging = this->device->createBuffer(stagingDesc);
+        bool loaded = false;
+
+        if (staging != nullptr) {
+            uint8_t* data = static_cast<uint8_t*>(staging->map(this->tileStagingSize, 0));
+            loaded = this->source->readTile(getKeyMip(key), getKeyX(key), getKeyY(key), data, this->tileRowPitch);
+
+            staging->flush(this->tileStagingSize, 0);
+            staging->unmap();
+        }
+
+        std::lock_guard<std::mutex> lock(this->loadedMutex);
+
+        if (loaded) {
+            this->loaded.push_back(LoadedTile{ key, std::move(staging) });
+        } else {
+            this->failed.push_back(key);
+        }
+    }
+
+    VirtualTextureStats VirtualTexture::update(CommandEncoder* encoder, Uint64 frameIndex, Uint64 completedFrameIndex) {
+        VirtualTextureStats stats;
+
+        auto released = std::remove_if(this->inFlightStaging.begin(), this->inFlightStaging.end(),
+            [completedFrameIndex](const std::pair<Uint64, std::shared_ptr<Buffer>>& entry) {
+                return entry.first <= completedFrameIndex;
+            });
+
+        this->inFlightStaging.erase(released, this->inFlightStaging.end());
+
+        if (!this->feedbackCleared) {
+            encoder->clearBuffer(this->feedbackBuffer.get());
+            transitionBuffer(encoder, ShaderStage::eTransfer, this->desc.consumerStage, this->feedbackBuffer.get(), ResourceAccess::eWriteOnly,
+                ResourceAccess::eReadWrite);
+
+            this->feedbackCleared = true;
+        }
+
+        std::vector<LoadedTile> ready;
+
+        {
+            std::lock_guard<std::mutex> lock(this->loadedMutex);
+
+            // Tiles missing from the source are never requested again
+            for (Uint64 key : this->failed) {
+                this->pendingTiles.erase(key);
+                this->missingTiles.insert(key);
+            }
+
+            this->failed.clear();
+
+            size_t count = std::min<size_t>(this->loaded.size(), this->desc.maxUploadsPerFrame);
+            std::move(this->loaded.begin(), this->loaded.begin() + count, std::back_inserter(ready));
+            this->loaded.erase(this->loaded.begin(), this->loaded.begin() + count);
+        }
+
+        // Coarse tiles claim slots first, finer ones are useless without them
+        std::sort(ready.begin(), ready.end(), [](const LoadedTile& a, const LoadedTile& b) {
+            return getKeyMip(a.key) > getKeyMip(b.key);
+        });
+
+        std::vector<Uint32> candidates;
+        size_t nextCandidate = 0;
+        bool candidatesBuilt = false;
+
+        Uint32 tileTexels = this->desc.tileSize + this->desc.tileBorder * 2;
+
+        for (auto& tile : ready) {
+            this->pendingTiles.erase(tile.key);
+
+            if (this->freeSlots.empty() && !candidatesBuilt) {
+                // Tiles seen in the latest feedback may still be sampled, the rest go oldest first
+                for (Uint32 slot = 0; slot < this->slots.size(); slot++) {
+                    if (this->slots[slot].used && !this->slots[slot].pinned && this->slots[slot].lastUsedFrame < this->lastFeedbackFrame) {
+                        candidates.push_back(slot);
+                    }
+                }
+
+                std::sort(candidates.begin(), candidates.end(), [this](Uint32 a, Uint32 b) {
+                    return this->slots[a].lastUsedFrame < this->slots[b].lastUsedFrame;
+                });
+
+                candidatesBuilt = true;
+            }
+
+            Uint32 slot;
+
+            // Dropped tiles are requested again by later feedback once room frees up
+            if (!this->allocateSlot(slot, candidates, nextCandidate, stats)) {
+                continue;
+            }
+
+            if (stats.uploadedTiles == 0) {
+                transitionTexture(encoder, this->desc.consumerStage, ShaderStage::eTransfer, this->cacheTexture.get(), TextureState::eCopyDst);
+            }
+
+            ImageCopyBuffer source;
+            source.offset = 0;
+            source.bytesPerRow = this->tileRowPitch;
+            source.rowsPerImage = this->tileRowCount;
+            source.buffer = tile.staging.get();
+
+            ImageCopyTexture destination;
+            destination.texture = this->cacheTexture.get();
+            destination.origin.x = slot % this->desc.cacheTilesX * tileTexels;
+            destination.origin.y = slot / this->desc.cacheTilesX * tileTexels;
+
+            encoder->copyBufferToTexture(source, destination, Extent3D{ tileTexels, tileTexels });
+
+            this->mapTile(tile.key, slot, frameIndex);
+            this->inFlightStaging.emplace_back(frameIndex, std::move(tile.staging));
+
+            stats.uploadedTiles++;
+        }
+
+        if (stats.uploadedTiles != 0) {
+            transitionTexture(encoder, ShaderStage::eTransfer, this->desc.consumerStage, this->cacheTexture.get(), TextureState::eShaderReadOnly);
+        }
+
+        // Loads queued now already see the tiles uploaded above as resident
+        this->readFeedback(completedFrameIndex, stats);
+        this->uploadPageTable(encoder, frameIndex);
+
+        stats.residentTiles = static_cast<Uint32>(this->residentTiles.size());
+        stats.pendingLoads = static_cast<Uint32>(this->pendingTiles.size());
+
+        return stats;
+    }
+
+    bool VirtualTexture::allocateSlot(Uint32& slot, std::vector<Uint32>& candidates, size_t& next, VirtualTextureStats& stats) {
+        if (!this->freeSlots.empty()) {
+            slot = this->freeSlots.back();
+            this->freeSlots.pop_back();
+
+            return true;
+        }
+
+        if (next >= candidates.size()) {
+            return false;
+        }
+
+        slot = candidates[next++];
+        this->unmapTile(this->slots[slot].key);
+
+        stats.evictedTiles++;
+        return true;
+    }
+
+    void VirtualTexture::mapTile(Uint64 key, Uint32 slot, Uint64 frameIndex) {
+        Uint32 mipLevel = getKeyMip(key);
+
+        this->slots[slot] = Slot{ key, frameIndex, true, mipLevel + 1 == this->mipLevelCount };
+        this->residentTiles[key] = slot;
+
+        uint32_t entry = packVirtualPageEntry(slot % this->desc.cacheTilesX, slot / this->desc.cacheTilesX, mipLevel);
+        this->writeEntries(mipLevel, getKeyX(key), getKeyY(key), entry, false);
+    }
+
+    void VirtualTexture::unmapTile(Uint64 key) {
+        Uint32 mipLevel = getKeyMip(key), x = getKeyX(key), y = getKeyY(key);
+
+        this->slots[this->residentTiles[key]].used = false;
+        this->residentTiles.erase(key);
+
+        uint32_t fallback = 0;
+
+        if (mipLevel + 1 < this->mipLevelCount) {
+            const Mip& parent = this->mips[mipLevel + 1];
+            fallback = parent.entries[static_cast<size_t>(y / 2) * parent.pagesX + x / 2];
+        }
+
+        this->writeEntries(mipLevel, x, y, fallback, true);
+    }
+
+    void VirtualTexture::writeEntries(Uint32 mipLevel, Uint32 x, Uint32 y, uint32_t entry, bool unmap) {
+        for (Uint32 level = mipLevel + 1; level-- > 0;) {
+            Mip& mip = this->mips[level];
+            Uint32 shift = mipLevel - level;
+
+            Uint32 minX = x << shift, minY = y << shift;
+            if (minX >= mip.pagesX || minY >= mip.pagesY) {
+                continue;
+            }
+
+            Uint32 maxX = std::min(mip.pagesX, (x + 1) << shift) - 1;
+            Uint32 maxY = std::min(mip.pagesY, (y + 1) << shift) - 1;
+
+            for (Uint32 row = minY; row <= maxY; row++) {
+                uint32_t* entries = mip.entries.data() + static_cast<size_t>(row) * mip.pagesX;
+
+                for (Uint32 column = minX; column <= maxX; column++) {
+                    uint32_t current = entries[column];
+                    bool valid = (current & kVirtualEntryValid) != 0;
+
+                    bool replace = level == mipLevel || (unmap
+                        ? valid && getEntryMip(current) == mipLevel
+                        : !valid || getEntryMip(current) > mipLevel);
+
+                    if (replace) {
+                        entries[column] = entry;
+                    }
+                }
+            }
+
+            if (mip.dirtyMaxX < mip.dirtyMinX || mip.dirtyMaxY < mip.dirtyMinY) {
+                mip.dirtyMinX = minX;
+                mip.dirtyMinY = minY;
+                mip.dirtyMaxX = maxX;
+                mip.dirtyMaxY = maxY;
+            } else {
+                mip.dirtyMinX = std::min(mip.dirtyMinX, minX);
+                mip.dirtyMinY = std::min(mip.dirtyMinY, minY);
+                mip.dirtyMaxX = std::max(mip.dirtyMaxX, maxX);
+                mip.dirtyMaxY = std::max(mip.dirtyMaxY, maxY);
+            }
+        }
+    }
+
+    void VirtualTexture::uploadPageTable(CommandEncoder* encoder, Uint64 frameIndex) {
+        std::vector<TextureUploadRegion> regions;
+        Uint64 stagingSize = 0;
+
+        for (Uint32 level = 0; level < this->mipLevelCount; level++) {
+            const Mip& mip = this->mips[level];
+
+            if (mip.dirtyMaxX < mip.dirtyMinX || mip.dirtyMaxY < mip.dirtyMinY) {
+                continue;
+            }
+
+            TextureUploadRegion region;
+            region.mipLevel = level;
+            region.arrayLayer = 0;
+            region.size = Extent3D{ mip.dirtyMaxX - mip.dirtyMinX + 1, mip.dirtyMaxY - mip.dirtyMinY + 1 };
+
+            CopyFootprint footprint = getCopyFootprint(TextureFormat::eR32uint, region.size);
+            region.layout.offset = alignCopyOffset(stagingSize, kTextureCopyOffsetAlignment);
+            region.layout.bytesPerRow = footprint.bytesPerRow;
+            region.layout.rowsPerImage = footprint.rowsPerImage;
+
+            stagingSize = region.layout.offset + footprint.size;
+            regions.push_back(region);
+        }
+
+        if (regions.empty()) {
+            return;
+        }
+
+        BufferDescriptor stagingDesc;
+        stagingDesc.size = stagingSize;
+        stagingDesc.usage = static_cast<BufferUsageFlags>(BufferUsage::eCopySrc);
+        stagingDesc.location = BufferLocation::eHost;
+
+        auto staging = this->device->createBuffer(stagingDesc);
+        if (staging == nullptr) {
+            return;
+        }
+
+        uint8_t* data = static_cast<uint8_t*>(staging->map(stagingSize, 0));
+
+        for (const auto& region : regions) {
+            Mip& mip = this->mips[region.mipLevel];
+
+            for (Uint32 row = 0; row < region.size.height; row++) {
+                const uint32_t* src = mip.entries.data() + static_cast<size_t>(mip.dirtyMinY + row) * mip.pagesX + mip.dirtyMinX;
+                std::memcpy(data + region.layout.offset + static_cast<Uint64>(row) * region.layout.bytesPerRow, src,
+                    region.size.width * sizeof(uint32_t));
+            }
+        }
+
+        staging->flush(stagingSize, 0);
+        staging->unmap();
+
+        transitionTexture(encoder, this->desc.consumerStage, ShaderStage::eTransfer, this->pageTable.get(), TextureState::eCopyDst);
+
+        for (const auto& region : regions) {
+            Mip& mip = this->mips[region.mipLevel];
+
+            ImageCopyBuffer source;
+            static_cast<ImageDataLayout&>(source) = region.layout;
+            source.buffer = staging.get();
+
+            ImageCopyTexture destination;
+            destination.texture = this->pageTable.get();
+            destination.mipLevel = region.mipLevel;
+            destination.origin.x = mip.dirtyMinX;
+            destination.origin.y = mip.dirtyMinY;
+
+            encoder->copyBufferToTexture(source, destination, region.size);
+
+            // Empty rectangle: min past max
+            mip.dirtyMinX = mip.pagesX;
+            mip.dirtyMinY = mip.pagesY;
+            mip.dirtyMaxX = 0;
+            mip.dirtyMaxY = 0;
+        }
+
+        transitionTexture(encoder, ShaderStage::eTransfer, this->desc.consumerStage, this->pageTable.get(), TextureState::eShaderReadOnly);
+        this->inFlightStaging.emplace_back(frameIndex, std::move(staging));
+    }
+};
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "rhi.hpp"
+#include "mapped_file.hpp"
+#include "task_pool.hpp"
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Rhi {
+    // ===========================================================================================================================
+    // Virtual Texture Encoding
+    // ===========================================================================================================================
+
+    // Shaders share these layouts with the CPU side.
+    //
+    // Page table: an eR32uint texture with one texel per virtual page and one mip per virtual
+    // mip. An entry names the cache slot holding the page, or its closest resident ancestor:
+    //   bits 0-11 slot x, bits 12-23 slot y, bits 24-30 mip of the tile in the slot, bit 31 valid
+    //
+    // Feedback: a storage buffer of uint32 entries the shader writes the pages it wanted into,
+    // at any index (typically a hash of the pixel). Zero means no request:
+    //   bits 0-12 page x, bits 13-25 page y, bits 26-30 mip, bit 31 valid
+
+    constexpr uint32_t kVirtualEntryValid = 0x80000000u;
+    constexpr Uint32 kVirtualMaxPagesPerSide = 1 << 13;
+    constexpr Uint32 kVirtualMaxCacheTilesPerSide = 1 << 12;
+
+    constexpr uint32_t packVirtualPageEntry(uint32_t slotX, uint32_t slotY, uint32_t mipLevel) {
+        return slotX | (slotY << 12) | (mipLevel << 24) | kVirtualEntryValid;
+    }
+
+    constexpr uint32_t packVirtualFeedback(uint32_t pageX, uint32_t pageY, uint32_t mipLevel) {
+        return pageX | (pageY << 13) | (mipLevel << 26) | kVirtualEntryValid;
+    }
+
+    // ===========================================================================================================================
+    // Virtual Texture Source
+    // ===========================================================================================================================
+
+    class VirtualTextureSource {
+    public:
+        virtual ~VirtualTextureSource() = default;
+
+        // Writes the tile with its border in the texture format, rows of blocks rowPitch bytes
+        // apart. Called from I/O threads, false when the tile does not exist.
+        virtual bool readTile(Uint32 mipLevel, Uint32 x, Uint32 y, uint8_t* destination, Uint32 rowPitch) = 0;
+    };
+
+    // A pack file holds every tile already block compressed, so tiles go from the page cache
+    // into staging memory without decoding. The header is followed by one { uint64 offset,
+    // uint64 size } entry per tile, mip by mip in row major order, then the tile data with
+    // rows of blocks tightly packed. A size of 0 marks a tile that was never authored.
+    struct VirtualTexturePackHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t format;
+        uint32_t width;
+        uint32_t height;
+        uint32_t tileSize;
+        uint32_t tileBorder;
+        uint32_t mipLevelCount;
+
+        // Tightly packed size of one tile row of blocks, and the block rows per tile
+        uint32_t rowBytes;
+        uint32_t rowCount;
+    };
+
+    constexpr uint32_t kVirtualTexturePackMagic = 0x4B505456;    // "VTPK"
+    constexpr uint32_t kVirtualTexturePackVersion = 1;
+
+    struct VirtualTextureDescriptor;
+
+    class VirtualTexturePack : public VirtualTextureSource {
+    public:
+        bool open(const std::string& path, std::string& error);
+
+        bool readTile(Uint32 mipLevel, Uint32 x, Uint32 y, uint8_t* destination, Uint32 rowPitch) override;
+
+        // Fills the size, format and tile layout of the descriptor from the pack
+        void getDescriptor(VirtualTextureDescriptor& descriptor) const;
+
+    private:
+        struct TileEntry {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        MappedFile file;
+        VirtualTexturePackHeader header;
+
+        const uint8_t* tileTable = nullptr;
+        std::vector<Uint64> mipTableOffsets;
+        std::vector<Uint32> mipPagesX;
+    };
+
+    // ===========================================================================================================================
+    // Virtual Texture
+    // ===========================================================================================================================
+
+    struct VirtualTextureDescriptor {
+        // Virtual size in texels, up to kVirtualMaxPagesPerSide tiles per side
+        Extent3D size;
+        TextureFormat format = eBC7RGBAUnorm;
+
+        // Texels per tile side without the border, the border keeps filtering inside the tile
+        Uint32 tileSize = 128;
+        Uint32 tileBorder = 4;
+
+        // Mips the source holds, 0 runs the chain down to a single page. The tiles of the
+        // coarsest mip stay resident as the fallback of every page.
+        Uint32 mipLevelCount = 0;
+
+        // Physical tile cache, cacheTilesX * cacheTilesY tiles resident at once, up to
+        // kVirtualMaxCacheTilesPerSide per side. It has to hold more than the coarsest mip.
+        Uint32 cacheTilesX = 32;
+        Uint32 cacheTilesY = 32;
+
+        Uint32 feedbackEntryCount = 64 * 1024;
+        Uint32 framesInFlight = 3;
+
+        Uint32 maxUploadsPerFrame = 64;
+        Uint32 maxPendingLoads = 256;
+        Uint32 ioThreadCount = 2;
+
+        ShaderStage consumerStage = ShaderStage::eFragment;
+    };
+
+    struct VirtualTextureStats {
+        Uint32 requestedPages = 0;
+        Uint32 queuedLoads = 0;
+        Uint32 uploadedTiles = 0;
+        Uint32 evictedTiles = 0;
+
+        Uint32 residentTiles = 0;
+        Uint32 pendingLoads = 0;
+    };
+
+    // Streams the tiles a scene actually samples into a fixed cache texture. Shaders look a
+    // virtual page up in the page table, sample the cache and report the page they wanted in
+    // the feedback buffer. The feedback is read back once its frame completed, missing tiles
+    // are loaded coarse mips first on I/O threads and the least recently seen tiles make room.
+    //
+    // The device must allow createBuffer and Buffer::map from worker threads.
+    class VirtualTexture {
+    public:
+        VirtualTexture(Device* device, VirtualTextureSource* source, VirtualTextureDescriptor descriptor);
+
+        VirtualTexture(const VirtualTexture&) = delete;
+        VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+        // False when the descriptor was rejected, getError says why and nothing else may be called
+        bool isValid() const { return this->error.empty(); }
+        const std::string& getError() const { return this->error; }
+
+        // Record after the passes that wrote feedback, copies it out and clears it for the next frame
+        void recordFeedbackReadback(CommandEncoder* encoder, Uint64 frameIndex);
+
+        // Record before the passes of frameIndex. Reads the feedback of frames up to
+        // completedFrameIndex, queues loads and uploads finished tiles with their page table
+        // entries. Staging memory of completed frames is released here as well.
+        VirtualTextureStats update(CommandEncoder* encoder, Uint64 frameIndex, Uint64 completedFrameIndex);
+
+        Texture* getCacheTexture() const { return this->cacheTexture.get(); }
+        Texture* getPageTable() const { return this->pageTable.get(); }
+        Buffer* getFeedbackBuffer() const { return this->feedbackBuffer.get(); }
+
+        Uint32 getMipLevelCount() const { return this->mipLevelCount; }
+        Uint32 getPagesX(Uint32 mipLevel) const { return this->mips[mipLevel].pagesX; }
+        Uint32 getPagesY(Uint32 mipLevel) const { return this->mips[mipLevel].pagesY; }
+
+    private:
+        struct Mip {
+            Uint32 pagesX;
+            Uint32 pagesY;
+
+            // CPU copy of the page table level and the rectangle changed since the last upload
+            std::vector<uint32_t> entries;
+            Uint32 dirtyMinX, dirtyMinY, dirtyMaxX, dirtyMaxY;
+        };
+
+        struct Slot {
+            Uint64 key;
+            Uint64 lastUsedFrame;
+            bool used;
+            bool pinned;
+        };
+
+        struct LoadedTile {
+            Uint64 key;
+            std::shared_ptr<Buffer> staging;
+        };
+
+        static Uint64 makeKey(Uint32 mipLevel, Uint32 x, Uint32 y) {
+            return (static_cast<Uint64>(mipLevel) << 40) | (static_cast<Uint64>(y) << 20) | x;
+        }
+
+        void readFeedback(Uint64 completedFrameIndex, VirtualTextureStats& stats);
+        void requestTile(Uint64 key, Int32 priority);
+        void load(Uint64 key);
+
+        // Takes a free slot or evicts the next cold tile, false when every tile is still in use
+        bool allocateSlot(Uint32& slot, std::vector<Uint32>& candidates, size_t& next, VirtualTextureStats& stats);
+
+        void mapTile(Uint64 key, Uint32 slot, Uint64 frameIndex);
+        void unmapTile(Uint64 key);
+
+        // Points the page and every finer page it covers at entry. Mapping replaces pages that
+        // fell back to a coarser tile, unmapping replaces the pages that pointed at the tile.
+        void writeEntries(Uint32 mipLevel, Uint32 x, Uint32 y, uint32_t entry, bool unmap);
+
+        void uploadPageTable(CommandEncoder* encoder, Uint64 frameIndex);
+
+        Device* device;
+        VirtualTextureSource* source;
+        VirtualTextureDescriptor desc;
+
+        std::string error;
+
+        Uint32 mipLevelCount = 0;
+        std::vector<Mip> mips;
+
+        std::shared_ptr<Texture> cacheTexture;
+        std::shared_ptr<Texture> pageTable;
+        std::shared_ptr<Buffer> feedbackBuffer;
+
+        // One readback buffer per frame in flight, with the frame that wrote it
+        std::vector<std::shared_ptr<Buffer>> readbackBuffers;
+        std::vector<std::pair<Uint64, Uint32>> pendingReadbacks;
+
+        // Row pitch and size of one tile in staging memory
+        Uint32 tileRowPitch;
+        Uint32 tileRowCount;
+        Uint64 tileStagingSize;
+
+        std::vector<Slot> slots;
+        std::vector<Uint32> freeSlots;
+        std::unordered_map<Uint64, Uint32> residentTiles;
+        std::unordered_set<Uint64> pendingTiles;
+        std::unordered_set<Uint64> missingTiles;
+
+        Uint64 lastFeedbackFrame = 0;
+        bool feedbackCleared = false;
+
+        std::mutex loadedMutex;
+        std::vector<LoadedTile> loaded;
+        std::vector<Uint64> failed;
+
+        std::vector<std::pair<Uint64, std::shared_ptr<Buffer>>> inFlightStaging;
+
+        // Declared last so worker threads are joined before the state they touch is destroyed
+        TaskPool ioPool;
+    };
+};
@@ -0,0 +1,38 @@
+#include "mesh.hpp"
+
+#include <cstdio>
+
+// Usage: MeshCooker <input.obj> <output.mesh>
+int main(int argc, char const *argv[])
+{
+    if (argc != 3) {
+        std::fprintf(stderr, "Usage: %s <input.obj> <output.mesh>\n", argv[0]);
+        return 1;
+    }
+
+    std::string error;
+    Rhi::MeshSource source;
+
+    if (!Rhi::importObjMesh(argv[1], source, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    Rhi::CookedMesh mesh;
+    Rhi::MeshCookOptions options;
+
+    float acmrBefore = Rhi::analyzeVertexCache(source.indices.data(), source.indices.size(),
+        static_cast<Rhi::Uint32>(source.positions.size() / 3), options.vertexCacheSize);
+
+    if (!Rhi::cookMesh(source, options, mesh, error) || !Rhi::writeMeshFile(argv[2], mesh, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    float acmrAfter = Rhi::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), mesh.vertexCount, options.vertexCacheSize);
+
+    std::printf("%lu vertices, %zu indices, %llu byte stride, ACMR %.3f -> %.3f\n",
+        mesh.vertexCount, mesh.indices.size(), static_cast<unsigned long long>(mesh.vertexStride), acmrBefore, acmrAfter);
+
+    return 0;
+}
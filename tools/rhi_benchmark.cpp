@@ -0,0 +1,893 @@
+#include "null_device.hpp"
+#include "command_pool.hpp"
+#include "culling.hpp"
+#include "draw_sort.hpp"
+#include "push_constants.hpp"
+#include "transient_allocator.hpp"
+#include "mesh.hpp"
+#include "multi_device.hpp"
+#include "pipeline_manifest.hpp"
+#include "rhi_stats.hpp"
+#include "struct_layout.hpp"
+#include "texture_sampler.hpp"
+#include "tiled_texture.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+
+namespace {
+    // ===========================================================================================================================
+    // Harness
+    // ===========================================================================================================================
+
+    struct BenchmarkResult {
+        std::string name;
+        std::string unit;
+        Rhi::Uint64 itemsPerSample;
+
+        // Nanoseconds per item
+        double min, p50, p90, p99, max, mean;
+    };
+
+    class BenchmarkRunner {
+    public:
+        Rhi::Uint32 sampleCount = 200;
+        Rhi::Uint32 warmupCount = 20;
+        std::string filter;
+
+        // body runs one sample covering itemsPerSample items, unit is "op" or "byte"
+        template <typename Body>
+        void run(const char* name, const char* unit, Rhi::Uint64 itemsPerSample, Body&& body) {
+            if (!this->filter.empty() && std::strstr(name, this->filter.c_str()) == nullptr) {
+                return;
+            }
+
+            for (Rhi::Uint32 i = 0; i < this->warmupCount; i++) {
+                body();
+            }
+
+            std::vector<double> samples(this->sampleCount);
+            for (auto& sample : samples) {
+                auto begin = std::chrono::steady_clock::now();
+                body();
+                auto end = std::chrono::steady_clock::now();
+
+                sample = std::chrono::duration<double, std::nano>(end - begin).count() / static_cast<double>(itemsPerSample);
+            }
+
+            std::sort(samples.begin(), samples.end());
+
+            BenchmarkResult result;
+            result.name = name;
+            result.unit = unit;
+            result.itemsPerSample = itemsPerSample;
+            result.min = samples.front();
+            result.p50 = getPercentile(samples, 0.50);
+            result.p90 = getPercentile(samples, 0.90);
+            result.p99 = getPercentile(samples, 0.99);
+            result.max = samples.back();
+
+            double sum = 0.0;
+            for (double sample : samples) {
+                sum += sample;
+            }
+
+            result.mean = sum / static_cast<double>(samples.size());
+
+            printResult(result);
+            this->results.push_back(result);
+        }
+
+        bool writeJson(const std::string& path, const std::string& label) const {
+            std::ofstream file{ path };
+
+            file << "{\n  \"label\": \"" << label << "\",\n";
+            file << "  \"samples\": " << this->sampleCount << ",\n";
+#ifdef NDEBUG
+            file << "  \"build\": \"release\",\n";
+#else
+            file << "  \"build\": \"debug\",\n";
+#endif
+            file << "  \"benchmarks\": [\n";
+
+            for (size_t i = 0; i < this->results.size(); i++) {
+                const auto& result = this->results[i];
+
+                file << "    { \"name\": \"" << result.name << "\", \"unit\": \"" << result.unit
+                    << "\", \"items\": " << result.itemsPerSample
+                    << ", \"min\": " << result.min << ", \"p50\": " << result.p50 << ", \"p90\": " << result.p90
+                    << ", \"p99\": " << result.p99 << ", \"max\": " << result.max << ", \"mean\": " << result.mean << " }"
+                    << (i + 1 < this->results.size() ? ",\n" : "\n");
+            }
+
+            file << "  ]\n}\n";
+            return static_cast<bool>(file);
+        }
+
+        // Reads back the p50 of every benchmark of a previous writeJson and prints the change
+        bool compare(const std::string& path) const {
+            std::ifstream file{ path };
+            if (!file) {
+                return false;
+            }
+
+            std::map<std::string, double> baseline;
+            std::string line;
+
+            while (std::getline(file, line)) {
+                size_t name = line.find("\"name\": \"");
+                size_t p50 = line.find("\"p50\": ");
+
+                if (name == std::string::npos || p50 == std::string::npos) {
+                    continue;
+                }
+
+                name += 9;
+                baseline[line.substr(name, line.find('"', name) - name)] = std::strtod(line.c_str() + p50 + 7, nullptr);
+            }
+
+            std::printf("\n%-36s %12s %12s %9s\n", "vs baseline (p50, ns/item)", "baseline", "current", "change");
+
+            for (const auto& result : this->results) {
+                auto found = baseline.find(result.name);
+                if (found == baseline.end()) {
+                    continue;
+                }
+
+                double change = (result.p50 - found->second) / found->second * 100.0;
+                std::printf("%-36s %12.3f %12.3f %+8.1f%%\n", result.name.c_str(), found->second, result.p50, change);
+            }
+
+            return true;
+        }
+
+    private:
+        std::vector<BenchmarkResult> results;
+
+        static double getPercentile(const std::vector<double>& sorted, double percentile) {
+            size_t index = static_cast<size_t>(percentile * static_cast<double>(sorted.size() - 1) + 0.5);
+            return sorted[std::min(index, sorted.size() - 1)];
+        }
+
+        static void printResult(const BenchmarkResult& result) {
+            // Byte benchmarks read better as bandwidth
+            if (result.unit == "byte") {
+                std::printf("%-36s p50 %9.3f GB/s  p90 %9.3f GB/s  p99 %9.3f GB/s\n", result.name.c_str(),
+                    1.0 / result.p50, 1.0 / result.p90, 1.0 / result.p99);
+            } else {
+                std::printf("%-36s p50 %9.3f ns    p90 %9.3f ns    p99 %9.3f ns\n", result.name.c_str(),
+                    result.p50, result.p90, result.p99);
+            }
+        }
+    };
+
+    // Keeps the optimizer from dropping work whose result is otherwise unused
+    volatile Rhi::Uint64 sink;
+
+    // ===========================================================================================================================
+    // Benchmarks
+    // ===========================================================================================================================
+
+    constexpr Rhi::Uint32 kDrawCount = 1000;
+
+    void benchmarkEncoding(BenchmarkRunner& runner, Rhi::Device* device) {
+        auto vertexBuffer = device->createBuffer(Rhi::BufferDescriptor{ 1 << 20, static_cast<Rhi::BufferUsageFlags>(Rhi::BufferUsage::eVertex),
+            Rhi::BufferLocation::eDeviceLocal });
+        auto indexBuffer = device->createBuffer(Rhi::BufferDescriptor{ 1 << 20, static_cast<Rhi::BufferUsageFlags>(Rhi::BufferUsage::eIndex),
+            Rhi::BufferLocation::eDeviceLocal });
+
+        auto pipeline = device->createRenderPipeline(Rhi::RenderPipelineDescriptor{});
+        auto bindGroup = device->createBindGroup(Rhi::BindGroupDescriptor{});
+
+        runner.run("encode/draw_indexed", "op", kDrawCount, [&]() {
+            auto encoder = device->createCommandEncoder();
+            auto pass = encoder->beginRenderPass(Rhi::RenderPassDescriptor{});
+
+            pass->setPipeline(pipeline.get());
+            pass->setIndexBuffer(indexBuffer.get(), Rhi::IndexFormat::eUint32);
+
+            for (Rhi::Uint32 i = 0; i < kDrawCount; i++) {
+                pass->drawIndexed(36, 1, i * 36);
+            }
+
+            pass->end();
+            encoder->finish();
+        });
+
+        runner.run("encode/draw_with_state", "op", kDrawCount, [&]() {
+            auto encoder = device->createCommandEncoder();
+            auto pass = encoder->beginRenderPass(Rhi::RenderPassDescriptor{});
+
+            for (Rhi::Uint32 i = 0; i < kDrawCount; i++) {
+                pass->setPipeline(pipeline.get());
+                pass->setBindGroup(0, bindGroup.get());
+                pass->setVertexBuffer(0, vertexBuffer.get(), i * 256ull);
+                pass->setIndexBuffer(indexBuffer.get(), Rhi::IndexFormat::eUint16, i * 72ull);
+                pass->drawIndexed(36);
+            }
+
+            pass->end();
+            encoder->finish();
+        });
+
+        // Same recording as draw_indexed, with the encoder recycled instead of created
+        Rhi::CommandEncoderPool encoderPool{ device };
+        Rhi::Uint64 poolFrame = 0;
+
+        runner.run("encode/draw_indexed_pooled", "op", kDrawCount, [&]() {
+            encoderPool.beginFrame(poolFrame++);
+
+            Rhi::CommandEncoder* encoder = encoderPool.acquire();
+            auto pass = encoder->beginRenderPass(Rhi::RenderPassDescriptor{});
+
+            pass->setPipeline(pipeline.get());
+            pass->setIndexBuffer(indexBuffer.get(), Rhi::IndexFormat::eUint32);
+
+            for (Rhi::Uint32 i = 0; i < kDrawCount; i++) {
+                pass->drawIndexed(36, 1, i * 36);
+            }
+
+            pass->end();
+            encoder->finish();
+        });
+
+        // Same recording as draw_indexed, counted through a stats device
+        Rhi::StatsDevice statsDevice{ device };
+        Rhi::Uint64 statsFrame = 0;
+
+        runner.run("encode/draw_indexed_stats", "op", kDrawCount, [&]() {
+            auto encoder = statsDevice.createCommandEncoder();
+            auto pass = encoder->beginRenderPass(Rhi::RenderPassDescriptor{});
+
+            pass->setPipeline(pipeline.get());
+            pass->setIndexBuffer(indexBuffer.get(), Rhi::IndexFormat::eUint32);
+
+            for (Rhi::Uint32 i = 0; i < kDrawCount; i++) {
+                pass->drawIndexed(36, 1, i * 36);
+            }
+
+            pass->end();
+            encoder->finish();
+
+            statsDevice.endFrame(statsFrame++);
+        });
+
+        std::vector<Rhi::Uint32> dynamicOffsets{ 0, 256 };
+
+        runner.run("encode/set_bind_group", "op", kDrawCount, [&]() {
+            auto encoder = device->createCommandEncoder();
+            auto pass = encoder->beginRenderPass(Rhi::RenderPassDescriptor{});
+
+            for (Rhi::Uint32 i = 0; i < kDrawCount; i++) {
+                dynamicOffsets[0] = i * 256;
+                pass->setBindGroup(i & 3, bindGroup.get(), dynamicOffsets);
+            }
+
+            pass->end();
+            encoder->finish();
+        });
+
+        // Per-draw object data: inline push constants against the uniform ring fallback
+        float objectData[20] = {};
+        auto emptyLayout = device->createBindGroupLayout(Rhi::BindGroupLayoutDescriptor{});
+        auto vertexStages = static_cast<Rhi::ShaderStageFlags>(Rhi::ShaderStage::eVertex);
+
+        runner.run("encode/push_constants", "op", kDrawCount, [&]() {
+            auto encoder = device->createCommandEncoder();
+            auto pass = encoder->beginRenderPass(Rhi::RenderPassDescriptor{});
+
+            for (Rhi::Uint32 i = 0; i < kDrawCount; i++) {
+                objectData[0] = static_cast<float>(i);
+                pass->setPushConstants(vertexStages, 0, sizeof(objectData), objectData);
+                pass->drawIndexed(36);
+            }
+
+            pass->end();
+            encoder->finish();
+        });
+
+        // Per-draw uniforms sub-allocated from the frame's pages, bound with one group and an offset
+        Rhi::TransientAllocatorDescriptor transientDesc;
+        transientDesc.layout = emptyLayout.get();
+        transientDesc.bindingSize = sizeof(objectData);
+
+        Rhi::TransientAllocator transient{ device, transientDesc };
+        Rhi::TransientAllocator::Context transientContext;
+        Rhi::Uint64 transientFrame = 0;
+
+        runner.run("encode/transient_uniforms", "op", kDrawCount, [&]() {
+            auto encoder = device->createCommandEncoder();
+            auto pass = encoder->beginRenderPass(Rhi::RenderPassDescriptor{});
+
+            transient.beginFrame(transientFrame++);
+
+            for (Rhi::Uint32 i = 0; i < kDrawCount; i++) {
+                Rhi::TransientAllocation allocation = transient.allocate(transientContext, sizeof(objectData));
+                std::memcpy(allocation.data, objectData, sizeof(objectData));
+
+                pass->setBindGroup(1, allocation.bindGroup, &allocation.offset, 0, 1);
+                pass->drawIndexed(36);
+            }
+
+            pass->end();
+            encoder->finish();
+        });
+
+        Rhi::PushConstantEmulatorDescriptor emulatorDesc;
+        emulatorDesc.blockSize = sizeof(objectData);
+
+        Rhi::PushConstantEmulator emulator{ device, emulatorDesc };
+        Rhi::Uint64 frameIndex = 0;
+
+        runner.run("encode/push_constants_emulated", "op", kDrawCount, [&]() {
+            auto encoder = device->createCommandEncoder();
+            auto pass = encoder->beginRenderPass(Rhi::RenderPassDescriptor{});
+
+            emulator.beginFrame(frameIndex++);
+
+            for (Rhi::Uint32 i = 0; i < kDrawCount; i++) {
+                objectData[0] = static_cast<float>(i);
+                emulator.setPushConstants(0, sizeof(objectData), objectData);
+                emulator.flush(pass.get());
+                pass->drawIndexed(36);
+            }
+
+            pass->end();
+            encoder->finish();
+        });
+    }
+
+    void benchmarkUploads(BenchmarkRunner& runner, Rhi::Device* device) {
+        const Rhi::Uint64 sizes[] = { 4ull << 10, 256ull << 10, 16ull << 20 };
+        const char* names[] = { "upload/write_buffer_4k", "upload/write_buffer_256k", "upload/write_buffer_16m" };
+
+        for (Rhi::Uint32 i = 0; i < 3; i++) {
+            std::vector<uint8_t> data(sizes[i], 0xA5);
+            auto buffer = device->createBuffer(Rhi::BufferDescriptor{ sizes[i],
+                static_cast<Rhi::BufferUsageFlags>(Rhi::BufferUsage::eCopyDst), Rhi::BufferLocation::eDeviceLocal });
+
+            runner.run(names[i], "byte", sizes[i], [&]() {
+                device->getQueue()->writeBuffer(buffer.get(), 0, data.data(), data.size());
+            });
+        }
+    }
+
+    // 2048x2048 RGBA8, row copies of the linear image are the baseline for the tiled copies
+    void benchmarkTextureCopies(BenchmarkRunner& runner, Rhi::Device* device) {
+        constexpr Rhi::Uint32 kSize = 2048;
+        constexpr Rhi::Uint64 kTexelCount = static_cast<Rhi::Uint64>(kSize) * kSize;
+
+        Rhi::TextureDescriptor descriptor{};
+        descriptor.size = Rhi::Extent3D{ kSize, kSize, 1 };
+        descriptor.mipLevelCount = 12;
+        descriptor.usage = static_cast<Rhi::TextureUsageFlags>(Rhi::TextureUsage::eCopySrc)
+            | static_cast<Rhi::TextureUsageFlags>(Rhi::TextureUsage::eCopyDst);
+        descriptor.format = Rhi::eRGBA8Unorm;
+
+        std::vector<uint8_t> image(kTexelCount * 4, 0xA5);
+        std::vector<uint8_t> copy(kTexelCount * 4);
+        Rhi::ImageDataLayout layout{ 0, kSize * 4, kSize };
+
+        Rhi::TiledTexture tiled{ descriptor };
+        Rhi::TaskPool pool;
+
+        runner.run("texture/copy_linear_rgba8_2k", "texel", kTexelCount, [&]() {
+            for (Rhi::Uint32 row = 0; row < kSize; row++) {
+                std::memcpy(&copy[row * kSize * 4], &image[row * kSize * 4], kSize * 4);
+            }
+
+            sink = copy[kTexelCount];
+        });
+
+        runner.run("texture/swizzle_rgba8_2k", "texel", kTexelCount, [&]() {
+            Rhi::copyLinearToTiled(tiled, 0, Rhi::Origin3D{}, descriptor.size, image.data(), layout);
+        });
+
+        runner.run("texture/deswizzle_rgba8_2k", "texel", kTexelCount, [&]() {
+            Rhi::copyTiledToLinear(tiled, 0, Rhi::Origin3D{}, descriptor.size, copy.data(), layout);
+            sink = copy[kTexelCount];
+        });
+
+        runner.run("texture/swizzle_rgba8_2k_parallel", "texel", kTexelCount, [&]() {
+            Rhi::copyLinearToTiled(pool, tiled, 0, Rhi::Origin3D{}, descriptor.size, image.data(), layout);
+        });
+
+        runner.run("texture/deswizzle_rgba8_2k_parallel", "texel", kTexelCount, [&]() {
+            Rhi::copyTiledToLinear(pool, tiled, 0, Rhi::Origin3D{}, descriptor.size, copy.data(), layout);
+            sink = copy[kTexelCount];
+        });
+
+        // Unaligned sub-rectangle of mip 1, mostly whole squares with ragged edges
+        Rhi::Extent3D region{ 509, 253, 1 };
+        runner.run("texture/swizzle_rgba8_subrect_mip1", "texel", region.width * region.height, [&]() {
+            Rhi::copyLinearToTiled(tiled, 1, Rhi::Origin3D{ 3, 5, 0 }, region, image.data(), layout);
+        });
+
+        auto texture = device->createTexture(descriptor);
+        runner.run("upload/write_texture_rgba8_2k", "texel", kTexelCount, [&]() {
+            device->getQueue()->writeTexture(Rhi::ImageCopyTexture{ texture.get() }, image.data(), image.size(), layout,
+                descriptor.size);
+        });
+    }
+
+    // 1024x1024 RGBA8 with a full mip chain, sampled along rows of jittered points as a baking pass would
+    void benchmarkSampling(BenchmarkRunner& runner) {
+        constexpr Rhi::Uint32 kSize = 1024;
+        constexpr Rhi::Uint32 kSampleCount = 4096;
+
+        Rhi::TextureDescriptor descriptor{};
+        descriptor.size = Rhi::Extent3D{ kSize, kSize, 1 };
+        descriptor.mipLevelCount = 11;
+        descriptor.format = Rhi::eRGBA8Unorm;
+
+        Rhi::TiledTexture texture{ descriptor };
+        std::vector<uint8_t> image(static_cast<Rhi::Uint64>(kSize) * kSize * 4, 0x5A);
+
+        for (Rhi::Uint32 mipLevel = 0; mipLevel < descriptor.mipLevelCount; mipLevel++) {
+            Rhi::Extent3D extent = texture.getMipBlocks(mipLevel);
+            Rhi::copyLinearToTiled(texture, mipLevel, Rhi::Origin3D{}, extent, image.data(),
+                Rhi::ImageDataLayout{ 0, static_cast<uint32_t>(extent.width * 4), 0 });
+        }
+
+        Rhi::SampledTexture sampled;
+        std::string error;
+        Rhi::createSampledTexture(texture, sampled, error);
+
+        // Fixed seed, every run samples the same coordinates
+        std::mt19937 random{ 1234 };
+        std::uniform_real_distribution<float> distribution{ 0.0f, 1.0f };
+
+        std::vector<float> u(kSampleCount), v(kSampleCount), lod(kSampleCount);
+        std::vector<float> dudx(kSampleCount), dvdx(kSampleCount, 0.0f), dudy(kSampleCount, 0.0f), dvdy(kSampleCount);
+
+        for (Rhi::Uint32 i = 0; i < kSampleCount; i++) {
+            u[i] = (i % 64 + distribution(random)) / 64.0f;
+            v[i] = (i / 64 + distribution(random)) / 64.0f;
+            lod[i] = distribution(random) * 4.0f;
+
+            // Stretched 8:1 along u, as on a surface seen at a grazing angle
+            dudx[i] = 8.0f / kSize;
+            dvdy[i] = 1.0f / kSize;
+        }
+
+        std::vector<float> output(kSampleCount * 4);
+        Rhi::SampleCoordinates coordinates{ u.data(), v.data(), nullptr, nullptr, kSampleCount };
+        Rhi::SampleGradients gradients{ dudx.data(), dvdx.data(), dudy.data(), dvdy.data() };
+
+        Rhi::SamplerDescriptor nearest{};
+        Rhi::SamplerDescriptor trilinear{};
+        trilinear.magFilter = Rhi::eLinear;
+        trilinear.minFilter = Rhi::eLinear;
+        trilinear.mipmapFilter = Rhi::MipmapFilterMode::eLinear;
+        trilinear.addressModeU = Rhi::AddressMode::eRepeat;
+        trilinear.addressModeV = Rhi::AddressMode::eRepeat;
+
+        Rhi::SamplerDescriptor anisotropic = trilinear;
+        anisotropic.maxAnisotropy = 8;
+
+        const Rhi::SamplerDescriptor descriptors[] = { nearest, trilinear, anisotropic };
+        const char* names[] = { "sample/nearest_rgba8", "sample/trilinear_rgba8", "sample/anisotropic8_rgba8" };
+
+        for (Rhi::Uint32 i = 0; i < 3; i++) {
+            Rhi::CpuSampler sampler{ descriptors[i] };
+
+            runner.run(names[i], "sample", kSampleCount, [&]() {
+                if (i < 2) {
+                    sampler.sampleLevel(sampled, coordinates, lod.data(), output.data());
+                } else {
+                    sampler.sampleGrad(sampled, coordinates, gradients, output.data());
+                }
+
+                sink = static_cast<Rhi::Uint64>(output[kSampleCount] * 255.0f);
+            });
+        }
+    }
+
+    // y = a * x + y over a storage buffer pair, from this GLSL compiled to SPIR-V:
+    //   layout(local_size_x = 64) in;
+    //   layout(binding = 0) readonly buffer X { float x[]; };
+    //   layout(binding = 1) buffer Y { float y[]; };
+    //   layout(push_constant) uniform P { float a; uint n; };
+    //   void main() { uint i = gl_GlobalInvocationID.x; if (i < n) y[i] = x[i] * a + y[i]; }
+    struct SaxpyConstants {
+        float a;
+        uint32_t n;
+    };
+
+    constexpr Rhi::ShaderField kSaxpyConstantFields[] = {
+        RHI_SHADER_FIELD(SaxpyConstants, a), RHI_SHADER_FIELD(SaxpyConstants, n) };
+
+    static_assert(Rhi::isBufferLayout<SaxpyConstants>(Rhi::BufferLayoutRule::eStd430, kSaxpyConstantFields),
+        "SaxpyConstants does not match the push constant block of kSaxpyShader");
+
+    const uint32_t kSaxpyShader[] = {
+            0x07230203, 0x00010300, 0x00000000, 0x00000029, 0x00000000, 0x00020011, 0x00000001, 0x0003000e,
+            0x00000000, 0x00000001, 0x0006000f, 0x00000005, 0x00000001, 0x6e69616d, 0x00000000, 0x00000002,
+            0x00060010, 0x00000001, 0x00000011, 0x00000040, 0x00000001, 0x00000001, 0x00040047, 0x00000002,
+            0x0000000b, 0x0000001c, 0x00040047, 0x00000003, 0x00000006, 0x00000004, 0x00050048, 0x00000004,
+            0x00000000, 0x00000023, 0x00000000, 0x00030047, 0x00000004, 0x00000002, 0x00040047, 0x00000005,
+            0x00000022, 0x00000000, 0x00040047, 0x00000005, 0x00000021, 0x00000000, 0x00040047, 0x00000006,
+            0x00000022, 0x00000000, 0x00040047, 0x00000006, 0x00000021, 0x00000001, 0x00050048, 0x00000007,
+            0x00000000, 0x00000023, 0x00000000, 0x00050048, 0x00000007, 0x00000001, 0x00000023, 0x00000004,
+            0x00030047, 0x00000007, 0x00000002, 0x00020013, 0x00000008, 0x00030021, 0x00000009, 0x00000008,
+            0x00040015, 0x0000000a, 0x00000020, 0x00000000, 0x00030016, 0x0000000b, 0x00000020, 0x00020014,
+            0x0000000c, 0x00040017, 0x0000000d, 0x0000000a, 0x00000003, 0x0003001d, 0x00000003, 0x0000000b,
+            0x0003001e, 0x00000004, 0x00000003, 0x00040020, 0x0000000e, 0x0000000c, 0x00000004, 0x0004003b,
+            0x0000000e, 0x00000005, 0x0000000c, 0x0004003b, 0x0000000e, 0x00000006, 0x0000000c, 0x0004001e,
+            0x00000007, 0x0000000b, 0x0000000a, 0x00040020, 0x0000000f, 0x00000009, 0x00000007, 0x0004003b,
+            0x0000000f, 0x00000010, 0x00000009, 0x00040020, 0x00000011, 0x00000001, 0x0000000d, 0x0004003b,
+            0x00000011, 0x00000002, 0x00000001, 0x00040020, 0x00000012, 0x0000000c, 0x0000000b, 0x00040020,
+            0x00000013, 0x00000009, 0x0000000b, 0x00040020, 0x00000014, 0x00000009, 0x0000000a, 0x00040020,
+            0x00000015, 0x00000001, 0x0000000a, 0x0004002b, 0x0000000a, 0x00000016, 0x00000000, 0x0004002b,
+            0x0000000a, 0x00000017, 0x00000001, 0x00050036, 0x00000008, 0x00000001, 0x00000000, 0x00000009,
+            0x000200f8, 0x00000018, 0x00050041, 0x00000015, 0x00000019, 0x00000002, 0x00000016, 0x0004003d,
+            0x0000000a, 0x0000001a, 0x00000019, 0x00050041, 0x00000014, 0x0000001b, 0x00000010, 0x00000017,
+            0x0004003d, 0x0000000a, 0x0000001c, 0x0000001b, 0x000500b0, 0x0000000c, 0x0000001d, 0x0000001a,
+            0x0000001c, 0x000300f7, 0x0000001e, 0x00000000, 0x000400fa, 0x0000001d, 0x0000001f, 0x0000001e,
+            0x000200f8, 0x0000001f, 0x00060041, 0x00000012, 0x00000020, 0x00000005, 0x00000016, 0x0000001a,
+            0x0004003d, 0x0000000b, 0x00000021, 0x00000020, 0x00050041, 0x00000013, 0x00000022, 0x00000010,
+            0x00000016, 0x0004003d, 0x0000000b, 0x00000023, 0x00000022, 0x00050085, 0x0000000b, 0x00000024,
+            0x00000021, 0x00000023, 0x00060041, 0x00000012, 0x00000025, 0x00000006, 0x00000016, 0x0000001a,
+            0x0004003d, 0x0000000b, 0x00000026, 0x00000025, 0x00050081, 0x0000000b, 0x00000027, 0x00000024,
+            0x00000026, 0x00060041, 0x00000012, 0x00000028, 0x00000006, 0x00000016, 0x0000001a, 0x0003003e,
+            0x00000028, 0x00000027, 0x000200f9, 0x0000001e, 0x000200f8, 0x0000001e, 0x000100fd, 0x00010038
+    };
+
+    void benchmarkCompute(BenchmarkRunner& runner) {
+        constexpr Rhi::Uint32 kInvocationCount = 1 << 18;
+
+        Rhi::NullAdapter adapter{ Rhi::getNullAdapterDescriptor() };
+        auto device = std::static_pointer_cast<Rhi::NullDevice>(adapter.requestDevice(Rhi::DeviceMode::eComputeOnly));
+
+        auto storageUsage = static_cast<Rhi::BufferUsageFlags>(Rhi::BufferUsage::eStorage);
+        auto x = device->createBuffer(Rhi::BufferDescriptor{ kInvocationCount * 4, storageUsage, Rhi::BufferLocation::eDeviceLocal });
+        auto y = device->createBuffer(Rhi::BufferDescriptor{ kInvocationCount * 4, storageUsage, Rhi::BufferLocation::eDeviceLocal });
+
+        Rhi::ShaderModuleDescriptor moduleDescriptor{};
+        moduleDescriptor.code = reinterpret_cast<Rhi::String>(kSaxpyShader);
+        moduleDescriptor.codeSize = sizeof(kSaxpyShader);
+        auto module = device->createShaderModule(moduleDescriptor);
+
+        Rhi::BindGroupLayoutDescriptor layoutDescriptor{};
+        layoutDescriptor.entries.resize(2);
+
+        for (Rhi::Uint32 i = 0; i < 2; i++) {
+            layoutDescriptor.entries[i].binding = i;
+            layoutDescriptor.entries[i].visibility = static_cast<Rhi::ShaderStageFlags>(Rhi::ShaderStage::eCompute);
+            layoutDescriptor.entries[i].buffer.type = Rhi::BufferBindingType::eStorage;
+        }
+
+        auto bindGroupLayout = device->createBindGroupLayout(layoutDescriptor);
+
+        Rhi::BindGroupDescriptor bindGroupDescriptor{ bindGroupLayout.get(), { Rhi::BindGroupEntry{ 0 }, Rhi::BindGroupEntry{ 1 } } };
+        bindGroupDescriptor.entries[0].buffer.buffer = x.get();
+        bindGroupDescriptor.entries[1].buffer.buffer = y.get();
+        auto bindGroup = device->createBindGroup(bindGroupDescriptor);
+
+        Rhi::ComputePipelineDescriptor pipelineDescriptor{};
+        pipelineDescriptor.compute = Rhi::ProgrammableStage{ module.get(), "main" };
+
+        runner.run("compute/translate_saxpy", "op", 1, [&]() {
+            Rhi::ComputeKernel kernel;
+            std::string error;
+            sink = kernel.compile(kSaxpyShader, sizeof(kSaxpyShader) / 4, "main", nullptr, error);
+        });
+
+        auto pipeline = device->createComputePipeline(pipelineDescriptor);
+        auto encoder = device->createCommandEncoder();
+
+        SaxpyConstants constants = { 2.0f, kInvocationCount };
+
+        auto pass = encoder->beginComputePass(Rhi::ComputePassDescriptor{});
+        pass->setPipeline(pipeline.get());
+        pass->setBindGroup(0, bindGroup.get());
+        pass->setPushConstants(static_cast<Rhi::ShaderStageFlags>(Rhi::ShaderStage::eCompute), 0, sizeof(constants), &constants);
+        pass->dispatchWorkgroups(kInvocationCount / 64);
+        pass->end();
+        encoder->finish();
+
+        runner.run("compute/saxpy_256k", "invocation", kInvocationCount, [&]() {
+            device->getQueue()->submit({ encoder.get() });
+        });
+
+        // Encoders pick up the pool when they are created
+        Rhi::TaskPool pool;
+        device->setComputePool(&pool);
+
+        auto pooledEncoder = device->createCommandEncoder();
+        auto pooledPass = pooledEncoder->beginComputePass(Rhi::ComputePassDescriptor{});
+        pooledPass->setPipeline(pipeline.get());
+        pooledPass->setBindGroup(0, bindGroup.get());
+        pooledPass->setPushConstants(static_cast<Rhi::ShaderStageFlags>(Rhi::ShaderStage::eCompute), 0, sizeof(constants), &constants);
+        pooledPass->dispatchWorkgroups(kInvocationCount / 64);
+        pooledPass->end();
+        pooledEncoder->finish();
+
+        runner.run("compute/saxpy_256k_pool", "invocation", kInvocationCount, [&]() {
+            device->getQueue()->submit({ pooledEncoder.get() });
+        });
+
+        device->setComputePool(nullptr);
+        sink = static_cast<const float*>(y->map())[kInvocationCount - 1] != 0.0f;
+        y->unmap();
+    }
+
+    // Two software adapters stand in for a multi-GPU machine
+    void benchmarkMultiDevice(BenchmarkRunner& runner) {
+        Rhi::NullInstance instance{ { Rhi::getNullAdapterDescriptor(), Rhi::getNullAdapterDescriptor() } };
+
+        std::vector<std::shared_ptr<Rhi::Device>> devices;
+        for (const Rhi::RankedAdapter& ranked : Rhi::rankAdapters(instance.enumerateAdapters())) {
+            devices.push_back(ranked.adapter->requestDevice());
+        }
+
+        runner.run("device/request_compute_only", "op", 1, [&]() {
+            auto device = instance.enumerateAdapters()[0]->requestDevice(Rhi::DeviceMode::eComputeOnly);
+            sink = static_cast<Rhi::Uint64>(device->desc.mode);
+        });
+
+        Rhi::DeviceGroup group{ { devices[0].get(), devices[1].get() } };
+
+        constexpr Rhi::Uint64 kCopySize = 16ull << 20;
+        auto copyUsage = static_cast<Rhi::BufferUsageFlags>(Rhi::BufferUsage::eCopySrc)
+            | static_cast<Rhi::BufferUsageFlags>(Rhi::BufferUsage::eCopyDst);
+
+        auto source = devices[0]->createBuffer(Rhi::BufferDescriptor{ kCopySize, copyUsage, Rhi::BufferLocation::eDeviceLocal });
+        auto destination = devices[1]->createBuffer(Rhi::BufferDescriptor{ kCopySize, copyUsage, Rhi::BufferLocation::eDeviceLocal });
+        std::string error;
+
+        runner.run("multi_device/copy_buffer_16m", "byte", kCopySize, [&]() {
+            sink = group.copyBuffer(0, source.get(), 0, 1, destination.get(), 0, kCopySize, error);
+        });
+
+        runner.run("multi_device/split_tiles_4k", "tile", (3840 / 64) * (2160 / 64 + 1), [&]() {
+            sink = group.splitTiles(3840, 2160, 64).size();
+        });
+    }
+
+    void benchmarkResources(BenchmarkRunner& runner, Rhi::Device* device) {
+        constexpr Rhi::Uint32 kResourceCount = 100;
+
+        runner.run("resource/create_destroy_buffer", "op", kResourceCount, [&]() {
+            for (Rhi::Uint32 i = 0; i < kResourceCount; i++) {
+                auto buffer = device->createBuffer(Rhi::BufferDescriptor{ 64ull << 10,
+                    static_cast<Rhi::BufferUsageFlags>(Rhi::BufferUsage::eUniform), Rhi::BufferLocation::eDeviceLocal });
+                sink = buffer->desc.size;
+            }
+        });
+
+        Rhi::TextureDescriptor textureDescriptor;
+        textureDescriptor.size = Rhi::Extent3D{ 1024, 1024, 1 };
+        textureDescriptor.mipLevelCount = 11;
+        textureDescriptor.usage = static_cast<Rhi::TextureUsageFlags>(Rhi::TextureUsage::eTextureBinding);
+        textureDescriptor.format = Rhi::eRGBA8Unorm;
+
+        runner.run("resource/create_destroy_texture", "op", kResourceCount, [&]() {
+            for (Rhi::Uint32 i = 0; i < kResourceCount; i++) {
+                auto texture = device->createTexture(textureDescriptor);
+                auto view = texture->createView(Rhi::TextureViewDescriptor{});
+                sink = view->desc.subresource.mipLevelCount;
+            }
+        });
+
+        auto layout = device->createBindGroupLayout(Rhi::BindGroupLayoutDescriptor{});
+
+        runner.run("resource/create_destroy_bind_group", "op", kResourceCount, [&]() {
+            for (Rhi::Uint32 i = 0; i < kResourceCount; i++) {
+                auto bindGroup = device->createBindGroup(Rhi::BindGroupDescriptor{ layout.get(), {} });
+                sink = bindGroup->desc.entries.size();
+            }
+        });
+
+        // Creating an already recorded pipeline: building its manifest key and finding the entry
+        Rhi::PipelineManifestDevice manifestDevice{ device };
+
+        std::vector<uint32_t> code(1024, 0x07230203);
+        auto module = manifestDevice.createShaderModule(Rhi::ShaderModuleDescriptor{
+            reinterpret_cast<Rhi::String>(code.data()), code.size() * sizeof(uint32_t) });
+
+        Rhi::RenderPipelineDescriptor pipelineDescriptor;
+        pipelineDescriptor.vertex.module = module.get();
+        pipelineDescriptor.vertex.entryPoint = "main";
+        pipelineDescriptor.vertex.buffers.push_back(Rhi::VertexBufferLayout{ 32, Rhi::VertexStepMode::eVertex,
+            { Rhi::VertexAttribute{ Rhi::eFloat32x3, 0, 0 }, Rhi::VertexAttribute{ Rhi::eFloat32x2, 12, 1 } } });
+        pipelineDescriptor.fragment.module = module.get();
+        pipelineDescriptor.fragment.entryPoint = "main";
+
+        Rhi::ColorTargetState colorTarget;
+        colorTarget.format = Rhi::eRGBA8Unorm;
+        colorTarget.blend = Rhi::BlendState{};
+        colorTarget.writeMask = 0xF;
+        pipelineDescriptor.fragment.targets.push_back(colorTarget);
+
+        runner.run("resource/manifest_recorded_pipeline", "op", kResourceCount, [&]() {
+            for (Rhi::Uint32 i = 0; i < kResourceCount; i++) {
+                auto pipeline = manifestDevice.createRenderPipeline(pipelineDescriptor);
+                sink = pipeline->desc.vertex.buffers.size();
+            }
+        });
+    }
+
+    void benchmarkVisibility(BenchmarkRunner& runner, Rhi::Device* device) {
+        constexpr Rhi::Uint32 kObjectCount = 100000;
+
+        std::mt19937 random{ 1234 };
+        std::uniform_real_distribution<float> position{ -200.0f, 200.0f };
+        std::uniform_real_distribution<float> size{ 0.5f, 4.0f };
+
+        std::vector<float> centerX(kObjectCount), centerY(kObjectCount), centerZ(kObjectCount), radius(kObjectCount);
+        for (Rhi::Uint32 i = 0; i < kObjectCount; i++) {
+            centerX[i] = position(random);
+            centerY[i] = position(random);
+            centerZ[i] = position(random);
+            radius[i] = size(random);
+        }
+
+        // 90 degree perspective looking down -z, near 0.1, far 500, [0, 1] depth
+        const float nearDepth = 0.1f, farDepth = 500.0f;
+        const float viewProjection[16] = {
+            1.0f, 0.0f, 0.0f, 0.0f,
+            0.0f, 1.0f, 0.0f, 0.0f,
+            0.0f, 0.0f, farDepth / (nearDepth - farDepth), -1.0f,
+            0.0f, 0.0f, nearDepth * farDepth / (nearDepth - farDepth), 0.0f
+        };
+
+        Rhi::Frustum frustum = Rhi::extractFrustum(viewProjection);
+        Rhi::BoundingSpheres spheres{ centerX.data(), centerY.data(), centerZ.data(), radius.data(), kObjectCount };
+        Rhi::BoundingBoxes boxes{ centerX.data(), centerY.data(), centerZ.data(), radius.data(), radius.data(), radius.data(), kObjectCount };
+
+        std::vector<Rhi::Uint32> visible(kObjectCount);
+        Rhi::TaskPool pool;
+
+        runner.run("cull/spheres", "op", kObjectCount, [&]() {
+            sink = Rhi::cullSpheres(frustum, spheres, visible.data());
+        });
+
+        runner.run("cull/boxes", "op", kObjectCount, [&]() {
+            sink = Rhi::cullBoxes(frustum, boxes, visible.data());
+        });
+
+        runner.run("cull/spheres_parallel", "op", kObjectCount, [&]() {
+            sink = Rhi::cullSpheres(pool, frustum, spheres, visible.data());
+        });
+
+        // Visible draws keyed over 16 pipelines and 256 bind groups, then recorded in key order
+        auto pipelines = std::vector<std::shared_ptr<Rhi::RenderPipeline>>(16);
+        for (auto& pipeline : pipelines) {
+            pipeline = device->createRenderPipeline(Rhi::RenderPipelineDescriptor{});
+        }
+
+        auto bindGroups = std::vector<std::shared_ptr<Rhi::BindGroup>>(256);
+        for (auto& bindGroup : bindGroups) {
+            bindGroup = device->createBindGroup(Rhi::BindGroupDescriptor{});
+        }
+
+        auto indexBuffer = device->createBuffer(Rhi::BufferDescriptor{ 1 << 20, static_cast<Rhi::BufferUsageFlags>(Rhi::BufferUsage::eIndex),
+            Rhi::BufferLocation::eDeviceLocal });
+
+        Rhi::Uint32 visibleCount = Rhi::cullSpheres(frustum, spheres, visible.data());
+
+        std::vector<Rhi::DrawItem> items(kObjectCount);
+        for (Rhi::Uint32 i = 0; i < kObjectCount; i++) {
+            items[i].pipeline = pipelines[i % pipelines.size()].get();
+            items[i].bindGroup = bindGroups[i % bindGroups.size()].get();
+            items[i].indexBuffer = indexBuffer.get();
+            items[i].count = 36;
+        }
+
+        std::vector<Rhi::SortedDraw> draws(visibleCount), scratch;
+
+        auto buildKeys = [&]() {
+            for (Rhi::Uint32 i = 0; i < visibleCount; i++) {
+                Rhi::Uint32 index = visible[i];
+                Rhi::Uint32 depth = Rhi::quantizeDrawDepth(-centerZ[index], nearDepth, farDepth);
+
+                draws[i].key = Rhi::makeDrawKey(0, index % pipelines.size(), index % bindGroups.size(), depth);
+                draws[i].drawIndex = index;
+            }
+        };
+
+        runner.run("sort/draw_keys", "op", visibleCount, [&]() {
+            buildKeys();
+            Rhi::sortDraws(draws, scratch);
+        });
+
+        buildKeys();
+        Rhi::sortDraws(draws, scratch);
+
+        runner.run("encode/sorted_draws", "op", visibleCount, [&]() {
+            auto encoder = device->createCommandEncoder();
+            auto pass = encoder->beginRenderPass(Rhi::RenderPassDescriptor{});
+
+            sink = Rhi::encodeSortedDraws(pass.get(), items.data(), draws.data(), visibleCount).pipelineChanges;
+
+            pass->end();
+            encoder->finish();
+        });
+    }
+
+    void benchmarkFormatConversion(BenchmarkRunner& runner) {
+        constexpr Rhi::Uint32 kVertexCount = 4096;
+
+        // Fixed seed, every run converts the same values
+        std::mt19937 random{ 1234 };
+        std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+
+        std::vector<float> values(kVertexCount * 4);
+        for (auto& value : values) {
+            value = distribution(random);
+        }
+
+        std::vector<uint8_t> output(kVertexCount * 16);
+
+        const Rhi::VertexFormat formats[] = { Rhi::eFloat16x4, Rhi::eSnorm8x4, Rhi::eUnorm16x2, Rhi::eUnorm1010102 };
+        const char* names[] = { "convert/float16x4", "convert/snorm8x4", "convert/unorm16x2", "convert/unorm1010102" };
+
+        for (Rhi::Uint32 f = 0; f < 4; f++) {
+            runner.run(names[f], "op", kVertexCount, [&]() {
+                for (Rhi::Uint32 v = 0; v < kVertexCount; v++) {
+                    Rhi::encodeVertexAttribute(formats[f], &values[v * 4], 4, &output[v * 16]);
+                }
+
+                sink = output[kVertexCount];
+            });
+        }
+    }
+};
+
+// Usage: RhiBenchmark [--filter <substring>] [--samples <n>] [--json <path>] [--label <name>] [--compare <baseline.json>]
+// Runs against the null backend, so the numbers are the CPU cost of the RHI layer itself.
+int main(int argc, char const *argv[])
+{
+    BenchmarkRunner runner;
+    std::string jsonPath, comparePath, label = "unlabeled";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string argument = argv[i];
+
+        if (argument == "--filter") {
+            runner.filter = argv[i + 1];
+        } else if (argument == "--samples") {
+            runner.sampleCount = std::max(1ul, std::strtoul(argv[i + 1], nullptr, 10));
+        } else if (argument == "--json") {
+            jsonPath = argv[i + 1];
+        } else if (argument == "--label") {
+            label = argv[i + 1];
+        } else if (argument == "--compare") {
+            comparePath = argv[i + 1];
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    Rhi::NullDevice device;
+
+    benchmarkEncoding(runner, &device);
+    benchmarkUploads(runner, &device);
+    benchmarkTextureCopies(runner, &device);
+    benchmarkSampling(runner);
+    benchmarkCompute(runner);
+    benchmarkMultiDevice(runner);
+    benchmarkResources(runner, &device);
+    benchmarkVisibility(runner, &device);
+    benchmarkFormatConversion(runner);
+
+    if (!jsonPath.empty() && !runner.writeJson(jsonPath, label)) {
+        std::fprintf(stderr, "Failed to write %s\n", jsonPath.c_str());
+        return 1;
+    }
+
+    if (!comparePath.empty() && !runner.compare(comparePath)) {
+        std::fprintf(stderr, "Failed to read %s\n", comparePath.c_str());
+        return 1;
+    }
+
+    return 0;
+}
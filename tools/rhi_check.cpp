@@ -0,0 +1,127 @@
+#include "null_device.hpp"
+#include "multi_device.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    // The split helpers cover their input exactly once, and copies between two software devices
+    // land byte for byte, chunked through a small staging buffer
+    bool checkMultiDevice(std::string& error) {
+        Rhi::NullInstance instance{ { Rhi::getNullAdapterDescriptor(), Rhi::getNullAdapterDescriptor() } };
+        auto adapters = instance.enumerateAdapters();
+
+        auto first = adapters[0]->requestDevice();
+        auto second = adapters[1]->requestDevice();
+
+        Rhi::DeviceGroupDescriptor descriptor;
+        descriptor.weights = { 3, 1 };
+        descriptor.stagingSize = 4096;
+
+        Rhi::DeviceGroup group{ { first.get(), second.get() }, descriptor };
+
+        constexpr Rhi::Uint64 kCopySize = 10000;
+        auto copyUsage = static_cast<Rhi::BufferUsageFlags>(Rhi::BufferUsage::eCopySrc)
+            | static_cast<Rhi::BufferUsageFlags>(Rhi::BufferUsage::eCopyDst);
+
+        auto source = first->createBuffer(Rhi::BufferDescriptor{ kCopySize, copyUsage, Rhi::BufferLocation::eDeviceLocal });
+        auto destination = second->createBuffer(Rhi::BufferDescriptor{ kCopySize + 16, copyUsage, Rhi::BufferLocation::eDeviceLocal });
+
+        std::vector<uint8_t> pattern(kCopySize);
+        for (Rhi::Uint64 i = 0; i < kCopySize; i++) {
+            pattern[i] = static_cast<uint8_t>(i * 7 + 3);
+        }
+
+        first->getQueue()->writeBuffer(source.get(), 0, pattern.data(), kCopySize);
+
+        if (!group.copyBuffer(0, source.get(), 5, 1, destination.get(), 16, kCopySize - 5, error)) {
+            return false;
+        }
+
+        const uint8_t* copied = static_cast<const uint8_t*>(destination->map());
+        bool isEqual = std::memcmp(copied + 16, pattern.data() + 5, kCopySize - 5) == 0;
+        destination->unmap();
+
+        if (!isEqual) {
+            error = "copyBuffer did not reproduce the source";
+            return false;
+        }
+
+        if (group.copyBuffer(0, source.get(), ULLONG_MAX - 7, 1, destination.get(), 0, 16, error)) {
+            error = "copyBuffer accepted a wrapping source range";
+            return false;
+        }
+
+        const Rhi::Uint32 counts[3] = { 7, 1001, 3 };
+        std::vector<Rhi::Uint32> covered(counts[1], 0);
+
+        for (const Rhi::DispatchRange& range : group.splitDispatch(counts[0], counts[1], counts[2])) {
+            if (range.baseWorkgroup[0] != 0 || range.workgroupCount[0] != counts[0]
+                || range.baseWorkgroup[2] != 0 || range.workgroupCount[2] != counts[2])
+            {
+                error = "splitDispatch cut an axis other than the largest";
+                return false;
+            }
+
+            for (Rhi::Uint32 y = range.baseWorkgroup[1]; y < range.baseWorkgroup[1] + range.workgroupCount[1] && y < counts[1]; y++) {
+                covered[y]++;
+            }
+        }
+
+        if (std::any_of(covered.begin(), covered.end(), [](Rhi::Uint32 count) { return count != 1; })) {
+            error = "splitDispatch does not cover every workgroup exactly once";
+            return false;
+        }
+
+        constexpr Rhi::Uint32 kWidth = 1000;
+        constexpr Rhi::Uint32 kHeight = 500;
+        std::vector<uint8_t> pixels(kWidth * kHeight, 0);
+
+        for (const Rhi::FrameTile& tile : group.splitTiles(kWidth, kHeight, 64)) {
+            for (Rhi::Uint32 y = tile.y; y < tile.y + tile.height && y < kHeight; y++) {
+                for (Rhi::Uint32 x = tile.x; x < tile.x + tile.width && x < kWidth; x++) {
+                    pixels[y * kWidth + x]++;
+                }
+            }
+        }
+
+        if (std::any_of(pixels.begin(), pixels.end(), [](uint8_t count) { return count != 1; })) {
+            error = "splitTiles does not cover every pixel exactly once";
+            return false;
+        }
+
+        return true;
+    }
+
+    struct Check {
+        const char* name;
+        bool (*run)(std::string& error);
+    };
+
+    const Check kChecks[] = {
+        { "multi_device", checkMultiDevice }
+    };
+};
+
+// Usage: RhiCheck
+// Correctness checks against the null backend, kept out of RhiBenchmark so timing runs do not
+// depend on them. Exits non zero when any check fails.
+int main()
+{
+    int exitCode = 0;
+
+    for (const Check& check : kChecks) {
+        std::string error;
+
+        if (check.run(error)) {
+            std::printf("%-24s ok\n", check.name);
+        } else {
+            std::fprintf(stderr, "%-24s failed: %s\n", check.name, error.c_str());
+            exitCode = 1;
+        }
+    }
+
+    return exitCode;
+}
@@ -0,0 +1,213 @@
+#include "shader_cache.hpp"
+#include "shader_reflection.hpp"
+#include "task_pool.hpp"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+    bool writeSpirv(const std::string& path, const std::vector<uint32_t>& spirv) {
+        std::ofstream file{ path, std::ios::binary };
+        file.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+
+        return static_cast<bool>(file);
+    }
+
+    std::string escapeDepfilePath(const std::string& path) {
+        std::string escaped;
+
+        for (char c : path) {
+            if (c == ' ' || c == '#') {
+                escaped.push_back('\\');
+            }
+
+            escaped.push_back(c == '\\' ? '/' : c);
+        }
+
+        return escaped;
+    }
+
+    bool writeDepfile(const std::string& path, const std::string& output, const std::string& input,
+        const std::vector<std::string>& dependencies)
+    {
+        std::ofstream file{ path };
+        file << escapeDepfilePath(output) << ": " << escapeDepfilePath(input);
+
+        for (const auto& dependency : dependencies) {
+            file << " \\\n  " << escapeDepfilePath(dependency);
+        }
+
+        file << "\n";
+        return static_cast<bool>(file);
+    }
+
+    const char* getVertexFormatName(Rhi::VertexFormat format) {
+        switch (format) {
+            case Rhi::eFloat32: return "eFloat32";
+            case Rhi::eFloat32x2: return "eFloat32x2";
+            case Rhi::eFloat32x3: return "eFloat32x3";
+            case Rhi::eFloat32x4: return "eFloat32x4";
+            case Rhi::eSint32: return "eSint32";
+            case Rhi::eSint32x2: return "eSint32x2";
+            case Rhi::eSint32x3: return "eSint32x3";
+            case Rhi::eSint32x4: return "eSint32x4";
+            case Rhi::eUint32: return "eUint32";
+            case Rhi::eUint32x2: return "eUint32x2";
+            case Rhi::eUint32x3: return "eUint32x3";
+            case Rhi::eUint32x4: return "eUint32x4";
+            default: return nullptr;
+        }
+    }
+
+    // The vertex inputs as a constexpr table named after the source file, basic.vert becomes
+    // ShaderInputs::basic_vert, for matchesVertexInputs
+    bool writeReflectionHeader(const std::string& path, const std::string& input, const std::vector<uint32_t>& spirv,
+        std::string& error)
+    {
+        Rhi::ShaderReflection reflection;
+        if (!Rhi::reflectSpirv(spirv.data(), spirv.size(), nullptr, reflection, error)) {
+            return false;
+        }
+
+        std::string name = std::filesystem::path(input).filename().string();
+        for (char& c : name) {
+            c = std::isalnum(static_cast<unsigned char>(c)) ? c : '_';
+        }
+
+        if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+            name.insert(name.begin(), '_');
+        }
+
+        // Reflection reports the shader's own type, which is always 32 bit today, but the
+        // header has no name to write for anything else
+        for (const auto& vertexInput : reflection.vertexInputs) {
+            if (getVertexFormatName(vertexInput.format) == nullptr) {
+                error = input + ": vertex input at location " + std::to_string(vertexInput.location)
+                    + " has no 32 bit vertex format";
+                return false;
+            }
+        }
+
+        std::ofstream file{ path };
+        file << "// Generated by ShaderCompiler from " << std::filesystem::path(input).filename().string() << "\n"
+            << "#pragma once\n\n#include \"struct_layout.hpp\"\n\nnamespace ShaderInputs {\n"
+            << "    constexpr std::array<Rhi::ShaderVertexInput, " << reflection.vertexInputs.size() << "> " << name << " = { {\n";
+
+        for (const auto& vertexInput : reflection.vertexInputs) {
+            file << "        { " << vertexInput.location << ", Rhi::" << getVertexFormatName(vertexInput.format) << " },\n";
+        }
+
+        file << "    } };\n};\n";
+
+        if (!file) {
+            error = "Failed to write " + path;
+            return false;
+        }
+
+        return true;
+    }
+};
+
+// Usage:
+//   ShaderCompiler [options] -o <output.spv> <input>
+//   ShaderCompiler [options] --out-dir <dir> <inputs...>
+// Options:
+//   --compiler <path>   glslc executable, found on PATH by default
+//   --cache <dir>       on-disk SPIR-V store, shared with the runtime ShaderCache
+//   --max-size <MiB>    store size before least recently used entries are evicted
+//   --depfile <file>    Makefile style include dependencies, single input only
+//   --reflect-header <file>  constexpr table of the vertex inputs, single input only
+//   -I <dir>            additional include directory
+int main(int argc, char const *argv[])
+{
+    Rhi::ShaderCacheDescriptor descriptor;
+    std::string output, outputDirectory, depfile, reflectHeader;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--compiler" && hasValue) {
+            descriptor.compiler = argv[++i];
+        } else if (argument == "--cache" && hasValue) {
+            descriptor.directory = argv[++i];
+        } else if (argument == "--max-size" && hasValue) {
+            descriptor.maxSize = std::strtoull(argv[++i], nullptr, 10) << 20;
+        } else if (argument == "--depfile" && hasValue) {
+            depfile = argv[++i];
+        } else if (argument == "--reflect-header" && hasValue) {
+            reflectHeader = argv[++i];
+        } else if (argument == "--out-dir" && hasValue) {
+            outputDirectory = argv[++i];
+        } else if (argument == "-o" && hasValue) {
+            output = argv[++i];
+        } else if (argument == "-I" && hasValue) {
+            descriptor.includeDirectories.push_back(argv[++i]);
+        } else {
+            inputs.push_back(argument);
+        }
+    }
+
+    if (inputs.empty() || output.empty() == outputDirectory.empty() || (!output.empty() && inputs.size() != 1)
+        || (!reflectHeader.empty() && inputs.size() != 1))
+    {
+        std::fprintf(stderr, "Usage: %s [--compiler <path>] [--cache <dir>] [--max-size <MiB>] [--depfile <file>] "
+            "[--reflect-header <file>] [-I <dir>]... "
+            "(-o <output.spv> <input> | --out-dir <dir> <inputs...>)\n", argv[0]);
+        return 1;
+    }
+
+    Rhi::ShaderCache cache{ descriptor };
+    Rhi::TaskPool pool;
+
+    std::vector<Rhi::ShaderCompileResult> results;
+    cache.compileFiles(inputs, pool, results);
+
+    int exitCode = 0;
+    size_t hitCount = 0;
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        const auto& result = results[i];
+
+        if (!result.success) {
+            std::fprintf(stderr, "%s: %s\n", inputs[i].c_str(), result.error.c_str());
+            exitCode = 1;
+            continue;
+        }
+
+        std::string path = output;
+        if (path.empty()) {
+            std::filesystem::path name = std::filesystem::path(inputs[i]).filename();
+            path = (std::filesystem::path(outputDirectory) / name).string() + ".spv";
+        }
+
+        if (!writeSpirv(path, result.spirv)) {
+            std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+            exitCode = 1;
+            continue;
+        }
+
+        if (!depfile.empty() && !writeDepfile(depfile, path, inputs[i], result.dependencies)) {
+            std::fprintf(stderr, "Failed to write %s\n", depfile.c_str());
+            exitCode = 1;
+        }
+
+        std::string error;
+        if (!reflectHeader.empty() && !writeReflectionHeader(reflectHeader, inputs[i], result.spirv, error)) {
+            std::fprintf(stderr, "%s: %s\n", inputs[i].c_str(), error.c_str());
+            exitCode = 1;
+        }
+
+        hitCount += result.cacheHit ? 1 : 0;
+    }
+
+    if (inputs.size() > 1) {
+        std::printf("%zu shaders, %zu from cache\n", inputs.size(), hitCount);
+    }
+
+    return exitCode;
+}
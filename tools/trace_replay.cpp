@@ -0,0 +1,114 @@
+#include "null_device.hpp"
+#include "trace_replay.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+    double getPercentile(const std::vector<double>& sorted, double percentile) {
+        size_t index = static_cast<size_t>(percentile * static_cast<double>(sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+
+    void printFrames(const std::vector<Rhi::TraceFrameTiming>& frames) {
+        std::vector<double> frameTimes;
+        double submitTime = 0.0;
+        Rhi::Uint64 commandCount = 0, uploadBytes = 0;
+
+        for (const auto& frame : frames) {
+            frameTimes.push_back(frame.milliseconds);
+            submitTime += frame.submitMilliseconds;
+            commandCount += frame.commandCount;
+            uploadBytes += frame.uploadBytes;
+        }
+
+        std::sort(frameTimes.begin(), frameTimes.end());
+        double frameCount = static_cast<double>(frames.size());
+
+        std::printf("%zu frames, %.1f commands and %.2f KiB uploaded per frame\n", frames.size(),
+            static_cast<double>(commandCount) / frameCount, static_cast<double>(uploadBytes) / frameCount / 1024.0);
+        std::printf("frame ms   p50 %8.4f  p90 %8.4f  p99 %8.4f  max %8.4f\n", getPercentile(frameTimes, 0.50),
+            getPercentile(frameTimes, 0.90), getPercentile(frameTimes, 0.99), frameTimes.back());
+        std::printf("submit ms  mean %8.4f\n\n", submitTime / frameCount);
+
+        // Passes are matched by their position in the frame
+        size_t passCount = 0;
+        for (const auto& frame : frames) {
+            passCount = std::max(passCount, frame.passes.size());
+        }
+
+        std::printf("%-6s %-8s %10s %10s %10s %10s\n", "pass", "type", "commands", "p50 ms", "p99 ms", "max ms");
+
+        for (size_t i = 0; i < passCount; i++) {
+            std::vector<double> passTimes;
+            Rhi::Uint64 passCommands = 0;
+            bool compute = false;
+
+            for (const auto& frame : frames) {
+                if (i < frame.passes.size()) {
+                    passTimes.push_back(frame.passes[i].milliseconds);
+                    passCommands += frame.passes[i].commandCount;
+                    compute = frame.passes[i].compute;
+                }
+            }
+
+            std::sort(passTimes.begin(), passTimes.end());
+
+            std::printf("%-6zu %-8s %10.1f %10.4f %10.4f %10.4f\n", i, compute ? "compute" : "render",
+                static_cast<double>(passCommands) / static_cast<double>(passTimes.size()), getPercentile(passTimes, 0.50),
+                getPercentile(passTimes, 0.99), passTimes.back());
+        }
+    }
+};
+
+int main(int argc, char const *argv[])
+{
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s [--loops count] trace\n", argv[0]);
+        return 1;
+    }
+
+    unsigned long loopCount = 1;
+    std::string tracePath;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+
+        if (argument == "--loops" && i + 1 < argc) {
+            loopCount = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+        } else if (tracePath.empty()) {
+            tracePath = argument;
+        } else {
+            std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    // Replays against the host backend until a GPU backend implements the RHI
+    Rhi::NullDevice device;
+    Rhi::TraceReader reader;
+    Rhi::TraceReplayer replayer{ &device };
+
+    std::vector<Rhi::TraceFrameTiming> frames, loopFrames;
+    std::string error;
+
+    for (unsigned long loop = 0; loop < loopCount; loop++) {
+        replayer.reset();
+
+        if (!reader.open(tracePath, error) || !replayer.replay(reader, loopFrames, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+
+        frames.insert(frames.end(), loopFrames.begin(), loopFrames.end());
+    }
+
+    if (frames.empty()) {
+        std::fprintf(stderr, "%s holds no frames\n", tracePath.c_str());
+        return 1;
+    }
+
+    printFrames(frames);
+    return 0;
+}